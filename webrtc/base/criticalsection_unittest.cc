@@ -220,6 +220,17 @@ TEST(AtomicOpsTest, Simple) {
   EXPECT_EQ(0, value);
 }
 
+TEST(AtomicOpsTest, SimplePtr) {
+  int a = 0;
+  int b = 0;
+  int* volatile ptr = &a;
+  EXPECT_EQ(&a, AtomicOps::AcquireLoadPtr(&ptr));
+  EXPECT_EQ(&a, AtomicOps::CompareAndSwapPtr(&ptr, &b, &b));
+  EXPECT_EQ(&a, AtomicOps::AcquireLoadPtr(&ptr));
+  EXPECT_EQ(&a, AtomicOps::CompareAndSwapPtr(&ptr, &a, &b));
+  EXPECT_EQ(&b, AtomicOps::AcquireLoadPtr(&ptr));
+}
+
 TEST(AtomicOpsTest, Increment) {
   // Create and start lots of threads.
   AtomicOpRunner<IncrementOp, UniqueValueVerifier> runner(0);
@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2015 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_BASE_SWAP_QUEUE_H_
+#define WEBRTC_BASE_SWAP_QUEUE_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/base/constructormagic.h"
+
+namespace rtc {
+
+// Fixed-size, wait-free queue for handing items from exactly one producer
+// thread to exactly one consumer thread.
+//
+// Items are never copied by the queue. Insert() and Remove() swap the
+// caller's item with the one stored in the queue slot, so if all slots and
+// the caller-held items are preallocated to the largest size that will ever be
+// used (e.g. by constructing the queue from a prototype), no memory is
+// allocated or freed on either side after construction. This makes it
+// suitable for real-time audio threads.
+//
+// Insert() may only be called from the producer thread and Remove() only from
+// the consumer thread. Clear() requires that neither thread is inside the
+// queue, e.g. because both are blocked on a lock held by the caller.
+template <typename T>
+class SwapQueue {
+ public:
+  // Creates a queue of |size| default-constructed items.
+  explicit SwapQueue(size_t size) : queue_(size) { Clear(); }
+
+  // Creates a queue of |size| copies of |prototype|.
+  SwapQueue(size_t size, const T& prototype) : queue_(size, prototype) {
+    Clear();
+  }
+
+  // Resets the queue to be empty. Not thread-safe; see the class comment.
+  void Clear() {
+    next_write_index_ = 0;
+    next_read_index_ = 0;
+    AtomicOps::ReleaseStore(&num_elements_, 0);
+  }
+
+  // Swaps *|input| into the queue. On success, *|input| holds the previous
+  // contents of the slot. Returns false, leaving *|input| untouched, if the
+  // queue is full.
+  bool Insert(T* input) {
+    DCHECK(input);
+    if (AtomicOps::AcquireLoad(&num_elements_) ==
+        static_cast<int>(queue_.size())) {
+      return false;
+    }
+
+    using std::swap;
+    swap(*input, queue_[next_write_index_]);
+    ++next_write_index_;
+    if (next_write_index_ == queue_.size()) {
+      next_write_index_ = 0;
+    }
+
+    // Publishes the slot to the consumer (full barrier).
+    AtomicOps::Increment(&num_elements_);
+    return true;
+  }
+
+  // Swaps the oldest item in the queue into *|output|. On success, the slot
+  // takes over the previous contents of *|output|. Returns false, leaving
+  // *|output| untouched, if the queue is empty.
+  bool Remove(T* output) {
+    DCHECK(output);
+    if (AtomicOps::AcquireLoad(&num_elements_) == 0) {
+      return false;
+    }
+
+    using std::swap;
+    swap(*output, queue_[next_read_index_]);
+    ++next_read_index_;
+    if (next_read_index_ == queue_.size()) {
+      next_read_index_ = 0;
+    }
+
+    // Hands the slot back to the producer (full barrier).
+    AtomicOps::Decrement(&num_elements_);
+    return true;
+  }
+
+  size_t capacity() const { return queue_.size(); }
+
+ private:
+  // Only accessed by the producer.
+  size_t next_write_index_;
+  // Only accessed by the consumer.
+  size_t next_read_index_;
+  // Shared between the producer and the consumer.
+  volatile int num_elements_;
+
+  std::vector<T> queue_;
+
+  DISALLOW_COPY_AND_ASSIGN(SwapQueue);
+};
+
+}  // namespace rtc
+
+#endif  // WEBRTC_BASE_SWAP_QUEUE_H_
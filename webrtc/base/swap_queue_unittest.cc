@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2015 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/base/swap_queue.h"
+
+#include <vector>
+
+#include "webrtc/base/gunit.h"
+#include "webrtc/base/thread.h"
+
+namespace rtc {
+
+namespace {
+
+const size_t kQueueSize = 4;
+const int kNumItemsToTransfer = 10000;
+
+class Producer : public Runnable {
+ public:
+  explicit Producer(SwapQueue<std::vector<int>>* queue) : queue_(queue) {}
+
+  void Run(Thread* thread) override {
+    std::vector<int> item(1);
+    for (int i = 0; i < kNumItemsToTransfer; ++i) {
+      item[0] = i;
+      while (!queue_->Insert(&item)) {
+        Thread::SleepMs(0);
+      }
+      // The slot handed back must not have been resized by the queue.
+      ASSERT_EQ(1u, item.size());
+    }
+  }
+
+ private:
+  SwapQueue<std::vector<int>>* const queue_;
+};
+
+}  // namespace
+
+TEST(SwapQueueTest, InsertAndRemove) {
+  SwapQueue<int> queue(2);
+  int item = 1;
+  EXPECT_TRUE(queue.Insert(&item));
+  item = 2;
+  EXPECT_TRUE(queue.Insert(&item));
+  item = 3;
+  EXPECT_FALSE(queue.Insert(&item));
+  EXPECT_EQ(3, item);
+
+  EXPECT_TRUE(queue.Remove(&item));
+  EXPECT_EQ(1, item);
+  EXPECT_TRUE(queue.Remove(&item));
+  EXPECT_EQ(2, item);
+  EXPECT_FALSE(queue.Remove(&item));
+  EXPECT_EQ(2, item);
+}
+
+TEST(SwapQueueTest, SwapsRatherThanCopies) {
+  const std::vector<float> prototype(100, 0.f);
+  SwapQueue<std::vector<float>> queue(kQueueSize, prototype);
+
+  std::vector<float> input(prototype);
+  const float* const input_data = input.data();
+  input[0] = 1.f;
+  EXPECT_TRUE(queue.Insert(&input));
+  // The caller now owns the storage that previously lived in the queue.
+  EXPECT_NE(input_data, input.data());
+  EXPECT_EQ(prototype.size(), input.size());
+
+  std::vector<float> output(prototype);
+  EXPECT_TRUE(queue.Remove(&output));
+  EXPECT_EQ(input_data, output.data());
+  EXPECT_EQ(1.f, output[0]);
+}
+
+TEST(SwapQueueTest, ClearEmptiesQueue) {
+  SwapQueue<int> queue(kQueueSize);
+  int item = 0;
+  EXPECT_TRUE(queue.Insert(&item));
+  EXPECT_TRUE(queue.Insert(&item));
+  queue.Clear();
+  EXPECT_FALSE(queue.Remove(&item));
+  for (size_t i = 0; i < queue.capacity(); ++i) {
+    EXPECT_TRUE(queue.Insert(&item));
+  }
+  EXPECT_FALSE(queue.Insert(&item));
+}
+
+TEST(SwapQueueTest, TransfersInOrderAcrossThreads) {
+  SwapQueue<std::vector<int>> queue(kQueueSize, std::vector<int>(1));
+  Producer producer(&queue);
+  Thread thread;
+  thread.Start(&producer);
+
+  std::vector<int> item(1);
+  for (int i = 0; i < kNumItemsToTransfer; ++i) {
+    while (!queue.Remove(&item)) {
+      Thread::SleepMs(0);
+    }
+    ASSERT_EQ(i, item[0]);
+  }
+  thread.Stop();
+  EXPECT_FALSE(queue.Remove(&item));
+}
+
+}  // namespace rtc
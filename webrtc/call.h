@@ -89,6 +89,12 @@ class Call {
       AudioProcessing* audio_processing = nullptr;
       VoiceEngineObserver* voice_engine_observer = nullptr;
     } audio_config;
+
+    // If > 0, the video receive streams share this many decode threads,
+    // instead of decoding on a thread each, e.g. to receive many streams. The
+    // decoders are then initialized for a single core, so that they don't
+    // start threads of their own.
+    int num_decode_threads = 0;
   };
 
   struct Stats {
@@ -15,7 +15,8 @@
 #include "webrtc/base/checks.h"
 #include "webrtc/base/safe_conversions.h"
 #include "webrtc/common_audio/channel_buffer.h"
-#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/common_audio/include/audio_util.h"
+#include "webrtc/common_audio/resampler/multi_channel_sinc_resampler.h"
 #include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 using rtc::checked_cast;
@@ -68,13 +69,7 @@ class DownmixConverter : public AudioConverter {
   void Convert(const float* const* src, size_t src_size, float* const* dst,
                size_t dst_capacity) override {
     CheckSizes(src_size, dst_capacity);
-    float* dst_mono = dst[0];
-    for (size_t i = 0; i < src_frames(); ++i) {
-      float sum = 0;
-      for (int j = 0; j < src_channels(); ++j)
-        sum += src[j][i];
-      dst_mono[i] = sum / src_channels();
-    }
+    DownmixToMono<float, float>(src, src_frames(), src_channels(), dst[0]);
   }
 };
 
@@ -82,22 +77,18 @@ class ResampleConverter : public AudioConverter {
  public:
   ResampleConverter(int src_channels, size_t src_frames, int dst_channels,
                     size_t dst_frames)
-      : AudioConverter(src_channels, src_frames, dst_channels, dst_frames) {
-    resamplers_.reserve(src_channels);
-    for (int i = 0; i < src_channels; ++i)
-      resamplers_.push_back(new PushSincResampler(src_frames, dst_frames));
-  }
+      : AudioConverter(src_channels, src_frames, dst_channels, dst_frames),
+        resampler_(src_frames, dst_frames, src_channels) {}
   ~ResampleConverter() override {};
 
   void Convert(const float* const* src, size_t src_size, float* const* dst,
                size_t dst_capacity) override {
     CheckSizes(src_size, dst_capacity);
-    for (size_t i = 0; i < resamplers_.size(); ++i)
-      resamplers_[i]->Resample(src[i], src_frames(), dst[i], dst_frames());
+    resampler_.Resample(src, src_frames(), dst, dst_frames());
   }
 
  private:
-  ScopedVector<PushSincResampler> resamplers_;
+  MultiChannelSincResampler resampler_;
 };
 
 // Apply a vector of converters in serial, in the order given. At least two
@@ -10,35 +10,285 @@
 
 #include "webrtc/common_audio/include/audio_util.h"
 
+#include "webrtc/base/atomicops.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/typedefs.h"
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/common_audio/audio_util_avx2.h"
+#include "webrtc/common_audio/audio_util_sse2.h"
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+#include "webrtc/common_audio/audio_util_neon.h"
+#endif
+
 namespace webrtc {
+namespace {
 
-void FloatToS16(const float* src, size_t size, int16_t* dest) {
+void FloatToS16_C(const float* src, size_t size, int16_t* dest) {
   for (size_t i = 0; i < size; ++i)
     dest[i] = FloatToS16(src[i]);
 }
 
-void S16ToFloat(const int16_t* src, size_t size, float* dest) {
+void S16ToFloat_C(const int16_t* src, size_t size, float* dest) {
   for (size_t i = 0; i < size; ++i)
     dest[i] = S16ToFloat(src[i]);
 }
 
-void FloatS16ToS16(const float* src, size_t size, int16_t* dest) {
+void S16ToFloatS16_C(const int16_t* src, size_t size, float* dest) {
+  for (size_t i = 0; i < size; ++i)
+    dest[i] = S16ToFloatS16(src[i]);
+}
+
+void FloatS16ToS16_C(const float* src, size_t size, int16_t* dest) {
   for (size_t i = 0; i < size; ++i)
     dest[i] = FloatS16ToS16(src[i]);
 }
 
-void FloatToFloatS16(const float* src, size_t size, float* dest) {
+void FloatToFloatS16_C(const float* src, size_t size, float* dest) {
   for (size_t i = 0; i < size; ++i)
     dest[i] = FloatToFloatS16(src[i]);
 }
 
-void FloatS16ToFloat(const float* src, size_t size, float* dest) {
+void FloatS16ToFloat_C(const float* src, size_t size, float* dest) {
   for (size_t i = 0; i < size; ++i)
     dest[i] = FloatS16ToFloat(src[i]);
 }
 
+template <typename T>
+void DeinterleaveStereo_C(const T* interleaved,
+                          size_t samples_per_channel,
+                          T* left,
+                          T* right) {
+  T* const deinterleaved[] = {left, right};
+  DeinterleaveImpl(interleaved, samples_per_channel, 2, deinterleaved);
+}
+
+template <typename T>
+void InterleaveStereo_C(const T* left,
+                        const T* right,
+                        size_t samples_per_channel,
+                        T* interleaved) {
+  const T* const deinterleaved[] = {left, right};
+  InterleaveImpl(deinterleaved, samples_per_channel, 2, interleaved);
+}
+
+inline float DownmixFrame(const float* const* input_channels,
+                          size_t i,
+                          int num_channels) {
+  float value = input_channels[0][i];
+  for (int j = 1; j < num_channels; ++j) {
+    value += input_channels[j][i];
+  }
+  return value / num_channels;
+}
+
+void DownmixToMono_C(const float* const* input_channels,
+                     size_t num_frames,
+                     int num_channels,
+                     float* out) {
+  for (size_t i = 0; i < num_frames; ++i)
+    out[i] = DownmixFrame(input_channels, i, num_channels);
+}
+
+void DownmixToMonoFloatS16_C(const float* const* input_channels,
+                             size_t num_frames,
+                             int num_channels,
+                             float* out) {
+  for (size_t i = 0; i < num_frames; ++i)
+    out[i] = FloatToFloatS16(DownmixFrame(input_channels, i, num_channels));
+}
+
+// The array functions for one instruction set.
+struct Kernels {
+  void (*float_to_s16)(const float*, size_t, int16_t*);
+  void (*s16_to_float)(const int16_t*, size_t, float*);
+  void (*s16_to_float_s16)(const int16_t*, size_t, float*);
+  void (*float_s16_to_s16)(const float*, size_t, int16_t*);
+  void (*float_to_float_s16)(const float*, size_t, float*);
+  void (*float_s16_to_float)(const float*, size_t, float*);
+  void (*deinterleave_stereo_float)(const float*, size_t, float*, float*);
+  void (*deinterleave_stereo_s16)(const int16_t*, size_t, int16_t*, int16_t*);
+  void (*interleave_stereo_float)(const float*, const float*, size_t, float*);
+  void (*interleave_stereo_s16)(const int16_t*,
+                                const int16_t*,
+                                size_t,
+                                int16_t*);
+  void (*downmix_to_mono)(const float* const*, size_t, int, float*);
+  void (*downmix_to_mono_float_s16)(const float* const*, size_t, int, float*);
+};
+
+const Kernels kKernelsC = {
+    FloatToS16_C,           S16ToFloat_C,
+    S16ToFloatS16_C,        FloatS16ToS16_C,
+    FloatToFloatS16_C,      FloatS16ToFloat_C,
+    DeinterleaveStereo_C,   DeinterleaveStereo_C,
+    InterleaveStereo_C,     InterleaveStereo_C,
+    DownmixToMono_C,        DownmixToMonoFloatS16_C,
+};
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+const Kernels kKernelsSSE2 = {
+    FloatToS16_SSE2,         S16ToFloat_SSE2,
+    S16ToFloatS16_SSE2,      FloatS16ToS16_SSE2,
+    FloatToFloatS16_SSE2,    FloatS16ToFloat_SSE2,
+    DeinterleaveStereo_SSE2, DeinterleaveStereo_SSE2,
+    InterleaveStereo_SSE2,   InterleaveStereo_SSE2,
+    DownmixToMono_SSE2,      DownmixToMonoFloatS16_SSE2,
+};
+
+const Kernels kKernelsAVX2 = {
+    FloatToS16_AVX2,         S16ToFloat_AVX2,
+    S16ToFloatS16_AVX2,      FloatS16ToS16_AVX2,
+    FloatToFloatS16_AVX2,    FloatS16ToFloat_AVX2,
+    DeinterleaveStereo_AVX2, DeinterleaveStereo_AVX2,
+    InterleaveStereo_AVX2,   InterleaveStereo_AVX2,
+    DownmixToMono_AVX2,      DownmixToMonoFloatS16_AVX2,
+};
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+const Kernels kKernelsNEON = {
+    FloatToS16_NEON,         S16ToFloat_NEON,
+    S16ToFloatS16_NEON,      FloatS16ToS16_NEON,
+    FloatToFloatS16_NEON,    FloatS16ToFloat_NEON,
+    DeinterleaveStereo_NEON, DeinterleaveStereo_NEON,
+    InterleaveStereo_NEON,   InterleaveStereo_NEON,
+    DownmixToMono_NEON,      DownmixToMonoFloatS16_NEON,
+};
+#endif
+
+const Kernels* SelectKernels() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  // AVX2 always requires runtime detection.
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA))
+    return &kKernelsAVX2;
+  // If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(__SSE2__)
+  return &kKernelsSSE2;
+#else
+  if (WebRtc_GetCPUInfo(kSSE2))
+    return &kKernelsSSE2;
+#endif
+#elif defined(WEBRTC_HAS_NEON)
+  return &kKernelsNEON;
+#elif defined(WEBRTC_DETECT_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0)
+    return &kKernelsNEON;
+#endif
+  return &kKernelsC;
+}
+
+// Selected on first use, so the CPU is only detected once. Concurrent first
+// calls all select the same kernels.
+const Kernels* volatile g_kernels = nullptr;
+
+const Kernels& GetKernels() {
+  const Kernels* kernels = rtc::AtomicOps::AcquireLoadPtr(&g_kernels);
+  if (!kernels) {
+    kernels = SelectKernels();
+    rtc::AtomicOps::CompareAndSwapPtr(&g_kernels,
+                                      static_cast<const Kernels*>(nullptr),
+                                      kernels);
+  }
+  return *kernels;
+}
+
+}  // namespace
+
+void FloatToS16(const float* src, size_t size, int16_t* dest) {
+  GetKernels().float_to_s16(src, size, dest);
+}
+
+void S16ToFloat(const int16_t* src, size_t size, float* dest) {
+  GetKernels().s16_to_float(src, size, dest);
+}
+
+void S16ToFloatS16(const int16_t* src, size_t size, float* dest) {
+  GetKernels().s16_to_float_s16(src, size, dest);
+}
+
+void FloatS16ToS16(const float* src, size_t size, int16_t* dest) {
+  GetKernels().float_s16_to_s16(src, size, dest);
+}
+
+void FloatToFloatS16(const float* src, size_t size, float* dest) {
+  GetKernels().float_to_float_s16(src, size, dest);
+}
+
+void FloatS16ToFloat(const float* src, size_t size, float* dest) {
+  GetKernels().float_s16_to_float(src, size, dest);
+}
+
+template <>
+void Deinterleave<float>(const float* interleaved,
+                         size_t samples_per_channel,
+                         int num_channels,
+                         float* const* deinterleaved) {
+  if (num_channels == 2) {
+    GetKernels().deinterleave_stereo_float(interleaved, samples_per_channel,
+                                           deinterleaved[0], deinterleaved[1]);
+    return;
+  }
+  DeinterleaveImpl(interleaved, samples_per_channel, num_channels,
+                   deinterleaved);
+}
+
+template <>
+void Deinterleave<int16_t>(const int16_t* interleaved,
+                           size_t samples_per_channel,
+                           int num_channels,
+                           int16_t* const* deinterleaved) {
+  if (num_channels == 2) {
+    GetKernels().deinterleave_stereo_s16(interleaved, samples_per_channel,
+                                         deinterleaved[0], deinterleaved[1]);
+    return;
+  }
+  DeinterleaveImpl(interleaved, samples_per_channel, num_channels,
+                   deinterleaved);
+}
+
+template <>
+void Interleave<float>(const float* const* deinterleaved,
+                       size_t samples_per_channel,
+                       int num_channels,
+                       float* interleaved) {
+  if (num_channels == 2) {
+    GetKernels().interleave_stereo_float(deinterleaved[0], deinterleaved[1],
+                                         samples_per_channel, interleaved);
+    return;
+  }
+  InterleaveImpl(deinterleaved, samples_per_channel, num_channels,
+                 interleaved);
+}
+
+template <>
+void Interleave<int16_t>(const int16_t* const* deinterleaved,
+                         size_t samples_per_channel,
+                         int num_channels,
+                         int16_t* interleaved) {
+  if (num_channels == 2) {
+    GetKernels().interleave_stereo_s16(deinterleaved[0], deinterleaved[1],
+                                       samples_per_channel, interleaved);
+    return;
+  }
+  InterleaveImpl(deinterleaved, samples_per_channel, num_channels,
+                 interleaved);
+}
+
+template <>
+void DownmixToMono<float, float>(const float* const* input_channels,
+                                 size_t num_frames,
+                                 int num_channels,
+                                 float* out) {
+  GetKernels().downmix_to_mono(input_channels, num_frames, num_channels, out);
+}
+
+void DownmixToMonoFloatS16(const float* const* input_channels,
+                           size_t num_frames,
+                           int num_channels,
+                           float* out) {
+  GetKernels().downmix_to_mono_float_s16(input_channels, num_frames,
+                                         num_channels, out);
+}
+
 template <>
 void DownmixInterleavedToMono<int16_t>(const int16_t* interleaved,
                                        size_t num_frames,
@@ -0,0 +1,280 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/audio_util_avx2.h"
+
+#include <immintrin.h>
+
+#include "webrtc/common_audio/include/audio_util.h"
+
+// The kernels perform the same floating point operations as the scalar
+// functions in include/audio_util.h, in the same order, with the branches
+// replaced by selects. The scalar functions handle the remaining samples.
+// The 256-bit pack and unpack instructions work on each 128-bit half, so their
+// results are reordered with cross-lane permutes.
+
+namespace webrtc {
+namespace {
+
+const float kMaxInt16 = limits_int16::max();
+const float kMinInt16 = limits_int16::min();
+const float kMaxInt16Inverse = 1.f / limits_int16::max();
+const float kMinInt16Inverse = 1.f / limits_int16::min();
+
+// Returns |positive| for the lanes of |v| which are greater than zero and
+// |non_positive| for the others.
+inline __m256 SelectBySign(__m256 v, float positive, float non_positive) {
+  return _mm256_blendv_ps(_mm256_set1_ps(non_positive),
+                          _mm256_set1_ps(positive),
+                          _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ));
+}
+
+// Rounds eight FloatS16 values clamped to the int16 range to the nearest
+// integer, with ties away from zero, and truncates them to 32 bits.
+inline __m256i RoundClampedFloatS16(__m256 v) {
+  return _mm256_cvttps_epi32(_mm256_add_ps(v, SelectBySign(v, 0.5f, -0.5f)));
+}
+
+inline __m256i FloatS16ToS16x8(__m256 v) {
+  return RoundClampedFloatS16(_mm256_min_ps(
+      _mm256_max_ps(v, _mm256_set1_ps(kMinInt16)), _mm256_set1_ps(kMaxInt16)));
+}
+
+inline __m256 FloatToFloatS16x8(__m256 v) {
+  return _mm256_mul_ps(v, SelectBySign(v, kMaxInt16, -kMinInt16));
+}
+
+inline __m256 FloatS16ToFloatx8(__m256 v) {
+  return _mm256_mul_ps(v,
+                       SelectBySign(v, kMaxInt16Inverse, -kMinInt16Inverse));
+}
+
+inline __m256i FloatToS16x8(__m256 v) {
+  // Clamping to [-1, 1] makes the scaled values round to the extremes.
+  return RoundClampedFloatS16(FloatToFloatS16x8(_mm256_min_ps(
+      _mm256_max_ps(v, _mm256_set1_ps(-1.f)), _mm256_set1_ps(1.f))));
+}
+
+// Packs two vectors of eight 32-bit values with saturation into sixteen
+// 16-bit values in order.
+inline __m256i PackS16(__m256i lo, __m256i hi) {
+  return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi),
+                                  _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+inline __m256 S16ToFloatS16x8(const int16_t* src) {
+  return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))));
+}
+
+inline __m256 DownmixFramesx8(const float* const* input_channels,
+                               size_t i,
+                               int num_channels,
+                               __m256 num_channels_float) {
+  __m256 value = _mm256_loadu_ps(&input_channels[0][i]);
+  for (int j = 1; j < num_channels; ++j) {
+    value = _mm256_add_ps(value, _mm256_loadu_ps(&input_channels[j][i]));
+  }
+  return _mm256_div_ps(value, num_channels_float);
+}
+
+inline float DownmixFrame(const float* const* input_channels,
+                          size_t i,
+                          int num_channels) {
+  float value = input_channels[0][i];
+  for (int j = 1; j < num_channels; ++j) {
+    value += input_channels[j][i];
+  }
+  return value / num_channels;
+}
+
+}  // namespace
+
+void FloatToS16_AVX2(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m256i lo = FloatToS16x8(_mm256_loadu_ps(&src[i]));
+    const __m256i hi = FloatToS16x8(_mm256_loadu_ps(&src[i + 8]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[i]), PackS16(lo, hi));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatToS16(src[i]);
+}
+
+void S16ToFloat_AVX2(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm256_storeu_ps(&dest[i], FloatS16ToFloatx8(S16ToFloatS16x8(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = S16ToFloat(src[i]);
+}
+
+void S16ToFloatS16_AVX2(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm256_storeu_ps(&dest[i], S16ToFloatS16x8(&src[i]));
+  for (; i < size; ++i)
+    dest[i] = S16ToFloatS16(src[i]);
+}
+
+void FloatS16ToS16_AVX2(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m256i lo = FloatS16ToS16x8(_mm256_loadu_ps(&src[i]));
+    const __m256i hi = FloatS16ToS16x8(_mm256_loadu_ps(&src[i + 8]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[i]), PackS16(lo, hi));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToS16(src[i]);
+}
+
+void FloatToFloatS16_AVX2(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm256_storeu_ps(&dest[i], FloatToFloatS16x8(_mm256_loadu_ps(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatToFloatS16(src[i]);
+}
+
+void FloatS16ToFloat_AVX2(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm256_storeu_ps(&dest[i], FloatS16ToFloatx8(_mm256_loadu_ps(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToFloat(src[i]);
+}
+
+void DeinterleaveStereo_AVX2(const float* interleaved,
+                             size_t samples_per_channel,
+                             float* left,
+                             float* right) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    const __m256 a = _mm256_loadu_ps(&interleaved[2 * i]);
+    const __m256 b = _mm256_loadu_ps(&interleaved[2 * i + 8]);
+    // Gives samples 0, 1, 4, 5, 2, 3, 6, 7 of each channel.
+    const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm256_storeu_ps(&left[i],
+                     _mm256_castpd_ps(_mm256_permute4x64_pd(
+                         _mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+    _mm256_storeu_ps(&right[i],
+                     _mm256_castpd_ps(_mm256_permute4x64_pd(
+                         _mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void DeinterleaveStereo_AVX2(const int16_t* interleaved,
+                             size_t samples_per_channel,
+                             int16_t* left,
+                             int16_t* right) {
+  size_t i = 0;
+  for (; i + 16 <= samples_per_channel; i += 16) {
+    // Every 32-bit lane holds a left sample in its low half and a right sample
+    // in its high half.
+    const __m256i a = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(&interleaved[2 * i]));
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(&interleaved[2 * i + 16]));
+    const __m256i left_lo = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+    const __m256i left_hi = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&left[i]),
+                        PackS16(left_lo, left_hi));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(&right[i]),
+        PackS16(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16)));
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void InterleaveStereo_AVX2(const float* left,
+                           const float* right,
+                           size_t samples_per_channel,
+                           float* interleaved) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    const __m256 l = _mm256_loadu_ps(&left[i]);
+    const __m256 r = _mm256_loadu_ps(&right[i]);
+    // Frames 0, 1, 4, 5 and 2, 3, 6, 7.
+    const __m256 lo = _mm256_unpacklo_ps(l, r);
+    const __m256 hi = _mm256_unpackhi_ps(l, r);
+    _mm256_storeu_ps(&interleaved[2 * i], _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(&interleaved[2 * i + 8],
+                     _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void InterleaveStereo_AVX2(const int16_t* left,
+                           const int16_t* right,
+                           size_t samples_per_channel,
+                           int16_t* interleaved) {
+  size_t i = 0;
+  for (; i + 16 <= samples_per_channel; i += 16) {
+    const __m256i l =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&left[i]));
+    const __m256i r =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&right[i]));
+    // Frames 0-3, 8-11 and 4-7, 12-15.
+    const __m256i lo = _mm256_unpacklo_epi16(l, r);
+    const __m256i hi = _mm256_unpackhi_epi16(l, r);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&interleaved[2 * i]),
+                        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&interleaved[2 * i + 16]),
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void DownmixToMono_AVX2(const float* const* input_channels,
+                        size_t num_frames,
+                        int num_channels,
+                        float* out) {
+  const __m256 num_channels_float =
+      _mm256_set1_ps(static_cast<float>(num_channels));
+  size_t i = 0;
+  for (; i + 8 <= num_frames; i += 8) {
+    _mm256_storeu_ps(&out[i], DownmixFramesx8(input_channels, i, num_channels,
+                                              num_channels_float));
+  }
+  for (; i < num_frames; ++i)
+    out[i] = DownmixFrame(input_channels, i, num_channels);
+}
+
+void DownmixToMonoFloatS16_AVX2(const float* const* input_channels,
+                                size_t num_frames,
+                                int num_channels,
+                                float* out) {
+  const __m256 num_channels_float =
+      _mm256_set1_ps(static_cast<float>(num_channels));
+  size_t i = 0;
+  for (; i + 8 <= num_frames; i += 8) {
+    _mm256_storeu_ps(&out[i],
+                     FloatToFloatS16x8(DownmixFramesx8(
+                         input_channels, i, num_channels, num_channels_float)));
+  }
+  for (; i < num_frames; ++i)
+    out[i] = FloatToFloatS16(DownmixFrame(input_channels, i, num_channels));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/audio_util_neon.h"
+
+#include <arm_neon.h>
+
+#include "webrtc/common_audio/include/audio_util.h"
+
+// The kernels perform the same floating point operations as the scalar
+// functions in include/audio_util.h, in the same order, with the branches
+// replaced by selects. The scalar functions handle the remaining samples.
+
+namespace webrtc {
+namespace {
+
+const float kMaxInt16 = limits_int16::max();
+const float kMinInt16 = limits_int16::min();
+const float kMaxInt16Inverse = 1.f / limits_int16::max();
+const float kMinInt16Inverse = 1.f / limits_int16::min();
+
+// Returns |positive| for the lanes of |v| which are greater than zero and
+// |non_positive| for the others.
+inline float32x4_t SelectBySign(float32x4_t v,
+                                float positive,
+                                float non_positive) {
+  return vbslq_f32(vcgtq_f32(v, vdupq_n_f32(0.f)), vdupq_n_f32(positive),
+                   vdupq_n_f32(non_positive));
+}
+
+// Rounds four FloatS16 values clamped to the int16 range to the nearest
+// integer, with ties away from zero, and truncates them to 32 bits.
+inline int32x4_t RoundClampedFloatS16(float32x4_t v) {
+  return vcvtq_s32_f32(vaddq_f32(v, SelectBySign(v, 0.5f, -0.5f)));
+}
+
+inline int32x4_t FloatS16ToS16x4(float32x4_t v) {
+  return RoundClampedFloatS16(vminq_f32(vmaxq_f32(v, vdupq_n_f32(kMinInt16)),
+                                        vdupq_n_f32(kMaxInt16)));
+}
+
+inline float32x4_t FloatToFloatS16x4(float32x4_t v) {
+  return vmulq_f32(v, SelectBySign(v, kMaxInt16, -kMinInt16));
+}
+
+inline float32x4_t FloatS16ToFloatx4(float32x4_t v) {
+  return vmulq_f32(v, SelectBySign(v, kMaxInt16Inverse, -kMinInt16Inverse));
+}
+
+inline int32x4_t FloatToS16x4(float32x4_t v) {
+  // Clamping to [-1, 1] makes the scaled values round to the extremes.
+  return RoundClampedFloatS16(FloatToFloatS16x4(
+      vminq_f32(vmaxq_f32(v, vdupq_n_f32(-1.f)), vdupq_n_f32(1.f))));
+}
+
+inline float32x4_t S16ToFloatS16Lo(int16x8_t v) {
+  return vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+}
+
+inline float32x4_t S16ToFloatS16Hi(int16x8_t v) {
+  return vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+
+inline float DownmixFrame(const float* const* input_channels,
+                          size_t i,
+                          int num_channels) {
+  float value = input_channels[0][i];
+  for (int j = 1; j < num_channels; ++j) {
+    value += input_channels[j][i];
+  }
+  return value / num_channels;
+}
+
+// ARMv7 has no vector division, and multiplying by the reciprocal is only
+// exact when |num_channels| is a power of two.
+inline bool CanDownmixWithVectors(int num_channels) {
+#if defined(WEBRTC_ARCH_ARM64)
+  return true;
+#else
+  return (num_channels & (num_channels - 1)) == 0;
+#endif
+}
+
+inline float32x4_t DownmixFramesx4(const float* const* input_channels,
+                                   size_t i,
+                                   int num_channels) {
+  float32x4_t value = vld1q_f32(&input_channels[0][i]);
+  for (int j = 1; j < num_channels; ++j) {
+    value = vaddq_f32(value, vld1q_f32(&input_channels[j][i]));
+  }
+#if defined(WEBRTC_ARCH_ARM64)
+  return vdivq_f32(value, vdupq_n_f32(static_cast<float>(num_channels)));
+#else
+  return vmulq_n_f32(value, 1.f / num_channels);
+#endif
+}
+
+}  // namespace
+
+void FloatToS16_NEON(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const int32x4_t lo = FloatToS16x4(vld1q_f32(&src[i]));
+    const int32x4_t hi = FloatToS16x4(vld1q_f32(&src[i + 4]));
+    vst1q_s16(&dest[i], vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatToS16(src[i]);
+}
+
+void S16ToFloat_NEON(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const int16x8_t v = vld1q_s16(&src[i]);
+    vst1q_f32(&dest[i], FloatS16ToFloatx4(S16ToFloatS16Lo(v)));
+    vst1q_f32(&dest[i + 4], FloatS16ToFloatx4(S16ToFloatS16Hi(v)));
+  }
+  for (; i < size; ++i)
+    dest[i] = S16ToFloat(src[i]);
+}
+
+void S16ToFloatS16_NEON(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const int16x8_t v = vld1q_s16(&src[i]);
+    vst1q_f32(&dest[i], S16ToFloatS16Lo(v));
+    vst1q_f32(&dest[i + 4], S16ToFloatS16Hi(v));
+  }
+  for (; i < size; ++i)
+    dest[i] = S16ToFloatS16(src[i]);
+}
+
+void FloatS16ToS16_NEON(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const int32x4_t lo = FloatS16ToS16x4(vld1q_f32(&src[i]));
+    const int32x4_t hi = FloatS16ToS16x4(vld1q_f32(&src[i + 4]));
+    vst1q_s16(&dest[i], vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToS16(src[i]);
+}
+
+void FloatToFloatS16_NEON(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    vst1q_f32(&dest[i], FloatToFloatS16x4(vld1q_f32(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatToFloatS16(src[i]);
+}
+
+void FloatS16ToFloat_NEON(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    vst1q_f32(&dest[i], FloatS16ToFloatx4(vld1q_f32(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToFloat(src[i]);
+}
+
+void DeinterleaveStereo_NEON(const float* interleaved,
+                             size_t samples_per_channel,
+                             float* left,
+                             float* right) {
+  size_t i = 0;
+  for (; i + 4 <= samples_per_channel; i += 4) {
+    const float32x4x2_t v = vld2q_f32(&interleaved[2 * i]);
+    vst1q_f32(&left[i], v.val[0]);
+    vst1q_f32(&right[i], v.val[1]);
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void DeinterleaveStereo_NEON(const int16_t* interleaved,
+                             size_t samples_per_channel,
+                             int16_t* left,
+                             int16_t* right) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    const int16x8x2_t v = vld2q_s16(&interleaved[2 * i]);
+    vst1q_s16(&left[i], v.val[0]);
+    vst1q_s16(&right[i], v.val[1]);
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void InterleaveStereo_NEON(const float* left,
+                           const float* right,
+                           size_t samples_per_channel,
+                           float* interleaved) {
+  size_t i = 0;
+  for (; i + 4 <= samples_per_channel; i += 4) {
+    float32x4x2_t v;
+    v.val[0] = vld1q_f32(&left[i]);
+    v.val[1] = vld1q_f32(&right[i]);
+    vst2q_f32(&interleaved[2 * i], v);
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void InterleaveStereo_NEON(const int16_t* left,
+                           const int16_t* right,
+                           size_t samples_per_channel,
+                           int16_t* interleaved) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    int16x8x2_t v;
+    v.val[0] = vld1q_s16(&left[i]);
+    v.val[1] = vld1q_s16(&right[i]);
+    vst2q_s16(&interleaved[2 * i], v);
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void DownmixToMono_NEON(const float* const* input_channels,
+                        size_t num_frames,
+                        int num_channels,
+                        float* out) {
+  size_t i = 0;
+  if (CanDownmixWithVectors(num_channels)) {
+    for (; i + 4 <= num_frames; i += 4)
+      vst1q_f32(&out[i], DownmixFramesx4(input_channels, i, num_channels));
+  }
+  for (; i < num_frames; ++i)
+    out[i] = DownmixFrame(input_channels, i, num_channels);
+}
+
+void DownmixToMonoFloatS16_NEON(const float* const* input_channels,
+                                size_t num_frames,
+                                int num_channels,
+                                float* out) {
+  size_t i = 0;
+  if (CanDownmixWithVectors(num_channels)) {
+    for (; i + 4 <= num_frames; i += 4) {
+      vst1q_f32(&out[i], FloatToFloatS16x4(DownmixFramesx4(
+                             input_channels, i, num_channels)));
+    }
+  }
+  for (; i < num_frames; ++i)
+    out[i] = FloatToFloatS16(DownmixFrame(input_channels, i, num_channels));
+}
+
+}  // namespace webrtc
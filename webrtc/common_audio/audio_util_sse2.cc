@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/audio_util_sse2.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/common_audio/include/audio_util.h"
+
+// The kernels perform the same floating point operations as the scalar
+// functions in include/audio_util.h, in the same order, with the branches
+// replaced by selects. The scalar functions handle the remaining samples.
+
+namespace webrtc {
+namespace {
+
+const float kMaxInt16 = limits_int16::max();
+const float kMinInt16 = limits_int16::min();
+const float kMaxInt16Inverse = 1.f / limits_int16::max();
+const float kMinInt16Inverse = 1.f / limits_int16::min();
+
+// Returns |a| where |mask| is set and |b| elsewhere.
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Returns |positive| for the lanes of |v| which are greater than zero and
+// |non_positive| for the others.
+inline __m128 SelectBySign(__m128 v, float positive, float non_positive) {
+  return Select(_mm_cmpgt_ps(v, _mm_setzero_ps()), _mm_set1_ps(positive),
+                _mm_set1_ps(non_positive));
+}
+
+// Rounds four FloatS16 values clamped to the int16 range to the nearest
+// integer, with ties away from zero, and truncates them to 32 bits.
+inline __m128i RoundClampedFloatS16(__m128 v) {
+  return _mm_cvttps_epi32(_mm_add_ps(v, SelectBySign(v, 0.5f, -0.5f)));
+}
+
+inline __m128i FloatS16ToS16x4(__m128 v) {
+  return RoundClampedFloatS16(_mm_min_ps(
+      _mm_max_ps(v, _mm_set1_ps(kMinInt16)), _mm_set1_ps(kMaxInt16)));
+}
+
+inline __m128 FloatToFloatS16x4(__m128 v) {
+  return _mm_mul_ps(v, SelectBySign(v, kMaxInt16, -kMinInt16));
+}
+
+inline __m128 FloatS16ToFloatx4(__m128 v) {
+  return _mm_mul_ps(v, SelectBySign(v, kMaxInt16Inverse, -kMinInt16Inverse));
+}
+
+inline __m128i FloatToS16x4(__m128 v) {
+  // Clamping to [-1, 1] makes the scaled values round to the extremes.
+  return RoundClampedFloatS16(FloatToFloatS16x4(
+      _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f))));
+}
+
+// Sign extends the low and high halves of |v| and converts them to float.
+inline __m128 S16ToFloatS16Lo(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline __m128 S16ToFloatS16Hi(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+inline __m128 DownmixFramesx4(const float* const* input_channels,
+                               size_t i,
+                               int num_channels,
+                               __m128 num_channels_float) {
+  __m128 value = _mm_loadu_ps(&input_channels[0][i]);
+  for (int j = 1; j < num_channels; ++j) {
+    value = _mm_add_ps(value, _mm_loadu_ps(&input_channels[j][i]));
+  }
+  return _mm_div_ps(value, num_channels_float);
+}
+
+inline float DownmixFrame(const float* const* input_channels,
+                          size_t i,
+                          int num_channels) {
+  float value = input_channels[0][i];
+  for (int j = 1; j < num_channels; ++j) {
+    value += input_channels[j][i];
+  }
+  return value / num_channels;
+}
+
+}  // namespace
+
+void FloatToS16_SSE2(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i lo = FloatToS16x4(_mm_loadu_ps(&src[i]));
+    const __m128i hi = FloatToS16x4(_mm_loadu_ps(&src[i + 4]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i]),
+                     _mm_packs_epi32(lo, hi));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatToS16(src[i]);
+}
+
+void S16ToFloat_SSE2(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+    _mm_storeu_ps(&dest[i], FloatS16ToFloatx4(S16ToFloatS16Lo(v)));
+    _mm_storeu_ps(&dest[i + 4], FloatS16ToFloatx4(S16ToFloatS16Hi(v)));
+  }
+  for (; i < size; ++i)
+    dest[i] = S16ToFloat(src[i]);
+}
+
+void S16ToFloatS16_SSE2(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+    _mm_storeu_ps(&dest[i], S16ToFloatS16Lo(v));
+    _mm_storeu_ps(&dest[i + 4], S16ToFloatS16Hi(v));
+  }
+  for (; i < size; ++i)
+    dest[i] = S16ToFloatS16(src[i]);
+}
+
+void FloatS16ToS16_SSE2(const float* src, size_t size, int16_t* dest) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i lo = FloatS16ToS16x4(_mm_loadu_ps(&src[i]));
+    const __m128i hi = FloatS16ToS16x4(_mm_loadu_ps(&src[i + 4]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i]),
+                     _mm_packs_epi32(lo, hi));
+  }
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToS16(src[i]);
+}
+
+void FloatToFloatS16_SSE2(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm_storeu_ps(&dest[i], FloatToFloatS16x4(_mm_loadu_ps(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatToFloatS16(src[i]);
+}
+
+void FloatS16ToFloat_SSE2(const float* src, size_t size, float* dest) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm_storeu_ps(&dest[i], FloatS16ToFloatx4(_mm_loadu_ps(&src[i])));
+  for (; i < size; ++i)
+    dest[i] = FloatS16ToFloat(src[i]);
+}
+
+void DeinterleaveStereo_SSE2(const float* interleaved,
+                             size_t samples_per_channel,
+                             float* left,
+                             float* right) {
+  size_t i = 0;
+  for (; i + 4 <= samples_per_channel; i += 4) {
+    const __m128 a = _mm_loadu_ps(&interleaved[2 * i]);
+    const __m128 b = _mm_loadu_ps(&interleaved[2 * i + 4]);
+    _mm_storeu_ps(&left[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(&right[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void DeinterleaveStereo_SSE2(const int16_t* interleaved,
+                             size_t samples_per_channel,
+                             int16_t* left,
+                             int16_t* right) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    // Every 32-bit lane holds a left sample in its low half and a right sample
+    // in its high half.
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&interleaved[2 * i]));
+    const __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&interleaved[2 * i + 8]));
+    const __m128i left_lo = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    const __m128i left_hi = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&left[i]),
+                     _mm_packs_epi32(left_lo, left_hi));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(&right[i]),
+        _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16)));
+  }
+  for (; i < samples_per_channel; ++i) {
+    left[i] = interleaved[2 * i];
+    right[i] = interleaved[2 * i + 1];
+  }
+}
+
+void InterleaveStereo_SSE2(const float* left,
+                           const float* right,
+                           size_t samples_per_channel,
+                           float* interleaved) {
+  size_t i = 0;
+  for (; i + 4 <= samples_per_channel; i += 4) {
+    const __m128 l = _mm_loadu_ps(&left[i]);
+    const __m128 r = _mm_loadu_ps(&right[i]);
+    _mm_storeu_ps(&interleaved[2 * i], _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(&interleaved[2 * i + 4], _mm_unpackhi_ps(l, r));
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void InterleaveStereo_SSE2(const int16_t* left,
+                           const int16_t* right,
+                           size_t samples_per_channel,
+                           int16_t* interleaved) {
+  size_t i = 0;
+  for (; i + 8 <= samples_per_channel; i += 8) {
+    const __m128i l =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&left[i]));
+    const __m128i r =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&right[i]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&interleaved[2 * i]),
+                     _mm_unpacklo_epi16(l, r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&interleaved[2 * i + 8]),
+                     _mm_unpackhi_epi16(l, r));
+  }
+  for (; i < samples_per_channel; ++i) {
+    interleaved[2 * i] = left[i];
+    interleaved[2 * i + 1] = right[i];
+  }
+}
+
+void DownmixToMono_SSE2(const float* const* input_channels,
+                        size_t num_frames,
+                        int num_channels,
+                        float* out) {
+  const __m128 num_channels_float =
+      _mm_set1_ps(static_cast<float>(num_channels));
+  size_t i = 0;
+  for (; i + 4 <= num_frames; i += 4) {
+    _mm_storeu_ps(&out[i], DownmixFramesx4(input_channels, i, num_channels,
+                                           num_channels_float));
+  }
+  for (; i < num_frames; ++i)
+    out[i] = DownmixFrame(input_channels, i, num_channels);
+}
+
+void DownmixToMonoFloatS16_SSE2(const float* const* input_channels,
+                                size_t num_frames,
+                                int num_channels,
+                                float* out) {
+  const __m128 num_channels_float =
+      _mm_set1_ps(static_cast<float>(num_channels));
+  size_t i = 0;
+  for (; i + 4 <= num_frames; i += 4) {
+    _mm_storeu_ps(&out[i],
+                  FloatToFloatS16x4(DownmixFramesx4(
+                      input_channels, i, num_channels, num_channels_float)));
+  }
+  for (; i < num_frames; ++i)
+    out[i] = FloatToFloatS16(DownmixFrame(input_channels, i, num_channels));
+}
+
+}  // namespace webrtc
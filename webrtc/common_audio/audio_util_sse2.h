@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_AUDIO_AUDIO_UTIL_SSE2_H_
+#define WEBRTC_COMMON_AUDIO_AUDIO_UTIL_SSE2_H_
+
+#include <stddef.h>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// SSE2 versions of the functions in include/audio_util.h, which dispatches to
+// them. Their output is identical to that of the scalar versions. There are no
+// alignment requirements.
+
+void FloatToS16_SSE2(const float* src, size_t size, int16_t* dest);
+void S16ToFloat_SSE2(const int16_t* src, size_t size, float* dest);
+void S16ToFloatS16_SSE2(const int16_t* src, size_t size, float* dest);
+void FloatS16ToS16_SSE2(const float* src, size_t size, int16_t* dest);
+void FloatToFloatS16_SSE2(const float* src, size_t size, float* dest);
+void FloatS16ToFloat_SSE2(const float* src, size_t size, float* dest);
+
+void DeinterleaveStereo_SSE2(const float* interleaved,
+                             size_t samples_per_channel,
+                             float* left,
+                             float* right);
+void DeinterleaveStereo_SSE2(const int16_t* interleaved,
+                             size_t samples_per_channel,
+                             int16_t* left,
+                             int16_t* right);
+void InterleaveStereo_SSE2(const float* left,
+                           const float* right,
+                           size_t samples_per_channel,
+                           float* interleaved);
+void InterleaveStereo_SSE2(const int16_t* left,
+                           const int16_t* right,
+                           size_t samples_per_channel,
+                           int16_t* interleaved);
+
+void DownmixToMono_SSE2(const float* const* input_channels,
+                        size_t num_frames,
+                        int num_channels,
+                        float* out);
+void DownmixToMonoFloatS16_SSE2(const float* const* input_channels,
+                                size_t num_frames,
+                                int num_channels,
+                                float* out);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_AUDIO_AUDIO_UTIL_SSE2_H_
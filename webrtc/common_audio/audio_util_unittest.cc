@@ -8,11 +8,24 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/common_audio/include/audio_util.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/typedefs.h"
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/common_audio/audio_util_avx2.h"
+#include "webrtc/common_audio/audio_util_sse2.h"
+#endif
+
 namespace webrtc {
 namespace {
 
@@ -227,5 +240,340 @@ TEST(AudioUtilTest, DownmixToMonoTest) {
   }
 }
 
+// Returns values covering the whole float range, with an emphasis on the
+// rounding boundaries of the int16 range, scaled by |scale|.
+std::vector<float> CreateConversionInput(float scale) {
+  std::vector<float> values;
+  const float kSpecialValues[] = {0.f, -0.f, 1e-40f, -1e-40f, 1e-10f, -1e-10f,
+                                  1e10f, -1e10f, 1e38f, -1e38f};
+  for (float value : kSpecialValues) {
+    values.push_back(value);
+  }
+  for (int i = -33000; i <= 33000; ++i) {
+    const float half = i + 0.5f;
+    values.push_back(i * scale);
+    values.push_back(half * scale);
+    values.push_back(nextafterf(half, 0.f) * scale);
+    values.push_back(nextafterf(half, 2.f * half) * scale);
+  }
+  return values;
+}
+
+// The SIMD versions process a few samples at a time. Vary the length and
+// alignment to exercise the scalar tail loops too.
+const size_t kOffsets[] = {0, 1, 3};
+
+template <typename T>
+void DeinterleaveStereo(const T* interleaved,
+                        size_t samples_per_channel,
+                        T* left,
+                        T* right) {
+  T* const deinterleaved[] = {left, right};
+  Deinterleave(interleaved, samples_per_channel, 2, deinterleaved);
+}
+
+template <typename T>
+void InterleaveStereo(const T* left,
+                      const T* right,
+                      size_t samples_per_channel,
+                      T* interleaved) {
+  const T* const deinterleaved[] = {left, right};
+  Interleave(deinterleaved, samples_per_channel, 2, interleaved);
+}
+
+// The array functions of one implementation.
+struct ArrayFunctions {
+  const char* name;
+  void (*float_to_s16)(const float*, size_t, int16_t*);
+  void (*s16_to_float)(const int16_t*, size_t, float*);
+  void (*s16_to_float_s16)(const int16_t*, size_t, float*);
+  void (*float_s16_to_s16)(const float*, size_t, int16_t*);
+  void (*float_to_float_s16)(const float*, size_t, float*);
+  void (*float_s16_to_float)(const float*, size_t, float*);
+  void (*deinterleave_stereo_float)(const float*, size_t, float*, float*);
+  void (*deinterleave_stereo_s16)(const int16_t*, size_t, int16_t*, int16_t*);
+  void (*interleave_stereo_float)(const float*, const float*, size_t, float*);
+  void (*interleave_stereo_s16)(const int16_t*,
+                                const int16_t*,
+                                size_t,
+                                int16_t*);
+  void (*downmix_to_mono)(const float* const*, size_t, int, float*);
+  void (*downmix_to_mono_float_s16)(const float* const*, size_t, int, float*);
+};
+
+// Returns the public functions, which dispatch to the kernels for this CPU,
+// and the kernels for each instruction set the CPU supports. The public
+// functions alone would only test one set of kernels.
+std::vector<ArrayFunctions> GetArrayFunctions() {
+  std::vector<ArrayFunctions> functions;
+  functions.push_back({"Dispatch", FloatToS16, S16ToFloat, S16ToFloatS16,
+                       FloatS16ToS16, FloatToFloatS16, FloatS16ToFloat,
+                       DeinterleaveStereo, DeinterleaveStereo,
+                       InterleaveStereo, InterleaveStereo,
+                       DownmixToMono<float, float>, DownmixToMonoFloatS16});
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    functions.push_back(
+        {"SSE2", FloatToS16_SSE2, S16ToFloat_SSE2, S16ToFloatS16_SSE2,
+         FloatS16ToS16_SSE2, FloatToFloatS16_SSE2, FloatS16ToFloat_SSE2,
+         DeinterleaveStereo_SSE2, DeinterleaveStereo_SSE2,
+         InterleaveStereo_SSE2, InterleaveStereo_SSE2, DownmixToMono_SSE2,
+         DownmixToMonoFloatS16_SSE2});
+  }
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    functions.push_back(
+        {"AVX2", FloatToS16_AVX2, S16ToFloat_AVX2, S16ToFloatS16_AVX2,
+         FloatS16ToS16_AVX2, FloatToFloatS16_AVX2, FloatS16ToFloat_AVX2,
+         DeinterleaveStereo_AVX2, DeinterleaveStereo_AVX2,
+         InterleaveStereo_AVX2, InterleaveStereo_AVX2, DownmixToMono_AVX2,
+         DownmixToMonoFloatS16_AVX2});
+  }
+#endif
+  return functions;
+}
+
+TEST(AudioUtilTest, ArrayConversionsFromS16MatchPerSampleVersions) {
+  std::vector<int16_t> input;
+  for (int i = limits_int16::min(); i <= limits_int16::max(); ++i) {
+    input.push_back(static_cast<int16_t>(i));
+  }
+  std::vector<float> output(input.size());
+  for (const ArrayFunctions& functions : GetArrayFunctions()) {
+    SCOPED_TRACE(functions.name);
+    for (size_t offset : kOffsets) {
+      SCOPED_TRACE(offset);
+      const size_t size = input.size() - offset;
+      functions.s16_to_float(&input[offset], size, &output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(S16ToFloat(input[offset + i]), output[i])
+            << input[offset + i];
+      }
+      functions.s16_to_float_s16(&input[offset], size, &output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(S16ToFloatS16(input[offset + i]), output[i])
+            << input[offset + i];
+      }
+    }
+  }
+}
+
+TEST(AudioUtilTest, ArrayConversionsFromFloatMatchPerSampleVersions) {
+  const std::vector<float> float_input = CreateConversionInput(1.f / 32768.f);
+  const std::vector<float> float_s16_input = CreateConversionInput(1.f);
+  std::vector<int16_t> s16_output(float_input.size());
+  std::vector<float> float_output(float_input.size());
+  for (const ArrayFunctions& functions : GetArrayFunctions()) {
+    SCOPED_TRACE(functions.name);
+    for (size_t offset : kOffsets) {
+      SCOPED_TRACE(offset);
+      const size_t size = float_input.size() - offset;
+      functions.float_to_s16(&float_input[offset], size, &s16_output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(FloatToS16(float_input[offset + i]), s16_output[i])
+            << float_input[offset + i];
+      }
+      functions.float_to_float_s16(&float_input[offset], size,
+                                   &float_output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(FloatToFloatS16(float_input[offset + i]), float_output[i])
+            << float_input[offset + i];
+      }
+      functions.float_s16_to_s16(&float_s16_input[offset], size,
+                                 &s16_output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(FloatS16ToS16(float_s16_input[offset + i]), s16_output[i])
+            << float_s16_input[offset + i];
+      }
+      functions.float_s16_to_float(&float_s16_input[offset], size,
+                                   &float_output[0]);
+      for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(FloatS16ToFloat(float_s16_input[offset + i]),
+                  float_output[i])
+            << float_s16_input[offset + i];
+      }
+    }
+  }
+}
+
+template <typename T>
+void VerifyInterleavingMatchesGenericVersion() {
+  const int kMaxNumChannels = 3;
+  const size_t kMaxSamplesPerChannel = 37;
+  std::vector<T> interleaved(kMaxNumChannels * kMaxSamplesPerChannel);
+  for (size_t i = 0; i < interleaved.size(); ++i) {
+    interleaved[i] = static_cast<T>(i * 7 - 100);
+  }
+  std::vector<T> channel_data(kMaxNumChannels * kMaxSamplesPerChannel);
+  std::vector<T> reference_data(kMaxNumChannels * kMaxSamplesPerChannel);
+  std::vector<T> output(kMaxNumChannels * kMaxSamplesPerChannel);
+  std::vector<T> reference_output(kMaxNumChannels * kMaxSamplesPerChannel);
+  for (int num_channels = 1; num_channels <= kMaxNumChannels; ++num_channels) {
+    for (size_t samples_per_channel = 0;
+         samples_per_channel <= kMaxSamplesPerChannel; ++samples_per_channel) {
+      T* channels[kMaxNumChannels];
+      T* reference_channels[kMaxNumChannels];
+      for (int i = 0; i < num_channels; ++i) {
+        channels[i] = &channel_data[i * samples_per_channel];
+        reference_channels[i] = &reference_data[i * samples_per_channel];
+      }
+      const size_t size = num_channels * samples_per_channel;
+      Deinterleave(&interleaved[0], samples_per_channel, num_channels,
+                   channels);
+      DeinterleaveImpl(&interleaved[0], samples_per_channel, num_channels,
+                       reference_channels);
+      EXPECT_TRUE(std::equal(reference_data.begin(),
+                             reference_data.begin() + size,
+                             channel_data.begin()));
+      Interleave(channels, samples_per_channel, num_channels, &output[0]);
+      InterleaveImpl(channels, samples_per_channel, num_channels,
+                     &reference_output[0]);
+      EXPECT_TRUE(std::equal(reference_output.begin(),
+                             reference_output.begin() + size,
+                             output.begin()));
+      EXPECT_TRUE(std::equal(interleaved.begin(), interleaved.begin() + size,
+                             output.begin()));
+    }
+  }
+}
+
+TEST(AudioUtilTest, InterleavingMatchesGenericVersion) {
+  VerifyInterleavingMatchesGenericVersion<float>();
+  VerifyInterleavingMatchesGenericVersion<int16_t>();
+}
+
+template <typename T>
+void VerifyStereoInterleavingMatchesGenericVersion(
+    void (*deinterleave)(const T*, size_t, T*, T*),
+    void (*interleave)(const T*, const T*, size_t, T*)) {
+  const size_t kMaxSamplesPerChannel = 37;
+  std::vector<T> interleaved(2 * kMaxSamplesPerChannel);
+  for (size_t i = 0; i < interleaved.size(); ++i) {
+    interleaved[i] = static_cast<T>(i * 7 - 100);
+  }
+  std::vector<T> left(kMaxSamplesPerChannel);
+  std::vector<T> right(kMaxSamplesPerChannel);
+  std::vector<T> reference_data(2 * kMaxSamplesPerChannel);
+  std::vector<T> output(2 * kMaxSamplesPerChannel);
+  for (size_t samples_per_channel = 0;
+       samples_per_channel <= kMaxSamplesPerChannel; ++samples_per_channel) {
+    SCOPED_TRACE(samples_per_channel);
+    T* reference_channels[] = {&reference_data[0],
+                               &reference_data[kMaxSamplesPerChannel]};
+    deinterleave(&interleaved[0], samples_per_channel, &left[0], &right[0]);
+    DeinterleaveImpl(&interleaved[0], samples_per_channel, 2,
+                     reference_channels);
+    EXPECT_TRUE(std::equal(left.begin(), left.begin() + samples_per_channel,
+                           reference_channels[0]));
+    EXPECT_TRUE(std::equal(right.begin(), right.begin() + samples_per_channel,
+                           reference_channels[1]));
+    interleave(&left[0], &right[0], samples_per_channel, &output[0]);
+    EXPECT_TRUE(std::equal(interleaved.begin(),
+                           interleaved.begin() + 2 * samples_per_channel,
+                           output.begin()));
+  }
+}
+
+TEST(AudioUtilTest, StereoInterleavingMatchesGenericVersion) {
+  for (const ArrayFunctions& functions : GetArrayFunctions()) {
+    SCOPED_TRACE(functions.name);
+    VerifyStereoInterleavingMatchesGenericVersion(
+        functions.deinterleave_stereo_float,
+        functions.interleave_stereo_float);
+    VerifyStereoInterleavingMatchesGenericVersion(
+        functions.deinterleave_stereo_s16, functions.interleave_stereo_s16);
+  }
+}
+
+TEST(AudioUtilTest, DownmixToMonoMatchesPerSampleVersion) {
+  const int kMaxNumChannels = 6;
+  const size_t kNumFrames = 483;
+  std::vector<float> input_data(kMaxNumChannels * kNumFrames);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = sinf(0.01f * i) * (i % 3 ? 1.f : 1e-3f);
+  }
+  const float* input[kMaxNumChannels];
+  for (int i = 0; i < kMaxNumChannels; ++i) {
+    input[i] = &input_data[i * kNumFrames];
+  }
+  std::vector<float> downmixed(kNumFrames);
+  std::vector<float> downmixed_s16(kNumFrames);
+  for (const ArrayFunctions& functions : GetArrayFunctions()) {
+    SCOPED_TRACE(functions.name);
+    for (int num_channels = 1; num_channels <= kMaxNumChannels;
+         ++num_channels) {
+      SCOPED_TRACE(num_channels);
+      functions.downmix_to_mono(input, kNumFrames, num_channels,
+                                &downmixed[0]);
+      functions.downmix_to_mono_float_s16(input, kNumFrames, num_channels,
+                                          &downmixed_s16[0]);
+      for (size_t i = 0; i < kNumFrames; ++i) {
+        float value = input[0][i];
+        for (int j = 1; j < num_channels; ++j) {
+          value += input[j][i];
+        }
+        value /= num_channels;
+        ASSERT_EQ(value, downmixed[i]) << "frame " << i;
+        ASSERT_EQ(FloatToFloatS16(value), downmixed_s16[i]) << "frame " << i;
+      }
+    }
+  }
+}
+
+// Compares the array functions of each implementation with loops over the
+// per-sample functions on 10 ms of 48 kHz stereo audio.
+TEST(AudioUtilTest, DISABLED_Benchmark) {
+  const size_t kNumFrames = 480;
+  const size_t kSize = 2 * kNumFrames;
+  const int kNumIterations = 200000;
+  std::vector<float> float_data(kSize);
+  std::vector<float> float_s16_data(kSize);
+  std::vector<int16_t> s16_data(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    float_data[i] = sinf(0.01f * i);
+    float_s16_data[i] = 32767.f * float_data[i];
+  }
+  std::vector<float> float_output(kSize);
+  std::vector<int16_t> s16_output(kSize);
+  float* left_right[] = {&float_output[0], &float_output[kNumFrames]};
+  const float* const_left_right[] = {&float_data[0], &float_data[kNumFrames]};
+  int16_t* s16_left_right[] = {&s16_output[0], &s16_output[kNumFrames]};
+
+  TickTime start = TickTime::Now();
+  for (int n = 0; n < kNumIterations; ++n) {
+    for (size_t i = 0; i < kSize; ++i)
+      s16_output[i] = FloatS16ToS16(float_s16_data[i]);
+    for (size_t i = 0; i < kSize; ++i)
+      float_output[i] = S16ToFloat(s16_output[i]);
+    DeinterleaveImpl(&float_data[0], kNumFrames, 2, left_right);
+    InterleaveImpl(const_left_right, kNumFrames, 2, &float_output[0]);
+    DeinterleaveImpl(&s16_data[0], kNumFrames, 2, s16_left_right);
+    for (size_t i = 0; i < kNumFrames; ++i)
+      float_output[i] = FloatToFloatS16(
+          (const_left_right[0][i] + const_left_right[1][i]) / 2);
+  }
+  const int64_t scalar_us = (TickTime::Now() - start).Microseconds();
+  printf("Per-sample: %.3f us per 10 ms\n", scalar_us * 1.0 / kNumIterations);
+
+  for (const ArrayFunctions& functions : GetArrayFunctions()) {
+    start = TickTime::Now();
+    for (int n = 0; n < kNumIterations; ++n) {
+      functions.float_s16_to_s16(&float_s16_data[0], kSize, &s16_output[0]);
+      functions.s16_to_float(&s16_output[0], kSize, &float_output[0]);
+      functions.deinterleave_stereo_float(&float_data[0], kNumFrames,
+                                          left_right[0], left_right[1]);
+      functions.interleave_stereo_float(const_left_right[0],
+                                        const_left_right[1], kNumFrames,
+                                        &float_output[0]);
+      functions.deinterleave_stereo_s16(&s16_data[0], kNumFrames,
+                                        s16_left_right[0], s16_left_right[1]);
+      functions.downmix_to_mono_float_s16(const_left_right, kNumFrames, 2,
+                                          &float_output[0]);
+    }
+    const int64_t array_us = (TickTime::Now() - start).Microseconds();
+    printf("%s: %.3f us per 10 ms (%.2fx)\n", functions.name,
+           array_us * 1.0 / kNumIterations, scalar_us * 1.0 / array_us);
+  }
+}
+
 }  // namespace
 }  // namespace webrtc
@@ -15,11 +15,23 @@ namespace webrtc {
 IFChannelBuffer::IFChannelBuffer(size_t num_frames,
                                  int num_channels,
                                  size_t num_bands)
-    : ivalid_(true),
+    : num_converted_samples_(0),
+      ivalid_(true),
       ibuf_(num_frames, num_channels, num_bands),
       fvalid_(true),
       fbuf_(num_frames, num_channels, num_bands) {}
 
+IFChannelBuffer::IFChannelBuffer(size_t num_frames,
+                                 int num_channels,
+                                 size_t num_bands,
+                                 int16_t* int_data,
+                                 float* float_data)
+    : num_converted_samples_(0),
+      ivalid_(true),
+      ibuf_(num_frames, num_channels, num_bands, int_data),
+      fvalid_(true),
+      fbuf_(num_frames, num_channels, num_bands, float_data) {}
+
 ChannelBuffer<int16_t>* IFChannelBuffer::ibuf() {
   RefreshI();
   fvalid_ = false;
@@ -32,6 +44,18 @@ ChannelBuffer<float>* IFChannelBuffer::fbuf() {
   return &fbuf_;
 }
 
+ChannelBuffer<int16_t>* IFChannelBuffer::ibuf_for_overwrite() {
+  ivalid_ = true;
+  fvalid_ = false;
+  return &ibuf_;
+}
+
+ChannelBuffer<float>* IFChannelBuffer::fbuf_for_overwrite() {
+  fvalid_ = true;
+  ivalid_ = false;
+  return &fbuf_;
+}
+
 const ChannelBuffer<int16_t>* IFChannelBuffer::ibuf_const() const {
   RefreshI();
   return &ibuf_;
@@ -52,6 +76,7 @@ void IFChannelBuffer::RefreshF() const {
         float_channels[i][j] = int_channels[i][j];
       }
     }
+    num_converted_samples_ += ibuf_.size();
     fvalid_ = true;
   }
 }
@@ -66,6 +91,7 @@ void IFChannelBuffer::RefreshI() const {
                     ibuf_.num_frames(),
                     int_channels[i]);
     }
+    num_converted_samples_ += ibuf_.size();
     ivalid_ = true;
   }
 }
@@ -42,20 +42,33 @@ class ChannelBuffer {
   ChannelBuffer(size_t num_frames,
                 int num_channels,
                 size_t num_bands = 1)
-      : data_(new T[num_frames * num_channels]()),
+      : owned_data_(new T[num_frames * num_channels]()),
+        data_(owned_data_.get()),
         channels_(new T*[num_channels * num_bands]),
         bands_(new T*[num_channels * num_bands]),
         num_frames_(num_frames),
         num_frames_per_band_(num_frames / num_bands),
         num_channels_(num_channels),
         num_bands_(num_bands) {
-    for (int i = 0; i < num_channels_; ++i) {
-      for (size_t j = 0; j < num_bands_; ++j) {
-        channels_[j * num_channels_ + i] =
-            &data_[i * num_frames_ + j * num_frames_per_band_];
-        bands_[i * num_bands_ + j] = channels_[j * num_channels_ + i];
-      }
-    }
+    InitPointers();
+  }
+
+  // Uses |data| as storage, which must hold |num_frames| * |num_channels|
+  // elements and outlive the ChannelBuffer. Lets a user with many buffers
+  // place them in a single allocation. |data| is used as is, not zeroed.
+  ChannelBuffer(size_t num_frames,
+                int num_channels,
+                size_t num_bands,
+                T* data)
+      : data_(data),
+        channels_(new T*[num_channels * num_bands]),
+        bands_(new T*[num_channels * num_bands]),
+        num_frames_(num_frames),
+        num_frames_per_band_(num_frames / num_bands),
+        num_channels_(num_channels),
+        num_bands_(num_bands) {
+    DCHECK(data);
+    InitPointers();
   }
 
   // Returns a pointer array to the full-band channels (or lower band channels).
@@ -121,11 +134,23 @@ class ChannelBuffer {
 
   void SetDataForTesting(const T* data, size_t size) {
     CHECK_EQ(size, this->size());
-    memcpy(data_.get(), data, size * sizeof(*data));
+    memcpy(data_, data, size * sizeof(*data));
   }
 
  private:
-  rtc::scoped_ptr<T[]> data_;
+  void InitPointers() {
+    for (int i = 0; i < num_channels_; ++i) {
+      for (size_t j = 0; j < num_bands_; ++j) {
+        channels_[j * num_channels_ + i] =
+            &data_[i * num_frames_ + j * num_frames_per_band_];
+        bands_[i * num_bands_ + j] = channels_[j * num_channels_ + i];
+      }
+    }
+  }
+
+  // Null if the storage is provided by the user.
+  rtc::scoped_ptr<T[]> owned_data_;
+  T* const data_;
   rtc::scoped_ptr<T* []> channels_;
   rtc::scoped_ptr<T* []> bands_;
   const size_t num_frames_;
@@ -143,21 +168,39 @@ class ChannelBuffer {
 class IFChannelBuffer {
  public:
   IFChannelBuffer(size_t num_frames, int num_channels, size_t num_bands = 1);
+  // Uses |int_data| and |float_data| as storage, as the corresponding
+  // ChannelBuffer constructor. They must be zeroed by the user.
+  IFChannelBuffer(size_t num_frames,
+                  int num_channels,
+                  size_t num_bands,
+                  int16_t* int_data,
+                  float* float_data);
 
   ChannelBuffer<int16_t>* ibuf();
   ChannelBuffer<float>* fbuf();
   const ChannelBuffer<int16_t>* ibuf_const() const;
   const ChannelBuffer<float>* fbuf_const() const;
 
+  // Same as ibuf() and fbuf(), for a caller which overwrites all channels and
+  // bands: the requested ChannelBuffer is not refreshed from the other one
+  // first.
+  ChannelBuffer<int16_t>* ibuf_for_overwrite();
+  ChannelBuffer<float>* fbuf_for_overwrite();
+
   size_t num_frames() const { return ibuf_.num_frames(); }
   size_t num_frames_per_band() const { return ibuf_.num_frames_per_band(); }
   int num_channels() const { return ibuf_.num_channels(); }
   size_t num_bands() const { return ibuf_.num_bands(); }
 
+  // The number of samples converted between int16_t and float to keep the
+  // two ChannelBuffers in sync.
+  int64_t num_converted_samples() const { return num_converted_samples_; }
+
  private:
   void RefreshF() const;
   void RefreshI() const;
 
+  mutable int64_t num_converted_samples_;
   mutable bool ivalid_;
   mutable ChannelBuffer<int16_t> ibuf_;
   mutable bool fvalid_;
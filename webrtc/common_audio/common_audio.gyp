@@ -34,6 +34,9 @@
         'audio_ring_buffer.cc',
         'audio_ring_buffer.h',
         'audio_util.cc',
+        'audio_util_avx2.h',
+        'audio_util_neon.h',
+        'audio_util_sse2.h',
         'blocker.cc',
         'blocker.h',
         'channel_buffer.cc',
@@ -42,6 +45,7 @@
         'fft4g.h',
         'fir_filter.cc',
         'fir_filter.h',
+        'fir_filter_avx2.h',
         'fir_filter_neon.h',
         'fir_filter_sse.h',
         'include/audio_util.h',
@@ -51,8 +55,11 @@
         'real_fourier.h',
         'real_fourier_ooura.cc',
         'real_fourier_ooura.h',
+        'real_fourier_sse2.h',
         'resampler/include/push_resampler.h',
         'resampler/include/resampler.h',
+        'resampler/multi_channel_sinc_resampler.cc',
+        'resampler/multi_channel_sinc_resampler.h',
         'resampler/push_resampler.cc',
         'resampler/push_sinc_resampler.cc',
         'resampler/push_sinc_resampler.h',
@@ -101,6 +108,8 @@
         'signal_processing/vector_scaling_operations.c',
         'sparse_fir_filter.cc',
         'sparse_fir_filter.h',
+        'spsc_audio_ring_buffer.cc',
+        'spsc_audio_ring_buffer.h',
         'vad/include/vad.h',
         'vad/include/webrtc_vad.h',
         'vad/vad.cc',
@@ -134,7 +143,10 @@
           ],
         }],
         ['target_arch=="ia32" or target_arch=="x64"', {
-          'dependencies': ['common_audio_sse2',],
+          'dependencies': [
+            'common_audio_sse2',
+            'common_audio_avx2',
+          ],
         }],
         ['build_with_neon==1', {
           'dependencies': ['common_audio_neon',],
@@ -197,7 +209,9 @@
           'target_name': 'common_audio_sse2',
           'type': 'static_library',
           'sources': [
+            'audio_util_sse2.cc',
             'fir_filter_sse.cc',
+            'real_fourier_sse2.cc',
             'resampler/sinc_resampler_sse.cc',
           ],
           'conditions': [
@@ -209,6 +223,29 @@
             }],
           ],
         },
+        {
+          # Only used after runtime detection of AVX2 and FMA support.
+          'target_name': 'common_audio_avx2',
+          'type': 'static_library',
+          'sources': [
+            'audio_util_avx2.cc',
+            'fir_filter_avx2.cc',
+            'resampler/sinc_resampler_avx2.cc',
+          ],
+          'conditions': [
+            ['os_posix==1', {
+              'cflags': [ '-mavx2', '-mfma', ],
+              'xcode_settings': {
+                'OTHER_CFLAGS': [ '-mavx2', '-mfma', ],
+              },
+            }],
+          ],
+          'msvs_settings': {
+            'VCCLCompilerTool': {
+              'AdditionalOptions': [ '/arch:AVX2', ],
+            },
+          },
+        },
       ],  # targets
     }],
     ['build_with_neon==1', {
@@ -218,6 +255,7 @@
           'type': 'static_library',
           'includes': ['../build/arm_neon.gypi',],
           'sources': [
+            'audio_util_neon.cc',
             'fir_filter_neon.cc',
             'resampler/sinc_resampler_neon.cc',
             'signal_processing/cross_correlation_neon.c',
@@ -246,6 +284,7 @@
             'fir_filter_unittest.cc',
             'lapped_transform_unittest.cc',
             'real_fourier_unittest.cc',
+            'resampler/multi_channel_sinc_resampler_unittest.cc',
             'resampler/resampler_unittest.cc',
             'resampler/push_resampler_unittest.cc',
             'resampler/push_sinc_resampler_unittest.cc',
@@ -256,6 +295,7 @@
             'signal_processing/real_fft_unittest.cc',
             'signal_processing/signal_processing_unittest.cc',
             'sparse_fir_filter_unittest.cc',
+            'spsc_audio_ring_buffer_unittest.cc',
             'vad/vad_core_unittest.cc',
             'vad/vad_filterbank_unittest.cc',
             'vad/vad_gmm_unittest.cc',
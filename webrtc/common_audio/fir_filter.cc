@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/fir_filter_avx2.h"
 #include "webrtc/common_audio/fir_filter_neon.h"
 #include "webrtc/common_audio/fir_filter_sse.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
@@ -45,18 +46,24 @@ FIRFilter* FIRFilter::Create(const float* coefficients,
   FIRFilter* filter = NULL;
 // If we know the minimum architecture at compile time, avoid CPU detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+  // AVX2 always requires runtime detection.
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    filter =
+        new FIRFilterAVX2(coefficients, coefficients_length, max_input_length);
+  } else {
 #if defined(__SSE2__)
-  filter =
-      new FIRFilterSSE2(coefficients, coefficients_length, max_input_length);
-#else
-  // x86 CPU detection required.
-  if (WebRtc_GetCPUInfo(kSSE2)) {
     filter =
         new FIRFilterSSE2(coefficients, coefficients_length, max_input_length);
-  } else {
-    filter = new FIRFilterC(coefficients, coefficients_length);
-  }
+#else
+    // x86 CPU detection required.
+    if (WebRtc_GetCPUInfo(kSSE2)) {
+      filter = new FIRFilterSSE2(coefficients, coefficients_length,
+                                 max_input_length);
+    } else {
+      filter = new FIRFilterC(coefficients, coefficients_length);
+    }
 #endif
+  }
 #elif defined(WEBRTC_HAS_NEON)
   filter =
       new FIRFilterNEON(coefficients, coefficients_length, max_input_length);
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/fir_filter_avx2.h"
+
+#include <assert.h>
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "webrtc/system_wrappers/interface/aligned_malloc.h"
+
+namespace webrtc {
+
+FIRFilterAVX2::FIRFilterAVX2(const float* coefficients,
+                             size_t coefficients_length,
+                             size_t max_input_length)
+    : coefficients_length_(coefficients_length),
+      state_length_(coefficients_length_ - 1),
+      coefficients_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * coefficients_length_, 32))),
+      state_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * (max_input_length + state_length_),
+                        32))) {
+  // The coefficients are reversed to compensate for the order in which the
+  // input samples are acquired (most recent last).
+  for (size_t i = 0; i < coefficients_length_; ++i) {
+    coefficients_[i] = coefficients[coefficients_length_ - i - 1];
+  }
+  memset(state_.get(),
+         0,
+         (max_input_length + state_length_) * sizeof(state_[0]));
+}
+
+void FIRFilterAVX2::Filter(const float* in, size_t length, float* out) {
+  assert(length > 0);
+
+  memcpy(&state_[state_length_], in, length * sizeof(*in));
+
+  // Unlike the SSE2 version, which vectorizes each dot product, this computes
+  // eight consecutive outputs at a time. There is no horizontal sum, and the
+  // filters used here are too short to fill several 8-wide dot products.
+  const float* coef_ptr = coefficients_.get();
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const float* in_ptr = &state_[i];
+    __m256 m_sum = _mm256_setzero_ps();
+    for (size_t j = 0; j < coefficients_length_; ++j) {
+      m_sum = _mm256_fmadd_ps(_mm256_broadcast_ss(coef_ptr + j),
+                              _mm256_loadu_ps(in_ptr + j), m_sum);
+    }
+    _mm256_storeu_ps(out + i, m_sum);
+  }
+  // The remaining outputs are computed with the same fused multiply-adds, so
+  // the output doesn't depend on how the input is split into chunks.
+  for (; i < length; ++i) {
+    const float* in_ptr = &state_[i];
+    float sum = 0.f;
+    for (size_t j = 0; j < coefficients_length_; ++j) {
+      sum = fmaf(coef_ptr[j], in_ptr[j], sum);
+    }
+    out[i] = sum;
+  }
+
+  // Update current state.
+  memmove(state_.get(), &state_[length], state_length_ * sizeof(state_[0]));
+}
+
+}  // namespace webrtc
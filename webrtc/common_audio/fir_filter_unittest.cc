@@ -14,6 +14,7 @@
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
 namespace webrtc {
 namespace {
@@ -35,6 +36,17 @@ void VerifyOutput(const float* expected_output,
                       length * sizeof(expected_output[0])));
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+WebRtc_CPUInfo g_get_cpu_info = nullptr;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  if (feature == kAVX2 || feature == kFMA) {
+    return 0;
+  }
+  return g_get_cpu_info(feature);
+}
+#endif
+
 }  // namespace
 
 TEST(FIRFilterTest, FilterAsIdentity) {
@@ -207,4 +219,46 @@ TEST(FIRFilterTest, SameOutputWhenSwapedCoefficientsAndInput) {
   }
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// The AVX2 filter computes several outputs at a time and uses fused
+// multiply-adds, so it is only close to the other implementations.
+TEST(FIRFilterTest, AVX2MatchesOtherImplementations) {
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA)) {
+    printf("Skipping test, AVX2 and FMA not supported.\n");
+    return;
+  }
+  const size_t kLongCoefficientsLength = 23;
+  const size_t kMaxLength = 100;
+  float coefficients[kLongCoefficientsLength];
+  for (size_t i = 0; i < kLongCoefficientsLength; ++i) {
+    coefficients[i] = 0.05f * static_cast<float>(i % 7) - 0.1f;
+  }
+  rtc::scoped_ptr<FIRFilter> avx2_filter(FIRFilter::Create(
+      coefficients, kLongCoefficientsLength, kMaxLength));
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  WebRtc_GetCPUInfo = GetCPUInfoNoAVX2;
+  rtc::scoped_ptr<FIRFilter> filter(FIRFilter::Create(
+      coefficients, kLongCoefficientsLength, kMaxLength));
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+
+  float input[kMaxLength];
+  float output[kMaxLength];
+  float avx2_output[kMaxLength];
+  uint32_t seed = 1;
+  // Lengths which are shorter than the filter, not multiples of eight, etc.
+  const size_t kLengths[] = {1, 3, 8, 17, 100, 64, 5, 99};
+  for (size_t length : kLengths) {
+    for (size_t i = 0; i < length; ++i) {
+      seed = seed * 1664525 + 1013904223;
+      input[i] = static_cast<float>(seed >> 8) / (1 << 23) - 1.f;
+    }
+    filter->Filter(input, length, output);
+    avx2_filter->Filter(input, length, avx2_output);
+    for (size_t i = 0; i < length; ++i) {
+      EXPECT_NEAR(output[i], avx2_output[i], 1e-6f) << length << ", " << i;
+    }
+  }
+}
+#endif
+
 }  // namespace webrtc
@@ -49,6 +49,10 @@ static inline int16_t FloatS16ToS16(float v) {
   return v <= kMinRound ? limits_int16::min() : static_cast<int16_t>(v - 0.5f);
 }
 
+static inline float S16ToFloatS16(int16_t v) {
+  return v;
+}
+
 static inline float FloatToFloatS16(float v) {
   return v * (v > 0 ? limits_int16::max() : -limits_int16::min());
 }
@@ -59,8 +63,11 @@ static inline float FloatS16ToFloat(float v) {
   return v * (v > 0 ? kMaxInt16Inverse : -kMinInt16Inverse);
 }
 
+// The array versions use SIMD where available, with the same results as the
+// per-sample functions.
 void FloatToS16(const float* src, size_t size, int16_t* dest);
 void S16ToFloat(const int16_t* src, size_t size, float* dest);
+void S16ToFloatS16(const int16_t* src, size_t size, float* dest);
 void FloatS16ToS16(const float* src, size_t size, int16_t* dest);
 void FloatToFloatS16(const float* src, size_t size, float* dest);
 void FloatS16ToFloat(const float* src, size_t size, float* dest);
@@ -80,15 +87,12 @@ void CopyAudioIfNeeded(const T* const* src,
   }
 }
 
-// Deinterleave audio from |interleaved| to the channel buffers pointed to
-// by |deinterleaved|. There must be sufficient space allocated in the
-// |deinterleaved| buffers (|num_channel| buffers with |samples_per_channel|
-// per buffer).
+// Generic versions of Deinterleave() and Interleave().
 template <typename T>
-void Deinterleave(const T* interleaved,
-                  size_t samples_per_channel,
-                  int num_channels,
-                  T* const* deinterleaved) {
+void DeinterleaveImpl(const T* interleaved,
+                      size_t samples_per_channel,
+                      int num_channels,
+                      T* const* deinterleaved) {
   for (int i = 0; i < num_channels; ++i) {
     T* channel = deinterleaved[i];
     int interleaved_idx = i;
@@ -99,14 +103,11 @@ void Deinterleave(const T* interleaved,
   }
 }
 
-// Interleave audio from the channel buffers pointed to by |deinterleaved| to
-// |interleaved|. There must be sufficient space allocated in |interleaved|
-// (|samples_per_channel| * |num_channels|).
 template <typename T>
-void Interleave(const T* const* deinterleaved,
-                size_t samples_per_channel,
-                int num_channels,
-                T* interleaved) {
+void InterleaveImpl(const T* const* deinterleaved,
+                    size_t samples_per_channel,
+                    int num_channels,
+                    T* interleaved) {
   for (int i = 0; i < num_channels; ++i) {
     const T* channel = deinterleaved[i];
     int interleaved_idx = i;
@@ -117,6 +118,56 @@ void Interleave(const T* const* deinterleaved,
   }
 }
 
+// Deinterleave audio from |interleaved| to the channel buffers pointed to
+// by |deinterleaved|. There must be sufficient space allocated in the
+// |deinterleaved| buffers (|num_channel| buffers with |samples_per_channel|
+// per buffer).
+template <typename T>
+void Deinterleave(const T* interleaved,
+                  size_t samples_per_channel,
+                  int num_channels,
+                  T* const* deinterleaved) {
+  DeinterleaveImpl(interleaved, samples_per_channel, num_channels,
+                   deinterleaved);
+}
+
+// Interleave audio from the channel buffers pointed to by |deinterleaved| to
+// |interleaved|. There must be sufficient space allocated in |interleaved|
+// (|samples_per_channel| * |num_channels|).
+template <typename T>
+void Interleave(const T* const* deinterleaved,
+                size_t samples_per_channel,
+                int num_channels,
+                T* interleaved) {
+  InterleaveImpl(deinterleaved, samples_per_channel, num_channels,
+                 interleaved);
+}
+
+// Stereo float and int16 audio is (de)interleaved with SIMD where available.
+template <>
+void Deinterleave<float>(const float* interleaved,
+                         size_t samples_per_channel,
+                         int num_channels,
+                         float* const* deinterleaved);
+
+template <>
+void Deinterleave<int16_t>(const int16_t* interleaved,
+                           size_t samples_per_channel,
+                           int num_channels,
+                           int16_t* const* deinterleaved);
+
+template <>
+void Interleave<float>(const float* const* deinterleaved,
+                       size_t samples_per_channel,
+                       int num_channels,
+                       float* interleaved);
+
+template <>
+void Interleave<int16_t>(const int16_t* const* deinterleaved,
+                         size_t samples_per_channel,
+                         int num_channels,
+                         int16_t* interleaved);
+
 // Copies audio from a single channel buffer pointed to by |mono| to each
 // channel of |interleaved|. There must be sufficient space allocated in
 // |interleaved| (|samples_per_channel| * |num_channels|).
@@ -147,6 +198,20 @@ void DownmixToMono(const T* const* input_channels,
   }
 }
 
+// Uses SIMD where available.
+template <>
+void DownmixToMono<float, float>(const float* const* input_channels,
+                                 size_t num_frames,
+                                 int num_channels,
+                                 float* out);
+
+// Equivalent to DownmixToMono<float, float>() followed by FloatToFloatS16(),
+// in a single pass.
+void DownmixToMonoFloatS16(const float* const* input_channels,
+                           size_t num_frames,
+                           int num_channels,
+                           float* out);
+
 // Downmixes an interleaved multichannel signal to a single channel by averaging
 // all channels.
 template <typename T, typename Intermediate>
@@ -31,9 +31,10 @@ void LappedTransform::BlockThunk::ProcessBlock(const float* const* input,
   for (int i = 0; i < num_input_channels; ++i) {
     memcpy(parent_->real_buf_.Row(i), input[i],
            num_frames * sizeof(*input[0]));
-    parent_->fft_->Forward(parent_->real_buf_.Row(i),
-                           parent_->cplx_pre_.Row(i));
   }
+  parent_->fft_->ForwardBatch(parent_->real_buf_.Array(),
+                              parent_->cplx_pre_.Array(),
+                              num_input_channels);
 
   size_t block_length = RealFourier::ComplexLength(
       RealFourier::FftOrder(num_frames));
@@ -44,9 +45,10 @@ void LappedTransform::BlockThunk::ProcessBlock(const float* const* input,
                                                num_output_channels,
                                                parent_->cplx_post_.Array());
 
+  parent_->fft_->InverseBatch(parent_->cplx_post_.Array(),
+                              parent_->real_buf_.Array(),
+                              num_output_channels);
   for (int i = 0; i < num_output_channels; ++i) {
-    parent_->fft_->Inverse(parent_->cplx_post_.Row(i),
-                           parent_->real_buf_.Row(i));
     memcpy(output[i], parent_->real_buf_.Row(i),
            num_frames * sizeof(*input[0]));
   }
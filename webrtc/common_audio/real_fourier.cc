@@ -13,7 +13,9 @@
 #include "webrtc/base/checks.h"
 #include "webrtc/common_audio/real_fourier_ooura.h"
 #include "webrtc/common_audio/real_fourier_openmax.h"
+#include "webrtc/common_audio/real_fourier_sse2.h"
 #include "webrtc/common_audio/signal_processing/include/spl_inl.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
 namespace webrtc {
 
@@ -25,6 +27,11 @@ rtc::scoped_ptr<RealFourier> RealFourier::Create(int fft_order) {
 #if defined(RTC_USE_OPENMAX_DL)
   return rtc::scoped_ptr<RealFourier>(new RealFourierOpenmax(fft_order));
 #else
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (fft_order >= RealFourierSse2::kMinOrder && WebRtc_GetCPUInfo(kSSE2)) {
+    return rtc::scoped_ptr<RealFourier>(new RealFourierSse2(fft_order));
+  }
+#endif
   return rtc::scoped_ptr<RealFourier>(new RealFourierOoura(fft_order));
 #endif
 }
@@ -53,5 +60,21 @@ RealFourier::fft_cplx_scoper RealFourier::AllocCplxBuffer(int count) {
       AlignedMalloc(sizeof(complex<float>) * count, kFftBufferAlignment)));
 }
 
+void RealFourier::ForwardBatch(const float* const* src,
+                               complex<float>* const* dest,
+                               size_t num_transforms) const {
+  for (size_t i = 0; i < num_transforms; ++i) {
+    Forward(src[i], dest[i]);
+  }
+}
+
+void RealFourier::InverseBatch(const complex<float>* const* src,
+                               float* const* dest,
+                               size_t num_transforms) const {
+  for (size_t i = 0; i < num_transforms; ++i) {
+    Inverse(src[i], dest[i]);
+  }
+}
+
 }  // namespace webrtc
 
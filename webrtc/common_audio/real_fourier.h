@@ -33,7 +33,8 @@ class RealFourier {
   static const int kFftBufferAlignment;
 
   // Construct a wrapper instance for the given input order, which must be
-  // between 1 and kMaxFftOrder, inclusively.
+  // between 1 and kMaxFftOrder, inclusively. On x86 CPUs with SSE2, orders of
+  // at least RealFourierSse2::kMinOrder get the vectorized implementation.
   static rtc::scoped_ptr<RealFourier> Create(int fft_order);
   virtual ~RealFourier() {};
 
@@ -66,6 +67,17 @@ class RealFourier {
   // not needed.
   virtual void Inverse(const std::complex<float>* src, float* dest) const = 0;
 
+  // Batch versions of Forward() and Inverse(), transforming |src[i]| into
+  // |dest[i]| for each of the |num_transforms| buffers, e.g. all the channels
+  // of a block. The default implementations transform one buffer at a time;
+  // implementations may override them to share work across the buffers.
+  virtual void ForwardBatch(const float* const* src,
+                            std::complex<float>* const* dest,
+                            size_t num_transforms) const;
+  virtual void InverseBatch(const std::complex<float>* const* src,
+                            float* const* dest,
+                            size_t num_transforms) const;
+
   virtual int order() const = 0;
 };
 
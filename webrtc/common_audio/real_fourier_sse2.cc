@@ -0,0 +1,303 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/real_fourier_sse2.h"
+
+#include <emmintrin.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "webrtc/base/checks.h"
+
+namespace webrtc {
+
+using std::complex;
+
+namespace {
+
+// Returns |a| * |b| for complex vectors in split form.
+inline void ComplexMultiply(__m128 a_re,
+                            __m128 a_im,
+                            __m128 b_re,
+                            __m128 b_im,
+                            __m128* out_re,
+                            __m128* out_im) {
+  *out_re = _mm_sub_ps(_mm_mul_ps(a_re, b_re), _mm_mul_ps(a_im, b_im));
+  *out_im = _mm_add_ps(_mm_mul_ps(a_re, b_im), _mm_mul_ps(a_im, b_re));
+}
+
+// Loads four consecutive complex values from |src| and splits them into
+// their real and imaginary parts.
+inline void LoadComplex(const complex<float>* src, __m128* re, __m128* im) {
+  const float* src_float = reinterpret_cast<const float*>(src);
+  const __m128 lo = _mm_loadu_ps(src_float);
+  const __m128 hi = _mm_loadu_ps(src_float + 4);
+  *re = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+  *im = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+// Same as LoadComplex(), but returns the values in reverse order.
+inline void LoadComplexReversed(const complex<float>* src,
+                                __m128* re,
+                                __m128* im) {
+  const float* src_float = reinterpret_cast<const float*>(src);
+  const __m128 lo = _mm_loadu_ps(src_float);
+  const __m128 hi = _mm_loadu_ps(src_float + 4);
+  *re = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(0, 2, 0, 2));
+  *im = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(1, 3, 1, 3));
+}
+
+inline __m128 Reverse(__m128 v) {
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// Interleaves |re| and |im| into four complex values at |dest|.
+inline void StoreInterleaved(__m128 re, __m128 im, float* dest) {
+  _mm_storeu_ps(dest, _mm_unpacklo_ps(re, im));
+  _mm_storeu_ps(dest + 4, _mm_unpackhi_ps(re, im));
+}
+
+}  // namespace
+
+RealFourierSse2::RealFourierSse2(int fft_order)
+    : order_(fft_order),
+      length_(FftLength(order_)),
+      half_length_(length_ / 2),
+      twiddle_re_(AllocRealBuffer(static_cast<int>(half_length_))),
+      twiddle_im_(AllocRealBuffer(static_cast<int>(half_length_))),
+      post_twiddle_re_(AllocRealBuffer(static_cast<int>(half_length_))),
+      post_twiddle_im_(AllocRealBuffer(static_cast<int>(half_length_))),
+      work_(AllocRealBuffer(static_cast<int>(4 * half_length_))) {
+  CHECK_GE(fft_order, kMinOrder);
+
+  // Stage by stage, the twiddle factors exp(-2 pi i p / n) for p < n / 2,
+  // where n is the length of the sub-transforms of the stage.
+  size_t index = 0;
+  for (size_t n = half_length_; n > 1; n /= 2) {
+    for (size_t p = 0; p < n / 2; ++p) {
+      const double angle = 2.0 * M_PI * p / n;
+      twiddle_re_[index] = static_cast<float>(cos(angle));
+      twiddle_im_[index] = static_cast<float>(-sin(angle));
+      ++index;
+    }
+  }
+  DCHECK_EQ(half_length_ - 1, index);
+
+  // -i * exp(-2 pi i k / length).
+  for (size_t k = 0; k < half_length_; ++k) {
+    const double angle = 2.0 * M_PI * k / length_;
+    post_twiddle_re_[k] = static_cast<float>(-sin(angle));
+    post_twiddle_im_[k] = static_cast<float>(-cos(angle));
+  }
+}
+
+void RealFourierSse2::ComplexFft(float* re,
+                                 float* im,
+                                 float* work_re,
+                                 float* work_im,
+                                 float** out_re,
+                                 float** out_im) const {
+  const float* w_re = twiddle_re_.get();
+  const float* w_im = twiddle_im_.get();
+  float* x_re = re;
+  float* x_im = im;
+  float* y_re = work_re;
+  float* y_im = work_im;
+  // Each stage splits the |s| interleaved sub-transforms of length |n| into
+  // 2 * |s| sub-transforms of length |n| / 2. The first two stages have too
+  // few sub-transforms to vectorize over them, so they vectorize over the
+  // butterflies instead.
+  size_t s = 1;
+  for (size_t n = half_length_; n > 1; n /= 2) {
+    const size_t m = n / 2;
+    if (s == 1) {
+      for (size_t p = 0; p < m; p += 4) {
+        const __m128 a_re = _mm_load_ps(x_re + p);
+        const __m128 a_im = _mm_load_ps(x_im + p);
+        const __m128 b_re = _mm_load_ps(x_re + p + m);
+        const __m128 b_im = _mm_load_ps(x_im + p + m);
+        __m128 d_re;
+        __m128 d_im;
+        ComplexMultiply(_mm_sub_ps(a_re, b_re), _mm_sub_ps(a_im, b_im),
+                        _mm_load_ps(w_re + p), _mm_load_ps(w_im + p), &d_re,
+                        &d_im);
+        const __m128 sum_re = _mm_add_ps(a_re, b_re);
+        const __m128 sum_im = _mm_add_ps(a_im, b_im);
+        StoreInterleaved(sum_re, d_re, y_re + 2 * p);
+        StoreInterleaved(sum_im, d_im, y_im + 2 * p);
+      }
+    } else if (s == 2) {
+      for (size_t p = 0; p < m; p += 2) {
+        const __m128 a_re = _mm_load_ps(x_re + 2 * p);
+        const __m128 a_im = _mm_load_ps(x_im + 2 * p);
+        const __m128 b_re = _mm_load_ps(x_re + 2 * (p + m));
+        const __m128 b_im = _mm_load_ps(x_im + 2 * (p + m));
+        // [w_p, w_p, w_p+1, w_p+1].
+        __m128 t_re = _mm_loadl_pi(_mm_setzero_ps(),
+                                   reinterpret_cast<const __m64*>(w_re + p));
+        __m128 t_im = _mm_loadl_pi(_mm_setzero_ps(),
+                                   reinterpret_cast<const __m64*>(w_im + p));
+        t_re = _mm_unpacklo_ps(t_re, t_re);
+        t_im = _mm_unpacklo_ps(t_im, t_im);
+        __m128 d_re;
+        __m128 d_im;
+        ComplexMultiply(_mm_sub_ps(a_re, b_re), _mm_sub_ps(a_im, b_im), t_re,
+                        t_im, &d_re, &d_im);
+        const __m128 sum_re = _mm_add_ps(a_re, b_re);
+        const __m128 sum_im = _mm_add_ps(a_im, b_im);
+        _mm_store_ps(y_re + 4 * p, _mm_movelh_ps(sum_re, d_re));
+        _mm_store_ps(y_re + 4 * p + 4, _mm_movehl_ps(d_re, sum_re));
+        _mm_store_ps(y_im + 4 * p, _mm_movelh_ps(sum_im, d_im));
+        _mm_store_ps(y_im + 4 * p + 4, _mm_movehl_ps(d_im, sum_im));
+      }
+    } else {
+      for (size_t p = 0; p < m; ++p) {
+        const __m128 t_re = _mm_set1_ps(w_re[p]);
+        const __m128 t_im = _mm_set1_ps(w_im[p]);
+        const float* a_re_ptr = x_re + s * p;
+        const float* a_im_ptr = x_im + s * p;
+        const float* b_re_ptr = x_re + s * (p + m);
+        const float* b_im_ptr = x_im + s * (p + m);
+        float* sum_re_ptr = y_re + 2 * s * p;
+        float* sum_im_ptr = y_im + 2 * s * p;
+        float* d_re_ptr = sum_re_ptr + s;
+        float* d_im_ptr = sum_im_ptr + s;
+        for (size_t q = 0; q < s; q += 4) {
+          const __m128 a_re = _mm_load_ps(a_re_ptr + q);
+          const __m128 a_im = _mm_load_ps(a_im_ptr + q);
+          const __m128 b_re = _mm_load_ps(b_re_ptr + q);
+          const __m128 b_im = _mm_load_ps(b_im_ptr + q);
+          __m128 d_re;
+          __m128 d_im;
+          ComplexMultiply(_mm_sub_ps(a_re, b_re), _mm_sub_ps(a_im, b_im),
+                          t_re, t_im, &d_re, &d_im);
+          _mm_store_ps(sum_re_ptr + q, _mm_add_ps(a_re, b_re));
+          _mm_store_ps(sum_im_ptr + q, _mm_add_ps(a_im, b_im));
+          _mm_store_ps(d_re_ptr + q, d_re);
+          _mm_store_ps(d_im_ptr + q, d_im);
+        }
+      }
+    }
+    w_re += m;
+    w_im += m;
+    std::swap(x_re, y_re);
+    std::swap(x_im, y_im);
+    s *= 2;
+  }
+  *out_re = x_re;
+  *out_im = x_im;
+}
+
+void RealFourierSse2::Forward(const float* src, complex<float>* dest) const {
+  const size_t half_length = half_length_;
+  float* re = work_.get();
+  float* im = re + half_length;
+
+  // The even samples form the real part, the odd ones the imaginary part.
+  for (size_t j = 0; j < half_length; j += 4) {
+    const __m128 lo = _mm_loadu_ps(src + 2 * j);
+    const __m128 hi = _mm_loadu_ps(src + 2 * j + 4);
+    _mm_store_ps(re + j, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_store_ps(im + j, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  float* z_re;
+  float* z_im;
+  ComplexFft(re, im, im + half_length, im + 2 * half_length, &z_re, &z_im);
+
+  // With F = Z[k] and G = conj(Z[N - k]), the spectra of the even and odd
+  // samples are (F + G) / 2 and (F - G) / 2i, which combine into
+  // X[k] = (F + G) / 2 - i * exp(-2 pi i k / length) * (F - G) / 2.
+  dest[0] = complex<float>(z_re[0] + z_im[0], 0.f);
+  dest[half_length] = complex<float>(z_re[0] - z_im[0], 0.f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  size_t k = 1;
+  for (; k + 4 <= half_length; k += 4) {
+    const __m128 f_re = _mm_loadu_ps(z_re + k);
+    const __m128 f_im = _mm_loadu_ps(z_im + k);
+    const __m128 g_re = Reverse(_mm_loadu_ps(z_re + half_length - k - 3));
+    const __m128 g_im = Reverse(_mm_loadu_ps(z_im + half_length - k - 3));
+    // G is conjugated, so the signs of g_im are flipped.
+    const __m128 e_re = _mm_mul_ps(half, _mm_add_ps(f_re, g_re));
+    const __m128 e_im = _mm_mul_ps(half, _mm_sub_ps(f_im, g_im));
+    const __m128 o_re = _mm_mul_ps(half, _mm_sub_ps(f_re, g_re));
+    const __m128 o_im = _mm_mul_ps(half, _mm_add_ps(f_im, g_im));
+    __m128 p_re;
+    __m128 p_im;
+    ComplexMultiply(o_re, o_im, _mm_loadu_ps(post_twiddle_re_.get() + k),
+                    _mm_loadu_ps(post_twiddle_im_.get() + k), &p_re, &p_im);
+    StoreInterleaved(_mm_add_ps(e_re, p_re), _mm_add_ps(e_im, p_im),
+                     reinterpret_cast<float*>(dest + k));
+  }
+  for (; k < half_length; ++k) {
+    const complex<float> f(z_re[k], z_im[k]);
+    const complex<float> g(z_re[half_length - k], -z_im[half_length - k]);
+    const complex<float> t(post_twiddle_re_[k], post_twiddle_im_[k]);
+    dest[k] = 0.5f * (f + g) + t * (0.5f * (f - g));
+  }
+}
+
+void RealFourierSse2::Inverse(const complex<float>* src, float* dest) const {
+  const size_t half_length = half_length_;
+  const float scale = 1.f / length_;
+  float* re = work_.get();
+  float* im = re + half_length;
+
+  // Undoes the combination in Forward(): with A = X[k] + conj(X[N - k]) and
+  // B = X[k] - conj(X[N - k]), Z[k] = (A + i * exp(2 pi i k / length) * B) / 2.
+  // The factor 2 / length also covers the normalization of the half length
+  // transform.
+  re[0] = scale * (src[0].real() + src[half_length].real());
+  im[0] = scale * (src[0].real() - src[half_length].real());
+  const __m128 scale_vec = _mm_set1_ps(scale);
+  size_t k = 1;
+  for (; k + 4 <= half_length; k += 4) {
+    __m128 x_re;
+    __m128 x_im;
+    __m128 g_re;
+    __m128 g_im;
+    LoadComplex(src + k, &x_re, &x_im);
+    LoadComplexReversed(src + half_length - k - 3, &g_re, &g_im);
+    // X[N - k] is conjugated, so the signs of g_im are flipped.
+    const __m128 a_re = _mm_add_ps(x_re, g_re);
+    const __m128 a_im = _mm_sub_ps(x_im, g_im);
+    const __m128 b_re = _mm_sub_ps(x_re, g_re);
+    const __m128 b_im = _mm_add_ps(x_im, g_im);
+    // The conjugate of the post twiddle factor used by Forward().
+    const __m128 t_re = _mm_loadu_ps(post_twiddle_re_.get() + k);
+    const __m128 t_im = _mm_sub_ps(_mm_setzero_ps(),
+                                   _mm_loadu_ps(post_twiddle_im_.get() + k));
+    __m128 p_re;
+    __m128 p_im;
+    ComplexMultiply(b_re, b_im, t_re, t_im, &p_re, &p_im);
+    _mm_storeu_ps(re + k, _mm_mul_ps(scale_vec, _mm_add_ps(a_re, p_re)));
+    _mm_storeu_ps(im + k, _mm_mul_ps(scale_vec, _mm_add_ps(a_im, p_im)));
+  }
+  for (; k < half_length; ++k) {
+    const complex<float> g = std::conj(src[half_length - k]);
+    const complex<float> t(post_twiddle_re_[k], -post_twiddle_im_[k]);
+    const complex<float> z = scale * ((src[k] + g) + t * (src[k] - g));
+    re[k] = z.real();
+    im[k] = z.imag();
+  }
+
+  // The inverse transform is the forward transform with the real and
+  // imaginary parts swapped on both ends.
+  float* z_re;
+  float* z_im;
+  ComplexFft(im, re, im + 2 * half_length, im + half_length, &z_im, &z_re);
+  for (size_t j = 0; j < half_length; j += 4) {
+    StoreInterleaved(_mm_load_ps(z_re + j), _mm_load_ps(z_im + j),
+                     dest + 2 * j);
+  }
+}
+
+}  // namespace webrtc
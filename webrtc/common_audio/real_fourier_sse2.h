@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_AUDIO_REAL_FOURIER_SSE2_H_
+#define WEBRTC_COMMON_AUDIO_REAL_FOURIER_SSE2_H_
+
+#include <complex>
+
+#include "webrtc/common_audio/real_fourier.h"
+
+namespace webrtc {
+
+// Real FFT for x86, vectorized with SSE2 within each transform. The real input
+// is transformed as a complex signal of half the length, whose real and
+// imaginary parts are the even and odd samples, with a radix-2 Stockham FFT on
+// split real and imaginary arrays, followed by the usual post-processing to
+// separate the spectra of the even and odd samples.
+class RealFourierSse2 : public RealFourier {
+ public:
+  // The smallest supported order. RealFourier::Create() falls back to
+  // RealFourierOoura below it.
+  static const int kMinOrder = 4;
+
+  explicit RealFourierSse2(int fft_order);
+
+  void Forward(const float* src, std::complex<float>* dest) const override;
+  void Inverse(const std::complex<float>* src, float* dest) const override;
+
+  int order() const override {
+    return order_;
+  }
+
+ private:
+  // Computes the unnormalized forward DFT of the half length complex signal
+  // |re| + i * |im|, using |work_re| and |work_im| as temporary storage. The
+  // result ends up in either pair of buffers, returned in |out_re| and
+  // |out_im|.
+  void ComplexFft(float* re,
+                  float* im,
+                  float* work_re,
+                  float* work_im,
+                  float** out_re,
+                  float** out_im) const;
+
+  const int order_;
+  const size_t length_;
+  const size_t half_length_;
+  // The twiddle factors of all the FFT stages, back-to-back.
+  const fft_real_scoper twiddle_re_;
+  const fft_real_scoper twiddle_im_;
+  // The factors combining the spectra of the even and odd samples.
+  const fft_real_scoper post_twiddle_re_;
+  const fft_real_scoper post_twiddle_im_;
+  // Holds the split input and the work buffers of ComplexFft().
+  const fft_real_scoper work_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_AUDIO_REAL_FOURIER_SSE2_H_
@@ -10,12 +10,16 @@
 
 #include "webrtc/common_audio/real_fourier.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/common_audio/real_fourier_openmax.h"
 #include "webrtc/common_audio/real_fourier_ooura.h"
+#include "webrtc/common_audio/real_fourier_sse2.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -106,5 +110,132 @@ TYPED_TEST(RealFourierTest, SimpleBackwardTransform) {
   EXPECT_NEAR(this->real_buffer_[3], 4.0f, 1e-8f);
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+namespace {
+
+void FillRandom(float* buffer, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    buffer[i] = 2.f * rand() / RAND_MAX - 1.f;
+  }
+}
+
+}  // namespace
+
+TEST(RealFourierSse2Test, MatchesOoura) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  srand(1);
+  for (int order = RealFourierSse2::kMinOrder; order <= 10; ++order) {
+    SCOPED_TRACE(order);
+    const int length = static_cast<int>(RealFourier::FftLength(order));
+    const int complex_length =
+        static_cast<int>(RealFourier::ComplexLength(order));
+    RealFourierOoura ooura(order);
+    RealFourierSse2 sse2(order);
+    RealFourier::fft_real_scoper input = RealFourier::AllocRealBuffer(length);
+    RealFourier::fft_real_scoper output = RealFourier::AllocRealBuffer(length);
+    RealFourier::fft_cplx_scoper reference =
+        RealFourier::AllocCplxBuffer(complex_length);
+    RealFourier::fft_cplx_scoper spectrum =
+        RealFourier::AllocCplxBuffer(complex_length);
+    FillRandom(input.get(), length);
+
+    ooura.Forward(input.get(), reference.get());
+    sse2.Forward(input.get(), spectrum.get());
+    // The error grows with the order; the bins are at most sqrt(length) on
+    // average.
+    const float tolerance = 1e-6f * length;
+    for (int k = 0; k < complex_length; ++k) {
+      EXPECT_NEAR(reference[k].real(), spectrum[k].real(), tolerance) << k;
+      EXPECT_NEAR(reference[k].imag(), spectrum[k].imag(), tolerance) << k;
+    }
+
+    sse2.Inverse(reference.get(), output.get());
+    for (int i = 0; i < length; ++i) {
+      EXPECT_NEAR(input[i], output[i], 1e-6f * order) << i;
+    }
+  }
+}
+
+TEST(RealFourierSse2Test, BatchMatchesSingleTransforms) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  const int kOrder = 8;
+  const int kNumChannels = 3;
+  const int length = static_cast<int>(RealFourier::FftLength(kOrder));
+  const int complex_length =
+      static_cast<int>(RealFourier::ComplexLength(kOrder));
+  rtc::scoped_ptr<RealFourier> fft = RealFourier::Create(kOrder);
+  RealFourier::fft_real_scoper input[kNumChannels];
+  RealFourier::fft_real_scoper output[kNumChannels];
+  RealFourier::fft_cplx_scoper spectrum[kNumChannels];
+  const float* input_ptrs[kNumChannels];
+  float* output_ptrs[kNumChannels];
+  std::complex<float>* spectrum_ptrs[kNumChannels];
+  srand(2);
+  for (int i = 0; i < kNumChannels; ++i) {
+    input[i] = RealFourier::AllocRealBuffer(length);
+    output[i] = RealFourier::AllocRealBuffer(length);
+    spectrum[i] = RealFourier::AllocCplxBuffer(complex_length);
+    FillRandom(input[i].get(), length);
+    input_ptrs[i] = input[i].get();
+    output_ptrs[i] = output[i].get();
+    spectrum_ptrs[i] = spectrum[i].get();
+  }
+
+  fft->ForwardBatch(input_ptrs, spectrum_ptrs, kNumChannels);
+  fft->InverseBatch(spectrum_ptrs, output_ptrs, kNumChannels);
+  RealFourier::fft_cplx_scoper single =
+      RealFourier::AllocCplxBuffer(complex_length);
+  for (int i = 0; i < kNumChannels; ++i) {
+    fft->Forward(input[i].get(), single.get());
+    for (int k = 0; k < complex_length; ++k) {
+      EXPECT_EQ(single[k], spectrum[i][k]);
+    }
+    for (int j = 0; j < length; ++j) {
+      EXPECT_NEAR(input[i][j], output[i][j], 1e-5f);
+    }
+  }
+}
+
+// Prints the time of a forward and inverse transform pair for the orders used
+// by the lapped transforms in audio_processing.
+TEST(RealFourierSse2Test, DISABLED_Benchmark) {
+  const int kIterations = 200000;
+  for (int order = 7; order <= 10; ++order) {
+    const int length = static_cast<int>(RealFourier::FftLength(order));
+    const int complex_length =
+        static_cast<int>(RealFourier::ComplexLength(order));
+    RealFourierOoura ooura(order);
+    RealFourierSse2 sse2(order);
+    RealFourier::fft_real_scoper real = RealFourier::AllocRealBuffer(length);
+    RealFourier::fft_cplx_scoper cplx =
+        RealFourier::AllocCplxBuffer(complex_length);
+    FillRandom(real.get(), length);
+
+    const int iterations = kIterations >> (order - 7);
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < iterations; ++i) {
+      ooura.Forward(real.get(), cplx.get());
+      ooura.Inverse(cplx.get(), real.get());
+    }
+    const double ooura_us = (TickTime::Now() - start).Microseconds();
+    start = TickTime::Now();
+    for (int i = 0; i < iterations; ++i) {
+      sse2.Forward(real.get(), cplx.get());
+      sse2.Inverse(cplx.get(), real.get());
+    }
+    const double sse2_us = (TickTime::Now() - start).Microseconds();
+    printf("Order %d: %.3f us per transform pair with Ooura, %.3f us with "
+           "SSE2 (%.2fx).\n", order, ooura_us / iterations,
+           sse2_us / iterations, ooura_us / sse2_us);
+  }
+}
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
+
 }  // namespace webrtc
 
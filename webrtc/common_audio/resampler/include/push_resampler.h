@@ -16,9 +16,9 @@
 
 namespace webrtc {
 
-class PushSincResampler;
+class MultiChannelSincResampler;
 
-// Wraps PushSincResampler to provide stereo support.
+// Wraps MultiChannelSincResampler to provide support for interleaved stereo.
 // TODO(ajm): add support for an arbitrary number of channels.
 template <typename T>
 class PushResampler {
@@ -36,8 +36,7 @@ class PushResampler {
   int Resample(const T* src, size_t src_length, T* dst, size_t dst_capacity);
 
  private:
-  rtc::scoped_ptr<PushSincResampler> sinc_resampler_;
-  rtc::scoped_ptr<PushSincResampler> sinc_resampler_right_;
+  rtc::scoped_ptr<MultiChannelSincResampler> sinc_resampler_;
   int src_sample_rate_hz_;
   int dst_sample_rate_hz_;
   int num_channels_;
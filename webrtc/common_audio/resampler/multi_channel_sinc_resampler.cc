@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/resampler/multi_channel_sinc_resampler.h"
+
+#include "webrtc/base/checks.h"
+#include "webrtc/common_audio/include/audio_util.h"
+
+namespace webrtc {
+
+MultiChannelSincResampler::MultiChannelSincResampler(size_t source_frames,
+                                                     size_t destination_frames,
+                                                     int num_channels)
+    : destination_frames_(destination_frames) {
+  CHECK_GT(num_channels, 0);
+  channels_.reserve(num_channels);
+  resamplers_.reserve(num_channels);
+  for (int i = 0; i < num_channels; ++i) {
+    channels_.push_back(
+        new PushSincResampler(source_frames, destination_frames));
+    resamplers_.push_back(channels_[i]->resampler_.get());
+  }
+}
+
+MultiChannelSincResampler::~MultiChannelSincResampler() {
+}
+
+size_t MultiChannelSincResampler::Resample(const int16_t* const* source,
+                                           size_t source_frames,
+                                           int16_t* const* destination,
+                                           size_t destination_capacity) {
+  CHECK_GE(destination_capacity, destination_frames_);
+  if (!float_buffer_.get()) {
+    float_buffer_.reset(
+        new ChannelBuffer<float>(destination_frames_, num_channels()));
+  }
+
+  SetSources(nullptr, source, source_frames);
+  ResampleChannels(float_buffer_->channels());
+  for (int i = 0; i < num_channels(); ++i) {
+    FloatS16ToS16(float_buffer_->channels()[i], destination_frames_,
+                  destination[i]);
+  }
+  return destination_frames_;
+}
+
+size_t MultiChannelSincResampler::Resample(const float* const* source,
+                                           size_t source_frames,
+                                           float* const* destination,
+                                           size_t destination_capacity) {
+  CHECK_GE(destination_capacity, destination_frames_);
+  SetSources(source, nullptr, source_frames);
+  ResampleChannels(destination);
+  return destination_frames_;
+}
+
+void MultiChannelSincResampler::SetSources(const float* const* source,
+                                           const int16_t* const* source_int,
+                                           size_t source_frames) {
+  CHECK_EQ(source_frames, resamplers_[0]->request_frames());
+  for (int i = 0; i < num_channels(); ++i) {
+    PushSincResampler* channel = channels_[i];
+    channel->source_ptr_ = source ? source[i] : nullptr;
+    channel->source_ptr_int_ = source_int ? source_int[i] : nullptr;
+    channel->source_available_ = source_frames;
+  }
+}
+
+void MultiChannelSincResampler::ResampleChannels(float* const* destination) {
+  // See PushSincResampler::Resample() for why the first pass is primed with
+  // ChunkSize() frames of dummy input.
+  if (channels_[0]->first_pass_) {
+    SincResampler::ResampleChannels(&resamplers_[0], resamplers_.size(),
+                                    resamplers_[0]->ChunkSize(), destination);
+  }
+  SincResampler::ResampleChannels(&resamplers_[0], resamplers_.size(),
+                                  destination_frames_, destination);
+  for (int i = 0; i < num_channels(); ++i) {
+    channels_[i]->source_ptr_ = nullptr;
+    channels_[i]->source_ptr_int_ = nullptr;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_AUDIO_RESAMPLER_MULTI_CHANNEL_SINC_RESAMPLER_H_
+#define WEBRTC_COMMON_AUDIO_RESAMPLER_MULTI_CHANNEL_SINC_RESAMPLER_H_
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// A push-based resampler for deinterleaved multichannel audio. The output is
+// identical to that of one PushSincResampler per channel, but the kernel
+// positions are computed once per output frame and a single set of kernels
+// is shared by all channels.
+class MultiChannelSincResampler {
+ public:
+  // Provide the size of the source and destination blocks in samples per
+  // channel. These must correspond to the same time duration (typically
+  // 10 ms) as the sample ratio is inferred from them.
+  MultiChannelSincResampler(size_t source_frames,
+                            size_t destination_frames,
+                            int num_channels);
+  ~MultiChannelSincResampler();
+
+  // Resamples every channel of |source| into the same channel of
+  // |destination|. |source_frames| must always equal the |source_frames|
+  // provided at construction. |destination_capacity| must be at least as large
+  // as |destination_frames|. Returns the number of samples provided in each
+  // channel of |destination|.
+  size_t Resample(const int16_t* const* source,
+                  size_t source_frames,
+                  int16_t* const* destination,
+                  size_t destination_capacity);
+  size_t Resample(const float* const* source,
+                  size_t source_frames,
+                  float* const* destination,
+                  size_t destination_capacity);
+
+  int num_channels() const { return static_cast<int>(channels_.size()); }
+
+ private:
+  // Prepares every channel to provide its |source| on the next request for
+  // data. Exactly one of |source| and |source_int| is non-null.
+  void SetSources(const float* const* source,
+                  const int16_t* const* source_int,
+                  size_t source_frames);
+  void ResampleChannels(float* const* destination);
+
+  // Each channel feeds its own SincResampler through the PushSincResampler
+  // callback, so the priming and delay are the same as for PushSincResampler.
+  ScopedVector<PushSincResampler> channels_;
+  std::vector<SincResampler*> resamplers_;
+  rtc::scoped_ptr<ChannelBuffer<float>> float_buffer_;
+  const size_t destination_frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiChannelSincResampler);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_AUDIO_RESAMPLER_MULTI_CHANNEL_SINC_RESAMPLER_H_
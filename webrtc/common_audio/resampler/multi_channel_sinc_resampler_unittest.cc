@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/common_audio/resampler/multi_channel_sinc_resampler.h"
+#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+// Fills every channel with a tone of a different frequency, in the S16 range.
+template <typename T>
+void GenerateBlock(int sample_rate_hz, size_t block, ChannelBuffer<T>* buffer) {
+  for (int ch = 0; ch < buffer->num_channels(); ++ch) {
+    for (size_t i = 0; i < buffer->num_frames(); ++i) {
+      const double t =
+          static_cast<double>(block * buffer->num_frames() + i) /
+          sample_rate_hz;
+      buffer->channels()[ch][i] =
+          static_cast<T>(10000 * sin(2 * M_PI * (300 + 500 * ch) * t));
+    }
+  }
+}
+
+}  // namespace
+
+class MultiChannelSincResamplerTest
+    : public ::testing::TestWithParam<::testing::tuple<int, int, int>> {
+ public:
+  MultiChannelSincResamplerTest()
+      : input_rate_(::testing::get<0>(GetParam())),
+        output_rate_(::testing::get<1>(GetParam())),
+        num_channels_(::testing::get<2>(GetParam())),
+        input_frames_(static_cast<size_t>(input_rate_ / 100)),
+        output_frames_(static_cast<size_t>(output_rate_ / 100)) {}
+
+ protected:
+  template <typename T>
+  void VerifyMatchesPushSincResampler();
+
+  const int input_rate_;
+  const int output_rate_;
+  const int num_channels_;
+  const size_t input_frames_;
+  const size_t output_frames_;
+};
+
+template <typename T>
+void MultiChannelSincResamplerTest::VerifyMatchesPushSincResampler() {
+  const size_t kNumBlocks = 50;
+  MultiChannelSincResampler resampler(input_frames_, output_frames_,
+                                      num_channels_);
+  EXPECT_EQ(num_channels_, resampler.num_channels());
+  ScopedVector<PushSincResampler> reference_resamplers;
+  for (int ch = 0; ch < num_channels_; ++ch) {
+    reference_resamplers.push_back(
+        new PushSincResampler(input_frames_, output_frames_));
+  }
+
+  ChannelBuffer<T> input(input_frames_, num_channels_);
+  ChannelBuffer<T> output(output_frames_, num_channels_);
+  ChannelBuffer<T> reference_output(output_frames_, num_channels_);
+  for (size_t block = 0; block < kNumBlocks; ++block) {
+    GenerateBlock(input_rate_, block, &input);
+    EXPECT_EQ(output_frames_,
+              resampler.Resample(input.channels(), input_frames_,
+                                 output.channels(), output_frames_));
+    for (int ch = 0; ch < num_channels_; ++ch) {
+      reference_resamplers[ch]->Resample(input.channels()[ch], input_frames_,
+                                         reference_output.channels()[ch],
+                                         output_frames_);
+      for (size_t i = 0; i < output_frames_; ++i) {
+        ASSERT_EQ(reference_output.channels()[ch][i], output.channels()[ch][i])
+            << "block " << block << ", channel " << ch << ", sample " << i;
+      }
+    }
+  }
+}
+
+TEST_P(MultiChannelSincResamplerTest, FloatMatchesPushSincResampler) {
+  VerifyMatchesPushSincResampler<float>();
+}
+
+TEST_P(MultiChannelSincResamplerTest, IntMatchesPushSincResampler) {
+  VerifyMatchesPushSincResampler<int16_t>();
+}
+
+// Compares the throughput with one PushSincResampler per channel. Disabled
+// because it takes too long to run routinely.
+TEST_P(MultiChannelSincResamplerTest, DISABLED_Benchmark) {
+  const int kResampleIterations = 20000;
+  MultiChannelSincResampler resampler(input_frames_, output_frames_,
+                                      num_channels_);
+  ScopedVector<PushSincResampler> reference_resamplers;
+  for (int ch = 0; ch < num_channels_; ++ch) {
+    reference_resamplers.push_back(
+        new PushSincResampler(input_frames_, output_frames_));
+  }
+  ChannelBuffer<float> input(input_frames_, num_channels_);
+  ChannelBuffer<float> output(output_frames_, num_channels_);
+  GenerateBlock(input_rate_, 0, &input);
+
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kResampleIterations; ++i) {
+    for (int ch = 0; ch < num_channels_; ++ch) {
+      reference_resamplers[ch]->Resample(input.channels()[ch], input_frames_,
+                                         output.channels()[ch],
+                                         output_frames_);
+    }
+  }
+  const double total_time_reference_us =
+      (TickTime::Now() - start).Microseconds();
+
+  start = TickTime::Now();
+  for (int i = 0; i < kResampleIterations; ++i) {
+    resampler.Resample(input.channels(), input_frames_, output.channels(),
+                       output_frames_);
+  }
+  const double total_time_us = (TickTime::Now() - start).Microseconds();
+  printf("%d Hz -> %d Hz, %d channels: %.2f us per 10 ms block with "
+         "PushSincResampler, %.2f us with MultiChannelSincResampler "
+         "(%.2fx).\n", input_rate_, output_rate_, num_channels_,
+         total_time_reference_us / kResampleIterations,
+         total_time_us / kResampleIterations,
+         total_time_reference_us / total_time_us);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    MultiChannelSincResamplerTest,
+    MultiChannelSincResamplerTest,
+    ::testing::Values(::testing::make_tuple(44100, 48000, 1),
+                      ::testing::make_tuple(48000, 44100, 2),
+                      ::testing::make_tuple(16000, 48000, 2),
+                      ::testing::make_tuple(48000, 16000, 6),
+                      ::testing::make_tuple(32000, 44100, 8)));
+
+}  // namespace webrtc
@@ -14,7 +14,7 @@
 
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/resampler/include/resampler.h"
-#include "webrtc/common_audio/resampler/push_sinc_resampler.h"
+#include "webrtc/common_audio/resampler/multi_channel_sinc_resampler.h"
 
 namespace webrtc {
 
@@ -51,15 +51,13 @@ int PushResampler<T>::InitializeIfNeeded(int src_sample_rate_hz,
       static_cast<size_t>(src_sample_rate_hz / 100);
   const size_t dst_size_10ms_mono =
       static_cast<size_t>(dst_sample_rate_hz / 100);
-  sinc_resampler_.reset(new PushSincResampler(src_size_10ms_mono,
-                                              dst_size_10ms_mono));
+  sinc_resampler_.reset(new MultiChannelSincResampler(
+      src_size_10ms_mono, dst_size_10ms_mono, num_channels_));
   if (num_channels_ == 2) {
     src_left_.reset(new T[src_size_10ms_mono]);
     src_right_.reset(new T[src_size_10ms_mono]);
     dst_left_.reset(new T[dst_size_10ms_mono]);
     dst_right_.reset(new T[dst_size_10ms_mono]);
-    sinc_resampler_right_.reset(new PushSincResampler(src_size_10ms_mono,
-                                                      dst_size_10ms_mono));
   }
 
   return 0;
@@ -87,19 +85,15 @@ int PushResampler<T>::Resample(const T* src, size_t src_length, T* dst,
     T* deinterleaved[] = {src_left_.get(), src_right_.get()};
     Deinterleave(src, src_length_mono, num_channels_, deinterleaved);
 
-    size_t dst_length_mono =
-        sinc_resampler_->Resample(src_left_.get(), src_length_mono,
-                                  dst_left_.get(), dst_capacity_mono);
-    sinc_resampler_right_->Resample(src_right_.get(), src_length_mono,
-                                    dst_right_.get(), dst_capacity_mono);
+    T* resampled[] = {dst_left_.get(), dst_right_.get()};
+    size_t dst_length_mono = sinc_resampler_->Resample(
+        deinterleaved, src_length_mono, resampled, dst_capacity_mono);
 
-    deinterleaved[0] = dst_left_.get();
-    deinterleaved[1] = dst_right_.get();
-    Interleave(deinterleaved, dst_length_mono, num_channels_, dst);
+    Interleave(resampled, dst_length_mono, num_channels_, dst);
     return static_cast<int>(dst_length_mono * num_channels_);
   } else {
     return static_cast<int>(
-        sinc_resampler_->Resample(src, src_length, dst, dst_capacity));
+        sinc_resampler_->Resample(&src, src_length, &dst, dst_capacity));
   }
 }
 
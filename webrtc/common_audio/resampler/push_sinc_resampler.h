@@ -53,6 +53,7 @@ class PushSincResampler : public SincResamplerCallback {
   void Run(size_t frames, float* destination) override;
 
  private:
+  friend class MultiChannelSincResampler;
   friend class PushSincResamplerTest;
   SincResampler* get_resampler_for_testing() { return resampler_.get(); }
 
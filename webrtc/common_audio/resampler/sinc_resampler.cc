@@ -119,20 +119,22 @@ double SincScaleFactor(double io_ratio) {
 }  // namespace
 
 // If we know the minimum architecture at compile time, avoid CPU detection.
+// On x86 the AVX2 version always requires runtime detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-#if defined(__SSE2__)
-#define CONVOLVE_FUNC Convolve_SSE
-void SincResampler::InitializeCPUSpecificFeatures() {}
-#else
-// x86 CPU detection required.  Function will be set by
-// InitializeCPUSpecificFeatures().
-// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
 #define CONVOLVE_FUNC convolve_proc_
 
 void SincResampler::InitializeCPUSpecificFeatures() {
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    convolve_proc_ = Convolve_AVX2;
+    return;
+  }
+#if defined(__SSE2__)
+  convolve_proc_ = Convolve_SSE;
+#else
+  // TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
   convolve_proc_ = WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C;
-}
 #endif
+}
 #elif defined(WEBRTC_HAS_NEON)
 #define CONVOLVE_FUNC Convolve_NEON
 void SincResampler::InitializeCPUSpecificFeatures() {}
@@ -155,9 +157,10 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
       read_cb_(read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
-      // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // Create input buffers with a 16-byte alignment for SSE optimizations,
+      // and the kernels with a 32-byte alignment for AVX2.
       kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
       kernel_window_storage_(static_cast<float*>(
@@ -268,18 +271,34 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
 }
 
 void SincResampler::Resample(size_t frames, float* destination) {
+  SincResampler* resampler = this;
+  ResampleChannels(&resampler, 1, frames, &destination);
+}
+
+void SincResampler::ResampleChannels(SincResampler* const* resamplers,
+                                     size_t num_channels,
+                                     size_t frames,
+                                     float* const* destination) {
+  // All channels are at the same position, so the bookkeeping is done on the
+  // first one and copied to the others on return.
+  SincResampler* const first = resamplers[0];
   size_t remaining_frames = frames;
+  size_t output_idx = 0;
 
   // Step (1) -- Prime the input buffer at the start of the input stream.
-  if (!buffer_primed_ && remaining_frames) {
-    read_cb_->Run(request_frames_, r0_);
-    buffer_primed_ = true;
+  if (!first->buffer_primed_ && remaining_frames) {
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      SincResampler* const resampler = resamplers[ch];
+      assert(resampler->request_frames_ == first->request_frames_);
+      resampler->read_cb_->Run(resampler->request_frames_, resampler->r0_);
+      resampler->buffer_primed_ = true;
+    }
   }
 
   // Step (2) -- Resample!  const what we can outside of the loop for speed.  It
   // actually has an impact on ARM performance.  See inner loop comment below.
-  const double current_io_ratio = io_sample_rate_ratio_;
-  const float* const kernel_ptr = kernel_storage_.get();
+  const double current_io_ratio = first->io_sample_rate_ratio_;
+  const float* const kernel_ptr = first->kernel_storage_.get();
   while (remaining_frames) {
     // |i| may be negative if the last Resample() call ended on an iteration
     // that put |virtual_source_idx_| over the limit.
@@ -287,14 +306,16 @@ void SincResampler::Resample(size_t frames, float* destination) {
     // Note: The loop construct here can severely impact performance on ARM
     // or when built with clang.  See https://codereview.chromium.org/18566009/
     for (int i = static_cast<int>(
-             ceil((block_size_ - virtual_source_idx_) / current_io_ratio));
+             ceil((first->block_size_ - first->virtual_source_idx_) /
+                  current_io_ratio));
          i > 0; --i) {
-      assert(virtual_source_idx_ < block_size_);
+      assert(first->virtual_source_idx_ < first->block_size_);
 
       // |virtual_source_idx_| lies in between two kernel offsets so figure out
       // what they are.
-      const int source_idx = static_cast<int>(virtual_source_idx_);
-      const double subsample_remainder = virtual_source_idx_ - source_idx;
+      const int source_idx = static_cast<int>(first->virtual_source_idx_);
+      const double subsample_remainder =
+          first->virtual_source_idx_ - source_idx;
 
       const double virtual_offset_idx =
           subsample_remainder * kKernelOffsetCount;
@@ -305,40 +326,52 @@ void SincResampler::Resample(size_t frames, float* destination) {
       const float* const k1 = kernel_ptr + offset_idx * kKernelSize;
       const float* const k2 = k1 + kKernelSize;
 
-      // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always be
-      // true so long as kKernelSize is a multiple of 16.
-      assert(0u == (reinterpret_cast<uintptr_t>(k1) & 0x0F));
-      assert(0u == (reinterpret_cast<uintptr_t>(k2) & 0x0F));
-
-      // Initialize input pointer based on quantized |virtual_source_idx_|.
-      const float* const input_ptr = r1_ + source_idx;
+      // Ensure |k1|, |k2| are 32-byte aligned for SIMD usage.  Should always be
+      // true so long as kKernelSize is a multiple of 32.
+      assert(0u == (reinterpret_cast<uintptr_t>(k1) & 0x1F));
+      assert(0u == (reinterpret_cast<uintptr_t>(k2) & 0x1F));
 
       // Figure out how much to weight each kernel's "convolution".
       const double kernel_interpolation_factor =
           virtual_offset_idx - offset_idx;
-      *destination++ = CONVOLVE_FUNC(
-          input_ptr, k1, k2, kernel_interpolation_factor);
+      for (size_t ch = 0; ch < num_channels; ++ch) {
+        // Initialize input pointer based on quantized |virtual_source_idx_|.
+        const float* const input_ptr = resamplers[ch]->r1_ + source_idx;
+        destination[ch][output_idx] = first->CONVOLVE_FUNC(
+            input_ptr, k1, k2, kernel_interpolation_factor);
+      }
+      ++output_idx;
 
       // Advance the virtual index.
-      virtual_source_idx_ += current_io_ratio;
+      first->virtual_source_idx_ += current_io_ratio;
 
       if (!--remaining_frames)
-        return;
+        break;
     }
+    if (!remaining_frames)
+      break;
 
     // Wrap back around to the start.
-    virtual_source_idx_ -= block_size_;
+    first->virtual_source_idx_ -= first->block_size_;
+
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      SincResampler* const resampler = resamplers[ch];
+      // Step (3) -- Copy r3_, r4_ to r1_, r2_.
+      // This wraps the last input frames back to the start of the buffer.
+      memcpy(resampler->r1_, resampler->r3_,
+             sizeof(*resampler->input_buffer_.get()) * kKernelSize);
 
-    // Step (3) -- Copy r3_, r4_ to r1_, r2_.
-    // This wraps the last input frames back to the start of the buffer.
-    memcpy(r1_, r3_, sizeof(*input_buffer_.get()) * kKernelSize);
+      // Step (4) -- Reinitialize regions if necessary.
+      if (resampler->r0_ == resampler->r2_)
+        resampler->UpdateRegions(true);
 
-    // Step (4) -- Reinitialize regions if necessary.
-    if (r0_ == r2_)
-      UpdateRegions(true);
+      // Step (5) -- Refresh the buffer with more input.
+      resampler->read_cb_->Run(resampler->request_frames_, resampler->r0_);
+    }
+  }
 
-    // Step (5) -- Refresh the buffer with more input.
-    read_cb_->Run(request_frames_, r0_);
+  for (size_t ch = 1; ch < num_channels; ++ch) {
+    resamplers[ch]->virtual_source_idx_ = first->virtual_source_idx_;
   }
 }
 
@@ -64,6 +64,17 @@ class SincResampler {
   // Resample |frames| of data from |read_cb_| into |destination|.
   void Resample(size_t frames, float* destination);
 
+  // Resamples |frames| of data from each of the |num_channels| |resamplers|
+  // into the corresponding channel of |destination|. The kernel positions are
+  // computed once per output frame and the kernels of the first resampler are
+  // used for all channels. The resamplers must have been created with the same
+  // ratio and request size, and must only ever be resampled together, through
+  // this method. Each of them requests data from its own |read_cb_|.
+  static void ResampleChannels(SincResampler* const* resamplers,
+                               size_t num_channels,
+                               size_t frames,
+                               float* const* destination);
+
   // The maximum size in frames that guarantees Resample() will only make a
   // single call to |read_cb_| for more data.
   size_t ChunkSize() const;
@@ -87,6 +98,7 @@ class SincResampler {
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveBenchmark);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveAVX2);
 
   void InitializeKernel();
   void UpdateRegions(bool second_load);
@@ -106,6 +118,9 @@ class SincResampler {
   static float Convolve_SSE(const float* input_ptr, const float* k1,
                             const float* k2,
                             double kernel_interpolation_factor);
+  static float Convolve_AVX2(const float* input_ptr, const float* k1,
+                             const float* k2,
+                             double kernel_interpolation_factor);
 #elif defined(WEBRTC_DETECT_NEON) || defined(WEBRTC_HAS_NEON)
   static float Convolve_NEON(const float* input_ptr, const float* k1,
                              const float* k2,
@@ -227,6 +227,51 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
 
 #undef CONVOLVE_FUNC
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Convolve_AVX2() uses fused multiply-adds, so it is compared to Convolve_C()
+// with a looser epsilon, and benchmarked against Convolve_SSE().
+TEST(SincResamplerTest, ConvolveAVX2) {
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA)) {
+    printf("Skipping test, AVX2 and FMA not supported.\n");
+    return;
+  }
+
+  MockSource mock_source;
+  SincResampler resampler(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                          &mock_source);
+  static const double kEpsilon = 0.0000002;
+  const float* kernel = resampler.kernel_storage_.get();
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t k = 0; k < SincResampler::kKernelOffsetCount; ++k) {
+      const float* k1 = kernel + k * SincResampler::kKernelSize;
+      const float* k2 = k1 + SincResampler::kKernelSize;
+      const double result = resampler.Convolve_C(
+          kernel + offset, k1, k2, kKernelInterpolationFactor);
+      const double result2 = resampler.Convolve_AVX2(
+          kernel + offset, k1, k2, kKernelInterpolationFactor);
+      EXPECT_NEAR(result, result2, kEpsilon) << offset << ", " << k;
+    }
+  }
+
+  const int kConvolveIterations = 1000000;
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    resampler.Convolve_SSE(kernel + 1, kernel, kernel,
+                           kKernelInterpolationFactor);
+  }
+  const double total_time_sse_us = (TickTime::Now() - start).Microseconds();
+  start = TickTime::Now();
+  for (int i = 0; i < kConvolveIterations; ++i) {
+    resampler.Convolve_AVX2(kernel + 1, kernel, kernel,
+                            kKernelInterpolationFactor);
+  }
+  const double total_time_avx2_us = (TickTime::Now() - start).Microseconds();
+  printf("Convolve_AVX2 (unaligned) took %.2fms; which is %.2fx faster than "
+         "Convolve_SSE (unaligned).\n", total_time_avx2_us / 1000,
+         total_time_sse_us / total_time_avx2_us);
+}
+#endif
+
 typedef std::tr1::tuple<int, int, double, double> SincResamplerTestData;
 class SincResamplerTest
     : public testing::TestWithParam<SincResamplerTestData> {
@@ -327,8 +372,18 @@ TEST_P(SincResamplerTest, Resample) {
   low_freq_max_error = DBFS(low_freq_max_error);
   high_freq_max_error = DBFS(high_freq_max_error);
 
+  // The thresholds below are for Convolve_C() and Convolve_SSE(). The fused
+  // multiply-adds and the eight-lane sums of Convolve_AVX2() round
+  // differently, which moves the low frequency error by up to 0.003 dB.
+  double low_freq_error = low_freq_error_;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  static const double kAvx2LowFrequencyErrorMargin = 0.01;
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA))
+    low_freq_error += kAvx2LowFrequencyErrorMargin;
+#endif
+
   EXPECT_LE(rms_error, rms_error_);
-  EXPECT_LE(low_freq_max_error, low_freq_error_);
+  EXPECT_LE(low_freq_max_error, low_freq_error);
 
   // All conversions currently have a high frequency error around -6 dbFS.
   static const double kHighFrequencyMaxError = -6.02;
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/spsc_audio_ring_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+// Rounds the channel length up to whole cache lines, so the channels don't
+// share cache lines and SIMD code can rely on their alignment.
+size_t ChannelStride(size_t max_frames) {
+  const size_t kFramesPerCacheLine = 16;
+  return (max_frames + kFramesPerCacheLine - 1) / kFramesPerCacheLine *
+         kFramesPerCacheLine;
+}
+
+}  // namespace
+
+SpscAudioRingBuffer::SpscAudioRingBuffer(size_t channels, size_t max_frames)
+    : num_channels_(channels),
+      max_frames_(max_frames),
+      stride_(ChannelStride(max_frames)),
+      buffer_(AlignedMalloc<float>(channels * stride_ * sizeof(float),
+                                   kCacheLineSize)) {
+  CHECK_GT(channels, 0u);
+  CHECK_GT(max_frames, 0u);
+  CHECK_LE(max_frames,
+           static_cast<size_t>(std::numeric_limits<int>::max() / 2));
+  memset(buffer_.get(), 0, channels * stride_ * sizeof(float));
+  write_position_.value = 0;
+  read_position_.value = 0;
+}
+
+SpscAudioRingBuffer::~SpscAudioRingBuffer() {}
+
+void SpscAudioRingBuffer::Write(const float* const* data,
+                                size_t channels,
+                                size_t frames) {
+  DCHECK_EQ(num_channels_, channels);
+  CHECK_LE(frames, WriteFramesAvailable());
+  const size_t offset = Offset(write_position_.value);
+  const size_t first = std::min(frames, max_frames_ - offset);
+  for (size_t i = 0; i < num_channels_; ++i) {
+    float* channel = Channel(i);
+    memcpy(channel + offset, data[i], first * sizeof(float));
+    memcpy(channel, data[i] + first, (frames - first) * sizeof(float));
+  }
+  CommitWrite(frames);
+}
+
+size_t SpscAudioRingBuffer::GetWriteSpan(float** data) const {
+  const size_t offset = Offset(write_position_.value);
+  for (size_t i = 0; i < num_channels_; ++i) {
+    data[i] = Channel(i) + offset;
+  }
+  return std::min(WriteFramesAvailable(), max_frames_ - offset);
+}
+
+void SpscAudioRingBuffer::CommitWrite(size_t frames) {
+  CHECK_LE(frames, WriteFramesAvailable());
+  rtc::AtomicOps::ReleaseStore(&write_position_.value,
+                               Advance(write_position_.value, frames));
+}
+
+size_t SpscAudioRingBuffer::WriteFramesAvailable() const {
+  return max_frames_ -
+         FramesBetween(rtc::AtomicOps::AcquireLoad(&read_position_.value),
+                       write_position_.value);
+}
+
+void SpscAudioRingBuffer::Read(float* const* data,
+                               size_t channels,
+                               size_t frames) {
+  DCHECK_EQ(num_channels_, channels);
+  CHECK_LE(frames, ReadFramesAvailable());
+  const size_t offset = Offset(read_position_.value);
+  const size_t first = std::min(frames, max_frames_ - offset);
+  for (size_t i = 0; i < num_channels_; ++i) {
+    const float* channel = Channel(i);
+    memcpy(data[i], channel + offset, first * sizeof(float));
+    memcpy(data[i] + first, channel, (frames - first) * sizeof(float));
+  }
+  CommitRead(frames);
+}
+
+size_t SpscAudioRingBuffer::GetReadSpan(const float** data) const {
+  const size_t offset = Offset(read_position_.value);
+  for (size_t i = 0; i < num_channels_; ++i) {
+    data[i] = Channel(i) + offset;
+  }
+  return std::min(ReadFramesAvailable(), max_frames_ - offset);
+}
+
+void SpscAudioRingBuffer::CommitRead(size_t frames) {
+  CHECK_LE(frames, ReadFramesAvailable());
+  rtc::AtomicOps::ReleaseStore(&read_position_.value,
+                               Advance(read_position_.value, frames));
+}
+
+size_t SpscAudioRingBuffer::ReadFramesAvailable() const {
+  return FramesBetween(read_position_.value,
+                       rtc::AtomicOps::AcquireLoad(&write_position_.value));
+}
+
+size_t SpscAudioRingBuffer::FramesBetween(int from, int to) const {
+  const int frames = to - from;
+  return static_cast<size_t>(frames >= 0 ? frames
+                                         : frames + 2 * max_frames_);
+}
+
+int SpscAudioRingBuffer::Advance(int position, size_t frames) const {
+  size_t advanced = static_cast<size_t>(position) + frames;
+  if (advanced >= 2 * max_frames_) {
+    advanced -= 2 * max_frames_;
+  }
+  return static_cast<int>(advanced);
+}
+
+size_t SpscAudioRingBuffer::Offset(int position) const {
+  const size_t offset = static_cast<size_t>(position);
+  return offset < max_frames_ ? offset : offset - max_frames_;
+}
+
+}  // namespace webrtc
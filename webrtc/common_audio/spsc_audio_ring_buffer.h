@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef WEBRTC_COMMON_AUDIO_SPSC_AUDIO_RING_BUFFER_H_
+#define WEBRTC_COMMON_AUDIO_SPSC_AUDIO_RING_BUFFER_H_
+
+#include <stddef.h>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/aligned_malloc.h"
+
+namespace webrtc {
+
+// A ring buffer for float deinterleaved audio, shared by one producer thread
+// and one consumer thread without locks: the producer only calls the write
+// methods and the consumer only calls the read methods, and neither ever
+// waits for the other. Like AudioRingBuffer, any operation that cannot be
+// performed as requested will cause a crash.
+//
+// Besides the copying Write() and Read(), the buffer memory can be accessed in
+// place, e.g. for a device callback to render straight into it:
+//   float* channels[kNumChannels];
+//   size_t frames = buffer.GetWriteSpan(channels);
+//   ... write up to |frames| frames to |channels| ...
+//   buffer.CommitWrite(frames_written);
+// A span ends at the end of the buffer memory, so accessing all available
+// frames may take two spans.
+class SpscAudioRingBuffer final {
+ public:
+  // Specify the number of channels and maximum number of frames the buffer will
+  // contain.
+  SpscAudioRingBuffer(size_t channels, size_t max_frames);
+  ~SpscAudioRingBuffer();
+
+  // Producer side.
+  //
+  // Copies |data| to the buffer and advances the write position. |channels|
+  // must be the same as at creation time.
+  void Write(const float* const* data, size_t channels, size_t frames);
+  // Sets |data[i]| to the start of the contiguous free space of channel i and
+  // returns its length in frames.
+  size_t GetWriteSpan(float** data) const;
+  // Makes the next |frames| frames available to the consumer.
+  void CommitWrite(size_t frames);
+  size_t WriteFramesAvailable() const;
+
+  // Consumer side.
+  //
+  // Copies from the buffer to |data| and advances the read position.
+  // |channels| must be the same as at creation time.
+  void Read(float* const* data, size_t channels, size_t frames);
+  // Sets |data[i]| to the start of the contiguous readable frames of channel i
+  // and returns their number.
+  size_t GetReadSpan(const float** data) const;
+  // Releases the next |frames| frames to the producer.
+  void CommitRead(size_t frames);
+  size_t ReadFramesAvailable() const;
+
+  size_t num_channels() const { return num_channels_; }
+  size_t max_frames() const { return max_frames_; }
+
+ private:
+  // Assumed size of a cache line, to keep the positions written by the two
+  // threads apart.
+  static const size_t kCacheLineSize = 64;
+
+  size_t FramesBetween(int from, int to) const;
+  int Advance(int position, size_t frames) const;
+  size_t Offset(int position) const;
+  float* Channel(size_t i) const { return buffer_.get() + i * stride_; }
+
+  const size_t num_channels_;
+  const size_t max_frames_;
+  // Channel i starts at |buffer_| + i * |stride_|, on a cache line boundary.
+  const size_t stride_;
+  const rtc::scoped_ptr<float, AlignedFreeDeleter> buffer_;
+
+  // A position on cache lines of its own.
+  struct Position {
+    char padding_before[kCacheLineSize];
+    volatile int value;
+    char padding_after[kCacheLineSize - sizeof(int)];
+  };
+
+  // The positions run over [0, 2 * max_frames_), so that a full buffer can be
+  // told apart from an empty one. |write_position_| is only written by the
+  // producer and |read_position_| only by the consumer, each with release
+  // semantics, after the corresponding frames have been accessed.
+  Position write_position_;
+  Position read_position_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpscAudioRingBuffer);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_AUDIO_SPSC_AUDIO_RING_BUFFER_H_
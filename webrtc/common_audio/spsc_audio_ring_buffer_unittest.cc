@@ -0,0 +1,271 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/spsc_audio_ring_buffer.h"
+
+#if defined(WEBRTC_LINUX)
+#include <sched.h>
+#endif
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/audio_ring_buffer.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+// Sample j of channel i of the test signal.
+float TestSample(size_t i, size_t j) {
+  return static_cast<float>(i * 100000 + j % 100000);
+}
+
+void FillBlock(size_t start, ChannelBuffer<float>* block) {
+  for (int i = 0; i < block->num_channels(); ++i) {
+    for (size_t j = 0; j < block->num_frames(); ++j) {
+      block->channels()[i][j] = TestSample(i, start + j);
+    }
+  }
+}
+
+void VerifyBlock(size_t start, const ChannelBuffer<float>& block) {
+  for (int i = 0; i < block.num_channels(); ++i) {
+    for (size_t j = 0; j < block.num_frames(); ++j) {
+      ASSERT_EQ(TestSample(i, start + j), block.channels()[i][j])
+          << "channel " << i << ", frame " << start + j;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SpscAudioRingBufferTest, ReadsWhatWasWritten) {
+  const size_t kNumChannels = 3;
+  const size_t kBufferFrames = 100;
+  // Chunk sizes which make the positions wrap at many different offsets.
+  const size_t kChunkFrames[][2] = {{7, 7}, {10, 3}, {3, 11}, {100, 100},
+                                    {33, 50}};
+  for (const auto& chunk_frames : kChunkFrames) {
+    SpscAudioRingBuffer buffer(kNumChannels, kBufferFrames);
+    ChannelBuffer<float> input(chunk_frames[0], kNumChannels);
+    ChannelBuffer<float> output(chunk_frames[1], kNumChannels);
+    size_t written = 0;
+    size_t read = 0;
+    while (read < 20 * kBufferFrames) {
+      while (buffer.WriteFramesAvailable() >= chunk_frames[0]) {
+        FillBlock(written, &input);
+        buffer.Write(input.channels(), kNumChannels, chunk_frames[0]);
+        written += chunk_frames[0];
+      }
+      EXPECT_EQ(written - read, buffer.ReadFramesAvailable());
+      while (buffer.ReadFramesAvailable() >= chunk_frames[1]) {
+        buffer.Read(output.channels(), kNumChannels, chunk_frames[1]);
+        VerifyBlock(read, output);
+        read += chunk_frames[1];
+      }
+      EXPECT_EQ(kBufferFrames - (written - read),
+                buffer.WriteFramesAvailable());
+    }
+  }
+}
+
+TEST(SpscAudioRingBufferTest, SpansAccessBufferInPlace) {
+  const size_t kNumChannels = 2;
+  const size_t kBufferFrames = 10;
+  SpscAudioRingBuffer buffer(kNumChannels, kBufferFrames);
+  float* write_span[kNumChannels];
+  const float* read_span[kNumChannels];
+  EXPECT_EQ(kBufferFrames, buffer.GetWriteSpan(write_span));
+  EXPECT_EQ(0u, buffer.GetReadSpan(read_span));
+
+  for (size_t i = 0; i < kNumChannels; ++i) {
+    // Every channel starts on a cache line.
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(write_span[i]) % 64);
+    for (size_t j = 0; j < 8; ++j) {
+      write_span[i][j] = TestSample(i, j);
+    }
+  }
+  buffer.CommitWrite(8);
+  EXPECT_EQ(8u, buffer.GetReadSpan(read_span));
+  EXPECT_EQ(TestSample(1, 0), read_span[1][0]);
+  buffer.CommitRead(6);
+
+  // The free space wraps around the end of the buffer memory, so it takes
+  // two spans.
+  EXPECT_EQ(8u, buffer.WriteFramesAvailable());
+  EXPECT_EQ(2u, buffer.GetWriteSpan(write_span));
+  for (size_t i = 0; i < kNumChannels; ++i) {
+    write_span[i][0] = TestSample(i, 8);
+    write_span[i][1] = TestSample(i, 9);
+  }
+  buffer.CommitWrite(2);
+  EXPECT_EQ(6u, buffer.GetWriteSpan(write_span));
+  for (size_t i = 0; i < kNumChannels; ++i) {
+    write_span[i][0] = TestSample(i, 10);
+  }
+  buffer.CommitWrite(1);
+
+  ChannelBuffer<float> output(5, kNumChannels);
+  ASSERT_EQ(5u, buffer.ReadFramesAvailable());
+  buffer.Read(output.channels(), kNumChannels, 5);
+  VerifyBlock(6, output);
+  EXPECT_EQ(kBufferFrames, buffer.WriteFramesAvailable());
+}
+
+namespace {
+
+const size_t kThreadedNumChannels = 2;
+const size_t kThreadedBlockFrames = 480;
+
+// Writes |num_blocks| blocks of the test signal from its own thread,
+// recording the time each block was made available.
+class Producer {
+ public:
+  Producer(SpscAudioRingBuffer* buffer, size_t num_blocks, int cpu)
+      : buffer_(buffer),
+        num_blocks_(num_blocks),
+        cpu_(cpu),
+        block_(kThreadedBlockFrames, kThreadedNumChannels),
+        write_times_(num_blocks),
+        thread_(ThreadWrapper::CreateThread(&Producer::Run, this,
+                                            "spsc_producer")) {}
+
+  void Start() { EXPECT_TRUE(thread_->Start()); }
+  void Stop() { EXPECT_TRUE(thread_->Stop()); }
+
+  // Only valid for blocks the consumer has received.
+  TickTime write_time(size_t block) const { return write_times_[block]; }
+
+ private:
+  static bool Run(void* obj) {
+    static_cast<Producer*>(obj)->Produce();
+    return false;
+  }
+
+  void Produce() {
+#if defined(WEBRTC_LINUX)
+    if (cpu_ >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu_, &cpus);
+      if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        printf("Failed to pin the producer to CPU %d.\n", cpu_);
+      }
+    }
+#endif
+    for (size_t block = 0; block < num_blocks_; ++block) {
+      FillBlock(block * kThreadedBlockFrames, &block_);
+      while (buffer_->WriteFramesAvailable() < kThreadedBlockFrames) {
+        if (cpu_ < 0) {
+          SleepMs(1);
+        }
+      }
+      write_times_[block] = TickTime::Now();
+      buffer_->Write(block_.channels(), kThreadedNumChannels,
+                     kThreadedBlockFrames);
+    }
+  }
+
+  SpscAudioRingBuffer* const buffer_;
+  const size_t num_blocks_;
+  // The CPU to pin the thread to and spin on, or -1 to sleep while waiting.
+  const int cpu_;
+  ChannelBuffer<float> block_;
+  std::vector<TickTime> write_times_;
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+};
+
+}  // namespace
+
+TEST(SpscAudioRingBufferTest, HandsOffAudioBetweenThreads) {
+  const size_t kNumBlocks = 200;
+  SpscAudioRingBuffer buffer(kThreadedNumChannels, 3 * kThreadedBlockFrames);
+  Producer producer(&buffer, kNumBlocks, -1);
+  producer.Start();
+
+  // Read in chunks which don't match the blocks, straight from the spans.
+  const size_t kReadFrames = 320;
+  const size_t kTotalFrames = kNumBlocks * kThreadedBlockFrames;
+  ChannelBuffer<float> output(kReadFrames, kThreadedNumChannels);
+  size_t read = 0;
+  while (read < kTotalFrames) {
+    const float* span[kThreadedNumChannels];
+    const size_t frames = std::min(buffer.GetReadSpan(span), kReadFrames);
+    if (frames == 0) {
+      SleepMs(1);
+      continue;
+    }
+    for (size_t i = 0; i < kThreadedNumChannels; ++i) {
+      for (size_t j = 0; j < frames; ++j) {
+        ASSERT_EQ(TestSample(i, read + j), span[i][j]);
+      }
+    }
+    buffer.CommitRead(frames);
+    read += frames;
+  }
+  producer.Stop();
+  EXPECT_EQ(0u, buffer.ReadFramesAvailable());
+}
+
+// Measures the throughput of the buffer and the latency from a block being
+// written to it being read, with the producer and the consumer spinning on two
+// different CPUs. Needs at least two CPUs to give meaningful results.
+TEST(SpscAudioRingBufferTest, DISABLED_Benchmark) {
+  const size_t kNumBlocks = 200000;
+  const int kProducerCpu = 0;
+  const int kConsumerCpu = 1;
+#if defined(WEBRTC_LINUX)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(kConsumerCpu, &cpus);
+  if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+    printf("Failed to pin the consumer to CPU %d.\n", kConsumerCpu);
+    return;
+  }
+#endif
+
+  SpscAudioRingBuffer buffer(kThreadedNumChannels, 4 * kThreadedBlockFrames);
+  Producer producer(&buffer, kNumBlocks, kProducerCpu);
+  ChannelBuffer<float> output(kThreadedBlockFrames, kThreadedNumChannels);
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
+  const TickTime start = TickTime::Now();
+  producer.Start();
+  for (size_t block = 0; block < kNumBlocks; ++block) {
+    while (buffer.ReadFramesAvailable() < kThreadedBlockFrames) {
+    }
+    const int64_t latency_us =
+        (TickTime::Now() - producer.write_time(block)).Microseconds();
+    total_latency_us += latency_us;
+    max_latency_us = std::max(max_latency_us, latency_us);
+    buffer.Read(output.channels(), kThreadedNumChannels,
+                kThreadedBlockFrames);
+  }
+  const int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+  producer.Stop();
+
+  printf("%d blocks of %d frames x %d channels in %.1f ms: %.1f Mframes/s, "
+         "latency %.2f us average, %d us max.\n",
+         static_cast<int>(kNumBlocks), static_cast<int>(kThreadedBlockFrames),
+         static_cast<int>(kThreadedNumChannels), elapsed_us / 1000.0,
+         static_cast<double>(kNumBlocks * kThreadedBlockFrames) / elapsed_us,
+         static_cast<double>(total_latency_us) / kNumBlocks,
+         static_cast<int>(max_latency_us));
+}
+
+}  // namespace webrtc
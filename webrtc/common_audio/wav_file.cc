@@ -10,6 +10,14 @@
 
 #include "webrtc/common_audio/wav_file.h"
 
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <string.h>
+
 #include <algorithm>
 #include <cstdio>
 #include <limits>
@@ -18,6 +26,8 @@
 #include "webrtc/base/safe_conversions.h"
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/wav_header.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace webrtc {
 
@@ -25,6 +35,18 @@ namespace webrtc {
 static const WavFormat kWavFormat = kWavFormatPcm;
 static const int kBytesPerSample = 2;
 
+// The duration of audio WavWriter buffers when writing in the background.
+static const int kWriteBufferMs = 250;
+
+// Returns the number of samples in kWriteBufferMs of audio. Invalid
+// parameters are caught by CheckWavParameters() afterwards.
+static size_t WriteBufferSize(int sample_rate, int num_channels) {
+  if (sample_rate <= 0 || num_channels <= 0)
+    return 1;
+  return std::max<size_t>(1, static_cast<size_t>(sample_rate) * num_channels *
+                                 kWriteBufferMs / 1000);
+}
+
 // Doesn't take ownership of the file handle and won't close it.
 class ReadableWavFile : public ReadableWav {
  public:
@@ -37,16 +59,104 @@ class ReadableWavFile : public ReadableWav {
   FILE* file_;
 };
 
-WavReader::WavReader(const std::string& filename)
-    : file_handle_(fopen(filename.c_str(), "rb")) {
-  CHECK(file_handle_ && "Could not open wav file for reading.");
+// Reads from memory, keeping track of the position.
+class ReadableWavMemory : public ReadableWav {
+ public:
+  ReadableWavMemory(const uint8_t* data, size_t size)
+      : data_(data), size_(size), position_(0) {}
+  virtual size_t Read(void* buf, size_t num_bytes) {
+    num_bytes = std::min(num_bytes, size_ - position_);
+    memcpy(buf, data_ + position_, num_bytes);
+    position_ += num_bytes;
+    return num_bytes;
+  }
+  size_t position() const { return position_; }
+
+ private:
+  const uint8_t* const data_;
+  const size_t size_;
+  size_t position_;
+};
+
+// A read-only memory mapping of a whole file.
+class WavReader::MappedFile {
+ public:
+  // Returns NULL if the file can't be mapped, e.g. because it doesn't fit in
+  // the address space or memory mapping isn't supported.
+  static MappedFile* Open(const std::string& filename) {
+#if defined(WEBRTC_POSIX)
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return NULL;
+    struct stat file_stat;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 &&
+        static_cast<uint64_t>(file_stat.st_size) <=
+            std::numeric_limits<size_t>::max()) {
+      data = mmap(NULL, static_cast<size_t>(file_stat.st_size), PROT_READ,
+                  MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after closing the file.
+    close(fd);
+    if (data == MAP_FAILED)
+      return NULL;
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    // Let the kernel read ahead aggressively.
+    madvise(data, size, MADV_SEQUENTIAL);
+    return new MappedFile(static_cast<const uint8_t*>(data), size);
+#else
+    return NULL;
+#endif
+  }
 
-  ReadableWavFile readable(file_handle_);
+  ~MappedFile() {
+#if defined(WEBRTC_POSIX)
+    CHECK_EQ(0, munmap(const_cast<uint8_t*>(data_), size_));
+#endif
+  }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t* const data_;
+  const size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+WavReader::WavReader(const std::string& filename)
+    : mapped_file_(MappedFile::Open(filename)),
+      next_sample_(NULL),
+      file_handle_(NULL) {
   WavFormat format;
   int bytes_per_sample;
-  CHECK(ReadWavHeader(&readable, &num_channels_, &sample_rate_, &format,
-                      &bytes_per_sample, &num_samples_));
-  num_samples_remaining_ = num_samples_;
+  uint64_t num_samples;
+  if (mapped_file_) {
+    ReadableWavMemory readable(mapped_file_->data(), mapped_file_->size());
+    CHECK(ReadWavHeader(&readable, &num_channels_, &sample_rate_, &format,
+                        &bytes_per_sample, &num_samples));
+    // Chunks are padded to an even size, so the samples are aligned.
+    CHECK_EQ(0u, readable.position() % sizeof(*next_sample_));
+    next_sample_ = reinterpret_cast<const int16_t*>(mapped_file_->data() +
+                                                    readable.position());
+    num_samples_ = rtc::checked_cast<size_t>(num_samples);
+    // A truncated file ends early, like with fread().
+    num_samples_remaining_ = std::min(
+        num_samples_,
+        (mapped_file_->size() - readable.position()) / sizeof(*next_sample_));
+  } else {
+    file_handle_ = fopen(filename.c_str(), "rb");
+    CHECK(file_handle_ && "Could not open wav file for reading.");
+
+    ReadableWavFile readable(file_handle_);
+    CHECK(ReadWavHeader(&readable, &num_channels_, &sample_rate_, &format,
+                        &bytes_per_sample, &num_samples));
+    num_samples_ = rtc::checked_cast<size_t>(num_samples);
+    num_samples_remaining_ = num_samples_;
+  }
   CHECK_EQ(kWavFormat, format);
   CHECK_EQ(kBytesPerSample, bytes_per_sample);
 }
@@ -60,53 +170,164 @@ size_t WavReader::ReadSamples(size_t num_samples, int16_t* samples) {
 #error "Need to convert samples to big-endian when reading from WAV file"
 #endif
   // There could be metadata after the audio; ensure we don't read it.
-  num_samples = std::min(rtc::checked_cast<uint32_t>(num_samples),
-                         num_samples_remaining_);
-  const size_t read =
-      fread(samples, sizeof(*samples), num_samples, file_handle_);
-  // If we didn't read what was requested, ensure we've reached the EOF.
-  CHECK(read == num_samples || feof(file_handle_));
+  num_samples = std::min(num_samples, num_samples_remaining_);
+  size_t read;
+  if (mapped_file_) {
+    memcpy(samples, next_sample_, num_samples * sizeof(*samples));
+    next_sample_ += num_samples;
+    read = num_samples;
+  } else {
+    read = fread(samples, sizeof(*samples), num_samples, file_handle_);
+    // If we didn't read what was requested, ensure we've reached the EOF.
+    CHECK(read == num_samples || feof(file_handle_));
+  }
   CHECK_LE(read, num_samples_remaining_);
-  num_samples_remaining_ -= rtc::checked_cast<uint32_t>(read);
+  num_samples_remaining_ -= read;
   return read;
 }
 
 size_t WavReader::ReadSamples(size_t num_samples, float* samples) {
+  if (mapped_file_) {
+    num_samples = std::min(num_samples, num_samples_remaining_);
+    S16ToFloatS16(next_sample_, num_samples, samples);
+    next_sample_ += num_samples;
+    num_samples_remaining_ -= num_samples;
+    return num_samples;
+  }
+
   static const size_t kChunksize = 4096 / sizeof(uint16_t);
   size_t read = 0;
   for (size_t i = 0; i < num_samples; i += kChunksize) {
     int16_t isamples[kChunksize];
     size_t chunk = std::min(kChunksize, num_samples - i);
     chunk = ReadSamples(chunk, isamples);
-    for (size_t j = 0; j < chunk; ++j)
-      samples[i + j] = isamples[j];
+    S16ToFloatS16(isamples, chunk, samples + i);
     read += chunk;
   }
   return read;
 }
 
 void WavReader::Close() {
-  CHECK_EQ(0, fclose(file_handle_));
-  file_handle_ = NULL;
+  if (file_handle_) {
+    CHECK_EQ(0, fclose(file_handle_));
+    file_handle_ = NULL;
+  }
+  mapped_file_.reset();
 }
 
+// Writes buffers to the file on a thread of its own.
+class WavWriter::BackgroundWriter {
+ public:
+  BackgroundWriter(FILE* file, size_t buffer_size)
+      : file_(file),
+        buffer_size_(buffer_size),
+        buffer_(new int16_t[buffer_size]),
+        num_samples_(0),
+        busy_(false),
+        stop_(false),
+        start_event_(EventWrapper::Create()),
+        done_event_(EventWrapper::Create()),
+        thread_(ThreadWrapper::CreateThread(&BackgroundWriter::Run, this,
+                                            "wav_writer")) {
+    CHECK(thread_->Start());
+  }
+
+  ~BackgroundWriter() {
+    Wait();
+    stop_ = true;
+    start_event_->Set();
+    CHECK(thread_->Stop());
+  }
+
+  // Waits for the previous buffer to be written, then starts writing the
+  // first |num_samples| samples of |*buffer|, swapping it for an unused
+  // buffer of the same size.
+  void Write(rtc::scoped_ptr<int16_t[]>* buffer, size_t num_samples) {
+    DCHECK_LE(num_samples, buffer_size_);
+    Wait();
+    buffer_.swap(*buffer);
+    num_samples_ = num_samples;
+    busy_ = true;
+    start_event_->Set();
+  }
+
+  // Waits until all the samples have been written to the file.
+  void Wait() {
+    if (busy_) {
+      done_event_->Wait(WEBRTC_EVENT_INFINITE);
+      busy_ = false;
+    }
+  }
+
+ private:
+  static bool Run(void* obj) {
+    return static_cast<BackgroundWriter*>(obj)->RunOnce();
+  }
+
+  bool RunOnce() {
+    start_event_->Wait(WEBRTC_EVENT_INFINITE);
+    if (stop_)
+      return false;
+    const size_t written =
+        fwrite(buffer_.get(), sizeof(buffer_[0]), num_samples_, file_);
+    CHECK_EQ(num_samples_, written);
+    done_event_->Set();
+    return true;
+  }
+
+  FILE* const file_;
+  const size_t buffer_size_;
+  // |buffer_|, |num_samples_| and |stop_| are only written before setting
+  // |start_event_|, and only read by the thread in between.
+  rtc::scoped_ptr<int16_t[]> buffer_;
+  size_t num_samples_;
+  // Only accessed by the thread owning the WavWriter.
+  bool busy_;
+  bool stop_;
+  rtc::scoped_ptr<EventWrapper> start_event_;
+  rtc::scoped_ptr<EventWrapper> done_event_;
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundWriter);
+};
+
 WavWriter::WavWriter(const std::string& filename, int sample_rate,
                      int num_channels)
+    : WavWriter(filename, sample_rate, num_channels, false, false) {}
+
+WavWriter::WavWriter(const std::string& filename,
+                     int sample_rate,
+                     int num_channels,
+                     bool large_file)
+    : WavWriter(filename, sample_rate, num_channels, large_file, false) {}
+
+WavWriter::WavWriter(const std::string& filename,
+                     int sample_rate,
+                     int num_channels,
+                     bool large_file,
+                     bool write_in_background)
     : sample_rate_(sample_rate),
       num_channels_(num_channels),
+      large_file_(large_file),
       num_samples_(0),
+      buffer_size_(write_in_background
+                       ? WriteBufferSize(sample_rate, num_channels)
+                       : 0),
+      buffer_(write_in_background ? new int16_t[buffer_size_] : NULL),
+      num_buffered_samples_(0),
       file_handle_(fopen(filename.c_str(), "wb")) {
   CHECK(file_handle_ && "Could not open wav file for writing.");
   CHECK(CheckWavParameters(num_channels_,
                            sample_rate_,
                            kWavFormat,
                            kBytesPerSample,
-                           num_samples_));
+                           0));
 
   // Write a blank placeholder header, since we need to know the total number
   // of samples before we can fill in the real data.
-  static const uint8_t blank_header[kWavHeaderSize] = {0};
-  CHECK_EQ(1u, fwrite(blank_header, kWavHeaderSize, 1, file_handle_));
+  static const uint8_t blank_header[kLargeWavHeaderSize] = {0};
+  const size_t header_size = large_file_ ? kLargeWavHeaderSize : kWavHeaderSize;
+  CHECK_EQ(1u, fwrite(blank_header, header_size, 1, file_handle_));
 }
 
 WavWriter::~WavWriter() {
@@ -117,30 +338,83 @@ void WavWriter::WriteSamples(const int16_t* samples, size_t num_samples) {
 #ifndef WEBRTC_ARCH_LITTLE_ENDIAN
 #error "Need to convert samples to little-endian when writing to WAV file"
 #endif
-  const size_t written =
-      fwrite(samples, sizeof(*samples), num_samples, file_handle_);
-  CHECK_EQ(num_samples, written);
-  num_samples_ += static_cast<uint32_t>(written);
-  CHECK(written <= std::numeric_limits<uint32_t>::max() ||
-        num_samples_ >= written);  // detect uint32_t overflow
+  // Detect overflow of the 32-bit sizes of a WAV file early.
+  CHECK(large_file_ || num_samples_ + num_samples <=
+                           std::numeric_limits<uint32_t>::max());
+  num_samples_ += num_samples;
+  if (!buffer_) {
+    const size_t written =
+        fwrite(samples, sizeof(*samples), num_samples, file_handle_);
+    CHECK_EQ(num_samples, written);
+    return;
+  }
+  while (num_samples > 0) {
+    const size_t chunk =
+        std::min(num_samples, buffer_size_ - num_buffered_samples_);
+    memcpy(&buffer_[num_buffered_samples_], samples,
+           chunk * sizeof(*samples));
+    num_buffered_samples_ += chunk;
+    samples += chunk;
+    num_samples -= chunk;
+    if (num_buffered_samples_ == buffer_size_)
+      FlushBuffer();
+  }
 }
 
 void WavWriter::WriteSamples(const float* samples, size_t num_samples) {
-  static const size_t kChunksize = 4096 / sizeof(uint16_t);
-  for (size_t i = 0; i < num_samples; i += kChunksize) {
-    int16_t isamples[kChunksize];
-    const size_t chunk = std::min(kChunksize, num_samples - i);
-    FloatS16ToS16(samples + i, chunk, isamples);
-    WriteSamples(isamples, chunk);
+  if (!buffer_) {
+    static const size_t kChunksize = 4096 / sizeof(uint16_t);
+    for (size_t i = 0; i < num_samples; i += kChunksize) {
+      int16_t isamples[kChunksize];
+      const size_t chunk = std::min(kChunksize, num_samples - i);
+      FloatS16ToS16(samples + i, chunk, isamples);
+      WriteSamples(isamples, chunk);
+    }
+    return;
   }
+  CHECK(large_file_ || num_samples_ + num_samples <=
+                           std::numeric_limits<uint32_t>::max());
+  num_samples_ += num_samples;
+  while (num_samples > 0) {
+    const size_t chunk =
+        std::min(num_samples, buffer_size_ - num_buffered_samples_);
+    FloatS16ToS16(samples, chunk, &buffer_[num_buffered_samples_]);
+    num_buffered_samples_ += chunk;
+    samples += chunk;
+    num_samples -= chunk;
+    if (num_buffered_samples_ == buffer_size_)
+      FlushBuffer();
+  }
+}
+
+void WavWriter::FlushBuffer() {
+  if (!background_writer_)
+    background_writer_.reset(new BackgroundWriter(file_handle_, buffer_size_));
+  background_writer_->Write(&buffer_, num_buffered_samples_);
+  num_buffered_samples_ = 0;
 }
 
 void WavWriter::Close() {
+  if (buffer_) {
+    // Stops the thread after it has written all full buffers.
+    background_writer_.reset();
+    CHECK_EQ(num_buffered_samples_,
+             fwrite(buffer_.get(), sizeof(buffer_[0]), num_buffered_samples_,
+                    file_handle_));
+    num_buffered_samples_ = 0;
+  }
+
   CHECK_EQ(0, fseek(file_handle_, 0, SEEK_SET));
-  uint8_t header[kWavHeaderSize];
-  WriteWavHeader(header, num_channels_, sample_rate_, kWavFormat,
-                 kBytesPerSample, num_samples_);
-  CHECK_EQ(1u, fwrite(header, kWavHeaderSize, 1, file_handle_));
+  uint8_t header[kLargeWavHeaderSize];
+  if (large_file_) {
+    WriteLargeWavHeader(header, num_channels_, sample_rate_, kWavFormat,
+                        kBytesPerSample, num_samples_);
+    CHECK_EQ(1u, fwrite(header, kLargeWavHeaderSize, 1, file_handle_));
+  } else {
+    WriteWavHeader(header, num_channels_, sample_rate_, kWavFormat,
+                   kBytesPerSample, static_cast<uint32_t>(num_samples_));
+    CHECK_EQ(1u, fwrite(header, kWavHeaderSize, 1, file_handle_));
+  }
   CHECK_EQ(0, fclose(file_handle_));
   file_handle_ = NULL;
 }
@@ -173,5 +447,6 @@ int rtc_WavNumChannels(const rtc_WavWriter* wf) {
 }
 
 uint32_t rtc_WavNumSamples(const rtc_WavWriter* wf) {
-  return reinterpret_cast<const webrtc::WavWriter*>(wf)->num_samples();
+  return rtc::checked_cast<uint32_t>(
+      reinterpret_cast<const webrtc::WavWriter*>(wf)->num_samples());
 }
@@ -15,9 +15,11 @@
 
 #include <stdint.h>
 #include <cstddef>
+#include <cstdio>
 #include <string>
 
 #include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
 
 namespace webrtc {
 
@@ -28,7 +30,7 @@ class WavFile {
 
   virtual int sample_rate() const = 0;
   virtual int num_channels() const = 0;
-  virtual uint32_t num_samples() const = 0;
+  virtual size_t num_samples() const = 0;
 };
 
 // Simple C++ class for writing 16-bit PCM WAV files. All error handling is
@@ -38,6 +40,25 @@ class WavWriter final : public WavFile {
   // Open a new WAV file for writing.
   WavWriter(const std::string& filename, int sample_rate, int num_channels);
 
+  // Like above, but if |large_file| is true, the header leaves room for
+  // turning the file into an RF64 file if it grows beyond the 4 GB limit of
+  // the WAV format. Below that limit, it remains a WAV file with an extra
+  // JUNK chunk.
+  WavWriter(const std::string& filename,
+            int sample_rate,
+            int num_channels,
+            bool large_file);
+
+  // Like above, but if |write_in_background| is true, the samples are
+  // buffered, and once the buffer holds a few hundred milliseconds of audio,
+  // it is written to the file on a separate thread while the next one is
+  // filled.
+  WavWriter(const std::string& filename,
+            int sample_rate,
+            int num_channels,
+            bool large_file,
+            bool write_in_background);
+
   // Close the WAV file, after writing its header.
   ~WavWriter();
 
@@ -49,19 +70,32 @@ class WavWriter final : public WavFile {
 
   int sample_rate() const override { return sample_rate_; }
   int num_channels() const override { return num_channels_; }
-  uint32_t num_samples() const override { return num_samples_; }
+  size_t num_samples() const override { return num_samples_; }
 
  private:
+  class BackgroundWriter;
+
+  // Hands the buffered samples over to |background_writer_|.
+  void FlushBuffer();
   void Close();
   const int sample_rate_;
   const int num_channels_;
-  uint32_t num_samples_;  // Total number of samples written to file.
+  const bool large_file_;
+  size_t num_samples_;  // Total number of samples written to file.
+  // Only used when writing in the background, otherwise zero and NULL.
+  const size_t buffer_size_;
+  rtc::scoped_ptr<int16_t[]> buffer_;
+  size_t num_buffered_samples_;
+  // Created when the buffer fills up for the first time.
+  rtc::scoped_ptr<BackgroundWriter> background_writer_;
   FILE* file_handle_;  // Output file, owned by this class
 
   DISALLOW_COPY_AND_ASSIGN(WavWriter);
 };
 
-// Follows the conventions of WavWriter.
+// Follows the conventions of WavWriter. Reads WAV and RF64 files. Where
+// possible, the file is memory mapped and the samples are converted straight
+// from the mapping.
 class WavReader final : public WavFile {
  public:
   // Opens an existing WAV file for reading.
@@ -77,14 +111,20 @@ class WavReader final : public WavFile {
 
   int sample_rate() const override { return sample_rate_; }
   int num_channels() const override { return num_channels_; }
-  uint32_t num_samples() const override { return num_samples_; }
+  size_t num_samples() const override { return num_samples_; }
 
  private:
+  class MappedFile;
+
   void Close();
   int sample_rate_;
   int num_channels_;
-  uint32_t num_samples_;  // Total number of samples in the file.
-  uint32_t num_samples_remaining_;
+  size_t num_samples_;  // Total number of samples in the file.
+  size_t num_samples_remaining_;
+  // Set if the file is memory mapped, in which case |next_sample_| points into
+  // the mapping and |file_handle_| is NULL.
+  rtc::scoped_ptr<MappedFile> mapped_file_;
+  const int16_t* next_sample_;
   FILE* file_handle_;  // Input file, owned by this class.
 
   DISALLOW_COPY_AND_ASSIGN(WavReader);
@@ -11,8 +11,10 @@
 // MSVC++ requires this to be set before any other includes to get M_PI.
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/common_audio/wav_header.h"
@@ -174,4 +176,51 @@ TEST(WavWriterTest, LargeFile) {
   }
 }
 
+// Write a file spanning several write buffers in odd-sized chunks, with room
+// for the RF64 header, and read it back in different chunks.
+static void TestLargeFileFormat(bool write_in_background) {
+  const std::string outfile = test::OutputPath() + "wavtest4.wav";
+  static const int kSampleRate = 48000;
+  static const int kNumChannels = 3;
+  static const size_t kNumSamples = 21 * kSampleRate * kNumChannels;
+  static const size_t kWriteChunk = 1237 * kNumChannels;
+  std::vector<int16_t> samples(kNumSamples);
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    samples[i] = static_cast<int16_t>(i * 7919);
+  }
+  {
+    WavWriter w(outfile, kSampleRate, kNumChannels, true,
+                write_in_background);
+    for (size_t i = 0; i < kNumSamples; i += kWriteChunk) {
+      w.WriteSamples(&samples[i], std::min(kWriteChunk, kNumSamples - i));
+    }
+    EXPECT_EQ(kNumSamples, w.num_samples());
+  }
+  EXPECT_EQ(sizeof(int16_t) * kNumSamples + kLargeWavHeaderSize,
+            test::GetFileSize(outfile));
+
+  WavReader r(outfile);
+  EXPECT_EQ(kSampleRate, r.sample_rate());
+  EXPECT_EQ(kNumChannels, r.num_channels());
+  EXPECT_EQ(kNumSamples, r.num_samples());
+  static const size_t kReadChunk = 4801;
+  std::vector<float> read_samples(kReadChunk);
+  for (size_t i = 0; i < kNumSamples; i += kReadChunk) {
+    const size_t chunk = std::min(kReadChunk, kNumSamples - i);
+    ASSERT_EQ(chunk, r.ReadSamples(kReadChunk, &read_samples[0]));
+    for (size_t j = 0; j < chunk; ++j) {
+      ASSERT_EQ(samples[i + j], read_samples[j]) << "sample " << i + j;
+    }
+  }
+  EXPECT_EQ(0u, r.ReadSamples(kReadChunk, &read_samples[0]));
+}
+
+TEST(WavWriterTest, LargeFileFormat) {
+  TestLargeFileFormat(false);
+}
+
+TEST(WavWriterTest, LargeFileFormatWrittenInBackground) {
+  TestLargeFileFormat(true);
+}
+
 }  // namespace webrtc
@@ -57,13 +57,42 @@ struct WavHeader {
 };
 static_assert(sizeof(WavHeader) == kWavHeaderSize, "no padding in header");
 
-}  // namespace
+// The chunk holding the 64-bit sizes of an RF64 file, whose 32-bit size fields
+// are set to kRf64ChunkSize.
+struct Ds64Subchunk {
+  ChunkHeader header;
+  uint32_t RiffSizeLow;
+  uint32_t RiffSizeHigh;
+  uint32_t DataSizeLow;
+  uint32_t DataSizeHigh;
+  uint32_t SampleCountLow;
+  uint32_t SampleCountHigh;
+  uint32_t TableLength;
+};
+static_assert(sizeof(Ds64Subchunk) == 36, "Ds64Subchunk size");
+const uint32_t kDs64SubchunkSize = sizeof(Ds64Subchunk) - sizeof(ChunkHeader);
+const uint32_t kRf64ChunkSize = 0xffffffff;
 
-bool CheckWavParameters(int num_channels,
-                        int sample_rate,
-                        WavFormat format,
-                        int bytes_per_sample,
-                        uint32_t num_samples) {
+// Written by WriteLargeWavHeader(). |ds64| is a JUNK chunk in WAV files.
+struct LargeWavHeader {
+  struct {
+    ChunkHeader header;
+    uint32_t Format;
+  } riff;
+  Ds64Subchunk ds64;
+  FmtSubchunk fmt;
+  struct {
+    ChunkHeader header;
+  } data;
+};
+static_assert(sizeof(LargeWavHeader) == kLargeWavHeaderSize,
+              "no padding in large header");
+
+// Checks the parameters of CheckWavParameters() except the number of samples.
+bool CheckWavFormat(int num_channels,
+                    int sample_rate,
+                    WavFormat format,
+                    int bytes_per_sample) {
   // num_channels, sample_rate, and bytes_per_sample must be positive, must fit
   // in their respective fields, and their product must fit in the 32-bit
   // ByteRate field.
@@ -96,6 +125,33 @@ bool CheckWavParameters(int num_channels,
     default:
       return false;
   }
+  return true;
+}
+
+// Like CheckWavParameters(), but for the 64-bit sizes of RF64.
+bool CheckLargeWavParameters(int num_channels,
+                             int sample_rate,
+                             WavFormat format,
+                             int bytes_per_sample,
+                             uint64_t num_samples) {
+  if (!CheckWavFormat(num_channels, sample_rate, format, bytes_per_sample))
+    return false;
+  // Keep the size of the file well within 64 bits.
+  if (num_samples > (std::numeric_limits<uint64_t>::max() >> 1) /
+                        static_cast<uint64_t>(bytes_per_sample))
+    return false;
+  return num_samples % num_channels == 0;
+}
+
+}  // namespace
+
+bool CheckWavParameters(int num_channels,
+                        int sample_rate,
+                        WavFormat format,
+                        int bytes_per_sample,
+                        uint32_t num_samples) {
+  if (!CheckWavFormat(num_channels, sample_rate, format, bytes_per_sample))
+    return false;
 
   // The number of bytes in the file, not counting the first ChunkHeader, must
   // be less than 2^32; otherwise, the ChunkSize field overflows.
@@ -116,6 +172,10 @@ bool CheckWavParameters(int num_channels,
 #ifdef WEBRTC_ARCH_LITTLE_ENDIAN
 static inline void WriteLE16(uint16_t* f, uint16_t x) { *f = x; }
 static inline void WriteLE32(uint32_t* f, uint32_t x) { *f = x; }
+static inline void WriteLE64(uint32_t* low, uint32_t* high, uint64_t x) {
+  *low = static_cast<uint32_t>(x);
+  *high = static_cast<uint32_t>(x >> 32);
+}
 static inline void WriteFourCC(uint32_t* f, char a, char b, char c, char d) {
   *f = static_cast<uint32_t>(a)
       | static_cast<uint32_t>(b) << 8
@@ -125,6 +185,9 @@ static inline void WriteFourCC(uint32_t* f, char a, char b, char c, char d) {
 
 static inline uint16_t ReadLE16(uint16_t x) { return x; }
 static inline uint32_t ReadLE32(uint32_t x) { return x; }
+static inline uint64_t ReadLE64(uint32_t low, uint32_t high) {
+  return static_cast<uint64_t>(high) << 32 | low;
+}
 static inline std::string ReadFourCC(uint32_t x) {
   return std::string(reinterpret_cast<char*>(&x), 4);
 }
@@ -145,6 +208,22 @@ static inline uint16_t BlockAlign(int num_channels, int bytes_per_sample) {
   return num_channels * bytes_per_sample;
 }
 
+static void WriteFmtSubchunk(FmtSubchunk* fmt,
+                             int num_channels,
+                             int sample_rate,
+                             WavFormat format,
+                             int bytes_per_sample) {
+  WriteFourCC(&fmt->header.ID, 'f', 'm', 't', ' ');
+  WriteLE32(&fmt->header.Size, kFmtSubchunkSize);
+  WriteLE16(&fmt->AudioFormat, format);
+  WriteLE16(&fmt->NumChannels, num_channels);
+  WriteLE32(&fmt->SampleRate, sample_rate);
+  WriteLE32(&fmt->ByteRate, ByteRate(num_channels, sample_rate,
+                                     bytes_per_sample));
+  WriteLE16(&fmt->BlockAlign, BlockAlign(num_channels, bytes_per_sample));
+  WriteLE16(&fmt->BitsPerSample, 8 * bytes_per_sample);
+}
+
 void WriteWavHeader(uint8_t* buf,
                     int num_channels,
                     int sample_rate,
@@ -161,15 +240,8 @@ void WriteWavHeader(uint8_t* buf,
   WriteLE32(&header.riff.header.Size, RiffChunkSize(bytes_in_payload));
   WriteFourCC(&header.riff.Format, 'W', 'A', 'V', 'E');
 
-  WriteFourCC(&header.fmt.header.ID, 'f', 'm', 't', ' ');
-  WriteLE32(&header.fmt.header.Size, kFmtSubchunkSize);
-  WriteLE16(&header.fmt.AudioFormat, format);
-  WriteLE16(&header.fmt.NumChannels, num_channels);
-  WriteLE32(&header.fmt.SampleRate, sample_rate);
-  WriteLE32(&header.fmt.ByteRate, ByteRate(num_channels, sample_rate,
-                                           bytes_per_sample));
-  WriteLE16(&header.fmt.BlockAlign, BlockAlign(num_channels, bytes_per_sample));
-  WriteLE16(&header.fmt.BitsPerSample, 8 * bytes_per_sample);
+  WriteFmtSubchunk(&header.fmt, num_channels, sample_rate, format,
+                   bytes_per_sample);
 
   WriteFourCC(&header.data.header.ID, 'd', 'a', 't', 'a');
   WriteLE32(&header.data.header.Size, bytes_in_payload);
@@ -179,30 +251,129 @@ void WriteWavHeader(uint8_t* buf,
   memcpy(buf, &header, kWavHeaderSize);
 }
 
+void WriteLargeWavHeader(uint8_t* buf,
+                         int num_channels,
+                         int sample_rate,
+                         WavFormat format,
+                         int bytes_per_sample,
+                         uint64_t num_samples) {
+  CHECK(CheckLargeWavParameters(num_channels, sample_rate, format,
+                                bytes_per_sample, num_samples));
+
+  LargeWavHeader header;
+  memset(&header, 0, sizeof(header));
+  const uint64_t bytes_in_payload = bytes_per_sample * num_samples;
+  const uint64_t riff_size =
+      bytes_in_payload + kLargeWavHeaderSize - sizeof(ChunkHeader);
+  if (riff_size < kRf64ChunkSize) {
+    WriteFourCC(&header.riff.header.ID, 'R', 'I', 'F', 'F');
+    WriteLE32(&header.riff.header.Size, static_cast<uint32_t>(riff_size));
+    WriteFourCC(&header.ds64.header.ID, 'J', 'U', 'N', 'K');
+    WriteLE32(&header.data.header.Size,
+              static_cast<uint32_t>(bytes_in_payload));
+  } else {
+    WriteFourCC(&header.riff.header.ID, 'R', 'F', '6', '4');
+    WriteLE32(&header.riff.header.Size, kRf64ChunkSize);
+    WriteFourCC(&header.ds64.header.ID, 'd', 's', '6', '4');
+    WriteLE64(&header.ds64.RiffSizeLow, &header.ds64.RiffSizeHigh, riff_size);
+    WriteLE64(&header.ds64.DataSizeLow, &header.ds64.DataSizeHigh,
+              bytes_in_payload);
+    WriteLE64(&header.ds64.SampleCountLow, &header.ds64.SampleCountHigh,
+              num_samples / num_channels);
+    WriteLE32(&header.data.header.Size, kRf64ChunkSize);
+  }
+  WriteFourCC(&header.riff.Format, 'W', 'A', 'V', 'E');
+  WriteLE32(&header.ds64.header.Size, kDs64SubchunkSize);
+
+  WriteFmtSubchunk(&header.fmt, num_channels, sample_rate, format,
+                   bytes_per_sample);
+
+  WriteFourCC(&header.data.header.ID, 'd', 'a', 't', 'a');
+
+  memcpy(buf, &header, kLargeWavHeaderSize);
+}
+
+// Reads and discards |num_bytes| bytes.
+static bool SkipBytes(ReadableWav* readable, uint64_t num_bytes) {
+  uint8_t buf[256];
+  while (num_bytes > 0) {
+    const size_t chunk =
+        static_cast<size_t>(std::min<uint64_t>(sizeof(buf), num_bytes));
+    if (readable->Read(buf, chunk) != chunk)
+      return false;
+    num_bytes -= chunk;
+  }
+  return true;
+}
+
 bool ReadWavHeader(ReadableWav* readable,
                    int* num_channels,
                    int* sample_rate,
                    WavFormat* format,
                    int* bytes_per_sample,
-                   uint32_t* num_samples) {
+                   uint64_t* num_samples) {
   WavHeader header;
-  if (readable->Read(&header, kWavHeaderSize - sizeof(header.data)) !=
-      kWavHeaderSize - sizeof(header.data))
+  if (readable->Read(&header.riff, sizeof(header.riff)) != sizeof(header.riff))
     return false;
-
-  const uint32_t fmt_size = ReadLE32(header.fmt.header.Size);
-  if (fmt_size != kFmtSubchunkSize) {
-    // There is an optional two-byte extension field permitted to be present
-    // with PCM, but which must be zero.
-    int16_t ext_size;
-    if (kFmtSubchunkSize + sizeof(ext_size) != fmt_size)
-      return false;
-    if (readable->Read(&ext_size, sizeof(ext_size)) != sizeof(ext_size))
-      return false;
-    if (ext_size != 0)
+  const std::string riff_id = ReadFourCC(header.riff.header.ID);
+  const bool rf64 = riff_id == "RF64";
+  uint64_t riff_size = ReadLE32(header.riff.header.Size);
+  uint64_t header_size = sizeof(header.riff);
+
+  // Walk the chunks up to the "data" chunk, which must come after the "fmt "
+  // chunk and, in RF64 files, the "ds64" chunk.
+  Ds64Subchunk ds64;
+  bool found_ds64 = false;
+  bool found_fmt = false;
+  while (true) {
+    ChunkHeader chunk;
+    if (readable->Read(&chunk, sizeof(chunk)) != sizeof(chunk))
       return false;
+    header_size += sizeof(chunk);
+    const std::string id = ReadFourCC(chunk.ID);
+    const uint32_t size = ReadLE32(chunk.Size);
+    if (id == "data") {
+      header.data.header = chunk;
+      break;
+    } else if (id == "fmt ") {
+      if (size != kFmtSubchunkSize &&
+          size != kFmtSubchunkSize + sizeof(int16_t))
+        return false;
+      header.fmt.header = chunk;
+      if (readable->Read(&header.fmt.AudioFormat, kFmtSubchunkSize) !=
+          kFmtSubchunkSize)
+        return false;
+      if (size != kFmtSubchunkSize) {
+        // There is an optional two-byte extension field permitted to be
+        // present with PCM, but which must be zero.
+        int16_t ext_size;
+        if (readable->Read(&ext_size, sizeof(ext_size)) != sizeof(ext_size))
+          return false;
+        if (ext_size != 0)
+          return false;
+      }
+      found_fmt = true;
+    } else if (id == "ds64" && rf64) {
+      if (size < kDs64SubchunkSize)
+        return false;
+      if (readable->Read(&ds64.RiffSizeLow, kDs64SubchunkSize) !=
+          kDs64SubchunkSize)
+        return false;
+      if (!SkipBytes(readable, size - kDs64SubchunkSize))
+        return false;
+      found_ds64 = true;
+    } else {
+      // Chunks are padded to an even size.
+      if (!SkipBytes(readable, size + (size & 1)))
+        return false;
+    }
+    header_size += size + (size & 1);
   }
-  if (readable->Read(&header.data, sizeof(header.data)) != sizeof(header.data))
+  if (!found_fmt || (rf64 && !found_ds64))
+    return false;
+  if (riff_id != "RIFF" && !rf64)
+    return false;
+  if (ReadFourCC(header.riff.Format) != "WAVE")
     return false;
 
   // Parse needed fields.
@@ -210,22 +381,17 @@ bool ReadWavHeader(ReadableWav* readable,
   *num_channels = ReadLE16(header.fmt.NumChannels);
   *sample_rate = ReadLE32(header.fmt.SampleRate);
   *bytes_per_sample = ReadLE16(header.fmt.BitsPerSample) / 8;
-  const uint32_t bytes_in_payload = ReadLE32(header.data.header.Size);
+  uint64_t bytes_in_payload = ReadLE32(header.data.header.Size);
+  if (rf64) {
+    riff_size = ReadLE64(ds64.RiffSizeLow, ds64.RiffSizeHigh);
+    bytes_in_payload = ReadLE64(ds64.DataSizeLow, ds64.DataSizeHigh);
+  }
   if (*bytes_per_sample <= 0)
     return false;
   *num_samples = bytes_in_payload / *bytes_per_sample;
 
   // Sanity check remaining fields.
-  if (ReadFourCC(header.riff.header.ID) != "RIFF")
-    return false;
-  if (ReadFourCC(header.riff.Format) != "WAVE")
-    return false;
-  if (ReadFourCC(header.fmt.header.ID) != "fmt ")
-    return false;
-  if (ReadFourCC(header.data.header.ID) != "data")
-    return false;
-
-  if (ReadLE32(header.riff.header.Size) < RiffChunkSize(bytes_in_payload))
+  if (riff_size < header_size - sizeof(ChunkHeader) + bytes_in_payload)
     return false;
   if (ReadLE32(header.fmt.ByteRate) !=
       ByteRate(*num_channels, *sample_rate, *bytes_per_sample))
@@ -234,8 +400,29 @@ bool ReadWavHeader(ReadableWav* readable,
       BlockAlign(*num_channels, *bytes_per_sample))
     return false;
 
+  if (rf64) {
+    return CheckLargeWavParameters(*num_channels, *sample_rate, *format,
+                                   *bytes_per_sample, *num_samples);
+  }
   return CheckWavParameters(*num_channels, *sample_rate, *format,
-                            *bytes_per_sample, *num_samples);
+                            *bytes_per_sample,
+                            static_cast<uint32_t>(*num_samples));
+}
+
+bool ReadWavHeader(ReadableWav* readable,
+                   int* num_channels,
+                   int* sample_rate,
+                   WavFormat* format,
+                   int* bytes_per_sample,
+                   uint32_t* num_samples) {
+  uint64_t num_samples64;
+  if (!ReadWavHeader(readable, num_channels, sample_rate, format,
+                     bytes_per_sample, &num_samples64))
+    return false;
+  if (num_samples64 > std::numeric_limits<uint32_t>::max())
+    return false;
+  *num_samples = static_cast<uint32_t>(num_samples64);
+  return true;
 }
 
 
@@ -17,6 +17,8 @@
 namespace webrtc {
 
 static const size_t kWavHeaderSize = 44;
+// The size of the header written by WriteLargeWavHeader().
+static const size_t kLargeWavHeaderSize = 80;
 
 class ReadableWav {
  public:
@@ -49,9 +51,22 @@ void WriteWavHeader(uint8_t* buf,
                     int bytes_per_sample,
                     uint32_t num_samples);
 
+// Like WriteWavHeader(), but for a payload of any size. Writes a
+// kLargeWavHeaderSize bytes long header: an RF64 header (EBU Tech 3306) if the
+// payload is too large for a WAV file, and otherwise a WAV header with a JUNK
+// chunk taking the place of the ds64 chunk of RF64. This lets a writer decide
+// on the format after writing the payload.
+void WriteLargeWavHeader(uint8_t* buf,
+                         int num_channels,
+                         int sample_rate,
+                         WavFormat format,
+                         int bytes_per_sample,
+                         uint64_t num_samples);
+
 // Read a WAV header from an implemented ReadableWav and parse the values into
 // the provided output parameters. ReadableWav is used because the header can
-// be variably sized. Returns false if the header is invalid.
+// be variably sized. Chunks other than "fmt " before the "data" chunk are
+// skipped. Returns false if the header is invalid.
 bool ReadWavHeader(ReadableWav* readable,
                    int* num_channels,
                    int* sample_rate,
@@ -59,6 +74,15 @@ bool ReadWavHeader(ReadableWav* readable,
                    int* bytes_per_sample,
                    uint32_t* num_samples);
 
+// Like ReadWavHeader() above, but also accepts RF64 headers, whose number of
+// samples may not fit in 32 bits.
+bool ReadWavHeader(ReadableWav* readable,
+                   int* num_channels,
+                   int* sample_rate,
+                   WavFormat* format,
+                   int* bytes_per_sample,
+                   uint64_t* num_samples);
+
 }  // namespace webrtc
 
 #endif  // WEBRTC_COMMON_AUDIO_WAV_HEADER_H_
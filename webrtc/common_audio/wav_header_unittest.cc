@@ -320,4 +320,101 @@ TEST(WavHeaderTest, ReadAtypicalWavHeader) {
   EXPECT_EQ(123457689u, num_samples);
 }
 
+// Write a large header for a payload that fits in a WAV file, which gets a
+// JUNK chunk in place of the ds64 chunk, and read it back.
+TEST(WavHeaderTest, WriteAndReadLargeWavHeaderForWavFile) {
+  uint8_t buf[kLargeWavHeaderSize];
+  WriteLargeWavHeader(buf, 2, 48000, kWavFormatPcm, 2, 1000);
+  static const uint8_t kExpectedBuf[] = {
+    'R', 'I', 'F', 'F',
+    0x18, 0x08, 0, 0,  // size of whole file - 8: 2000 + 80 - 8
+    'W', 'A', 'V', 'E',
+    'J', 'U', 'N', 'K',
+    28, 0, 0, 0,  // size of the JUNK chunk, reserved for the ds64 chunk
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    'f', 'm', 't', ' ',
+    16, 0, 0, 0,  // size of fmt block - 8: 24 - 8
+    1, 0,  // format: PCM (1)
+    2, 0,  // channels: 2
+    0x80, 0xbb, 0, 0,  // sample rate: 48000
+    0, 0xee, 2, 0,  // byte rate: 2 * 2 * 48000
+    4, 0,  // block align: NumChannels * BytesPerSample
+    16, 0,  // bits per sample: 2 * 8
+    'd', 'a', 't', 'a',
+    0xd0, 0x07, 0, 0,  // size of payload: 2000
+  };
+  static_assert(sizeof(kExpectedBuf) == kLargeWavHeaderSize, "buffer size");
+  EXPECT_EQ(0, memcmp(kExpectedBuf, buf, kLargeWavHeaderSize));
+
+  int num_channels = 0;
+  int sample_rate = 0;
+  WavFormat format = kWavFormatALaw;
+  int bytes_per_sample = 0;
+  uint32_t num_samples = 0;
+  ReadableWavBuffer r(buf, sizeof(buf));
+  EXPECT_TRUE(
+      ReadWavHeader(&r, &num_channels, &sample_rate, &format,
+                    &bytes_per_sample, &num_samples));
+  EXPECT_EQ(2, num_channels);
+  EXPECT_EQ(48000, sample_rate);
+  EXPECT_EQ(kWavFormatPcm, format);
+  EXPECT_EQ(2, bytes_per_sample);
+  EXPECT_EQ(1000u, num_samples);
+}
+
+// Write and read an RF64 header for a payload beyond the 4 GB limit of WAV.
+TEST(WavHeaderTest, WriteAndReadRf64Header) {
+  static const uint64_t kNumSamples = 5000000000u;
+  uint8_t buf[kLargeWavHeaderSize];
+  WriteLargeWavHeader(buf, 2, 48000, kWavFormatPcm, 2, kNumSamples);
+  static const uint8_t kExpectedBuf[] = {
+    'R', 'F', '6', '4',
+    0xff, 0xff, 0xff, 0xff,  // size of whole file - 8: see ds64
+    'W', 'A', 'V', 'E',
+    'd', 's', '6', '4',
+    28, 0, 0, 0,  // size of the ds64 chunk
+    0x48, 0xe4, 0x0b, 0x54, 2, 0, 0, 0,  // RIFF size: 10000000000 + 80 - 8
+    0x00, 0xe4, 0x0b, 0x54, 2, 0, 0, 0,  // size of payload: 10000000000
+    0x00, 0xf9, 0x02, 0x95, 0, 0, 0, 0,  // sample frames: 2500000000
+    0, 0, 0, 0,  // table length: 0
+    'f', 'm', 't', ' ',
+    16, 0, 0, 0,  // size of fmt block - 8: 24 - 8
+    1, 0,  // format: PCM (1)
+    2, 0,  // channels: 2
+    0x80, 0xbb, 0, 0,  // sample rate: 48000
+    0, 0xee, 2, 0,  // byte rate: 2 * 2 * 48000
+    4, 0,  // block align: NumChannels * BytesPerSample
+    16, 0,  // bits per sample: 2 * 8
+    'd', 'a', 't', 'a',
+    0xff, 0xff, 0xff, 0xff,  // size of payload: see ds64
+  };
+  static_assert(sizeof(kExpectedBuf) == kLargeWavHeaderSize, "buffer size");
+  EXPECT_EQ(0, memcmp(kExpectedBuf, buf, kLargeWavHeaderSize));
+
+  int num_channels = 0;
+  int sample_rate = 0;
+  WavFormat format = kWavFormatALaw;
+  int bytes_per_sample = 0;
+  uint64_t num_samples = 0;
+  {
+    ReadableWavBuffer r(buf, sizeof(buf));
+    EXPECT_TRUE(
+        ReadWavHeader(&r, &num_channels, &sample_rate, &format,
+                      &bytes_per_sample, &num_samples));
+  }
+  EXPECT_EQ(2, num_channels);
+  EXPECT_EQ(48000, sample_rate);
+  EXPECT_EQ(kWavFormatPcm, format);
+  EXPECT_EQ(2, bytes_per_sample);
+  EXPECT_EQ(kNumSamples, num_samples);
+
+  // The number of samples doesn't fit the 32-bit interface.
+  uint32_t num_samples32 = 0;
+  ReadableWavBuffer r(buf, sizeof(buf));
+  EXPECT_FALSE(
+      ReadWavHeader(&r, &num_channels, &sample_rate, &format,
+                    &bytes_per_sample, &num_samples32));
+}
+
 }  // namespace webrtc
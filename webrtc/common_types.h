@@ -294,6 +294,15 @@ class SendSideDelayObserver {
                                     uint32_t ssrc) = 0;
 };
 
+// Callback, used to notify an observer whenever a media packet is sent to the
+// network, with the capture time of the frame it belongs to. Retransmissions
+// and padding are not reported.
+class SendPacketObserver {
+ public:
+  virtual ~SendPacketObserver() {}
+  virtual void OnSendPacket(int64_t capture_time_ms, uint32_t ssrc) = 0;
+};
+
 // ==================================================================
 // Voice specific types
 // ==================================================================
@@ -629,6 +638,10 @@ struct VideoCodecVP9 {
   bool                 adaptiveQpMode;
   unsigned char        numberOfSpatialLayers;
   bool                 flexibleMode;
+  // Decoder side: decode consecutive frames on separate threads. This raises
+  // the throughput of multi-core receivers at the cost of a few frames of
+  // latency.
+  bool                 frameParallelDecoding;
 };
 
 // H264 specific.
@@ -10,34 +10,78 @@
 
 #include "webrtc/common_video/interface/i420_buffer_pool.h"
 
+#include "webrtc/base/atomicops.h"
 #include "webrtc/base/checks.h"
+#include "webrtc/system_wrappers/interface/clock.h"
 
-namespace {
+namespace webrtc {
 
-// One extra indirection is needed to make |HasOneRef| work.
-class PooledI420Buffer : public webrtc::VideoFrameBuffer {
+// A lock-free stack of the buffers released by their last owner, on any
+// thread, until the pool collects them on its own thread. Only the pool takes
+// buffers from the stack, and it takes all of them at once, so the stack is
+// not subject to the ABA problem.
+class I420BufferPool::ReleasedBuffers : public rtc::RefCountInterface {
  public:
-  explicit PooledI420Buffer(
-      const rtc::scoped_refptr<webrtc::I420Buffer>& buffer)
-      : buffer_(buffer) {}
+  ReleasedBuffers() : head_(nullptr) {}
+
+  // Returns false if the stack has been closed, in which case the caller
+  // frees |buffer|.
+  bool Push(PooledI420Buffer* buffer);
+  // Takes the buffers pushed since the last call, linked in the order they
+  // were pushed.
+  PooledI420Buffer* TakeAll();
+  // Takes the remaining buffers and makes the following Push() calls fail.
+  PooledI420Buffer* Close();
+
+ protected:
+  ~ReleasedBuffers() override {}
 
  private:
+  // |head_| points to this object itself, which no buffer does, once the
+  // stack is closed.
+  PooledI420Buffer* closed() {
+    return reinterpret_cast<PooledI420Buffer*>(this);
+  }
+  PooledI420Buffer* Exchange(PooledI420Buffer* value);
+
+  PooledI420Buffer* volatile head_;
+};
+
+class I420BufferPool::PooledI420Buffer : public VideoFrameBuffer {
+ public:
+  PooledI420Buffer(int width,
+                   int height,
+                   const rtc::scoped_refptr<ReleasedBuffers>& released_buffers)
+      : next(nullptr),
+        release_time_ms(0),
+        buffer_(new rtc::RefCountedObject<I420Buffer>(width, height)),
+        released_buffers_(released_buffers),
+        ref_count_(0) {}
   ~PooledI420Buffer() override {}
 
+  // Instead of being deleted, the buffer returns to the pool when the last
+  // reference is released.
+  int AddRef() override { return rtc::AtomicOps::Increment(&ref_count_); }
+  int Release() override {
+    const int count = rtc::AtomicOps::Decrement(&ref_count_);
+    if (count == 0 && !released_buffers_->Push(this))
+      delete this;
+    return count;
+  }
+  bool HasOneRef() const override {
+    return rtc::AtomicOps::AcquireLoad(&ref_count_) == 1;
+  }
+
   int width() const override { return buffer_->width(); }
   int height() const override { return buffer_->height(); }
-  const uint8_t* data(webrtc::PlaneType type) const override {
+  const uint8_t* data(PlaneType type) const override {
     return buffer_->data(type);
   }
-  uint8_t* MutableData(webrtc::PlaneType type) override {
-    // Make the HasOneRef() check here instead of in |buffer_|, because the pool
-    // also has a reference to |buffer_|.
+  uint8_t* MutableData(PlaneType type) override {
     DCHECK(HasOneRef());
     return const_cast<uint8_t*>(buffer_->data(type));
   }
-  int stride(webrtc::PlaneType type) const override {
-    return buffer_->stride(type);
-  }
+  int stride(PlaneType type) const override { return buffer_->stride(type); }
   void* native_handle() const override { return nullptr; }
 
   rtc::scoped_refptr<VideoFrameBuffer> NativeToI420Buffer() override {
@@ -45,46 +89,228 @@ class PooledI420Buffer : public webrtc::VideoFrameBuffer {
     return nullptr;
   }
 
-  friend class rtc::RefCountedObject<PooledI420Buffer>;
-  rtc::scoped_refptr<webrtc::I420Buffer> buffer_;
+  size_t size_in_bytes() const {
+    const int chroma_height = (height() + 1) / 2;
+    return static_cast<size_t>(stride(kYPlane) * height() +
+                               stride(kUPlane) * chroma_height +
+                               stride(kVPlane) * chroma_height);
+  }
+
+  // The next buffer in ReleasedBuffers.
+  PooledI420Buffer* next;
+  // When the pool collected the buffer after its release.
+  int64_t release_time_ms;
+
+ private:
+  const rtc::scoped_refptr<I420Buffer> buffer_;
+  const rtc::scoped_refptr<ReleasedBuffers> released_buffers_;
+  volatile int ref_count_;
 };
 
-}  // namespace
+bool I420BufferPool::ReleasedBuffers::Push(PooledI420Buffer* buffer) {
+  PooledI420Buffer* head = rtc::AtomicOps::AcquireLoadPtr(&head_);
+  while (true) {
+    if (head == closed())
+      return false;
+    buffer->next = head;
+    PooledI420Buffer* previous =
+        rtc::AtomicOps::CompareAndSwapPtr(&head_, head, buffer);
+    if (previous == head)
+      return true;
+    head = previous;
+  }
+}
 
-namespace webrtc {
+I420BufferPool::PooledI420Buffer* I420BufferPool::ReleasedBuffers::TakeAll() {
+  PooledI420Buffer* buffer = Exchange(nullptr);
+  DCHECK(buffer != closed());
+  // Reverse the stack.
+  PooledI420Buffer* buffers = nullptr;
+  while (buffer) {
+    PooledI420Buffer* next = buffer->next;
+    buffer->next = buffers;
+    buffers = buffer;
+    buffer = next;
+  }
+  return buffers;
+}
 
-I420BufferPool::I420BufferPool() {
-  Release();
+I420BufferPool::PooledI420Buffer* I420BufferPool::ReleasedBuffers::Close() {
+  return Exchange(closed());
+}
+
+I420BufferPool::PooledI420Buffer* I420BufferPool::ReleasedBuffers::Exchange(
+    PooledI420Buffer* value) {
+  PooledI420Buffer* head = rtc::AtomicOps::AcquireLoadPtr(&head_);
+  while (true) {
+    PooledI420Buffer* previous =
+        rtc::AtomicOps::CompareAndSwapPtr(&head_, head, value);
+    if (previous == head)
+      return head;
+    head = previous;
+  }
+}
+
+I420BufferPool::I420BufferPool()
+    : I420BufferPool(kDefaultMaxNumberOfBuffers,
+                     kDefaultMaxIdleTimeMs,
+                     Clock::GetRealTimeClock()) {}
+
+I420BufferPool::I420BufferPool(int max_number_of_buffers,
+                               int64_t max_idle_time_ms,
+                               Clock* clock)
+    : max_number_of_buffers_(max_number_of_buffers),
+      max_idle_time_ms_(max_idle_time_ms),
+      clock_(clock),
+      released_buffers_(new rtc::RefCountedObject<ReleasedBuffers>()),
+      num_buffers_(0),
+      num_hits_(0),
+      num_misses_(0) {
+  DCHECK_GE(max_number_of_buffers_, 0);
+  thread_checker_.DetachFromThread();
+}
+
+I420BufferPool::~I420BufferPool() {
+  Clear();
 }
 
 void I420BufferPool::Release() {
   thread_checker_.DetachFromThread();
-  buffers_.clear();
+  Clear();
+  released_buffers_ = new rtc::RefCountedObject<ReleasedBuffers>();
 }
 
 rtc::scoped_refptr<VideoFrameBuffer> I420BufferPool::CreateBuffer(int width,
                                                                   int height) {
   DCHECK(thread_checker_.CalledOnValidThread());
-  // Release buffers with wrong resolution.
-  for (auto it = buffers_.begin(); it != buffers_.end();) {
-    if ((*it)->width() != width || (*it)->height() != height)
-      it = buffers_.erase(it);
+  CollectReleasedBuffers();
+  BucketMap::iterator it = buckets_.find(std::make_pair(width, height));
+  if (it != buckets_.end() && !it->second.free_buffers.empty()) {
+    // Reuse the most recently released buffer, which is the most likely to
+    // still be in the cache.
+    ++num_hits_;
+    PooledI420Buffer* buffer = it->second.free_buffers.back();
+    it->second.free_buffers.pop_back();
+    return buffer;
+  }
+
+  ++num_misses_;
+  // Make room by freeing a buffer of another resolution, if possible.
+  if (num_buffers_ >= max_number_of_buffers_ &&
+      !FreeLeastRecentlyReleasedBuffer()) {
+    // All buffers are in use. This one isn't pooled.
+    return new rtc::RefCountedObject<I420Buffer>(width, height);
+  }
+  return AllocateBuffer(width, height,
+                        &buckets_[std::make_pair(width, height)]);
+}
+
+void I420BufferPool::Preallocate(int width, int height, int count) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  CollectReleasedBuffers();
+  if (count <= 0 || num_buffers_ >= max_number_of_buffers_)
+    return;
+  Bucket* bucket = &buckets_[std::make_pair(width, height)];
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  while (bucket->num_buffers < count &&
+         num_buffers_ < max_number_of_buffers_) {
+    PooledI420Buffer* buffer = AllocateBuffer(width, height, bucket);
+    buffer->release_time_ms = now_ms;
+    bucket->free_buffers.push_back(buffer);
+  }
+}
+
+I420BufferPool::Stats I420BufferPool::GetStats() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  CollectReleasedBuffers();
+  Stats stats;
+  stats.num_hits = num_hits_;
+  stats.num_misses = num_misses_;
+  stats.num_buffers = num_buffers_;
+  for (const auto& bucket : buckets_) {
+    stats.num_free_buffers +=
+        static_cast<int>(bucket.second.free_buffers.size());
+    stats.bytes_held += bucket.second.num_buffers * bucket.second.buffer_size;
+  }
+  return stats;
+}
+
+void I420BufferPool::CollectReleasedBuffers() {
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  PooledI420Buffer* buffer = released_buffers_->TakeAll();
+  while (buffer) {
+    PooledI420Buffer* next = buffer->next;
+    BucketMap::iterator it =
+        buckets_.find(std::make_pair(buffer->width(), buffer->height()));
+    DCHECK(it != buckets_.end());
+    buffer->release_time_ms = now_ms;
+    it->second.free_buffers.push_back(buffer);
+    buffer = next;
+  }
+
+  for (BucketMap::iterator it = buckets_.begin(); it != buckets_.end();) {
+    Bucket& bucket = it->second;
+    while (!bucket.free_buffers.empty() &&
+           now_ms - bucket.free_buffers.front()->release_time_ms >=
+               max_idle_time_ms_) {
+      delete bucket.free_buffers.front();
+      bucket.free_buffers.pop_front();
+      --bucket.num_buffers;
+      --num_buffers_;
+    }
+    if (bucket.num_buffers == 0)
+      buckets_.erase(it++);
     else
       ++it;
   }
-  // Look for a free buffer.
-  for (const rtc::scoped_refptr<I420Buffer>& buffer : buffers_) {
-    // If the buffer is in use, the ref count will be 2, one from the list we
-    // are looping over and one from a PooledI420Buffer returned from
-    // CreateBuffer that has not been released yet. If the ref count is 1
-    // (HasOneRef), then the list we are looping over holds the only reference
-    // and it's safe to reuse.
-    if (buffer->HasOneRef())
-      return new rtc::RefCountedObject<PooledI420Buffer>(buffer);
-  }
-  // Allocate new buffer.
-  buffers_.push_back(new rtc::RefCountedObject<I420Buffer>(width, height));
-  return new rtc::RefCountedObject<PooledI420Buffer>(buffers_.back());
+}
+
+bool I420BufferPool::FreeLeastRecentlyReleasedBuffer() {
+  BucketMap::iterator oldest = buckets_.end();
+  for (BucketMap::iterator it = buckets_.begin(); it != buckets_.end(); ++it) {
+    if (!it->second.free_buffers.empty() &&
+        (oldest == buckets_.end() ||
+         it->second.free_buffers.front()->release_time_ms <
+             oldest->second.free_buffers.front()->release_time_ms)) {
+      oldest = it;
+    }
+  }
+  if (oldest == buckets_.end())
+    return false;
+
+  delete oldest->second.free_buffers.front();
+  oldest->second.free_buffers.pop_front();
+  --num_buffers_;
+  if (--oldest->second.num_buffers == 0)
+    buckets_.erase(oldest);
+  return true;
+}
+
+void I420BufferPool::Clear() {
+  PooledI420Buffer* buffer = released_buffers_->Close();
+  while (buffer) {
+    PooledI420Buffer* next = buffer->next;
+    delete buffer;
+    buffer = next;
+  }
+  for (const auto& bucket : buckets_) {
+    for (PooledI420Buffer* free_buffer : bucket.second.free_buffers)
+      delete free_buffer;
+  }
+  buckets_.clear();
+  num_buffers_ = 0;
+}
+
+I420BufferPool::PooledI420Buffer* I420BufferPool::AllocateBuffer(
+    int width,
+    int height,
+    Bucket* bucket) {
+  PooledI420Buffer* buffer =
+      new PooledI420Buffer(width, height, released_buffers_);
+  bucket->buffer_size = buffer->size_in_bytes();
+  ++bucket->num_buffers;
+  ++num_buffers_;
+  return buffer;
 }
 
 }  // namespace webrtc
@@ -9,12 +9,46 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/common_video/interface/i420_buffer_pool.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace webrtc {
 
+namespace {
+
+const int64_t kMaxIdleTimeMs = 1000;
+
+// Releases a share of the buffers on its own thread.
+class BufferReleaser {
+ public:
+  BufferReleaser() : thread_(ThreadWrapper::CreateThread(&Run, this, "r")) {}
+
+  void Release(std::vector<rtc::scoped_refptr<VideoFrameBuffer>>* buffers,
+               size_t count) {
+    buffers_.assign(buffers->end() - count, buffers->end());
+    buffers->resize(buffers->size() - count);
+    thread_->Start();
+  }
+  void Stop() { thread_->Stop(); }
+
+ private:
+  static bool Run(void* obj) {
+    BufferReleaser* releaser = static_cast<BufferReleaser*>(obj);
+    releaser->buffers_.clear();
+    return false;
+  }
+
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  std::vector<rtc::scoped_refptr<VideoFrameBuffer>> buffers_;
+};
+
+}  // namespace
+
 TEST(TestI420BufferPool, SimpleFrameReuse) {
   I420BufferPool pool;
   rtc::scoped_refptr<VideoFrameBuffer> buffer = pool.CreateBuffer(16, 16);
@@ -71,4 +105,132 @@ TEST(TestI420BufferPool, FrameValidAfterPoolDestruction) {
   memset(buffer->MutableData(kYPlane), 0xA5, 16 * buffer->stride(kYPlane));
 }
 
+TEST(TestI420BufferPool, ReuseAfterResolutionSwitch) {
+  SimulatedClock clock(0);
+  I420BufferPool pool(I420BufferPool::kDefaultMaxNumberOfBuffers,
+                      kMaxIdleTimeMs, &clock);
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = pool.CreateBuffer(16, 16);
+  const uint8_t* small_y_ptr = buffer->data(kYPlane);
+  buffer = pool.CreateBuffer(32, 16);
+  const uint8_t* large_y_ptr = buffer->data(kYPlane);
+  buffer = pool.CreateBuffer(16, 16);
+  EXPECT_EQ(small_y_ptr, buffer->data(kYPlane));
+  buffer = pool.CreateBuffer(32, 16);
+  EXPECT_EQ(large_y_ptr, buffer->data(kYPlane));
+  buffer = nullptr;
+
+  I420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(2, stats.num_hits);
+  EXPECT_EQ(2, stats.num_misses);
+  EXPECT_EQ(2, stats.num_buffers);
+  EXPECT_EQ(2, stats.num_free_buffers);
+  EXPECT_EQ(16u * 16 * 3 / 2 + 32u * 16 * 3 / 2, stats.bytes_held);
+}
+
+TEST(TestI420BufferPool, FreesIdleBuffers) {
+  SimulatedClock clock(0);
+  I420BufferPool pool(I420BufferPool::kDefaultMaxNumberOfBuffers,
+                      kMaxIdleTimeMs, &clock);
+  rtc::scoped_refptr<VideoFrameBuffer> idle = pool.CreateBuffer(32, 16);
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = pool.CreateBuffer(16, 16);
+  idle = nullptr;
+  EXPECT_EQ(1, pool.GetStats().num_free_buffers);
+  // The buffer in use is kept, however long it is used.
+  clock.AdvanceTimeMilliseconds(kMaxIdleTimeMs - 1);
+  EXPECT_EQ(2, pool.GetStats().num_buffers);
+  clock.AdvanceTimeMilliseconds(1);
+  I420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(1, stats.num_buffers);
+  EXPECT_EQ(0, stats.num_free_buffers);
+  EXPECT_EQ(16u * 16 * 3 / 2, stats.bytes_held);
+
+  buffer = nullptr;
+  EXPECT_EQ(1, pool.GetStats().num_free_buffers);
+  clock.AdvanceTimeMilliseconds(kMaxIdleTimeMs);
+  stats = pool.GetStats();
+  EXPECT_EQ(0, stats.num_buffers);
+  EXPECT_EQ(0u, stats.bytes_held);
+}
+
+TEST(TestI420BufferPool, LimitsNumberOfBuffers) {
+  SimulatedClock clock(0);
+  I420BufferPool pool(2, kMaxIdleTimeMs, &clock);
+  std::vector<rtc::scoped_refptr<VideoFrameBuffer>> buffers;
+  for (int i = 0; i < 3; ++i) {
+    buffers.push_back(pool.CreateBuffer(16, 16));
+    EXPECT_TRUE(buffers.back()->HasOneRef());
+    EXPECT_EQ(16, buffers.back()->width());
+  }
+  I420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(3, stats.num_misses);
+  EXPECT_EQ(2, stats.num_buffers);
+  buffers.clear();
+  stats = pool.GetStats();
+  EXPECT_EQ(2, stats.num_buffers);
+  EXPECT_EQ(2, stats.num_free_buffers);
+
+  // A free buffer of another resolution is freed to make room.
+  clock.AdvanceTimeMilliseconds(1);
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = pool.CreateBuffer(32, 16);
+  stats = pool.GetStats();
+  EXPECT_EQ(2, stats.num_buffers);
+  EXPECT_EQ(1, stats.num_free_buffers);
+  EXPECT_EQ(16u * 16 * 3 / 2 + 32u * 16 * 3 / 2, stats.bytes_held);
+}
+
+TEST(TestI420BufferPool, Preallocate) {
+  I420BufferPool pool;
+  pool.Preallocate(16, 16, 3);
+  I420BufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(3, stats.num_buffers);
+  EXPECT_EQ(3, stats.num_free_buffers);
+  std::vector<rtc::scoped_refptr<VideoFrameBuffer>> buffers;
+  for (int i = 0; i < 3; ++i)
+    buffers.push_back(pool.CreateBuffer(16, 16));
+  pool.Preallocate(16, 16, 3);
+  stats = pool.GetStats();
+  EXPECT_EQ(3, stats.num_hits);
+  EXPECT_EQ(0, stats.num_misses);
+  EXPECT_EQ(3, stats.num_buffers);
+  EXPECT_EQ(0, stats.num_free_buffers);
+}
+
+TEST(TestI420BufferPool, BuffersInUseAreFreedAfterRelease) {
+  I420BufferPool pool;
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = pool.CreateBuffer(16, 16);
+  pool.Release();
+  EXPECT_EQ(0, pool.GetStats().num_buffers);
+  buffer = nullptr;
+  EXPECT_EQ(0, pool.GetStats().num_buffers);
+  buffer = pool.CreateBuffer(16, 16);
+  buffer = nullptr;
+  EXPECT_EQ(1, pool.GetStats().num_free_buffers);
+}
+
+TEST(TestI420BufferPool, ReleaseOnOtherThreads) {
+  const int kNumThreads = 4;
+  const int kBuffersPerThread = 50;
+  SimulatedClock clock(0);
+  I420BufferPool pool(kNumThreads * kBuffersPerThread, kMaxIdleTimeMs, &clock);
+  for (int round = 0; round < 10; ++round) {
+    std::vector<rtc::scoped_refptr<VideoFrameBuffer>> buffers;
+    for (int i = 0; i < kNumThreads * kBuffersPerThread; ++i)
+      buffers.push_back(pool.CreateBuffer(16, 16));
+    ScopedVector<BufferReleaser> releasers;
+    for (int i = 0; i < kNumThreads; ++i) {
+      releasers.push_back(new BufferReleaser());
+      releasers.back()->Release(&buffers, kBuffersPerThread);
+    }
+    // Collect the buffers while they are being released.
+    for (int i = 0; i < 100; ++i)
+      pool.GetStats();
+    for (BufferReleaser* releaser : releasers)
+      releaser->Stop();
+    I420BufferPool::Stats stats = pool.GetStats();
+    ASSERT_EQ(kNumThreads * kBuffersPerThread, stats.num_buffers);
+    ASSERT_EQ(kNumThreads * kBuffersPerThread, stats.num_free_buffers);
+  }
+  EXPECT_EQ(9 * kNumThreads * kBuffersPerThread, pool.GetStats().num_hits);
+}
+
 }  // namespace webrtc
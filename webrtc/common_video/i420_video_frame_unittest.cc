@@ -13,9 +13,17 @@
 #include <math.h>
 #include <string.h>
 
+#if defined(WEBRTC_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/bind.h"
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_video/interface/shared_memory_buffer.h"
 #include "webrtc/test/fake_texture_frame.h"
 
 namespace webrtc {
@@ -258,6 +266,135 @@ TEST(TestVideoFrame, TextureInitialValues) {
   EXPECT_EQ(20, frame.render_time_ms());
 }
 
+namespace {
+
+// An NV12 frame where each pixel value depends on its position, and the I420
+// frame it converts to.
+void CreateNV12Frame(int width,
+                     int height,
+                     std::vector<uint8_t>* nv12,
+                     VideoFrame* i420_frame) {
+  const int half_width = (width + 1) / 2;
+  const int half_height = (height + 1) / 2;
+  nv12->resize(width * height + 2 * half_width * half_height);
+  i420_frame->CreateEmptyFrame(width, height, width, half_width, half_width);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const uint8_t value = static_cast<uint8_t>(x + 3 * y);
+      (*nv12)[y * width + x] = value;
+      i420_frame->buffer(kYPlane)[y * width + x] = value;
+    }
+  }
+  uint8_t* uv = &(*nv12)[width * height];
+  for (int y = 0; y < half_height; ++y) {
+    for (int x = 0; x < half_width; ++x) {
+      const uint8_t u = static_cast<uint8_t>(2 * x + y);
+      const uint8_t v = static_cast<uint8_t>(255 - x - 2 * y);
+      uv[y * 2 * half_width + 2 * x] = u;
+      uv[y * 2 * half_width + 2 * x + 1] = v;
+      i420_frame->buffer(kUPlane)[y * half_width + x] = u;
+      i420_frame->buffer(kVPlane)[y * half_width + x] = v;
+    }
+  }
+}
+
+void SetTrue(bool* released) {
+  *released = true;
+}
+
+#if defined(WEBRTC_LINUX) && defined(__NR_memfd_create)
+// Stand-in for shared memory from a capture device or another process.
+int CreateSharedMemory(const uint8_t* data, size_t offset, size_t size) {
+  const int fd = static_cast<int>(
+      syscall(__NR_memfd_create, "nv12_frame", 0));
+  if (fd < 0)
+    return -1;
+  if (ftruncate(fd, offset + size) != 0 ||
+      pwrite(fd, data, size, offset) != static_cast<ssize_t>(size)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+#endif
+
+}  // namespace
+
+TEST(TestVideoFrame, NV12FrameIsOnlyConvertedWhenAsked) {
+  const int kWidth = 35;
+  const int kHeight = 21;
+  std::vector<uint8_t> nv12;
+  VideoFrame expected_frame;
+  CreateNV12Frame(kWidth, kHeight, &nv12, &expected_frame);
+
+  bool released = false;
+  {
+    const int half_width = (kWidth + 1) / 2;
+    VideoFrame frame(new rtc::RefCountedObject<WrappedNV12Buffer>(
+                         kWidth, kHeight, &nv12[0], kWidth,
+                         &nv12[kWidth * kHeight], 2 * half_width,
+                         rtc::Bind(&SetTrue, &released)),
+                     100, 10, kVideoRotation_0);
+    EXPECT_EQ(kWidth, frame.width());
+    EXPECT_EQ(kHeight, frame.height());
+    EXPECT_TRUE(frame.native_handle() != nullptr);
+
+    // Copying shares the buffer.
+    const FrameBufferCounts counts_before = GetFrameBufferCounts();
+    VideoFrame copied_frame;
+    copied_frame.CopyFrame(frame);
+    EXPECT_EQ(frame.video_frame_buffer(), copied_frame.video_frame_buffer());
+    EXPECT_EQ(counts_before.num_copies, GetFrameBufferCounts().num_copies);
+
+    VideoFrame i420_frame = frame.ConvertNativeToI420Frame();
+    EXPECT_EQ(counts_before.num_conversions + 1,
+              GetFrameBufferCounts().num_conversions);
+    EXPECT_TRUE(i420_frame.native_handle() == nullptr);
+    EXPECT_EQ(100u, i420_frame.timestamp());
+    EXPECT_EQ(10, i420_frame.render_time_ms());
+    expected_frame.set_timestamp(100);
+    expected_frame.set_render_time_ms(10);
+    EXPECT_TRUE(EqualFrames(expected_frame, i420_frame));
+    EXPECT_FALSE(released);
+  }
+  EXPECT_TRUE(released);
+}
+
+TEST(TestVideoFrame, CopyFrameCountsCopies) {
+  VideoFrame frame;
+  frame.CreateEmptyFrame(16, 16, 16, 8, 8);
+  const FrameBufferCounts counts_before = GetFrameBufferCounts();
+  VideoFrame copied_frame;
+  copied_frame.CopyFrame(frame);
+  EXPECT_EQ(counts_before.num_copies + 1, GetFrameBufferCounts().num_copies);
+  EXPECT_EQ(counts_before.num_conversions,
+            GetFrameBufferCounts().num_conversions);
+}
+
+#if defined(WEBRTC_LINUX) && defined(__NR_memfd_create)
+TEST(TestVideoFrame, SharedMemoryNV12Frame) {
+  const int kWidth = 64;
+  const int kHeight = 48;
+  // Not page aligned.
+  const size_t kOffset = 100;
+  std::vector<uint8_t> nv12;
+  VideoFrame expected_frame;
+  CreateNV12Frame(kWidth, kHeight, &nv12, &expected_frame);
+  const int fd = CreateSharedMemory(&nv12[0], kOffset, nv12.size());
+  ASSERT_GE(fd, 0);
+
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = MapSharedMemoryNV12Buffer(
+      fd, kOffset, kWidth, kHeight, kWidth, kWidth);
+  // The mapping outlives the file descriptor.
+  close(fd);
+  ASSERT_TRUE(buffer);
+  EXPECT_TRUE(buffer->native_handle() != nullptr);
+
+  VideoFrame frame(buffer, 0, 0, kVideoRotation_0);
+  EXPECT_TRUE(EqualFrames(expected_frame, frame.ConvertNativeToI420Frame()));
+}
+#endif
+
 bool EqualPlane(const uint8_t* data1,
                 const uint8_t* data2,
                 int stride,
@@ -11,31 +11,115 @@
 #ifndef WEBRTC_COMMON_VIDEO_INTERFACE_I420_BUFFER_POOL_H_
 #define WEBRTC_COMMON_VIDEO_INTERFACE_I420_BUFFER_POOL_H_
 
-#include <list>
+#include <deque>
+#include <map>
+#include <utility>
 
+#include "webrtc/base/constructormagic.h"
 #include "webrtc/base/thread_checker.h"
 #include "webrtc/common_video/interface/video_frame_buffer.h"
 
 namespace webrtc {
 
-// Simple buffer pool to avoid unnecessary allocations of I420Buffer objects.
+class Clock;
+
+// Buffer pool to avoid unnecessary allocations of I420Buffer objects.
 // The pool manages the memory of the I420Buffer returned from CreateBuffer.
 // When the I420Buffer is destructed, the memory is returned to the pool for use
-// by subsequent calls to CreateBuffer. If the resolution passed to CreateBuffer
-// changes, old buffers will be purged from the pool.
+// by subsequent calls to CreateBuffer.
+//
+// The free buffers are kept per resolution, so switching between a few
+// resolutions, e.g. with simulcast, doesn't reallocate. A free buffer which
+// hasn't been reused for |max_idle_time_ms| is freed, and the pool never owns
+// more than |max_number_of_buffers|; beyond that CreateBuffer returns buffers
+// which are freed when released.
+//
+// CreateBuffer and the other methods must be called on one thread, but the
+// buffers may be released on any thread. They are returned to the pool through
+// a lock-free list, so releasing a buffer never blocks.
 class I420BufferPool {
  public:
+  static const int kDefaultMaxNumberOfBuffers = 32;
+  static const int64_t kDefaultMaxIdleTimeMs = 2000;
+
+  struct Stats {
+    Stats()
+        : num_hits(0),
+          num_misses(0),
+          num_buffers(0),
+          num_free_buffers(0),
+          bytes_held(0) {}
+
+    // The number of CreateBuffer calls which reused a free buffer, and the
+    // number which allocated a new one.
+    int64_t num_hits;
+    int64_t num_misses;
+    // The buffers owned by the pool, whether in use or free, and their size.
+    int num_buffers;
+    int num_free_buffers;
+    size_t bytes_held;
+  };
+
   I420BufferPool();
+  // |clock| is used to measure the idle time of the free buffers.
+  I420BufferPool(int max_number_of_buffers,
+                 int64_t max_idle_time_ms,
+                 Clock* clock);
+  ~I420BufferPool();
+
   // Returns a buffer from the pool, or creates a new buffer if no suitable
   // buffer exists in the pool.
   rtc::scoped_refptr<VideoFrameBuffer> CreateBuffer(int width, int height);
-  // Clears buffers_ and detaches the thread checker so that it can be reused
-  // later from another thread.
+  // Makes sure the pool owns at least |count| buffers of the given
+  // resolution, e.g. ahead of a resolution switch. Like released buffers, the
+  // preallocated buffers are freed if they stay unused for too long.
+  void Preallocate(int width, int height, int count);
+  // Frees the free buffers, lets the buffers in use be freed when released,
+  // and detaches the thread checker so that the pool can be reused later from
+  // another thread.
   void Release();
 
+  Stats GetStats();
+
  private:
+  class PooledI420Buffer;
+  class ReleasedBuffers;
+
+  // The buffers of one resolution.
+  struct Bucket {
+    Bucket() : num_buffers(0), buffer_size(0) {}
+
+    // The free buffers, the least recently released first.
+    std::deque<PooledI420Buffer*> free_buffers;
+    // The free buffers and those in use.
+    int num_buffers;
+    size_t buffer_size;
+  };
+  typedef std::map<std::pair<int, int>, Bucket> BucketMap;
+
+  // Moves the buffers released since the last call to their buckets, and
+  // frees the buffers which have been free for |max_idle_time_ms_|.
+  void CollectReleasedBuffers();
+  // Frees the free buffer released the longest time ago, of any resolution.
+  // Returns false if there are no free buffers.
+  bool FreeLeastRecentlyReleasedBuffer();
+  // Frees all free buffers and lets the buffers in use be freed when released.
+  void Clear();
+
+  PooledI420Buffer* AllocateBuffer(int width, int height, Bucket* bucket);
+
+  const int max_number_of_buffers_;
+  const int64_t max_idle_time_ms_;
+  Clock* const clock_;
+
   rtc::ThreadChecker thread_checker_;
-  std::list<rtc::scoped_refptr<I420Buffer>> buffers_;
+  rtc::scoped_refptr<ReleasedBuffers> released_buffers_;
+  BucketMap buckets_;
+  int num_buffers_;
+  int64_t num_hits_;
+  int64_t num_misses_;
+
+  DISALLOW_COPY_AND_ASSIGN(I420BufferPool);
 };
 
 }  // namespace webrtc
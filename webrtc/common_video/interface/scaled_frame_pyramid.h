@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_VIDEO_INTERFACE_SCALED_FRAME_PYRAMID_H_
+#define WEBRTC_COMMON_VIDEO_INTERFACE_SCALED_FRAME_PYRAMID_H_
+
+#include <list>
+#include <map>
+#include <utility>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/thread_annotations.h"
+#include "webrtc/common_video/interface/video_frame_buffer.h"
+
+namespace webrtc {
+
+class ScaledFramePyramidPool;
+
+// The scaled versions of a captured frame, built on demand and cached, so that
+// the consumers which scale the frame to the same size, e.g. the simulcast
+// encoder, the frame preprocessor and the quality scaler, scale it only once.
+// The frame is scaled like Scaler with kScaleBox does: the largest center
+// region with the aspect ratio of the requested size is scaled, so a scaled
+// frame doesn't depend on which consumer asked for it first.
+//
+// The pyramid is attached to the captured VideoFrame and shared by its copies
+// and by the scaled frames taken from it. The frame must not be modified while
+// the pyramid is attached. GetScaledBuffer may be called on any thread.
+class ScaledFramePyramid : public rtc::RefCountInterface {
+ public:
+  // |pool|, if not null, provides the buffers of the scaled frames.
+  ScaledFramePyramid(const rtc::scoped_refptr<VideoFrameBuffer>& buffer,
+                     const rtc::scoped_refptr<ScaledFramePyramidPool>& pool);
+
+  // Returns the frame scaled to |width|x|height|, or the frame itself if it
+  // already has that size.
+  rtc::scoped_refptr<VideoFrameBuffer> GetScaledBuffer(int width, int height);
+
+  int width() const { return buffer_->width(); }
+  int height() const { return buffer_->height(); }
+
+  // The number of GetScaledBuffer calls which scaled the frame, and the number
+  // which returned a cached scaled frame.
+  int num_scaled_frames() const;
+  int num_reused_frames() const;
+
+ protected:
+  ~ScaledFramePyramid() override;
+
+ private:
+  typedef std::map<std::pair<int, int>, rtc::scoped_refptr<VideoFrameBuffer>>
+      LevelMap;
+
+  rtc::scoped_refptr<VideoFrameBuffer> Scale(int width, int height) const;
+
+  const rtc::scoped_refptr<VideoFrameBuffer> buffer_;
+  const rtc::scoped_refptr<ScaledFramePyramidPool> pool_;
+
+  mutable rtc::CriticalSection crit_;
+  LevelMap levels_ GUARDED_BY(crit_);
+  int num_scaled_frames_ GUARDED_BY(crit_);
+  int num_reused_frames_ GUARDED_BY(crit_);
+
+  DISALLOW_COPY_AND_ASSIGN(ScaledFramePyramid);
+};
+
+// Creates the pyramids of consecutive frames, recycles the buffers of their
+// scaled frames, and counts how many scaling passes the pyramids saved. Thread
+// safe.
+class ScaledFramePyramidPool : public rtc::RefCountInterface {
+ public:
+  static const int kMaxNumberOfBuffers = 16;
+
+  struct Stats {
+    Stats() : num_frames(0), num_scaled_frames(0), num_reused_frames(0) {}
+
+    // The frames whose pyramids have been freed, and the frames those pyramids
+    // scaled and reused.
+    int64_t num_frames;
+    int64_t num_scaled_frames;
+    int64_t num_reused_frames;
+  };
+
+  ScaledFramePyramidPool();
+
+  rtc::scoped_refptr<ScaledFramePyramid> CreatePyramid(
+      const rtc::scoped_refptr<VideoFrameBuffer>& buffer);
+
+  Stats GetStats() const;
+
+ protected:
+  ~ScaledFramePyramidPool() override;
+
+ private:
+  friend class ScaledFramePyramid;
+
+  // Returns a buffer no one else references, or a new buffer.
+  rtc::scoped_refptr<I420Buffer> GetBuffer(int width, int height);
+  void OnPyramidFreed(int num_scaled_frames, int num_reused_frames);
+
+  mutable rtc::CriticalSection crit_;
+  // The least recently allocated buffers first.
+  std::list<rtc::scoped_refptr<I420Buffer>> buffers_ GUARDED_BY(crit_);
+  Stats stats_ GUARDED_BY(crit_);
+
+  DISALLOW_COPY_AND_ASSIGN(ScaledFramePyramidPool);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_VIDEO_INTERFACE_SCALED_FRAME_PYRAMID_H_
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_COMMON_VIDEO_INTERFACE_SHARED_MEMORY_BUFFER_H_
+#define WEBRTC_COMMON_VIDEO_INTERFACE_SHARED_MEMORY_BUFFER_H_
+
+#include <stddef.h>
+
+#include "webrtc/common_video/interface/video_frame_buffer.h"
+
+namespace webrtc {
+
+#if defined(WEBRTC_POSIX)
+// Maps an NV12 frame in shared memory, e.g. a memfd, shm or dmabuf file
+// descriptor, and wraps it without copying it. The Y plane starts at |offset|
+// and the UV plane right after it, at |offset| + |y_stride| * |height|. The
+// memory is mapped read only and unmapped when the buffer is released; |fd|
+// may be closed as soon as this returns. For dmabufs the producer must have
+// finished writing the frame. Returns null if the memory can't be mapped.
+rtc::scoped_refptr<VideoFrameBuffer> MapSharedMemoryNV12Buffer(int fd,
+                                                               size_t offset,
+                                                               int width,
+                                                               int height,
+                                                               int y_stride,
+                                                               int uv_stride);
+#endif  // defined(WEBRTC_POSIX)
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_COMMON_VIDEO_INTERFACE_SHARED_MEMORY_BUFFER_H_
@@ -145,6 +145,52 @@ class WrappedI420Buffer : public webrtc::VideoFrameBuffer {
   rtc::Callback0<void> no_longer_used_cb_;
 };
 
+// NV12 buffer in memory owned by someone else, e.g. a capture device or shared
+// memory: a Y plane followed by an interleaved UV plane of half the height.
+// It is kept as a native buffer, so it's passed along as it is until it's
+// converted by NativeToI420Buffer() for a consumer which needs I420.
+class WrappedNV12Buffer : public NativeHandleBuffer {
+ public:
+  WrappedNV12Buffer(int width,
+                    int height,
+                    const uint8_t* y_plane,
+                    int y_stride,
+                    const uint8_t* uv_plane,
+                    int uv_stride,
+                    const rtc::Callback0<void>& no_longer_used);
+
+  const uint8_t* y_plane() const { return y_plane_; }
+  const uint8_t* uv_plane() const { return uv_plane_; }
+  int y_stride() const { return y_stride_; }
+  int uv_stride() const { return uv_stride_; }
+
+  rtc::scoped_refptr<VideoFrameBuffer> NativeToI420Buffer() override;
+
+ private:
+  friend class rtc::RefCountedObject<WrappedNV12Buffer>;
+  ~WrappedNV12Buffer() override;
+
+  const uint8_t* const y_plane_;
+  const uint8_t* const uv_plane_;
+  const int y_stride_;
+  const int uv_stride_;
+  rtc::Callback0<void> no_longer_used_cb_;
+};
+
+// Process wide counts of conversions of frame buffers to I420, e.g. from
+// native or NV12 buffers, and of deep copies of I420 frames. Used to see how
+// many conversions and copies frames go through on their way to the encoder.
+struct FrameBufferCounts {
+  FrameBufferCounts() : num_conversions(0), num_copies(0) {}
+
+  int num_conversions;
+  int num_copies;
+};
+
+void CountFrameBufferConversion();
+void CountFrameBufferCopy();
+FrameBufferCounts GetFrameBufferCounts();
+
 // Helper function to crop |buffer| without making a deep copy. May only be used
 // for non-native frames.
 rtc::scoped_refptr<VideoFrameBuffer> ShallowCenterCrop(
@@ -45,6 +45,8 @@ class Scaler {
 
   // Scale frame
   // Memory is allocated by this object and recycled using |buffer_pool_|.
+  // With kScaleBox, a frame with a scaled frame pyramid is scaled through the
+  // pyramid instead, and |dst_frame| shares the cached buffer.
   // Return value: 0 - OK,
   //               -1 - parameter error
   //               -2 - scaler not set
@@ -54,6 +54,17 @@ int Scaler::Scale(const VideoFrame& src_frame, VideoFrame* dst_frame) {
   if (!set_)
     return -2;
 
+  // Reuse the frame scaled by other consumers of the captured frame, if any.
+  // The pyramid scales the captured frame itself, not |src_frame|, which may
+  // be one of its scaled frames.
+  ScaledFramePyramid* pyramid = src_frame.scaled_frame_pyramid();
+  if (pyramid && method_ == kScaleBox) {
+    dst_frame->set_video_frame_buffer(
+        pyramid->GetScaledBuffer(dst_width_, dst_height_));
+    dst_frame->set_scaled_frame_pyramid(pyramid);
+    return 0;
+  }
+
   // Making sure that destination frame is of sufficient size.
   dst_frame->set_video_frame_buffer(
       buffer_pool_.CreateBuffer(dst_width_, dst_height_));
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_video/interface/scaled_frame_pyramid.h"
+
+#include <algorithm>
+
+#include "webrtc/base/checks.h"
+// NOTE(ajm): Path provided by gyp.
+#include "libyuv.h"  // NOLINT
+
+namespace webrtc {
+
+ScaledFramePyramid::ScaledFramePyramid(
+    const rtc::scoped_refptr<VideoFrameBuffer>& buffer,
+    const rtc::scoped_refptr<ScaledFramePyramidPool>& pool)
+    : buffer_(buffer),
+      pool_(pool),
+      num_scaled_frames_(0),
+      num_reused_frames_(0) {
+  DCHECK(buffer_);
+  DCHECK(!buffer_->native_handle());
+}
+
+ScaledFramePyramid::~ScaledFramePyramid() {
+  if (pool_)
+    pool_->OnPyramidFreed(num_scaled_frames_, num_reused_frames_);
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> ScaledFramePyramid::GetScaledBuffer(
+    int width,
+    int height) {
+  DCHECK_GT(width, 0);
+  DCHECK_GT(height, 0);
+  if (width == buffer_->width() && height == buffer_->height())
+    return buffer_;
+
+  const std::pair<int, int> size(width, height);
+  {
+    rtc::CritScope lock(&crit_);
+    LevelMap::const_iterator it = levels_.find(size);
+    if (it != levels_.end()) {
+      ++num_reused_frames_;
+      return it->second;
+    }
+  }
+
+  // Scale without holding the lock, so that other sizes can be scaled on other
+  // threads meanwhile. If another thread scaled to the same size first, its
+  // frame is kept and returned.
+  rtc::scoped_refptr<VideoFrameBuffer> scaled = Scale(width, height);
+  rtc::CritScope lock(&crit_);
+  ++num_scaled_frames_;
+  return levels_.insert(std::make_pair(size, scaled)).first->second;
+}
+
+int ScaledFramePyramid::num_scaled_frames() const {
+  rtc::CritScope lock(&crit_);
+  return num_scaled_frames_;
+}
+
+int ScaledFramePyramid::num_reused_frames() const {
+  rtc::CritScope lock(&crit_);
+  return num_reused_frames_;
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> ScaledFramePyramid::Scale(
+    int width,
+    int height) const {
+  rtc::scoped_refptr<I420Buffer> scaled =
+      pool_ ? pool_->GetBuffer(width, height)
+            : new rtc::RefCountedObject<I420Buffer>(width, height);
+
+  // Crop the frame like Scaler does, to preserve the aspect ratio.
+  const int src_width = buffer_->width();
+  const int src_height = buffer_->height();
+  const int cropped_src_width =
+      std::min(src_width, width * src_height / height);
+  const int cropped_src_height =
+      std::min(src_height, height * src_width / width);
+  // Make sure the offsets are even to avoid rounding errors for the U/V planes.
+  const int src_offset_x = ((src_width - cropped_src_width) / 2) & ~1;
+  const int src_offset_y = ((src_height - cropped_src_height) / 2) & ~1;
+
+  const uint8_t* y_ptr = buffer_->data(kYPlane) +
+                         src_offset_y * buffer_->stride(kYPlane) +
+                         src_offset_x;
+  const uint8_t* u_ptr = buffer_->data(kUPlane) +
+                         src_offset_y / 2 * buffer_->stride(kUPlane) +
+                         src_offset_x / 2;
+  const uint8_t* v_ptr = buffer_->data(kVPlane) +
+                         src_offset_y / 2 * buffer_->stride(kVPlane) +
+                         src_offset_x / 2;
+
+  // The pool still references |scaled|, but no one reads it until it's
+  // returned. Scaler's kScaleBox corresponds to libyuv::kFilterBilinear.
+  libyuv::I420Scale(y_ptr, buffer_->stride(kYPlane),
+                    u_ptr, buffer_->stride(kUPlane),
+                    v_ptr, buffer_->stride(kVPlane),
+                    cropped_src_width, cropped_src_height,
+                    const_cast<uint8_t*>(scaled->data(kYPlane)),
+                    scaled->stride(kYPlane),
+                    const_cast<uint8_t*>(scaled->data(kUPlane)),
+                    scaled->stride(kUPlane),
+                    const_cast<uint8_t*>(scaled->data(kVPlane)),
+                    scaled->stride(kVPlane),
+                    width, height, libyuv::kFilterBilinear);
+  return scaled;
+}
+
+ScaledFramePyramidPool::ScaledFramePyramidPool() {}
+
+ScaledFramePyramidPool::~ScaledFramePyramidPool() {}
+
+rtc::scoped_refptr<ScaledFramePyramid> ScaledFramePyramidPool::CreatePyramid(
+    const rtc::scoped_refptr<VideoFrameBuffer>& buffer) {
+  return new rtc::RefCountedObject<ScaledFramePyramid>(buffer, this);
+}
+
+ScaledFramePyramidPool::Stats ScaledFramePyramidPool::GetStats() const {
+  rtc::CritScope lock(&crit_);
+  return stats_;
+}
+
+rtc::scoped_refptr<I420Buffer> ScaledFramePyramidPool::GetBuffer(int width,
+                                                                 int height) {
+  rtc::CritScope lock(&crit_);
+  // Only the pool can add references to a buffer it alone references, so the
+  // buffer stays free until returned.
+  std::list<rtc::scoped_refptr<I420Buffer>>::iterator free_buffer =
+      buffers_.end();
+  for (auto it = buffers_.begin(); it != buffers_.end(); ++it) {
+    if (!(*it)->HasOneRef())
+      continue;
+    if ((*it)->width() == width && (*it)->height() == height)
+      return *it;
+    if (free_buffer == buffers_.end())
+      free_buffer = it;
+  }
+
+  if (static_cast<int>(buffers_.size()) >= kMaxNumberOfBuffers) {
+    // Make room by freeing a buffer of another size, if possible.
+    if (free_buffer == buffers_.end())
+      return new rtc::RefCountedObject<I420Buffer>(width, height);
+    buffers_.erase(free_buffer);
+  }
+  buffers_.push_back(new rtc::RefCountedObject<I420Buffer>(width, height));
+  return buffers_.back();
+}
+
+void ScaledFramePyramidPool::OnPyramidFreed(int num_scaled_frames,
+                                            int num_reused_frames) {
+  rtc::CritScope lock(&crit_);
+  ++stats_.num_frames;
+  stats_.num_scaled_frames += num_scaled_frames;
+  stats_.num_reused_frames += num_reused_frames;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_video/interface/scaled_frame_pyramid.h"
+#include "webrtc/common_video/libyuv/include/scaler.h"
+#include "webrtc/video_frame.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kWidth = 352;
+const int kHeight = 288;
+
+rtc::scoped_refptr<VideoFrameBuffer> CreateBuffer(int width, int height) {
+  rtc::scoped_refptr<I420Buffer> buffer(
+      new rtc::RefCountedObject<I420Buffer>(width, height));
+  const int chroma_height = (height + 1) / 2;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x)
+      buffer->MutableData(kYPlane)[y * buffer->stride(kYPlane) + x] = x * y;
+  }
+  for (int y = 0; y < chroma_height; ++y) {
+    for (int x = 0; x < (width + 1) / 2; ++x) {
+      buffer->MutableData(kUPlane)[y * buffer->stride(kUPlane) + x] = x + y;
+      buffer->MutableData(kVPlane)[y * buffer->stride(kVPlane) + x] = x - y;
+    }
+  }
+  return buffer;
+}
+
+void ExpectEqualPlanes(const VideoFrameBuffer& a, const VideoFrameBuffer& b) {
+  ASSERT_EQ(a.width(), b.width());
+  ASSERT_EQ(a.height(), b.height());
+  for (int plane = kYPlane; plane < kNumOfPlanes; ++plane) {
+    const PlaneType type = static_cast<PlaneType>(plane);
+    const int width = type == kYPlane ? a.width() : (a.width() + 1) / 2;
+    const int height = type == kYPlane ? a.height() : (a.height() + 1) / 2;
+    for (int y = 0; y < height; ++y) {
+      EXPECT_EQ(0, memcmp(a.data(type) + y * a.stride(type),
+                          b.data(type) + y * b.stride(type), width));
+    }
+  }
+}
+
+}  // namespace
+
+class ScaledFramePyramidTest : public ::testing::Test {
+ protected:
+  ScaledFramePyramidTest()
+      : pool_(new rtc::RefCountedObject<ScaledFramePyramidPool>()),
+        buffer_(CreateBuffer(kWidth, kHeight)) {}
+
+  // Scales |buffer_| with Scaler, without a pyramid.
+  VideoFrame ScaleWithScaler(int width, int height) {
+    VideoFrame frame(buffer_, 0, 0, kVideoRotation_0);
+    VideoFrame scaled_frame;
+    Scaler scaler;
+    EXPECT_EQ(0, scaler.Set(kWidth, kHeight, width, height, kI420, kI420,
+                            kScaleBox));
+    EXPECT_EQ(0, scaler.Scale(frame, &scaled_frame));
+    return scaled_frame;
+  }
+
+  const rtc::scoped_refptr<ScaledFramePyramidPool> pool_;
+  const rtc::scoped_refptr<VideoFrameBuffer> buffer_;
+};
+
+TEST_F(ScaledFramePyramidTest, ReturnsFrameAtItsOwnSize) {
+  rtc::scoped_refptr<ScaledFramePyramid> pyramid =
+      pool_->CreatePyramid(buffer_);
+  EXPECT_EQ(buffer_, pyramid->GetScaledBuffer(kWidth, kHeight));
+  EXPECT_EQ(0, pyramid->num_scaled_frames());
+  EXPECT_EQ(0, pyramid->num_reused_frames());
+}
+
+TEST_F(ScaledFramePyramidTest, ReusesScaledFrames) {
+  rtc::scoped_refptr<ScaledFramePyramid> pyramid =
+      pool_->CreatePyramid(buffer_);
+  rtc::scoped_refptr<VideoFrameBuffer> half =
+      pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2);
+  rtc::scoped_refptr<VideoFrameBuffer> quarter =
+      pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4);
+  EXPECT_NE(half, quarter);
+  EXPECT_EQ(half, pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2));
+  EXPECT_EQ(quarter, pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4));
+  EXPECT_EQ(half, pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2));
+  EXPECT_EQ(2, pyramid->num_scaled_frames());
+  EXPECT_EQ(3, pyramid->num_reused_frames());
+}
+
+TEST_F(ScaledFramePyramidTest, ScalesLikeScaler) {
+  rtc::scoped_refptr<ScaledFramePyramid> pyramid =
+      pool_->CreatePyramid(buffer_);
+  // The last size has another aspect ratio, so the frame is cropped.
+  const int kSizes[][2] = {{176, 144}, {88, 72}, {240, 180}, {160, 90}};
+  for (const auto& size : kSizes) {
+    ExpectEqualPlanes(*ScaleWithScaler(size[0], size[1]).video_frame_buffer(),
+                      *pyramid->GetScaledBuffer(size[0], size[1]));
+  }
+}
+
+TEST_F(ScaledFramePyramidTest, ScalerSharesThePyramid) {
+  VideoFrame frame(buffer_, 0, 0, kVideoRotation_0);
+  frame.set_scaled_frame_pyramid(pool_->CreatePyramid(buffer_));
+  ScaledFramePyramid* pyramid = frame.scaled_frame_pyramid();
+
+  Scaler scaler;
+  VideoFrame half_frame;
+  ASSERT_EQ(0, scaler.Set(kWidth, kHeight, kWidth / 2, kHeight / 2, kI420,
+                          kI420, kScaleBox));
+  ASSERT_EQ(0, scaler.Scale(frame, &half_frame));
+  EXPECT_EQ(pyramid, half_frame.scaled_frame_pyramid());
+  EXPECT_EQ(pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2),
+            half_frame.video_frame_buffer());
+
+  // Scaling the scaled frame uses the pyramid of the captured frame too.
+  VideoFrame quarter_frame;
+  ASSERT_EQ(0, scaler.Set(kWidth / 2, kHeight / 2, kWidth / 4, kHeight / 4,
+                          kI420, kI420, kScaleBox));
+  ASSERT_EQ(0, scaler.Scale(half_frame, &quarter_frame));
+  EXPECT_EQ(pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4),
+            quarter_frame.video_frame_buffer());
+  EXPECT_EQ(2, pyramid->num_scaled_frames());
+  EXPECT_EQ(2, pyramid->num_reused_frames());
+
+  // Other scale methods don't use the pyramid.
+  VideoFrame bilinear_frame;
+  ASSERT_EQ(0, scaler.Set(kWidth, kHeight, kWidth / 2, kHeight / 2, kI420,
+                          kI420, kScaleBilinear));
+  ASSERT_EQ(0, scaler.Scale(frame, &bilinear_frame));
+  EXPECT_TRUE(bilinear_frame.scaled_frame_pyramid() == nullptr);
+  EXPECT_NE(pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2),
+            bilinear_frame.video_frame_buffer());
+}
+
+TEST_F(ScaledFramePyramidTest, VideoFrameCopiesSharePyramid) {
+  VideoFrame frame(buffer_, 0, 0, kVideoRotation_0);
+  frame.set_scaled_frame_pyramid(pool_->CreatePyramid(buffer_));
+
+  VideoFrame shallow_copy;
+  shallow_copy.ShallowCopy(frame);
+  EXPECT_EQ(frame.scaled_frame_pyramid(), shallow_copy.scaled_frame_pyramid());
+  VideoFrame copy_constructed(frame);
+  EXPECT_EQ(frame.scaled_frame_pyramid(),
+            copy_constructed.scaled_frame_pyramid());
+
+  // A deep copy may be modified, so it doesn't share the pyramid.
+  VideoFrame deep_copy;
+  deep_copy.CopyFrame(frame);
+  EXPECT_TRUE(deep_copy.scaled_frame_pyramid() == nullptr);
+
+  shallow_copy.set_video_frame_buffer(CreateBuffer(kWidth, kHeight));
+  EXPECT_TRUE(shallow_copy.scaled_frame_pyramid() == nullptr);
+  copy_constructed.Reset();
+  EXPECT_TRUE(copy_constructed.scaled_frame_pyramid() == nullptr);
+}
+
+TEST_F(ScaledFramePyramidTest, PoolRecyclesBuffers) {
+  rtc::scoped_refptr<ScaledFramePyramid> pyramid =
+      pool_->CreatePyramid(buffer_);
+  const VideoFrameBuffer* half =
+      pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2).get();
+  rtc::scoped_refptr<VideoFrameBuffer> quarter =
+      pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4);
+  pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4);
+  pyramid = nullptr;
+
+  ScaledFramePyramidPool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(1, stats.num_frames);
+  EXPECT_EQ(2, stats.num_scaled_frames);
+  EXPECT_EQ(1, stats.num_reused_frames);
+
+  // The half size buffer is free, the quarter size buffer is still in use.
+  pyramid = pool_->CreatePyramid(CreateBuffer(kWidth, kHeight));
+  EXPECT_EQ(half, pyramid->GetScaledBuffer(kWidth / 2, kHeight / 2).get());
+  EXPECT_NE(quarter, pyramid->GetScaledBuffer(kWidth / 4, kHeight / 4));
+}
+
+TEST_F(ScaledFramePyramidTest, PoolLimitsNumberOfBuffers) {
+  const int kMaxNumberOfBuffers = ScaledFramePyramidPool::kMaxNumberOfBuffers;
+  rtc::scoped_refptr<ScaledFramePyramid> pyramid =
+      pool_->CreatePyramid(buffer_);
+  std::vector<const VideoFrameBuffer*> pooled;
+  for (int i = 0; i < kMaxNumberOfBuffers; ++i)
+    pooled.push_back(pyramid->GetScaledBuffer(16 + 2 * i, 16).get());
+  // All pooled buffers are in use, so this one isn't pooled.
+  rtc::scoped_refptr<VideoFrameBuffer> unpooled =
+      pyramid->GetScaledBuffer(16 + 2 * kMaxNumberOfBuffers, 16);
+  pyramid = nullptr;
+
+  // A buffer of a new size replaces the least recently allocated free buffer.
+  pyramid = pool_->CreatePyramid(buffer_);
+  EXPECT_NE(unpooled,
+            pyramid->GetScaledBuffer(16 + 2 * kMaxNumberOfBuffers, 16));
+  for (int i = 1; i < kMaxNumberOfBuffers; ++i)
+    EXPECT_EQ(pooled[i], pyramid->GetScaledBuffer(16 + 2 * i, 16).get());
+}
+
+}  // namespace webrtc
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_video/interface/shared_memory_buffer.h"
+
+#if defined(WEBRTC_POSIX)
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "webrtc/base/bind.h"
+#include "webrtc/base/checks.h"
+#include "webrtc/system_wrappers/interface/logging.h"
+
+namespace webrtc {
+
+#if defined(WEBRTC_POSIX)
+namespace {
+
+void UnmapSharedMemory(void* address, size_t length) {
+  munmap(address, length);
+}
+
+}  // namespace
+
+rtc::scoped_refptr<VideoFrameBuffer> MapSharedMemoryNV12Buffer(int fd,
+                                                               size_t offset,
+                                                               int width,
+                                                               int height,
+                                                               int y_stride,
+                                                               int uv_stride) {
+  DCHECK_GT(width, 0);
+  DCHECK_GT(height, 0);
+  // mmap() needs a page aligned offset.
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t map_offset = offset - offset % page_size;
+  const size_t frame_size = static_cast<size_t>(y_stride) * height +
+                            static_cast<size_t>(uv_stride) * ((height + 1) / 2);
+  const size_t map_length = offset - map_offset + frame_size;
+  void* address = mmap(nullptr, map_length, PROT_READ, MAP_SHARED, fd,
+                       static_cast<off_t>(map_offset));
+  if (address == MAP_FAILED) {
+    LOG(LS_ERROR) << "Failed to map shared memory NV12 frame, fd " << fd
+                  << ", errno " << errno;
+    return nullptr;
+  }
+
+  const uint8_t* y_plane =
+      static_cast<const uint8_t*>(address) + (offset - map_offset);
+  const uint8_t* uv_plane = y_plane + static_cast<size_t>(y_stride) * height;
+  return new rtc::RefCountedObject<WrappedNV12Buffer>(
+      width, height, y_plane, y_stride, uv_plane, uv_stride,
+      rtc::Bind(&UnmapSharedMemory, address, map_length));
+}
+#endif  // defined(WEBRTC_POSIX)
+
+}  // namespace webrtc
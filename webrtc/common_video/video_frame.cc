@@ -49,6 +49,7 @@ int VideoFrame::CreateEmptyFrame(int width,
   DCHECK_GE(stride_v, half_width);
 
   // Creating empty frame - reset all values.
+  scaled_frame_pyramid_ = nullptr;
   timestamp_ = 0;
   ntp_time_ms_ = 0;
   render_time_ms_ = 0;
@@ -117,11 +118,14 @@ int VideoFrame::CreateFrame(const uint8_t* buffer,
 }
 
 int VideoFrame::CopyFrame(const VideoFrame& videoFrame) {
+  // The copy may be modified, so it doesn't share the pyramid.
+  scaled_frame_pyramid_ = nullptr;
   if (videoFrame.IsZeroSize()) {
     video_frame_buffer_ = nullptr;
   } else if (videoFrame.native_handle()) {
     video_frame_buffer_ = videoFrame.video_frame_buffer();
   } else {
+    CountFrameBufferCopy();
     CreateFrame(videoFrame.buffer(kYPlane), videoFrame.buffer(kUPlane),
                 videoFrame.buffer(kVPlane), videoFrame.width(),
                 videoFrame.height(), videoFrame.stride(kYPlane),
@@ -141,10 +145,12 @@ void VideoFrame::ShallowCopy(const VideoFrame& videoFrame) {
   ntp_time_ms_ = videoFrame.ntp_time_ms_;
   render_time_ms_ = videoFrame.render_time_ms_;
   rotation_ = videoFrame.rotation_;
+  scaled_frame_pyramid_ = videoFrame.scaled_frame_pyramid_;
 }
 
 void VideoFrame::Reset() {
   video_frame_buffer_ = nullptr;
+  scaled_frame_pyramid_ = nullptr;
   timestamp_ = 0;
   ntp_time_ms_ = 0;
   render_time_ms_ = 0;
@@ -192,6 +198,7 @@ rtc::scoped_refptr<VideoFrameBuffer> VideoFrame::video_frame_buffer() const {
 void VideoFrame::set_video_frame_buffer(
     const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer) {
   video_frame_buffer_ = buffer;
+  scaled_frame_pyramid_ = nullptr;
 }
 
 VideoFrame VideoFrame::ConvertNativeToI420Frame() const {
@@ -199,6 +206,8 @@ VideoFrame VideoFrame::ConvertNativeToI420Frame() const {
   VideoFrame frame;
   frame.ShallowCopy(*this);
   frame.set_video_frame_buffer(video_frame_buffer_->NativeToI420Buffer());
+  if (!frame.IsZeroSize())
+    CountFrameBufferConversion();
   return frame;
 }
 
@@ -10,6 +10,8 @@
 
 #include "webrtc/common_video/interface/video_frame_buffer.h"
 
+#include "libyuv.h"  // NOLINT
+#include "webrtc/base/atomicops.h"
 #include "webrtc/base/bind.h"
 #include "webrtc/base/checks.h"
 
@@ -22,6 +24,9 @@ namespace {
 // Used in rtc::Bind to keep a buffer alive until destructor is called.
 static void NoLongerUsedCallback(rtc::scoped_refptr<VideoFrameBuffer> dummy) {}
 
+volatile int g_num_conversions = 0;
+volatile int g_num_copies = 0;
+
 }  // anonymous namespace
 
 uint8_t* VideoFrameBuffer::MutableData(PlaneType type) {
@@ -210,6 +215,55 @@ rtc::scoped_refptr<VideoFrameBuffer> WrappedI420Buffer::NativeToI420Buffer() {
   return nullptr;
 }
 
+WrappedNV12Buffer::WrappedNV12Buffer(int width,
+                                     int height,
+                                     const uint8_t* y_plane,
+                                     int y_stride,
+                                     const uint8_t* uv_plane,
+                                     int uv_stride,
+                                     const rtc::Callback0<void>& no_longer_used)
+    : NativeHandleBuffer(const_cast<uint8_t*>(y_plane), width, height),
+      y_plane_(y_plane),
+      uv_plane_(uv_plane),
+      y_stride_(y_stride),
+      uv_stride_(uv_stride),
+      no_longer_used_cb_(no_longer_used) {
+  DCHECK_GE(y_stride, width);
+  DCHECK_GE(uv_stride, 2 * ((width + 1) / 2));
+}
+
+WrappedNV12Buffer::~WrappedNV12Buffer() {
+  no_longer_used_cb_();
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> WrappedNV12Buffer::NativeToI420Buffer() {
+  rtc::scoped_refptr<I420Buffer> buffer =
+      new rtc::RefCountedObject<I420Buffer>(width_, height_);
+  if (libyuv::NV12ToI420(y_plane_, y_stride_, uv_plane_, uv_stride_,
+                         buffer->MutableData(kYPlane), buffer->stride(kYPlane),
+                         buffer->MutableData(kUPlane), buffer->stride(kUPlane),
+                         buffer->MutableData(kVPlane), buffer->stride(kVPlane),
+                         width_, height_) != 0) {
+    return nullptr;
+  }
+  return buffer;
+}
+
+void CountFrameBufferConversion() {
+  rtc::AtomicOps::Increment(&g_num_conversions);
+}
+
+void CountFrameBufferCopy() {
+  rtc::AtomicOps::Increment(&g_num_copies);
+}
+
+FrameBufferCounts GetFrameBufferCounts() {
+  FrameBufferCounts counts;
+  counts.num_conversions = rtc::AtomicOps::AcquireLoad(&g_num_conversions);
+  counts.num_copies = rtc::AtomicOps::AcquireLoad(&g_num_copies);
+  return counts;
+}
+
 rtc::scoped_refptr<VideoFrameBuffer> ShallowCenterCrop(
     const rtc::scoped_refptr<VideoFrameBuffer>& buffer,
     int cropped_width,
@@ -1482,6 +1482,9 @@ AecCore* WebRtcAec_CreateAec() {
   if (WebRtc_GetCPUInfo(kSSE2)) {
     WebRtcAec_InitAec_SSE2();
   }
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    WebRtcAec_InitAec_AVX2();
+  }
 #endif
 
 #if defined(MIPS_FPU_LE)
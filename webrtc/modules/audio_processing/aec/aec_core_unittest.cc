@@ -0,0 +1,327 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Verifies that the AVX2 kernels stay within a small tolerance of the SSE2
+// kernels they replace. They are not bitexact because of the fused
+// multiply-adds.
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+// Included by aec_core_internal.h. Its C++ part must not get C linkage.
+#include "webrtc/common_audio/wav_file.h"
+extern "C" {
+#include "webrtc/modules/audio_processing/aec/aec_core.h"
+#include "webrtc/modules/audio_processing/aec/aec_core_internal.h"
+#include "webrtc/modules/audio_processing/aec/aec_rdft.h"
+}
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/aec/include/echo_cancellation.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+namespace webrtc {
+namespace {
+
+const int kSampleRateHz = 16000;
+const float kTolerance = 1e-5f;
+
+WebRtc_CPUInfo g_get_cpu_info = nullptr;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  if (feature == kAVX2 || feature == kFMA) {
+    return 0;
+  }
+  return g_get_cpu_info(feature);
+}
+
+bool HasAVX2() {
+  return WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA);
+}
+
+// Fills |data| with deterministic values in [-|scale|, |scale|).
+void FillRandom(float* data, size_t length, float scale, uint32_t* seed) {
+  for (size_t i = 0; i < length; ++i) {
+    *seed = *seed * 1664525 + 1013904223;
+    data[i] = scale * (static_cast<float>(*seed >> 8) / (1 << 23) - 1.f);
+  }
+}
+
+void ExpectNear(const float* reference, const float* test, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    EXPECT_NEAR(reference[i], test[i],
+                kTolerance * std::max(1.f, fabsf(reference[i])))
+        << "at index " << i;
+  }
+}
+
+// For outputs which sum many inputs, where the rounding errors scale with the
+// largest output rather than with each element.
+void ExpectNearRelativeToMax(const float* reference,
+                             const float* test,
+                             size_t length) {
+  const float max_reference = fabsf(*std::max_element(
+      reference, reference + length,
+      [](float a, float b) { return fabsf(a) < fabsf(b); }));
+  for (size_t i = 0; i < length; ++i) {
+    EXPECT_NEAR(reference[i], test[i], kTolerance * max_reference)
+        << "at index " << i;
+  }
+}
+
+// Captures the SSE2 and AVX2 kernel function pointers. The kernels are selected
+// in WebRtcAec_CreateAec(), so they are set up here directly, and the
+// selection of the CPU is restored afterwards.
+class AecCoreAvx2Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    aec_ = WebRtcAec_CreateAec();
+    ASSERT_TRUE(aec_ != nullptr);
+    ASSERT_EQ(0, WebRtcAec_InitAec(aec_, kSampleRateHz));
+    filter_far_ = WebRtcAec_FilterFar;
+    scale_error_signal_ = WebRtcAec_ScaleErrorSignal;
+    filter_adaptation_ = WebRtcAec_FilterAdaptation;
+    overdrive_and_suppress_ = WebRtcAec_OverdriveAndSuppress;
+    subband_coherence_ = WebRtcAec_SubbandCoherence;
+
+    WebRtcAec_InitAec_SSE2();
+    filter_far_sse2_ = WebRtcAec_FilterFar;
+    scale_error_signal_sse2_ = WebRtcAec_ScaleErrorSignal;
+    filter_adaptation_sse2_ = WebRtcAec_FilterAdaptation;
+    overdrive_and_suppress_sse2_ = WebRtcAec_OverdriveAndSuppress;
+
+    // The AVX2 kernels must only be installed where they can run.
+    if (HasAVX2()) {
+      WebRtcAec_InitAec_AVX2();
+      ASSERT_NE(filter_far_sse2_, WebRtcAec_FilterFar);
+      ASSERT_NE(scale_error_signal_sse2_, WebRtcAec_ScaleErrorSignal);
+      ASSERT_NE(filter_adaptation_sse2_, WebRtcAec_FilterAdaptation);
+      ASSERT_NE(overdrive_and_suppress_sse2_, WebRtcAec_OverdriveAndSuppress);
+    }
+
+    uint32_t seed = 1;
+    FillRandom(&aec_->xfBuf[0][0], sizeof(aec_->xfBuf) / sizeof(float), 1e3f,
+               &seed);
+    FillRandom(&aec_->wfBuf[0][0], sizeof(aec_->wfBuf) / sizeof(float), 1.f,
+               &seed);
+    FillRandom(aec_->xPow, PART_LEN1, 1e4f, &seed);
+    for (int i = 0; i < PART_LEN1; ++i) {
+      aec_->xPow[i] = fabsf(aec_->xPow[i]);
+    }
+    aec_->xfBufBlockPos = 5;
+  }
+
+  void TearDown() override {
+    WebRtcAec_FilterFar = filter_far_;
+    WebRtcAec_ScaleErrorSignal = scale_error_signal_;
+    WebRtcAec_FilterAdaptation = filter_adaptation_;
+    WebRtcAec_OverdriveAndSuppress = overdrive_and_suppress_;
+    WebRtcAec_SubbandCoherence = subband_coherence_;
+    WebRtcAec_FreeAec(aec_);
+  }
+
+  AecCore* aec_;
+  // The kernels selected for this CPU.
+  WebRtcAecFilterFar filter_far_;
+  WebRtcAecScaleErrorSignal scale_error_signal_;
+  WebRtcAecFilterAdaptation filter_adaptation_;
+  WebRtcAecOverdriveAndSuppress overdrive_and_suppress_;
+  WebRtcAecSubBandCoherence subband_coherence_;
+  WebRtcAecFilterFar filter_far_sse2_;
+  WebRtcAecScaleErrorSignal scale_error_signal_sse2_;
+  WebRtcAecFilterAdaptation filter_adaptation_sse2_;
+  WebRtcAecOverdriveAndSuppress overdrive_and_suppress_sse2_;
+};
+
+}  // namespace
+
+TEST_F(AecCoreAvx2Test, FilterFar) {
+  if (!HasAVX2()) {
+    return;
+  }
+  for (int num_partitions : {kNormalNumPartitions,
+                             static_cast<int>(kExtendedNumPartitions)}) {
+    aec_->num_partitions = num_partitions;
+    float reference[2][PART_LEN1];
+    float test[2][PART_LEN1];
+    uint32_t seed = 2;
+    FillRandom(&reference[0][0], 2 * PART_LEN1, 1.f, &seed);
+    memcpy(test, reference, sizeof(test));
+
+    filter_far_sse2_(aec_, reference);
+    WebRtcAec_FilterFar(aec_, test);
+    // Each bin sums the products of all partitions.
+    ExpectNearRelativeToMax(&reference[0][0], &test[0][0], 2 * PART_LEN1);
+  }
+}
+
+TEST_F(AecCoreAvx2Test, ScaleErrorSignal) {
+  if (!HasAVX2()) {
+    return;
+  }
+  for (int extended_filter = 0; extended_filter < 2; ++extended_filter) {
+    aec_->extended_filter_enabled = extended_filter;
+    float reference[2][PART_LEN1];
+    float test[2][PART_LEN1];
+    uint32_t seed = 3;
+    // Large enough for some, but not all, bins to exceed the error threshold.
+    FillRandom(&reference[0][0], 2 * PART_LEN1, 1e3f, &seed);
+    memcpy(test, reference, sizeof(test));
+
+    scale_error_signal_sse2_(aec_, reference);
+    WebRtcAec_ScaleErrorSignal(aec_, test);
+    ExpectNear(&reference[0][0], &test[0][0], 2 * PART_LEN1);
+  }
+}
+
+TEST_F(AecCoreAvx2Test, FilterAdaptation) {
+  if (!HasAVX2()) {
+    return;
+  }
+  aec_->num_partitions = kNormalNumPartitions;
+  float ef[2][PART_LEN1];
+  uint32_t seed = 4;
+  FillRandom(&ef[0][0], 2 * PART_LEN1, 1e-4f, &seed);
+  float fft[PART_LEN2];
+
+  static float reference[2][kExtendedNumPartitions * PART_LEN1];
+  memcpy(reference, aec_->wfBuf, sizeof(reference));
+  filter_adaptation_sse2_(aec_, fft, ef);
+  std::swap_ranges(&reference[0][0], &reference[0][0] +
+                       sizeof(reference) / sizeof(float),
+                   &aec_->wfBuf[0][0]);
+  WebRtcAec_FilterAdaptation(aec_, fft, ef);
+  ExpectNear(&reference[0][0], &aec_->wfBuf[0][0],
+             sizeof(reference) / sizeof(float));
+}
+
+TEST_F(AecCoreAvx2Test, OverdriveAndSuppress) {
+  if (!HasAVX2()) {
+    return;
+  }
+  aec_->overDriveSm = 2.5f;
+  float reference_hnl[PART_LEN1];
+  float reference_efw[2][PART_LEN1];
+  uint32_t seed = 5;
+  FillRandom(reference_hnl, PART_LEN1, 0.5f, &seed);
+  for (int i = 0; i < PART_LEN1; ++i) {
+    reference_hnl[i] += 0.5f;
+  }
+  FillRandom(&reference_efw[0][0], 2 * PART_LEN1, 1e3f, &seed);
+  float test_hnl[PART_LEN1];
+  float test_efw[2][PART_LEN1];
+  memcpy(test_hnl, reference_hnl, sizeof(test_hnl));
+  memcpy(test_efw, reference_efw, sizeof(test_efw));
+
+  const float hnl_fb = 0.5f;
+  overdrive_and_suppress_sse2_(aec_, reference_hnl, hnl_fb, reference_efw);
+  WebRtcAec_OverdriveAndSuppress(aec_, test_hnl, hnl_fb, test_efw);
+  ExpectNear(reference_hnl, test_hnl, PART_LEN1);
+  ExpectNear(&reference_efw[0][0], &test_efw[0][0], 2 * PART_LEN1);
+}
+
+TEST(AecRdftAvx2Test, ForwardAndInverse) {
+  if (!HasAVX2()) {
+    return;
+  }
+  float input[PART_LEN2];
+  uint32_t seed = 6;
+  FillRandom(input, PART_LEN2, 1e4f, &seed);
+
+  float reference_forward[PART_LEN2];
+  float reference_inverse[PART_LEN2];
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  WebRtc_GetCPUInfo = GetCPUInfoNoAVX2;
+  aec_rdft_init();
+  const RftSub128 cftmdl_128_sse2 = cftmdl_128;
+  memcpy(reference_forward, input, sizeof(input));
+  aec_rdft_forward_128(reference_forward);
+  memcpy(reference_inverse, reference_forward, sizeof(input));
+  aec_rdft_inverse_128(reference_inverse);
+
+  float forward[PART_LEN2];
+  float inverse[PART_LEN2];
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+  aec_rdft_init();
+  ASSERT_NE(cftmdl_128_sse2, cftmdl_128);
+  memcpy(forward, input, sizeof(input));
+  aec_rdft_forward_128(forward);
+  memcpy(inverse, reference_forward, sizeof(input));
+  aec_rdft_inverse_128(inverse);
+
+  // Every output bin sums all inputs.
+  ExpectNearRelativeToMax(reference_forward, forward, PART_LEN2);
+  ExpectNearRelativeToMax(reference_inverse, inverse, PART_LEN2);
+  const float max_inverse = fabsf(*std::max_element(
+      reference_inverse, reference_inverse + PART_LEN2,
+      [](float a, float b) { return fabsf(a) < fabsf(b); }));
+  for (int i = 0; i < PART_LEN2; ++i) {
+    // The inverse transform is scaled by PART_LEN2 / 2.
+    EXPECT_NEAR(input[i], inverse[i] * 2.f / PART_LEN2,
+                kTolerance * max_inverse * 2.f / PART_LEN2);
+  }
+}
+
+// Runs a full echo canceller on a simulated echo path with and without the
+// AVX2 kernels and verifies that the outputs are essentially identical.
+TEST(AecAvx2Test, ProcessedOutputMatchesSse2) {
+  if (!HasAVX2()) {
+    return;
+  }
+  const int kNumFrames = 300;
+  const int kFrameLength = kSampleRateHz / 100;
+  const int kEchoDelay = 40;
+  float far[kNumFrames * kFrameLength];
+  float near[kNumFrames * kFrameLength];
+  uint32_t seed = 7;
+  FillRandom(far, kNumFrames * kFrameLength, 8000.f, &seed);
+  FillRandom(near, kNumFrames * kFrameLength, 100.f, &seed);
+  for (int i = kEchoDelay; i < kNumFrames * kFrameLength; ++i) {
+    near[i] += 0.5f * far[i - kEchoDelay];
+  }
+
+  float outputs[2][kNumFrames * kFrameLength];
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  for (int use_avx2 = 0; use_avx2 < 2; ++use_avx2) {
+    WebRtc_GetCPUInfo = use_avx2 ? g_get_cpu_info : GetCPUInfoNoAVX2;
+    void* handle = WebRtcAec_Create();
+    ASSERT_TRUE(handle != nullptr);
+    ASSERT_EQ(0, WebRtcAec_Init(handle, kSampleRateHz, 48000));
+    for (int i = 0; i < kNumFrames; ++i) {
+      const float* near_frame = &near[i * kFrameLength];
+      float* out_frame = &outputs[use_avx2][i * kFrameLength];
+      ASSERT_EQ(0, WebRtcAec_BufferFarend(handle, &far[i * kFrameLength],
+                                          kFrameLength));
+      ASSERT_EQ(0, WebRtcAec_Process(handle, &near_frame, 1, &out_frame,
+                                     kFrameLength, 10, 0));
+    }
+    WebRtcAec_Free(handle);
+  }
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+
+  // Compare the energy of the difference to the energy of the output.
+  double output_energy = 0.0;
+  double error_energy = 0.0;
+  for (int i = 0; i < kNumFrames * kFrameLength; ++i) {
+    output_energy += outputs[0][i] * outputs[0][i];
+    const float error = outputs[1][i] - outputs[0][i];
+    error_energy += error * error;
+  }
+  ASSERT_GT(output_energy, 0.0);
+  EXPECT_LT(10.0 * log10(error_energy / output_energy + 1e-20), -60.0);
+}
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
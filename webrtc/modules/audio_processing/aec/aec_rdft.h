@@ -26,7 +26,7 @@ extern const float rdft_w[64];
 // Constants used by the C path.
 extern const float rdft_wk3ri_first[16];
 extern const float rdft_wk3ri_second[16];
-// Constants used by SSE2 and NEON but initialized in the C path.
+// Constants used by SSE2, AVX2 and NEON but initialized in the C path.
 extern ALIGN16_BEG const float ALIGN16_END rdft_wk1r[32];
 extern ALIGN16_BEG const float ALIGN16_END rdft_wk2r[32];
 extern ALIGN16_BEG const float ALIGN16_END rdft_wk3r[32];
@@ -48,6 +48,7 @@ extern RftSub128 bitrv2_128;
 // entry points
 void aec_rdft_init(void);
 void aec_rdft_init_sse2(void);
+void aec_rdft_init_avx2(void);
 void aec_rdft_forward_128(float* a);
 void aec_rdft_inverse_128(float* a);
 
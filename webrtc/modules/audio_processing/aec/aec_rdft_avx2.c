@@ -0,0 +1,427 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/aec/aec_rdft.h"
+
+#include <immintrin.h>
+
+// The radix-4 stages below run two iterations of the SSE2 versions at once,
+// one in each 128-bit lane, so the in-lane shuffles are unchanged.
+
+static const ALIGN16_BEG float ALIGN16_END
+    k_swap_sign[4] = {-1.f, 1.f, -1.f, 1.f};
+static const ALIGN16_BEG float ALIGN16_END
+    k_conj_sign[4] = {1.f, -1.f, 1.f, -1.f};
+
+// Loads four floats from |lo| into the low lane and four from |hi| into the
+// high lane.
+static __inline __m256 LoadLanes(const float* lo, const float* hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)),
+                              _mm_loadu_ps(hi), 1);
+}
+
+static __inline void StoreLanes(float* lo, float* hi, __m256 v) {
+  _mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+  _mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+}
+
+// Swaps the middle two 64-bit pairs: (0, 1, 2, 3) -> (0, 2, 1, 3). Applying
+// it twice is the identity.
+static __inline __m256 SwapMiddlePairs(__m256 v) {
+  return _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+// Reverses the order of all eight floats.
+static __inline __m256 Reverse(__m256 v) {
+  return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+static void cft1st_128_AVX2(float* a) {
+  const __m256 mm_swap_sign = _mm256_broadcast_ps((const __m128*)k_swap_sign);
+  int j, k2;
+
+  for (k2 = 0, j = 0; j < 128; j += 32, k2 += 8) {
+    __m256 a00v = LoadLanes(&a[j + 0], &a[j + 16]);
+    __m256 a04v = LoadLanes(&a[j + 4], &a[j + 20]);
+    __m256 a08v = LoadLanes(&a[j + 8], &a[j + 24]);
+    __m256 a12v = LoadLanes(&a[j + 12], &a[j + 28]);
+    __m256 a01v = _mm256_shuffle_ps(a00v, a08v, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 a23v = _mm256_shuffle_ps(a00v, a08v, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 a45v = _mm256_shuffle_ps(a04v, a12v, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 a67v = _mm256_shuffle_ps(a04v, a12v, _MM_SHUFFLE(3, 2, 3, 2));
+
+    // The twiddle factors of two consecutive SSE2 iterations are adjacent.
+    const __m256 wk1rv = _mm256_loadu_ps(&rdft_wk1r[k2]);
+    const __m256 wk1iv = _mm256_loadu_ps(&rdft_wk1i[k2]);
+    const __m256 wk2rv = _mm256_loadu_ps(&rdft_wk2r[k2]);
+    const __m256 wk2iv = _mm256_loadu_ps(&rdft_wk2i[k2]);
+    const __m256 wk3rv = _mm256_loadu_ps(&rdft_wk3r[k2]);
+    const __m256 wk3iv = _mm256_loadu_ps(&rdft_wk3i[k2]);
+    __m256 x0v = _mm256_add_ps(a01v, a23v);
+    const __m256 x1v = _mm256_sub_ps(a01v, a23v);
+    const __m256 x2v = _mm256_add_ps(a45v, a67v);
+    const __m256 x3v = _mm256_sub_ps(a45v, a67v);
+    __m256 x0w;
+    a01v = _mm256_add_ps(x0v, x2v);
+    x0v = _mm256_sub_ps(x0v, x2v);
+    x0w = _mm256_shuffle_ps(x0v, x0v, _MM_SHUFFLE(2, 3, 0, 1));
+    a45v = _mm256_fmadd_ps(wk2rv, x0v, _mm256_mul_ps(wk2iv, x0w));
+    {
+      const __m256 x3w = _mm256_shuffle_ps(x3v, x3v, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m256 x3s = _mm256_mul_ps(mm_swap_sign, x3w);
+      x0v = _mm256_add_ps(x1v, x3s);
+      x0w = _mm256_shuffle_ps(x0v, x0v, _MM_SHUFFLE(2, 3, 0, 1));
+      a23v = _mm256_fmadd_ps(wk1rv, x0v, _mm256_mul_ps(wk1iv, x0w));
+
+      x0v = _mm256_sub_ps(x1v, x3s);
+      x0w = _mm256_shuffle_ps(x0v, x0v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    a67v = _mm256_fmadd_ps(wk3rv, x0v, _mm256_mul_ps(wk3iv, x0w));
+
+    a00v = _mm256_shuffle_ps(a01v, a23v, _MM_SHUFFLE(1, 0, 1, 0));
+    a04v = _mm256_shuffle_ps(a45v, a67v, _MM_SHUFFLE(1, 0, 1, 0));
+    a08v = _mm256_shuffle_ps(a01v, a23v, _MM_SHUFFLE(3, 2, 3, 2));
+    a12v = _mm256_shuffle_ps(a45v, a67v, _MM_SHUFFLE(3, 2, 3, 2));
+    StoreLanes(&a[j + 0], &a[j + 16], a00v);
+    StoreLanes(&a[j + 4], &a[j + 20], a04v);
+    StoreLanes(&a[j + 8], &a[j + 24], a08v);
+    StoreLanes(&a[j + 12], &a[j + 28], a12v);
+  }
+}
+
+// Loads the complex pairs at |lo|[0, 1, 2, 3] and |hi|[0, 1, 2, 3] as
+// (lo0, lo1, hi0, hi1 | lo2, lo3, hi2, hi3), i.e. the SSE2 register layout of
+// two consecutive iterations.
+static __inline __m256 LoadPairs(const float* lo, const float* hi) {
+  return SwapMiddlePairs(LoadLanes(lo, hi));
+}
+
+// Inverse of LoadPairs().
+static __inline void StorePairs(float* lo, float* hi, __m256 v) {
+  StoreLanes(lo, hi, SwapMiddlePairs(v));
+}
+
+static void cftmdl_128_AVX2(float* a) {
+  const int l = 8;
+  const __m256 mm_swap_sign = _mm256_broadcast_ps((const __m128*)k_swap_sign);
+  int j0;
+
+  __m256 wk1rv = _mm256_broadcast_ps((const __m128*)cftmdl_wk1r);
+  for (j0 = 0; j0 < l; j0 += 4) {
+    const __m256 a_00_32 = LoadPairs(&a[j0 + 0], &a[j0 + 32]);
+    const __m256 a_08_40 = LoadPairs(&a[j0 + 8], &a[j0 + 40]);
+    const __m256 x0r0_0i0_0r1_x0i1 = _mm256_add_ps(a_00_32, a_08_40);
+    const __m256 x1r0_1i0_1r1_x1i1 = _mm256_sub_ps(a_00_32, a_08_40);
+
+    const __m256 a_16_48 = LoadPairs(&a[j0 + 16], &a[j0 + 48]);
+    const __m256 a_24_56 = LoadPairs(&a[j0 + 24], &a[j0 + 56]);
+    const __m256 x2r0_2i0_2r1_x2i1 = _mm256_add_ps(a_16_48, a_24_56);
+    const __m256 x3r0_3i0_3r1_x3i1 = _mm256_sub_ps(a_16_48, a_24_56);
+
+    const __m256 xx0 = _mm256_add_ps(x0r0_0i0_0r1_x0i1, x2r0_2i0_2r1_x2i1);
+    const __m256 xx1 = _mm256_sub_ps(x0r0_0i0_0r1_x0i1, x2r0_2i0_2r1_x2i1);
+
+    const __m256 x3i0_3r0_3i1_x3r1 = _mm256_shuffle_ps(
+        x3r0_3i0_3r1_x3i1, x3r0_3i0_3r1_x3i1, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m256 x3_swapped = _mm256_mul_ps(mm_swap_sign, x3i0_3r0_3i1_x3r1);
+    const __m256 x1_x3_add = _mm256_add_ps(x1r0_1i0_1r1_x1i1, x3_swapped);
+    const __m256 x1_x3_sub = _mm256_sub_ps(x1r0_1i0_1r1_x1i1, x3_swapped);
+
+    const __m256 yy0 =
+        _mm256_shuffle_ps(x1_x3_add, x1_x3_sub, _MM_SHUFFLE(2, 2, 2, 2));
+    const __m256 yy1 =
+        _mm256_shuffle_ps(x1_x3_add, x1_x3_sub, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256 yy2 = _mm256_mul_ps(mm_swap_sign, yy1);
+    const __m256 yy3 = _mm256_add_ps(yy0, yy2);
+    const __m256 yy4 = _mm256_mul_ps(wk1rv, yy3);
+
+    // a[j0 + 48] = -xx1[3] and a[j0 + 49] = xx1[2].
+    const __m256 xx1_swapped = _mm256_xor_ps(
+        _mm256_shuffle_ps(xx1, xx1, _MM_SHUFFLE(2, 3, 1, 0)),
+        _mm256_setr_ps(0.f, 0.f, -0.f, 0.f, 0.f, 0.f, -0.f, 0.f));
+    // a[j0 + 56] = yy4[3] and a[j0 + 57] = yy4[2].
+    const __m256 yy4_swapped =
+        _mm256_shuffle_ps(yy4, yy4, _MM_SHUFFLE(2, 3, 1, 0));
+    // Only the low pairs of x1_x3_add and x1_x3_sub are stored.
+    const __m256 x1_x3 =
+        _mm256_shuffle_ps(x1_x3_add, x1_x3_sub, _MM_SHUFFLE(1, 0, 1, 0));
+
+    StorePairs(&a[j0 + 0], &a[j0 + 32], xx0);
+    StorePairs(&a[j0 + 16], &a[j0 + 48], xx1_swapped);
+    StorePairs(&a[j0 + 8], &a[j0 + 24], x1_x3);
+    StorePairs(&a[j0 + 40], &a[j0 + 56], yy4_swapped);
+  }
+
+  {
+    int k = 64;
+    int k1 = 2;
+    int k2 = 2 * k1;
+    const __m256 wk2rv = _mm256_broadcast_ps((const __m128*)&rdft_wk2r[k2]);
+    const __m256 wk2iv = _mm256_broadcast_ps((const __m128*)&rdft_wk2i[k2]);
+    const __m256 wk1iv = _mm256_broadcast_ps((const __m128*)&rdft_wk1i[k2]);
+    const __m256 wk3rv = _mm256_broadcast_ps((const __m128*)&rdft_wk3r[k2]);
+    const __m256 wk3iv = _mm256_broadcast_ps((const __m128*)&rdft_wk3i[k2]);
+    wk1rv = _mm256_broadcast_ps((const __m128*)&rdft_wk1r[k2]);
+    for (j0 = k; j0 < l + k; j0 += 4) {
+      const __m256 a_00_32 = LoadPairs(&a[j0 + 0], &a[j0 + 32]);
+      const __m256 a_08_40 = LoadPairs(&a[j0 + 8], &a[j0 + 40]);
+      const __m256 x0r0_0i0_0r1_x0i1 = _mm256_add_ps(a_00_32, a_08_40);
+      const __m256 x1r0_1i0_1r1_x1i1 = _mm256_sub_ps(a_00_32, a_08_40);
+
+      const __m256 a_16_48 = LoadPairs(&a[j0 + 16], &a[j0 + 48]);
+      const __m256 a_24_56 = LoadPairs(&a[j0 + 24], &a[j0 + 56]);
+      const __m256 x2r0_2i0_2r1_x2i1 = _mm256_add_ps(a_16_48, a_24_56);
+      const __m256 x3r0_3i0_3r1_x3i1 = _mm256_sub_ps(a_16_48, a_24_56);
+
+      const __m256 xx = _mm256_add_ps(x0r0_0i0_0r1_x0i1, x2r0_2i0_2r1_x2i1);
+      const __m256 xx1 = _mm256_sub_ps(x0r0_0i0_0r1_x0i1, x2r0_2i0_2r1_x2i1);
+      const __m256 xx4 = _mm256_fmadd_ps(
+          xx1, wk2rv,
+          _mm256_mul_ps(wk2iv,
+                        _mm256_shuffle_ps(xx1, xx1, _MM_SHUFFLE(2, 3, 0, 1))));
+
+      const __m256 x3i0_3r0_3i1_x3r1 = _mm256_shuffle_ps(
+          x3r0_3i0_3r1_x3i1, x3r0_3i0_3r1_x3i1, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m256 x3_swapped = _mm256_mul_ps(mm_swap_sign, x3i0_3r0_3i1_x3r1);
+      const __m256 x1_x3_add = _mm256_add_ps(x1r0_1i0_1r1_x1i1, x3_swapped);
+      const __m256 x1_x3_sub = _mm256_sub_ps(x1r0_1i0_1r1_x1i1, x3_swapped);
+
+      const __m256 xx12 = _mm256_fmadd_ps(
+          x1_x3_add, wk1rv,
+          _mm256_mul_ps(wk1iv, _mm256_shuffle_ps(x1_x3_add, x1_x3_add,
+                                                 _MM_SHUFFLE(2, 3, 0, 1))));
+      const __m256 xx22 = _mm256_fmadd_ps(
+          x1_x3_sub, wk3rv,
+          _mm256_mul_ps(wk3iv, _mm256_shuffle_ps(x1_x3_sub, x1_x3_sub,
+                                                 _MM_SHUFFLE(2, 3, 0, 1))));
+
+      StorePairs(&a[j0 + 0], &a[j0 + 32], xx);
+      StorePairs(&a[j0 + 16], &a[j0 + 48], xx4);
+      StorePairs(&a[j0 + 8], &a[j0 + 40], xx12);
+      StorePairs(&a[j0 + 24], &a[j0 + 56], xx22);
+    }
+  }
+}
+
+// Last radix-4 stage of the forward and backward transforms. Only multiplies
+// by +-1, so the result is bitexact with the C version.
+static void cftfsub_128_AVX2(float* a) {
+  const __m256 mm_swap_sign = _mm256_broadcast_ps((const __m128*)k_swap_sign);
+  int j;
+
+  cft1st_128_AVX2(a);
+  cftmdl_128_AVX2(a);
+  for (j = 0; j < 32; j += 8) {
+    const __m256 a_j0 = _mm256_loadu_ps(&a[j + 0]);
+    const __m256 a_j1 = _mm256_loadu_ps(&a[j + 32]);
+    const __m256 a_j2 = _mm256_loadu_ps(&a[j + 64]);
+    const __m256 a_j3 = _mm256_loadu_ps(&a[j + 96]);
+    const __m256 x0 = _mm256_add_ps(a_j0, a_j1);
+    const __m256 x1 = _mm256_sub_ps(a_j0, a_j1);
+    const __m256 x2 = _mm256_add_ps(a_j2, a_j3);
+    const __m256 x3 = _mm256_sub_ps(a_j2, a_j3);
+    // (-x3i, x3r)
+    const __m256 x3s = _mm256_mul_ps(
+        mm_swap_sign, _mm256_shuffle_ps(x3, x3, _MM_SHUFFLE(2, 3, 0, 1)));
+    _mm256_storeu_ps(&a[j + 0], _mm256_add_ps(x0, x2));
+    _mm256_storeu_ps(&a[j + 64], _mm256_sub_ps(x0, x2));
+    _mm256_storeu_ps(&a[j + 32], _mm256_add_ps(x1, x3s));
+    _mm256_storeu_ps(&a[j + 96], _mm256_sub_ps(x1, x3s));
+  }
+}
+
+static void cftbsub_128_AVX2(float* a) {
+  const __m256 mm_conj_sign = _mm256_broadcast_ps((const __m128*)k_conj_sign);
+  int j;
+
+  cft1st_128_AVX2(a);
+  cftmdl_128_AVX2(a);
+  for (j = 0; j < 32; j += 8) {
+    const __m256 a_j0 = _mm256_loadu_ps(&a[j + 0]);
+    const __m256 a_j1 = _mm256_loadu_ps(&a[j + 32]);
+    const __m256 a_j2 = _mm256_loadu_ps(&a[j + 64]);
+    const __m256 a_j3 = _mm256_loadu_ps(&a[j + 96]);
+    const __m256 x0 = _mm256_mul_ps(mm_conj_sign, _mm256_add_ps(a_j0, a_j1));
+    const __m256 x1 = _mm256_mul_ps(mm_conj_sign, _mm256_sub_ps(a_j0, a_j1));
+    const __m256 x2 = _mm256_mul_ps(mm_conj_sign, _mm256_add_ps(a_j2, a_j3));
+    const __m256 x3 = _mm256_sub_ps(a_j2, a_j3);
+    // (x3i, x3r)
+    const __m256 x3w = _mm256_shuffle_ps(x3, x3, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm256_storeu_ps(&a[j + 0], _mm256_add_ps(x0, x2));
+    _mm256_storeu_ps(&a[j + 64], _mm256_sub_ps(x0, x2));
+    _mm256_storeu_ps(&a[j + 32], _mm256_sub_ps(x1, x3w));
+    _mm256_storeu_ps(&a[j + 96], _mm256_add_ps(x1, x3w));
+  }
+}
+
+// Splits |lo| and |hi|, eight consecutive complex values together, into their
+// real and imaginary parts.
+static __inline void Deinterleave(__m256 lo, __m256 hi, __m256* re,
+                                  __m256* im) {
+  *re = SwapMiddlePairs(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+  *im = SwapMiddlePairs(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+// Inverse of Deinterleave().
+static __inline void Interleave(__m256 re, __m256 im, __m256* lo,
+                                __m256* hi) {
+  const __m256 t0 = _mm256_unpacklo_ps(re, im);
+  const __m256 t1 = _mm256_unpackhi_ps(re, im);
+  *lo = _mm256_permute2f128_ps(t0, t1, 0x20);
+  *hi = _mm256_permute2f128_ps(t0, t1, 0x31);
+}
+
+static void rftfsub_128_AVX2(float* a) {
+  const float* c = rdft_w + 32;
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+
+  const __m256 mm_half = _mm256_set1_ps(0.5f);
+
+  // Vectorized code (eight at once).
+  //    Note: commented number are indexes for the first iteration of the loop.
+  for (j1 = 1, j2 = 2; j2 + 15 < 64; j1 += 8, j2 += 16) {
+    // Load 'wk'.
+    const __m256 c_j1 = _mm256_loadu_ps(&c[j1]);  //  1, ...,  8,
+    const __m256 c_k1 = _mm256_loadu_ps(&c[25 - j1]);  // 24, ..., 31,
+    const __m256 wkr_ = Reverse(_mm256_sub_ps(mm_half, c_k1));  // 31, ..., 24,
+    const __m256 wki_ = c_j1;                                  //  1, ...,  8,
+    // Load and shuffle 'a'.
+    __m256 a_j2_p0, a_j2_p1, a_k2_p0, a_k2_p1;
+    Deinterleave(_mm256_loadu_ps(&a[0 + j2]), _mm256_loadu_ps(&a[8 + j2]),
+                 &a_j2_p0, &a_j2_p1);  // 2, 4, ..., 16 and 3, 5, ..., 17,
+    Deinterleave(_mm256_loadu_ps(&a[114 - j2]), _mm256_loadu_ps(&a[122 - j2]),
+                 &a_k2_p0, &a_k2_p1);  // 112, ..., 126 and 113, ..., 127,
+    a_k2_p0 = Reverse(a_k2_p0);        // 126, ..., 112,
+    a_k2_p1 = Reverse(a_k2_p1);        // 127, ..., 113,
+    {
+      // Calculate 'x'.
+      const __m256 xr_ = _mm256_sub_ps(a_j2_p0, a_k2_p0);
+      const __m256 xi_ = _mm256_add_ps(a_j2_p1, a_k2_p1);
+      // Calculate product into 'y'.
+      //    yr = wkr * xr - wki * xi;
+      //    yi = wkr * xi + wki * xr;
+      const __m256 yr_ = _mm256_fmsub_ps(wkr_, xr_, _mm256_mul_ps(wki_, xi_));
+      const __m256 yi_ = _mm256_fmadd_ps(wkr_, xi_, _mm256_mul_ps(wki_, xr_));
+      // Update 'a'.
+      //    a[j2 + 0] -= yr;
+      //    a[j2 + 1] -= yi;
+      //    a[k2 + 0] += yr;
+      //    a[k2 + 1] -= yi;
+      const __m256 a_j2_p0n = _mm256_sub_ps(a_j2_p0, yr_);
+      const __m256 a_j2_p1n = _mm256_sub_ps(a_j2_p1, yi_);
+      const __m256 a_k2_p0n = Reverse(_mm256_add_ps(a_k2_p0, yr_));
+      const __m256 a_k2_p1n = Reverse(_mm256_sub_ps(a_k2_p1, yi_));
+      // Shuffle in right order and store.
+      __m256 a_j2_0n, a_j2_8n, a_k2_0n, a_k2_8n;
+      Interleave(a_j2_p0n, a_j2_p1n, &a_j2_0n, &a_j2_8n);
+      Interleave(a_k2_p0n, a_k2_p1n, &a_k2_0n, &a_k2_8n);
+      _mm256_storeu_ps(&a[0 + j2], a_j2_0n);
+      _mm256_storeu_ps(&a[8 + j2], a_j2_8n);
+      _mm256_storeu_ps(&a[114 - j2], a_k2_0n);
+      _mm256_storeu_ps(&a[122 - j2], a_k2_8n);
+    }
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 = 32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr - wki * xi;
+    yi = wkr * xi + wki * xr;
+    a[j2 + 0] -= yr;
+    a[j2 + 1] -= yi;
+    a[k2 + 0] += yr;
+    a[k2 + 1] -= yi;
+  }
+}
+
+static void rftbsub_128_AVX2(float* a) {
+  const float* c = rdft_w + 32;
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+
+  const __m256 mm_half = _mm256_set1_ps(0.5f);
+
+  a[1] = -a[1];
+  // Vectorized code (eight at once).
+  //    Note: commented number are indexes for the first iteration of the loop.
+  for (j1 = 1, j2 = 2; j2 + 15 < 64; j1 += 8, j2 += 16) {
+    // Load 'wk'.
+    const __m256 c_j1 = _mm256_loadu_ps(&c[j1]);  //  1, ...,  8,
+    const __m256 c_k1 = _mm256_loadu_ps(&c[25 - j1]);  // 24, ..., 31,
+    const __m256 wkr_ = Reverse(_mm256_sub_ps(mm_half, c_k1));  // 31, ..., 24,
+    const __m256 wki_ = c_j1;                                  //  1, ...,  8,
+    // Load and shuffle 'a'.
+    __m256 a_j2_p0, a_j2_p1, a_k2_p0, a_k2_p1;
+    Deinterleave(_mm256_loadu_ps(&a[0 + j2]), _mm256_loadu_ps(&a[8 + j2]),
+                 &a_j2_p0, &a_j2_p1);  // 2, 4, ..., 16 and 3, 5, ..., 17,
+    Deinterleave(_mm256_loadu_ps(&a[114 - j2]), _mm256_loadu_ps(&a[122 - j2]),
+                 &a_k2_p0, &a_k2_p1);  // 112, ..., 126 and 113, ..., 127,
+    a_k2_p0 = Reverse(a_k2_p0);        // 126, ..., 112,
+    a_k2_p1 = Reverse(a_k2_p1);        // 127, ..., 113,
+    {
+      // Calculate 'x'.
+      const __m256 xr_ = _mm256_sub_ps(a_j2_p0, a_k2_p0);
+      const __m256 xi_ = _mm256_add_ps(a_j2_p1, a_k2_p1);
+      // Calculate product into 'y'.
+      //    yr = wkr * xr + wki * xi;
+      //    yi = wkr * xi - wki * xr;
+      const __m256 yr_ = _mm256_fmadd_ps(wkr_, xr_, _mm256_mul_ps(wki_, xi_));
+      const __m256 yi_ = _mm256_fmsub_ps(wkr_, xi_, _mm256_mul_ps(wki_, xr_));
+      // Update 'a'.
+      //    a[j2 + 0] = a[j2 + 0] - yr;
+      //    a[j2 + 1] = yi - a[j2 + 1];
+      //    a[k2 + 0] = yr + a[k2 + 0];
+      //    a[k2 + 1] = yi - a[k2 + 1];
+      const __m256 a_j2_p0n = _mm256_sub_ps(a_j2_p0, yr_);
+      const __m256 a_j2_p1n = _mm256_sub_ps(yi_, a_j2_p1);
+      const __m256 a_k2_p0n = Reverse(_mm256_add_ps(a_k2_p0, yr_));
+      const __m256 a_k2_p1n = Reverse(_mm256_sub_ps(yi_, a_k2_p1));
+      // Shuffle in right order and store.
+      __m256 a_j2_0n, a_j2_8n, a_k2_0n, a_k2_8n;
+      Interleave(a_j2_p0n, a_j2_p1n, &a_j2_0n, &a_j2_8n);
+      Interleave(a_k2_p0n, a_k2_p1n, &a_k2_0n, &a_k2_8n);
+      _mm256_storeu_ps(&a[0 + j2], a_j2_0n);
+      _mm256_storeu_ps(&a[8 + j2], a_j2_8n);
+      _mm256_storeu_ps(&a[114 - j2], a_k2_0n);
+      _mm256_storeu_ps(&a[122 - j2], a_k2_8n);
+    }
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 = 32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr + wki * xi;
+    yi = wkr * xi - wki * xr;
+    a[j2 + 0] = a[j2 + 0] - yr;
+    a[j2 + 1] = yi - a[j2 + 1];
+    a[k2 + 0] = yr + a[k2 + 0];
+    a[k2 + 1] = yi - a[k2 + 1];
+  }
+  a[65] = -a[65];
+}
+
+void aec_rdft_init_avx2(void) {
+  cft1st_128 = cft1st_128_AVX2;
+  cftmdl_128 = cftmdl_128_AVX2;
+  cftfsub_128 = cftfsub_128_AVX2;
+  cftbsub_128 = cftbsub_128_AVX2;
+  rftfsub_128 = rftfsub_128_AVX2;
+  rftbsub_128 = rftbsub_128_AVX2;
+}
@@ -11,6 +11,7 @@
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 
 #include "webrtc/common_audio/include/audio_util.h"
+#include "webrtc/common_audio/resampler/multi_channel_sinc_resampler.h"
 #include "webrtc/common_audio/resampler/push_sinc_resampler.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/common_audio/channel_buffer.h"
@@ -60,40 +61,99 @@ AudioBuffer::AudioBuffer(size_t input_num_frames,
     reference_copied_(false),
     activity_(AudioFrame::kVadUnknown),
     keyboard_data_(NULL),
-    data_(new IFChannelBuffer(proc_num_frames_, num_proc_channels_)) {
+    arena_size_(0),
+    num_copied_samples_(0) {
   assert(input_num_frames_ > 0);
   assert(proc_num_frames_ > 0);
   assert(output_num_frames_ > 0);
   assert(num_input_channels_ > 0);
   assert(num_proc_channels_ > 0 && num_proc_channels_ <= num_input_channels_);
 
-  if (input_num_frames_ != proc_num_frames_ ||
-      output_num_frames_ != proc_num_frames_) {
-    // Create an intermediate buffer for resampling.
-    process_buffer_.reset(new ChannelBuffer<float>(proc_num_frames_,
-                                                   num_proc_channels_));
+  const bool need_to_downmix =
+      num_input_channels_ > 1 && num_proc_channels_ == 1;
+  const bool need_input_buffer =
+      need_to_downmix || input_num_frames_ != proc_num_frames_;
+  const bool need_process_buffer = input_num_frames_ != proc_num_frames_ ||
+                                   output_num_frames_ != proc_num_frames_;
+  const bool need_output_buffer = output_num_frames_ != proc_num_frames_;
+
+  // All the sample storage is carved out of one allocation, so that no
+  // allocation happens after construction and the buffers used by
+  // consecutive components are close in memory.
+  const size_t proc_size = proc_num_frames_ * num_proc_channels_;
+  const size_t input_size = input_num_frames_ * num_proc_channels_;
+  const size_t output_size = output_num_frames_ * num_proc_channels_;
+  const size_t data_offset = ReserveArena<int16_t>(proc_size);
+  const size_t data_f_offset = ReserveArena<float>(proc_size);
+  const size_t split_data_offset =
+      num_bands_ > 1 ? ReserveArena<int16_t>(proc_size) : 0;
+  const size_t split_data_f_offset =
+      num_bands_ > 1 ? ReserveArena<float>(proc_size) : 0;
+  const size_t mixed_low_pass_offset =
+      num_proc_channels_ > 1 ? ReserveArena<int16_t>(num_split_frames_) : 0;
+  const size_t low_pass_reference_offset =
+      ReserveArena<int16_t>(num_split_frames_ * num_proc_channels_);
+  const size_t input_offset =
+      need_input_buffer ? ReserveArena<int16_t>(input_size) : 0;
+  const size_t input_f_offset =
+      need_input_buffer ? ReserveArena<float>(input_size) : 0;
+  const size_t output_offset =
+      need_output_buffer ? ReserveArena<int16_t>(output_size) : 0;
+  const size_t output_f_offset =
+      need_output_buffer ? ReserveArena<float>(output_size) : 0;
+  const size_t process_offset =
+      need_process_buffer ? ReserveArena<float>(proc_size) : 0;
+
+  arena_.reset(AlignedMalloc<uint8_t>(arena_size_, kArenaAlignment));
+  memset(arena_.get(), 0, arena_size_);
+
+  data_.reset(new IFChannelBuffer(proc_num_frames_, num_proc_channels_, 1,
+                                  ArenaPointer<int16_t>(data_offset),
+                                  ArenaPointer<float>(data_f_offset)));
+  low_pass_reference_channels_.reset(new ChannelBuffer<int16_t>(
+      num_split_frames_, num_proc_channels_, 1,
+      ArenaPointer<int16_t>(low_pass_reference_offset)));
+  if (num_proc_channels_ > 1) {
+    mixed_low_pass_channels_.reset(new ChannelBuffer<int16_t>(
+        num_split_frames_, 1, 1, ArenaPointer<int16_t>(mixed_low_pass_offset)));
+  }
+  if (need_input_buffer) {
+    input_buffer_.reset(new IFChannelBuffer(
+        input_num_frames_, num_proc_channels_, 1,
+        ArenaPointer<int16_t>(input_offset),
+        ArenaPointer<float>(input_f_offset)));
+  }
+  if (need_output_buffer) {
+    output_buffer_.reset(new IFChannelBuffer(
+        output_num_frames_, num_proc_channels_, 1,
+        ArenaPointer<int16_t>(output_offset),
+        ArenaPointer<float>(output_f_offset)));
+  }
+
+  if (need_process_buffer) {
+    // An intermediate buffer for resampling.
+    process_buffer_.reset(new ChannelBuffer<float>(
+        proc_num_frames_, num_proc_channels_, 1,
+        ArenaPointer<float>(process_offset)));
 
     if (input_num_frames_ != proc_num_frames_) {
-      for (int i = 0; i < num_proc_channels_; ++i) {
-        input_resamplers_.push_back(
-            new PushSincResampler(input_num_frames_,
-                                  proc_num_frames_));
-      }
+      input_resampler_.reset(new MultiChannelSincResampler(
+          input_num_frames_, proc_num_frames_, num_proc_channels_));
     }
 
     if (output_num_frames_ != proc_num_frames_) {
       for (int i = 0; i < num_proc_channels_; ++i) {
         output_resamplers_.push_back(
-            new PushSincResampler(proc_num_frames_,
-                                  output_num_frames_));
+            new PushSincResampler(proc_num_frames_, output_num_frames_));
       }
     }
   }
 
   if (num_bands_ > 1) {
-    split_data_.reset(new IFChannelBuffer(proc_num_frames_,
-                                          num_proc_channels_,
-                                          num_bands_));
+    split_data_.reset(new IFChannelBuffer(
+        proc_num_frames_, num_proc_channels_, num_bands_,
+        ArenaPointer<int16_t>(split_data_offset),
+        ArenaPointer<float>(split_data_f_offset)));
     splitting_filter_.reset(new SplittingFilter(num_proc_channels_,
                                                 num_bands_,
                                                 proc_num_frames_));
@@ -107,44 +167,45 @@ void AudioBuffer::CopyFrom(const float* const* data,
   assert(stream_config.num_frames() == input_num_frames_);
   assert(stream_config.num_channels() == num_input_channels_);
   InitForNewData();
-  // Initialized lazily because there's a different condition in
-  // DeinterleaveFrom.
   const bool need_to_downmix =
       num_input_channels_ > 1 && num_proc_channels_ == 1;
-  if (need_to_downmix && !input_buffer_) {
-    input_buffer_.reset(
-        new IFChannelBuffer(input_num_frames_, num_proc_channels_));
-  }
 
   if (stream_config.has_keyboard()) {
     keyboard_data_ = data[KeyboardChannelIndex(stream_config)];
   }
 
+  // Downmix and convert to the S16 range in a single pass when there is no
+  // resampling in between.
+  if (need_to_downmix && input_num_frames_ == proc_num_frames_) {
+    DownmixToMonoFloatS16(data, input_num_frames_, num_input_channels_,
+                          data_->fbuf_for_overwrite()->channels()[0]);
+    num_copied_samples_ += proc_num_frames_;
+    return;
+  }
+
   // Downmix.
   const float* const* data_ptr = data;
   if (need_to_downmix) {
-    DownmixToMono<float, float>(data, input_num_frames_, num_input_channels_,
-                                input_buffer_->fbuf()->channels()[0]);
+    DownmixToMono<float, float>(
+        data, input_num_frames_, num_input_channels_,
+        input_buffer_->fbuf_for_overwrite()->channels()[0]);
     data_ptr = input_buffer_->fbuf_const()->channels();
+    num_copied_samples_ += input_num_frames_;
   }
 
   // Resample.
   if (input_num_frames_ != proc_num_frames_) {
-    for (int i = 0; i < num_proc_channels_; ++i) {
-      input_resamplers_[i]->Resample(data_ptr[i],
-                                     input_num_frames_,
-                                     process_buffer_->channels()[i],
-                                     proc_num_frames_);
-    }
+    input_resampler_->Resample(data_ptr, input_num_frames_,
+                               process_buffer_->channels(), proc_num_frames_);
     data_ptr = process_buffer_->channels();
   }
 
   // Convert to the S16 range.
+  float* const* channels = data_->fbuf_for_overwrite()->channels();
   for (int i = 0; i < num_proc_channels_; ++i) {
-    FloatToFloatS16(data_ptr[i],
-                    proc_num_frames_,
-                    data_->fbuf()->channels()[i]);
+    FloatToFloatS16(data_ptr[i], proc_num_frames_, channels[i]);
   }
+  num_copied_samples_ += proc_num_frames_ * num_proc_channels_;
 }
 
 void AudioBuffer::CopyTo(const StreamConfig& stream_config,
@@ -158,20 +219,24 @@ void AudioBuffer::CopyTo(const StreamConfig& stream_config,
     // Convert to an intermediate buffer for subsequent resampling.
     data_ptr = process_buffer_->channels();
   }
+  const float* const* channels = data_->fbuf_const()->channels();
   for (int i = 0; i < num_channels_; ++i) {
-    FloatS16ToFloat(data_->fbuf()->channels()[i],
-                    proc_num_frames_,
-                    data_ptr[i]);
+    FloatS16ToFloat(channels[i], proc_num_frames_, data_ptr[i]);
   }
+  num_copied_samples_ += proc_num_frames_ * num_channels_;
 
   // Resample.
   if (output_num_frames_ != proc_num_frames_) {
-    for (int i = 0; i < num_channels_; ++i) {
-      output_resamplers_[i]->Resample(data_ptr[i],
-                                      proc_num_frames_,
-                                      data[i],
-                                      output_num_frames_);
-    }
+    ResampleOutput(data_ptr, data);
+  }
+}
+
+void AudioBuffer::ResampleOutput(const float* const* src, float* const* dst) {
+  // The number of channels may have been lowered during processing, so only
+  // the resamplers of the remaining channels are run.
+  for (int i = 0; i < num_channels_; ++i) {
+    output_resamplers_[i]->Resample(src[i], proc_num_frames_, dst[i],
+                                    output_num_frames_);
   }
 }
 
@@ -303,14 +368,10 @@ const int16_t* AudioBuffer::mixed_low_pass_data() {
   }
 
   if (!mixed_low_pass_valid_) {
-    if (!mixed_low_pass_channels_.get()) {
-      mixed_low_pass_channels_.reset(
-          new ChannelBuffer<int16_t>(num_split_frames_, 1));
-    }
-
     DownmixToMono<int16_t, int32_t>(split_channels_const(kBand0To8kHz),
                                     num_split_frames_, num_channels_,
                                     mixed_low_pass_channels_->channels()[0]);
+    num_copied_samples_ += num_split_frames_;
     mixed_low_pass_valid_ = true;
   }
   return mixed_low_pass_channels_->channels()[0];
@@ -366,18 +427,13 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
   assert(frame->num_channels_ == num_input_channels_);
   assert(frame->samples_per_channel_ == input_num_frames_);
   InitForNewData();
-  // Initialized lazily because there's a different condition in CopyFrom.
-  if ((input_num_frames_ != proc_num_frames_) && !input_buffer_) {
-    input_buffer_.reset(
-        new IFChannelBuffer(input_num_frames_, num_proc_channels_));
-  }
   activity_ = frame->vad_activity_;
 
   int16_t* const* deinterleaved;
   if (input_num_frames_ == proc_num_frames_) {
-    deinterleaved = data_->ibuf()->channels();
+    deinterleaved = data_->ibuf_for_overwrite()->channels();
   } else {
-    deinterleaved = input_buffer_->ibuf()->channels();
+    deinterleaved = input_buffer_->ibuf_for_overwrite()->channels();
   }
   if (num_proc_channels_ == 1) {
     // Downmix and deinterleave simultaneously.
@@ -390,15 +446,14 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
                  num_proc_channels_,
                  deinterleaved);
   }
+  num_copied_samples_ += input_num_frames_ * num_proc_channels_;
 
   // Resample.
   if (input_num_frames_ != proc_num_frames_) {
-    for (int i = 0; i < num_proc_channels_; ++i) {
-      input_resamplers_[i]->Resample(input_buffer_->fbuf_const()->channels()[i],
-                                     input_num_frames_,
-                                     data_->fbuf()->channels()[i],
-                                     proc_num_frames_);
-    }
+    input_resampler_->Resample(input_buffer_->fbuf_const()->channels(),
+                               input_num_frames_,
+                               data_->fbuf_for_overwrite()->channels(),
+                               proc_num_frames_);
   }
 }
 
@@ -412,43 +467,33 @@ void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) {
   assert(frame->samples_per_channel_ == output_num_frames_);
 
   // Resample if necessary.
-  IFChannelBuffer* data_ptr = data_.get();
+  const IFChannelBuffer* data_ptr = data_.get();
   if (proc_num_frames_ != output_num_frames_) {
-    if (!output_buffer_) {
-      output_buffer_.reset(
-          new IFChannelBuffer(output_num_frames_, num_channels_));
-    }
-    for (int i = 0; i < num_channels_; ++i) {
-      output_resamplers_[i]->Resample(
-          data_->fbuf()->channels()[i], proc_num_frames_,
-          output_buffer_->fbuf()->channels()[i], output_num_frames_);
-    }
+    ResampleOutput(data_->fbuf_const()->channels(),
+                   output_buffer_->fbuf_for_overwrite()->channels());
     data_ptr = output_buffer_.get();
   }
 
   if (frame->num_channels_ == num_channels_) {
-    Interleave(data_ptr->ibuf()->channels(), proc_num_frames_, num_channels_,
-               frame->data_);
+    Interleave(data_ptr->ibuf_const()->channels(), proc_num_frames_,
+               num_channels_, frame->data_);
   } else {
-    UpmixMonoToInterleaved(data_ptr->ibuf()->channels()[0], proc_num_frames_,
-                           frame->num_channels_, frame->data_);
+    UpmixMonoToInterleaved(data_ptr->ibuf_const()->channels()[0],
+                           proc_num_frames_, frame->num_channels_,
+                           frame->data_);
   }
+  num_copied_samples_ += proc_num_frames_ * frame->num_channels_;
 }
 
 void AudioBuffer::CopyLowPassToReference() {
   reference_copied_ = true;
-  if (!low_pass_reference_channels_.get() ||
-      low_pass_reference_channels_->num_channels() != num_channels_) {
-    low_pass_reference_channels_.reset(
-        new ChannelBuffer<int16_t>(num_split_frames_,
-                                   num_proc_channels_));
-  }
   for (int i = 0; i < num_proc_channels_; i++) {
     memcpy(low_pass_reference_channels_->channels()[i],
            split_bands_const(i)[kBand0To8kHz],
            low_pass_reference_channels_->num_frames_per_band() *
                sizeof(split_bands_const(i)[kBand0To8kHz][0]));
   }
+  num_copied_samples_ += num_split_frames_ * num_proc_channels_;
 }
 
 void AudioBuffer::SplitIntoFrequencyBands() {
@@ -459,4 +504,19 @@ void AudioBuffer::MergeFrequencyBands() {
   splitting_filter_->Synthesis(split_data_.get(), data_.get());
 }
 
+void AudioBuffer::AddStatistics(
+    AudioProcessing::BufferStatistics* stats) const {
+  ++stats->num_arenas;
+  stats->arena_bytes += arena_size_;
+  const IFChannelBuffer* buffers[] = {data_.get(), split_data_.get(),
+                                      input_buffer_.get(),
+                                      output_buffer_.get()};
+  for (const IFChannelBuffer* buffer : buffers) {
+    if (buffer) {
+      stats->num_converted_samples += buffer->num_converted_samples();
+    }
+  }
+  stats->num_copied_samples += num_copied_samples_;
+}
+
 }  // namespace webrtc
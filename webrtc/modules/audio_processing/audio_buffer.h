@@ -16,13 +16,15 @@
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/splitting_filter.h"
 #include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/aligned_malloc.h"
 #include "webrtc/system_wrappers/interface/scoped_vector.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
 
-class PushSincResampler;
 class IFChannelBuffer;
+class MultiChannelSincResampler;
+class PushSincResampler;
 
 enum Band {
   kBand0To8kHz = 0,
@@ -121,10 +123,34 @@ class AudioBuffer {
   // Recombine the different bands into one signal.
   void MergeFrequencyBands();
 
+  // Adds the sample arena, conversions and copies done by this buffer so far
+  // to |stats|.
+  void AddStatistics(AudioProcessing::BufferStatistics* stats) const;
+
  private:
+  // Aligned for SIMD loads of the channels.
+  static const size_t kArenaAlignment = 32;
+
   // Called from DeinterleaveFrom() and CopyFrom().
   void InitForNewData();
 
+  // Resamples the |num_channels_| processed channels from |src| to |dst|.
+  void ResampleOutput(const float* const* src, float* const* dst);
+
+  // Reserves room for |num_elements| of type T in |arena_|, before it is
+  // allocated, and returns their offset.
+  template <typename T>
+  size_t ReserveArena(size_t num_elements) {
+    const size_t offset = arena_size_;
+    arena_size_ += (num_elements * sizeof(T) + kArenaAlignment - 1) &
+                   ~(kArenaAlignment - 1);
+    return offset;
+  }
+  template <typename T>
+  T* ArenaPointer(size_t offset) {
+    return reinterpret_cast<T*>(arena_.get() + offset);
+  }
+
   // The audio is passed into DeinterleaveFrom() or CopyFrom() with input
   // format (samples per channel and number of channels).
   const size_t input_num_frames_;
@@ -146,6 +172,11 @@ class AudioBuffer {
   AudioFrame::VADActivity activity_;
 
   const float* keyboard_data_;
+  // Holds the samples of all the buffers below. The buffers are only
+  // allocated if they are needed with the formats given at construction.
+  rtc::scoped_ptr<uint8_t, AlignedFreeDeleter> arena_;
+  size_t arena_size_;
+  int64_t num_copied_samples_;
   rtc::scoped_ptr<IFChannelBuffer> data_;
   rtc::scoped_ptr<IFChannelBuffer> split_data_;
   rtc::scoped_ptr<SplittingFilter> splitting_filter_;
@@ -154,7 +185,8 @@ class AudioBuffer {
   rtc::scoped_ptr<IFChannelBuffer> input_buffer_;
   rtc::scoped_ptr<IFChannelBuffer> output_buffer_;
   rtc::scoped_ptr<ChannelBuffer<float> > process_buffer_;
-  ScopedVector<PushSincResampler> input_resamplers_;
+  rtc::scoped_ptr<MultiChannelSincResampler> input_resampler_;
+  // One per processed channel, as fewer channels may be output.
   ScopedVector<PushSincResampler> output_resamplers_;
 };
 
@@ -179,10 +179,13 @@ AudioProcessingImpl::AudioProcessingImpl(const Config& config,
       level_estimator_(NULL),
       noise_suppression_(NULL),
       voice_detection_(NULL),
-      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      crit_render_(CriticalSectionWrapper::CreateCriticalSection()),
+      crit_capture_(CriticalSectionWrapper::CreateCriticalSection()),
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
       debug_file_(FileWrapper::Create()),
+      crit_debug_(CriticalSectionWrapper::CreateCriticalSection()),
       event_msg_(new audioproc::Event()),
+      render_event_msg_(new audioproc::Event()),
 #endif
       api_format_({{{kSampleRate16kHz, 1, false},
                     {kSampleRate16kHz, 1, false},
@@ -215,25 +218,29 @@ AudioProcessingImpl::AudioProcessingImpl(const Config& config,
       beamformer_(beamformer),
       array_geometry_(config.Get<Beamforming>().array_geometry),
       intelligibility_enabled_(config.Get<Intelligibility>().enabled) {
-  echo_cancellation_ = new EchoCancellationImpl(this, crit_);
+  // Components which consume the render signal queue it for the capture side
+  // and need both locks; the others only run on the capture side.
+  echo_cancellation_ =
+      new EchoCancellationImpl(this, crit_render_, crit_capture_);
   component_list_.push_back(echo_cancellation_);
 
-  echo_control_mobile_ = new EchoControlMobileImpl(this, crit_);
+  echo_control_mobile_ =
+      new EchoControlMobileImpl(this, crit_render_, crit_capture_);
   component_list_.push_back(echo_control_mobile_);
 
-  gain_control_ = new GainControlImpl(this, crit_);
+  gain_control_ = new GainControlImpl(this, crit_render_, crit_capture_);
   component_list_.push_back(gain_control_);
 
-  high_pass_filter_ = new HighPassFilterImpl(this, crit_);
+  high_pass_filter_ = new HighPassFilterImpl(this, crit_capture_);
   component_list_.push_back(high_pass_filter_);
 
-  level_estimator_ = new LevelEstimatorImpl(this, crit_);
+  level_estimator_ = new LevelEstimatorImpl(this, crit_capture_);
   component_list_.push_back(level_estimator_);
 
-  noise_suppression_ = new NoiseSuppressionImpl(this, crit_);
+  noise_suppression_ = new NoiseSuppressionImpl(this, crit_capture_);
   component_list_.push_back(noise_suppression_);
 
-  voice_detection_ = new VoiceDetectionImpl(this, crit_);
+  voice_detection_ = new VoiceDetectionImpl(this, crit_capture_);
   component_list_.push_back(voice_detection_);
 
   gain_control_for_new_agc_.reset(new GainControlForNewAgc(gain_control_));
@@ -243,7 +250,8 @@ AudioProcessingImpl::AudioProcessingImpl(const Config& config,
 
 AudioProcessingImpl::~AudioProcessingImpl() {
   {
-    CriticalSectionScoped crit_scoped(crit_);
+    CriticalSectionScoped crit_scoped_render(crit_render_);
+    CriticalSectionScoped crit_scoped_capture(crit_capture_);
     // Depends on gain_control_ and gain_control_for_new_agc_.
     agc_manager_.reset();
     // Depends on gain_control_.
@@ -261,17 +269,21 @@ AudioProcessingImpl::~AudioProcessingImpl() {
     }
 #endif
   }
-  delete crit_;
-  crit_ = NULL;
+  delete crit_capture_;
+  crit_capture_ = NULL;
+  delete crit_render_;
+  crit_render_ = NULL;
 }
 
 int AudioProcessingImpl::Initialize() {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   return InitializeLocked();
 }
 
 int AudioProcessingImpl::set_sample_rate_hz(int rate) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
 
   ProcessingConfig processing_config = api_format_;
   processing_config.input_stream().set_sample_rate_hz(rate);
@@ -303,7 +315,8 @@ int AudioProcessingImpl::Initialize(int input_sample_rate_hz,
 }
 
 int AudioProcessingImpl::Initialize(const ProcessingConfig& processing_config) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   return InitializeLocked(processing_config);
 }
 
@@ -454,8 +467,43 @@ int AudioProcessingImpl::MaybeInitializeLocked(
   return InitializeLocked(processing_config);
 }
 
+int AudioProcessingImpl::MaybeInitializeCapture(
+    const StreamConfig& input_config,
+    const StreamConfig& output_config) {
+  {
+    // The format only changes with both locks held, so the capture lock is
+    // enough to check it.
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    if (input_config == api_format_.input_stream() &&
+        output_config == api_format_.output_stream()) {
+      return kNoError;
+    }
+  }
+
+  // The render lock has to be taken first, which is why the capture lock was
+  // released above.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
+  ProcessingConfig processing_config = api_format_;
+  processing_config.input_stream() = input_config;
+  processing_config.output_stream() = output_config;
+  return MaybeInitializeLocked(processing_config);
+}
+
+int AudioProcessingImpl::MaybeInitializeRender(
+    const ProcessingConfig& processing_config) {
+  if (processing_config == api_format_) {
+    return kNoError;
+  }
+  // Lock order is render before capture, so this can't deadlock with the
+  // capture side.
+  CriticalSectionScoped crit_scoped(crit_capture_);
+  return InitializeLocked(processing_config);
+}
+
 void AudioProcessingImpl::SetExtraOptions(const Config& config) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   for (auto item : component_list_) {
     item->SetExtraOptions(config);
   }
@@ -467,12 +515,12 @@ void AudioProcessingImpl::SetExtraOptions(const Config& config) {
 }
 
 int AudioProcessingImpl::input_sample_rate_hz() const {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   return api_format_.input_stream().sample_rate_hz();
 }
 
 int AudioProcessingImpl::sample_rate_hz() const {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   return api_format_.input_stream().sample_rate_hz();
 }
 
@@ -497,7 +545,7 @@ int AudioProcessingImpl::num_output_channels() const {
 }
 
 void AudioProcessingImpl::set_output_will_be_muted(bool muted) {
-  CriticalSectionScoped lock(crit_);
+  CriticalSectionScoped lock(crit_capture_);
   output_will_be_muted_ = muted;
   if (agc_manager_.get()) {
     agc_manager_->SetCaptureMuted(output_will_be_muted_);
@@ -505,7 +553,7 @@ void AudioProcessingImpl::set_output_will_be_muted(bool muted) {
 }
 
 bool AudioProcessingImpl::output_will_be_muted() const {
-  CriticalSectionScoped lock(crit_);
+  CriticalSectionScoped lock(crit_capture_);
   return output_will_be_muted_;
 }
 
@@ -516,16 +564,12 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
                                        int output_sample_rate_hz,
                                        ChannelLayout output_layout,
                                        float* const* dest) {
-  CriticalSectionScoped crit_scoped(crit_);
-  StreamConfig input_stream = api_format_.input_stream();
-  input_stream.set_sample_rate_hz(input_sample_rate_hz);
-  input_stream.set_num_channels(ChannelsFromLayout(input_layout));
-  input_stream.set_has_keyboard(LayoutHasKeyboard(input_layout));
-
-  StreamConfig output_stream = api_format_.output_stream();
-  output_stream.set_sample_rate_hz(output_sample_rate_hz);
-  output_stream.set_num_channels(ChannelsFromLayout(output_layout));
-  output_stream.set_has_keyboard(LayoutHasKeyboard(output_layout));
+  const StreamConfig input_stream(input_sample_rate_hz,
+                                  ChannelsFromLayout(input_layout),
+                                  LayoutHasKeyboard(input_layout));
+  const StreamConfig output_stream(output_sample_rate_hz,
+                                   ChannelsFromLayout(output_layout),
+                                   LayoutHasKeyboard(output_layout));
 
   if (samples_per_channel != input_stream.num_frames()) {
     return kBadDataLengthError;
@@ -537,17 +581,13 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
                                        const StreamConfig& input_config,
                                        const StreamConfig& output_config,
                                        float* const* dest) {
-  CriticalSectionScoped crit_scoped(crit_);
   if (!src || !dest) {
     return kNullPointerError;
   }
 
-  ProcessingConfig processing_config = api_format_;
-  processing_config.input_stream() = input_config;
-  processing_config.output_stream() = output_config;
-
-  RETURN_ON_ERR(MaybeInitializeLocked(processing_config));
-  assert(processing_config.input_stream().num_frames() ==
+  RETURN_ON_ERR(MaybeInitializeCapture(input_config, output_config));
+  CriticalSectionScoped crit_scoped(crit_capture_);
+  assert(input_config.num_frames() ==
          api_format_.input_stream().num_frames());
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
@@ -572,7 +612,7 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
         sizeof(float) * api_format_.output_stream().num_frames();
     for (int i = 0; i < api_format_.output_stream().num_channels(); ++i)
       msg->add_output_channel(dest[i], channel_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    RETURN_ON_ERR(WriteMessageToDebugFile(event_msg_.get()));
   }
 #endif
 
@@ -580,7 +620,6 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
 }
 
 int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
   if (!frame) {
     return kNullPointerError;
   }
@@ -591,21 +630,29 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
       frame->sample_rate_hz_ != kSampleRate48kHz) {
     return kBadSampleRateError;
   }
-  if (echo_control_mobile_->is_enabled() &&
-      frame->sample_rate_hz_ > kSampleRate16kHz) {
-    LOG(LS_ERROR) << "AECM only supports 16 or 8 kHz sample rates";
-    return kUnsupportedComponentError;
+
+  StreamConfig input_config;
+  StreamConfig output_config;
+  {
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    if (echo_control_mobile_->is_enabled() &&
+        frame->sample_rate_hz_ > kSampleRate16kHz) {
+      LOG(LS_ERROR) << "AECM only supports 16 or 8 kHz sample rates";
+      return kUnsupportedComponentError;
+    }
+    input_config = api_format_.input_stream();
+    output_config = api_format_.output_stream();
   }
 
   // TODO(ajm): The input and output rates and channels are currently
   // constrained to be identical in the int16 interface.
-  ProcessingConfig processing_config = api_format_;
-  processing_config.input_stream().set_sample_rate_hz(frame->sample_rate_hz_);
-  processing_config.input_stream().set_num_channels(frame->num_channels_);
-  processing_config.output_stream().set_sample_rate_hz(frame->sample_rate_hz_);
-  processing_config.output_stream().set_num_channels(frame->num_channels_);
+  input_config.set_sample_rate_hz(frame->sample_rate_hz_);
+  input_config.set_num_channels(frame->num_channels_);
+  output_config.set_sample_rate_hz(frame->sample_rate_hz_);
+  output_config.set_num_channels(frame->num_channels_);
 
-  RETURN_ON_ERR(MaybeInitializeLocked(processing_config));
+  RETURN_ON_ERR(MaybeInitializeCapture(input_config, output_config));
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (frame->samples_per_channel_ != api_format_.input_stream().num_frames()) {
     return kBadDataLengthError;
   }
@@ -630,7 +677,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
     const size_t data_size =
         sizeof(int16_t) * frame->samples_per_channel_ * frame->num_channels_;
     msg->set_output_data(frame->data_, data_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    RETURN_ON_ERR(WriteMessageToDebugFile(event_msg_.get()));
   }
 #endif
 
@@ -648,6 +695,12 @@ int AudioProcessingImpl::ProcessStreamLocked() {
   }
 #endif
 
+  // Hand the far-end signal queued up by the render side over to the
+  // components before they process the near-end signal.
+  RETURN_ON_ERR(echo_cancellation_->ReadQueuedRenderData());
+  RETURN_ON_ERR(echo_control_mobile_->ReadQueuedRenderData());
+  RETURN_ON_ERR(gain_control_->ReadQueuedRenderData());
+
   MaybeUpdateHistograms();
 
   AudioBuffer* ca = capture_audio_.get();  // For brevity.
@@ -733,8 +786,9 @@ int AudioProcessingImpl::ProcessReverseStream(
     const StreamConfig& reverse_input_config,
     const StreamConfig& reverse_output_config,
     float* const* dest) {
-  RETURN_ON_ERR(
-      AnalyzeReverseStream(src, reverse_input_config, reverse_output_config));
+  CriticalSectionScoped crit_scoped(crit_render_);
+  RETURN_ON_ERR(AnalyzeReverseStreamLocked(src, reverse_input_config,
+                                           reverse_output_config));
   if (is_rev_processed()) {
     render_audio_->CopyTo(api_format_.reverse_output_stream(), dest);
   } else if (rev_conversion_needed()) {
@@ -752,7 +806,15 @@ int AudioProcessingImpl::AnalyzeReverseStream(
     const float* const* src,
     const StreamConfig& reverse_input_config,
     const StreamConfig& reverse_output_config) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_render_);
+  return AnalyzeReverseStreamLocked(src, reverse_input_config,
+                                    reverse_output_config);
+}
+
+int AudioProcessingImpl::AnalyzeReverseStreamLocked(
+    const float* const* src,
+    const StreamConfig& reverse_input_config,
+    const StreamConfig& reverse_output_config) {
   if (src == NULL) {
     return kNullPointerError;
   }
@@ -765,19 +827,20 @@ int AudioProcessingImpl::AnalyzeReverseStream(
   processing_config.reverse_input_stream() = reverse_input_config;
   processing_config.reverse_output_stream() = reverse_output_config;
 
-  RETURN_ON_ERR(MaybeInitializeLocked(processing_config));
+  RETURN_ON_ERR(MaybeInitializeRender(processing_config));
   assert(reverse_input_config.num_frames() ==
          api_format_.reverse_input_stream().num_frames());
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
-    audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
+    render_event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
+    audioproc::ReverseStream* msg =
+        render_event_msg_->mutable_reverse_stream();
     const size_t channel_size =
         sizeof(float) * api_format_.reverse_input_stream().num_frames();
     for (int i = 0; i < api_format_.reverse_input_stream().num_channels(); ++i)
       msg->add_channel(src[i], channel_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    RETURN_ON_ERR(WriteMessageToDebugFile(render_event_msg_.get()));
   }
 #endif
 
@@ -786,7 +849,8 @@ int AudioProcessingImpl::AnalyzeReverseStream(
 }
 
 int AudioProcessingImpl::ProcessReverseStream(AudioFrame* frame) {
-  RETURN_ON_ERR(AnalyzeReverseStream(frame));
+  CriticalSectionScoped crit_scoped(crit_render_);
+  RETURN_ON_ERR(AnalyzeReverseStreamLocked(frame));
   if (is_rev_processed()) {
     render_audio_->InterleaveTo(frame, true);
   }
@@ -795,7 +859,11 @@ int AudioProcessingImpl::ProcessReverseStream(AudioFrame* frame) {
 }
 
 int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_render_);
+  return AnalyzeReverseStreamLocked(frame);
+}
+
+int AudioProcessingImpl::AnalyzeReverseStreamLocked(AudioFrame* frame) {
   if (frame == NULL) {
     return kNullPointerError;
   }
@@ -825,7 +893,7 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
   processing_config.reverse_output_stream().set_num_channels(
       frame->num_channels_);
 
-  RETURN_ON_ERR(MaybeInitializeLocked(processing_config));
+  RETURN_ON_ERR(MaybeInitializeRender(processing_config));
   if (frame->samples_per_channel_ !=
       api_format_.reverse_input_stream().num_frames()) {
     return kBadDataLengthError;
@@ -833,12 +901,13 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
-    audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
+    render_event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
+    audioproc::ReverseStream* msg =
+        render_event_msg_->mutable_reverse_stream();
     const size_t data_size =
         sizeof(int16_t) * frame->samples_per_channel_ * frame->num_channels_;
     msg->set_data(frame->data_, data_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    RETURN_ON_ERR(WriteMessageToDebugFile(render_event_msg_.get()));
   }
 #endif
   render_audio_->DeinterleaveFrom(frame);
@@ -852,6 +921,8 @@ int AudioProcessingImpl::ProcessReverseStreamLocked() {
   }
 
   if (intelligibility_enabled_) {
+    // The enhancer shares its state between the render and capture sides.
+    CriticalSectionScoped crit_scoped(crit_capture_);
     intelligibility_enhancer_->ProcessRenderAudio(
         ra->split_channels_f(kBand0To8kHz), split_rate_, ra->num_channels());
   }
@@ -907,7 +978,7 @@ bool AudioProcessingImpl::stream_key_pressed() const {
 }
 
 void AudioProcessingImpl::set_delay_offset_ms(int offset) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   delay_offset_ms_ = offset;
 }
 
@@ -917,7 +988,8 @@ int AudioProcessingImpl::delay_offset_ms() const {
 
 int AudioProcessingImpl::StartDebugRecording(
     const char filename[AudioProcessing::kMaxFilenameSize]) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   static_assert(kMaxFilenameSize == FileWrapper::kMaxFileNameSize, "");
 
   if (filename == NULL) {
@@ -948,7 +1020,8 @@ int AudioProcessingImpl::StartDebugRecording(
 }
 
 int AudioProcessingImpl::StartDebugRecording(FILE* handle) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
 
   if (handle == NULL) {
     return kNullPointerError;
@@ -983,7 +1056,8 @@ int AudioProcessingImpl::StartDebugRecordingForPlatformFile(
 }
 
 int AudioProcessingImpl::StopDebugRecording() {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // We just return if recording hasn't started.
@@ -1181,7 +1255,7 @@ void AudioProcessingImpl::MaybeUpdateHistograms() {
 }
 
 void AudioProcessingImpl::UpdateHistogramsOnCallEnd() {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (stream_delay_jumps_ > -1) {
     RTC_HISTOGRAM_ENUMERATION(
         "WebRTC.Audio.NumOfPlatformReportedStreamDelayJumps",
@@ -1198,9 +1272,27 @@ void AudioProcessingImpl::UpdateHistogramsOnCallEnd() {
   last_aec_system_delay_ms_ = 0;
 }
 
+int AudioProcessingImpl::GetBufferStatistics(BufferStatistics* stats) const {
+  if (!stats) {
+    return kNullPointerError;
+  }
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
+  *stats = BufferStatistics();
+  if (render_audio_) {
+    render_audio_->AddStatistics(stats);
+  }
+  if (capture_audio_) {
+    capture_audio_->AddStatistics(stats);
+  }
+  return kNoError;
+}
+
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-int AudioProcessingImpl::WriteMessageToDebugFile() {
-  int32_t size = event_msg_->ByteSize();
+int AudioProcessingImpl::WriteMessageToDebugFile(
+    audioproc::Event* event_msg) {
+  CriticalSectionScoped crit_scoped(crit_debug_.get());
+  int32_t size = event_msg->ByteSize();
   if (size <= 0) {
     return kUnspecifiedError;
   }
@@ -1209,7 +1301,7 @@ int AudioProcessingImpl::WriteMessageToDebugFile() {
 //            pretty safe in assuming little-endian.
 #endif
 
-  if (!event_msg_->SerializeToString(&event_str_)) {
+  if (!event_msg->SerializeToString(&event_str_)) {
     return kUnspecifiedError;
   }
 
@@ -1221,7 +1313,7 @@ int AudioProcessingImpl::WriteMessageToDebugFile() {
     return kFileError;
   }
 
-  event_msg_->Clear();
+  event_msg->Clear();
 
   return kNoError;
 }
@@ -1239,7 +1331,7 @@ int AudioProcessingImpl::WriteInitMessage() {
   msg->set_output_sample_rate(api_format_.output_stream().sample_rate_hz());
   // TODO(ekmeyerson): Add reverse output fields to event_msg_.
 
-  int err = WriteMessageToDebugFile();
+  int err = WriteMessageToDebugFile(event_msg_.get());
   if (err != kNoError) {
     return err;
   }
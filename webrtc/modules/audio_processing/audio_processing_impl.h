@@ -112,6 +112,7 @@ class AudioProcessingImpl : public AudioProcessing {
   int StartDebugRecordingForPlatformFile(rtc::PlatformFile handle) override;
   int StopDebugRecording() override;
   void UpdateHistogramsOnCallEnd() override;
+  int GetBufferStatistics(BufferStatistics* stats) const override;
   EchoCancellation* echo_cancellation() const override;
   EchoControlMobile* echo_control_mobile() const override;
   GainControl* gain_control() const override;
@@ -122,19 +123,33 @@ class AudioProcessingImpl : public AudioProcessing {
 
  protected:
   // Overridden in a mock.
-  virtual int InitializeLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  virtual int InitializeLocked()
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
 
  private:
   int InitializeLocked(const ProcessingConfig& config)
-      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
   int MaybeInitializeLocked(const ProcessingConfig& config)
-      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
+  // Reinitializes if the capture stream formats differ from the current ones.
+  // Must be called without any lock held, since reinitialization needs both.
+  int MaybeInitializeCapture(const StreamConfig& input_config,
+                             const StreamConfig& output_config);
+  // Reinitializes if the render stream formats differ from the current ones.
+  int MaybeInitializeRender(const ProcessingConfig& config)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
   // TODO(ekm): Remove once all clients updated to new interface.
   int AnalyzeReverseStream(const float* const* src,
                            const StreamConfig& input_config,
                            const StreamConfig& output_config);
-  int ProcessStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  int ProcessReverseStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  int AnalyzeReverseStreamLocked(const float* const* src,
+                                 const StreamConfig& input_config,
+                                 const StreamConfig& output_config)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
+  int AnalyzeReverseStreamLocked(AudioFrame* frame)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
+  int ProcessStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
+  int ProcessReverseStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
 
   bool is_data_processed() const;
   bool output_copy_needed(bool is_data_processed) const;
@@ -142,11 +157,15 @@ class AudioProcessingImpl : public AudioProcessing {
   bool analysis_needed(bool is_data_processed) const;
   bool is_rev_processed() const;
   bool rev_conversion_needed() const;
-  void InitializeExperimentalAgc() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  void InitializeTransient() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  void InitializeBeamformer() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  void InitializeIntelligibility() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  void MaybeUpdateHistograms() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void InitializeExperimentalAgc()
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
+  void InitializeTransient()
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
+  void InitializeBeamformer()
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
+  void InitializeIntelligibility()
+      EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
+  void MaybeUpdateHistograms() EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
 
   EchoCancellationImpl* echo_cancellation_;
   EchoControlMobileImpl* echo_control_mobile_;
@@ -158,17 +177,29 @@ class AudioProcessingImpl : public AudioProcessing {
   rtc::scoped_ptr<GainControlForNewAgc> gain_control_for_new_agc_;
 
   std::list<ProcessingComponent*> component_list_;
-  CriticalSectionWrapper* crit_;
+
+  // The render (AnalyzeReverseStream) and capture (ProcessStream) paths run
+  // concurrently, each under its own lock. The far-end signal needed by the
+  // echo cancellers and the AGC is handed over through lock-free queues owned
+  // by those components. Changing the configuration or reinitializing
+  // requires both locks, which must always be acquired render first.
+  CriticalSectionWrapper* crit_render_;
+  CriticalSectionWrapper* crit_capture_;
   rtc::scoped_ptr<AudioBuffer> render_audio_;
   rtc::scoped_ptr<AudioBuffer> capture_audio_;
   rtc::scoped_ptr<AudioConverter> render_converter_;
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // TODO(andrew): make this more graceful. Ideally we would split this stuff
   // out into a separate class with an "enabled" and "disabled" implementation.
-  int WriteMessageToDebugFile();
+  int WriteMessageToDebugFile(audioproc::Event* event_msg);
   int WriteInitMessage();
   rtc::scoped_ptr<FileWrapper> debug_file_;
-  rtc::scoped_ptr<audioproc::Event> event_msg_;  // Protobuf message.
+  // Serializes writes to |debug_file_| from the render and capture paths.
+  rtc::scoped_ptr<CriticalSectionWrapper> crit_debug_;
+  // Protobuf messages for the capture path (including INIT events) and the
+  // render path.
+  rtc::scoped_ptr<audioproc::Event> event_msg_;
+  rtc::scoped_ptr<audioproc::Event> render_event_msg_;
   std::string event_str_;  // Memory for protobuf serialization.
 #endif
 
@@ -190,13 +221,13 @@ class AudioProcessingImpl : public AudioProcessing {
   int stream_delay_jumps_;
   int aec_system_delay_jumps_;
 
-  bool output_will_be_muted_ GUARDED_BY(crit_);
+  bool output_will_be_muted_ GUARDED_BY(crit_capture_);
 
   bool key_pressed_;
 
   // Only set through the constructor's Config parameter.
   const bool use_new_agc_;
-  rtc::scoped_ptr<AgcManagerDirect> agc_manager_ GUARDED_BY(crit_);
+  rtc::scoped_ptr<AgcManagerDirect> agc_manager_ GUARDED_BY(crit_capture_);
   int agc_startup_min_volume_;
 
   bool transient_suppressor_enabled_;
@@ -0,0 +1,547 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/batch_audio_processing.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/include/audio_util.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "webrtc/modules/audio_processing/agc/legacy/gain_control.h"
+#include "webrtc/modules/audio_processing/audio_buffer.h"
+#if defined(WEBRTC_NS_FLOAT)
+#include "webrtc/modules/audio_processing/ns/include/noise_suppression.h"
+#elif defined(WEBRTC_NS_FIXED)
+#include "webrtc/modules/audio_processing/ns/include/noise_suppression_x.h"
+#endif
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+
+#if defined(WEBRTC_NS_FLOAT)
+typedef NsHandle NsInst;
+#elif defined(WEBRTC_NS_FIXED)
+typedef NsxHandle NsInst;
+#endif
+
+namespace {
+
+// Keeps the working set of a block within the L2 cache at 48 kHz, and is a
+// multiple of the number of 16-bit lanes of an AVX2 register.
+const int kMaxStreamsPerBlock = 16;
+
+// Same coefficients as in HighPassFilterImpl.
+const int16_t kFilterCoefficients8kHz[5] =
+    {3798, -7596, 3798, 7807, -3733};
+
+const int16_t kFilterCoefficients[5] =
+    {4012, -8024, 4012, 8002, -3913};
+
+int MapNsSetting(NoiseSuppression::Level level) {
+  switch (level) {
+    case NoiseSuppression::kLow:
+      return 0;
+    case NoiseSuppression::kModerate:
+      return 1;
+    case NoiseSuppression::kHigh:
+      return 2;
+    case NoiseSuppression::kVeryHigh:
+      return 3;
+  }
+  return -1;
+}
+
+int MapVadSetting(VoiceDetection::Likelihood likelihood) {
+  switch (likelihood) {
+    case VoiceDetection::kVeryLowLikelihood:
+      return 3;
+    case VoiceDetection::kLowLikelihood:
+      return 2;
+    case VoiceDetection::kModerateLikelihood:
+      return 1;
+    case VoiceDetection::kHighLikelihood:
+      return 0;
+  }
+  return -1;
+}
+
+// The filter of HighPassFilterImpl, run on all the channels of an AudioBuffer.
+// The low band is interleaved so that each step of the recursion updates the
+// state of all streams from contiguous memory, which lets the compiler
+// vectorize the loop over the streams.
+class MultiStreamHighPassFilter {
+ public:
+  MultiStreamHighPassFilter(int sample_rate_hz,
+                            int num_streams,
+                            size_t num_frames_per_band)
+      : ba_(sample_rate_hz == AudioProcessing::kSampleRate8kHz
+                ? kFilterCoefficients8kHz
+                : kFilterCoefficients),
+        num_streams_(num_streams),
+        x0_(num_streams, 0),
+        x1_(num_streams, 0),
+        y0_(num_streams, 0),
+        y1_(num_streams, 0),
+        y2_(num_streams, 0),
+        y3_(num_streams, 0),
+        interleaved_(num_streams * num_frames_per_band) {}
+
+  void Process(AudioBuffer* audio) {
+    assert(audio->num_channels() == num_streams_);
+    const size_t num_frames = audio->num_frames_per_band();
+    Interleave(audio->split_channels_const(kBand0To8kHz), num_frames,
+               num_streams_, &interleaved_[0]);
+    for (size_t i = 0; i < num_frames; ++i) {
+      FilterSample(&interleaved_[i * num_streams_]);
+    }
+    Deinterleave(&interleaved_[0], num_frames, num_streams_,
+                 audio->split_channels(kBand0To8kHz));
+  }
+
+ private:
+  // Filters one sample of every stream. Bitexact with the per-stream
+  // Filter() in high_pass_filter_impl.cc.
+  void FilterSample(int16_t* data) {
+    const int32_t b0 = ba_[0];
+    const int32_t b1 = ba_[1];
+    const int32_t b2 = ba_[2];
+    const int32_t a1 = ba_[3];
+    const int32_t a2 = ba_[4];
+    int16_t* x0 = &x0_[0];
+    int16_t* x1 = &x1_[0];
+    int16_t* y0 = &y0_[0];
+    int16_t* y1 = &y1_[0];
+    int16_t* y2 = &y2_[0];
+    int16_t* y3 = &y3_[0];
+
+    for (int j = 0; j < num_streams_; ++j) {
+      int32_t tmp_int32 = y1[j] * a1 + y3[j] * a2;
+      tmp_int32 = (tmp_int32 >> 15);
+      tmp_int32 += y0[j] * a1 + y2[j] * a2;
+      tmp_int32 = (tmp_int32 << 1);
+      tmp_int32 += data[j] * b0 + x0[j] * b1 + x1[j] * b2;
+
+      x1[j] = x0[j];
+      x0[j] = data[j];
+
+      y2[j] = y0[j];
+      y3[j] = y1[j];
+      y0[j] = static_cast<int16_t>(tmp_int32 >> 13);
+      y1[j] = static_cast<int16_t>(
+          (tmp_int32 - (static_cast<int32_t>(y0[j]) << 13)) << 2);
+
+      tmp_int32 += 2048;
+      tmp_int32 = WEBRTC_SPL_SAT(static_cast<int32_t>(134217727),
+                                 tmp_int32,
+                                 static_cast<int32_t>(-134217728));
+      data[j] = static_cast<int16_t>(tmp_int32 >> 12);
+    }
+  }
+
+  const int16_t* const ba_;
+  const int num_streams_;
+  std::vector<int16_t> x0_;
+  std::vector<int16_t> x1_;
+  std::vector<int16_t> y0_;
+  std::vector<int16_t> y1_;
+  std::vector<int16_t> y2_;
+  std::vector<int16_t> y3_;
+  std::vector<int16_t> interleaved_;
+};
+
+// A block of streams processed together: the streams are the channels of one
+// AudioBuffer.
+class StreamBlock {
+ public:
+  StreamBlock(const BatchAudioProcessing::Config& config, int num_streams)
+      : config_(config),
+        stream_config_(config.sample_rate_hz, num_streams),
+        split_rate_hz_(config.sample_rate_hz > AudioProcessing::kSampleRate16kHz
+                           ? AudioProcessing::kSampleRate16kHz
+                           : config.sample_rate_hz),
+        audio_(stream_config_.num_frames(), num_streams,
+               stream_config_.num_frames(), num_streams,
+               stream_config_.num_frames()),
+        capture_levels_(num_streams, 0),
+        has_voice_(num_streams, true) {}
+
+  ~StreamBlock() {
+    for (NsInst* ns : ns_) {
+#if defined(WEBRTC_NS_FLOAT)
+      WebRtcNs_Free(ns);
+#elif defined(WEBRTC_NS_FIXED)
+      WebRtcNsx_Free(ns);
+#endif
+    }
+    for (void* agc : agc_) {
+      WebRtcAgc_Free(agc);
+    }
+    for (VadInst* vad : vad_) {
+      WebRtcVad_Free(vad);
+    }
+  }
+
+  int Initialize() {
+    const int num_streams = stream_config_.num_channels();
+    if (config_.high_pass_filter_enabled) {
+      hpf_.reset(new MultiStreamHighPassFilter(
+          config_.sample_rate_hz, num_streams, audio_.num_frames_per_band()));
+    }
+
+    for (int i = 0; i < num_streams; ++i) {
+      if (config_.noise_suppression_enabled) {
+#if defined(WEBRTC_NS_FLOAT)
+        ns_.push_back(WebRtcNs_Create());
+        if (WebRtcNs_Init(ns_.back(), config_.sample_rate_hz) != 0 ||
+            WebRtcNs_set_policy(ns_.back(),
+                                MapNsSetting(config_.noise_suppression_level))
+                != 0) {
+          return AudioProcessing::kUnspecifiedError;
+        }
+#elif defined(WEBRTC_NS_FIXED)
+        ns_.push_back(WebRtcNsx_Create());
+        if (WebRtcNsx_Init(ns_.back(), config_.sample_rate_hz) != 0 ||
+            WebRtcNsx_set_policy(ns_.back(),
+                                 MapNsSetting(config_.noise_suppression_level))
+                != 0) {
+          return AudioProcessing::kUnspecifiedError;
+        }
+#endif
+      }
+
+      if (config_.gain_control_enabled) {
+        agc_.push_back(WebRtcAgc_Create());
+        WebRtcAgcConfig agc_config;
+        agc_config.targetLevelDbfs =
+            static_cast<int16_t>(config_.gain_control_target_level_dbfs);
+        agc_config.compressionGaindB =
+            static_cast<int16_t>(config_.gain_control_compression_gain_db);
+        agc_config.limiterEnable = config_.gain_control_limiter_enabled;
+        if (WebRtcAgc_Init(agc_.back(), 0, 255, kAgcModeAdaptiveDigital,
+                           config_.sample_rate_hz) != 0 ||
+            WebRtcAgc_set_config(agc_.back(), agc_config) != 0) {
+          return AudioProcessing::kUnspecifiedError;
+        }
+      }
+
+      if (config_.voice_detection_enabled) {
+        vad_.push_back(WebRtcVad_Create());
+        if (WebRtcVad_Init(vad_.back()) != 0 ||
+            WebRtcVad_set_mode(vad_.back(), MapVadSetting(
+                config_.voice_detection_likelihood)) != 0) {
+          return AudioProcessing::kUnspecifiedError;
+        }
+      }
+    }
+    return AudioProcessing::kNoError;
+  }
+
+  // Processes one chunk of the block's streams in the order of
+  // AudioProcessingImpl::ProcessStreamLocked().
+  int Process(float* const* streams) {
+    audio_.CopyFrom(streams, stream_config_);
+    const bool data_processed = config_.high_pass_filter_enabled ||
+                                config_.noise_suppression_enabled ||
+                                config_.gain_control_enabled;
+    const bool split =
+        config_.sample_rate_hz == AudioProcessing::kSampleRate32kHz ||
+        config_.sample_rate_hz == AudioProcessing::kSampleRate48kHz;
+    if (split) {
+      audio_.SplitIntoFrequencyBands();
+    }
+
+    if (hpf_) {
+      hpf_->Process(&audio_);
+    }
+
+    for (size_t i = 0; i < agc_.size(); ++i) {
+      int32_t capture_level_out = 0;
+      if (WebRtcAgc_VirtualMic(agc_[i], audio_.split_bands(i),
+                               audio_.num_bands(),
+                               audio_.num_frames_per_band(), 0,
+                               &capture_level_out) != 0) {
+        return AudioProcessing::kUnspecifiedError;
+      }
+      capture_levels_[i] = capture_level_out;
+    }
+
+#if defined(WEBRTC_NS_FLOAT)
+    for (size_t i = 0; i < ns_.size(); ++i) {
+      WebRtcNs_Analyze(ns_[i], audio_.split_bands_const_f(i)[kBand0To8kHz]);
+    }
+    for (size_t i = 0; i < ns_.size(); ++i) {
+      WebRtcNs_Process(ns_[i], audio_.split_bands_const_f(i),
+                       audio_.num_bands(), audio_.split_bands_f(i));
+    }
+#elif defined(WEBRTC_NS_FIXED)
+    for (size_t i = 0; i < ns_.size(); ++i) {
+      WebRtcNsx_Process(ns_[i], audio_.split_bands_const(i),
+                        audio_.num_bands(), audio_.split_bands(i));
+    }
+#endif
+
+    for (size_t i = 0; i < vad_.size(); ++i) {
+      const int vad_ret = WebRtcVad_Process(
+          vad_[i], split_rate_hz_,
+          audio_.split_bands_const(i)[kBand0To8kHz],
+          audio_.num_frames_per_band());
+      if (vad_ret < 0) {
+        return AudioProcessing::kUnspecifiedError;
+      }
+      has_voice_[i] = vad_ret == 1;
+    }
+
+    for (size_t i = 0; i < agc_.size(); ++i) {
+      int32_t capture_level_out = 0;
+      uint8_t saturation_warning = 0;
+      if (WebRtcAgc_Process(agc_[i], audio_.split_bands_const(i),
+                            audio_.num_bands(), audio_.num_frames_per_band(),
+                            audio_.split_bands(i), capture_levels_[i],
+                            &capture_level_out, 0,
+                            &saturation_warning) != 0) {
+        return AudioProcessing::kUnspecifiedError;
+      }
+      capture_levels_[i] = capture_level_out;
+    }
+
+    if (split && data_processed) {
+      audio_.MergeFrequencyBands();
+    }
+    audio_.CopyTo(stream_config_, streams);
+    return AudioProcessing::kNoError;
+  }
+
+  int num_streams() const { return stream_config_.num_channels(); }
+  bool stream_has_voice(int stream) const { return has_voice_[stream]; }
+
+ private:
+  const BatchAudioProcessing::Config config_;
+  const StreamConfig stream_config_;
+  const int split_rate_hz_;
+  AudioBuffer audio_;
+  rtc::scoped_ptr<MultiStreamHighPassFilter> hpf_;
+  std::vector<NsInst*> ns_;
+  std::vector<void*> agc_;
+  std::vector<VadInst*> vad_;
+  std::vector<int32_t> capture_levels_;
+  std::vector<bool> has_voice_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamBlock);
+};
+
+}  // namespace
+
+// The streams processed by one thread, split into blocks small enough for the
+// state of a block to stay in cache. All but the first group own a worker
+// thread, which waits for ProcessStreams() to hand it a chunk.
+class BatchAudioProcessing::StreamGroup {
+ public:
+  StreamGroup(const Config& config, int num_streams)
+      : num_streams_(num_streams),
+        streams_(nullptr),
+        result_(AudioProcessing::kNoError),
+        stop_(false) {
+    const int num_blocks =
+        (num_streams + kMaxStreamsPerBlock - 1) / kMaxStreamsPerBlock;
+    for (int i = 0; i < num_blocks; ++i) {
+      blocks_.push_back(new StreamBlock(
+          config,
+          num_streams / num_blocks + (i < num_streams % num_blocks ? 1 : 0)));
+    }
+  }
+
+  ~StreamGroup() {
+    if (thread_) {
+      stop_ = true;
+      start_event_->Set();
+      thread_->Stop();
+    }
+  }
+
+  int Initialize() {
+    for (StreamBlock* block : blocks_) {
+      const int err = block->Initialize();
+      if (err != AudioProcessing::kNoError) {
+        return err;
+      }
+    }
+    return AudioProcessing::kNoError;
+  }
+
+  bool StartThread() {
+    start_event_.reset(EventWrapper::Create());
+    done_event_.reset(EventWrapper::Create());
+    thread_ = ThreadWrapper::CreateThread(&StreamGroup::Run, this,
+                                          "batch_apm_worker");
+    return thread_->Start();
+  }
+
+  // Hands |streams| to the worker thread.
+  void ProcessAsync(float* const* streams) {
+    assert(thread_);
+    streams_ = streams;
+    start_event_->Set();
+  }
+
+  // Waits for the chunk passed to ProcessAsync() to be processed.
+  int WaitForCompletion() {
+    done_event_->Wait(WEBRTC_EVENT_INFINITE);
+    return result_;
+  }
+
+  int Process(float* const* streams) {
+    for (StreamBlock* block : blocks_) {
+      const int err = block->Process(streams);
+      if (err != AudioProcessing::kNoError) {
+        return err;
+      }
+      streams += block->num_streams();
+    }
+    return AudioProcessing::kNoError;
+  }
+
+  int num_streams() const { return num_streams_; }
+
+  bool stream_has_voice(int stream) const {
+    for (const StreamBlock* block : blocks_) {
+      if (stream < block->num_streams()) {
+        return block->stream_has_voice(stream);
+      }
+      stream -= block->num_streams();
+    }
+    assert(false);
+    return true;
+  }
+
+ private:
+  static bool Run(void* obj) {
+    return static_cast<StreamGroup*>(obj)->RunOnce();
+  }
+
+  bool RunOnce() {
+    start_event_->Wait(WEBRTC_EVENT_INFINITE);
+    if (stop_) {
+      return false;
+    }
+    result_ = Process(streams_);
+    done_event_->Set();
+    return true;
+  }
+
+  const int num_streams_;
+  ScopedVector<StreamBlock> blocks_;
+
+  // Handshake with the worker thread. |streams_|, |result_| and |stop_| are
+  // only written before setting the event the other thread waits on.
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  rtc::scoped_ptr<EventWrapper> start_event_;
+  rtc::scoped_ptr<EventWrapper> done_event_;
+  float* const* streams_;
+  int result_;
+  bool stop_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamGroup);
+};
+
+BatchAudioProcessing::Config::Config()
+    : sample_rate_hz(AudioProcessing::kSampleRate16kHz),
+      num_streams(1),
+      num_threads(1),
+      high_pass_filter_enabled(true),
+      noise_suppression_enabled(true),
+      noise_suppression_level(NoiseSuppression::kModerate),
+      gain_control_enabled(true),
+      gain_control_target_level_dbfs(3),
+      gain_control_compression_gain_db(9),
+      gain_control_limiter_enabled(true),
+      voice_detection_enabled(true),
+      voice_detection_likelihood(VoiceDetection::kLowLikelihood) {}
+
+BatchAudioProcessing* BatchAudioProcessing::Create(const Config& config) {
+  if ((config.sample_rate_hz != AudioProcessing::kSampleRate8kHz &&
+       config.sample_rate_hz != AudioProcessing::kSampleRate16kHz &&
+       config.sample_rate_hz != AudioProcessing::kSampleRate32kHz &&
+       config.sample_rate_hz != AudioProcessing::kSampleRate48kHz) ||
+      config.num_streams <= 0 || config.num_threads <= 0 ||
+      MapNsSetting(config.noise_suppression_level) == -1 ||
+      config.gain_control_target_level_dbfs < 0 ||
+      config.gain_control_target_level_dbfs > 31 ||
+      config.gain_control_compression_gain_db < 0 ||
+      config.gain_control_compression_gain_db > 90 ||
+      MapVadSetting(config.voice_detection_likelihood) == -1) {
+    return nullptr;
+  }
+
+  rtc::scoped_ptr<BatchAudioProcessing> batch(
+      new BatchAudioProcessing(config));
+  if (batch->Initialize() != AudioProcessing::kNoError) {
+    return nullptr;
+  }
+  return batch.release();
+}
+
+BatchAudioProcessing::BatchAudioProcessing(const Config& config)
+    : config_(config) {}
+
+BatchAudioProcessing::~BatchAudioProcessing() {}
+
+int BatchAudioProcessing::Initialize() {
+  const int num_groups = std::min(config_.num_threads, config_.num_streams);
+  for (int i = 0; i < num_groups; ++i) {
+    // Spreads the remainder over the first groups.
+    const int num_streams = config_.num_streams / num_groups +
+                            (i < config_.num_streams % num_groups ? 1 : 0);
+    groups_.push_back(new StreamGroup(config_, num_streams));
+    int err = groups_.back()->Initialize();
+    if (err != AudioProcessing::kNoError) {
+      return err;
+    }
+    if (i > 0 && !groups_.back()->StartThread()) {
+      return AudioProcessing::kUnspecifiedError;
+    }
+  }
+  return AudioProcessing::kNoError;
+}
+
+int BatchAudioProcessing::ProcessStreams(float* const* streams) {
+  int first_stream = groups_[0]->num_streams();
+  for (size_t i = 1; i < groups_.size(); ++i) {
+    groups_[i]->ProcessAsync(&streams[first_stream]);
+    first_stream += groups_[i]->num_streams();
+  }
+
+  int err = groups_[0]->Process(streams);
+  for (size_t i = 1; i < groups_.size(); ++i) {
+    const int group_err = groups_[i]->WaitForCompletion();
+    if (err == AudioProcessing::kNoError) {
+      err = group_err;
+    }
+  }
+  return err;
+}
+
+bool BatchAudioProcessing::stream_has_voice(int stream) const {
+  assert(stream >= 0 && stream < config_.num_streams);
+  for (const StreamGroup* group : groups_) {
+    if (stream < group->num_streams()) {
+      return group->stream_has_voice(stream);
+    }
+    stream -= group->num_streams();
+  }
+  return true;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_BATCH_AUDIO_PROCESSING_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_BATCH_AUDIO_PROCESSING_H_
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/modules/audio_processing/include/audio_processing.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+
+namespace webrtc {
+
+// Runs the capture-side cleanup of AudioProcessing (high-pass filter, noise
+// suppression, adaptive digital gain control and voice detection) on many
+// independent mono streams at once, as needed by a server mixing a large
+// number of participants.
+//
+// The output of every stream is identical to that of an AudioProcessing
+// instance with the same components enabled. The streams are partitioned into
+// groups, one per thread, and each group into blocks of a few streams. The
+// streams of a block are the channels of a single AudioBuffer, so the format
+// conversions and band splitting run over all of them in one pass, and the
+// high-pass filter runs across streams, sample by sample, on contiguous state.
+//
+// Usage:
+// BatchAudioProcessing::Config config;
+// config.sample_rate_hz = 16000;
+// config.num_streams = 200;
+// config.num_threads = 4;
+// rtc::scoped_ptr<BatchAudioProcessing> batch(
+//     BatchAudioProcessing::Create(config));
+//
+// // Every 10 ms:
+// batch->ProcessStreams(streams);
+// for (int i = 0; i < config.num_streams; ++i) {
+//   if (batch->stream_has_voice(i)) ...
+// }
+class BatchAudioProcessing {
+ public:
+  struct Config {
+    Config();
+
+    // One of the AudioProcessing::NativeRate values.
+    int sample_rate_hz;
+    int num_streams;
+    // The number of threads processing the streams, including the one calling
+    // ProcessStreams().
+    int num_threads;
+
+    bool high_pass_filter_enabled;
+    bool noise_suppression_enabled;
+    NoiseSuppression::Level noise_suppression_level;
+    // Gain control always runs in GainControl::kAdaptiveDigital mode.
+    bool gain_control_enabled;
+    int gain_control_target_level_dbfs;
+    int gain_control_compression_gain_db;
+    bool gain_control_limiter_enabled;
+    bool voice_detection_enabled;
+    VoiceDetection::Likelihood voice_detection_likelihood;
+  };
+
+  // Returns NULL if |config| is invalid.
+  static BatchAudioProcessing* Create(const Config& config);
+  ~BatchAudioProcessing();
+
+  // Processes one 10 ms chunk of every stream in place. |streams| holds
+  // |num_streams| pointers to |sample_rate_hz| / 100 samples in the range
+  // [-1, 1]. Returns the first error encountered, or kNoError.
+  int ProcessStreams(float* const* streams);
+
+  // The result of the voice detection on the last chunk of |stream|. Always
+  // true if voice detection is disabled.
+  bool stream_has_voice(int stream) const;
+
+  int num_streams() const { return config_.num_streams; }
+  int num_threads() const { return static_cast<int>(groups_.size()); }
+
+ private:
+  class StreamGroup;
+
+  explicit BatchAudioProcessing(const Config& config);
+  int Initialize();
+
+  const Config config_;
+  ScopedVector<StreamGroup> groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchAudioProcessing);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_BATCH_AUDIO_PROCESSING_H_
@@ -0,0 +1,231 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/config.h"
+#include "webrtc/modules/audio_processing/batch_audio_processing.h"
+#include "webrtc/modules/audio_processing/include/audio_processing.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumChunks = 200;
+
+// Fills |buffer| with a different signal per stream: bursts of a tone, whose
+// frequency and level depend on the stream, on top of noise. Every fifth
+// stream is silent, to exercise the voice detection in both states.
+void GenerateChunk(int chunk_index,
+                   int sample_rate_hz,
+                   ChannelBuffer<float>* buffer) {
+  for (int stream = 0; stream < buffer->num_channels(); ++stream) {
+    float* samples = buffer->channels()[stream];
+    uint32_t seed = 1 + 7919 * stream + 104729 * chunk_index;
+    const bool silent = stream % 5 == 4;
+    const bool active = (chunk_index / (10 + stream)) % 2 == 0;
+    const float frequency_hz = 200.f + 50.f * stream;
+    const float amplitude = active ? 0.05f + 0.1f * (stream % 3) : 0.f;
+    for (size_t i = 0; i < buffer->num_frames(); ++i) {
+      seed = seed * 1664525 + 1013904223;
+      const float t = static_cast<float>(chunk_index * buffer->num_frames() +
+                                         i) / sample_rate_hz;
+      const float noise = static_cast<float>(seed >> 16) / 65536.f - 0.5f;
+      samples[i] = silent ? 0.f
+                          : amplitude * sinf(2.f * static_cast<float>(M_PI) *
+                                             frequency_hz * t) +
+                                0.005f * noise;
+    }
+  }
+}
+
+AudioProcessing* CreateEquivalentApm(
+    const BatchAudioProcessing::Config& config) {
+  Config apm_config;
+  apm_config.Set<ExperimentalAgc>(new ExperimentalAgc(false));
+  AudioProcessing* apm = AudioProcessing::Create(apm_config);
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->high_pass_filter()->Enable(config.high_pass_filter_enabled));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->set_level(
+                config.noise_suppression_level));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->Enable(
+                config.noise_suppression_enabled));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->gain_control()->Enable(config.gain_control_enabled));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->voice_detection()->set_likelihood(
+                config.voice_detection_likelihood));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->voice_detection()->Enable(config.voice_detection_enabled));
+  return apm;
+}
+
+// Verifies that every stream processed by BatchAudioProcessing is bitexact
+// with the same stream processed by its own AudioProcessing instance.
+void VerifyMatchesAudioProcessing(const BatchAudioProcessing::Config& config) {
+  rtc::scoped_ptr<BatchAudioProcessing> batch(
+      BatchAudioProcessing::Create(config));
+  ASSERT_TRUE(batch.get() != nullptr);
+  ScopedVector<AudioProcessing> apms;
+  for (int i = 0; i < config.num_streams; ++i) {
+    apms.push_back(CreateEquivalentApm(config));
+  }
+
+  const StreamConfig stream_config(config.sample_rate_hz, 1);
+  ChannelBuffer<float> batch_buffer(stream_config.num_frames(),
+                                    config.num_streams);
+  ChannelBuffer<float> apm_buffer(stream_config.num_frames(),
+                                  config.num_streams);
+  int num_voice_decisions = 0;
+  for (int chunk = 0; chunk < kNumChunks; ++chunk) {
+    GenerateChunk(chunk, config.sample_rate_hz, &batch_buffer);
+    GenerateChunk(chunk, config.sample_rate_hz, &apm_buffer);
+    ASSERT_EQ(AudioProcessing::kNoError,
+              batch->ProcessStreams(batch_buffer.channels()));
+    for (int i = 0; i < config.num_streams; ++i) {
+      float* stream = apm_buffer.channels()[i];
+      ASSERT_EQ(AudioProcessing::kNoError,
+                apms[i]->ProcessStream(&stream, stream_config, stream_config,
+                                       &stream));
+      for (size_t j = 0; j < stream_config.num_frames(); ++j) {
+        ASSERT_EQ(apm_buffer.channels()[i][j], batch_buffer.channels()[i][j])
+            << "stream " << i << ", chunk " << chunk << ", sample " << j;
+      }
+      if (config.voice_detection_enabled) {
+        ASSERT_EQ(apms[i]->voice_detection()->stream_has_voice(),
+                  batch->stream_has_voice(i))
+            << "stream " << i << ", chunk " << chunk;
+        num_voice_decisions += batch->stream_has_voice(i) ? 1 : 0;
+      }
+    }
+  }
+  if (config.voice_detection_enabled) {
+    // Make sure the signal exercises both decisions.
+    EXPECT_GT(num_voice_decisions, 0);
+    EXPECT_LT(num_voice_decisions, kNumChunks * config.num_streams);
+  }
+}
+
+}  // namespace
+
+TEST(BatchAudioProcessingTest, MatchesAudioProcessingAtAllRates) {
+  const int kSampleRatesHz[] = {AudioProcessing::kSampleRate8kHz,
+                                AudioProcessing::kSampleRate16kHz,
+                                AudioProcessing::kSampleRate32kHz,
+                                AudioProcessing::kSampleRate48kHz};
+  for (int sample_rate_hz : kSampleRatesHz) {
+    SCOPED_TRACE(sample_rate_hz);
+    BatchAudioProcessing::Config config;
+    config.sample_rate_hz = sample_rate_hz;
+    config.num_streams = 7;
+    config.num_threads = 3;
+    VerifyMatchesAudioProcessing(config);
+  }
+}
+
+TEST(BatchAudioProcessingTest, MatchesAudioProcessingWithSeveralBlocks) {
+  BatchAudioProcessing::Config config;
+  config.num_streams = 37;
+  VerifyMatchesAudioProcessing(config);
+}
+
+TEST(BatchAudioProcessingTest, MatchesAudioProcessingWithSubsetOfComponents) {
+  BatchAudioProcessing::Config config;
+  config.sample_rate_hz = AudioProcessing::kSampleRate32kHz;
+  config.num_streams = 5;
+  config.num_threads = 2;
+  config.gain_control_enabled = false;
+  config.noise_suppression_level = NoiseSuppression::kVeryHigh;
+  config.voice_detection_likelihood = VoiceDetection::kHighLikelihood;
+  VerifyMatchesAudioProcessing(config);
+
+  config.high_pass_filter_enabled = false;
+  config.noise_suppression_enabled = false;
+  config.gain_control_enabled = true;
+  config.voice_detection_enabled = false;
+  VerifyMatchesAudioProcessing(config);
+}
+
+TEST(BatchAudioProcessingTest, ThreadCountDoesNotChangeOutput) {
+  BatchAudioProcessing::Config config;
+  config.sample_rate_hz = AudioProcessing::kSampleRate48kHz;
+  config.num_streams = 41;
+  rtc::scoped_ptr<BatchAudioProcessing> single(
+      BatchAudioProcessing::Create(config));
+  config.num_threads = 4;
+  rtc::scoped_ptr<BatchAudioProcessing> multi(
+      BatchAudioProcessing::Create(config));
+  ASSERT_TRUE(single.get() != nullptr);
+  ASSERT_TRUE(multi.get() != nullptr);
+  EXPECT_EQ(1, single->num_threads());
+  EXPECT_EQ(4, multi->num_threads());
+
+  const size_t num_frames = static_cast<size_t>(config.sample_rate_hz / 100);
+  ChannelBuffer<float> single_buffer(num_frames, config.num_streams);
+  ChannelBuffer<float> multi_buffer(num_frames, config.num_streams);
+  for (int chunk = 0; chunk < kNumChunks; ++chunk) {
+    GenerateChunk(chunk, config.sample_rate_hz, &single_buffer);
+    GenerateChunk(chunk, config.sample_rate_hz, &multi_buffer);
+    ASSERT_EQ(AudioProcessing::kNoError,
+              single->ProcessStreams(single_buffer.channels()));
+    ASSERT_EQ(AudioProcessing::kNoError,
+              multi->ProcessStreams(multi_buffer.channels()));
+    for (int i = 0; i < config.num_streams; ++i) {
+      for (size_t j = 0; j < num_frames; ++j) {
+        ASSERT_EQ(single_buffer.channels()[i][j],
+                  multi_buffer.channels()[i][j]);
+      }
+      ASSERT_EQ(single->stream_has_voice(i), multi->stream_has_voice(i));
+    }
+  }
+}
+
+TEST(BatchAudioProcessingTest, MoreThreadsThanStreams) {
+  BatchAudioProcessing::Config config;
+  config.num_streams = 2;
+  config.num_threads = 8;
+  rtc::scoped_ptr<BatchAudioProcessing> batch(
+      BatchAudioProcessing::Create(config));
+  ASSERT_TRUE(batch.get() != nullptr);
+  EXPECT_EQ(2, batch->num_threads());
+}
+
+TEST(BatchAudioProcessingTest, RejectsInvalidConfig) {
+  BatchAudioProcessing::Config config;
+  config.sample_rate_hz = 44100;
+  EXPECT_TRUE(BatchAudioProcessing::Create(config) == nullptr);
+
+  config = BatchAudioProcessing::Config();
+  config.num_streams = 0;
+  EXPECT_TRUE(BatchAudioProcessing::Create(config) == nullptr);
+
+  config = BatchAudioProcessing::Config();
+  config.num_threads = 0;
+  EXPECT_TRUE(BatchAudioProcessing::Create(config) == nullptr);
+
+  config = BatchAudioProcessing::Config();
+  config.gain_control_target_level_dbfs = 32;
+  EXPECT_TRUE(BatchAudioProcessing::Create(config) == nullptr);
+
+  config = BatchAudioProcessing::Config();
+  config.gain_control_compression_gain_db = -1;
+  EXPECT_TRUE(BatchAudioProcessing::Create(config) == nullptr);
+}
+
+}  // namespace webrtc
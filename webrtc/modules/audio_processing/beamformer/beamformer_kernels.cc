@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels_sse2.h"
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels_neon.h"
+#endif
+
+// With m = x + iy and R = A + iB, the quadratic forms are computed with real
+// arithmetic as
+//   Re(conj(m) * R * m.') = sum_i (sum_j x_j A_ji + y_j B_ji) x_i
+//                                - (sum_j x_j B_ji - y_j A_ji) y_i,
+//   Re(conj(m) * conj(R) * m.') = sum_i (sum_j x_j A_ji - y_j B_ji) x_i
+//                                      + (sum_j x_j B_ji + y_j A_ji) y_i,
+// which share all their products. The vectorized kernels do the same
+// operations in the same order for 4 bins at a time.
+
+namespace webrtc {
+namespace {
+
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+bool HasSse2() {
+#if defined(__SSE2__)
+  return true;
+#else
+  return WebRtc_GetCPUInfo(kSSE2) != 0;
+#endif
+}
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+bool HasNeon() {
+#if defined(WEBRTC_HAS_NEON)
+  return true;
+#else
+  return (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0;
+#endif
+}
+#endif
+
+void ComputePostfilterNorms_C(const BinnedComplexMatrices& target_cov_mats,
+                              const BinnedComplexMatrices& interf_cov_mats,
+                              const BinnedComplexMatrices& delay_sum_masks,
+                              const std::complex<float>* const* input,
+                              size_t first_bin,
+                              size_t last_bin,
+                              float* rxims,
+                              float* rpsims,
+                              float* reflected_rpsims,
+                              float* rmws) {
+  const int num_channels = delay_sum_masks.num_columns();
+  for (size_t bin = first_bin; bin < last_bin; ++bin) {
+    float sum_squares = 0.f;
+    for (int c = 0; c < num_channels; ++c) {
+      sum_squares += input[c][bin].real() * input[c][bin].real();
+      sum_squares += input[c][bin].imag() * input[c][bin].imag();
+    }
+    // Normalizes to unit norm, leaving all-zero inputs untouched.
+    const float scale = sum_squares > 0.f ? 1.f / std::sqrt(sum_squares) : 0.f;
+
+    float rxim = 0.f;
+    float rpsim = 0.f;
+    float reflected_rpsim = 0.f;
+    float rmw_real = 0.f;
+    float rmw_imag = 0.f;
+    for (int i = 0; i < num_channels; ++i) {
+      float target_xa = 0.f;
+      float target_yb = 0.f;
+      float target_xb = 0.f;
+      float target_ya = 0.f;
+      float interf_xa = 0.f;
+      float interf_yb = 0.f;
+      float interf_xb = 0.f;
+      float interf_ya = 0.f;
+      for (int j = 0; j < num_channels; ++j) {
+        const float x = scale * input[j][bin].real();
+        const float y = scale * input[j][bin].imag();
+        target_xa += x * target_cov_mats.real(j, i)[bin];
+        target_yb += y * target_cov_mats.imag(j, i)[bin];
+        target_xb += x * target_cov_mats.imag(j, i)[bin];
+        target_ya += y * target_cov_mats.real(j, i)[bin];
+        interf_xa += x * interf_cov_mats.real(j, i)[bin];
+        interf_yb += y * interf_cov_mats.imag(j, i)[bin];
+        interf_xb += x * interf_cov_mats.imag(j, i)[bin];
+        interf_ya += y * interf_cov_mats.real(j, i)[bin];
+      }
+      const float x = scale * input[i][bin].real();
+      const float y = scale * input[i][bin].imag();
+      rxim += (target_xa + target_yb) * x;
+      rxim -= (target_xb - target_ya) * y;
+      rpsim += (interf_xa + interf_yb) * x;
+      rpsim -= (interf_xb - interf_ya) * y;
+      reflected_rpsim += (interf_xa - interf_yb) * x;
+      reflected_rpsim += (interf_xb + interf_ya) * y;
+      const float mask_real = delay_sum_masks.real(0, i)[bin];
+      const float mask_imag = delay_sum_masks.imag(0, i)[bin];
+      rmw_real += mask_real * x;
+      rmw_real += mask_imag * y;
+      rmw_imag += mask_real * y;
+      rmw_imag -= mask_imag * x;
+    }
+    rxims[bin] = std::max(rxim, 0.f);
+    rpsims[bin] = std::max(rpsim, 0.f);
+    reflected_rpsims[bin] = std::max(reflected_rpsim, 0.f);
+    rmws[bin] = rmw_real * rmw_real + rmw_imag * rmw_imag;
+  }
+}
+
+void ApplyBinMasks_C(const BinnedComplexMatrices& masks,
+                     const std::complex<float>* const* input,
+                     const float* gains,
+                     size_t first_bin,
+                     size_t last_bin,
+                     std::complex<float>* output) {
+  const int num_channels = masks.num_columns();
+  for (size_t bin = first_bin; bin < last_bin; ++bin) {
+    float real = 0.f;
+    float imag = 0.f;
+    for (int c = 0; c < num_channels; ++c) {
+      const float mask_real = masks.real(0, c)[bin];
+      const float mask_imag = masks.imag(0, c)[bin];
+      real += input[c][bin].real() * mask_real;
+      real -= input[c][bin].imag() * mask_imag;
+      imag += input[c][bin].real() * mask_imag;
+      imag += input[c][bin].imag() * mask_real;
+    }
+    output[bin] = std::complex<float>(real * gains[bin], imag * gains[bin]);
+  }
+}
+
+// Returns the end of the largest range of whole groups of 4 bins starting at
+// |first_bin|.
+size_t VectorizedEnd(size_t first_bin, size_t last_bin) {
+  return first_bin + (last_bin - first_bin) / 4 * 4;
+}
+
+}  // namespace
+
+BinnedComplexMatrices::BinnedComplexMatrices(int num_rows,
+                                             int num_columns,
+                                             size_t num_bins)
+    : num_rows_(num_rows),
+      num_columns_(num_columns),
+      num_bins_(num_bins),
+      real_(num_rows * num_columns * num_bins, 0.f),
+      imag_(real_.size(), 0.f) {}
+
+void BinnedComplexMatrices::Set(size_t bin, const ComplexMatrix<float>& mat) {
+  CHECK_LT(bin, num_bins_);
+  CHECK_EQ(num_rows_, mat.num_rows());
+  CHECK_EQ(num_columns_, mat.num_columns());
+  const std::complex<float>* const* elements = mat.elements();
+  for (int i = 0; i < num_rows_; ++i) {
+    for (int j = 0; j < num_columns_; ++j) {
+      real_[(i * num_columns_ + j) * num_bins_ + bin] = elements[i][j].real();
+      imag_[(i * num_columns_ + j) * num_bins_ + bin] = elements[i][j].imag();
+    }
+  }
+}
+
+void ComputePostfilterNorms(const BinnedComplexMatrices& target_cov_mats,
+                            const BinnedComplexMatrices& interf_cov_mats,
+                            const BinnedComplexMatrices& delay_sum_masks,
+                            const std::complex<float>* const* input,
+                            size_t first_bin,
+                            size_t last_bin,
+                            float* rxims,
+                            float* rpsims,
+                            float* reflected_rpsims,
+                            float* rmws) {
+  const int num_channels = delay_sum_masks.num_columns();
+  DCHECK_EQ(1, delay_sum_masks.num_rows());
+  DCHECK_EQ(num_channels, target_cov_mats.num_rows());
+  DCHECK_EQ(num_channels, target_cov_mats.num_columns());
+  DCHECK_EQ(num_channels, interf_cov_mats.num_rows());
+  DCHECK_EQ(num_channels, interf_cov_mats.num_columns());
+  DCHECK_LE(first_bin, last_bin);
+  DCHECK_LE(last_bin, delay_sum_masks.num_bins());
+  size_t bin = first_bin;
+  if (num_channels <= kMaxSpecializedChannels) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (HasSse2()) {
+      bin = VectorizedEnd(first_bin, last_bin);
+      ComputePostfilterNorms_SSE2(target_cov_mats, interf_cov_mats,
+                                  delay_sum_masks, input, first_bin, bin,
+                                  rxims, rpsims, reflected_rpsims, rmws);
+    }
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+    if (HasNeon()) {
+      bin = VectorizedEnd(first_bin, last_bin);
+      ComputePostfilterNorms_NEON(target_cov_mats, interf_cov_mats,
+                                  delay_sum_masks, input, first_bin, bin,
+                                  rxims, rpsims, reflected_rpsims, rmws);
+    }
+#endif
+  }
+  ComputePostfilterNorms_C(target_cov_mats, interf_cov_mats, delay_sum_masks,
+                           input, bin, last_bin, rxims, rpsims,
+                           reflected_rpsims, rmws);
+}
+
+void ApplyBinMasks(const BinnedComplexMatrices& masks,
+                   const std::complex<float>* const* input,
+                   const float* gains,
+                   std::complex<float>* output) {
+  DCHECK_EQ(1, masks.num_rows());
+  size_t bin = 0;
+  if (masks.num_columns() <= kMaxSpecializedChannels) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (HasSse2()) {
+      bin = VectorizedEnd(0, masks.num_bins());
+      ApplyBinMasks_SSE2(masks, input, gains, 0, bin, output);
+    }
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+    if (HasNeon()) {
+      bin = VectorizedEnd(0, masks.num_bins());
+      ApplyBinMasks_NEON(masks, input, gains, 0, bin, output);
+    }
+#endif
+  }
+  ApplyBinMasks_C(masks, input, gains, bin, masks.num_bins(), output);
+}
+
+}  // namespace webrtc
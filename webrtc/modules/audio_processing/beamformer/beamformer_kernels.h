@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_H_
+
+#include <complex>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/modules/audio_processing/beamformer/complex_matrix.h"
+
+namespace webrtc {
+
+// The kernels are vectorized with SSE2 or NEON, and unrolled at compile time,
+// for arrays of up to this many microphones.
+const int kMaxSpecializedChannels = 8;
+
+// One complex matrix per frequency bin, all of the same size. The matrices are
+// stored element by element: the real and imaginary parts of an element are
+// kept in separate planes, each holding the values of that element for
+// consecutive bins. This lets the kernels below process one bin per SIMD lane.
+class BinnedComplexMatrices {
+ public:
+  BinnedComplexMatrices(int num_rows, int num_columns, size_t num_bins);
+
+  // Stores |mat| as the matrix of |bin|.
+  void Set(size_t bin, const ComplexMatrix<float>& mat);
+
+  int num_rows() const { return num_rows_; }
+  int num_columns() const { return num_columns_; }
+  size_t num_bins() const { return num_bins_; }
+
+  // The planes of element (|row|, |column|), indexed by bin.
+  const float* real(int row, int column) const {
+    return &real_[(row * num_columns_ + column) * num_bins_];
+  }
+  const float* imag(int row, int column) const {
+    return &imag_[(row * num_columns_ + column) * num_bins_];
+  }
+
+ private:
+  const int num_rows_;
+  const int num_columns_;
+  const size_t num_bins_;
+  std::vector<float> real_;
+  std::vector<float> imag_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinnedComplexMatrices);
+};
+
+// For every bin in [|first_bin|, |last_bin|) computes, with m the 1 x N row
+// vector of the N channels of |input| at that bin normalized to unit norm and
+// Norm(R, m) = max(Re(conj(m) * R * m.'), 0):
+//   |rxims|[bin] = Norm(target_cov_mats[bin], m),
+//   |rpsims|[bin] = Norm(interf_cov_mats[bin], m),
+//   |reflected_rpsims|[bin] = Norm(conj(interf_cov_mats[bin]), m),
+//   |rmws|[bin] = |conj(delay_sum_masks[bin]) * m.'|^2.
+// The covariance matrices are N x N and the masks 1 x N. These are the
+// quadratic forms the NonlinearBeamformer postfilter needs every block.
+void ComputePostfilterNorms(const BinnedComplexMatrices& target_cov_mats,
+                            const BinnedComplexMatrices& interf_cov_mats,
+                            const BinnedComplexMatrices& delay_sum_masks,
+                            const std::complex<float>* const* input,
+                            size_t first_bin,
+                            size_t last_bin,
+                            float* rxims,
+                            float* rpsims,
+                            float* reflected_rpsims,
+                            float* rmws);
+
+// For every bin computes |output|[bin] = m * masks[bin].' * |gains|[bin], with
+// m the 1 x N row vector of the N channels of |input| at that bin.
+void ApplyBinMasks(const BinnedComplexMatrices& masks,
+                   const std::complex<float>* const* input,
+                   const float* gains,
+                   std::complex<float>* output);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_H_
@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels_neon.h"
+
+#include <arm_neon.h>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace {
+
+// Loads the values of 4 consecutive bins of |channel| as separate real and
+// imaginary parts.
+inline float32x4x2_t LoadBins(const std::complex<float>* channel,
+                              size_t bin) {
+  return vld2q_f32(reinterpret_cast<const float*>(&channel[bin]));
+}
+
+inline float32x4_t Load(const float* plane, size_t bin) {
+  return vld1q_f32(&plane[bin]);
+}
+
+// Returns 1 / sqrt(|v|) for the positive lanes of |v| and 0 for the others.
+inline float32x4_t ReciprocalSqrtOrZero(float32x4_t v) {
+#if defined(WEBRTC_ARCH_ARM64)
+  const float32x4_t r = vdivq_f32(vdupq_n_f32(1.f), vsqrtq_f32(v));
+#else
+  // ARMv7 has no vector square root nor division. Two Newton-Raphson steps
+  // refine the estimate to about single precision.
+  float32x4_t r = vrsqrteq_f32(v);
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+#endif
+  return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(v, vdupq_n_f32(0.f)),
+                                         vreinterpretq_u32_f32(r)));
+}
+
+template <int kNumChannels>
+void ComputePostfilterNorms(const BinnedComplexMatrices& target_cov_mats,
+                            const BinnedComplexMatrices& interf_cov_mats,
+                            const BinnedComplexMatrices& delay_sum_masks,
+                            const std::complex<float>* const* input,
+                            size_t first_bin,
+                            size_t last_bin,
+                            float* rxims,
+                            float* rpsims,
+                            float* reflected_rpsims,
+                            float* rmws) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  for (size_t bin = first_bin; bin < last_bin; bin += 4) {
+    float32x4_t x[kNumChannels];
+    float32x4_t y[kNumChannels];
+    float32x4_t sum_squares = zero;
+    for (int c = 0; c < kNumChannels; ++c) {
+      const float32x4x2_t values = LoadBins(input[c], bin);
+      x[c] = values.val[0];
+      y[c] = values.val[1];
+      sum_squares = vmlaq_f32(sum_squares, x[c], x[c]);
+      sum_squares = vmlaq_f32(sum_squares, y[c], y[c]);
+    }
+    // Normalizes to unit norm, leaving all-zero inputs untouched.
+    const float32x4_t scale = ReciprocalSqrtOrZero(sum_squares);
+    for (int c = 0; c < kNumChannels; ++c) {
+      x[c] = vmulq_f32(scale, x[c]);
+      y[c] = vmulq_f32(scale, y[c]);
+    }
+
+    float32x4_t rxim = zero;
+    float32x4_t rpsim = zero;
+    float32x4_t reflected_rpsim = zero;
+    float32x4_t rmw_real = zero;
+    float32x4_t rmw_imag = zero;
+    for (int i = 0; i < kNumChannels; ++i) {
+      float32x4_t target_xa = zero;
+      float32x4_t target_yb = zero;
+      float32x4_t target_xb = zero;
+      float32x4_t target_ya = zero;
+      float32x4_t interf_xa = zero;
+      float32x4_t interf_yb = zero;
+      float32x4_t interf_xb = zero;
+      float32x4_t interf_ya = zero;
+      for (int j = 0; j < kNumChannels; ++j) {
+        const float32x4_t target_a = Load(target_cov_mats.real(j, i), bin);
+        const float32x4_t target_b = Load(target_cov_mats.imag(j, i), bin);
+        const float32x4_t interf_a = Load(interf_cov_mats.real(j, i), bin);
+        const float32x4_t interf_b = Load(interf_cov_mats.imag(j, i), bin);
+        target_xa = vmlaq_f32(target_xa, x[j], target_a);
+        target_yb = vmlaq_f32(target_yb, y[j], target_b);
+        target_xb = vmlaq_f32(target_xb, x[j], target_b);
+        target_ya = vmlaq_f32(target_ya, y[j], target_a);
+        interf_xa = vmlaq_f32(interf_xa, x[j], interf_a);
+        interf_yb = vmlaq_f32(interf_yb, y[j], interf_b);
+        interf_xb = vmlaq_f32(interf_xb, x[j], interf_b);
+        interf_ya = vmlaq_f32(interf_ya, y[j], interf_a);
+      }
+      rxim = vmlaq_f32(rxim, vaddq_f32(target_xa, target_yb), x[i]);
+      rxim = vmlsq_f32(rxim, vsubq_f32(target_xb, target_ya), y[i]);
+      rpsim = vmlaq_f32(rpsim, vaddq_f32(interf_xa, interf_yb), x[i]);
+      rpsim = vmlsq_f32(rpsim, vsubq_f32(interf_xb, interf_ya), y[i]);
+      reflected_rpsim =
+          vmlaq_f32(reflected_rpsim, vsubq_f32(interf_xa, interf_yb), x[i]);
+      reflected_rpsim =
+          vmlaq_f32(reflected_rpsim, vaddq_f32(interf_xb, interf_ya), y[i]);
+      const float32x4_t mask_real = Load(delay_sum_masks.real(0, i), bin);
+      const float32x4_t mask_imag = Load(delay_sum_masks.imag(0, i), bin);
+      rmw_real = vmlaq_f32(rmw_real, mask_real, x[i]);
+      rmw_real = vmlaq_f32(rmw_real, mask_imag, y[i]);
+      rmw_imag = vmlaq_f32(rmw_imag, mask_real, y[i]);
+      rmw_imag = vmlsq_f32(rmw_imag, mask_imag, x[i]);
+    }
+    vst1q_f32(&rxims[bin], vmaxq_f32(rxim, zero));
+    vst1q_f32(&rpsims[bin], vmaxq_f32(rpsim, zero));
+    vst1q_f32(&reflected_rpsims[bin], vmaxq_f32(reflected_rpsim, zero));
+    vst1q_f32(&rmws[bin], vmlaq_f32(vmulq_f32(rmw_real, rmw_real), rmw_imag,
+                                    rmw_imag));
+  }
+}
+
+template <int kNumChannels>
+void ApplyBinMasks(const BinnedComplexMatrices& masks,
+                   const std::complex<float>* const* input,
+                   const float* gains,
+                   size_t first_bin,
+                   size_t last_bin,
+                   std::complex<float>* output) {
+  for (size_t bin = first_bin; bin < last_bin; bin += 4) {
+    float32x4x2_t result;
+    result.val[0] = vdupq_n_f32(0.f);
+    result.val[1] = vdupq_n_f32(0.f);
+    for (int c = 0; c < kNumChannels; ++c) {
+      const float32x4x2_t values = LoadBins(input[c], bin);
+      const float32x4_t mask_real = Load(masks.real(0, c), bin);
+      const float32x4_t mask_imag = Load(masks.imag(0, c), bin);
+      result.val[0] = vmlaq_f32(result.val[0], values.val[0], mask_real);
+      result.val[0] = vmlsq_f32(result.val[0], values.val[1], mask_imag);
+      result.val[1] = vmlaq_f32(result.val[1], values.val[0], mask_imag);
+      result.val[1] = vmlaq_f32(result.val[1], values.val[1], mask_real);
+    }
+    const float32x4_t gain = Load(gains, bin);
+    result.val[0] = vmulq_f32(result.val[0], gain);
+    result.val[1] = vmulq_f32(result.val[1], gain);
+    vst2q_f32(reinterpret_cast<float*>(&output[bin]), result);
+  }
+}
+
+}  // namespace
+
+void ComputePostfilterNorms_NEON(const BinnedComplexMatrices& target_cov_mats,
+                                 const BinnedComplexMatrices& interf_cov_mats,
+                                 const BinnedComplexMatrices& delay_sum_masks,
+                                 const std::complex<float>* const* input,
+                                 size_t first_bin,
+                                 size_t last_bin,
+                                 float* rxims,
+                                 float* rpsims,
+                                 float* reflected_rpsims,
+                                 float* rmws) {
+  typedef void (*Kernel)(const BinnedComplexMatrices&,
+                         const BinnedComplexMatrices&,
+                         const BinnedComplexMatrices&,
+                         const std::complex<float>* const*, size_t, size_t,
+                         float*, float*, float*, float*);
+  static const Kernel kKernels[kMaxSpecializedChannels] = {
+      ComputePostfilterNorms<1>, ComputePostfilterNorms<2>,
+      ComputePostfilterNorms<3>, ComputePostfilterNorms<4>,
+      ComputePostfilterNorms<5>, ComputePostfilterNorms<6>,
+      ComputePostfilterNorms<7>, ComputePostfilterNorms<8>};
+  const int num_channels = delay_sum_masks.num_columns();
+  DCHECK_GE(num_channels, 1);
+  DCHECK_LE(num_channels, kMaxSpecializedChannels);
+  DCHECK_EQ(0u, (last_bin - first_bin) % 4);
+  kKernels[num_channels - 1](target_cov_mats, interf_cov_mats,
+                             delay_sum_masks, input, first_bin, last_bin,
+                             rxims, rpsims, reflected_rpsims, rmws);
+}
+
+void ApplyBinMasks_NEON(const BinnedComplexMatrices& masks,
+                        const std::complex<float>* const* input,
+                        const float* gains,
+                        size_t first_bin,
+                        size_t last_bin,
+                        std::complex<float>* output) {
+  typedef void (*Kernel)(const BinnedComplexMatrices&,
+                         const std::complex<float>* const*, const float*,
+                         size_t, size_t, std::complex<float>*);
+  static const Kernel kKernels[kMaxSpecializedChannels] = {
+      ApplyBinMasks<1>, ApplyBinMasks<2>, ApplyBinMasks<3>, ApplyBinMasks<4>,
+      ApplyBinMasks<5>, ApplyBinMasks<6>, ApplyBinMasks<7>, ApplyBinMasks<8>};
+  const int num_channels = masks.num_columns();
+  DCHECK_GE(num_channels, 1);
+  DCHECK_LE(num_channels, kMaxSpecializedChannels);
+  DCHECK_EQ(0u, (last_bin - first_bin) % 4);
+  kKernels[num_channels - 1](masks, input, gains, first_bin, last_bin,
+                             output);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_NEON_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_NEON_H_
+
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels.h"
+
+namespace webrtc {
+
+// NEON versions of the functions in beamformer_kernels.h, for arrays of up to
+// |kMaxSpecializedChannels| microphones. They process the bins in groups of 4,
+// so |last_bin| - |first_bin| has to be a multiple of 4.
+void ComputePostfilterNorms_NEON(const BinnedComplexMatrices& target_cov_mats,
+                                 const BinnedComplexMatrices& interf_cov_mats,
+                                 const BinnedComplexMatrices& delay_sum_masks,
+                                 const std::complex<float>* const* input,
+                                 size_t first_bin,
+                                 size_t last_bin,
+                                 float* rxims,
+                                 float* rpsims,
+                                 float* reflected_rpsims,
+                                 float* rmws);
+
+void ApplyBinMasks_NEON(const BinnedComplexMatrices& masks,
+                        const std::complex<float>* const* input,
+                        const float* gains,
+                        size_t first_bin,
+                        size_t last_bin,
+                        std::complex<float>* output);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_BEAMFORMER_BEAMFORMER_KERNELS_NEON_H_
@@ -0,0 +1,205 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels_sse2.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/base/checks.h"
+
+namespace webrtc {
+namespace {
+
+// Loads the values of 4 consecutive bins of |channel| as separate real and
+// imaginary parts.
+inline void LoadBins(const std::complex<float>* channel,
+                     size_t bin,
+                     __m128* real,
+                     __m128* imag) {
+  const float* values = reinterpret_cast<const float*>(&channel[bin]);
+  const __m128 lo = _mm_loadu_ps(values);
+  const __m128 hi = _mm_loadu_ps(values + 4);
+  *real = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+  *imag = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline __m128 Load(const float* plane, size_t bin) {
+  return _mm_loadu_ps(&plane[bin]);
+}
+
+inline __m128 MultiplyAdd(__m128 sum, __m128 a, __m128 b) {
+  return _mm_add_ps(sum, _mm_mul_ps(a, b));
+}
+
+template <int kNumChannels>
+void ComputePostfilterNorms(const BinnedComplexMatrices& target_cov_mats,
+                            const BinnedComplexMatrices& interf_cov_mats,
+                            const BinnedComplexMatrices& delay_sum_masks,
+                            const std::complex<float>* const* input,
+                            size_t first_bin,
+                            size_t last_bin,
+                            float* rxims,
+                            float* rpsims,
+                            float* reflected_rpsims,
+                            float* rmws) {
+  const __m128 zero = _mm_setzero_ps();
+  for (size_t bin = first_bin; bin < last_bin; bin += 4) {
+    __m128 x[kNumChannels];
+    __m128 y[kNumChannels];
+    __m128 sum_squares = zero;
+    for (int c = 0; c < kNumChannels; ++c) {
+      LoadBins(input[c], bin, &x[c], &y[c]);
+      sum_squares = MultiplyAdd(sum_squares, x[c], x[c]);
+      sum_squares = MultiplyAdd(sum_squares, y[c], y[c]);
+    }
+    // Normalizes to unit norm, leaving all-zero inputs untouched.
+    const __m128 scale =
+        _mm_and_ps(_mm_cmpgt_ps(sum_squares, zero),
+                   _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(sum_squares)));
+    for (int c = 0; c < kNumChannels; ++c) {
+      x[c] = _mm_mul_ps(scale, x[c]);
+      y[c] = _mm_mul_ps(scale, y[c]);
+    }
+
+    __m128 rxim = zero;
+    __m128 rpsim = zero;
+    __m128 reflected_rpsim = zero;
+    __m128 rmw_real = zero;
+    __m128 rmw_imag = zero;
+    for (int i = 0; i < kNumChannels; ++i) {
+      __m128 target_xa = zero;
+      __m128 target_yb = zero;
+      __m128 target_xb = zero;
+      __m128 target_ya = zero;
+      __m128 interf_xa = zero;
+      __m128 interf_yb = zero;
+      __m128 interf_xb = zero;
+      __m128 interf_ya = zero;
+      for (int j = 0; j < kNumChannels; ++j) {
+        const __m128 target_a = Load(target_cov_mats.real(j, i), bin);
+        const __m128 target_b = Load(target_cov_mats.imag(j, i), bin);
+        const __m128 interf_a = Load(interf_cov_mats.real(j, i), bin);
+        const __m128 interf_b = Load(interf_cov_mats.imag(j, i), bin);
+        target_xa = MultiplyAdd(target_xa, x[j], target_a);
+        target_yb = MultiplyAdd(target_yb, y[j], target_b);
+        target_xb = MultiplyAdd(target_xb, x[j], target_b);
+        target_ya = MultiplyAdd(target_ya, y[j], target_a);
+        interf_xa = MultiplyAdd(interf_xa, x[j], interf_a);
+        interf_yb = MultiplyAdd(interf_yb, y[j], interf_b);
+        interf_xb = MultiplyAdd(interf_xb, x[j], interf_b);
+        interf_ya = MultiplyAdd(interf_ya, y[j], interf_a);
+      }
+      rxim = MultiplyAdd(rxim, _mm_add_ps(target_xa, target_yb), x[i]);
+      rxim = _mm_sub_ps(
+          rxim, _mm_mul_ps(_mm_sub_ps(target_xb, target_ya), y[i]));
+      rpsim = MultiplyAdd(rpsim, _mm_add_ps(interf_xa, interf_yb), x[i]);
+      rpsim = _mm_sub_ps(
+          rpsim, _mm_mul_ps(_mm_sub_ps(interf_xb, interf_ya), y[i]));
+      reflected_rpsim = MultiplyAdd(
+          reflected_rpsim, _mm_sub_ps(interf_xa, interf_yb), x[i]);
+      reflected_rpsim = MultiplyAdd(
+          reflected_rpsim, _mm_add_ps(interf_xb, interf_ya), y[i]);
+      const __m128 mask_real = Load(delay_sum_masks.real(0, i), bin);
+      const __m128 mask_imag = Load(delay_sum_masks.imag(0, i), bin);
+      rmw_real = MultiplyAdd(rmw_real, mask_real, x[i]);
+      rmw_real = MultiplyAdd(rmw_real, mask_imag, y[i]);
+      rmw_imag = MultiplyAdd(rmw_imag, mask_real, y[i]);
+      rmw_imag = _mm_sub_ps(rmw_imag, _mm_mul_ps(mask_imag, x[i]));
+    }
+    _mm_storeu_ps(&rxims[bin], _mm_max_ps(rxim, zero));
+    _mm_storeu_ps(&rpsims[bin], _mm_max_ps(rpsim, zero));
+    _mm_storeu_ps(&reflected_rpsims[bin], _mm_max_ps(reflected_rpsim, zero));
+    _mm_storeu_ps(&rmws[bin],
+                  MultiplyAdd(_mm_mul_ps(rmw_real, rmw_real), rmw_imag,
+                              rmw_imag));
+  }
+}
+
+template <int kNumChannels>
+void ApplyBinMasks(const BinnedComplexMatrices& masks,
+                   const std::complex<float>* const* input,
+                   const float* gains,
+                   size_t first_bin,
+                   size_t last_bin,
+                   std::complex<float>* output) {
+  for (size_t bin = first_bin; bin < last_bin; bin += 4) {
+    __m128 real = _mm_setzero_ps();
+    __m128 imag = _mm_setzero_ps();
+    for (int c = 0; c < kNumChannels; ++c) {
+      __m128 x;
+      __m128 y;
+      LoadBins(input[c], bin, &x, &y);
+      const __m128 mask_real = Load(masks.real(0, c), bin);
+      const __m128 mask_imag = Load(masks.imag(0, c), bin);
+      real = _mm_sub_ps(MultiplyAdd(real, x, mask_real),
+                        _mm_mul_ps(y, mask_imag));
+      imag = MultiplyAdd(MultiplyAdd(imag, x, mask_imag), y, mask_real);
+    }
+    const __m128 gain = Load(gains, bin);
+    real = _mm_mul_ps(real, gain);
+    imag = _mm_mul_ps(imag, gain);
+    float* values = reinterpret_cast<float*>(&output[bin]);
+    _mm_storeu_ps(values, _mm_unpacklo_ps(real, imag));
+    _mm_storeu_ps(values + 4, _mm_unpackhi_ps(real, imag));
+  }
+}
+
+}  // namespace
+
+void ComputePostfilterNorms_SSE2(const BinnedComplexMatrices& target_cov_mats,
+                                 const BinnedComplexMatrices& interf_cov_mats,
+                                 const BinnedComplexMatrices& delay_sum_masks,
+                                 const std::complex<float>* const* input,
+                                 size_t first_bin,
+                                 size_t last_bin,
+                                 float* rxims,
+                                 float* rpsims,
+                                 float* reflected_rpsims,
+                                 float* rmws) {
+  typedef void (*Kernel)(const BinnedComplexMatrices&,
+                         const BinnedComplexMatrices&,
+                         const BinnedComplexMatrices&,
+                         const std::complex<float>* const*, size_t, size_t,
+                         float*, float*, float*, float*);
+  static const Kernel kKernels[kMaxSpecializedChannels] = {
+      ComputePostfilterNorms<1>, ComputePostfilterNorms<2>,
+      ComputePostfilterNorms<3>, ComputePostfilterNorms<4>,
+      ComputePostfilterNorms<5>, ComputePostfilterNorms<6>,
+      ComputePostfilterNorms<7>, ComputePostfilterNorms<8>};
+  const int num_channels = delay_sum_masks.num_columns();
+  DCHECK_GE(num_channels, 1);
+  DCHECK_LE(num_channels, kMaxSpecializedChannels);
+  DCHECK_EQ(0u, (last_bin - first_bin) % 4);
+  kKernels[num_channels - 1](target_cov_mats, interf_cov_mats,
+                             delay_sum_masks, input, first_bin, last_bin,
+                             rxims, rpsims, reflected_rpsims, rmws);
+}
+
+void ApplyBinMasks_SSE2(const BinnedComplexMatrices& masks,
+                        const std::complex<float>* const* input,
+                        const float* gains,
+                        size_t first_bin,
+                        size_t last_bin,
+                        std::complex<float>* output) {
+  typedef void (*Kernel)(const BinnedComplexMatrices&,
+                         const std::complex<float>* const*, const float*,
+                         size_t, size_t, std::complex<float>*);
+  static const Kernel kKernels[kMaxSpecializedChannels] = {
+      ApplyBinMasks<1>, ApplyBinMasks<2>, ApplyBinMasks<3>, ApplyBinMasks<4>,
+      ApplyBinMasks<5>, ApplyBinMasks<6>, ApplyBinMasks<7>, ApplyBinMasks<8>};
+  const int num_channels = masks.num_columns();
+  DCHECK_GE(num_channels, 1);
+  DCHECK_LE(num_channels, kMaxSpecializedChannels);
+  DCHECK_EQ(0u, (last_bin - first_bin) % 4);
+  kKernels[num_channels - 1](masks, input, gains, first_bin, last_bin,
+                             output);
+}
+
+}  // namespace webrtc
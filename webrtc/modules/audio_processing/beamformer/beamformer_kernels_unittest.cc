@@ -0,0 +1,280 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+const size_t kNumFreqBins = 129;
+const float kTolerance = 1e-4f;
+
+float Random(uint32_t* seed) {
+  *seed = *seed * 1664525 + 1013904223;
+  return static_cast<float>(*seed >> 8) / (1 << 23) - 1.f;
+}
+
+void FillRandom(uint32_t* seed, ComplexMatrix<float>* mat) {
+  complex<float>* const* elements = mat->elements();
+  for (int i = 0; i < mat->num_rows(); ++i) {
+    for (int j = 0; j < mat->num_columns(); ++j) {
+      elements[i][j] = complex<float>(Random(seed), Random(seed));
+    }
+  }
+}
+
+// The computations of NonlinearBeamformer::ProcessAudioBlock() before they
+// were moved to the kernels, one bin at a time with ComplexMatrix.
+float ReferenceNorm(const ComplexMatrix<float>& mat,
+                    const ComplexMatrix<float>& norm_mat) {
+  complex<float> first_product = complex<float>(0.f, 0.f);
+  complex<float> second_product = complex<float>(0.f, 0.f);
+  const complex<float>* const* mat_els = mat.elements();
+  const complex<float>* const* norm_mat_els = norm_mat.elements();
+  for (int i = 0; i < norm_mat.num_columns(); ++i) {
+    for (int j = 0; j < norm_mat.num_columns(); ++j) {
+      first_product += conj(norm_mat_els[0][j]) * mat_els[j][i];
+    }
+    second_product += first_product * norm_mat_els[0][i];
+    first_product = 0.f;
+  }
+  return std::max(second_product.real(), 0.f);
+}
+
+class ReferenceBins {
+ public:
+  ReferenceBins(int num_channels, size_t num_bins, uint32_t seed)
+      : num_channels_(num_channels), eig_m_(1, num_channels) {
+    for (size_t i = 0; i < num_bins; ++i) {
+      target_cov_mats_.push_back(
+          new ComplexMatrix<float>(num_channels, num_channels));
+      interf_cov_mats_.push_back(
+          new ComplexMatrix<float>(num_channels, num_channels));
+      reflected_interf_cov_mats_.push_back(new ComplexMatrix<float>());
+      delay_sum_masks_.push_back(new ComplexMatrix<float>(1, num_channels));
+      FillRandom(&seed, target_cov_mats_[i]);
+      FillRandom(&seed, interf_cov_mats_[i]);
+      FillRandom(&seed, delay_sum_masks_[i]);
+      reflected_interf_cov_mats_[i]->PointwiseConjugate(*interf_cov_mats_[i]);
+    }
+  }
+
+  void CopyTo(BinnedComplexMatrices* target_cov_mats,
+              BinnedComplexMatrices* interf_cov_mats,
+              BinnedComplexMatrices* delay_sum_masks) const {
+    for (size_t i = 0; i < target_cov_mats_.size(); ++i) {
+      target_cov_mats->Set(i, *target_cov_mats_[i]);
+      interf_cov_mats->Set(i, *interf_cov_mats_[i]);
+      delay_sum_masks->Set(i, *delay_sum_masks_[i]);
+    }
+  }
+
+  void ComputeNorms(const complex<float>* const* input,
+                    size_t bin,
+                    float* rxim,
+                    float* rpsim,
+                    float* reflected_rpsim,
+                    float* rmw) {
+    eig_m_.CopyFromColumn(input, bin, num_channels_);
+    float sum_squares = 0.f;
+    for (int c = 0; c < num_channels_; ++c) {
+      const float abs_value = std::abs(eig_m_.elements()[0][c]);
+      sum_squares += abs_value * abs_value;
+    }
+    const float norm_factor = std::sqrt(sum_squares);
+    if (norm_factor != 0.f) {
+      eig_m_.Scale(1.f / norm_factor);
+    }
+    *rxim = ReferenceNorm(*target_cov_mats_[bin], eig_m_);
+    *rpsim = ReferenceNorm(*interf_cov_mats_[bin], eig_m_);
+    *reflected_rpsim = ReferenceNorm(*reflected_interf_cov_mats_[bin], eig_m_);
+    complex<float> product(0.f, 0.f);
+    for (int c = 0; c < num_channels_; ++c) {
+      product += conj(delay_sum_masks_[bin]->elements()[0][c]) *
+                 eig_m_.elements()[0][c];
+    }
+    *rmw = std::norm(product);
+  }
+
+  complex<float> ApplyMask(const complex<float>* const* input,
+                           size_t bin,
+                           float gain) const {
+    complex<float> output(0.f, 0.f);
+    for (int c = 0; c < num_channels_; ++c) {
+      output += input[c][bin] * delay_sum_masks_[bin]->elements()[0][c];
+    }
+    return output * gain;
+  }
+
+ private:
+  const int num_channels_;
+  ScopedVector<ComplexMatrix<float> > target_cov_mats_;
+  ScopedVector<ComplexMatrix<float> > interf_cov_mats_;
+  ScopedVector<ComplexMatrix<float> > reflected_interf_cov_mats_;
+  ScopedVector<ComplexMatrix<float> > delay_sum_masks_;
+  ComplexMatrix<float> eig_m_;
+};
+
+// |num_channels| channels of |kNumFreqBins| random bins. Bin 5 is silent.
+class RandomInput {
+ public:
+  RandomInput(int num_channels, uint32_t seed)
+      : data_(num_channels * kNumFreqBins), channels_(num_channels) {
+    for (int c = 0; c < num_channels; ++c) {
+      channels_[c] = &data_[c * kNumFreqBins];
+      for (size_t i = 0; i < kNumFreqBins; ++i) {
+        channels_[c][i] = i == 5 ? complex<float>(0.f, 0.f)
+                                 : complex<float>(Random(&seed) * 1000.f,
+                                                  Random(&seed) * 1000.f);
+      }
+    }
+  }
+
+  const complex<float>* const* channels() const { return &channels_[0]; }
+
+ private:
+  std::vector<complex<float> > data_;
+  std::vector<complex<float>*> channels_;
+};
+
+}  // namespace
+
+// Covers every specialized array size and one using the generic kernels, with
+// bin ranges which do and do not split into whole groups of 4 bins.
+TEST(BeamformerKernelsTest, ComputePostfilterNormsMatchesReference) {
+  for (int num_channels = 1; num_channels <= kMaxSpecializedChannels + 1;
+       ++num_channels) {
+    SCOPED_TRACE(num_channels);
+    ReferenceBins reference(num_channels, kNumFreqBins, num_channels);
+    BinnedComplexMatrices target_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices interf_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices delay_sum_masks(1, num_channels, kNumFreqBins);
+    reference.CopyTo(&target_cov_mats, &interf_cov_mats, &delay_sum_masks);
+    const RandomInput input(num_channels, 100 + num_channels);
+
+    const size_t kRanges[][2] = {{0, kNumFreqBins}, {3, 82}, {5, 9}, {7, 8}};
+    for (const auto& range : kRanges) {
+      std::vector<float> rxims(kNumFreqBins, -1.f);
+      std::vector<float> rpsims(kNumFreqBins, -1.f);
+      std::vector<float> reflected_rpsims(kNumFreqBins, -1.f);
+      std::vector<float> rmws(kNumFreqBins, -1.f);
+      ComputePostfilterNorms(target_cov_mats, interf_cov_mats, delay_sum_masks,
+                             input.channels(), range[0], range[1], &rxims[0],
+                             &rpsims[0], &reflected_rpsims[0], &rmws[0]);
+      for (size_t i = 0; i < kNumFreqBins; ++i) {
+        if (i < range[0] || i >= range[1]) {
+          // Bins outside the range are left untouched.
+          ASSERT_EQ(-1.f, rxims[i]);
+          ASSERT_EQ(-1.f, rmws[i]);
+          continue;
+        }
+        float rxim, rpsim, reflected_rpsim, rmw;
+        reference.ComputeNorms(input.channels(), i, &rxim, &rpsim,
+                               &reflected_rpsim, &rmw);
+        ASSERT_NEAR(rxim, rxims[i], kTolerance) << "bin " << i;
+        ASSERT_NEAR(rpsim, rpsims[i], kTolerance) << "bin " << i;
+        ASSERT_NEAR(reflected_rpsim, reflected_rpsims[i], kTolerance)
+            << "bin " << i;
+        ASSERT_NEAR(rmw, rmws[i], kTolerance) << "bin " << i;
+      }
+    }
+  }
+}
+
+TEST(BeamformerKernelsTest, ApplyBinMasksMatchesReference) {
+  for (int num_channels = 1; num_channels <= kMaxSpecializedChannels + 1;
+       ++num_channels) {
+    SCOPED_TRACE(num_channels);
+    ReferenceBins reference(num_channels, kNumFreqBins, num_channels);
+    BinnedComplexMatrices target_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices interf_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices masks(1, num_channels, kNumFreqBins);
+    reference.CopyTo(&target_cov_mats, &interf_cov_mats, &masks);
+    const RandomInput input(num_channels, 200 + num_channels);
+    std::vector<float> gains(kNumFreqBins);
+    for (size_t i = 0; i < kNumFreqBins; ++i) {
+      gains[i] = 0.01f + static_cast<float>(i) / kNumFreqBins;
+    }
+
+    std::vector<complex<float> > output(kNumFreqBins);
+    ApplyBinMasks(masks, input.channels(), &gains[0], &output[0]);
+    for (size_t i = 0; i < kNumFreqBins; ++i) {
+      const complex<float> expected =
+          reference.ApplyMask(input.channels(), i, gains[i]);
+      // The input is scaled by 1000.
+      ASSERT_NEAR(expected.real(), output[i].real(), 1000.f * kTolerance)
+          << "bin " << i;
+      ASSERT_NEAR(expected.imag(), output[i].imag(), 1000.f * kTolerance)
+          << "bin " << i;
+    }
+  }
+}
+
+// Prints the cost of the per-bin linear algebra of one block, the way the
+// NonlinearBeamformer did it with ComplexMatrix and with the kernels.
+TEST(BeamformerKernelsTest, DISABLED_Benchmark) {
+  const int kNumIterations = 2000;
+  const int kNumChannels[] = {2, 4, 8};
+  for (int num_channels : kNumChannels) {
+    ReferenceBins reference(num_channels, kNumFreqBins, 1);
+    BinnedComplexMatrices target_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices interf_cov_mats(num_channels, num_channels,
+                                          kNumFreqBins);
+    BinnedComplexMatrices delay_sum_masks(1, num_channels, kNumFreqBins);
+    reference.CopyTo(&target_cov_mats, &interf_cov_mats, &delay_sum_masks);
+    const RandomInput input(num_channels, 2);
+    std::vector<float> rxims(kNumFreqBins);
+    std::vector<float> rpsims(kNumFreqBins);
+    std::vector<float> reflected_rpsims(kNumFreqBins);
+    std::vector<float> rmws(kNumFreqBins);
+    std::vector<float> gains(kNumFreqBins, 0.5f);
+    std::vector<complex<float> > output(kNumFreqBins);
+
+    TickTime start = TickTime::Now();
+    for (int n = 0; n < kNumIterations; ++n) {
+      for (size_t i = 0; i < kNumFreqBins; ++i) {
+        reference.ComputeNorms(input.channels(), i, &rxims[i], &rpsims[i],
+                               &reflected_rpsims[i], &rmws[i]);
+        output[i] = reference.ApplyMask(input.channels(), i, gains[i]);
+      }
+    }
+    const int64_t reference_us = (TickTime::Now() - start).Microseconds();
+
+    start = TickTime::Now();
+    for (int n = 0; n < kNumIterations; ++n) {
+      ComputePostfilterNorms(target_cov_mats, interf_cov_mats, delay_sum_masks,
+                             input.channels(), 0, kNumFreqBins, &rxims[0],
+                             &rpsims[0], &reflected_rpsims[0], &rmws[0]);
+      ApplyBinMasks(delay_sum_masks, input.channels(), &gains[0], &output[0]);
+    }
+    const int64_t kernels_us = (TickTime::Now() - start).Microseconds();
+
+    printf("%d channels: reference %.2f us, kernels %.2f us per block "
+           "(%.2fx)\n",
+           num_channels, static_cast<double>(reference_us) / kNumIterations,
+           static_cast<double>(kernels_us) / kNumIterations,
+           static_cast<double>(reference_us) / kernels_us);
+  }
+}
+
+}  // namespace webrtc
@@ -135,19 +135,6 @@ float SumAbs(const ComplexMatrix<float>& mat) {
   return sum_abs;
 }
 
-// Calculates the sum of squares of a complex matrix.
-float SumSquares(const ComplexMatrix<float>& mat) {
-  float sum_squares = 0.f;
-  const complex<float>* const* mat_els = mat.elements();
-  for (int i = 0; i < mat.num_rows(); ++i) {
-    for (int j = 0; j < mat.num_columns(); ++j) {
-      float abs_value = std::abs(mat_els[i][j]);
-      sum_squares += abs_value * abs_value;
-    }
-  }
-  return sum_squares;
-}
-
 // Does |out| = |in|.' * conj(|in|) for row vector |in|.
 void TransposedConjugatedProduct(const ComplexMatrix<float>& in,
                                  ComplexMatrix<float>* out) {
@@ -185,7 +172,14 @@ const size_t NonlinearBeamformer::kNumFreqBins;
 NonlinearBeamformer::NonlinearBeamformer(
     const std::vector<Point>& array_geometry)
   : num_input_channels_(array_geometry.size()),
-      array_geometry_(GetCenteredArray(array_geometry)) {
+      array_geometry_(GetCenteredArray(array_geometry)),
+      binned_target_cov_mats_(num_input_channels_, num_input_channels_,
+                              kNumFreqBins),
+      binned_interf_cov_mats_(num_input_channels_, num_input_channels_,
+                              kNumFreqBins),
+      binned_delay_sum_masks_(1, num_input_channels_, kNumFreqBins),
+      binned_normalized_delay_sum_masks_(1, num_input_channels_,
+                                         kNumFreqBins) {
   WindowGenerator::KaiserBesselDerived(kKbdAlpha, kFftSize, window_);
 }
 
@@ -246,6 +240,10 @@ void NonlinearBeamformer::Initialize(int chunk_size_ms, int sample_rate_hz) {
     rpsiws_[i] = Norm(interf_cov_mats_[i], delay_sum_masks_[i]);
     reflected_rpsiws_[i] =
         Norm(reflected_interf_cov_mats_[i], delay_sum_masks_[i]);
+    binned_target_cov_mats_.Set(i, target_cov_mats_[i]);
+    binned_interf_cov_mats_.Set(i, interf_cov_mats_[i]);
+    binned_delay_sum_masks_.Set(i, delay_sum_masks_[i]);
+    binned_normalized_delay_sum_masks_.Set(i, normalized_delay_sum_masks_[i]);
   }
 }
 
@@ -358,31 +356,32 @@ void NonlinearBeamformer::ProcessAudioBlock(const complex_f* const* input,
 
   // Calculating the post-filter masks. Note that we need two for each
   // frequency bin to account for the positive and negative interferer
-  // angle.
+  // angle. The quadratic forms of the normalized input with the covariance
+  // matrices are computed for all bins at once.
+  ComputePostfilterNorms(binned_target_cov_mats_,
+                         binned_interf_cov_mats_,
+                         binned_delay_sum_masks_,
+                         input,
+                         low_mean_start_bin_,
+                         high_mean_end_bin_ + 1,
+                         rxims_,
+                         rpsims_,
+                         reflected_rpsims_,
+                         rmws_);
   for (size_t i = low_mean_start_bin_; i <= high_mean_end_bin_; ++i) {
-    eig_m_.CopyFromColumn(input, i, num_input_channels_);
-    float eig_m_norm_factor = std::sqrt(SumSquares(eig_m_));
-    if (eig_m_norm_factor != 0.f) {
-      eig_m_.Scale(1.f / eig_m_norm_factor);
-    }
-
-    float rxim = Norm(target_cov_mats_[i], eig_m_);
     float ratio_rxiw_rxim = 0.f;
-    if (rxim > 0.f) {
-      ratio_rxiw_rxim = rxiws_[i] / rxim;
+    if (rxims_[i] > 0.f) {
+      ratio_rxiw_rxim = rxiws_[i] / rxims_[i];
     }
+    float rmw_r = rmws_[i];
 
-    complex_f rmw = abs(ConjugateDotProduct(delay_sum_masks_[i], eig_m_));
-    rmw *= rmw;
-    float rmw_r = rmw.real();
-
-    new_mask_[i] = CalculatePostfilterMask(interf_cov_mats_[i],
+    new_mask_[i] = CalculatePostfilterMask(rpsims_[i],
                                            rpsiws_[i],
                                            ratio_rxiw_rxim,
                                            rmw_r,
                                            mask_thresholds_[i]);
 
-    new_mask_[i] *= CalculatePostfilterMask(reflected_interf_cov_mats_[i],
+    new_mask_[i] *= CalculatePostfilterMask(reflected_rpsims_[i],
                                             reflected_rpsiws_[i],
                                             ratio_rxiw_rxim,
                                             rmw_r,
@@ -397,14 +396,11 @@ void NonlinearBeamformer::ProcessAudioBlock(const complex_f* const* input,
   ApplyMasks(input, output);
 }
 
-float NonlinearBeamformer::CalculatePostfilterMask(
-    const ComplexMatrixF& interf_cov_mat,
-    float rpsiw,
-    float ratio_rxiw_rxim,
-    float rmw_r,
-    float mask_threshold) {
-  float rpsim = Norm(interf_cov_mat, eig_m_);
-
+float NonlinearBeamformer::CalculatePostfilterMask(float rpsim,
+                                                   float rpsiw,
+                                                   float ratio_rxiw_rxim,
+                                                   float rmw_r,
+                                                   float mask_threshold) {
   // Find lambda.
   float ratio = 0.f;
   if (rpsim > 0.f) {
@@ -423,18 +419,8 @@ float NonlinearBeamformer::CalculatePostfilterMask(
 
 void NonlinearBeamformer::ApplyMasks(const complex_f* const* input,
                                      complex_f* const* output) {
-  complex_f* output_channel = output[0];
-  for (size_t f_ix = 0; f_ix < kNumFreqBins; ++f_ix) {
-    output_channel[f_ix] = complex_f(0.f, 0.f);
-
-    const complex_f* delay_sum_mask_els =
-        normalized_delay_sum_masks_[f_ix].elements()[0];
-    for (int c_ix = 0; c_ix < num_input_channels_; ++c_ix) {
-      output_channel[f_ix] += input[c_ix][f_ix] * delay_sum_mask_els[c_ix];
-    }
-
-    output_channel[f_ix] *= final_mask_[f_ix];
-  }
+  ApplyBinMasks(binned_normalized_delay_sum_masks_, input, final_mask_,
+                output[0]);
 }
 
 // Smooth new_mask_ into time_smooth_mask_.
@@ -16,6 +16,7 @@
 #include "webrtc/common_audio/lapped_transform.h"
 #include "webrtc/common_audio/channel_buffer.h"
 #include "webrtc/modules/audio_processing/beamformer/beamformer.h"
+#include "webrtc/modules/audio_processing/beamformer/beamformer_kernels.h"
 #include "webrtc/modules/audio_processing/beamformer/complex_matrix.h"
 
 namespace webrtc {
@@ -77,7 +78,7 @@ class NonlinearBeamformer
   // when applied, minimize the mean-square error of our estimation of the
   // desired signal. A sub-task is to calculate lambda, which is solved via
   // equation 13.
-  float CalculatePostfilterMask(const ComplexMatrixF& interf_cov_mat,
+  float CalculatePostfilterMask(float rpsim,
                                 float rpsiw,
                                 float ratio_rxiw_rxim,
                                 float rmxi_r,
@@ -156,9 +157,18 @@ class NonlinearBeamformer
   float rxiws_[kNumFreqBins];
   float rpsiws_[kNumFreqBins];
   float reflected_rpsiws_[kNumFreqBins];
-
-  // The microphone normalization factor.
-  ComplexMatrixF eig_m_;
+  float rxims_[kNumFreqBins];
+  float rpsims_[kNumFreqBins];
+  float reflected_rpsims_[kNumFreqBins];
+  float rmws_[kNumFreqBins];
+
+  // Copies of |target_cov_mats_|, |interf_cov_mats_|, |delay_sum_masks_| and
+  // |normalized_delay_sum_masks_| laid out for the kernels, which process
+  // several bins at a time.
+  BinnedComplexMatrices binned_target_cov_mats_;
+  BinnedComplexMatrices binned_interf_cov_mats_;
+  BinnedComplexMatrices binned_delay_sum_masks_;
+  BinnedComplexMatrices binned_normalized_delay_sum_masks_;
 
   // For processing the high-frequency input signal.
   float high_pass_postfilter_mask_;
@@ -17,6 +17,13 @@
 
 namespace webrtc {
 
+// The largest number of samples per band and channel in a 10 ms chunk.
+static const size_t kMaxNumFramesPerBand = 160;
+
+// The number of 10 ms render chunks which may be queued by the render side of
+// a component before the capture side has to catch up.
+static const size_t kMaxNumQueuedRenderFrames = 100;
+
 static inline int ChannelsFromLayout(AudioProcessing::ChannelLayout layout) {
   switch (layout) {
     case AudioProcessing::kMono:
@@ -18,6 +18,7 @@ extern "C" {
 }
 #include "webrtc/modules/audio_processing/aec/include/echo_cancellation.h"
 #include "webrtc/modules/audio_processing/audio_buffer.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
 namespace webrtc {
@@ -56,10 +57,12 @@ AudioProcessing::Error MapError(int err) {
 }  // namespace
 
 EchoCancellationImpl::EchoCancellationImpl(const AudioProcessing* apm,
-                                           CriticalSectionWrapper* crit)
+                                           CriticalSectionWrapper* crit_render,
+                                           CriticalSectionWrapper* crit_capture)
     : ProcessingComponent(),
       apm_(apm),
-      crit_(crit),
+      crit_render_(crit_render),
+      crit_capture_(crit_capture),
       drift_compensation_enabled_(false),
       metrics_enabled_(false),
       suppression_level_(kModerateSuppression),
@@ -68,7 +71,8 @@ EchoCancellationImpl::EchoCancellationImpl(const AudioProcessing* apm,
       stream_has_echo_(false),
       delay_logging_enabled_(false),
       extended_filter_enabled_(false),
-      delay_agnostic_enabled_(false) {
+      delay_agnostic_enabled_(false),
+      render_queue_element_max_size_(0) {
 }
 
 EchoCancellationImpl::~EchoCancellationImpl() {}
@@ -78,26 +82,60 @@ int EchoCancellationImpl::ProcessRenderAudio(const AudioBuffer* audio) {
     return apm_->kNoError;
   }
 
-  assert(audio->num_frames_per_band() <= 160);
+  assert(audio->num_frames_per_band() <= kMaxNumFramesPerBand);
   assert(audio->num_channels() == apm_->num_reverse_channels());
 
-  int err = apm_->kNoError;
+  // Only the lower band of each reverse channel is needed; the AEC instances
+  // for the different capture channels share it.
+  render_queue_buffer_.clear();
+  for (int j = 0; j < audio->num_channels(); j++) {
+    const float* farend = audio->split_bands_const_f(j)[kBand0To8kHz];
+    render_queue_buffer_.insert(render_queue_buffer_.end(), farend,
+                                farend + audio->num_frames_per_band());
+  }
 
-  // The ordering convention must be followed to pass to the correct AEC.
-  size_t handle_index = 0;
-  for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
-      Handle* my_handle = static_cast<Handle*>(handle(handle_index));
-      err = WebRtcAec_BufferFarend(
-          my_handle,
-          audio->split_bands_const_f(j)[kBand0To8kHz],
-          audio->num_frames_per_band());
+  if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+    // The capture side has fallen behind. Drain the queue on its behalf; this
+    // is the only place where the render side waits for the capture side.
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    int err = ReadQueuedRenderData();
+    if (err != apm_->kNoError) {
+      return err;
+    }
+    if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+      assert(false);
+      return apm_->kUnspecifiedError;
+    }
+  }
 
-      if (err != apm_->kNoError) {
-        return GetHandleError(my_handle);  // TODO(ajm): warning possible?
-      }
+  return apm_->kNoError;
+}
 
-      handle_index++;
+int EchoCancellationImpl::ReadQueuedRenderData() {
+  if (!is_component_enabled()) {
+    return apm_->kNoError;
+  }
+
+  while (render_signal_queue_->Remove(&capture_queue_buffer_)) {
+    const size_t num_frames_per_band =
+        capture_queue_buffer_.size() / apm_->num_reverse_channels();
+
+    // The ordering convention must be followed to pass to the correct AEC.
+    size_t handle_index = 0;
+    for (int i = 0; i < apm_->num_output_channels(); i++) {
+      for (int j = 0; j < apm_->num_reverse_channels(); j++) {
+        Handle* my_handle = static_cast<Handle*>(handle(handle_index));
+        int err = WebRtcAec_BufferFarend(
+            my_handle,
+            &capture_queue_buffer_[j * num_frames_per_band],
+            num_frames_per_band);
+
+        if (err != apm_->kNoError) {
+          return GetHandleError(my_handle);  // TODO(ajm): warning possible?
+        }
+
+        handle_index++;
+      }
     }
   }
 
@@ -164,7 +202,9 @@ int EchoCancellationImpl::ProcessCaptureAudio(AudioBuffer* audio) {
 }
 
 int EchoCancellationImpl::Enable(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  // Enabling (re)creates the render queue, so both sides must be idle.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   // Ensure AEC and AECM are not both enabled.
   if (enable && apm_->echo_control_mobile()->is_enabled()) {
     return apm_->kBadParameterError;
@@ -178,7 +218,7 @@ bool EchoCancellationImpl::is_enabled() const {
 }
 
 int EchoCancellationImpl::set_suppression_level(SuppressionLevel level) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (MapSetting(level) == -1) {
     return apm_->kBadParameterError;
   }
@@ -193,7 +233,7 @@ EchoCancellation::SuppressionLevel EchoCancellationImpl::suppression_level()
 }
 
 int EchoCancellationImpl::enable_drift_compensation(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   drift_compensation_enabled_ = enable;
   return Configure();
 }
@@ -212,7 +252,7 @@ int EchoCancellationImpl::stream_drift_samples() const {
 }
 
 int EchoCancellationImpl::enable_metrics(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   metrics_enabled_ = enable;
   return Configure();
 }
@@ -224,7 +264,7 @@ bool EchoCancellationImpl::are_metrics_enabled() const {
 // TODO(ajm): we currently just use the metrics from the first AEC. Think more
 //            aboue the best way to extend this to multi-channel.
 int EchoCancellationImpl::GetMetrics(Metrics* metrics) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (metrics == NULL) {
     return apm_->kNullPointerError;
   }
@@ -271,7 +311,7 @@ bool EchoCancellationImpl::stream_has_echo() const {
 }
 
 int EchoCancellationImpl::enable_delay_logging(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   delay_logging_enabled_ = enable;
   return Configure();
 }
@@ -288,7 +328,7 @@ int EchoCancellationImpl::GetDelayMetrics(int* median, int* std) {
 
 int EchoCancellationImpl::GetDelayMetrics(int* median, int* std,
                                           float* fraction_poor_delays) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (median == NULL) {
     return apm_->kNullPointerError;
   }
@@ -310,7 +350,7 @@ int EchoCancellationImpl::GetDelayMetrics(int* median, int* std,
 }
 
 struct AecCore* EchoCancellationImpl::aec_core() const {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (!is_component_enabled()) {
     return NULL;
   }
@@ -320,11 +360,34 @@ struct AecCore* EchoCancellationImpl::aec_core() const {
 
 int EchoCancellationImpl::Initialize() {
   int err = ProcessingComponent::Initialize();
-  if (err != apm_->kNoError || !is_component_enabled()) {
+  if (!is_component_enabled()) {
     return err;
   }
 
-  return apm_->kNoError;
+  // The render side relies on the queue whenever the component is enabled,
+  // even if the AEC instances failed to initialize.
+  AllocateRenderQueue();
+
+  return err;
+}
+
+void EchoCancellationImpl::AllocateRenderQueue() {
+  const size_t new_render_queue_element_max_size =
+      kMaxNumFramesPerBand * apm_->num_reverse_channels();
+
+  // Reallocate the queue only if the elements would otherwise need to grow.
+  // Any data still in the queue belongs to the AEC state being reset.
+  if (!render_signal_queue_.get() ||
+      new_render_queue_element_max_size > render_queue_element_max_size_) {
+    render_queue_element_max_size_ = new_render_queue_element_max_size;
+    std::vector<float> template_queue_element(render_queue_element_max_size_);
+    render_signal_queue_.reset(new rtc::SwapQueue<std::vector<float>>(
+        kMaxNumQueuedRenderFrames, template_queue_element));
+    render_queue_buffer_.resize(render_queue_element_max_size_);
+    capture_queue_buffer_.resize(render_queue_element_max_size_);
+  } else {
+    render_signal_queue_->Clear();
+  }
 }
 
 void EchoCancellationImpl::SetExtraOptions(const Config& config) {
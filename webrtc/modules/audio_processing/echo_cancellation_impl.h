@@ -11,6 +11,10 @@
 #ifndef WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CANCELLATION_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CANCELLATION_IMPL_H_
 
+#include <vector>
+
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/swap_queue.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
 
@@ -23,10 +27,17 @@ class EchoCancellationImpl : public EchoCancellation,
                              public ProcessingComponent {
  public:
   EchoCancellationImpl(const AudioProcessing* apm,
-                       CriticalSectionWrapper* crit);
+                       CriticalSectionWrapper* crit_render,
+                       CriticalSectionWrapper* crit_capture);
   virtual ~EchoCancellationImpl();
 
+  // Queues the far-end signal for the capture side. Called on the render
+  // thread with |crit_render| held.
   int ProcessRenderAudio(const AudioBuffer* audio);
+  // Feeds the far-end signal queued by ProcessRenderAudio() to the AEC
+  // instances. Called on the capture thread with |crit_capture| held, before
+  // ProcessCaptureAudio().
+  int ReadQueuedRenderData();
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoCancellation implementation.
@@ -65,8 +76,11 @@ class EchoCancellationImpl : public EchoCancellation,
   int num_handles_required() const override;
   int GetHandleError(void* handle) const override;
 
+  void AllocateRenderQueue();
+
   const AudioProcessing* apm_;
-  CriticalSectionWrapper* crit_;
+  CriticalSectionWrapper* crit_render_;
+  CriticalSectionWrapper* crit_capture_;
   bool drift_compensation_enabled_;
   bool metrics_enabled_;
   SuppressionLevel suppression_level_;
@@ -76,6 +90,14 @@ class EchoCancellationImpl : public EchoCancellation,
   bool delay_logging_enabled_;
   bool extended_filter_enabled_;
   bool delay_agnostic_enabled_;
+
+  // Lock-free handoff of the far-end signal from the render thread to the
+  // capture thread. Each element holds one 10 ms lower-band chunk per reverse
+  // channel.
+  size_t render_queue_element_max_size_;
+  std::vector<float> render_queue_buffer_;
+  std::vector<float> capture_queue_buffer_;
+  rtc::scoped_ptr<rtc::SwapQueue<std::vector<float>>> render_signal_queue_;
 };
 
 }  // namespace webrtc
@@ -15,6 +15,7 @@
 
 #include "webrtc/modules/audio_processing/aecm/include/echo_control_mobile.h"
 #include "webrtc/modules/audio_processing/audio_buffer.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
@@ -62,14 +63,18 @@ size_t EchoControlMobile::echo_path_size_bytes() {
     return WebRtcAecm_echo_path_size_bytes();
 }
 
-EchoControlMobileImpl::EchoControlMobileImpl(const AudioProcessing* apm,
-                                             CriticalSectionWrapper* crit)
+EchoControlMobileImpl::EchoControlMobileImpl(
+    const AudioProcessing* apm,
+    CriticalSectionWrapper* crit_render,
+    CriticalSectionWrapper* crit_capture)
   : ProcessingComponent(),
     apm_(apm),
-    crit_(crit),
+    crit_render_(crit_render),
+    crit_capture_(crit_capture),
     routing_mode_(kSpeakerphone),
     comfort_noise_enabled_(true),
-    external_echo_path_(NULL) {}
+    external_echo_path_(NULL),
+    render_queue_element_max_size_(0) {}
 
 EchoControlMobileImpl::~EchoControlMobileImpl() {
     if (external_echo_path_ != NULL) {
@@ -83,26 +88,57 @@ int EchoControlMobileImpl::ProcessRenderAudio(const AudioBuffer* audio) {
     return apm_->kNoError;
   }
 
-  assert(audio->num_frames_per_band() <= 160);
+  assert(audio->num_frames_per_band() <= kMaxNumFramesPerBand);
   assert(audio->num_channels() == apm_->num_reverse_channels());
 
-  int err = apm_->kNoError;
+  render_queue_buffer_.clear();
+  for (int j = 0; j < audio->num_channels(); j++) {
+    const int16_t* farend = audio->split_bands_const(j)[kBand0To8kHz];
+    render_queue_buffer_.insert(render_queue_buffer_.end(), farend,
+                                farend + audio->num_frames_per_band());
+  }
 
-  // The ordering convention must be followed to pass to the correct AECM.
-  size_t handle_index = 0;
-  for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
-      Handle* my_handle = static_cast<Handle*>(handle(handle_index));
-      err = WebRtcAecm_BufferFarend(
-          my_handle,
-          audio->split_bands_const(j)[kBand0To8kHz],
-          audio->num_frames_per_band());
+  if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+    // The capture side has fallen behind; drain the queue on its behalf.
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    int err = ReadQueuedRenderData();
+    if (err != apm_->kNoError) {
+      return err;
+    }
+    if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+      assert(false);
+      return apm_->kUnspecifiedError;
+    }
+  }
 
-      if (err != apm_->kNoError) {
-        return GetHandleError(my_handle);  // TODO(ajm): warning possible?
-      }
+  return apm_->kNoError;
+}
 
-      handle_index++;
+int EchoControlMobileImpl::ReadQueuedRenderData() {
+  if (!is_component_enabled()) {
+    return apm_->kNoError;
+  }
+
+  while (render_signal_queue_->Remove(&capture_queue_buffer_)) {
+    const size_t num_frames_per_band =
+        capture_queue_buffer_.size() / apm_->num_reverse_channels();
+
+    // The ordering convention must be followed to pass to the correct AECM.
+    size_t handle_index = 0;
+    for (int i = 0; i < apm_->num_output_channels(); i++) {
+      for (int j = 0; j < apm_->num_reverse_channels(); j++) {
+        Handle* my_handle = static_cast<Handle*>(handle(handle_index));
+        int err = WebRtcAecm_BufferFarend(
+            my_handle,
+            &capture_queue_buffer_[j * num_frames_per_band],
+            num_frames_per_band);
+
+        if (err != apm_->kNoError) {
+          return GetHandleError(my_handle);  // TODO(ajm): warning possible?
+        }
+
+        handle_index++;
+      }
     }
   }
 
@@ -156,7 +192,9 @@ int EchoControlMobileImpl::ProcessCaptureAudio(AudioBuffer* audio) {
 }
 
 int EchoControlMobileImpl::Enable(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  // Enabling (re)creates the render queue, so both sides must be idle.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   // Ensure AEC and AECM are not both enabled.
   if (enable && apm_->echo_cancellation()->is_enabled()) {
     return apm_->kBadParameterError;
@@ -170,7 +208,7 @@ bool EchoControlMobileImpl::is_enabled() const {
 }
 
 int EchoControlMobileImpl::set_routing_mode(RoutingMode mode) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (MapSetting(mode) == -1) {
     return apm_->kBadParameterError;
   }
@@ -185,7 +223,7 @@ EchoControlMobile::RoutingMode EchoControlMobileImpl::routing_mode()
 }
 
 int EchoControlMobileImpl::enable_comfort_noise(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   comfort_noise_enabled_ = enable;
   return Configure();
 }
@@ -196,7 +234,8 @@ bool EchoControlMobileImpl::is_comfort_noise_enabled() const {
 
 int EchoControlMobileImpl::SetEchoPath(const void* echo_path,
                                        size_t size_bytes) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   if (echo_path == NULL) {
     return apm_->kNullPointerError;
   }
@@ -215,7 +254,7 @@ int EchoControlMobileImpl::SetEchoPath(const void* echo_path,
 
 int EchoControlMobileImpl::GetEchoPath(void* echo_path,
                                        size_t size_bytes) const {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (echo_path == NULL) {
     return apm_->kNullPointerError;
   }
@@ -241,6 +280,10 @@ int EchoControlMobileImpl::Initialize() {
     return apm_->kNoError;
   }
 
+  // The render side relies on the queue whenever the component is enabled,
+  // even if the AECM instances fail to initialize.
+  AllocateRenderQueue();
+
   if (apm_->proc_sample_rate_hz() > apm_->kSampleRate16kHz) {
     LOG(LS_ERROR) << "AECM only supports 16 kHz or lower sample rates";
     return apm_->kBadSampleRateError;
@@ -249,6 +292,26 @@ int EchoControlMobileImpl::Initialize() {
   return ProcessingComponent::Initialize();
 }
 
+void EchoControlMobileImpl::AllocateRenderQueue() {
+  const size_t new_render_queue_element_max_size =
+      kMaxNumFramesPerBand * apm_->num_reverse_channels();
+
+  // Reallocate the queue only if the elements would otherwise need to grow.
+  // Any data still in the queue belongs to the AECM state being reset.
+  if (!render_signal_queue_.get() ||
+      new_render_queue_element_max_size > render_queue_element_max_size_) {
+    render_queue_element_max_size_ = new_render_queue_element_max_size;
+    std::vector<int16_t> template_queue_element(
+        render_queue_element_max_size_);
+    render_signal_queue_.reset(new rtc::SwapQueue<std::vector<int16_t>>(
+        kMaxNumQueuedRenderFrames, template_queue_element));
+    render_queue_buffer_.resize(render_queue_element_max_size_);
+    capture_queue_buffer_.resize(render_queue_element_max_size_);
+  } else {
+    render_signal_queue_->Clear();
+  }
+}
+
 void* EchoControlMobileImpl::CreateHandle() const {
   return WebRtcAecm_Create();
 }
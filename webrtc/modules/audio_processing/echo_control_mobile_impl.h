@@ -11,6 +11,10 @@
 #ifndef WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CONTROL_MOBILE_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CONTROL_MOBILE_IMPL_H_
 
+#include <vector>
+
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/swap_queue.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
 
@@ -23,10 +27,17 @@ class EchoControlMobileImpl : public EchoControlMobile,
                               public ProcessingComponent {
  public:
   EchoControlMobileImpl(const AudioProcessing* apm,
-                        CriticalSectionWrapper* crit);
+                        CriticalSectionWrapper* crit_render,
+                        CriticalSectionWrapper* crit_capture);
   virtual ~EchoControlMobileImpl();
 
+  // Queues the far-end signal for the capture side. Called on the render
+  // thread with |crit_render| held.
   int ProcessRenderAudio(const AudioBuffer* audio);
+  // Feeds the far-end signal queued by ProcessRenderAudio() to the AECM
+  // instances. Called on the capture thread with |crit_capture| held, before
+  // ProcessCaptureAudio().
+  int ReadQueuedRenderData();
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoControlMobile implementation.
@@ -53,11 +64,22 @@ class EchoControlMobileImpl : public EchoControlMobile,
   int num_handles_required() const override;
   int GetHandleError(void* handle) const override;
 
+  void AllocateRenderQueue();
+
   const AudioProcessing* apm_;
-  CriticalSectionWrapper* crit_;
+  CriticalSectionWrapper* crit_render_;
+  CriticalSectionWrapper* crit_capture_;
   RoutingMode routing_mode_;
   bool comfort_noise_enabled_;
   unsigned char* external_echo_path_;
+
+  // Lock-free handoff of the far-end signal from the render thread to the
+  // capture thread. Each element holds one 10 ms lower-band chunk per reverse
+  // channel.
+  size_t render_queue_element_max_size_;
+  std::vector<int16_t> render_queue_buffer_;
+  std::vector<int16_t> capture_queue_buffer_;
+  rtc::scoped_ptr<rtc::SwapQueue<std::vector<int16_t>>> render_signal_queue_;
 };
 }  // namespace webrtc
 
@@ -14,6 +14,7 @@
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/agc/legacy/gain_control.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
 namespace webrtc {
@@ -36,10 +37,12 @@ int16_t MapSetting(GainControl::Mode mode) {
 }  // namespace
 
 GainControlImpl::GainControlImpl(const AudioProcessing* apm,
-                                 CriticalSectionWrapper* crit)
+                                 CriticalSectionWrapper* crit_render,
+                                 CriticalSectionWrapper* crit_capture)
   : ProcessingComponent(),
     apm_(apm),
-    crit_(crit),
+    crit_render_(crit_render),
+    crit_capture_(crit_capture),
     mode_(kAdaptiveAnalog),
     minimum_capture_level_(0),
     maximum_capture_level_(255),
@@ -48,7 +51,12 @@ GainControlImpl::GainControlImpl(const AudioProcessing* apm,
     compression_gain_db_(9),
     analog_capture_level_(0),
     was_analog_level_set_(false),
-    stream_is_saturated_(false) {}
+    stream_is_saturated_(false),
+    render_queue_buffer_(kMaxNumFramesPerBand),
+    capture_queue_buffer_(kMaxNumFramesPerBand),
+    render_signal_queue_(new rtc::SwapQueue<std::vector<int16_t>>(
+        kMaxNumQueuedRenderFrames,
+        std::vector<int16_t>(kMaxNumFramesPerBand))) {}
 
 GainControlImpl::~GainControlImpl() {}
 
@@ -57,17 +65,43 @@ int GainControlImpl::ProcessRenderAudio(AudioBuffer* audio) {
     return apm_->kNoError;
   }
 
-  assert(audio->num_frames_per_band() <= 160);
+  assert(audio->num_frames_per_band() <= kMaxNumFramesPerBand);
 
-  for (int i = 0; i < num_handles(); i++) {
-    Handle* my_handle = static_cast<Handle*>(handle(i));
-    int err = WebRtcAgc_AddFarend(
-        my_handle,
-        audio->mixed_low_pass_data(),
-        audio->num_frames_per_band());
+  const int16_t* farend = audio->mixed_low_pass_data();
+  render_queue_buffer_.assign(farend, farend + audio->num_frames_per_band());
 
+  if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+    // The capture side has fallen behind; drain the queue on its behalf.
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    int err = ReadQueuedRenderData();
     if (err != apm_->kNoError) {
-      return GetHandleError(my_handle);
+      return err;
+    }
+    if (!render_signal_queue_->Insert(&render_queue_buffer_)) {
+      assert(false);
+      return apm_->kUnspecifiedError;
+    }
+  }
+
+  return apm_->kNoError;
+}
+
+int GainControlImpl::ReadQueuedRenderData() {
+  if (!is_component_enabled()) {
+    return apm_->kNoError;
+  }
+
+  while (render_signal_queue_->Remove(&capture_queue_buffer_)) {
+    for (int i = 0; i < num_handles(); i++) {
+      Handle* my_handle = static_cast<Handle*>(handle(i));
+      int err = WebRtcAgc_AddFarend(
+          my_handle,
+          &capture_queue_buffer_[0],
+          capture_queue_buffer_.size());
+
+      if (err != apm_->kNoError) {
+        return GetHandleError(my_handle);
+      }
     }
   }
 
@@ -179,7 +213,7 @@ int GainControlImpl::ProcessCaptureAudio(AudioBuffer* audio) {
 
 // TODO(ajm): ensure this is called under kAdaptiveAnalog.
 int GainControlImpl::set_stream_analog_level(int level) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   was_analog_level_set_ = true;
   if (level < minimum_capture_level_ || level > maximum_capture_level_) {
     return apm_->kBadParameterError;
@@ -197,7 +231,9 @@ int GainControlImpl::stream_analog_level() {
 }
 
 int GainControlImpl::Enable(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  // May (re)initialize the component, so both sides must be idle.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   return EnableComponent(enable);
 }
 
@@ -206,7 +242,9 @@ bool GainControlImpl::is_enabled() const {
 }
 
 int GainControlImpl::set_mode(Mode mode) {
-  CriticalSectionScoped crit_scoped(crit_);
+  // May (re)initialize the component, so both sides must be idle.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   if (MapSetting(mode) == -1) {
     return apm_->kBadParameterError;
   }
@@ -221,7 +259,9 @@ GainControl::Mode GainControlImpl::mode() const {
 
 int GainControlImpl::set_analog_level_limits(int minimum,
                                              int maximum) {
-  CriticalSectionScoped crit_scoped(crit_);
+  // May (re)initialize the component, so both sides must be idle.
+  CriticalSectionScoped crit_scoped_render(crit_render_);
+  CriticalSectionScoped crit_scoped_capture(crit_capture_);
   if (minimum < 0) {
     return apm_->kBadParameterError;
   }
@@ -253,7 +293,7 @@ bool GainControlImpl::stream_is_saturated() const {
 }
 
 int GainControlImpl::set_target_level_dbfs(int level) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (level > 31 || level < 0) {
     return apm_->kBadParameterError;
   }
@@ -267,7 +307,7 @@ int GainControlImpl::target_level_dbfs() const {
 }
 
 int GainControlImpl::set_compression_gain_db(int gain) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   if (gain < 0 || gain > 90) {
     return apm_->kBadParameterError;
   }
@@ -281,7 +321,7 @@ int GainControlImpl::compression_gain_db() const {
 }
 
 int GainControlImpl::enable_limiter(bool enable) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   limiter_enabled_ = enable;
   return Configure();
 }
@@ -297,6 +337,8 @@ int GainControlImpl::Initialize() {
   }
 
   capture_levels_.assign(num_handles(), analog_capture_level_);
+  // Any data still in the queue belongs to the AGC state being reset.
+  render_signal_queue_->Clear();
   return apm_->kNoError;
 }
 
@@ -13,6 +13,8 @@
 
 #include <vector>
 
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/swap_queue.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
 
@@ -25,10 +27,17 @@ class GainControlImpl : public GainControl,
                         public ProcessingComponent {
  public:
   GainControlImpl(const AudioProcessing* apm,
-                  CriticalSectionWrapper* crit);
+                  CriticalSectionWrapper* crit_render,
+                  CriticalSectionWrapper* crit_capture);
   virtual ~GainControlImpl();
 
+  // Queues the far-end signal for the capture side. Called on the render
+  // thread with |crit_render| held.
   int ProcessRenderAudio(AudioBuffer* audio);
+  // Feeds the far-end signal queued by ProcessRenderAudio() to the AGC
+  // instances. Called on the capture thread with |crit_capture| held, before
+  // AnalyzeCaptureAudio().
+  int ReadQueuedRenderData();
   int AnalyzeCaptureAudio(AudioBuffer* audio);
   int ProcessCaptureAudio(AudioBuffer* audio);
 
@@ -65,7 +74,8 @@ class GainControlImpl : public GainControl,
   int GetHandleError(void* handle) const override;
 
   const AudioProcessing* apm_;
-  CriticalSectionWrapper* crit_;
+  CriticalSectionWrapper* crit_render_;
+  CriticalSectionWrapper* crit_capture_;
   Mode mode_;
   int minimum_capture_level_;
   int maximum_capture_level_;
@@ -76,6 +86,12 @@ class GainControlImpl : public GainControl,
   int analog_capture_level_;
   bool was_analog_level_set_;
   bool stream_is_saturated_;
+
+  // Lock-free handoff of the far-end signal from the render thread to the
+  // capture thread. Each element holds one 10 ms mixed low-band chunk.
+  std::vector<int16_t> render_queue_buffer_;
+  std::vector<int16_t> capture_queue_buffer_;
+  rtc::scoped_ptr<rtc::SwapQueue<std::vector<int16_t>>> render_signal_queue_;
 };
 }  // namespace webrtc
 
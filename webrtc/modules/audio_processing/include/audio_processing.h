@@ -159,6 +159,11 @@ static const int kAudioProcMaxNativeSampleRateHz = 32000;
 //   2. Parameter getters are never called concurrently with the corresponding
 //      setter.
 //
+// The render side (AnalyzeReverseStream() and ProcessReverseStream()) and the
+// capture side (ProcessStream()) are locked independently and may run
+// concurrently on different threads without blocking each other, except when
+// a format change forces a reinitialization.
+//
 // APM accepts only linear PCM audio data in chunks of 10 ms. The int16
 // interfaces use interleaved data, while the float interfaces use deinterleaved
 // data.
@@ -424,6 +429,35 @@ class AudioProcessing {
   // specific member variables are reset.
   virtual void UpdateHistogramsOnCallEnd() = 0;
 
+  // Counts the memory traffic of the audio buffers holding the signal between
+  // the components, to measure the overhead of the format conversions. Only
+  // the buffers of the current format are covered, since reinitializing
+  // replaces them.
+  struct BufferStatistics {
+    BufferStatistics()
+        : num_arenas(0),
+          arena_bytes(0),
+          num_converted_samples(0),
+          num_copied_samples(0) {}
+
+    // Arenas holding the samples of the audio buffers, and their total size.
+    // Each buffer has one. The channel pointer arrays, resamplers and
+    // splitting filters of the buffers allocate separately and are not
+    // counted.
+    int num_arenas;
+    size_t arena_bytes;
+    // Samples converted between the int16_t and float representations.
+    int64_t num_converted_samples;
+    // Samples copied into and out of the buffers, including the downmixing and
+    // the conversions to the API formats.
+    int64_t num_copied_samples;
+  };
+
+  // Returns kUnsupportedFunctionError if the implementation doesn't count.
+  virtual int GetBufferStatistics(BufferStatistics* stats) const {
+    return kUnsupportedFunctionError;
+  }
+
   // These provide access to the component interfaces and should never return
   // NULL. The pointers will be valid for the lifetime of the APM instance.
   // The memory for these objects is entirely managed internally.
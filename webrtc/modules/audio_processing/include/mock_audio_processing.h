@@ -257,6 +257,8 @@ class MockAudioProcessing : public AudioProcessing {
   MOCK_METHOD0(StopDebugRecording,
       int());
   MOCK_METHOD0(UpdateHistogramsOnCallEnd, void());
+  MOCK_CONST_METHOD1(GetBufferStatistics,
+      int(BufferStatistics* stats));
   virtual MockEchoCancellation* echo_cancellation() const {
     return echo_cancellation_.get();
   }
@@ -18,6 +18,383 @@
 #include "webrtc/modules/audio_processing/ns/include/noise_suppression.h"
 #include "webrtc/modules/audio_processing/ns/ns_core.h"
 #include "webrtc/modules/audio_processing/ns/windows_private.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+WebRtcNsMagnitudeSpectrum WebRtcNs_MagnitudeSpectrum;
+WebRtcNsLog WebRtcNs_Log;
+WebRtcNsExp WebRtcNs_Exp;
+WebRtcNsUpdateQuantile WebRtcNs_UpdateQuantile;
+WebRtcNsComputeSnr WebRtcNs_ComputeSnr;
+WebRtcNsSum WebRtcNs_Sum;
+WebRtcNsCovariance WebRtcNs_Covariance;
+WebRtcNsUpdateLogLrt WebRtcNs_UpdateLogLrt;
+WebRtcNsSpeechProbability WebRtcNs_SpeechProbability;
+WebRtcNsUpdateNoiseEstimate WebRtcNs_UpdateNoiseEstimate;
+WebRtcNsComputeWienerFilter WebRtcNs_ComputeWienerFilter;
+WebRtcNsApplyWienerFilter WebRtcNs_ApplyWienerFilter;
+
+static int bitexact = 0;
+
+void WebRtcNs_SetBitexact(int enable) {
+  bitexact = enable;
+}
+
+static void MagnitudeSpectrum(const float* fft,
+                              size_t num_bins,
+                              float* real,
+                              float* imag,
+                              float* magn) {
+  size_t i = 0;
+
+  if (WebRtcNs_MagnitudeSpectrum) {
+    i = WebRtcNs_MagnitudeSpectrum(fft, num_bins, real, imag, magn);
+  }
+  for (; i < num_bins; ++i) {
+    real[i] = fft[2 * i];
+    imag[i] = fft[2 * i + 1];
+    // Magnitude spectrum.
+    magn[i] = sqrtf(real[i] * real[i] + imag[i] * imag[i]) + 1.f;
+  }
+}
+
+static void Log(const float* in, size_t length, float* out) {
+  size_t i = 0;
+
+  if (WebRtcNs_Log) {
+    i = WebRtcNs_Log(in, length, out);
+  }
+  for (; i < length; i++) {
+    out[i] = (float)log(in[i]);
+  }
+}
+
+static void Exp(const float* in, size_t length, float* out) {
+  size_t i = 0;
+
+  if (WebRtcNs_Exp) {
+    i = WebRtcNs_Exp(in, length, out);
+  }
+  for (; i < length; i++) {
+    out[i] = (float)exp(in[i]);
+  }
+}
+
+static void UpdateQuantile(const float* lmagn,
+                           size_t length,
+                           int counter,
+                           float* lquantile,
+                           float* density) {
+  size_t i = 0;
+  float delta;
+
+  if (WebRtcNs_UpdateQuantile) {
+    i = WebRtcNs_UpdateQuantile(lmagn, length, counter, lquantile, density);
+  }
+  for (; i < length; i++) {
+    // Compute delta.
+    if (density[i] > 1.0) {
+      delta = FACTOR * 1.f / density[i];
+    } else {
+      delta = FACTOR;
+    }
+
+    // Update log quantile estimate.
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / (float)(counter + 1);
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / (float)(counter + 1);
+    }
+
+    // Update density estimate.
+    if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] = ((float)counter * density[i] + 1.f / (2.f * WIDTH)) /
+                   (float)(counter + 1);
+    }
+  }  // End loop over magnitude spectrum.
+}
+
+// Compute prior and post SNR based on quantile noise estimation.
+// Compute DD estimate of prior SNR.
+// Inputs:
+//   * |magn| is the signal magnitude spectrum estimate.
+//   * |noise| is the magnitude noise spectrum estimate.
+// Outputs:
+//   * |snrLocPrior| is the computed prior SNR.
+//   * |snrLocPost| is the computed post SNR.
+static void ComputeSnr(const NoiseSuppressionC* self,
+                       const float* magn,
+                       const float* noise,
+                       float* snrLocPrior,
+                       float* snrLocPost) {
+  size_t i = 0;
+
+  if (WebRtcNs_ComputeSnr) {
+    i = WebRtcNs_ComputeSnr(magn, noise, self->magnPrevAnalyze,
+                            self->noisePrev, self->smooth, self->magnLen,
+                            snrLocPrior, snrLocPost);
+  }
+  for (; i < self->magnLen; i++) {
+    // Previous post SNR.
+    // Previous estimate: based on previous frame with gain filter.
+    float previousEstimateStsa = self->magnPrevAnalyze[i] /
+        (self->noisePrev[i] + 0.0001f) * self->smooth[i];
+    // Post SNR.
+    snrLocPost[i] = 0.f;
+    if (magn[i] > noise[i]) {
+      snrLocPost[i] = magn[i] / (noise[i] + 0.0001f) - 1.f;
+    }
+    // DD estimate is sum of two terms: current estimate and previous estimate.
+    // Directed decision update of snrPrior.
+    snrLocPrior[i] =
+        DD_PR_SNR * previousEstimateStsa + (1.f - DD_PR_SNR) * snrLocPost[i];
+  }  // End of loop over frequencies.
+}
+
+// Compute the variance and covariance quantities of the spectral difference.
+// |magnIn| is the input spectrum.
+// The reference/template spectrum is self->magnAvgPause[i].
+static void SpectralDifferenceStats(const NoiseSuppressionC* self,
+                                    const float* magnIn,
+                                    float* covMagnPauseOut,
+                                    float* varPauseOut,
+                                    float* varMagnOut) {
+  size_t i = 0;
+  float avgPause, avgMagn, covMagnPause, varPause, varMagn;
+
+  avgPause = 0.0;
+  avgMagn = self->sumMagn;
+  // Compute average quantities.
+  if (WebRtcNs_Sum) {
+    i = WebRtcNs_Sum(self->magnAvgPause, self->magnLen, &avgPause);
+  }
+  for (; i < self->magnLen; i++) {
+    // Conservative smooth noise spectrum from pause frames.
+    avgPause += self->magnAvgPause[i];
+  }
+  avgPause /= self->magnLen;
+  avgMagn /= self->magnLen;
+
+  covMagnPause = 0.0;
+  varPause = 0.0;
+  varMagn = 0.0;
+  i = 0;
+  // Compute variance and covariance quantities.
+  if (WebRtcNs_Covariance) {
+    i = WebRtcNs_Covariance(magnIn, avgMagn, self->magnAvgPause, avgPause,
+                            self->magnLen, &covMagnPause, &varPause, &varMagn);
+  }
+  for (; i < self->magnLen; i++) {
+    covMagnPause += (magnIn[i] - avgMagn) * (self->magnAvgPause[i] - avgPause);
+    varPause +=
+        (self->magnAvgPause[i] - avgPause) * (self->magnAvgPause[i] - avgPause);
+    varMagn += (magnIn[i] - avgMagn) * (magnIn[i] - avgMagn);
+  }
+  *covMagnPauseOut = covMagnPause / self->magnLen;
+  *varPauseOut = varPause / self->magnLen;
+  *varMagnOut = varMagn / self->magnLen;
+}
+
+static float UpdateLogLrt(NoiseSuppressionC* self,
+                          const float* snrLocPrior,
+                          const float* snrLocPost) {
+  size_t i = 0;
+  float tmpFloat1, tmpFloat2, besselTmp;
+  float logLrtTimeAvgKsum = 0.0;
+
+  if (WebRtcNs_UpdateLogLrt) {
+    i = WebRtcNs_UpdateLogLrt(snrLocPrior, snrLocPost, self->magnLen,
+                              self->logLrtTimeAvg, &logLrtTimeAvgKsum);
+  }
+  for (; i < self->magnLen; i++) {
+    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
+    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
+    self->logLrtTimeAvg[i] +=
+        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
+    logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
+  }
+  return logLrtTimeAvgKsum;
+}
+
+static void SpeechProbability(const NoiseSuppressionC* self,
+                              float gainPrior,
+                              float* probSpeechFinal) {
+  size_t i = 0;
+  float invLrt;
+
+  if (WebRtcNs_SpeechProbability) {
+    i = WebRtcNs_SpeechProbability(self->logLrtTimeAvg, gainPrior,
+                                   self->magnLen, probSpeechFinal);
+  }
+  for (; i < self->magnLen; i++) {
+    invLrt = (float)exp(-self->logLrtTimeAvg[i]);
+    invLrt = (float)gainPrior * invLrt;
+    probSpeechFinal[i] = 1.f / (1.f + invLrt);
+  }
+}
+
+// Update the noise estimate of bin |i|.
+// Inputs:
+//   * |magn| is the signal magnitude spectrum estimate.
+// Output:
+//   * |noise| is the updated noise magnitude spectrum estimate.
+static void UpdateNoiseEstimateBin(NoiseSuppressionC* self,
+                                   const float* magn,
+                                   size_t i,
+                                   float* noise) {
+  const float probSpeech = self->speechProb[i];
+  const float probNonSpeech = 1.f - probSpeech;
+  // Time-avg parameter for noise update, based on the speech/noise state of
+  // the previous bin.
+  float gammaNoiseTmp =
+      i > 0 && self->speechProb[i - 1] > PROB_RANGE ? SPEECH_UPDATE
+                                                    : NOISE_UPDATE;
+  float gammaNoiseOld;
+  float noiseUpdateTmp;
+
+  // Temporary noise update:
+  // Use it for speech frames if update value is less than previous.
+  noiseUpdateTmp = gammaNoiseTmp * self->noisePrev[i] +
+                   (1.f - gammaNoiseTmp) * (probNonSpeech * magn[i] +
+                                            probSpeech * self->noisePrev[i]);
+  // Time-constant based on speech/noise state.
+  gammaNoiseOld = gammaNoiseTmp;
+  gammaNoiseTmp = NOISE_UPDATE;
+  // Increase gamma (i.e., less noise update) for frame likely to be speech.
+  if (probSpeech > PROB_RANGE) {
+    gammaNoiseTmp = SPEECH_UPDATE;
+  }
+  // Conservative noise update.
+  if (probSpeech < PROB_RANGE) {
+    self->magnAvgPause[i] += GAMMA_PAUSE * (magn[i] - self->magnAvgPause[i]);
+  }
+  // Noise update.
+  if (gammaNoiseTmp == gammaNoiseOld) {
+    noise[i] = noiseUpdateTmp;
+  } else {
+    noise[i] = gammaNoiseTmp * self->noisePrev[i] +
+               (1.f - gammaNoiseTmp) * (probNonSpeech * magn[i] +
+                                        probSpeech * self->noisePrev[i]);
+    // Allow for noise update downwards:
+    // If noise update decreases the noise, it is safe, so allow it to
+    // happen.
+    if (noiseUpdateTmp < noise[i]) {
+      noise[i] = noiseUpdateTmp;
+    }
+  }
+}
+
+// Update the noise estimate.
+// Inputs:
+//   * |magn| is the signal magnitude spectrum estimate.
+// Output:
+//   * |noise| is the updated noise magnitude spectrum estimate.
+static void UpdateNoiseEstimate(NoiseSuppressionC* self,
+                                const float* magn,
+                                float* noise) {
+  size_t i;
+
+  // The first bin has no previous bin, so the kernel starts at the second.
+  UpdateNoiseEstimateBin(self, magn, 0, noise);
+  i = 1;
+  if (WebRtcNs_UpdateNoiseEstimate) {
+    i += WebRtcNs_UpdateNoiseEstimate(&self->speechProb[1], &magn[1],
+                                      &self->noisePrev[1], self->magnLen - 1,
+                                      &self->magnAvgPause[1], &noise[1]);
+  }
+  for (; i < self->magnLen; i++) {
+    UpdateNoiseEstimateBin(self, magn, i, noise);
+  }
+}
+
+// Estimate prior SNR decision-directed and compute DD based Wiener Filter.
+// Input:
+//   * |magn| is the signal magnitude spectrum estimate.
+// Output:
+//   * |theFilter| is the frequency response of the computed Wiener filter.
+static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
+                                       const float* magn,
+                                       float* theFilter) {
+  size_t i = 0;
+  float snrPrior, previousEstimateStsa, currentEstimateStsa;
+
+  if (WebRtcNs_ComputeWienerFilter) {
+    i = WebRtcNs_ComputeWienerFilter(magn, self->noise, self->magnPrevProcess,
+                                     self->noisePrev, self->smooth,
+                                     self->overdrive, self->magnLen,
+                                     theFilter);
+  }
+  for (; i < self->magnLen; i++) {
+    // Previous estimate: based on previous frame with gain filter.
+    previousEstimateStsa = self->magnPrevProcess[i] /
+                           (self->noisePrev[i] + 0.0001f) * self->smooth[i];
+    // Post and prior SNR.
+    currentEstimateStsa = 0.f;
+    if (magn[i] > self->noise[i]) {
+      currentEstimateStsa = magn[i] / (self->noise[i] + 0.0001f) - 1.f;
+    }
+    // DD estimate is sum of two terms: current estimate and previous estimate.
+    // Directed decision update of |snrPrior|.
+    snrPrior = DD_PR_SNR * previousEstimateStsa +
+               (1.f - DD_PR_SNR) * currentEstimateStsa;
+    // Gain filter.
+    theFilter[i] = snrPrior / (self->overdrive + snrPrior);
+  }  // End of loop over frequencies.
+}
+
+// Limits the Wiener filter, weights it with the startup filter during startup
+// and applies it to the spectrum.
+// Input:
+//   * |theFilter| is the frequency response of the Wiener filter.
+// Output:
+//   * |theFilter| is the limited and weighted frequency response.
+//   * |real| and |imag| are the filtered spectrum.
+static void ApplyWienerFilter(NoiseSuppressionC* self,
+                              float* theFilter,
+                              float* real,
+                              float* imag) {
+  size_t i = 0;
+  float theFilterTmp;
+
+  // The startup weighting only lasts for the first frames, so it is left to
+  // the generic code.
+  if (WebRtcNs_ApplyWienerFilter && self->blockInd >= END_STARTUP_SHORT) {
+    i = WebRtcNs_ApplyWienerFilter(self->denoiseBound, self->magnLen,
+                                   theFilter, self->smooth, real, imag);
+  }
+  for (; i < self->magnLen; i++) {
+    // Flooring bottom.
+    if (theFilter[i] < self->denoiseBound) {
+      theFilter[i] = self->denoiseBound;
+    }
+    // Flooring top.
+    if (theFilter[i] > 1.f) {
+      theFilter[i] = 1.f;
+    }
+    if (self->blockInd < END_STARTUP_SHORT) {
+      theFilterTmp =
+          (self->initMagnEst[i] - self->overdrive * self->parametricNoise[i]);
+      theFilterTmp /= (self->initMagnEst[i] + 0.0001f);
+      // Flooring bottom.
+      if (theFilterTmp < self->denoiseBound) {
+        theFilterTmp = self->denoiseBound;
+      }
+      // Flooring top.
+      if (theFilterTmp > 1.f) {
+        theFilterTmp = 1.f;
+      }
+      // Weight the two suppression filters.
+      theFilter[i] *= (self->blockInd);
+      theFilterTmp *= (END_STARTUP_SHORT - self->blockInd);
+      theFilter[i] += theFilterTmp;
+      theFilter[i] /= (END_STARTUP_SHORT);
+    }
+
+    self->smooth[i] = theFilter[i];
+    real[i] *= self->smooth[i];
+    imag[i] *= self->smooth[i];
+  }
+}
 
 // Set Feature Extraction Parameters.
 static void set_feature_extraction_parameters(NoiseSuppressionC* self) {
@@ -209,6 +586,29 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
   // Default mode.
   WebRtcNs_set_policy_core(self, 0);
 
+  // Initialize function pointers.
+  WebRtcNs_MagnitudeSpectrum = NULL;
+  WebRtcNs_Log = NULL;
+  WebRtcNs_Exp = NULL;
+  WebRtcNs_UpdateQuantile = NULL;
+  WebRtcNs_ComputeSnr = NULL;
+  WebRtcNs_Sum = NULL;
+  WebRtcNs_Covariance = NULL;
+  WebRtcNs_UpdateLogLrt = NULL;
+  WebRtcNs_SpeechProbability = NULL;
+  WebRtcNs_UpdateNoiseEstimate = NULL;
+  WebRtcNs_ComputeWienerFilter = NULL;
+  WebRtcNs_ApplyWienerFilter = NULL;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (!bitexact && WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNs_InitSSE2();
+  }
+  if (!bitexact && WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    WebRtcNs_InitAVX2();
+  }
+#endif
+
   self->initFlag = 1;
   return 0;
 }
@@ -217,54 +617,27 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
 static void NoiseEstimation(NoiseSuppressionC* self,
                             float* magn,
                             float* noise) {
-  size_t i, s, offset;
-  float lmagn[HALF_ANAL_BLOCKL], delta;
+  size_t i, s, offset = 0;
+  float lmagn[HALF_ANAL_BLOCKL];
 
   if (self->updates < END_STARTUP_LONG) {
     self->updates++;
   }
 
-  for (i = 0; i < self->magnLen; i++) {
-    lmagn[i] = (float)log(magn[i]);
-  }
+  Log(magn, self->magnLen, lmagn);
 
   // Loop over simultaneous estimates.
   for (s = 0; s < SIMULT; s++) {
     offset = s * self->magnLen;
 
     // newquantest(...)
-    for (i = 0; i < self->magnLen; i++) {
-      // Compute delta.
-      if (self->density[offset + i] > 1.0) {
-        delta = FACTOR * 1.f / self->density[offset + i];
-      } else {
-        delta = FACTOR;
-      }
-
-      // Update log quantile estimate.
-      if (lmagn[i] > self->lquantile[offset + i]) {
-        self->lquantile[offset + i] +=
-            QUANTILE * delta / (float)(self->counter[s] + 1);
-      } else {
-        self->lquantile[offset + i] -=
-            (1.f - QUANTILE) * delta / (float)(self->counter[s] + 1);
-      }
-
-      // Update density estimate.
-      if (fabs(lmagn[i] - self->lquantile[offset + i]) < WIDTH) {
-        self->density[offset + i] =
-            ((float)self->counter[s] * self->density[offset + i] +
-             1.f / (2.f * WIDTH)) /
-            (float)(self->counter[s] + 1);
-      }
-    }  // End loop over magnitude spectrum.
+    UpdateQuantile(lmagn, self->magnLen, self->counter[s],
+                   &self->lquantile[offset], &self->density[offset]);
 
     if (self->counter[s] >= END_STARTUP_LONG) {
       self->counter[s] = 0;
       if (self->updates >= END_STARTUP_LONG) {
-        for (i = 0; i < self->magnLen; i++) {
-          self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-        }
+        Exp(&self->lquantile[offset], self->magnLen, self->quantile);
       }
     }
 
@@ -274,9 +647,7 @@ static void NoiseEstimation(NoiseSuppressionC* self,
   // Sequentially update the noise during startup.
   if (self->updates < END_STARTUP_LONG) {
     // Use the last "s" to get noise during startup that differ from zero.
-    for (i = 0; i < self->magnLen; i++) {
-      self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-    }
+    Exp(&self->lquantile[offset], self->magnLen, self->quantile);
   }
 
   for (i = 0; i < self->magnLen; i++) {
@@ -555,38 +926,6 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
   // Done with flatness feature.
 }
 
-// Compute prior and post SNR based on quantile noise estimation.
-// Compute DD estimate of prior SNR.
-// Inputs:
-//   * |magn| is the signal magnitude spectrum estimate.
-//   * |noise| is the magnitude noise spectrum estimate.
-// Outputs:
-//   * |snrLocPrior| is the computed prior SNR.
-//   * |snrLocPost| is the computed post SNR.
-static void ComputeSnr(const NoiseSuppressionC* self,
-                       const float* magn,
-                       const float* noise,
-                       float* snrLocPrior,
-                       float* snrLocPost) {
-  size_t i;
-
-  for (i = 0; i < self->magnLen; i++) {
-    // Previous post SNR.
-    // Previous estimate: based on previous frame with gain filter.
-    float previousEstimateStsa = self->magnPrevAnalyze[i] /
-        (self->noisePrev[i] + 0.0001f) * self->smooth[i];
-    // Post SNR.
-    snrLocPost[i] = 0.f;
-    if (magn[i] > noise[i]) {
-      snrLocPost[i] = magn[i] / (noise[i] + 0.0001f) - 1.f;
-    }
-    // DD estimate is sum of two terms: current estimate and previous estimate.
-    // Directed decision update of snrPrior.
-    snrLocPrior[i] =
-        DD_PR_SNR * previousEstimateStsa + (1.f - DD_PR_SNR) * snrLocPost[i];
-  }  // End of loop over frequencies.
-}
-
 // Compute the difference measure between input spectrum and a template/learned
 // noise spectrum.
 // |magnIn| is the input spectrum.
@@ -596,32 +935,9 @@ static void ComputeSpectralDifference(NoiseSuppressionC* self,
                                       const float* magnIn) {
   // avgDiffNormMagn = var(magnIn) - cov(magnIn, magnAvgPause)^2 /
   // var(magnAvgPause)
-  size_t i;
-  float avgPause, avgMagn, covMagnPause, varPause, varMagn, avgDiffNormMagn;
-
-  avgPause = 0.0;
-  avgMagn = self->sumMagn;
-  // Compute average quantities.
-  for (i = 0; i < self->magnLen; i++) {
-    // Conservative smooth noise spectrum from pause frames.
-    avgPause += self->magnAvgPause[i];
-  }
-  avgPause /= self->magnLen;
-  avgMagn /= self->magnLen;
+  float covMagnPause, varPause, varMagn, avgDiffNormMagn;
 
-  covMagnPause = 0.0;
-  varPause = 0.0;
-  varMagn = 0.0;
-  // Compute variance and covariance quantities.
-  for (i = 0; i < self->magnLen; i++) {
-    covMagnPause += (magnIn[i] - avgMagn) * (self->magnAvgPause[i] - avgPause);
-    varPause +=
-        (self->magnAvgPause[i] - avgPause) * (self->magnAvgPause[i] - avgPause);
-    varMagn += (magnIn[i] - avgMagn) * (magnIn[i] - avgMagn);
-  }
-  covMagnPause /= self->magnLen;
-  varPause /= self->magnLen;
-  varMagn /= self->magnLen;
+  SpectralDifferenceStats(self, magnIn, &covMagnPause, &varPause, &varMagn);
   // Update of average magnitude spectrum.
   self->featureData[6] += self->signalEnergy;
 
@@ -643,12 +959,11 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
                             float* probSpeechFinal,
                             const float* snrLocPrior,
                             const float* snrLocPost) {
-  size_t i;
   int sgnMap;
-  float invLrt, gainPrior, indPrior;
-  float logLrtTimeAvgKsum, besselTmp;
+  float gainPrior, indPrior;
+  float logLrtTimeAvgKsum;
   float indicator0, indicator1, indicator2;
-  float tmpFloat1, tmpFloat2;
+  float tmpFloat1;
   float weightIndPrior0, weightIndPrior1, weightIndPrior2;
   float threshPrior0, threshPrior1, threshPrior2;
   float widthPrior, widthPrior0, widthPrior1, widthPrior2;
@@ -673,15 +988,7 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
 
   // Compute feature based on average LR factor.
   // This is the average over all frequencies of the smooth log LRT.
-  logLrtTimeAvgKsum = 0.0;
-  for (i = 0; i < self->magnLen; i++) {
-    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
-    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
-    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
-    self->logLrtTimeAvg[i] +=
-        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
-    logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
-  }
+  logLrtTimeAvgKsum = UpdateLogLrt(self, snrLocPrior, snrLocPost);
   logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (self->magnLen);
   self->featureData[3] = logLrtTimeAvgKsum;
   // Done with computation of LR factor.
@@ -742,11 +1049,7 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
 
   // Final speech probability: combine prior model with LR factor:.
   gainPrior = (1.f - self->priorSpeechProb) / (self->priorSpeechProb + 0.0001f);
-  for (i = 0; i < self->magnLen; i++) {
-    invLrt = (float)exp(-self->logLrtTimeAvg[i]);
-    invLrt = (float)gainPrior * invLrt;
-    probSpeechFinal[i] = 1.f / (1.f + invLrt);
-  }
+  SpeechProbability(self, gainPrior, probSpeechFinal);
 }
 
 // Update the noise features.
@@ -791,61 +1094,6 @@ static void FeatureUpdate(NoiseSuppressionC* self,
   }
 }
 
-// Update the noise estimate.
-// Inputs:
-//   * |magn| is the signal magnitude spectrum estimate.
-//   * |snrLocPrior| is the prior SNR.
-//   * |snrLocPost| is the post SNR.
-// Output:
-//   * |noise| is the updated noise magnitude spectrum estimate.
-static void UpdateNoiseEstimate(NoiseSuppressionC* self,
-                                const float* magn,
-                                const float* snrLocPrior,
-                                const float* snrLocPost,
-                                float* noise) {
-  size_t i;
-  float probSpeech, probNonSpeech;
-  // Time-avg parameter for noise update.
-  float gammaNoiseTmp = NOISE_UPDATE;
-  float gammaNoiseOld;
-  float noiseUpdateTmp;
-
-  for (i = 0; i < self->magnLen; i++) {
-    probSpeech = self->speechProb[i];
-    probNonSpeech = 1.f - probSpeech;
-    // Temporary noise update:
-    // Use it for speech frames if update value is less than previous.
-    noiseUpdateTmp = gammaNoiseTmp * self->noisePrev[i] +
-                     (1.f - gammaNoiseTmp) * (probNonSpeech * magn[i] +
-                                              probSpeech * self->noisePrev[i]);
-    // Time-constant based on speech/noise state.
-    gammaNoiseOld = gammaNoiseTmp;
-    gammaNoiseTmp = NOISE_UPDATE;
-    // Increase gamma (i.e., less noise update) for frame likely to be speech.
-    if (probSpeech > PROB_RANGE) {
-      gammaNoiseTmp = SPEECH_UPDATE;
-    }
-    // Conservative noise update.
-    if (probSpeech < PROB_RANGE) {
-      self->magnAvgPause[i] += GAMMA_PAUSE * (magn[i] - self->magnAvgPause[i]);
-    }
-    // Noise update.
-    if (gammaNoiseTmp == gammaNoiseOld) {
-      noise[i] = noiseUpdateTmp;
-    } else {
-      noise[i] = gammaNoiseTmp * self->noisePrev[i] +
-                 (1.f - gammaNoiseTmp) * (probNonSpeech * magn[i] +
-                                          probSpeech * self->noisePrev[i]);
-      // Allow for noise update downwards:
-      // If noise update decreases the noise, it is safe, so allow it to
-      // happen.
-      if (noiseUpdateTmp < noise[i]) {
-        noise[i] = noiseUpdateTmp;
-      }
-    }
-  }  // End of freq loop.
-}
-
 // Updates |buffer| with a new |frame|.
 // Inputs:
 //   * |frame| is a new speech frame or NULL for setting to zero.
@@ -891,8 +1139,6 @@ static void FFT(NoiseSuppressionC* self,
                 float* real,
                 float* imag,
                 float* magn) {
-  size_t i;
-
   assert(magnitude_length == time_data_length / 2 + 1);
 
   WebRtc_rdft(time_data_length, 1, time_data, self->ip, self->wfft);
@@ -903,12 +1149,8 @@ static void FFT(NoiseSuppressionC* self,
   imag[magnitude_length - 1] = 0;
   real[magnitude_length - 1] = time_data[1];
   magn[magnitude_length - 1] = fabsf(real[magnitude_length - 1]) + 1.f;
-  for (i = 1; i < magnitude_length - 1; ++i) {
-    real[i] = time_data[2 * i];
-    imag[i] = time_data[2 * i + 1];
-    // Magnitude spectrum.
-    magn[i] = sqrtf(real[i] * real[i] + imag[i] * imag[i]) + 1.f;
-  }
+  MagnitudeSpectrum(&time_data[2], magnitude_length - 2, &real[1], &imag[1],
+                    &magn[1]);
 }
 
 // Transforms the signal from frequency to time domain.
@@ -978,35 +1220,6 @@ static void Windowing(const float* window,
   }
 }
 
-// Estimate prior SNR decision-directed and compute DD based Wiener Filter.
-// Input:
-//   * |magn| is the signal magnitude spectrum estimate.
-// Output:
-//   * |theFilter| is the frequency response of the computed Wiener filter.
-static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
-                                       const float* magn,
-                                       float* theFilter) {
-  size_t i;
-  float snrPrior, previousEstimateStsa, currentEstimateStsa;
-
-  for (i = 0; i < self->magnLen; i++) {
-    // Previous estimate: based on previous frame with gain filter.
-    previousEstimateStsa = self->magnPrevProcess[i] /
-                           (self->noisePrev[i] + 0.0001f) * self->smooth[i];
-    // Post and prior SNR.
-    currentEstimateStsa = 0.f;
-    if (magn[i] > self->noise[i]) {
-      currentEstimateStsa = magn[i] / (self->noise[i] + 0.0001f) - 1.f;
-    }
-    // DD estimate is sum of two terms: current estimate and previous estimate.
-    // Directed decision update of |snrPrior|.
-    snrPrior = DD_PR_SNR * previousEstimateStsa +
-               (1.f - DD_PR_SNR) * currentEstimateStsa;
-    // Gain filter.
-    theFilter[i] = snrPrior / (self->overdrive + snrPrior);
-  }  // End of loop over frequencies.
-}
-
 // Changes the aggressiveness of the noise suppression method.
 // |mode| = 0 is mild (6dB), |mode| = 1 is medium (10dB) and |mode| = 2 is
 // aggressive (15dB).
@@ -1174,7 +1387,7 @@ void WebRtcNs_AnalyzeCore(NoiseSuppressionC* self, const float* speechFrame) {
 
   FeatureUpdate(self, magn, updateParsFlag);
   SpeechNoiseProb(self, self->speechProb, snrLocPrior, snrLocPost);
-  UpdateNoiseEstimate(self, magn, snrLocPrior, snrLocPost, noise);
+  UpdateNoiseEstimate(self, magn, noise);
 
   // Keep track of noise spectrum for next frame.
   memcpy(self->noise, noise, sizeof(*noise) * self->magnLen);
@@ -1193,7 +1406,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
   float fout[BLOCKL_MAX];
   float winData[ANAL_BLOCKL_MAX];
   float magn[HALF_ANAL_BLOCKL];
-  float theFilter[HALF_ANAL_BLOCKL], theFilterTmp[HALF_ANAL_BLOCKL];
+  float theFilter[HALF_ANAL_BLOCKL];
   float real[ANAL_BLOCKL_MAX], imag[HALF_ANAL_BLOCKL];
 
   // SWB variables.
@@ -1273,39 +1486,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
   }
 
   ComputeDdBasedWienerFilter(self, magn, theFilter);
-
-  for (i = 0; i < self->magnLen; i++) {
-    // Flooring bottom.
-    if (theFilter[i] < self->denoiseBound) {
-      theFilter[i] = self->denoiseBound;
-    }
-    // Flooring top.
-    if (theFilter[i] > 1.f) {
-      theFilter[i] = 1.f;
-    }
-    if (self->blockInd < END_STARTUP_SHORT) {
-      theFilterTmp[i] =
-          (self->initMagnEst[i] - self->overdrive * self->parametricNoise[i]);
-      theFilterTmp[i] /= (self->initMagnEst[i] + 0.0001f);
-      // Flooring bottom.
-      if (theFilterTmp[i] < self->denoiseBound) {
-        theFilterTmp[i] = self->denoiseBound;
-      }
-      // Flooring top.
-      if (theFilterTmp[i] > 1.f) {
-        theFilterTmp[i] = 1.f;
-      }
-      // Weight the two suppression filters.
-      theFilter[i] *= (self->blockInd);
-      theFilterTmp[i] *= (END_STARTUP_SHORT - self->blockInd);
-      theFilter[i] += theFilterTmp[i];
-      theFilter[i] /= (END_STARTUP_SHORT);
-    }
-
-    self->smooth[i] = theFilter[i];
-    real[i] *= self->smooth[i];
-    imag[i] *= self->smooth[i];
-  }
+  ApplyWienerFilter(self, theFilter, real, imag);
   // Keep track of |magn| spectrum for next frame.
   memcpy(self->magnPrevProcess, magn, sizeof(*magn) * self->magnLen);
   memcpy(self->noisePrev, self->noise, sizeof(self->noise[0]) * self->magnLen);
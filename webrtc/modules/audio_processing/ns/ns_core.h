@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_NS_NS_CORE_H_
 
 #include "webrtc/modules/audio_processing/ns/defines.h"
+#include "webrtc/typedefs.h"
 
 typedef struct NSParaExtract_ {
   // Bin size of histogram.
@@ -184,6 +185,138 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
                           size_t num_bands,
                           float* const* outFrame);
 
+/****************************************************************************
+ * WebRtcNs_SetBitexact(...)
+ *
+ * Makes the following WebRtcNs_InitCore() calls select only the generic C
+ * code, which the stored reference data of the APM tests are generated with.
+ * The SSE2 and AVX2 kernels below are close to, but not bitexact with, it.
+ *
+ * Input:
+ *      - enable        : 1 to use only the generic C code, 0 (default) to
+ *                        select the kernels based on the CPU features
+ */
+void WebRtcNs_SetBitexact(int enable);
+
+/****************************************************************************
+ * Some function pointers, for the vectorized part of the per-frequency-bin
+ * loops. Each kernel processes as many leading bins as fit in whole vectors
+ * and returns that number; the generic code in ns_core.c processes the rest.
+ * They are NULL when only the generic code is used.
+ */
+// Splits the interleaved complex values in |fft| into |real| and |imag| and
+// computes the magnitude spectrum |magn| (offset by 1).
+typedef size_t (*WebRtcNsMagnitudeSpectrum)(const float* fft,
+                                            size_t num_bins,
+                                            float* real,
+                                            float* imag,
+                                            float* magn);
+extern WebRtcNsMagnitudeSpectrum WebRtcNs_MagnitudeSpectrum;
+
+// Computes the natural logarithm of |in|.
+typedef size_t (*WebRtcNsLog)(const float* in, size_t length, float* out);
+extern WebRtcNsLog WebRtcNs_Log;
+
+// Computes the natural exponential of |in|.
+typedef size_t (*WebRtcNsExp)(const float* in, size_t length, float* out);
+extern WebRtcNsExp WebRtcNs_Exp;
+
+// Updates the log quantile and density estimates of one of the simultaneous
+// quantile noise estimates, given the log magnitude spectrum |lmagn|.
+typedef size_t (*WebRtcNsUpdateQuantile)(const float* lmagn,
+                                         size_t length,
+                                         int counter,
+                                         float* lquantile,
+                                         float* density);
+extern WebRtcNsUpdateQuantile WebRtcNs_UpdateQuantile;
+
+// Computes the post SNR of |magn| over |noise| and the decision-directed prior
+// SNR, where the previous estimate is |magnPrev| over |noisePrev|, weighted by
+// the previous gain |smooth|.
+typedef size_t (*WebRtcNsComputeSnr)(const float* magn,
+                                     const float* noise,
+                                     const float* magnPrev,
+                                     const float* noisePrev,
+                                     const float* smooth,
+                                     size_t length,
+                                     float* snrLocPrior,
+                                     float* snrLocPost);
+extern WebRtcNsComputeSnr WebRtcNs_ComputeSnr;
+
+// Adds the elements of |in| to |*sum|.
+typedef size_t (*WebRtcNsSum)(const float* in, size_t length, float* sum);
+extern WebRtcNsSum WebRtcNs_Sum;
+
+// Adds the covariance of |magn| and |pause| around their averages, and their
+// variances, to |*cov|, |*varPause| and |*varMagn|.
+typedef size_t (*WebRtcNsCovariance)(const float* magn,
+                                     float avgMagn,
+                                     const float* pause,
+                                     float avgPause,
+                                     size_t length,
+                                     float* cov,
+                                     float* varPause,
+                                     float* varMagn);
+extern WebRtcNsCovariance WebRtcNs_Covariance;
+
+// Updates the time-smoothed log likelihood ratio |logLrtTimeAvg| and adds it
+// to |*sum|.
+typedef size_t (*WebRtcNsUpdateLogLrt)(const float* snrLocPrior,
+                                       const float* snrLocPost,
+                                       size_t length,
+                                       float* logLrtTimeAvg,
+                                       float* sum);
+extern WebRtcNsUpdateLogLrt WebRtcNs_UpdateLogLrt;
+
+// Combines the prior speech probability, through |gainPrior|, with the
+// likelihood ratio into the final speech probability.
+typedef size_t (*WebRtcNsSpeechProbability)(const float* logLrtTimeAvg,
+                                            float gainPrior,
+                                            size_t length,
+                                            float* probSpeechFinal);
+extern WebRtcNsSpeechProbability WebRtcNs_SpeechProbability;
+
+// Updates the noise estimate |noise| and the conservative noise estimate
+// |magnAvgPause| from |magn| and the speech probability. The time constant of
+// each bin depends on the speech probability of the previous bin, so
+// |probSpeech[-1]| must be valid.
+typedef size_t (*WebRtcNsUpdateNoiseEstimate)(const float* probSpeech,
+                                              const float* magn,
+                                              const float* noisePrev,
+                                              size_t length,
+                                              float* magnAvgPause,
+                                              float* noise);
+extern WebRtcNsUpdateNoiseEstimate WebRtcNs_UpdateNoiseEstimate;
+
+// Estimates the decision-directed prior SNR like WebRtcNs_ComputeSnr() and
+// computes the Wiener filter.
+typedef size_t (*WebRtcNsComputeWienerFilter)(const float* magn,
+                                              const float* noise,
+                                              const float* magnPrev,
+                                              const float* noisePrev,
+                                              const float* smooth,
+                                              float overdrive,
+                                              size_t length,
+                                              float* theFilter);
+extern WebRtcNsComputeWienerFilter WebRtcNs_ComputeWienerFilter;
+
+// Limits |theFilter| to [|denoiseBound|, 1], stores it in |smooth| and applies
+// it to the spectrum.
+typedef size_t (*WebRtcNsApplyWienerFilter)(float denoiseBound,
+                                            size_t length,
+                                            float* theFilter,
+                                            float* smooth,
+                                            float* real,
+                                            float* imag);
+extern WebRtcNsApplyWienerFilter WebRtcNs_ApplyWienerFilter;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Set the above function pointers to the kernels in ns_core_sse2.c and
+// ns_core_avx2.c.
+void WebRtcNs_InitSSE2(void);
+void WebRtcNs_InitAVX2(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
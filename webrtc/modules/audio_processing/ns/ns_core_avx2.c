@@ -0,0 +1,440 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core noise suppression algorithm, AVX2/FMA kernels for the
+ * per-frequency-bin loops. They process eight bins at a time and leave the
+ * remaining bins to the generic code in ns_core.c. Like the SSE2 kernels, they
+ * are close to, but not bitexact with, the generic code.
+ */
+
+#include <immintrin.h>
+
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+
+// Sums the eight elements of |v|.
+static __inline float HorizontalSum(__m256 v) {
+  const __m128 sum_lanes =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  const __m128 sum_high = _mm_movehl_ps(sum_lanes, sum_lanes);
+  const __m128 sum_pairs = _mm_add_ps(sum_lanes, sum_high);
+  const __m128 sum =
+      _mm_add_ss(sum_pairs, _mm_shuffle_ps(sum_pairs, sum_pairs, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+// Natural logarithm of eight positive, normal numbers, using the polynomial
+// approximation of the Cephes library.
+static __inline __m256 LogAVX2(__m256 x) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 kSqrtHalf = _mm256_set1_ps(0.707106781186547524f);
+  const __m256i kMantissaMask = _mm256_set1_epi32(0x007FFFFF);
+  const __m256i kHalf = _mm256_set1_epi32(0x3F000000);
+  const __m256i kExponentBias = _mm256_set1_epi32(126);
+  const __m256i x_bits = _mm256_castps_si256(x);
+  __m256 e = _mm256_cvtepi32_ps(
+      _mm256_sub_epi32(_mm256_srli_epi32(x_bits, 23), kExponentBias));
+  // Mantissa in [0.5, 1).
+  __m256 m = _mm256_castsi256_ps(
+      _mm256_or_si256(_mm256_and_si256(x_bits, kMantissaMask), kHalf));
+  // Move the mantissa to [sqrt(0.5), sqrt(2)) and shift it by one.
+  const __m256 small = _mm256_cmp_ps(m, kSqrtHalf, _CMP_LT_OQ);
+  __m256 z, y;
+  e = _mm256_sub_ps(e, _mm256_and_ps(kOne, small));
+  m = _mm256_add_ps(_mm256_sub_ps(m, kOne), _mm256_and_ps(m, small));
+  z = _mm256_mul_ps(m, m);
+
+  y = _mm256_set1_ps(7.0376836292E-2f);
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.1514610310E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.1676998740E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.2420140846E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.4249322787E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.6668057665E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(2.0000714765E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-2.4999993993E-1f));
+  y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(3.3333331174E-1f));
+  y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440E-4f), y);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), _mm256_add_ps(m, y));
+}
+
+// Natural exponential of eight numbers, using the polynomial approximation of
+// the Cephes library. The input is limited to the range of float.
+static __inline __m256 ExpAVX2(__m256 x) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  __m256 fx, y, z;
+  __m256i n;
+  x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+  x = _mm256_max_ps(x, _mm256_set1_ps(-88.3762626647949f));
+
+  // Express exp(x) as 2^n * exp(g), with n = floor(x / ln(2) + 0.5).
+  fx = _mm256_floor_ps(_mm256_fmadd_ps(
+      x, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f)));
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440E-4f), x);
+  z = _mm256_mul_ps(x, x);
+
+  y = _mm256_set1_ps(1.9875691500E-4f);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507E-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073E-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894E-2f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459E-1f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201E-1f));
+  y = _mm256_add_ps(_mm256_fmadd_ps(y, z, x), kOne);
+
+  // Build 2^n.
+  n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+static size_t MagnitudeSpectrumAVX2(const float* fft,
+                                    size_t num_bins,
+                                    float* real,
+                                    float* imag,
+                                    float* magn) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  size_t i;
+
+  for (i = 0; i + 8 <= num_bins; i += 8) {
+    const __m256 a = _mm256_loadu_ps(&fft[2 * i]);
+    const __m256 b = _mm256_loadu_ps(&fft[2 * i + 8]);
+    // The in-lane shuffles leave the pairs of bins in the order 0, 2, 1, 3.
+    const __m256 re = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+        _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m256 im = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))),
+        _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m256 power = _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im));
+    _mm256_storeu_ps(&real[i], re);
+    _mm256_storeu_ps(&imag[i], im);
+    _mm256_storeu_ps(&magn[i], _mm256_add_ps(_mm256_sqrt_ps(power), kOne));
+  }
+  return i;
+}
+
+static size_t LogAVX2Loop(const float* in, size_t length, float* out) {
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    _mm256_storeu_ps(&out[i], LogAVX2(_mm256_loadu_ps(&in[i])));
+  }
+  return i;
+}
+
+static size_t ExpAVX2Loop(const float* in, size_t length, float* out) {
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    _mm256_storeu_ps(&out[i], ExpAVX2(_mm256_loadu_ps(&in[i])));
+  }
+  return i;
+}
+
+static size_t UpdateQuantileAVX2(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density) {
+  const __m256 kFactor = _mm256_set1_ps(FACTOR);
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 kSignBit = _mm256_set1_ps(-0.f);
+  const __m256 counter_f = _mm256_set1_ps((float)counter);
+  const __m256 counter_plus_one_f = _mm256_set1_ps((float)(counter + 1));
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 lmagn_v = _mm256_loadu_ps(&lmagn[i]);
+    __m256 lquantile_v = _mm256_loadu_ps(&lquantile[i]);
+    __m256 density_v = _mm256_loadu_ps(&density[i]);
+    // Compute delta.
+    const __m256 delta =
+        _mm256_blendv_ps(kFactor, _mm256_div_ps(kFactor, density_v),
+                         _mm256_cmp_ps(density_v, kOne, _CMP_GT_OQ));
+    // Update log quantile estimate.
+    const __m256 step_up = _mm256_div_ps(
+        _mm256_mul_ps(_mm256_set1_ps(QUANTILE), delta), counter_plus_one_f);
+    const __m256 step_down =
+        _mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(1.f - QUANTILE), delta),
+                      counter_plus_one_f);
+    __m256 distance, new_density;
+    lquantile_v = _mm256_blendv_ps(
+        _mm256_sub_ps(lquantile_v, step_down),
+        _mm256_add_ps(lquantile_v, step_up),
+        _mm256_cmp_ps(lmagn_v, lquantile_v, _CMP_GT_OQ));
+    // Update density estimate.
+    distance = _mm256_andnot_ps(kSignBit, _mm256_sub_ps(lmagn_v, lquantile_v));
+    new_density = _mm256_div_ps(
+        _mm256_fmadd_ps(counter_f, density_v,
+                        _mm256_set1_ps(1.f / (2.f * WIDTH))),
+        counter_plus_one_f);
+    density_v = _mm256_blendv_ps(
+        density_v, new_density,
+        _mm256_cmp_ps(distance, _mm256_set1_ps(WIDTH), _CMP_LT_OQ));
+    _mm256_storeu_ps(&lquantile[i], lquantile_v);
+    _mm256_storeu_ps(&density[i], density_v);
+  }
+  return i;
+}
+
+// Decision-directed estimate of the prior SNR, given the post SNR |post|.
+static __inline __m256 DdPriorSnrAVX2(const float* magn_prev,
+                                      const float* noise_prev,
+                                      const float* smooth,
+                                      __m256 post) {
+  // Previous estimate: based on previous frame with gain filter.
+  const __m256 previous_estimate_stsa = _mm256_mul_ps(
+      _mm256_div_ps(_mm256_loadu_ps(magn_prev),
+                    _mm256_add_ps(_mm256_loadu_ps(noise_prev),
+                                  _mm256_set1_ps(0.0001f))),
+      _mm256_loadu_ps(smooth));
+  return _mm256_fmadd_ps(_mm256_set1_ps(DD_PR_SNR), previous_estimate_stsa,
+                         _mm256_mul_ps(_mm256_set1_ps(1.f - DD_PR_SNR), post));
+}
+
+// Post SNR of |magn| over |noise|, zero where |magn| is the smaller.
+static __inline __m256 PostSnrAVX2(const float* magn, const float* noise) {
+  const __m256 magn_v = _mm256_loadu_ps(magn);
+  const __m256 noise_v = _mm256_loadu_ps(noise);
+  return _mm256_and_ps(
+      _mm256_cmp_ps(magn_v, noise_v, _CMP_GT_OQ),
+      _mm256_sub_ps(
+          _mm256_div_ps(magn_v,
+                        _mm256_add_ps(noise_v, _mm256_set1_ps(0.0001f))),
+          _mm256_set1_ps(1.f)));
+}
+
+static size_t ComputeSnrAVX2(const float* magn,
+                             const float* noise,
+                             const float* magnPrev,
+                             const float* noisePrev,
+                             const float* smooth,
+                             size_t length,
+                             float* snrLocPrior,
+                             float* snrLocPost) {
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 post = PostSnrAVX2(&magn[i], &noise[i]);
+    _mm256_storeu_ps(&snrLocPost[i], post);
+    _mm256_storeu_ps(&snrLocPrior[i], DdPriorSnrAVX2(&magnPrev[i],
+                                                     &noisePrev[i],
+                                                     &smooth[i], post));
+  }
+  return i;
+}
+
+static size_t SumAVX2(const float* in, size_t length, float* sum) {
+  __m256 sum_v = _mm256_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    sum_v = _mm256_add_ps(sum_v, _mm256_loadu_ps(&in[i]));
+  }
+  *sum += HorizontalSum(sum_v);
+  return i;
+}
+
+static size_t CovarianceAVX2(const float* magn,
+                             float avgMagn,
+                             const float* pause,
+                             float avgPause,
+                             size_t length,
+                             float* cov,
+                             float* varPause,
+                             float* varMagn) {
+  const __m256 avg_magn = _mm256_set1_ps(avgMagn);
+  const __m256 avg_pause = _mm256_set1_ps(avgPause);
+  __m256 cov_v = _mm256_setzero_ps();
+  __m256 var_pause_v = _mm256_setzero_ps();
+  __m256 var_magn_v = _mm256_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 magn_diff = _mm256_sub_ps(_mm256_loadu_ps(&magn[i]), avg_magn);
+    const __m256 pause_diff =
+        _mm256_sub_ps(_mm256_loadu_ps(&pause[i]), avg_pause);
+    cov_v = _mm256_fmadd_ps(magn_diff, pause_diff, cov_v);
+    var_pause_v = _mm256_fmadd_ps(pause_diff, pause_diff, var_pause_v);
+    var_magn_v = _mm256_fmadd_ps(magn_diff, magn_diff, var_magn_v);
+  }
+  *cov += HorizontalSum(cov_v);
+  *varPause += HorizontalSum(var_pause_v);
+  *varMagn += HorizontalSum(var_magn_v);
+  return i;
+}
+
+static size_t UpdateLogLrtAVX2(const float* snrLocPrior,
+                               const float* snrLocPost,
+                               size_t length,
+                               float* logLrtTimeAvg,
+                               float* sum) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 kTwo = _mm256_set1_ps(2.f);
+  const __m256 kEps = _mm256_set1_ps(0.0001f);
+  const __m256 kLrtTavg = _mm256_set1_ps(LRT_TAVG);
+  __m256 sum_v = _mm256_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 prior = _mm256_loadu_ps(&snrLocPrior[i]);
+    const __m256 tmp1 = _mm256_fmadd_ps(kTwo, prior, kOne);
+    const __m256 tmp2 = _mm256_div_ps(_mm256_mul_ps(kTwo, prior),
+                                      _mm256_add_ps(tmp1, kEps));
+    const __m256 bessel = _mm256_mul_ps(
+        _mm256_add_ps(_mm256_loadu_ps(&snrLocPost[i]), kOne), tmp2);
+    __m256 lrt = _mm256_loadu_ps(&logLrtTimeAvg[i]);
+    lrt = _mm256_fmadd_ps(
+        kLrtTavg, _mm256_sub_ps(_mm256_sub_ps(bessel, LogAVX2(tmp1)), lrt),
+        lrt);
+    _mm256_storeu_ps(&logLrtTimeAvg[i], lrt);
+    sum_v = _mm256_add_ps(sum_v, lrt);
+  }
+  *sum += HorizontalSum(sum_v);
+  return i;
+}
+
+static size_t SpeechProbabilityAVX2(const float* logLrtTimeAvg,
+                                    float gainPrior,
+                                    size_t length,
+                                    float* probSpeechFinal) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 kSignBit = _mm256_set1_ps(-0.f);
+  const __m256 gain_prior = _mm256_set1_ps(gainPrior);
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 neg_lrt =
+        _mm256_xor_ps(_mm256_loadu_ps(&logLrtTimeAvg[i]), kSignBit);
+    _mm256_storeu_ps(
+        &probSpeechFinal[i],
+        _mm256_div_ps(kOne,
+                      _mm256_fmadd_ps(gain_prior, ExpAVX2(neg_lrt), kOne)));
+  }
+  return i;
+}
+
+// Computes the time-averaged noise update for time constant |gamma|.
+static __inline __m256 NoiseUpdateAVX2(__m256 gamma,
+                                       __m256 prob_speech,
+                                       __m256 magn,
+                                       __m256 noise_prev) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 prob_non_speech = _mm256_sub_ps(kOne, prob_speech);
+  const __m256 update = _mm256_fmadd_ps(prob_non_speech, magn,
+                                        _mm256_mul_ps(prob_speech, noise_prev));
+  return _mm256_fmadd_ps(gamma, noise_prev,
+                         _mm256_mul_ps(_mm256_sub_ps(kOne, gamma), update));
+}
+
+// See UpdateNoiseEstimateSSE2() for how the dependency between bins is
+// removed.
+static size_t UpdateNoiseEstimateAVX2(const float* probSpeech,
+                                      const float* magn,
+                                      const float* noisePrev,
+                                      size_t length,
+                                      float* magnAvgPause,
+                                      float* noise) {
+  const __m256 kProbRange = _mm256_set1_ps(PROB_RANGE);
+  const __m256 kNoiseUpdate = _mm256_set1_ps(NOISE_UPDATE);
+  const __m256 kSpeechUpdate = _mm256_set1_ps(SPEECH_UPDATE);
+  const __m256 kGammaPause = _mm256_set1_ps(GAMMA_PAUSE);
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 prob = _mm256_loadu_ps(&probSpeech[i]);
+    const __m256 gamma =
+        _mm256_blendv_ps(kNoiseUpdate, kSpeechUpdate,
+                         _mm256_cmp_ps(prob, kProbRange, _CMP_GT_OQ));
+    const __m256 gamma_old = _mm256_blendv_ps(
+        kNoiseUpdate, kSpeechUpdate,
+        _mm256_cmp_ps(_mm256_loadu_ps(&probSpeech[i - 1]), kProbRange,
+                      _CMP_GT_OQ));
+    const __m256 magn_v = _mm256_loadu_ps(&magn[i]);
+    const __m256 noise_prev = _mm256_loadu_ps(&noisePrev[i]);
+    const __m256 noise_update_tmp =
+        NoiseUpdateAVX2(gamma_old, prob, magn_v, noise_prev);
+    const __m256 noise_new = NoiseUpdateAVX2(gamma, prob, magn_v, noise_prev);
+    // Conservative noise update.
+    const __m256 pause = _mm256_cmp_ps(prob, kProbRange, _CMP_LT_OQ);
+    const __m256 avg_pause = _mm256_loadu_ps(&magnAvgPause[i]);
+    _mm256_storeu_ps(
+        &magnAvgPause[i],
+        _mm256_blendv_ps(
+            avg_pause,
+            _mm256_fmadd_ps(kGammaPause, _mm256_sub_ps(magn_v, avg_pause),
+                            avg_pause),
+            pause));
+    _mm256_storeu_ps(&noise[i], _mm256_min_ps(noise_update_tmp, noise_new));
+  }
+  return i;
+}
+
+static size_t ComputeWienerFilterAVX2(const float* magn,
+                                      const float* noise,
+                                      const float* magnPrev,
+                                      const float* noisePrev,
+                                      const float* smooth,
+                                      float overdrive,
+                                      size_t length,
+                                      float* theFilter) {
+  const __m256 overdrive_v = _mm256_set1_ps(overdrive);
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    const __m256 snr_prior =
+        DdPriorSnrAVX2(&magnPrev[i], &noisePrev[i], &smooth[i],
+                       PostSnrAVX2(&magn[i], &noise[i]));
+    // Gain filter.
+    _mm256_storeu_ps(
+        &theFilter[i],
+        _mm256_div_ps(snr_prior, _mm256_add_ps(overdrive_v, snr_prior)));
+  }
+  return i;
+}
+
+static size_t ApplyWienerFilterAVX2(float denoiseBound,
+                                    size_t length,
+                                    float* theFilter,
+                                    float* smooth,
+                                    float* real,
+                                    float* imag) {
+  const __m256 kOne = _mm256_set1_ps(1.f);
+  const __m256 denoise_bound = _mm256_set1_ps(denoiseBound);
+  size_t i;
+
+  for (i = 0; i + 8 <= length; i += 8) {
+    // Flooring bottom and top.
+    const __m256 filter = _mm256_min_ps(
+        _mm256_max_ps(_mm256_loadu_ps(&theFilter[i]), denoise_bound), kOne);
+    _mm256_storeu_ps(&theFilter[i], filter);
+    _mm256_storeu_ps(&smooth[i], filter);
+    _mm256_storeu_ps(&real[i], _mm256_mul_ps(_mm256_loadu_ps(&real[i]), filter));
+    _mm256_storeu_ps(&imag[i], _mm256_mul_ps(_mm256_loadu_ps(&imag[i]), filter));
+  }
+  return i;
+}
+
+void WebRtcNs_InitAVX2(void) {
+  WebRtcNs_MagnitudeSpectrum = MagnitudeSpectrumAVX2;
+  WebRtcNs_Log = LogAVX2Loop;
+  WebRtcNs_Exp = ExpAVX2Loop;
+  WebRtcNs_UpdateQuantile = UpdateQuantileAVX2;
+  WebRtcNs_ComputeSnr = ComputeSnrAVX2;
+  WebRtcNs_Sum = SumAVX2;
+  WebRtcNs_Covariance = CovarianceAVX2;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtAVX2;
+  WebRtcNs_SpeechProbability = SpeechProbabilityAVX2;
+  WebRtcNs_UpdateNoiseEstimate = UpdateNoiseEstimateAVX2;
+  WebRtcNs_ComputeWienerFilter = ComputeWienerFilterAVX2;
+  WebRtcNs_ApplyWienerFilter = ApplyWienerFilterAVX2;
+}
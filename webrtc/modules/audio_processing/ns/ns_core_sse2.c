@@ -0,0 +1,432 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core noise suppression algorithm, SSE2 kernels for the per-frequency-bin
+ * loops. They process four bins at a time and leave the remaining bins to the
+ * generic code in ns_core.c. The log and exp approximations are accurate to a
+ * few ulp, so the output is close to, but not bitexact with, the generic code.
+ */
+
+#include <emmintrin.h>
+
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+
+// Sums the four elements of |v|.
+static __inline float HorizontalSum(__m128 v) {
+  const __m128 sum_high = _mm_movehl_ps(v, v);
+  const __m128 sum_pairs = _mm_add_ps(v, sum_high);
+  const __m128 sum =
+      _mm_add_ss(sum_pairs, _mm_shuffle_ps(sum_pairs, sum_pairs, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+// Natural logarithm of four positive, normal numbers, using the polynomial
+// approximation of the Cephes library.
+static __inline __m128 LogSSE2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kSqrtHalf = _mm_set1_ps(0.707106781186547524f);
+  const __m128i kMantissaMask = _mm_set1_epi32(0x007FFFFF);
+  const __m128i kHalf = _mm_set1_epi32(0x3F000000);
+  const __m128i kExponentBias = _mm_set1_epi32(126);
+  __m128i x_bits = _mm_castps_si128(x);
+  __m128 e = _mm_cvtepi32_ps(
+      _mm_sub_epi32(_mm_srli_epi32(x_bits, 23), kExponentBias));
+  // Mantissa in [0.5, 1).
+  __m128 m = _mm_castsi128_ps(
+      _mm_or_si128(_mm_and_si128(x_bits, kMantissaMask), kHalf));
+  // Move the mantissa to [sqrt(0.5), sqrt(2)) and shift it by one.
+  const __m128 small = _mm_cmplt_ps(m, kSqrtHalf);
+  __m128 z, y;
+  e = _mm_sub_ps(e, _mm_and_ps(kOne, small));
+  m = _mm_add_ps(_mm_sub_ps(m, kOne), _mm_and_ps(m, small));
+  z = _mm_mul_ps(m, m);
+
+  y = _mm_set1_ps(7.0376836292E-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174E-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440E-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  return _mm_add_ps(_mm_add_ps(m, y),
+                    _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+// Natural exponential of four numbers, using the polynomial approximation of
+// the Cephes library. The input is limited to the range of float.
+static __inline __m128 ExpSSE2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  __m128 fx, floor_fx, y, z;
+  x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+  x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+  // Express exp(x) as 2^n * exp(g), with n = floor(x / ln(2) + 0.5).
+  fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)),
+                  _mm_set1_ps(0.5f));
+  floor_fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  floor_fx = _mm_sub_ps(floor_fx,
+                        _mm_and_ps(_mm_cmpgt_ps(floor_fx, fx), kOne));
+  x = _mm_sub_ps(x, _mm_mul_ps(floor_fx, _mm_set1_ps(0.693359375f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(floor_fx, _mm_set1_ps(-2.12194440E-4f)));
+  z = _mm_mul_ps(x, x);
+
+  y = _mm_set1_ps(1.9875691500E-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), kOne);
+
+  // Build 2^n.
+  {
+    const __m128i n = _mm_add_epi32(_mm_cvttps_epi32(floor_fx),
+                                    _mm_set1_epi32(127));
+    return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+  }
+}
+
+static size_t MagnitudeSpectrumSSE2(const float* fft,
+                                    size_t num_bins,
+                                    float* real,
+                                    float* imag,
+                                    float* magn) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  size_t i;
+
+  for (i = 0; i + 4 <= num_bins; i += 4) {
+    const __m128 a = _mm_loadu_ps(&fft[2 * i]);
+    const __m128 b = _mm_loadu_ps(&fft[2 * i + 4]);
+    const __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+    _mm_storeu_ps(&real[i], re);
+    _mm_storeu_ps(&imag[i], im);
+    _mm_storeu_ps(&magn[i], _mm_add_ps(_mm_sqrt_ps(power), kOne));
+  }
+  return i;
+}
+
+static size_t LogSSE2Loop(const float* in, size_t length, float* out) {
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    _mm_storeu_ps(&out[i], LogSSE2(_mm_loadu_ps(&in[i])));
+  }
+  return i;
+}
+
+static size_t ExpSSE2Loop(const float* in, size_t length, float* out) {
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    _mm_storeu_ps(&out[i], ExpSSE2(_mm_loadu_ps(&in[i])));
+  }
+  return i;
+}
+
+static size_t UpdateQuantileSSE2(const float* lmagn,
+                                 size_t length,
+                                 int counter,
+                                 float* lquantile,
+                                 float* density) {
+  const __m128 kFactor = _mm_set1_ps(FACTOR);
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kSignBit = _mm_set1_ps(-0.f);
+  const __m128 counter_f = _mm_set1_ps((float)counter);
+  const __m128 counter_plus_one_f = _mm_set1_ps((float)(counter + 1));
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 lmagn_v = _mm_loadu_ps(&lmagn[i]);
+    __m128 lquantile_v = _mm_loadu_ps(&lquantile[i]);
+    __m128 density_v = _mm_loadu_ps(&density[i]);
+    // Compute delta.
+    const __m128 dense = _mm_cmpgt_ps(density_v, kOne);
+    const __m128 delta = _mm_or_ps(
+        _mm_and_ps(dense, _mm_div_ps(_mm_mul_ps(kFactor, kOne), density_v)),
+        _mm_andnot_ps(dense, kFactor));
+    // Update log quantile estimate.
+    const __m128 above = _mm_cmpgt_ps(lmagn_v, lquantile_v);
+    const __m128 step_up = _mm_div_ps(
+        _mm_mul_ps(_mm_set1_ps(QUANTILE), delta), counter_plus_one_f);
+    const __m128 step_down = _mm_div_ps(
+        _mm_mul_ps(_mm_set1_ps(1.f - QUANTILE), delta), counter_plus_one_f);
+    __m128 distance, near, new_density;
+    lquantile_v = _mm_or_ps(
+        _mm_and_ps(above, _mm_add_ps(lquantile_v, step_up)),
+        _mm_andnot_ps(above, _mm_sub_ps(lquantile_v, step_down)));
+    // Update density estimate.
+    distance = _mm_andnot_ps(kSignBit, _mm_sub_ps(lmagn_v, lquantile_v));
+    near = _mm_cmplt_ps(distance, _mm_set1_ps(WIDTH));
+    new_density = _mm_div_ps(
+        _mm_add_ps(_mm_mul_ps(counter_f, density_v),
+                   _mm_set1_ps(1.f / (2.f * WIDTH))),
+        counter_plus_one_f);
+    density_v = _mm_or_ps(_mm_and_ps(near, new_density),
+                          _mm_andnot_ps(near, density_v));
+    _mm_storeu_ps(&lquantile[i], lquantile_v);
+    _mm_storeu_ps(&density[i], density_v);
+  }
+  return i;
+}
+
+// Decision-directed estimate of the prior SNR, given the post SNR |post|.
+static __inline __m128 DdPriorSnrSSE2(const float* magn_prev,
+                                      const float* noise_prev,
+                                      const float* smooth,
+                                      __m128 post) {
+  // Previous estimate: based on previous frame with gain filter.
+  const __m128 previous_estimate_stsa = _mm_mul_ps(
+      _mm_div_ps(_mm_loadu_ps(magn_prev),
+                 _mm_add_ps(_mm_loadu_ps(noise_prev), _mm_set1_ps(0.0001f))),
+      _mm_loadu_ps(smooth));
+  return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(DD_PR_SNR), previous_estimate_stsa),
+                    _mm_mul_ps(_mm_set1_ps(1.f - DD_PR_SNR), post));
+}
+
+// Post SNR of |magn| over |noise|, zero where |magn| is the smaller.
+static __inline __m128 PostSnrSSE2(const float* magn, const float* noise) {
+  const __m128 magn_v = _mm_loadu_ps(magn);
+  const __m128 noise_v = _mm_loadu_ps(noise);
+  return _mm_and_ps(
+      _mm_cmpgt_ps(magn_v, noise_v),
+      _mm_sub_ps(_mm_div_ps(magn_v, _mm_add_ps(noise_v, _mm_set1_ps(0.0001f))),
+                 _mm_set1_ps(1.f)));
+}
+
+static size_t ComputeSnrSSE2(const float* magn,
+                             const float* noise,
+                             const float* magnPrev,
+                             const float* noisePrev,
+                             const float* smooth,
+                             size_t length,
+                             float* snrLocPrior,
+                             float* snrLocPost) {
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 post = PostSnrSSE2(&magn[i], &noise[i]);
+    _mm_storeu_ps(&snrLocPost[i], post);
+    _mm_storeu_ps(&snrLocPrior[i], DdPriorSnrSSE2(&magnPrev[i], &noisePrev[i],
+                                                  &smooth[i], post));
+  }
+  return i;
+}
+
+static size_t SumSSE2(const float* in, size_t length, float* sum) {
+  __m128 sum_v = _mm_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    sum_v = _mm_add_ps(sum_v, _mm_loadu_ps(&in[i]));
+  }
+  *sum += HorizontalSum(sum_v);
+  return i;
+}
+
+static size_t CovarianceSSE2(const float* magn,
+                             float avgMagn,
+                             const float* pause,
+                             float avgPause,
+                             size_t length,
+                             float* cov,
+                             float* varPause,
+                             float* varMagn) {
+  const __m128 avg_magn = _mm_set1_ps(avgMagn);
+  const __m128 avg_pause = _mm_set1_ps(avgPause);
+  __m128 cov_v = _mm_setzero_ps();
+  __m128 var_pause_v = _mm_setzero_ps();
+  __m128 var_magn_v = _mm_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 magn_diff = _mm_sub_ps(_mm_loadu_ps(&magn[i]), avg_magn);
+    const __m128 pause_diff = _mm_sub_ps(_mm_loadu_ps(&pause[i]), avg_pause);
+    cov_v = _mm_add_ps(cov_v, _mm_mul_ps(magn_diff, pause_diff));
+    var_pause_v = _mm_add_ps(var_pause_v, _mm_mul_ps(pause_diff, pause_diff));
+    var_magn_v = _mm_add_ps(var_magn_v, _mm_mul_ps(magn_diff, magn_diff));
+  }
+  *cov += HorizontalSum(cov_v);
+  *varPause += HorizontalSum(var_pause_v);
+  *varMagn += HorizontalSum(var_magn_v);
+  return i;
+}
+
+static size_t UpdateLogLrtSSE2(const float* snrLocPrior,
+                               const float* snrLocPost,
+                               size_t length,
+                               float* logLrtTimeAvg,
+                               float* sum) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kTwo = _mm_set1_ps(2.f);
+  const __m128 kEps = _mm_set1_ps(0.0001f);
+  const __m128 kLrtTavg = _mm_set1_ps(LRT_TAVG);
+  __m128 sum_v = _mm_setzero_ps();
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 prior = _mm_loadu_ps(&snrLocPrior[i]);
+    const __m128 tmp1 = _mm_add_ps(kOne, _mm_mul_ps(kTwo, prior));
+    const __m128 tmp2 =
+        _mm_div_ps(_mm_mul_ps(kTwo, prior), _mm_add_ps(tmp1, kEps));
+    const __m128 bessel =
+        _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&snrLocPost[i]), kOne), tmp2);
+    __m128 lrt = _mm_loadu_ps(&logLrtTimeAvg[i]);
+    lrt = _mm_add_ps(
+        lrt, _mm_mul_ps(kLrtTavg, _mm_sub_ps(_mm_sub_ps(bessel, LogSSE2(tmp1)),
+                                             lrt)));
+    _mm_storeu_ps(&logLrtTimeAvg[i], lrt);
+    sum_v = _mm_add_ps(sum_v, lrt);
+  }
+  *sum += HorizontalSum(sum_v);
+  return i;
+}
+
+static size_t SpeechProbabilitySSE2(const float* logLrtTimeAvg,
+                                    float gainPrior,
+                                    size_t length,
+                                    float* probSpeechFinal) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kSignBit = _mm_set1_ps(-0.f);
+  const __m128 gain_prior = _mm_set1_ps(gainPrior);
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 neg_lrt = _mm_xor_ps(_mm_loadu_ps(&logLrtTimeAvg[i]), kSignBit);
+    const __m128 inv_lrt = _mm_mul_ps(gain_prior, ExpSSE2(neg_lrt));
+    _mm_storeu_ps(&probSpeechFinal[i],
+                  _mm_div_ps(kOne, _mm_add_ps(kOne, inv_lrt)));
+  }
+  return i;
+}
+
+// Computes the time-averaged noise update for time constant |gamma|.
+static __inline __m128 NoiseUpdateSSE2(__m128 gamma,
+                                       __m128 prob_speech,
+                                       __m128 magn,
+                                       __m128 noise_prev) {
+  const __m128 prob_non_speech = _mm_sub_ps(_mm_set1_ps(1.f), prob_speech);
+  return _mm_add_ps(
+      _mm_mul_ps(gamma, noise_prev),
+      _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), gamma),
+                 _mm_add_ps(_mm_mul_ps(prob_non_speech, magn),
+                            _mm_mul_ps(prob_speech, noise_prev))));
+}
+
+// The noise update with the time constant of the current bin is only kept
+// when it is smaller than the update with the time constant of the previous
+// bin, and both are equal when the time constants are, so the update is the
+// minimum of the two. This removes the dependency between bins.
+static size_t UpdateNoiseEstimateSSE2(const float* probSpeech,
+                                      const float* magn,
+                                      const float* noisePrev,
+                                      size_t length,
+                                      float* magnAvgPause,
+                                      float* noise) {
+  const __m128 kProbRange = _mm_set1_ps(PROB_RANGE);
+  const __m128 kNoiseUpdate = _mm_set1_ps(NOISE_UPDATE);
+  const __m128 kSpeechUpdate = _mm_set1_ps(SPEECH_UPDATE);
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 prob = _mm_loadu_ps(&probSpeech[i]);
+    const __m128 speech = _mm_cmpgt_ps(prob, kProbRange);
+    const __m128 speech_prev =
+        _mm_cmpgt_ps(_mm_loadu_ps(&probSpeech[i - 1]), kProbRange);
+    const __m128 gamma = _mm_or_ps(_mm_and_ps(speech, kSpeechUpdate),
+                                   _mm_andnot_ps(speech, kNoiseUpdate));
+    const __m128 gamma_old =
+        _mm_or_ps(_mm_and_ps(speech_prev, kSpeechUpdate),
+                  _mm_andnot_ps(speech_prev, kNoiseUpdate));
+    const __m128 magn_v = _mm_loadu_ps(&magn[i]);
+    const __m128 noise_prev = _mm_loadu_ps(&noisePrev[i]);
+    const __m128 noise_update_tmp =
+        NoiseUpdateSSE2(gamma_old, prob, magn_v, noise_prev);
+    const __m128 noise_new = NoiseUpdateSSE2(gamma, prob, magn_v, noise_prev);
+    // Conservative noise update.
+    const __m128 pause = _mm_cmplt_ps(prob, kProbRange);
+    __m128 avg_pause = _mm_loadu_ps(&magnAvgPause[i]);
+    avg_pause = _mm_add_ps(
+        avg_pause,
+        _mm_and_ps(pause, _mm_mul_ps(_mm_set1_ps(GAMMA_PAUSE),
+                                     _mm_sub_ps(magn_v, avg_pause))));
+    _mm_storeu_ps(&magnAvgPause[i], avg_pause);
+    _mm_storeu_ps(&noise[i], _mm_min_ps(noise_update_tmp, noise_new));
+  }
+  return i;
+}
+
+static size_t ComputeWienerFilterSSE2(const float* magn,
+                                      const float* noise,
+                                      const float* magnPrev,
+                                      const float* noisePrev,
+                                      const float* smooth,
+                                      float overdrive,
+                                      size_t length,
+                                      float* theFilter) {
+  const __m128 overdrive_v = _mm_set1_ps(overdrive);
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    const __m128 snr_prior =
+        DdPriorSnrSSE2(&magnPrev[i], &noisePrev[i], &smooth[i],
+                       PostSnrSSE2(&magn[i], &noise[i]));
+    // Gain filter.
+    _mm_storeu_ps(&theFilter[i],
+                  _mm_div_ps(snr_prior, _mm_add_ps(overdrive_v, snr_prior)));
+  }
+  return i;
+}
+
+static size_t ApplyWienerFilterSSE2(float denoiseBound,
+                                    size_t length,
+                                    float* theFilter,
+                                    float* smooth,
+                                    float* real,
+                                    float* imag) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 denoise_bound = _mm_set1_ps(denoiseBound);
+  size_t i;
+
+  for (i = 0; i + 4 <= length; i += 4) {
+    // Flooring bottom and top.
+    const __m128 filter =
+        _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&theFilter[i]), denoise_bound),
+                   kOne);
+    _mm_storeu_ps(&theFilter[i], filter);
+    _mm_storeu_ps(&smooth[i], filter);
+    _mm_storeu_ps(&real[i], _mm_mul_ps(_mm_loadu_ps(&real[i]), filter));
+    _mm_storeu_ps(&imag[i], _mm_mul_ps(_mm_loadu_ps(&imag[i]), filter));
+  }
+  return i;
+}
+
+void WebRtcNs_InitSSE2(void) {
+  WebRtcNs_MagnitudeSpectrum = MagnitudeSpectrumSSE2;
+  WebRtcNs_Log = LogSSE2Loop;
+  WebRtcNs_Exp = ExpSSE2Loop;
+  WebRtcNs_UpdateQuantile = UpdateQuantileSSE2;
+  WebRtcNs_ComputeSnr = ComputeSnrSSE2;
+  WebRtcNs_Sum = SumSSE2;
+  WebRtcNs_Covariance = CovarianceSSE2;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtSSE2;
+  WebRtcNs_SpeechProbability = SpeechProbabilitySSE2;
+  WebRtcNs_UpdateNoiseEstimate = UpdateNoiseEstimateSSE2;
+  WebRtcNs_ComputeWienerFilter = ComputeWienerFilterSSE2;
+  WebRtcNs_ApplyWienerFilter = ApplyWienerFilterSSE2;
+}
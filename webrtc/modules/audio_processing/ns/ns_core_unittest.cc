@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Verifies that the SSE2 and AVX2 versions of the noise suppression loops stay
+// close to the generic C version. They are not bitexact because of the log and
+// exp approximations and the fused multiply-adds.
+
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/ns/include/noise_suppression.h"
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+namespace webrtc {
+namespace {
+
+enum Implementation { kGeneric, kSse2, kAvx2 };
+
+WebRtc_CPUInfo g_get_cpu_info = nullptr;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  if (feature == kAVX2 || feature == kFMA) {
+    return 0;
+  }
+  return g_get_cpu_info(feature);
+}
+
+bool IsSupported(Implementation implementation) {
+  switch (implementation) {
+    case kGeneric:
+      return true;
+    case kSse2:
+      return WebRtc_GetCPUInfo(kSSE2) != 0;
+    case kAvx2:
+      return WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA);
+  }
+  return false;
+}
+
+// Makes the next WebRtcNs_Init() select |implementation|. Must be undone with
+// RestoreCPUInfo().
+void SelectImplementation(Implementation implementation) {
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  if (implementation == kGeneric) {
+    WebRtc_GetCPUInfo = WebRtc_GetCPUInfoNoASM;
+  } else if (implementation == kSse2) {
+    WebRtc_GetCPUInfo = GetCPUInfoNoAVX2;
+  }
+}
+
+void RestoreCPUInfo() {
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+}
+
+// Generates a tone with a syllable-like envelope on top of white noise, in
+// the 16-bit range the noise suppressor expects.
+void GenerateSignal(int sample_rate_hz, size_t length, float* signal) {
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; ++i) {
+    const float t = static_cast<float>(i) / sample_rate_hz;
+    const float envelope = std::max(0.f, sinf(2.f * 3.14159f * 2.f * t));
+    seed = seed * 1664525 + 1013904223;
+    const float noise = static_cast<float>(seed >> 8) / (1 << 23) - 1.f;
+    signal[i] = 3000.f * envelope * sinf(2.f * 3.14159f * 300.f * t) +
+                300.f * noise;
+  }
+}
+
+// Runs the noise suppressor on the full-band |input| split into |num_bands|
+// bands by decimation, which is good enough to exercise all code paths.
+std::vector<float> RunNoiseSuppression(Implementation implementation,
+                                       int sample_rate_hz,
+                                       size_t num_bands,
+                                       const std::vector<float>& input,
+                                       float* speech_probability) {
+  const size_t kFrameLength = static_cast<size_t>(sample_rate_hz / 100);
+  const size_t kBandLength = kFrameLength / num_bands;
+  std::vector<float> output(input.size());
+  SelectImplementation(implementation);
+  NsHandle* ns = WebRtcNs_Create();
+  EXPECT_EQ(0, WebRtcNs_Init(ns, sample_rate_hz));
+  EXPECT_EQ(0, WebRtcNs_set_policy(ns, 2));
+  RestoreCPUInfo();
+
+  *speech_probability = 0.f;
+  std::vector<float> bands(kFrameLength);
+  std::vector<float> out_bands(kFrameLength);
+  const float* in_ptrs[NUM_HIGH_BANDS_MAX + 1];
+  float* out_ptrs[NUM_HIGH_BANDS_MAX + 1];
+  for (size_t b = 0; b < num_bands; ++b) {
+    in_ptrs[b] = &bands[b * kBandLength];
+    out_ptrs[b] = &out_bands[b * kBandLength];
+  }
+  for (size_t start = 0; start + kFrameLength <= input.size();
+       start += kFrameLength) {
+    for (size_t b = 0; b < num_bands; ++b) {
+      for (size_t i = 0; i < kBandLength; ++i) {
+        bands[b * kBandLength + i] = input[start + i * num_bands + b];
+      }
+    }
+    WebRtcNs_Analyze(ns, in_ptrs[0]);
+    WebRtcNs_Process(ns, in_ptrs, num_bands, out_ptrs);
+    *speech_probability += WebRtcNs_prior_speech_probability(ns);
+    std::copy(out_bands.begin(), out_bands.end(), output.begin() + start);
+  }
+  WebRtcNs_Free(ns);
+  return output;
+}
+
+// The APM reference tests run the generic version through
+// WebRtcNs_SetBitexact(). For everything else, keep the SIMD versions an order
+// of magnitude inside the 0.0005 those tests allow on the average speech
+// probability.
+const float kSpeechProbabilityTolerance = 5e-5f;
+
+void VerifyMatchesGeneric(int sample_rate_hz, size_t num_bands) {
+  const size_t kNumFrames = 1000;
+  std::vector<float> input(kNumFrames * sample_rate_hz / 100);
+  GenerateSignal(sample_rate_hz, input.size(), &input[0]);
+
+  float reference_probability;
+  const std::vector<float> reference = RunNoiseSuppression(
+      kGeneric, sample_rate_hz, num_bands, input, &reference_probability);
+  double output_energy = 0.0;
+  for (float sample : reference) {
+    output_energy += sample * sample;
+  }
+  ASSERT_GT(output_energy, 0.0);
+
+  const Implementation kImplementations[] = {kSse2, kAvx2};
+  for (Implementation implementation : kImplementations) {
+    if (!IsSupported(implementation)) {
+      continue;
+    }
+    SCOPED_TRACE(implementation == kSse2 ? "SSE2" : "AVX2");
+    float probability;
+    const std::vector<float> output = RunNoiseSuppression(
+        implementation, sample_rate_hz, num_bands, input, &probability);
+    double error_energy = 0.0;
+    for (size_t i = 0; i < output.size(); ++i) {
+      const float error = output[i] - reference[i];
+      error_energy += error * error;
+    }
+    EXPECT_LT(10.0 * log10(error_energy / output_energy + 1e-20), -80.0);
+    EXPECT_NEAR(reference_probability / kNumFrames, probability / kNumFrames,
+                kSpeechProbabilityTolerance);
+  }
+}
+
+}  // namespace
+
+TEST(NsCoreTest, LogAndExpAreAccurate) {
+  const size_t kLength = 1003;
+  std::vector<float> log_in(kLength);
+  std::vector<float> exp_in(kLength);
+  std::vector<float> out(kLength);
+  for (size_t i = 0; i < kLength; ++i) {
+    // Covers the range of the magnitude spectrum and the log quantiles.
+    log_in[i] = 1.f + powf(1.02f, static_cast<float>(i)) * 0.01f;
+    exp_in[i] = (static_cast<float>(i) - kLength / 2.f) * 0.08f;
+  }
+
+  const Implementation kImplementations[] = {kSse2, kAvx2};
+  for (Implementation implementation : kImplementations) {
+    if (!IsSupported(implementation)) {
+      continue;
+    }
+    SCOPED_TRACE(implementation == kSse2 ? "SSE2" : "AVX2");
+    if (implementation == kSse2) {
+      WebRtcNs_InitSSE2();
+    } else {
+      WebRtcNs_InitAVX2();
+    }
+
+    // The kernels leave the last kLength % 8 elements to the generic code.
+    const size_t num_logs = WebRtcNs_Log(&log_in[0], kLength, &out[0]);
+    EXPECT_LT(kLength - num_logs, 8u);
+    for (size_t i = 0; i < num_logs; ++i) {
+      const float reference = static_cast<float>(log(log_in[i]));
+      EXPECT_NEAR(reference, out[i], 2e-7f * std::max(1.f, fabsf(reference)))
+          << "log at index " << i;
+    }
+
+    const size_t num_exps = WebRtcNs_Exp(&exp_in[0], kLength, &out[0]);
+    EXPECT_LT(kLength - num_exps, 8u);
+    for (size_t i = 0; i < num_exps; ++i) {
+      const float reference = static_cast<float>(exp(exp_in[i]));
+      EXPECT_NEAR(reference, out[i], 4e-7f * reference)
+          << "exp at index " << i;
+    }
+  }
+}
+
+TEST(NsCoreTest, BitexactSelectsGeneric) {
+  const int kSampleRateHz = 16000;
+  std::vector<float> input(100 * kSampleRateHz / 100);
+  GenerateSignal(kSampleRateHz, input.size(), &input[0]);
+  float reference_probability;
+  const std::vector<float> reference = RunNoiseSuppression(
+      kGeneric, kSampleRateHz, 1, input, &reference_probability);
+
+  WebRtcNs_SetBitexact(1);
+  float probability;
+  const std::vector<float> output =
+      RunNoiseSuppression(kAvx2, kSampleRateHz, 1, input, &probability);
+  WebRtcNs_SetBitexact(0);
+  EXPECT_TRUE(output == reference);
+  EXPECT_EQ(reference_probability, probability);
+}
+
+TEST(NsCoreTest, ProcessedOutputMatchesGeneric8kHz) {
+  VerifyMatchesGeneric(8000, 1);
+}
+
+TEST(NsCoreTest, ProcessedOutputMatchesGeneric16kHz) {
+  VerifyMatchesGeneric(16000, 1);
+}
+
+TEST(NsCoreTest, ProcessedOutputMatchesGeneric32kHz) {
+  VerifyMatchesGeneric(32000, 2);
+}
+
+TEST(NsCoreTest, ProcessedOutputMatchesGeneric48kHz) {
+  VerifyMatchesGeneric(48000, 3);
+}
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
@@ -62,8 +62,8 @@ void SplittingFilter::TwoBandsAnalysis(const IFChannelBuffer* data,
   for (size_t i = 0; i < two_bands_states_.size(); ++i) {
     WebRtcSpl_AnalysisQMF(data->ibuf_const()->channels()[i],
                           data->num_frames(),
-                          bands->ibuf()->channels(0)[i],
-                          bands->ibuf()->channels(1)[i],
+                          bands->ibuf_for_overwrite()->channels(0)[i],
+                          bands->ibuf_for_overwrite()->channels(1)[i],
                           two_bands_states_[i].analysis_state1,
                           two_bands_states_[i].analysis_state2);
   }
@@ -76,7 +76,7 @@ void SplittingFilter::TwoBandsSynthesis(const IFChannelBuffer* bands,
     WebRtcSpl_SynthesisQMF(bands->ibuf_const()->channels(0)[i],
                            bands->ibuf_const()->channels(1)[i],
                            bands->num_frames_per_band(),
-                           data->ibuf()->channels()[i],
+                           data->ibuf_for_overwrite()->channels()[i],
                            two_bands_states_[i].synthesis_state1,
                            two_bands_states_[i].synthesis_state2);
   }
@@ -86,10 +86,11 @@ void SplittingFilter::ThreeBandsAnalysis(const IFChannelBuffer* data,
                                          IFChannelBuffer* bands) {
   DCHECK_EQ(static_cast<int>(three_band_filter_banks_.size()),
             data->num_channels());
+  ChannelBuffer<float>* band_buffer = bands->fbuf_for_overwrite();
   for (size_t i = 0; i < three_band_filter_banks_.size(); ++i) {
     three_band_filter_banks_[i]->Analysis(data->fbuf_const()->channels()[i],
                                           data->num_frames(),
-                                          bands->fbuf()->bands(i));
+                                          band_buffer->bands(i));
   }
 }
 
@@ -97,10 +98,11 @@ void SplittingFilter::ThreeBandsSynthesis(const IFChannelBuffer* bands,
                                           IFChannelBuffer* data) {
   DCHECK_EQ(static_cast<int>(three_band_filter_banks_.size()),
             data->num_channels());
+  float* const* channels = data->fbuf_for_overwrite()->channels();
   for (size_t i = 0; i < three_band_filter_banks_.size(); ++i) {
     three_band_filter_banks_[i]->Synthesis(bands->fbuf_const()->bands(i),
                                            bands->num_frames_per_band(),
-                                           data->fbuf()->channels()[i]);
+                                           channels[i]);
   }
 }
 
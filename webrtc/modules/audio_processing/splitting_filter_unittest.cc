@@ -12,10 +12,15 @@
 #define _USE_MATH_DEFINES
 
 #include <cmath>
+#include <cstdio>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/common_audio/sparse_fir_filter.h"
 #include "webrtc/modules/audio_processing/splitting_filter.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 namespace {
@@ -23,6 +28,155 @@ namespace {
 const size_t kSamplesPer16kHzChannel = 160;
 const size_t kSamplesPer48kHzChannel = 480;
 
+// The fused kernels of ThreeBandFilterBank do the same operations in the same
+// order as the reference, so only a compiler contracting them into fused
+// multiply-adds makes them differ.
+const float kTolerance = 1e-3f;
+
+// The 3-band filter bank as a set of SparseFIRFilters followed by a separate
+// DCT modulation, to verify the fused kernels of ThreeBandFilterBank.
+class ReferenceThreeBandFilterBank {
+ public:
+  explicit ReferenceThreeBandFilterBank(size_t length)
+      : in_buffer_(length / kNumBands), out_buffer_(in_buffer_.size()) {
+    for (size_t i = 0; i < kSparsity; ++i) {
+      for (size_t j = 0; j < kNumBands; ++j) {
+        analysis_filters_.push_back(new SparseFIRFilter(
+            kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i));
+        synthesis_filters_.push_back(new SparseFIRFilter(
+            kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i));
+      }
+    }
+    for (size_t i = 0; i < kNumBands * kSparsity; ++i) {
+      for (size_t j = 0; j < kNumBands; ++j) {
+        dct_modulation_[i][j] = 2.f * cos(2.f * M_PI * i * (2.f * j + 1.f) /
+                                          (kNumBands * kSparsity));
+      }
+    }
+  }
+
+  void Analysis(const float* in, float* const* out) {
+    const size_t split_length = in_buffer_.size();
+    for (size_t i = 0; i < kNumBands; ++i) {
+      memset(out[i], 0, split_length * sizeof(*out[i]));
+    }
+    for (size_t i = 0; i < kNumBands; ++i) {
+      for (size_t k = 0; k < split_length; ++k) {
+        in_buffer_[k] = in[kNumBands * k + kNumBands - i - 1];
+      }
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        analysis_filters_[offset]->Filter(&in_buffer_[0], split_length,
+                                          &out_buffer_[0]);
+        for (size_t b = 0; b < kNumBands; ++b) {
+          for (size_t k = 0; k < split_length; ++k) {
+            out[b][k] += dct_modulation_[offset][b] * out_buffer_[k];
+          }
+        }
+      }
+    }
+  }
+
+  void Synthesis(const float* const* in, float* out) {
+    const size_t split_length = in_buffer_.size();
+    memset(out, 0, kNumBands * split_length * sizeof(*out));
+    for (size_t i = 0; i < kNumBands; ++i) {
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        memset(&in_buffer_[0], 0, split_length * sizeof(in_buffer_[0]));
+        for (size_t b = 0; b < kNumBands; ++b) {
+          for (size_t k = 0; k < split_length; ++k) {
+            in_buffer_[k] += dct_modulation_[offset][b] * in[b][k];
+          }
+        }
+        synthesis_filters_[offset]->Filter(&in_buffer_[0], split_length,
+                                           &out_buffer_[0]);
+        for (size_t k = 0; k < split_length; ++k) {
+          out[kNumBands * k + i] += kNumBands * out_buffer_[k];
+        }
+      }
+    }
+  }
+
+ private:
+  static const size_t kNumBands = 3;
+  static const size_t kSparsity = 4;
+  static const size_t kNumCoeffs = 4;
+  static const float kLowpassCoeffs[kNumBands * kSparsity][kNumCoeffs];
+
+  std::vector<float> in_buffer_;
+  std::vector<float> out_buffer_;
+  ScopedVector<SparseFIRFilter> analysis_filters_;
+  ScopedVector<SparseFIRFilter> synthesis_filters_;
+  float dct_modulation_[kNumBands * kSparsity][kNumBands];
+};
+
+const float ReferenceThreeBandFilterBank::kLowpassCoeffs[][kNumCoeffs] =
+    {{-0.00047749f, -0.00496888f, +0.16547118f, +0.00425496f},
+     {-0.00173287f, -0.01585778f, +0.14989004f, +0.00994113f},
+     {-0.00304815f, -0.02536082f, +0.12154542f, +0.01157993f},
+     {-0.00383509f, -0.02982767f, +0.08543175f, +0.00983212f},
+     {-0.00346946f, -0.02587886f, +0.04760441f, +0.00607594f},
+     {-0.00154717f, -0.01136076f, +0.01387458f, +0.00186353f},
+     {+0.00186353f, +0.01387458f, -0.01136076f, -0.00154717f},
+     {+0.00607594f, +0.04760441f, -0.02587886f, -0.00346946f},
+     {+0.00983212f, +0.08543175f, -0.02982767f, -0.00383509f},
+     {+0.01157993f, +0.12154542f, -0.02536082f, -0.00304815f},
+     {+0.00994113f, +0.14989004f, -0.01585778f, -0.00173287f},
+     {+0.00425496f, +0.16547118f, -0.00496888f, -0.00047749f}};
+
+// Fills every channel of |buffer| with a different FloatS16 signal, mixing
+// tones in the three bands with noise.
+void GenerateChunk(size_t chunk_index, ChannelBuffer<float>* buffer) {
+  for (int ch = 0; ch < buffer->num_channels(); ++ch) {
+    uint32_t seed = 1 + 7919 * ch + 104729 * static_cast<uint32_t>(chunk_index);
+    for (size_t i = 0; i < buffer->num_frames(); ++i) {
+      seed = seed * 1664525 + 1013904223;
+      const float t = static_cast<float>(chunk_index * buffer->num_frames() +
+                                         i) / 48000.f;
+      const float noise = static_cast<float>(seed >> 16) - 32768.f;
+      buffer->channels()[ch][i] =
+          4000.f * sinf(2.f * static_cast<float>(M_PI) * (900.f + 100.f * ch) *
+                        t) +
+          3000.f * sinf(2.f * static_cast<float>(M_PI) * 12500.f * t) +
+          2000.f * sinf(2.f * static_cast<float>(M_PI) * 19000.f * t) +
+          0.05f * noise;
+    }
+  }
+}
+
+// Runs |kChunks| chunks of |length| samples through a ThreeBandFilterBank and
+// the reference, and verifies that the bands and reconstructions match.
+void VerifyThreeBandFilterBankMatchesReference(size_t length) {
+  static const size_t kChunks = 20;
+  static const size_t kNumBands = 3;
+  ThreeBandFilterBank filter_bank(length);
+  ReferenceThreeBandFilterBank reference(length);
+  ChannelBuffer<float> in(length, 1);
+  ChannelBuffer<float> bands(length, 1, kNumBands);
+  ChannelBuffer<float> reference_bands(length, 1, kNumBands);
+  std::vector<float> out(length);
+  std::vector<float> reference_out(length);
+  for (size_t chunk = 0; chunk < kChunks; ++chunk) {
+    GenerateChunk(chunk, &in);
+    filter_bank.Analysis(in.channels()[0], length, bands.bands(0));
+    reference.Analysis(in.channels()[0], reference_bands.bands(0));
+    for (size_t b = 0; b < kNumBands; ++b) {
+      for (size_t i = 0; i < length / kNumBands; ++i) {
+        ASSERT_NEAR(reference_bands.bands(0)[b][i], bands.bands(0)[b][i],
+                    kTolerance)
+            << "chunk " << chunk << ", band " << b << ", sample " << i;
+      }
+    }
+    filter_bank.Synthesis(bands.bands(0), length / kNumBands, &out[0]);
+    reference.Synthesis(reference_bands.bands(0), &reference_out[0]);
+    for (size_t i = 0; i < length; ++i) {
+      ASSERT_NEAR(reference_out[i], out[i], kTolerance)
+          << "chunk " << chunk << ", sample " << i;
+    }
+  }
+}
+
 }  // namespace
 
 // Generates a signal from presence or absence of sine waves of different
@@ -103,4 +257,96 @@ TEST(SplittingFilterTest, SplitsIntoThreeBandsAndReconstructs) {
   }
 }
 
+// The length of a 10 ms chunk at 48 kHz uses the vectorized kernels where
+// available, while lengths which are not a multiple of 4 per band use the
+// generic ones.
+TEST(ThreeBandFilterBankTest, MatchesSparseFirReference) {
+  VerifyThreeBandFilterBankMatchesReference(kSamplesPer48kHzChannel);
+  VerifyThreeBandFilterBankMatchesReference(30);
+  VerifyThreeBandFilterBankMatchesReference(3);
+}
+
+TEST(SplittingFilterTest, ThreeBandsMatchReferenceForAllChannels) {
+  static const int kChannels = 2;
+  static const size_t kNumBands = 3;
+  static const size_t kChunks = 20;
+  SplittingFilter splitting_filter(kChannels, kNumBands,
+                                   kSamplesPer48kHzChannel);
+  ScopedVector<ReferenceThreeBandFilterBank> references;
+  for (int ch = 0; ch < kChannels; ++ch) {
+    references.push_back(
+        new ReferenceThreeBandFilterBank(kSamplesPer48kHzChannel));
+  }
+  IFChannelBuffer in_data(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  IFChannelBuffer bands(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  IFChannelBuffer out_data(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  ChannelBuffer<float> reference_bands(kSamplesPer48kHzChannel, kChannels,
+                                       kNumBands);
+  std::vector<float> reference_out(kSamplesPer48kHzChannel);
+  for (size_t chunk = 0; chunk < kChunks; ++chunk) {
+    GenerateChunk(chunk, in_data.fbuf());
+    splitting_filter.Analysis(&in_data, &bands);
+    splitting_filter.Synthesis(&bands, &out_data);
+    for (int ch = 0; ch < kChannels; ++ch) {
+      references[ch]->Analysis(in_data.fbuf_const()->channels()[ch],
+                               reference_bands.bands(ch));
+      for (size_t b = 0; b < kNumBands; ++b) {
+        for (size_t i = 0; i < kSamplesPer16kHzChannel; ++i) {
+          ASSERT_NEAR(reference_bands.channels(b)[ch][i],
+                      bands.fbuf_const()->channels(b)[ch][i], kTolerance);
+        }
+      }
+      references[ch]->Synthesis(reference_bands.bands(ch), &reference_out[0]);
+      for (size_t i = 0; i < kSamplesPer48kHzChannel; ++i) {
+        ASSERT_NEAR(reference_out[i], out_data.fbuf_const()->channels()[ch][i],
+                    kTolerance);
+      }
+    }
+  }
+}
+
+// Prints the cost of splitting and merging one 10 ms stereo chunk at 48 kHz.
+TEST(SplittingFilterTest, DISABLED_ThreeBandsBenchmark) {
+  static const int kChannels = 2;
+  static const size_t kNumBands = 3;
+  static const int kNumIterations = 100000;
+  SplittingFilter splitting_filter(kChannels, kNumBands,
+                                   kSamplesPer48kHzChannel);
+  ScopedVector<ReferenceThreeBandFilterBank> references;
+  for (int ch = 0; ch < kChannels; ++ch) {
+    references.push_back(
+        new ReferenceThreeBandFilterBank(kSamplesPer48kHzChannel));
+  }
+  IFChannelBuffer in_data(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  IFChannelBuffer bands(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  IFChannelBuffer out_data(kSamplesPer48kHzChannel, kChannels, kNumBands);
+  ChannelBuffer<float> reference_bands(kSamplesPer48kHzChannel, kChannels,
+                                       kNumBands);
+  std::vector<float> reference_out(kSamplesPer48kHzChannel);
+  GenerateChunk(0, in_data.fbuf());
+
+  TickTime start = TickTime::Now();
+  for (int n = 0; n < kNumIterations; ++n) {
+    for (int ch = 0; ch < kChannels; ++ch) {
+      references[ch]->Analysis(in_data.fbuf_const()->channels()[ch],
+                               reference_bands.bands(ch));
+      references[ch]->Synthesis(reference_bands.bands(ch), &reference_out[0]);
+    }
+  }
+  const int64_t reference_us = (TickTime::Now() - start).Microseconds();
+
+  start = TickTime::Now();
+  for (int n = 0; n < kNumIterations; ++n) {
+    splitting_filter.Analysis(&in_data, &bands);
+    splitting_filter.Synthesis(&bands, &out_data);
+  }
+  const int64_t fused_us = (TickTime::Now() - start).Microseconds();
+
+  printf("Reference: %.3f us per frame\n",
+         static_cast<double>(reference_us) / kNumIterations);
+  printf("Fused: %.3f us per frame (%.2fx)\n",
+         static_cast<double>(fused_us) / kNumIterations,
+         static_cast<double>(reference_us) / fused_us);
+}
+
 }  // namespace webrtc
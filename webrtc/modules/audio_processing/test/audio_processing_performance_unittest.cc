@@ -0,0 +1,340 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/config.h"
+#include "webrtc/modules/audio_processing/batch_audio_processing.h"
+#include "webrtc/modules/audio_processing/include/audio_processing.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumFrames = 1000;
+// How many 10 ms chunks the render thread may run ahead of the capture
+// thread. Keeps the two threads loosely coupled, as with real audio devices.
+const int kMaxRenderLead = 2;
+
+// Fills |buffer| with a tone plus deterministic pseudo-random noise.
+void GenerateSignal(int frame_index,
+                    int sample_rate_hz,
+                    float frequency_hz,
+                    ChannelBuffer<float>* buffer) {
+  uint32_t seed = 17 + frame_index;
+  for (int ch = 0; ch < buffer->num_channels(); ++ch) {
+    float* channel = buffer->channels()[ch];
+    for (size_t i = 0; i < buffer->num_frames(); ++i) {
+      seed = seed * 1664525 + 1013904223;
+      const float t = static_cast<float>(frame_index * buffer->num_frames() +
+                                         i) / sample_rate_hz;
+      channel[i] = 0.3f * sinf(2.f * static_cast<float>(M_PI) * frequency_hz *
+                               t) +
+                   0.01f * (static_cast<float>(seed >> 16) / 65536.f - 0.5f);
+    }
+  }
+}
+
+// Runs AnalyzeReverseStream() on a separate thread while the test thread runs
+// ProcessStream(), and records the duration of every capture call.
+class ConcurrentApmRunner {
+ public:
+  ConcurrentApmRunner(int sample_rate_hz, int num_channels)
+      : sample_rate_hz_(sample_rate_hz),
+        stream_config_(sample_rate_hz, num_channels),
+        render_buffer_(stream_config_.num_frames(), num_channels),
+        capture_buffer_(stream_config_.num_frames(), num_channels),
+        num_render_frames_(0),
+        num_capture_frames_(0),
+        render_error_(AudioProcessing::kNoError) {
+    Config config;
+    config.Set<ExtendedFilter>(new ExtendedFilter(true));
+    apm_.reset(AudioProcessing::Create(config));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->echo_cancellation()->Enable(true));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->gain_control()->set_mode(GainControl::kAdaptiveDigital));
+    EXPECT_EQ(AudioProcessing::kNoError, apm_->gain_control()->Enable(true));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->noise_suppression()->Enable(true));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->high_pass_filter()->Enable(true));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->voice_detection()->Enable(true));
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm_->level_estimator()->Enable(true));
+  }
+
+  // Returns the ProcessStream() durations in microseconds.
+  std::vector<int64_t> Run() {
+    std::vector<int64_t> durations_us;
+    durations_us.reserve(kNumFrames);
+
+    rtc::scoped_ptr<ThreadWrapper> render_thread = ThreadWrapper::CreateThread(
+        &ConcurrentApmRunner::RenderThreadFunc, this, "apm_render");
+    EXPECT_TRUE(render_thread->Start());
+
+    for (int i = 0; i < kNumFrames; ++i) {
+      GenerateSignal(i, sample_rate_hz_, 440.f, &capture_buffer_);
+      const int64_t start_us = TickTime::MicrosecondTimestamp();
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apm_->set_stream_delay_ms(0));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apm_->ProcessStream(capture_buffer_.channels(), stream_config_,
+                                    stream_config_,
+                                    capture_buffer_.channels()));
+      durations_us.push_back(TickTime::MicrosecondTimestamp() - start_us);
+      rtc::AtomicOps::Increment(&num_capture_frames_);
+    }
+
+    EXPECT_TRUE(render_thread->Stop());
+    EXPECT_EQ(AudioProcessing::kNoError, render_error_);
+    return durations_us;
+  }
+
+ private:
+  static bool RenderThreadFunc(void* context) {
+    return static_cast<ConcurrentApmRunner*>(context)->ProcessRender();
+  }
+
+  bool ProcessRender() {
+    const int num_capture_frames =
+        rtc::AtomicOps::AcquireLoad(&num_capture_frames_);
+    if (num_capture_frames >= kNumFrames) {
+      return false;
+    }
+    if (num_render_frames_ >= num_capture_frames + kMaxRenderLead) {
+      // Let the capture thread catch up.
+      SleepMs(0);
+      return true;
+    }
+
+    GenerateSignal(num_render_frames_, sample_rate_hz_, 300.f,
+                   &render_buffer_);
+    const int err = apm_->ProcessReverseStream(
+        render_buffer_.channels(), stream_config_, stream_config_,
+        render_buffer_.channels());
+    if (err != AudioProcessing::kNoError) {
+      render_error_ = err;
+      return false;
+    }
+    ++num_render_frames_;
+    return true;
+  }
+
+  const int sample_rate_hz_;
+  const StreamConfig stream_config_;
+  rtc::scoped_ptr<AudioProcessing> apm_;
+  ChannelBuffer<float> render_buffer_;
+  ChannelBuffer<float> capture_buffer_;
+  // Only accessed on the render thread.
+  int num_render_frames_;
+  volatile int num_capture_frames_;
+  int render_error_;
+};
+
+void RunConcurrentTest(int sample_rate_hz, int num_channels) {
+  ConcurrentApmRunner runner(sample_rate_hz, num_channels);
+  std::vector<int64_t> durations_us = runner.Run();
+  ASSERT_EQ(static_cast<size_t>(kNumFrames), durations_us.size());
+
+  int64_t sum_us = 0;
+  for (int64_t duration_us : durations_us) {
+    sum_us += duration_us;
+  }
+  std::sort(durations_us.begin(), durations_us.end());
+
+  std::ostringstream trace;
+  trace << sample_rate_hz / 1000 << "kHz_" << num_channels << "ch";
+  test::PrintResult("apm_concurrent_process_stream", "_mean", trace.str(),
+                    static_cast<size_t>(sum_us / kNumFrames), "us", false);
+  test::PrintResult("apm_concurrent_process_stream", "_99th_percentile",
+                    trace.str(),
+                    static_cast<size_t>(durations_us[kNumFrames * 99 / 100]),
+                    "us", false);
+  test::PrintResult("apm_concurrent_process_stream", "_max", trace.str(),
+                    static_cast<size_t>(durations_us.back()), "us", true);
+}
+
+WebRtc_CPUInfo g_get_cpu_info = nullptr;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  if (feature == kAVX2 || feature == kFMA) {
+    return 0;
+  }
+  return g_get_cpu_info(feature);
+}
+
+// Returns the mean ProcessStream() duration in microseconds with only the
+// noise suppressor enabled. The kernels are selected when the noise suppressor
+// is initialized, i.e. with the CPU features visible at that time.
+int64_t MeasureNoiseSuppression(WebRtc_CPUInfo get_cpu_info) {
+  const int kSampleRateHz = AudioProcessing::kSampleRate48kHz;
+  const StreamConfig stream_config(kSampleRateHz, 1);
+  ChannelBuffer<float> buffer(stream_config.num_frames(), 1);
+
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  WebRtc_GetCPUInfo = get_cpu_info;
+  rtc::scoped_ptr<AudioProcessing> apm(AudioProcessing::Create());
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->set_level(NoiseSuppression::kHigh));
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->Enable(true));
+  // Initializes the noise suppressor with the masked CPU features.
+  GenerateSignal(0, kSampleRateHz, 440.f, &buffer);
+  EXPECT_EQ(AudioProcessing::kNoError,
+            apm->ProcessStream(buffer.channels(), stream_config, stream_config,
+                               buffer.channels()));
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+
+  int64_t sum_us = 0;
+  for (int i = 1; i <= kNumFrames; ++i) {
+    GenerateSignal(i, kSampleRateHz, 440.f, &buffer);
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    EXPECT_EQ(AudioProcessing::kNoError,
+              apm->ProcessStream(buffer.channels(), stream_config,
+                                 stream_config, buffer.channels()));
+    sum_us += TickTime::MicrosecondTimestamp() - start_us;
+  }
+  return sum_us / kNumFrames;
+}
+
+// Returns how many mono streams one core can clean up in real time with high-pass
+// filter, noise suppression, adaptive digital AGC and voice detection, either
+// with one AudioProcessing per stream or with BatchAudioProcessing.
+int StreamsPerCore(int sample_rate_hz, bool batched) {
+  const int kNumStreams = 64;
+  const int kNumChunks = 200;
+  const StreamConfig stream_config(sample_rate_hz, 1);
+  ChannelBuffer<float> buffer(stream_config.num_frames(), kNumStreams);
+
+  BatchAudioProcessing::Config batch_config;
+  batch_config.sample_rate_hz = sample_rate_hz;
+  batch_config.num_streams = kNumStreams;
+  rtc::scoped_ptr<BatchAudioProcessing> batch;
+  ScopedVector<AudioProcessing> apms;
+  if (batched) {
+    batch.reset(BatchAudioProcessing::Create(batch_config));
+  } else {
+    Config config;
+    config.Set<ExperimentalAgc>(new ExperimentalAgc(false));
+    for (int i = 0; i < kNumStreams; ++i) {
+      apms.push_back(AudioProcessing::Create(config));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apms.back()->high_pass_filter()->Enable(true));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apms.back()->noise_suppression()->Enable(true));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apms.back()->gain_control()->set_mode(
+                    GainControl::kAdaptiveDigital));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apms.back()->gain_control()->Enable(true));
+      EXPECT_EQ(AudioProcessing::kNoError,
+                apms.back()->voice_detection()->Enable(true));
+    }
+  }
+
+  int64_t sum_us = 0;
+  for (int i = 0; i < kNumChunks; ++i) {
+    GenerateSignal(i, sample_rate_hz, 440.f, &buffer);
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    if (batched) {
+      EXPECT_EQ(AudioProcessing::kNoError,
+                batch->ProcessStreams(buffer.channels()));
+    } else {
+      for (int j = 0; j < kNumStreams; ++j) {
+        float* stream = buffer.channels()[j];
+        EXPECT_EQ(AudioProcessing::kNoError,
+                  apms[j]->ProcessStream(&stream, stream_config,
+                                         stream_config, &stream));
+      }
+    }
+    sum_us += TickTime::MicrosecondTimestamp() - start_us;
+  }
+  // Each chunk holds 10 ms of audio.
+  return static_cast<int>(10000 * kNumStreams * kNumChunks /
+                          std::max<int64_t>(sum_us, 1));
+}
+
+void RunStreamsPerCoreTest(int sample_rate_hz) {
+  std::ostringstream trace;
+  trace << sample_rate_hz / 1000 << "kHz";
+  test::PrintResult("apm_streams_per_core", "_per_stream_apm", trace.str(),
+                    StreamsPerCore(sample_rate_hz, false), "streams", false);
+  test::PrintResult("apm_streams_per_core", "_batch", trace.str(),
+                    StreamsPerCore(sample_rate_hz, true), "streams", true);
+}
+
+}  // namespace
+
+// Measures the cost of the noise suppressor per 10 ms frame at 48 kHz, for
+// each implementation of its per-bin loops supported by the CPU. Nothing but
+// the band splitting runs besides the noise suppressor.
+TEST(AudioProcessingPerformanceTest, NoiseSuppression48kHz) {
+  test::PrintResult("apm_noise_suppression", "_48kHz", "generic",
+                    static_cast<size_t>(
+                        MeasureNoiseSuppression(WebRtc_GetCPUInfoNoASM)),
+                    "us", false);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    test::PrintResult("apm_noise_suppression", "_48kHz", "sse2",
+                      static_cast<size_t>(
+                          MeasureNoiseSuppression(GetCPUInfoNoAVX2)),
+                      "us", false);
+  }
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    test::PrintResult("apm_noise_suppression", "_48kHz", "avx2",
+                      static_cast<size_t>(
+                          MeasureNoiseSuppression(WebRtc_GetCPUInfo)),
+                      "us", false);
+  }
+#endif
+}
+
+// Measures how many server-side capture streams a single core can process in
+// real time, with one AudioProcessing per stream and with BatchAudioProcessing.
+TEST(AudioProcessingPerformanceTest, StreamsPerCore16kHz) {
+  RunStreamsPerCoreTest(AudioProcessing::kSampleRate16kHz);
+}
+
+TEST(AudioProcessingPerformanceTest, StreamsPerCore48kHz) {
+  RunStreamsPerCoreTest(AudioProcessing::kSampleRate48kHz);
+}
+
+// Measures the ProcessStream() latency while AnalyzeReverseStream() runs
+// concurrently on another thread. The worst case is dominated by how long the
+// capture thread has to wait for the render thread.
+TEST(AudioProcessingPerformanceTest, ConcurrentRenderAndCapture16kHzMono) {
+  RunConcurrentTest(AudioProcessing::kSampleRate16kHz, 1);
+}
+
+TEST(AudioProcessingPerformanceTest, ConcurrentRenderAndCapture32kHzStereo) {
+  RunConcurrentTest(AudioProcessing::kSampleRate32kHz, 2);
+}
+
+TEST(AudioProcessingPerformanceTest, ConcurrentRenderAndCapture48kHzStereo) {
+  RunConcurrentTest(AudioProcessing::kSampleRate48kHz, 2);
+}
+
+}  // namespace webrtc
@@ -22,6 +22,9 @@
 #include "webrtc/modules/audio_processing/beamformer/mock_nonlinear_beamformer.h"
 #include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+#endif
 #include "webrtc/modules/audio_processing/test/protobuf_utils.h"
 #include "webrtc/modules/audio_processing/test/test_utils.h"
 #include "webrtc/modules/interface/module_common_types.h"
@@ -434,6 +437,10 @@ ApmTest::ApmTest()
 
 void ApmTest::SetUp() {
   ASSERT_TRUE(apm_.get() != NULL);
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+  // The reference data is generated with the generic noise suppressor.
+  WebRtcNs_SetBitexact(1);
+#endif
 
   frame_ = new AudioFrame();
   revframe_ = new AudioFrame();
@@ -446,6 +453,9 @@ void ApmTest::SetUp() {
 }
 
 void ApmTest::TearDown() {
+#if defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+  WebRtcNs_SetBitexact(0);
+#endif
   if (frame_) {
     delete frame_;
   }
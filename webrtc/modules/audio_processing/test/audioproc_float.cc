@@ -20,6 +20,7 @@
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/test/protobuf_utils.h"
 #include "webrtc/modules/audio_processing/test/test_utils.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/test/testsupport/trace_to_stderr.h"
 
@@ -48,8 +49,21 @@ DEFINE_bool(ie, false, "Enable intelligibility enhancer.");
 DEFINE_bool(all, false, "Enable all components.");
 
 DEFINE_int32(ns_level, -1, "Noise suppression level [0 - 3].");
+DEFINE_int32(stream_delay, 0,
+             "The render-to-capture delay in ms reported to the echo "
+             "canceller.");
 
-DEFINE_bool(perf, false, "Enable performance tests.");
+DEFINE_bool(noasm, false, "Disable all SIMD optimizations.");
+DEFINE_bool(noavx2, false,
+            "Disable the AVX2 optimizations. Use with -perf to compare "
+            "against the SSE2 implementation.");
+
+DEFINE_bool(perf, false,
+            "Enable performance tests. Also prints the buffer statistics and "
+            "the file reading and writing rates.");
+DEFINE_bool(large_files, false,
+            "Write the output files with room for an RF64 header, so they can "
+            "grow beyond 4 GB.");
 
 namespace webrtc {
 namespace {
@@ -60,8 +74,17 @@ const char kUsage[] =
     "an input capture WAV file or protobuf debug dump and writes to an output\n"
     "WAV file.\n"
     "\n"
-    "All components are disabled by default. If any bi-directional components\n"
-    "are enabled, only debug dump files are permitted.";
+    "All components are disabled by default. The echo canceller requires a\n"
+    "reverse input WAV file.";
+
+WebRtc_CPUInfo g_get_cpu_info = nullptr;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  if (feature == kAVX2 || feature == kFMA) {
+    return 0;
+  }
+  return g_get_cpu_info(feature);
+}
 
 // Returns a StreamConfig corresponding to wav_file if it's non-nullptr.
 // Otherwise returns a default initialized StreamConfig.
@@ -95,7 +118,18 @@ int main(int argc, char* argv[]) {
       FLAGS_out_channels ? FLAGS_out_channels : in_file.num_channels();
   const int out_sample_rate =
       FLAGS_out_sample_rate ? FLAGS_out_sample_rate : in_file.sample_rate();
-  WavWriter out_file(FLAGS_o, out_sample_rate, out_channels);
+  // Write in the background, so that -perf measures the processing.
+  const bool kWriteInBackground = true;
+  WavWriter out_file(FLAGS_o, out_sample_rate, out_channels,
+                     FLAGS_large_files, kWriteInBackground);
+
+  // Must be done before any component is initialized.
+  if (FLAGS_noasm) {
+    WebRtc_GetCPUInfo = WebRtc_GetCPUInfoNoASM;
+  } else if (FLAGS_noavx2) {
+    g_get_cpu_info = WebRtc_GetCPUInfo;
+    WebRtc_GetCPUInfo = GetCPUInfoNoAVX2;
+  }
 
   Config config;
   config.Set<ExperimentalNs>(new ExperimentalNs(FLAGS_ts || FLAGS_all));
@@ -111,13 +145,13 @@ int main(int argc, char* argv[]) {
   }
 
   rtc::scoped_ptr<AudioProcessing> ap(AudioProcessing::Create(config));
-  if (!FLAGS_dump.empty()) {
+  bool process_reverse = !FLAGS_i_rev.empty();
+  if (process_reverse) {
     CHECK_EQ(kNoErr, ap->echo_cancellation()->Enable(FLAGS_aec || FLAGS_all));
   } else if (FLAGS_aec) {
-    fprintf(stderr, "-aec requires a -dump file.\n");
+    fprintf(stderr, "-aec requires an -i_rev file.\n");
     return -1;
   }
-  bool process_reverse = !FLAGS_i_rev.empty();
   CHECK_EQ(kNoErr, ap->gain_control()->Enable(FLAGS_agc || FLAGS_all));
   CHECK_EQ(kNoErr, ap->gain_control()->set_mode(GainControl::kFixedDigital));
   CHECK_EQ(kNoErr, ap->high_pass_filter()->Enable(FLAGS_hpf || FLAGS_all));
@@ -150,7 +184,8 @@ int main(int argc, char* argv[]) {
   if (process_reverse) {
     in_rev_file.reset(new WavReader(FLAGS_i_rev));
     out_rev_file.reset(new WavWriter(FLAGS_o_rev, in_rev_file->sample_rate(),
-                                     in_rev_file->num_channels()));
+                                     in_rev_file->num_channels(),
+                                     FLAGS_large_files, kWriteInBackground));
     printf("In rev file: %s\nChannels: %d, Sample rate: %d Hz\n\n",
            FLAGS_i_rev.c_str(), in_rev_file->num_channels(),
            in_rev_file->sample_rate());
@@ -169,6 +204,9 @@ int main(int argc, char* argv[]) {
 
   TickTime processing_start_time;
   TickInterval accumulated_time;
+  TickInterval read_time;
+  TickInterval write_time;
+  int64_t num_file_samples = 0;
   int num_chunks = 0;
 
   const auto input_config = MakeStreamConfig(&in_file);
@@ -176,8 +214,18 @@ int main(int argc, char* argv[]) {
   const auto reverse_input_config = MakeStreamConfig(in_rev_file.get());
   const auto reverse_output_config = MakeStreamConfig(out_rev_file.get());
 
+  const TickTime start_time = TickTime::Now();
+  TickTime io_start_time = start_time;
   while (in_file.ReadSamples(in_interleaved.size(),
                              &in_interleaved[0]) == in_interleaved.size()) {
+    if (process_reverse) {
+      in_rev_file->ReadSamples(in_rev_interleaved.size(),
+                               in_rev_interleaved.data());
+    }
+    if (FLAGS_perf) {
+      read_time += TickTime::Now() - io_start_time;
+    }
+
     // Have logs display the file time rather than wallclock time.
     trace_to_stderr.SetTimeSeconds(num_chunks * 1.f / kChunksPerSecond);
     FloatS16ToFloat(&in_interleaved[0], in_interleaved.size(),
@@ -185,8 +233,6 @@ int main(int argc, char* argv[]) {
     Deinterleave(&in_interleaved[0], in_buf.num_frames(),
                  in_buf.num_channels(), in_buf.channels());
     if (process_reverse) {
-      in_rev_file->ReadSamples(in_rev_interleaved.size(),
-                               in_rev_interleaved.data());
       FloatS16ToFloat(in_rev_interleaved.data(), in_rev_interleaved.size(),
                       in_rev_interleaved.data());
       Deinterleave(in_rev_interleaved.data(), in_rev_buf->num_frames(),
@@ -196,13 +242,17 @@ int main(int argc, char* argv[]) {
     if (FLAGS_perf) {
       processing_start_time = TickTime::Now();
     }
-    CHECK_EQ(kNoErr, ap->ProcessStream(in_buf.channels(), input_config,
-                                       output_config, out_buf.channels()));
+    // The far-end signal is rendered before it is picked up as echo.
     if (process_reverse) {
       CHECK_EQ(kNoErr, ap->ProcessReverseStream(
                            in_rev_buf->channels(), reverse_input_config,
                            reverse_output_config, out_rev_buf->channels()));
     }
+    if (ap->echo_cancellation()->is_enabled()) {
+      CHECK_EQ(kNoErr, ap->set_stream_delay_ms(FLAGS_stream_delay));
+    }
+    CHECK_EQ(kNoErr, ap->ProcessStream(in_buf.channels(), input_config,
+                                       output_config, out_buf.channels()));
     if (FLAGS_perf) {
       accumulated_time += TickTime::Now() - processing_start_time;
     }
@@ -211,23 +261,58 @@ int main(int argc, char* argv[]) {
                out_buf.num_channels(), &out_interleaved[0]);
     FloatToFloatS16(&out_interleaved[0], out_interleaved.size(),
                     &out_interleaved[0]);
-    out_file.WriteSamples(&out_interleaved[0], out_interleaved.size());
     if (process_reverse) {
       Interleave(out_rev_buf->channels(), out_rev_buf->num_frames(),
                  out_rev_buf->num_channels(), out_rev_interleaved.data());
       FloatToFloatS16(out_rev_interleaved.data(), out_rev_interleaved.size(),
                       out_rev_interleaved.data());
+    }
+
+    if (FLAGS_perf) {
+      io_start_time = TickTime::Now();
+    }
+    out_file.WriteSamples(&out_interleaved[0], out_interleaved.size());
+    num_file_samples += in_interleaved.size() + out_interleaved.size();
+    if (process_reverse) {
       out_rev_file->WriteSamples(out_rev_interleaved.data(),
                                  out_rev_interleaved.size());
+      num_file_samples +=
+          in_rev_interleaved.size() + out_rev_interleaved.size();
+    }
+    if (FLAGS_perf) {
+      const TickTime now = TickTime::Now();
+      write_time += now - io_start_time;
+      io_start_time = now;
     }
     num_chunks++;
   }
+  // Excludes the writing of the last buffered samples when the files close.
+  const TickInterval total_time = TickTime::Now() - start_time;
   if (FLAGS_perf) {
     int64_t execution_time_ms = accumulated_time.Milliseconds();
     printf("\nExecution time: %.3f s\nFile time: %.2f s\n"
            "Time per chunk: %.3f ms\n",
            execution_time_ms * 0.001f, num_chunks * 1.f / kChunksPerSecond,
            execution_time_ms * 1.f / num_chunks);
+
+    // The samples are 16-bit in the files.
+    const float file_megabytes = num_file_samples * 2.f / (1 << 20);
+    const float total_time_s = total_time.Microseconds() * 1e-6f;
+    printf("\nTotal time: %.3f s (%.1fx realtime)\n"
+           "Reading time: %.3f s\nWriting time: %.3f s\n"
+           "File data read and written: %.1f MB (%.1f MB/s)\n",
+           total_time_s, num_chunks * 1.f / kChunksPerSecond / total_time_s,
+           read_time.Microseconds() * 1e-6f, write_time.Microseconds() * 1e-6f,
+           file_megabytes, file_megabytes / total_time_s);
+
+    AudioProcessing::BufferStatistics stats;
+    CHECK_EQ(kNoErr, ap->GetBufferStatistics(&stats));
+    printf("\nBuffer sample arenas: %d (%d bytes)\n"
+           "Samples converted between int16 and float per chunk: %.1f\n"
+           "Samples copied per chunk: %.1f\n",
+           stats.num_arenas, static_cast<int>(stats.arena_bytes),
+           stats.num_converted_samples * 1.f / num_chunks,
+           stats.num_copied_samples * 1.f / num_chunks);
   }
   return 0;
 }
@@ -38,12 +38,12 @@
 #include <cmath>
 
 #include "webrtc/base/checks.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
 namespace webrtc {
-namespace {
 
-const size_t kNumBands = 3;
-const size_t kSparsity = 4;
+const size_t ThreeBandFilterBank::kNumBands;
+const size_t ThreeBandFilterBank::kSparsity;
 
 // Factors to take into account when choosing |kNumCoeffs|:
 //   1. Higher |kNumCoeffs|, means faster transition, which ensures less
@@ -53,7 +53,9 @@ const size_t kSparsity = 4;
 //      |kNumBands| * |kSparsity| * |kNumCoeffs| / 2, so it increases linearly
 //      with |kNumCoeffs|.
 //   3. The computation complexity also increases linearly with |kNumCoeffs|.
-const size_t kNumCoeffs = 4;
+const size_t ThreeBandFilterBank::kNumCoeffs;
+const size_t ThreeBandFilterBank::kNumSubFilters;
+const size_t ThreeBandFilterBank::kMemorySize;
 
 // The Matlab code to generate these |kLowpassCoeffs| is:
 //
@@ -68,7 +70,7 @@ const size_t kNumCoeffs = 4;
 // A Kaiser window is used because of its flexibility and the alpha is set to
 // 3.5, since that sets a stop band attenuation of 40dB ensuring a fast
 // transition.
-const float kLowpassCoeffs[kNumBands * kSparsity][kNumCoeffs] =
+const float ThreeBandFilterBank::kLowpassCoeffs[kNumSubFilters][kNumCoeffs] =
     {{-0.00047749f, -0.00496888f, +0.16547118f, +0.00425496f},
      {-0.00173287f, -0.01585778f, +0.14989004f, +0.00994113f},
      {-0.00304815f, -0.02536082f, +0.12154542f, +0.01157993f},
@@ -82,51 +84,53 @@ const float kLowpassCoeffs[kNumBands * kSparsity][kNumCoeffs] =
      {+0.00994113f, +0.14989004f, -0.01585778f, -0.00173287f},
      {+0.00425496f, +0.16547118f, -0.00496888f, -0.00047749f}};
 
-// Downsamples |in| into |out|, taking one every |kNumbands| starting from
-// |offset|. |split_length| is the |out| length. |in| has to be at least
-// |kNumBands| * |split_length| long.
-void Downsample(const float* in,
-                size_t split_length,
-                size_t offset,
-                float* out) {
-  for (size_t i = 0; i < split_length; ++i) {
-    out[i] = in[kNumBands * i + offset];
+// If we know the minimum architecture at compile time, avoid CPU detection.
+// The vectorized kernels process 4 downsampled samples at a time.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void ThreeBandFilterBank::InitializeCPUSpecificFeatures() {
+#if defined(__SSE2__)
+  const bool has_sse2 = true;
+#else
+  const bool has_sse2 = WebRtc_GetCPUInfo(kSSE2) != 0;
+#endif
+  if (has_sse2 && split_length_ % 4 == 0) {
+    analysis_proc_ = Analysis_SSE2;
+    synthesis_proc_ = Synthesis_SSE2;
   }
 }
-
-// Upsamples |in| into |out|, scaling by |kNumBands| and accumulating it every
-// |kNumBands| starting from |offset|. |split_length| is the |in| length. |out|
-// has to be at least |kNumBands| * |split_length| long.
-void Upsample(const float* in, size_t split_length, size_t offset, float* out) {
-  for (size_t i = 0; i < split_length; ++i) {
-    out[kNumBands * i + offset] += kNumBands * in[i];
+#elif defined(WEBRTC_DETECT_NEON) || defined(WEBRTC_HAS_NEON)
+void ThreeBandFilterBank::InitializeCPUSpecificFeatures() {
+#if defined(WEBRTC_HAS_NEON)
+  const bool has_neon = true;
+#else
+  const bool has_neon =
+      (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0;
+#endif
+  if (has_neon && split_length_ % 4 == 0) {
+    analysis_proc_ = Analysis_NEON;
+    synthesis_proc_ = Synthesis_NEON;
   }
 }
-
-}  // namespace
+#else
+void ThreeBandFilterBank::InitializeCPUSpecificFeatures() {}
+#endif
 
 // Because the low-pass filter prototype has half bandwidth it is possible to
 // use a DCT to shift it in both directions at the same time, to the center
 // frequencies [1 / 12, 3 / 12, 5 / 12].
 ThreeBandFilterBank::ThreeBandFilterBank(size_t length)
-    : in_buffer_(rtc::CheckedDivExact(length, kNumBands)),
-      out_buffer_(in_buffer_.size()) {
-  for (size_t i = 0; i < kSparsity; ++i) {
-    for (size_t j = 0; j < kNumBands; ++j) {
-      analysis_filters_.push_back(new SparseFIRFilter(
-          kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i));
-      synthesis_filters_.push_back(new SparseFIRFilter(
-          kLowpassCoeffs[i * kNumBands + j], kNumCoeffs, kSparsity, i));
-    }
-  }
-  dct_modulation_.resize(kNumBands * kSparsity);
-  for (size_t i = 0; i < dct_modulation_.size(); ++i) {
-    dct_modulation_[i].resize(kNumBands);
+    : split_length_(rtc::CheckedDivExact(length, kNumBands)),
+      analysis_memory_(kNumBands * (kMemorySize + split_length_), 0.f),
+      synthesis_memory_(kNumSubFilters * (kMemorySize + split_length_), 0.f),
+      analysis_proc_(Analysis_C),
+      synthesis_proc_(Synthesis_C) {
+  for (size_t i = 0; i < kNumSubFilters; ++i) {
     for (size_t j = 0; j < kNumBands; ++j) {
       dct_modulation_[i][j] =
-          2.f * cos(2.f * M_PI * i * (2.f * j + 1.f) / dct_modulation_.size());
+          2.f * cos(2.f * M_PI * i * (2.f * j + 1.f) / kNumSubFilters);
     }
   }
+  InitializeCPUSpecificFeatures();
 }
 
 // The analysis can be separated in these steps:
@@ -135,23 +139,16 @@ ThreeBandFilterBank::ThreeBandFilterBank(size_t length)
 //      decomposition of the low-pass prototype filter and upsampled by a factor
 //      of |kSparsity|.
 //   3. Modulating with cosines and accumulating to get the desired band.
+// The kernels run the last two steps for all the sub-filters at once, keeping
+// the bands of the current sample in registers.
 void ThreeBandFilterBank::Analysis(const float* in,
                                    size_t length,
                                    float* const* out) {
-  CHECK_EQ(in_buffer_.size(), rtc::CheckedDivExact(length, kNumBands));
-  for (size_t i = 0; i < kNumBands; ++i) {
-    memset(out[i], 0, in_buffer_.size() * sizeof(*out[i]));
-  }
-  for (size_t i = 0; i < kNumBands; ++i) {
-    Downsample(in, in_buffer_.size(), kNumBands - i - 1, &in_buffer_[0]);
-    for (size_t j = 0; j < kSparsity; ++j) {
-      const size_t offset = i + j * kNumBands;
-      analysis_filters_[offset]->Filter(&in_buffer_[0],
-                                        in_buffer_.size(),
-                                        &out_buffer_[0]);
-      DownModulate(&out_buffer_[0], out_buffer_.size(), offset, out);
-    }
-  }
+  CHECK_EQ(split_length_, rtc::CheckedDivExact(length, kNumBands));
+  float* phases[kNumBands];
+  GetBlockPointers(&analysis_memory_, kNumBands, phases);
+  analysis_proc_(in, split_length_, dct_modulation_, phases, out);
+  UpdateMemory(&analysis_memory_);
 }
 
 // The synthesis can be separated in these steps:
@@ -163,49 +160,92 @@ void ThreeBandFilterBank::Analysis(const float* in,
 void ThreeBandFilterBank::Synthesis(const float* const* in,
                                     size_t split_length,
                                     float* out) {
-  CHECK_EQ(in_buffer_.size(), split_length);
-  memset(out, 0, kNumBands * in_buffer_.size() * sizeof(*out));
+  CHECK_EQ(split_length_, split_length);
+  float* sub_bands[kNumSubFilters];
+  GetBlockPointers(&synthesis_memory_, kNumSubFilters, sub_bands);
+  synthesis_proc_(in, split_length_, dct_modulation_, sub_bands, out);
+  UpdateMemory(&synthesis_memory_);
+}
+
+// The sub-filter |i + j * kNumBands| filters the phase |i| delayed by |j|
+// samples. The operations are done in the same order as filtering every
+// sub-filter separately and then accumulating the modulated outputs.
+void ThreeBandFilterBank::Analysis_C(const float* in,
+                                     size_t split_length,
+                                     const float (*modulation)[kNumBands],
+                                     float* const* phases,
+                                     float* const* out) {
   for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < kSparsity; ++j) {
-      const size_t offset = i + j * kNumBands;
-      UpModulate(in, in_buffer_.size(), offset, &in_buffer_[0]);
-      synthesis_filters_[offset]->Filter(&in_buffer_[0],
-                                         in_buffer_.size(),
-                                         &out_buffer_[0]);
-      Upsample(&out_buffer_[0], out_buffer_.size(), i, out);
+    for (size_t n = 0; n < split_length; ++n) {
+      phases[i][n] = in[kNumBands * n + kNumBands - i - 1];
+    }
+  }
+  for (size_t n = 0; n < split_length; ++n) {
+    float bands[kNumBands] = {0.f, 0.f, 0.f};
+    for (size_t i = 0; i < kNumBands; ++i) {
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &phases[i][n] - j;
+        float filtered = 0.f;
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered += *(delayed - k * kSparsity) *
+                      kLowpassCoeffs[offset][k];
+        }
+        for (size_t b = 0; b < kNumBands; ++b) {
+          bands[b] += modulation[offset][b] * filtered;
+        }
+      }
+    }
+    for (size_t b = 0; b < kNumBands; ++b) {
+      out[b][n] = bands[b];
     }
   }
 }
 
-
-// Modulates |in| by |dct_modulation_| and accumulates it in each of the
-// |kNumBands| bands of |out|. |offset| is the index in the period of the
-// cosines used for modulation. |split_length| is the length of |in| and each
-// band of |out|.
-void ThreeBandFilterBank::DownModulate(const float* in,
-                                       size_t split_length,
-                                       size_t offset,
-                                       float* const* out) {
-  for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[i][j] += dct_modulation_[offset][i] * in[j];
+void ThreeBandFilterBank::Synthesis_C(const float* const* in,
+                                      size_t split_length,
+                                      const float (*modulation)[kNumBands],
+                                      float* const* sub_bands,
+                                      float* out) {
+  for (size_t offset = 0; offset < kNumSubFilters; ++offset) {
+    for (size_t n = 0; n < split_length; ++n) {
+      float modulated = 0.f;
+      for (size_t b = 0; b < kNumBands; ++b) {
+        modulated += modulation[offset][b] * in[b][n];
+      }
+      sub_bands[offset][n] = modulated;
+    }
+  }
+  for (size_t n = 0; n < split_length; ++n) {
+    for (size_t i = 0; i < kNumBands; ++i) {
+      float sample = 0.f;
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &sub_bands[offset][n] - j;
+        float filtered = 0.f;
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered += *(delayed - k * kSparsity) *
+                      kLowpassCoeffs[offset][k];
+        }
+        sample += kNumBands * filtered;
+      }
+      out[kNumBands * n + i] = sample;
     }
   }
 }
 
-// Modulates each of the |kNumBands| bands of |in| by |dct_modulation_| and
-// accumulates them in |out|. |out| is cleared before starting to accumulate.
-// |offset| is the index in the period of the cosines used for modulation.
-// |split_length| is the length of each band of |in| and |out|.
-void ThreeBandFilterBank::UpModulate(const float* const* in,
-                                     size_t split_length,
-                                     size_t offset,
-                                     float* out) {
-  memset(out, 0, split_length * sizeof(*out));
-  for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[j] += dct_modulation_[offset][i] * in[i][j];
-    }
+void ThreeBandFilterBank::GetBlockPointers(std::vector<float>* memory,
+                                           size_t count,
+                                           float** pointers) {
+  for (size_t i = 0; i < count; ++i) {
+    pointers[i] = &(*memory)[i * (kMemorySize + split_length_) + kMemorySize];
+  }
+}
+
+void ThreeBandFilterBank::UpdateMemory(std::vector<float>* memory) {
+  for (size_t i = 0; i < memory->size(); i += kMemorySize + split_length_) {
+    memmove(&(*memory)[i], &(*memory)[i + split_length_],
+            kMemorySize * sizeof((*memory)[0]));
   }
 }
 
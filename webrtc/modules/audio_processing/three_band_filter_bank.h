@@ -14,8 +14,7 @@
 #include <cstring>
 #include <vector>
 
-#include "webrtc/common_audio/sparse_fir_filter.h"
-#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/typedefs.h"
 
 namespace webrtc {
 
@@ -47,20 +46,88 @@ class ThreeBandFilterBank final {
   void Synthesis(const float* const* in, size_t split_length, float* out);
 
  private:
-  void DownModulate(const float* in,
-                    size_t split_length,
-                    size_t offset,
-                    float* const* out);
-  void UpModulate(const float* const* in,
-                  size_t split_length,
-                  size_t offset,
-                  float* out);
-
-  std::vector<float> in_buffer_;
-  std::vector<float> out_buffer_;
-  ScopedVector<SparseFIRFilter> analysis_filters_;
-  ScopedVector<SparseFIRFilter> synthesis_filters_;
-  std::vector<std::vector<float>> dct_modulation_;
+  static const size_t kNumBands = 3;
+  static const size_t kSparsity = 4;
+  static const size_t kNumCoeffs = 4;
+  // The number of polyphase sub-filters, each one with its own modulation.
+  static const size_t kNumSubFilters = kNumBands * kSparsity;
+  // The longest delay of a sub-filter, in downsampled samples.
+  static const size_t kMemorySize = kSparsity * kNumCoeffs - 1;
+
+  static const float kLowpassCoeffs[kNumSubFilters][kNumCoeffs];
+
+  // The analysis kernels deinterleave |in| into the |kNumBands| polyphase
+  // components in |phases| and filter and modulate them into the bands of
+  // |out|, all sub-filters in a single pass. The synthesis kernels modulate the
+  // bands of |in| into the |kNumSubFilters| signals in |sub_bands| and filter
+  // and interleave them into |out|. The |kMemorySize| samples before every
+  // pointer in |phases| and |sub_bands| hold the end of the previous block.
+  // The vectorized kernels require |split_length| to be a multiple of 4.
+  typedef void (*AnalysisProc)(const float* in,
+                               size_t split_length,
+                               const float (*modulation)[kNumBands],
+                               float* const* phases,
+                               float* const* out);
+  typedef void (*SynthesisProc)(const float* const* in,
+                                size_t split_length,
+                                const float (*modulation)[kNumBands],
+                                float* const* sub_bands,
+                                float* out);
+
+  static void Analysis_C(const float* in,
+                         size_t split_length,
+                         const float (*modulation)[kNumBands],
+                         float* const* phases,
+                         float* const* out);
+  static void Synthesis_C(const float* const* in,
+                          size_t split_length,
+                          const float (*modulation)[kNumBands],
+                          float* const* sub_bands,
+                          float* out);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  static void Analysis_SSE2(const float* in,
+                            size_t split_length,
+                            const float (*modulation)[kNumBands],
+                            float* const* phases,
+                            float* const* out);
+  static void Synthesis_SSE2(const float* const* in,
+                             size_t split_length,
+                             const float (*modulation)[kNumBands],
+                             float* const* sub_bands,
+                             float* out);
+#elif defined(WEBRTC_DETECT_NEON) || defined(WEBRTC_HAS_NEON)
+  static void Analysis_NEON(const float* in,
+                            size_t split_length,
+                            const float (*modulation)[kNumBands],
+                            float* const* phases,
+                            float* const* out);
+  static void Synthesis_NEON(const float* const* in,
+                             size_t split_length,
+                             const float (*modulation)[kNumBands],
+                             float* const* sub_bands,
+                             float* out);
+#endif
+
+  // Selects the kernels for the CPU and |split_length_|.
+  void InitializeCPUSpecificFeatures();
+
+  // Fills |pointers| with the start of the current block of every one of the
+  // |count| signals stored back-to-back in |memory|.
+  void GetBlockPointers(std::vector<float>* memory,
+                        size_t count,
+                        float** pointers);
+  // Moves the end of the current block of every signal in |memory| to the
+  // memory of the next one.
+  void UpdateMemory(std::vector<float>* memory);
+
+  const size_t split_length_;
+  // |kNumBands| polyphase components of the input signal.
+  std::vector<float> analysis_memory_;
+  // |kNumSubFilters| modulated signals.
+  std::vector<float> synthesis_memory_;
+  float dct_modulation_[kNumSubFilters][kNumBands];
+  AnalysisProc analysis_proc_;
+  SynthesisProc synthesis_proc_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/three_band_filter_bank.h"
+
+#include <arm_neon.h>
+
+// The kernels compute 4 consecutive downsampled samples at a time, with the
+// same operations in the same order as ThreeBandFilterBank::Analysis_C() and
+// ThreeBandFilterBank::Synthesis_C().
+
+namespace webrtc {
+
+void ThreeBandFilterBank::Analysis_NEON(const float* in,
+                                        size_t split_length,
+                                        const float (*modulation)[kNumBands],
+                                        float* const* phases,
+                                        float* const* out) {
+  // The phase |i| starts at the input sample |kNumBands - i - 1|.
+  for (size_t n = 0; n < split_length; n += 4) {
+    const float32x4x3_t v = vld3q_f32(&in[kNumBands * n]);
+    for (size_t i = 0; i < kNumBands; ++i) {
+      vst1q_f32(&phases[i][n], v.val[kNumBands - i - 1]);
+    }
+  }
+  for (size_t n = 0; n < split_length; n += 4) {
+    float32x4_t bands[kNumBands];
+    for (size_t b = 0; b < kNumBands; ++b) {
+      bands[b] = vdupq_n_f32(0.f);
+    }
+    for (size_t i = 0; i < kNumBands; ++i) {
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &phases[i][n] - j;
+        float32x4_t filtered = vdupq_n_f32(0.f);
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered = vmlaq_n_f32(filtered, vld1q_f32(delayed - k * kSparsity),
+                                 kLowpassCoeffs[offset][k]);
+        }
+        for (size_t b = 0; b < kNumBands; ++b) {
+          bands[b] = vmlaq_n_f32(bands[b], filtered, modulation[offset][b]);
+        }
+      }
+    }
+    for (size_t b = 0; b < kNumBands; ++b) {
+      vst1q_f32(&out[b][n], bands[b]);
+    }
+  }
+}
+
+void ThreeBandFilterBank::Synthesis_NEON(const float* const* in,
+                                         size_t split_length,
+                                         const float (*modulation)[kNumBands],
+                                         float* const* sub_bands,
+                                         float* out) {
+  for (size_t n = 0; n < split_length; n += 4) {
+    float32x4_t bands[kNumBands];
+    for (size_t b = 0; b < kNumBands; ++b) {
+      bands[b] = vld1q_f32(&in[b][n]);
+    }
+    for (size_t offset = 0; offset < kNumSubFilters; ++offset) {
+      float32x4_t modulated = vdupq_n_f32(0.f);
+      for (size_t b = 0; b < kNumBands; ++b) {
+        modulated = vmlaq_n_f32(modulated, bands[b], modulation[offset][b]);
+      }
+      vst1q_f32(&sub_bands[offset][n], modulated);
+    }
+  }
+  for (size_t n = 0; n < split_length; n += 4) {
+    float32x4x3_t samples;
+    for (size_t i = 0; i < kNumBands; ++i) {
+      samples.val[i] = vdupq_n_f32(0.f);
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &sub_bands[offset][n] - j;
+        float32x4_t filtered = vdupq_n_f32(0.f);
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered = vmlaq_n_f32(filtered, vld1q_f32(delayed - k * kSparsity),
+                                 kLowpassCoeffs[offset][k]);
+        }
+        samples.val[i] = vmlaq_n_f32(samples.val[i], filtered,
+                                     static_cast<float>(kNumBands));
+      }
+    }
+    vst3q_f32(&out[kNumBands * n], samples);
+  }
+}
+
+}  // namespace webrtc
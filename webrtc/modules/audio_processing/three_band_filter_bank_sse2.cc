@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/three_band_filter_bank.h"
+
+#include <emmintrin.h>
+
+// The kernels compute 4 consecutive downsampled samples at a time, with the
+// same operations in the same order as ThreeBandFilterBank::Analysis_C() and
+// ThreeBandFilterBank::Synthesis_C().
+
+namespace webrtc {
+
+void ThreeBandFilterBank::Analysis_SSE2(const float* in,
+                                        size_t split_length,
+                                        const float (*modulation)[kNumBands],
+                                        float* const* phases,
+                                        float* const* out) {
+  // Every 12 input samples hold 4 samples of each phase, interleaved. The
+  // phase |i| starts at the input sample |kNumBands - i - 1|.
+  for (size_t n = 0; n < split_length; n += 4) {
+    const __m128 v0 = _mm_loadu_ps(&in[kNumBands * n]);
+    const __m128 v1 = _mm_loadu_ps(&in[kNumBands * n + 4]);
+    const __m128 v2 = _mm_loadu_ps(&in[kNumBands * n + 8]);
+    const __m128 a = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2));
+    _mm_storeu_ps(&phases[2][n],
+                  _mm_shuffle_ps(v0, a, _MM_SHUFFLE(2, 0, 3, 0)));
+    const __m128 b = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1));
+    const __m128 c = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3));
+    _mm_storeu_ps(&phases[1][n],
+                  _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 0, 2, 0)));
+    const __m128 d = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));
+    _mm_storeu_ps(&phases[0][n],
+                  _mm_shuffle_ps(d, v2, _MM_SHUFFLE(3, 0, 2, 0)));
+  }
+  for (size_t n = 0; n < split_length; n += 4) {
+    __m128 bands[kNumBands];
+    for (size_t b = 0; b < kNumBands; ++b) {
+      bands[b] = _mm_setzero_ps();
+    }
+    for (size_t i = 0; i < kNumBands; ++i) {
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &phases[i][n] - j;
+        __m128 filtered = _mm_setzero_ps();
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered = _mm_add_ps(
+              filtered,
+              _mm_mul_ps(_mm_loadu_ps(delayed - k * kSparsity),
+                         _mm_set1_ps(kLowpassCoeffs[offset][k])));
+        }
+        for (size_t b = 0; b < kNumBands; ++b) {
+          bands[b] = _mm_add_ps(
+              bands[b],
+              _mm_mul_ps(_mm_set1_ps(modulation[offset][b]), filtered));
+        }
+      }
+    }
+    for (size_t b = 0; b < kNumBands; ++b) {
+      _mm_storeu_ps(&out[b][n], bands[b]);
+    }
+  }
+}
+
+void ThreeBandFilterBank::Synthesis_SSE2(const float* const* in,
+                                         size_t split_length,
+                                         const float (*modulation)[kNumBands],
+                                         float* const* sub_bands,
+                                         float* out) {
+  for (size_t n = 0; n < split_length; n += 4) {
+    __m128 bands[kNumBands];
+    for (size_t b = 0; b < kNumBands; ++b) {
+      bands[b] = _mm_loadu_ps(&in[b][n]);
+    }
+    for (size_t offset = 0; offset < kNumSubFilters; ++offset) {
+      __m128 modulated = _mm_setzero_ps();
+      for (size_t b = 0; b < kNumBands; ++b) {
+        modulated = _mm_add_ps(
+            modulated,
+            _mm_mul_ps(_mm_set1_ps(modulation[offset][b]), bands[b]));
+      }
+      _mm_storeu_ps(&sub_bands[offset][n], modulated);
+    }
+  }
+  const __m128 scale = _mm_set1_ps(static_cast<float>(kNumBands));
+  for (size_t n = 0; n < split_length; n += 4) {
+    __m128 samples[kNumBands];
+    for (size_t i = 0; i < kNumBands; ++i) {
+      samples[i] = _mm_setzero_ps();
+      for (size_t j = 0; j < kSparsity; ++j) {
+        const size_t offset = i + j * kNumBands;
+        const float* delayed = &sub_bands[offset][n] - j;
+        __m128 filtered = _mm_setzero_ps();
+        for (size_t k = 0; k < kNumCoeffs; ++k) {
+          filtered = _mm_add_ps(
+              filtered,
+              _mm_mul_ps(_mm_loadu_ps(delayed - k * kSparsity),
+                         _mm_set1_ps(kLowpassCoeffs[offset][k])));
+        }
+        samples[i] = _mm_add_ps(samples[i], _mm_mul_ps(scale, filtered));
+      }
+    }
+    // Interleaves the 4 samples of every phase into 12 output samples.
+    const __m128 lo = _mm_unpacklo_ps(samples[0], samples[1]);
+    const __m128 hi = _mm_unpackhi_ps(samples[0], samples[1]);
+    const __m128 a = _mm_shuffle_ps(samples[2], lo, _MM_SHUFFLE(2, 2, 0, 0));
+    _mm_storeu_ps(&out[kNumBands * n],
+                  _mm_shuffle_ps(lo, a, _MM_SHUFFLE(2, 0, 1, 0)));
+    const __m128 b = _mm_shuffle_ps(lo, samples[2], _MM_SHUFFLE(1, 1, 3, 3));
+    _mm_storeu_ps(&out[kNumBands * n + 4],
+                  _mm_shuffle_ps(b, hi, _MM_SHUFFLE(1, 0, 2, 0)));
+    const __m128 c = _mm_shuffle_ps(samples[2], hi, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm_storeu_ps(&out[kNumBands * n + 8],
+                  _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 3, 2, 0)));
+  }
+}
+
+}  // namespace webrtc
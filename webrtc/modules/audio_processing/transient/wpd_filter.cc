@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
+
+#include <assert.h>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/modules/audio_processing/transient/wpd_filter_avx2.h"
+#include "webrtc/modules/audio_processing/transient/wpd_filter_sse2.h"
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+#include "webrtc/modules/audio_processing/transient/wpd_filter_neon.h"
+#endif
+
+namespace webrtc {
+
+WPDFilterFunction GetWPDFilterFunction() {
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  // AVX2 always requires runtime detection.
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    return WPDFilter_AVX2;
+  }
+#if defined(__SSE2__)
+  return WPDFilter_SSE2;
+#else
+  // x86 CPU detection required.
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    return WPDFilter_SSE2;
+  }
+#endif
+#elif defined(WEBRTC_HAS_NEON)
+  return WPDFilter_NEON;
+#elif defined(WEBRTC_DETECT_NEON)
+  if (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) {
+    return WPDFilter_NEON;
+  }
+#endif
+  return WPDFilter_C;
+}
+
+void WPDFilter_C(const float* input,
+                 size_t output_length,
+                 const float* const* reversed_coefficients,
+                 size_t coefficients_length,
+                 int num_filters,
+                 float* const* outputs) {
+  assert(input && reversed_coefficients && coefficients_length > 0 &&
+         num_filters > 0 && num_filters <= kMaxWPDFilters && outputs);
+  for (int f = 0; f < num_filters; ++f) {
+    for (size_t i = 0; i < output_length; ++i) {
+      outputs[f][i] = WPDFilterSample(&input[2 * i + 1],
+                                      reversed_coefficients[f],
+                                      coefficients_length);
+    }
+  }
+}
+
+}  // namespace webrtc
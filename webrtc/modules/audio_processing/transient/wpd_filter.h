@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_H_
+
+#include <math.h>
+#include <stddef.h>
+
+namespace webrtc {
+
+// The maximum number of filters a WPDFilterFunction runs over the same input.
+const int kMaxWPDFilters = 2;
+
+// Computes the data of up to |kMaxWPDFilters| nodes of a Wavelet Packet
+// Decomposition tree from the data of their parent: filters the parent data
+// with the FIR filter of every node, keeps the odd output samples and takes
+// their absolute values. This is equivalent to a FIRFilter followed by
+// DyadicDecimate() with an odd sequence and fabs(), but only the samples which
+// are kept are computed, and the input is read once for all the filters.
+//
+// |input| holds the |coefficients_length| - 1 last samples of the previous
+// parent data followed by the current parent data, of at least
+// 2 * |output_length| samples. The |reversed_coefficients| of every filter are
+// in reverse order, so that
+//   outputs[f][i] = |sum_j reversed_coefficients[f][j] * input[2 * i + 1 + j]|
+// for i in [0, |output_length|).
+typedef void (*WPDFilterFunction)(const float* input,
+                                  size_t output_length,
+                                  const float* const* reversed_coefficients,
+                                  size_t coefficients_length,
+                                  int num_filters,
+                                  float* const* outputs);
+
+// Returns the fastest WPDFilterFunction supported by the CPU. The optimized
+// versions sum the products in another order, so their outputs differ from
+// those of WPDFilter_C() by rounding errors. The CPU detection is costly, so
+// this is meant to be called once on creation.
+WPDFilterFunction GetWPDFilterFunction();
+
+void WPDFilter_C(const float* input,
+                 size_t output_length,
+                 const float* const* reversed_coefficients,
+                 size_t coefficients_length,
+                 int num_filters,
+                 float* const* outputs);
+
+// Computes a single output sample, |in| pointing to the first input of its
+// filter. The optimized versions use it for the samples which do not fill a
+// vector.
+static inline float WPDFilterSample(const float* in,
+                                    const float* reversed_coefficients,
+                                    size_t coefficients_length) {
+  float sum = 0.f;
+  for (size_t j = 0; j < coefficients_length; ++j) {
+    sum += in[j] * reversed_coefficients[j];
+  }
+  return fabsf(sum);
+}
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_H_
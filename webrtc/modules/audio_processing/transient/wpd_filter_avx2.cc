@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter_avx2.h"
+
+#include <immintrin.h>
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
+
+namespace webrtc {
+namespace {
+
+// Computes 8 * |kNumBlocks| output samples of every filter, starting at
+// |first_output|. Every pair of taps reads 16 consecutive input samples per
+// block and splits them into the even and odd ones, which are the inputs of the
+// taps for 8 consecutive output samples. The split is done within 128-bit
+// lanes, so the output samples are accumulated in the order 0, 1, 4, 5, 2, 3,
+// 6, 7 and only put back in order when stored.
+template <int kNumFilters, int kNumBlocks>
+void FilterBlocks(const float* input,
+                  size_t first_output,
+                  const float* const* reversed_coefficients,
+                  size_t coefficients_length,
+                  float* const* outputs) {
+  const float* in = &input[2 * first_output + 1];
+  __m256 sums[kNumFilters][kNumBlocks];
+  for (int f = 0; f < kNumFilters; ++f) {
+    for (int b = 0; b < kNumBlocks; ++b) {
+      sums[f][b] = _mm256_setzero_ps();
+    }
+  }
+  size_t j = 0;
+  for (; j + 2 <= coefficients_length; j += 2) {
+    __m256 even_coefficients[kNumFilters];
+    __m256 odd_coefficients[kNumFilters];
+    for (int f = 0; f < kNumFilters; ++f) {
+      even_coefficients[f] = _mm256_set1_ps(reversed_coefficients[f][j]);
+      odd_coefficients[f] = _mm256_set1_ps(reversed_coefficients[f][j + 1]);
+    }
+    for (int b = 0; b < kNumBlocks; ++b) {
+      const __m256 lo = _mm256_loadu_ps(&in[16 * b + j]);
+      const __m256 hi = _mm256_loadu_ps(&in[16 * b + j + 8]);
+      const __m256 even = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+      const __m256 odd = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+      for (int f = 0; f < kNumFilters; ++f) {
+        sums[f][b] = _mm256_fmadd_ps(even, even_coefficients[f], sums[f][b]);
+        sums[f][b] = _mm256_fmadd_ps(odd, odd_coefficients[f], sums[f][b]);
+      }
+    }
+  }
+  if (j < coefficients_length) {
+    // The last tap of an odd length filter. Reading from one sample earlier
+    // stays within the input.
+    for (int b = 0; b < kNumBlocks; ++b) {
+      const __m256 lo = _mm256_loadu_ps(&in[16 * b + j - 1]);
+      const __m256 hi = _mm256_loadu_ps(&in[16 * b + j + 7]);
+      const __m256 even = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+      for (int f = 0; f < kNumFilters; ++f) {
+        sums[f][b] = _mm256_fmadd_ps(
+            even, _mm256_set1_ps(reversed_coefficients[f][j]), sums[f][b]);
+      }
+    }
+  }
+  const __m256 sign_mask = _mm256_set1_ps(-0.f);
+  for (int f = 0; f < kNumFilters; ++f) {
+    for (int b = 0; b < kNumBlocks; ++b) {
+      const __m256 ordered = _mm256_castpd_ps(_mm256_permute4x64_pd(
+          _mm256_castps_pd(sums[f][b]), _MM_SHUFFLE(3, 1, 2, 0)));
+      _mm256_storeu_ps(&outputs[f][first_output + 8 * b],
+                       _mm256_andnot_ps(sign_mask, ordered));
+    }
+  }
+}
+
+template <int kNumFilters>
+void Filter(const float* input,
+            size_t output_length,
+            const float* const* reversed_coefficients,
+            size_t coefficients_length,
+            float* const* outputs) {
+  size_t i = 0;
+  for (; i + 16 <= output_length; i += 16) {
+    FilterBlocks<kNumFilters, 2>(input, i, reversed_coefficients,
+                                 coefficients_length, outputs);
+  }
+  if (i + 8 <= output_length) {
+    FilterBlocks<kNumFilters, 1>(input, i, reversed_coefficients,
+                                 coefficients_length, outputs);
+    i += 8;
+  }
+  for (; i < output_length; ++i) {
+    for (int f = 0; f < kNumFilters; ++f) {
+      outputs[f][i] = WPDFilterSample(&input[2 * i + 1],
+                                      reversed_coefficients[f],
+                                      coefficients_length);
+    }
+  }
+}
+
+}  // namespace
+
+void WPDFilter_AVX2(const float* input,
+                    size_t output_length,
+                    const float* const* reversed_coefficients,
+                    size_t coefficients_length,
+                    int num_filters,
+                    float* const* outputs) {
+  if (num_filters == 2) {
+    Filter<2>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  } else {
+    Filter<1>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  }
+}
+
+}  // namespace webrtc
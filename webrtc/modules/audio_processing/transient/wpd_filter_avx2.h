@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_AVX2_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_AVX2_H_
+
+#include <stddef.h>
+
+namespace webrtc {
+
+// AVX2 version of WPDFilter_C(), using fused multiply-adds. It computes 8
+// output samples at a time.
+void WPDFilter_AVX2(const float* input,
+                    size_t output_length,
+                    const float* const* reversed_coefficients,
+                    size_t coefficients_length,
+                    int num_filters,
+                    float* const* outputs);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_FILTER_AVX2_H_
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter_neon.h"
+
+#include <arm_neon.h>
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
+
+namespace webrtc {
+namespace {
+
+// Every pair of taps loads 8 consecutive input samples deinterleaved into the
+// even and odd ones, which are the inputs of the taps for 4 consecutive output
+// samples.
+template <int kNumFilters>
+void Filter(const float* input,
+            size_t output_length,
+            const float* const* reversed_coefficients,
+            size_t coefficients_length,
+            float* const* outputs) {
+  size_t i = 0;
+  for (; i + 4 <= output_length; i += 4) {
+    const float* in = &input[2 * i + 1];
+    float32x4_t sums[kNumFilters];
+    for (int f = 0; f < kNumFilters; ++f) {
+      sums[f] = vdupq_n_f32(0.f);
+    }
+    size_t j = 0;
+    for (; j + 2 <= coefficients_length; j += 2) {
+      const float32x4x2_t v = vld2q_f32(&in[j]);
+      for (int f = 0; f < kNumFilters; ++f) {
+        const float* coefficients = &reversed_coefficients[f][j];
+        sums[f] = vmlaq_n_f32(sums[f], v.val[0], coefficients[0]);
+        sums[f] = vmlaq_n_f32(sums[f], v.val[1], coefficients[1]);
+      }
+    }
+    if (j < coefficients_length) {
+      // The last tap of an odd length filter. Reading from one sample earlier
+      // stays within the input.
+      const float32x4x2_t v = vld2q_f32(&in[j - 1]);
+      for (int f = 0; f < kNumFilters; ++f) {
+        sums[f] = vmlaq_n_f32(sums[f], v.val[1], reversed_coefficients[f][j]);
+      }
+    }
+    for (int f = 0; f < kNumFilters; ++f) {
+      vst1q_f32(&outputs[f][i], vabsq_f32(sums[f]));
+    }
+  }
+  for (; i < output_length; ++i) {
+    for (int f = 0; f < kNumFilters; ++f) {
+      outputs[f][i] = WPDFilterSample(&input[2 * i + 1],
+                                      reversed_coefficients[f],
+                                      coefficients_length);
+    }
+  }
+}
+
+}  // namespace
+
+void WPDFilter_NEON(const float* input,
+                    size_t output_length,
+                    const float* const* reversed_coefficients,
+                    size_t coefficients_length,
+                    int num_filters,
+                    float* const* outputs) {
+  if (num_filters == 2) {
+    Filter<2>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  } else {
+    Filter<1>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  }
+}
+
+}  // namespace webrtc
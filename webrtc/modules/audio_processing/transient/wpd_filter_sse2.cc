@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter_sse2.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
+
+namespace webrtc {
+namespace {
+
+// Computes 4 * |kNumBlocks| output samples of every filter, starting at
+// |first_output|. Every pair of taps reads 8 consecutive input samples per
+// block and splits them into the even and odd ones, which are the inputs of the
+// taps for 4 consecutive output samples. Several blocks share the broadcast
+// coefficients.
+template <int kNumFilters, int kNumBlocks>
+void FilterBlocks(const float* input,
+                  size_t first_output,
+                  const float* const* reversed_coefficients,
+                  size_t coefficients_length,
+                  float* const* outputs) {
+  const float* in = &input[2 * first_output + 1];
+  __m128 sums[kNumFilters][kNumBlocks];
+  for (int f = 0; f < kNumFilters; ++f) {
+    for (int b = 0; b < kNumBlocks; ++b) {
+      sums[f][b] = _mm_setzero_ps();
+    }
+  }
+  size_t j = 0;
+  for (; j + 2 <= coefficients_length; j += 2) {
+    __m128 even[kNumBlocks];
+    __m128 odd[kNumBlocks];
+    for (int b = 0; b < kNumBlocks; ++b) {
+      const __m128 lo = _mm_loadu_ps(&in[8 * b + j]);
+      const __m128 hi = _mm_loadu_ps(&in[8 * b + j + 4]);
+      even[b] = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+      odd[b] = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    for (int f = 0; f < kNumFilters; ++f) {
+      const __m128 even_coefficient = _mm_set1_ps(reversed_coefficients[f][j]);
+      const __m128 odd_coefficient =
+          _mm_set1_ps(reversed_coefficients[f][j + 1]);
+      for (int b = 0; b < kNumBlocks; ++b) {
+        sums[f][b] =
+            _mm_add_ps(sums[f][b], _mm_mul_ps(even[b], even_coefficient));
+        sums[f][b] =
+            _mm_add_ps(sums[f][b], _mm_mul_ps(odd[b], odd_coefficient));
+      }
+    }
+  }
+  if (j < coefficients_length) {
+    // The last tap of an odd length filter. Reading from one sample earlier
+    // stays within the input.
+    for (int b = 0; b < kNumBlocks; ++b) {
+      const __m128 lo = _mm_loadu_ps(&in[8 * b + j - 1]);
+      const __m128 hi = _mm_loadu_ps(&in[8 * b + j + 3]);
+      const __m128 even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+      for (int f = 0; f < kNumFilters; ++f) {
+        sums[f][b] = _mm_add_ps(
+            sums[f][b],
+            _mm_mul_ps(even, _mm_set1_ps(reversed_coefficients[f][j])));
+      }
+    }
+  }
+  const __m128 sign_mask = _mm_set1_ps(-0.f);
+  for (int f = 0; f < kNumFilters; ++f) {
+    for (int b = 0; b < kNumBlocks; ++b) {
+      _mm_storeu_ps(&outputs[f][first_output + 4 * b],
+                    _mm_andnot_ps(sign_mask, sums[f][b]));
+    }
+  }
+}
+
+template <int kNumFilters>
+void Filter(const float* input,
+            size_t output_length,
+            const float* const* reversed_coefficients,
+            size_t coefficients_length,
+            float* const* outputs) {
+  size_t i = 0;
+  for (; i + 8 <= output_length; i += 8) {
+    FilterBlocks<kNumFilters, 2>(input, i, reversed_coefficients,
+                                 coefficients_length, outputs);
+  }
+  if (i + 4 <= output_length) {
+    FilterBlocks<kNumFilters, 1>(input, i, reversed_coefficients,
+                                 coefficients_length, outputs);
+    i += 4;
+  }
+  for (; i < output_length; ++i) {
+    for (int f = 0; f < kNumFilters; ++f) {
+      outputs[f][i] = WPDFilterSample(&input[2 * i + 1],
+                                      reversed_coefficients[f],
+                                      coefficients_length);
+    }
+  }
+}
+
+}  // namespace
+
+void WPDFilter_SSE2(const float* input,
+                    size_t output_length,
+                    const float* const* reversed_coefficients,
+                    size_t coefficients_length,
+                    int num_filters,
+                    float* const* outputs) {
+  if (num_filters == 2) {
+    Filter<2>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  } else {
+    Filter<1>(input, output_length, reversed_coefficients, coefficients_length,
+              outputs);
+  }
+}
+
+}  // namespace webrtc
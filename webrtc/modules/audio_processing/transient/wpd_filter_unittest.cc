@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
+
+#include <math.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/transient/daubechies_8_wavelet_coeffs.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/modules/audio_processing/transient/wpd_filter_avx2.h"
+#include "webrtc/modules/audio_processing/transient/wpd_filter_sse2.h"
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+#include "webrtc/modules/audio_processing/transient/wpd_filter_neon.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+const size_t kMaxOutputLength = 37;
+
+// Runs |filter| with every output length up to |kMaxOutputLength|, which covers
+// whole vectors and the samples left after them, and compares it with a double
+// precision computation.
+void VerifyFilter(WPDFilterFunction filter) {
+  const float kOddCoefficients[] = {0.2f, -0.3f, 0.5f, -0.7f, 0.11f};
+  const float kIdentityCoefficient = 1.f;
+  const struct {
+    const float* coefficients[kMaxWPDFilters];
+    size_t length;
+  } kFilters[] = {
+      {{kDaubechies8LowPassCoefficients, kDaubechies8HighPassCoefficients},
+       kDaubechies8CoefficientsLength},
+      {{kOddCoefficients, kDaubechies8HighPassCoefficients}, 5},
+      {{&kIdentityCoefficient, kOddCoefficients}, 1},
+  };
+  for (const auto& filter_config : kFilters) {
+    // The input is sized exactly, so that reads past its end can be caught by
+    // memory checkers.
+    std::vector<float> input(filter_config.length - 1 + 2 * kMaxOutputLength);
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = 1000.f * sinf(0.7f * i) * cosf(0.05f * i);
+    }
+    for (int num_filters = 1; num_filters <= kMaxWPDFilters; ++num_filters) {
+      for (size_t output_length = 0; output_length <= kMaxOutputLength;
+           ++output_length) {
+        SCOPED_TRACE(filter_config.length);
+        SCOPED_TRACE(num_filters);
+        SCOPED_TRACE(output_length);
+        const float* input_end = &input[0] + input.size();
+        const float* start = input_end - (filter_config.length - 1) -
+                             2 * output_length;
+        std::vector<float> outputs[kMaxWPDFilters];
+        float* output_pointers[kMaxWPDFilters];
+        for (int f = 0; f < kMaxWPDFilters; ++f) {
+          outputs[f].assign(output_length + 1, -1.f);
+          output_pointers[f] = &outputs[f][0];
+        }
+        filter(start, output_length, filter_config.coefficients,
+               filter_config.length, num_filters, output_pointers);
+
+        for (int f = 0; f < kMaxWPDFilters; ++f) {
+          for (size_t i = 0; i < output_length; ++i) {
+            if (f >= num_filters) {
+              ASSERT_EQ(-1.f, outputs[f][i]);
+              continue;
+            }
+            double expected = 0.0;
+            for (size_t j = 0; j < filter_config.length; ++j) {
+              expected += static_cast<double>(start[2 * i + 1 + j]) *
+                          filter_config.coefficients[f][j];
+            }
+            ASSERT_NEAR(fabs(expected), outputs[f][i], 1e-3) << "sample " << i;
+          }
+          // Nothing is written past the end.
+          ASSERT_EQ(-1.f, outputs[f][output_length]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(WPDFilterTest, C) {
+  VerifyFilter(WPDFilter_C);
+}
+
+TEST(WPDFilterTest, Optimized) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    VerifyFilter(WPDFilter_SSE2);
+  }
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA)) {
+    VerifyFilter(WPDFilter_AVX2);
+  }
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+  if (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) {
+    VerifyFilter(WPDFilter_NEON);
+  }
+#endif
+  VerifyFilter(GetWPDFilterFunction());
+}
+
+}  // namespace webrtc
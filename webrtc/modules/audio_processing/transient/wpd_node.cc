@@ -11,51 +11,57 @@
 #include "webrtc/modules/audio_processing/transient/wpd_node.h"
 
 #include <assert.h>
-#include <math.h>
 #include <string.h>
 
 #include "webrtc/base/scoped_ptr.h"
-#include "webrtc/common_audio/fir_filter.h"
-#include "webrtc/modules/audio_processing/transient/dyadic_decimator.h"
 
 namespace webrtc {
 
 WPDNode::WPDNode(size_t length,
                  const float* coefficients,
                  size_t coefficients_length)
-    : // The data buffer has parent data length to be able to contain and filter
-      // it.
-      data_(new float[2 * length + 1]),
+    : owned_data_(new float[length]),
+      data_(owned_data_.get()),
       length_(length),
-      filter_(FIRFilter::Create(coefficients,
-                                coefficients_length,
-                                2 * length + 1)) {
+      coefficients_(new float[coefficients_length]),
+      coefficients_length_(coefficients_length),
+      filter_(GetWPDFilterFunction()),
+      // Room for the filter history and a parent data of odd length.
+      parent_data_(new float[coefficients_length + 2 * length]) {
   assert(length > 0 && coefficients && coefficients_length > 0);
-  memset(data_.get(), 0.f, (2 * length + 1) * sizeof(data_[0]));
+  memset(data_, 0, length * sizeof(data_[0]));
+  for (size_t i = 0; i < coefficients_length; ++i) {
+    coefficients_[i] = coefficients[coefficients_length - i - 1];
+  }
+  memset(parent_data_.get(), 0,
+         (coefficients_length - 1) * sizeof(parent_data_[0]));
+}
+
+WPDNode::WPDNode(size_t length, float* data)
+    : data_(data), length_(length), coefficients_length_(0), filter_(NULL) {
+  assert(length > 0 && data);
+  memset(data_, 0, length * sizeof(data_[0]));
 }
 
 WPDNode::~WPDNode() {}
 
 int WPDNode::Update(const float* parent_data, size_t parent_data_length) {
-  if (!parent_data || (parent_data_length / 2) != length_) {
+  if (!parent_data || (parent_data_length / 2) != length_ || !parent_data_) {
     return -1;
   }
 
-  // Filter data.
-  filter_->Filter(parent_data, parent_data_length, data_.get());
+  const size_t history_length = coefficients_length_ - 1;
+  memcpy(&parent_data_[history_length], parent_data,
+         parent_data_length * sizeof(parent_data[0]));
 
-  // Decimate data.
-  const bool kOddSequence = true;
-  size_t output_samples = DyadicDecimate(
-      data_.get(), parent_data_length, kOddSequence, data_.get(), length_);
-  if (output_samples != length_) {
-    return -1;
-  }
+  // Filter, decimate and get abs to all values.
+  const float* coefficients = coefficients_.get();
+  filter_(parent_data_.get(), length_, &coefficients, coefficients_length_, 1,
+          &data_);
 
-  // Get abs to all values.
-  for (size_t i = 0; i < length_; ++i) {
-    data_[i] = fabs(data_[i]);
-  }
+  // Keep the end of the parent data for the next update.
+  memmove(parent_data_.get(), &parent_data_[parent_data_length],
+          history_length * sizeof(parent_data_[0]));
 
   return 0;
 }
@@ -64,7 +70,7 @@ int WPDNode::set_data(const float* new_data, size_t length) {
   if (!new_data || length != length_) {
     return -1;
   }
-  memcpy(data_.get(), new_data, length * sizeof(data_[0]));
+  memcpy(data_, new_data, length * sizeof(data_[0]));
   return 0;
 }
 
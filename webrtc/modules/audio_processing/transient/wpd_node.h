@@ -12,12 +12,11 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_NODE_H_
 
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
 
-class FIRFilter;
-
 // A single node of a Wavelet Packet Decomposition (WPD) tree.
 class WPDNode {
  public:
@@ -30,15 +29,28 @@ class WPDNode {
   // Returns 0 if correct, and -1 otherwise.
   int Update(const float* parent_data, size_t parent_data_length);
 
-  const float* data() const { return data_.get(); }
+  const float* data() const { return data_; }
   // Returns 0 if correct, and -1 otherwise.
   int set_data(const float* new_data, size_t length);
   size_t length() const { return length_; }
 
  private:
-  rtc::scoped_ptr<float[]> data_;
+  friend class WPDTree;
+
+  // Creates a node of a WPDTree, whose data is stored in |data| by the tree.
+  // Update() is not available on such a node.
+  WPDNode(size_t length, float* data);
+
+  rtc::scoped_ptr<float[]> owned_data_;
+  float* data_;
   size_t length_;
-  rtc::scoped_ptr<FIRFilter> filter_;
+  // The filter coefficients, in reverse order.
+  rtc::scoped_ptr<float[]> coefficients_;
+  size_t coefficients_length_;
+  WPDFilterFunction filter_;
+  // The last |coefficients_length_| - 1 samples of the previous parent data,
+  // followed by room for the current parent data.
+  rtc::scoped_ptr<float[]> parent_data_;
 };
 
 }  // namespace webrtc
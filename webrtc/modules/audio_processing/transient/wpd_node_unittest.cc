@@ -10,10 +10,12 @@
 
 #include "webrtc/modules/audio_processing/transient/wpd_node.h"
 
+#include <math.h>
 #include <string.h>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/fir_filter.h"
 
 namespace webrtc {
 
@@ -55,6 +57,29 @@ TEST(WPDNodeTest, UpdateWithArbitraryDataAndArbitraryFilter) {
   EXPECT_NEAR(0.94f, node.data()[4], kTolerance);
 }
 
+// Compares consecutive updates with parent data of odd length against filtering
+// the whole parent data with a FIRFilter and decimating it.
+TEST(WPDNodeTest, UpdateKeepsFilterStateBetweenCalls) {
+  const size_t kLength = 9;
+  const size_t kOddParentDataLength = 2 * kLength + 1;
+  WPDNode node(kLength, kCoefficients, kCoefficientsLength);
+  rtc::scoped_ptr<FIRFilter> filter(FIRFilter::Create(
+      kCoefficients, kCoefficientsLength, kOddParentDataLength));
+  float parent_data[kOddParentDataLength];
+  float filtered_data[kOddParentDataLength];
+  for (int update = 0; update < 5; ++update) {
+    for (size_t i = 0; i < kOddParentDataLength; ++i) {
+      parent_data[i] = sinf(0.3f * (update * kOddParentDataLength + i));
+    }
+    filter->Filter(parent_data, kOddParentDataLength, filtered_data);
+    ASSERT_EQ(0, node.Update(parent_data, kOddParentDataLength));
+    for (size_t i = 0; i < kLength; ++i) {
+      EXPECT_NEAR(fabsf(filtered_data[2 * i + 1]), node.data()[i], kTolerance)
+          << "update " << update << ", sample " << i;
+    }
+  }
+}
+
 TEST(WPDNodeTest, ExpectedErrorReturnValue) {
   WPDNode node(kDataLength, kCoefficients, kCoefficientsLength);
   EXPECT_EQ(-1, node.Update(kParentData, kParentDataLength - 1));
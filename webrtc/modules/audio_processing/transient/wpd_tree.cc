@@ -11,11 +11,10 @@
 #include "webrtc/modules/audio_processing/transient/wpd_tree.h"
 
 #include <assert.h>
-#include <math.h>
 #include <string.h>
 
 #include "webrtc/base/scoped_ptr.h"
-#include "webrtc/modules/audio_processing/transient/dyadic_decimator.h"
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
 #include "webrtc/modules/audio_processing/transient/wpd_node.h"
 
 namespace webrtc {
@@ -25,42 +24,50 @@ WPDTree::WPDTree(size_t data_length, const float* high_pass_coefficients,
                  int levels)
     : data_length_(data_length),
       levels_(levels),
-      num_nodes_((1 << (levels + 1)) - 1) {
+      num_nodes_((1 << (levels + 1)) - 1),
+      coefficients_length_(coefficients_length),
+      filter_(GetWPDFilterFunction()),
+      low_pass_coefficients_(new float[coefficients_length]),
+      high_pass_coefficients_(new float[coefficients_length]) {
   assert(data_length > (static_cast<size_t>(1) << levels) &&
          high_pass_coefficients &&
          low_pass_coefficients &&
+         coefficients_length > 0 &&
          levels > 0);
+  for (size_t i = 0; i < coefficients_length; ++i) {
+    low_pass_coefficients_[i] =
+        low_pass_coefficients[coefficients_length - i - 1];
+    high_pass_coefficients_[i] =
+        high_pass_coefficients[coefficients_length - i - 1];
+  }
+
+  // The length of the nodes is halved at every level.
+  const size_t history_length = coefficients_length - 1;
+  size_t node_data_length = 0;
+  for (int level = 0; level <= levels; ++level) {
+    node_data_length += (data_length >> level) << level;
+    if (level < levels) {
+      node_data_length += history_length << level;
+    }
+  }
+  node_data_.reset(new float[node_data_length]);
+  memset(node_data_.get(), 0, node_data_length * sizeof(node_data_[0]));
+
   // Size is 1 more, so we can use the array as 1-based. nodes_[0] is never
   // allocated.
   nodes_.reset(new rtc::scoped_ptr<WPDNode>[num_nodes_ + 1]);
-
-  // Create the first node
-  const float kRootCoefficient = 1.f;  // Identity Coefficient.
-  nodes_[1].reset(new WPDNode(data_length, &kRootCoefficient, 1));
-  // Variables used to create the rest of the nodes.
-  size_t index = 1;
-  size_t index_left_child = 0;
-  size_t index_right_child = 0;
-
-  int num_nodes_at_curr_level = 0;
-
-  // Branching each node in each level to create its children. The last level is
-  // not branched (all the nodes of that level are leaves).
-  for (int current_level = 0; current_level < levels; ++current_level) {
-    num_nodes_at_curr_level = 1 << current_level;
-    for (int i = 0; i < num_nodes_at_curr_level; ++i) {
-      index = (1 << current_level) + i;
-      // Obtain the index of the current node children.
-      index_left_child = index * 2;
-      index_right_child = index_left_child + 1;
-      nodes_[index_left_child].reset(new WPDNode(nodes_[index]->length() / 2,
-                                                 low_pass_coefficients,
-                                                 coefficients_length));
-      nodes_[index_right_child].reset(new WPDNode(nodes_[index]->length() / 2,
-                                                  high_pass_coefficients,
-                                                  coefficients_length));
+  float* next_node_data = node_data_.get();
+  int index = 1;
+  for (int level = 0; level <= levels; ++level) {
+    for (int i = 0; i < NumberOfNodesAtLevel(level); ++i, ++index) {
+      if (level < levels) {
+        next_node_data += history_length;
+      }
+      nodes_[index].reset(new WPDNode(data_length >> level, next_node_data));
+      next_node_data += data_length >> level;
     }
   }
+  assert(next_node_data == node_data_.get() + node_data_length);
 }
 
 WPDTree::~WPDTree() {}
@@ -84,33 +91,25 @@ int WPDTree::Update(const float* data, size_t data_length) {
     return -1;
   }
 
-  // Variables used to update the rest of the nodes.
-  size_t index = 1;
-  size_t index_left_child = 0;
-  size_t index_right_child = 0;
-
-  int num_nodes_at_curr_level = 0;
-
-  for (int current_level = 0; current_level < levels_; ++current_level) {
-    num_nodes_at_curr_level = 1 << current_level;
-    for (int i = 0; i < num_nodes_at_curr_level; ++i) {
-      index = (1 << current_level) + i;
-      // Obtain the index of the current node children.
-      index_left_child = index * 2;
-      index_right_child = index_left_child + 1;
-
-      update_result = nodes_[index_left_child]->Update(
-          nodes_[index]->data(), nodes_[index]->length());
-      if (update_result != 0) {
-        return -1;
-      }
-
-      update_result = nodes_[index_right_child]->Update(
-          nodes_[index]->data(), nodes_[index]->length());
-      if (update_result != 0) {
-        return -1;
-      }
-    }
+  const size_t history_length = coefficients_length_ - 1;
+  const float* coefficients[kMaxWPDFilters] = {low_pass_coefficients_.get(),
+                                               high_pass_coefficients_.get()};
+  // The nodes are stored level by level, so every node is updated before its
+  // children. The last level is not branched (all the nodes of that level are
+  // leaves).
+  for (int index = 1; index < NumberOfNodesAtLevel(levels_); ++index) {
+    WPDNode* node = nodes_[index].get();
+    WPDNode* left_child = nodes_[index * 2].get();
+    WPDNode* right_child = nodes_[index * 2 + 1].get();
+    float* children_data[kMaxWPDFilters] = {left_child->data_,
+                                            right_child->data_};
+    float* input = node->data_ - history_length;
+    filter_(input, left_child->length(), coefficients, coefficients_length_,
+            kMaxWPDFilters, children_data);
+
+    // Keep the end of the node data for the next update.
+    memmove(input, &input[node->length()],
+            history_length * sizeof(input[0]));
   }
 
   return 0;
@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_TRANSIENT_WPD_TREE_H_
 
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/audio_processing/transient/wpd_filter.h"
 #include "webrtc/modules/audio_processing/transient/wpd_node.h"
 
 namespace webrtc {
@@ -35,6 +36,9 @@ namespace webrtc {
 // Left Child: Current node index * 2.
 // Right Child: Current node index * 2 + 1.
 // Parent: Current Node Index / 2 (Integer division).
+// The data of all the nodes is stored in a single buffer, allocated on
+// creation. The two children of a node are updated together, in a single pass
+// over the data of their parent.
 class WPDTree {
  public:
   // Creates a WPD tree using the data length and coefficients provided.
@@ -83,6 +87,15 @@ class WPDTree {
   size_t data_length_;
   int levels_;
   int num_nodes_;
+  size_t coefficients_length_;
+  WPDFilterFunction filter_;
+  // The filter coefficients of the left and right children, in reverse order.
+  rtc::scoped_ptr<float[]> low_pass_coefficients_;
+  rtc::scoped_ptr<float[]> high_pass_coefficients_;
+  // The data of all the nodes, level by level. The data of every node which is
+  // not a leaf is preceded by the last |coefficients_length_| - 1 samples of
+  // its previous data, needed to filter it into its children.
+  rtc::scoped_ptr<float[]> node_data_;
   rtc::scoped_ptr<rtc::scoped_ptr<WPDNode>[]> nodes_;
 };
 
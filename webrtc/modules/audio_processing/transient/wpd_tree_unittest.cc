@@ -10,18 +10,87 @@
 
 #include "webrtc/modules/audio_processing/transient/wpd_tree.h"
 
+#include <math.h>
+#include <stdio.h>
+
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/fir_filter.h"
 #include "webrtc/modules/audio_processing/transient/daubechies_8_wavelet_coeffs.h"
+#include "webrtc/modules/audio_processing/transient/dyadic_decimator.h"
 #include "webrtc/modules/audio_processing/transient/file_utils.h"
 #include "webrtc/system_wrappers/interface/file_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/test/testsupport/fileutils.h"
 #include "webrtc/test/testsupport/gtest_disable.h"
 
 namespace webrtc {
+namespace {
+
+// A WPD tree updated one node at a time with a FIRFilter and DyadicDecimate(),
+// the way WPDTree used to be implemented.
+class ReferenceWPDTree {
+ public:
+  ReferenceWPDTree(size_t data_length,
+                   const float* high_pass_coefficients,
+                   const float* low_pass_coefficients,
+                   size_t coefficients_length,
+                   int levels)
+      : node_lengths_(1 << (levels + 1)), node_data_(node_lengths_.size()) {
+    // As in WPDTree, index 0 is not used.
+    node_lengths_[1] = data_length;
+    node_data_[1].resize(data_length);
+    filters_.push_back(NULL);
+    filters_.push_back(NULL);
+    for (size_t index = 2; index < node_lengths_.size(); ++index) {
+      node_lengths_[index] = node_lengths_[index / 2] / 2;
+      // Room to filter the parent data before decimating it.
+      node_data_[index].resize(2 * node_lengths_[index] + 1);
+      filters_.push_back(FIRFilter::Create(
+          index % 2 == 0 ? low_pass_coefficients : high_pass_coefficients,
+          coefficients_length, 2 * node_lengths_[index] + 1));
+    }
+  }
+
+  void Update(const float* data) {
+    memcpy(&node_data_[1][0], data, node_lengths_[1] * sizeof(data[0]));
+    for (size_t index = 2; index < node_lengths_.size(); ++index) {
+      const size_t parent_length = node_lengths_[index / 2];
+      float* node_data = &node_data_[index][0];
+      filters_[index]->Filter(&node_data_[index / 2][0], parent_length,
+                              node_data);
+      DyadicDecimate(node_data, parent_length, true, node_data,
+                     node_lengths_[index]);
+      for (size_t i = 0; i < node_lengths_[index]; ++i) {
+        node_data[i] = fabsf(node_data[i]);
+      }
+    }
+  }
+
+  const float* NodeData(int level, int index) const {
+    return &node_data_[(1 << level) + index][0];
+  }
+
+ private:
+  std::vector<size_t> node_lengths_;
+  std::vector<std::vector<float> > node_data_;
+  ScopedVector<FIRFilter> filters_;
+};
+
+void GenerateData(int update, size_t length, float* data) {
+  for (size_t i = 0; i < length; ++i) {
+    const float t = static_cast<float>(update * length + i);
+    data[i] = 1000.f * sinf(0.01f * t) * sinf(0.37f * t) +
+              (i % 53 == 0 ? 5000.f : 0.f);
+  }
+}
+
+}  // namespace
 
 TEST(WPDTreeTest, Construction) {
   const size_t kTestBufferSize = 100;
@@ -63,6 +132,87 @@ TEST(WPDTreeTest, Construction) {
   EXPECT_EQ(-1, tree.Update(test_buffer, kTestBufferSize - 1));
 }
 
+// Covers the lengths used by TransientDetector, and node lengths which are odd
+// or not multiples of 4.
+TEST(WPDTreeTest, MatchesFilterAndDecimateReference) {
+  const size_t kDataLengths[] = {80, 160, 320, 480, 100, 75};
+  const int kLevels = 3;
+  const float kOddCoefficients[] = {0.2f, -0.3f, 0.5f, -0.7f, 0.11f};
+  // The data reaches 6000, and the filters may sum the products in another
+  // order.
+  const float kTolerance = 0.01f;
+  for (size_t data_length : kDataLengths) {
+    for (int odd = 0; odd < 2; ++odd) {
+      SCOPED_TRACE(data_length);
+      SCOPED_TRACE(odd);
+      const float* high_pass_coefficients =
+          odd ? kOddCoefficients : kDaubechies8HighPassCoefficients;
+      const float* low_pass_coefficients =
+          odd ? kOddCoefficients : kDaubechies8LowPassCoefficients;
+      const size_t coefficients_length =
+          odd ? sizeof(kOddCoefficients) / sizeof(kOddCoefficients[0])
+              : kDaubechies8CoefficientsLength;
+      WPDTree tree(data_length, high_pass_coefficients, low_pass_coefficients,
+                   coefficients_length, kLevels);
+      ReferenceWPDTree reference(data_length, high_pass_coefficients,
+                                 low_pass_coefficients, coefficients_length,
+                                 kLevels);
+      rtc::scoped_ptr<float[]> data(new float[data_length]);
+      for (int update = 0; update < 10; ++update) {
+        GenerateData(update, data_length, data.get());
+        ASSERT_EQ(0, tree.Update(data.get(), data_length));
+        reference.Update(data.get());
+        for (int level = 0; level <= kLevels; ++level) {
+          for (int i = 0; i < WPDTree::NumberOfNodesAtLevel(level); ++i) {
+            const WPDNode* node = tree.NodeAt(level, i);
+            const float* expected = reference.NodeData(level, i);
+            for (size_t j = 0; j < node->length(); ++j) {
+              ASSERT_NEAR(expected[j], node->data()[j], kTolerance)
+                  << "update " << update << ", node (" << level << ", " << i
+                  << "), sample " << j;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Prints the cost of updating the tree of TransientDetector for one 10 ms
+// chunk, compared to filtering and decimating one node at a time.
+TEST(WPDTreeTest, DISABLED_Benchmark) {
+  const int kNumUpdates = 10000;
+  const int kLevels = 3;
+  const int kSampleRatesHz[] = {16000, 32000, 48000};
+  for (int sample_rate_hz : kSampleRatesHz) {
+    const size_t data_length = static_cast<size_t>(sample_rate_hz / 100);
+    WPDTree tree(data_length, kDaubechies8HighPassCoefficients,
+                 kDaubechies8LowPassCoefficients,
+                 kDaubechies8CoefficientsLength, kLevels);
+    ReferenceWPDTree reference(data_length, kDaubechies8HighPassCoefficients,
+                               kDaubechies8LowPassCoefficients,
+                               kDaubechies8CoefficientsLength, kLevels);
+    rtc::scoped_ptr<float[]> data(new float[data_length]);
+    GenerateData(0, data_length, data.get());
+
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kNumUpdates; ++i) {
+      reference.Update(data.get());
+    }
+    const int64_t reference_us = (TickTime::Now() - start).Microseconds();
+    start = TickTime::Now();
+    for (int i = 0; i < kNumUpdates; ++i) {
+      tree.Update(data.get(), data_length);
+    }
+    const int64_t tree_us = (TickTime::Now() - start).Microseconds();
+
+    printf("%d Hz: reference %.2f us, WPDTree %.2f us per chunk (%.2fx)\n",
+           sample_rate_hz, static_cast<double>(reference_us) / kNumUpdates,
+           static_cast<double>(tree_us) / kNumUpdates,
+           static_cast<double>(reference_us) / tree_us);
+  }
+}
+
 // This test is for the correctness of the tree.
 // Checks the results from the Matlab equivalent, it is done comparing the
 // results that are stored in the output files from Matlab.
@@ -14,6 +14,7 @@ namespace webrtc {
 
 DesktopCaptureOptions::DesktopCaptureOptions()
     : use_update_notifications_(true),
+      use_capture_thread_(false),
       disable_effects_(true) {
 #if defined(USE_X11)
   // XDamage is often broken, so don't use it by default.
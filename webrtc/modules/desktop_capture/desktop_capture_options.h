@@ -69,6 +69,16 @@ class DesktopCaptureOptions {
     use_update_notifications_ = use_update_notifications;
   }
 
+  // Flag indicating that the screen capturer should grab frames on a dedicated
+  // thread, while the previous frame is diffed and delivered. Each Capture()
+  // call then delivers the frame grabbed at the end of the previous call, so
+  // this trades up to one capture interval of latency for throughput.
+  // Currently used only by the X11 capturer.
+  bool use_capture_thread() const { return use_capture_thread_; }
+  void set_use_capture_thread(bool use_capture_thread) {
+    use_capture_thread_ = use_capture_thread;
+  }
+
   // Flag indicating if desktop effects (e.g. Aero) should be disabled when the
   // capturer is active. Currently used only on Windows.
   bool disable_effects() const { return disable_effects_; }
@@ -100,6 +110,7 @@ class DesktopCaptureOptions {
   bool allow_use_magnification_api_;
 #endif
   bool use_update_notifications_;
+  bool use_capture_thread_;
   bool disable_effects_;
 };
 
@@ -147,6 +147,32 @@ void DesktopRegion::AddRects(const DesktopRect* rects, int count) {
   }
 }
 
+void DesktopRegion::AppendRow(const DesktopRect* rects, int count) {
+  if (count <= 0)
+    return;
+
+  const int32_t top = rects[0].top();
+  const int32_t bottom = rects[0].bottom();
+  bool can_append = top < bottom &&
+                    (rows_.empty() || rows_.rbegin()->first <= top);
+  for (int i = 0; i < count && can_append; ++i) {
+    can_append = rects[i].top() == top && rects[i].bottom() == bottom &&
+                 rects[i].left() < rects[i].right() &&
+                 (i == 0 || rects[i - 1].right() < rects[i].left());
+  }
+  if (!can_append) {
+    AddRects(rects, count);
+    return;
+  }
+
+  Rows::iterator row = rows_.insert(
+      rows_.end(), Rows::value_type(bottom, new Row(top, bottom)));
+  row->second->spans.reserve(count);
+  for (int i = 0; i < count; ++i)
+    row->second->spans.push_back(RowSpan(rects[i].left(), rects[i].right()));
+  MergeWithPrecedingRow(row);
+}
+
 void DesktopRegion::MergeWithPrecedingRow(Rows::iterator row) {
   assert(row != rows_.end());
 
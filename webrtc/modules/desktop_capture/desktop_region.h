@@ -111,6 +111,14 @@ class DesktopRegion {
   void AddRects(const DesktopRect* rects, int count);
   void AddRegion(const DesktopRegion& region);
 
+  // Adds |count| rects that form a single row below the current content of
+  // the region, i.e. all of them have the same top and bottom, no higher than
+  // the bottom of the region, and are sorted left to right without touching
+  // each other. This is much cheaper than AddRects() when a region is built
+  // from top to bottom. Rects that don't meet these conditions are added with
+  // AddRects().
+  void AppendRow(const DesktopRect* rects, int count);
+
   // Finds intersection of two regions and stores them in the current region.
   void Intersect(const DesktopRegion& region1, const DesktopRegion& region2);
 
@@ -11,6 +11,7 @@
 #include "webrtc/modules/desktop_capture/desktop_region.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -687,6 +688,65 @@ TEST(DesktopRegionTest, SubtractRectOnSameCol) {
 }
 
 
+// Verify that AppendRow() builds the same region as AddRects(), and falls back
+// to it for rects which don't form a row below the region.
+TEST(DesktopRegionTest, AppendRow) {
+  for (int c = 0; c < 100; ++c) {
+    SCOPED_TRACE(c);
+    DesktopRegion appended;
+    DesktopRegion added;
+    int top = 0;
+    for (int y = 0; y < 20; ++y) {
+      const int bottom = top + 1 + RadmonInt(3) * 10;
+      std::vector<DesktopRect> row;
+      int left = RadmonInt(5);
+      while (left < 200) {
+        const int right = left + 1 + RadmonInt(30);
+        row.push_back(DesktopRect::MakeLTRB(left, top, right, bottom));
+        left = right + 1 + RadmonInt(30);
+      }
+      appended.AppendRow(&row[0], static_cast<int>(row.size()));
+      added.AddRects(&row[0], static_cast<int>(row.size()));
+      top = RadmonInt(2) ? bottom : bottom + RadmonInt(10);
+    }
+    EXPECT_TRUE(appended.Equals(added));
+  }
+
+  // Rows of identical spans are merged.
+  DesktopRegion r;
+  DesktopRect row1[] = { DesktopRect::MakeLTRB(0, 0, 10, 10),
+                         DesktopRect::MakeLTRB(20, 0, 30, 10) };
+  DesktopRect row2[] = { DesktopRect::MakeLTRB(0, 10, 10, 20),
+                         DesktopRect::MakeLTRB(20, 10, 30, 20) };
+  r.AppendRow(row1, 2);
+  r.AppendRow(row2, 2);
+  DesktopRect expected_rects[] = { DesktopRect::MakeLTRB(0, 0, 10, 20),
+                                   DesktopRect::MakeLTRB(20, 0, 30, 20) };
+  CompareRegion(r, expected_rects, 2);
+
+  // Touching, unsorted, misaligned and overlapping rects.
+  DesktopRect invalid_rows[][2] = {
+    { DesktopRect::MakeLTRB(0, 20, 10, 30),
+      DesktopRect::MakeLTRB(10, 20, 15, 30) },
+    { DesktopRect::MakeLTRB(20, 20, 30, 30),
+      DesktopRect::MakeLTRB(0, 20, 10, 30) },
+    { DesktopRect::MakeLTRB(0, 20, 10, 30),
+      DesktopRect::MakeLTRB(20, 21, 30, 30) },
+    { DesktopRect::MakeLTRB(0, 5, 10, 30),
+      DesktopRect::MakeLTRB(20, 5, 30, 30) },
+    { DesktopRect::MakeLTRB(0, 20, 10, 30),
+      DesktopRect::MakeLTRB(20, 20, 20, 30) },
+  };
+  for (size_t i = 0; i < sizeof(invalid_rows) / sizeof(invalid_rows[0]); ++i) {
+    SCOPED_TRACE(i);
+    DesktopRegion appended(row1, 2);
+    DesktopRegion added(row1, 2);
+    appended.AppendRow(invalid_rows[i], 2);
+    added.AddRects(invalid_rows[i], 2);
+    EXPECT_TRUE(appended.Equals(added));
+  }
+}
+
 TEST(DesktopRegionTest, DISABLED_Performance) {
   for (int c = 0; c < 1000; ++c) {
     DesktopRegion r;
@@ -10,26 +10,113 @@
 
 #include "webrtc/modules/desktop_capture/differ.h"
 
-#include "string.h"
+#include <assert.h>
+#include <string.h>
 
-#include "webrtc/modules/desktop_capture/differ_block.h"
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace webrtc {
 
-Differ::Differ(int width, int height, int bpp, int stride) {
-  // Dimensions of screen.
-  width_ = width;
-  height_ = height;
-  bytes_per_pixel_ = bpp;
-  bytes_per_row_ = stride;
-
-  // Calc number of blocks (full and partial) required to cover entire image.
-  // One additional row/column is added as a boundary on the right & bottom.
-  diff_info_width_ = ((width_ + kBlockSize - 1) / kBlockSize) + 1;
-  diff_info_height_ = ((height_ + kBlockSize - 1) / kBlockSize) + 1;
-  diff_info_size_ = diff_info_width_ * diff_info_height_ * sizeof(bool);
-  diff_info_.reset(new bool[diff_info_size_]);
+class Differ::Worker {
+ public:
+  Worker(Differ* differ, int first_row, int end_row)
+      : differ_(differ),
+        first_row_(first_row),
+        end_row_(end_row),
+        prev_buffer_(nullptr),
+        curr_buffer_(nullptr),
+        stop_(false) {}
+
+  ~Worker() {
+    if (thread_) {
+      stop_ = true;
+      start_event_->Set();
+      thread_->Stop();
+    }
+  }
+
+  bool StartThread() {
+    start_event_.reset(EventWrapper::Create());
+    done_event_.reset(EventWrapper::Create());
+    thread_ = ThreadWrapper::CreateThread(&Worker::Run, this, "differ_worker");
+    return thread_->Start();
+  }
+
+  // Hands the buffers to the worker thread.
+  void MarkDirtyBlocksAsync(const uint8_t* prev_buffer,
+                            const uint8_t* curr_buffer) {
+    prev_buffer_ = prev_buffer;
+    curr_buffer_ = curr_buffer;
+    start_event_->Set();
+  }
+
+  void WaitForCompletion() { done_event_->Wait(WEBRTC_EVENT_INFINITE); }
+
+ private:
+  static bool Run(void* obj) { return static_cast<Worker*>(obj)->RunOnce(); }
+
+  bool RunOnce() {
+    start_event_->Wait(WEBRTC_EVENT_INFINITE);
+    if (stop_)
+      return false;
+    differ_->MarkDirtyBlockRows(prev_buffer_, curr_buffer_, first_row_,
+                                end_row_);
+    done_event_->Set();
+    return true;
+  }
+
+  Differ* const differ_;
+  const int first_row_;
+  const int end_row_;
+
+  // Handshake with the worker thread. The buffers and |stop_| are only
+  // written before setting the event the other thread waits on.
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  rtc::scoped_ptr<EventWrapper> start_event_;
+  rtc::scoped_ptr<EventWrapper> done_event_;
+  const uint8_t* prev_buffer_;
+  const uint8_t* curr_buffer_;
+  bool stop_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+Differ::Differ(int width, int height, int bpp, int stride)
+    : Differ(width, height, bpp, stride, 1) {}
+
+Differ::Differ(int width, int height, int bpp, int stride, int num_threads)
+    : width_(width),
+      height_(height),
+      bytes_per_pixel_(bpp),
+      bytes_per_row_(stride),
+      block_difference_(GetBlockDifferenceFunction()),
+      // Covers the entire image with full and partial blocks.
+      dirty_blocks_(DesktopSize(width, height), kBlockSize),
+      first_worker_row_(dirty_blocks_.height()) {
+  const int num_rows = dirty_blocks_.height();
+  num_threads = std::max(1, std::min(num_threads, num_rows));
+
+  // Spreads the remainder over the first bands.
+  int end_row = 0;
+  for (int i = 0; i < num_threads; ++i) {
+    const int first_row = end_row;
+    end_row += num_rows / num_threads + (i < num_rows % num_threads ? 1 : 0);
+    if (i == 0) {
+      first_worker_row_ = end_row;
+      continue;
+    }
+    workers_.push_back(new Worker(this, first_row, end_row));
+    if (!workers_.back()->StartThread()) {
+      LOG(LS_WARNING) << "Failed to start a differ thread, using one thread.";
+      workers_.clear();
+      first_worker_row_ = num_rows;
+      break;
+    }
+  }
 }
 
 Differ::~Differ() {}
@@ -47,75 +134,58 @@ void Differ::CalcDirtyRegion(const uint8_t* prev_buffer,
 
 void Differ::MarkDirtyBlocks(const uint8_t* prev_buffer,
                              const uint8_t* curr_buffer) {
-  memset(diff_info_.get(), 0, diff_info_size_);
+  dirty_blocks_.Clear();
 
-  // Calc number of full blocks.
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->MarkDirtyBlocksAsync(prev_buffer, curr_buffer);
+  MarkDirtyBlockRows(prev_buffer, curr_buffer, 0, first_worker_row_);
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->WaitForCompletion();
+}
+
+void Differ::MarkDirtyBlockRows(const uint8_t* prev_buffer,
+                                const uint8_t* curr_buffer,
+                                int first_row,
+                                int end_row) {
+  // Calc number of full blocks in a row.
   int x_full_blocks = width_ / kBlockSize;
-  int y_full_blocks = height_ / kBlockSize;
 
-  // Calc size of partial blocks which may be present on right and bottom edge.
+  // Calc size of the partial block which may be present on the right edge.
   int partial_column_width = width_ - (x_full_blocks * kBlockSize);
-  int partial_row_height = height_ - (y_full_blocks * kBlockSize);
 
   // Offset from the start of one block-column to the next.
   int block_x_offset = bytes_per_pixel_ * kBlockSize;
   // Offset from the start of one block-row to the next.
-  int block_y_stride = (width_ * bytes_per_pixel_) * kBlockSize;
-  // Offset from the start of one diff_info row to the next.
-  int diff_info_stride = diff_info_width_ * sizeof(bool);
-
-  const uint8_t* prev_block_row_start = prev_buffer;
-  const uint8_t* curr_block_row_start = curr_buffer;
-  bool* diff_info_row_start = diff_info_.get();
+  int block_y_stride = bytes_per_row_ * kBlockSize;
 
-  for (int y = 0; y < y_full_blocks; y++) {
-    const uint8_t* prev_block = prev_block_row_start;
-    const uint8_t* curr_block = curr_block_row_start;
-    bool* diff_info = diff_info_row_start;
+  for (int y = first_row; y < end_row; y++) {
+    const uint8_t* prev_block = prev_buffer + y * block_y_stride;
+    const uint8_t* curr_block = curr_buffer + y * block_y_stride;
 
+    // The last row is partial if the screen height is not a multiple of the
+    // block size. This situation is far more common than the 'partial column'
+    // case.
+    int block_height = std::min(kBlockSize, height_ - y * kBlockSize);
     for (int x = 0; x < x_full_blocks; x++) {
       // Mark this block as being modified so that it gets incorporated into
       // a dirty rect.
-      *diff_info = BlockDifference(prev_block, curr_block, bytes_per_row_);
+      bool changed =
+          block_height == kBlockSize
+              ? block_difference_(prev_block, curr_block, bytes_per_row_)
+              : !PartialBlocksEqual(prev_block, curr_block, bytes_per_row_,
+                                    kBlockSize, block_height);
+      if (changed)
+        dirty_blocks_.Set(x, y);
       prev_block += block_x_offset;
       curr_block += block_x_offset;
-      diff_info += sizeof(bool);
     }
 
     // If there is a partial column at the end, handle it.
     // This condition should rarely, if ever, occur.
-    if (partial_column_width != 0) {
-      *diff_info = !PartialBlocksEqual(prev_block, curr_block, bytes_per_row_,
-                                       partial_column_width, kBlockSize);
-      diff_info += sizeof(bool);
-    }
-
-    // Update pointers for next row.
-    prev_block_row_start += block_y_stride;
-    curr_block_row_start += block_y_stride;
-    diff_info_row_start += diff_info_stride;
-  }
-
-  // If the screen height is not a multiple of the block size, then this
-  // handles the last partial row. This situation is far more common than the
-  // 'partial column' case.
-  if (partial_row_height != 0) {
-    const uint8_t* prev_block = prev_block_row_start;
-    const uint8_t* curr_block = curr_block_row_start;
-    bool* diff_info = diff_info_row_start;
-    for (int x = 0; x < x_full_blocks; x++) {
-      *diff_info = !PartialBlocksEqual(prev_block, curr_block,
-                                       bytes_per_row_,
-                                       kBlockSize, partial_row_height);
-      prev_block += block_x_offset;
-      curr_block += block_x_offset;
-      diff_info += sizeof(bool);
-    }
-    if (partial_column_width != 0) {
-      *diff_info = !PartialBlocksEqual(prev_block, curr_block, bytes_per_row_,
-                                       partial_column_width,
-                                       partial_row_height);
-      diff_info += sizeof(bool);
+    if (partial_column_width != 0 &&
+        !PartialBlocksEqual(prev_block, curr_block, bytes_per_row_,
+                            partial_column_width, block_height)) {
+      dirty_blocks_.Set(x_full_blocks, y);
     }
   }
 }
@@ -134,78 +204,7 @@ bool Differ::PartialBlocksEqual(const uint8_t* prev_buffer,
 }
 
 void Differ::MergeBlocks(DesktopRegion* region) {
-  region->Clear();
-
-  bool* diff_info_row_start = diff_info_.get();
-  int diff_info_stride = diff_info_width_ * sizeof(bool);
-
-  for (int y = 0; y < diff_info_height_; y++) {
-    bool* diff_info = diff_info_row_start;
-    for (int x = 0; x < diff_info_width_; x++) {
-      if (*diff_info) {
-        // We've found a modified block. Look at blocks to the right and below
-        // to group this block with as many others as we can.
-        int left = x * kBlockSize;
-        int top = y * kBlockSize;
-        int width = 1;
-        int height = 1;
-        *diff_info = false;
-
-        // Group with blocks to the right.
-        // We can keep looking until we find an unchanged block because we
-        // have a boundary block which is never marked as having diffs.
-        bool* right = diff_info + 1;
-        while (*right) {
-          *right++ = false;
-          width++;
-        }
-
-        // Group with blocks below.
-        // The entire width of blocks that we matched above much match for
-        // each row that we add.
-        bool* bottom = diff_info;
-        bool found_new_row;
-        do {
-          found_new_row = true;
-          bottom += diff_info_stride;
-          right = bottom;
-          for (int x2 = 0; x2 < width; x2++) {
-            if (!*right++) {
-              found_new_row = false;
-            }
-          }
-
-          if (found_new_row) {
-            height++;
-
-            // We need to go back and erase the diff markers so that we don't
-            // try to add these blocks a second time.
-            right = bottom;
-            for (int x2 = 0; x2 < width; x2++) {
-              *right++ = false;
-            }
-          }
-        } while (found_new_row);
-
-        // Add rect to list of dirty rects.
-        width *= kBlockSize;
-        if (left + width > width_) {
-          width = width_ - left;
-        }
-        height *= kBlockSize;
-        if (top + height > height_) {
-          height = height_ - top;
-        }
-        region->AddRect(DesktopRect::MakeXYWH(left, top, width, height));
-      }
-
-      // Increment to next block in this row.
-      diff_info++;
-    }
-
-    // Go to start of next row.
-    diff_info_row_start += diff_info_stride;
-  }
+  dirty_blocks_.ToRegion(region);
 }
 
 }  // namespace webrtc
@@ -11,17 +11,13 @@
 #ifndef WEBRTC_MODULES_DESKTOP_CAPTURE_DIFFER_H_
 #define WEBRTC_MODULES_DESKTOP_CAPTURE_DIFFER_H_
 
-#include <vector>
-
-#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/desktop_capture/desktop_region.h"
+#include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/modules/desktop_capture/dirty_block_bitmap.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 namespace webrtc {
 
-// TODO(sergeyu): Simplify differ now that we are working with DesktopRegion.
-// diff_info_ should no longer be needed, as we can put our data directly into
-// the region that we are calculating.
-// http://crbug.com/92379
 // TODO(sergeyu): Rename this class to something more sensible, e.g.
 // ScreenCaptureFrameDifferencer.
 class Differ {
@@ -29,12 +25,19 @@ class Differ {
   // Create a differ that operates on bitmaps with the specified width, height
   // and bytes_per_pixel.
   Differ(int width, int height, int bytes_per_pixel, int stride);
+  // Same as above, but the rows of blocks are split into |num_threads| bands
+  // that are compared in parallel, one of them on the thread calling
+  // CalcDirtyRegion(). Fewer threads are used if the screen has fewer rows of
+  // blocks, and a single one if the threads can't be started.
+  Differ(int width, int height, int bytes_per_pixel, int stride,
+         int num_threads);
   ~Differ();
 
   int width() { return width_; }
   int height() { return height_; }
   int bytes_per_pixel() { return bytes_per_pixel_; }
   int bytes_per_row() { return bytes_per_row_; }
+  int num_threads() { return static_cast<int>(workers_.size()) + 1; }
 
   // Given the previous and current screen buffer, calculate the dirty region
   // that encloses all of the changed pixels in the new screen.
@@ -45,9 +48,18 @@ class Differ {
   // Allow tests to access our private parts.
   friend class DifferTest;
 
+  // Compares a band of rows of blocks on its own thread.
+  class Worker;
+
   // Identify all of the blocks that contain changed pixels.
   void MarkDirtyBlocks(const uint8_t* prev_buffer, const uint8_t* curr_buffer);
 
+  // Same as above, for the rows of blocks in [|first_row|, |end_row|).
+  void MarkDirtyBlockRows(const uint8_t* prev_buffer,
+                          const uint8_t* curr_buffer,
+                          int first_row,
+                          int end_row);
+
   // After the dirty blocks have been identified, this routine merges adjacent
   // blocks into a region.
   // The goal is to minimize the region that covers the dirty blocks.
@@ -73,13 +85,16 @@ class Differ {
   // Number of bytes in each row of the image (AKA: stride).
   int bytes_per_row_;
 
+  // Compares full blocks, selected for the CPU at construction.
+  BlockDifferenceFunction block_difference_;
+
   // Diff information for each block in the image.
-  rtc::scoped_ptr<bool[]> diff_info_;
+  DirtyBlockBitmap dirty_blocks_;
 
-  // Dimensions and total size of diff info array.
-  int diff_info_width_;
-  int diff_info_height_;
-  int diff_info_size_;
+  // The rows of blocks from 0 to |first_worker_row_| are compared on the
+  // calling thread, the rest by |workers_|.
+  int first_worker_row_;
+  ScopedVector<Worker> workers_;
 
   DISALLOW_COPY_AND_ASSIGN(Differ);
 };
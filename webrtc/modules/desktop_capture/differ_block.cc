@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include "build/build_config.h"
+#include "webrtc/modules/desktop_capture/differ_block_avx2.h"
 #include "webrtc/modules/desktop_capture/differ_block_sse2.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
@@ -32,28 +33,34 @@ bool BlockDifference_C(const uint8_t* image1,
   return false;
 }
 
+BlockDifferenceFunction GetBlockDifferenceFunction() {
+#if defined(ARCH_CPU_ARM_FAMILY) || defined(ARCH_CPU_MIPS_FAMILY)
+  // For ARM and MIPS processors, always use C version.
+  // TODO(hclam): Implement a NEON version.
+  return &BlockDifference_C;
+#else
+  // AVX2 is only worth it with a full row of a block per 32 byte vector.
+  if (kBlockSize == 32 && WebRtc_GetCPUInfo(kAVX2) != 0)
+    return &BlockDifference_AVX2_W32;
+  bool have_sse2 = WebRtc_GetCPUInfo(kSSE2) != 0;
+  // For x86 processors, check if SSE2 is supported.
+  if (have_sse2 && kBlockSize == 32) {
+    return &BlockDifference_SSE2_W32;
+  } else if (have_sse2 && kBlockSize == 16) {
+    return &BlockDifference_SSE2_W16;
+  } else {
+    return &BlockDifference_C;
+  }
+#endif
+}
+
 bool BlockDifference(const uint8_t* image1,
                      const uint8_t* image2,
                      int stride) {
-  static bool (*diff_proc)(const uint8_t*, const uint8_t*, int) = NULL;
+  static BlockDifferenceFunction diff_proc = NULL;
 
-  if (!diff_proc) {
-#if defined(ARCH_CPU_ARM_FAMILY) || defined(ARCH_CPU_MIPS_FAMILY)
-    // For ARM and MIPS processors, always use C version.
-    // TODO(hclam): Implement a NEON version.
-    diff_proc = &BlockDifference_C;
-#else
-    bool have_sse2 = WebRtc_GetCPUInfo(kSSE2) != 0;
-    // For x86 processors, check if SSE2 is supported.
-    if (have_sse2 && kBlockSize == 32) {
-      diff_proc = &BlockDifference_SSE2_W32;
-    } else if (have_sse2 && kBlockSize == 16) {
-      diff_proc = &BlockDifference_SSE2_W16;
-    } else {
-      diff_proc = &BlockDifference_C;
-    }
-#endif
-  }
+  if (!diff_proc)
+    diff_proc = GetBlockDifferenceFunction();
 
   return diff_proc(image1, image2, stride);
 }
@@ -28,6 +28,16 @@ bool BlockDifference(const uint8_t* image1,
                      const uint8_t* image2,
                      int stride);
 
+typedef bool (*BlockDifferenceFunction)(const uint8_t* image1,
+                                        const uint8_t* image2,
+                                        int stride);
+
+// Returns the fastest implementation of BlockDifference() supported by the
+// CPU. Unlike BlockDifference(), which selects it on first use, this doesn't
+// touch any shared state, so it can be used to set up differs running on
+// several threads.
+BlockDifferenceFunction GetBlockDifferenceFunction();
+
 }  // namespace webrtc
 
 #endif  // WEBRTC_MODULES_DESKTOP_CAPTURE_DIFFER_BLOCK_H_
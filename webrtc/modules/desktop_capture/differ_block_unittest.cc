@@ -8,8 +8,11 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/system_wrappers/interface/ref_count.h"
 
 namespace webrtc {
@@ -84,4 +87,38 @@ TEST(BlockDifferenceTestFirst, BlockDifference) {
   }
 }
 
+static WebRtc_CPUInfo g_get_cpu_info = NULL;
+
+static int GetCPUInfoNoAVX2(CPUFeature feature) {
+  return feature == kAVX2 ? 0 : g_get_cpu_info(feature);
+}
+
+// Verifies that every implementation the CPU supports finds a change in every
+// byte of a block, and ignores the bytes between the rows of blocks.
+TEST(BlockDifferenceTest, AllImplementationsFindEveryChange) {
+  const int kRowSize = kBlockSize * kBytesPerPixel;
+  const int kStride = kRowSize + 40;
+  std::vector<uint8_t> image1(kStride * kBlockSize);
+  GenerateData(&image1[0], static_cast<int>(image1.size()));
+  std::vector<uint8_t> image2 = image1;
+
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  const WebRtc_CPUInfo kCPUInfos[] = {g_get_cpu_info, &GetCPUInfoNoAVX2,
+                                      WebRtc_GetCPUInfoNoASM};
+  for (size_t j = 0; j < sizeof(kCPUInfos) / sizeof(kCPUInfos[0]); ++j) {
+    WebRtc_GetCPUInfo = kCPUInfos[j];
+    BlockDifferenceFunction block_difference = GetBlockDifferenceFunction();
+    WebRtc_GetCPUInfo = g_get_cpu_info;
+
+    EXPECT_FALSE(block_difference(&image1[0], &image2[0], kStride));
+    for (size_t i = 0; i < image2.size(); ++i) {
+      image2[i] ^= 0x10;
+      const bool in_block = static_cast<int>(i % kStride) < kRowSize;
+      ASSERT_EQ(in_block, block_difference(&image1[0], &image2[0], kStride))
+          << "implementation " << j << ", byte " << i;
+      image2[i] = image1[i];
+    }
+  }
+}
+
 }  // namespace webrtc
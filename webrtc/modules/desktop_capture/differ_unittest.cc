@@ -8,10 +8,16 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/desktop_capture/differ.h"
 #include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -108,42 +114,35 @@ class DifferTest : public testing::Test {
   // These are here so that we don't have to make each DifferText_Xxx_Test
   // class a friend class to Differ.
 
-  // Clear out the entire |diff_info_| buffer.
+  // Clear out the entire |dirty_blocks_| bitmap.
   void ClearDiffInfo() {
-    memset(differ_->diff_info_.get(), 0, differ_->diff_info_size_);
+    differ_->dirty_blocks_.Clear();
   }
 
-  // Get the value in the |diff_info_| array at (x,y).
+  // Get the value in the |dirty_blocks_| bitmap at (x,y).
   bool GetDiffInfo(int x, int y) {
-    bool* diff_info = differ_->diff_info_.get();
-    return diff_info[(y * GetDiffInfoWidth()) + x];
+    return differ_->dirty_blocks_.IsSet(x, y);
   }
 
-  // Width of |diff_info_| array.
+  // Width of |dirty_blocks_| bitmap.
   int GetDiffInfoWidth() {
-    return differ_->diff_info_width_;
+    return differ_->dirty_blocks_.width();
   }
 
-  // Height of |diff_info_| array.
+  // Height of |dirty_blocks_| bitmap.
   int GetDiffInfoHeight() {
-    return differ_->diff_info_height_;
-  }
-
-  // Size of |diff_info_| array.
-  int GetDiffInfoSize() {
-    return differ_->diff_info_size_;
+    return differ_->dirty_blocks_.height();
   }
 
-  void SetDiffInfo(int x, int y, bool value) {
-    bool* diff_info = differ_->diff_info_.get();
-    diff_info[(y * GetDiffInfoWidth()) + x] = value;
+  void SetDiffInfo(int x, int y) {
+    differ_->dirty_blocks_.Set(x, y);
   }
 
   // Mark the range of blocks specified.
   void MarkBlocks(int x_origin, int y_origin, int width, int height) {
     for (int y = 0; y < height; y++) {
       for (int x = 0; x < width; x++) {
-        SetDiffInfo(x_origin + x, y_origin + y, true);
+        SetDiffInfo(x_origin + x, y_origin + y);
       }
     }
   }
@@ -209,19 +208,16 @@ class DifferTest : public testing::Test {
 
 TEST_F(DifferTest, Setup) {
   InitDiffer(kScreenWidth, kScreenHeight);
-  // 96x96 pixels results in 3x3 array. Add 1 to each dimension as boundary.
-  // +---+---+---+---+
-  // | o | o | o | _ |
-  // +---+---+---+---+  o = blocks mapped to screen pixels
-  // | o | o | o | _ |
-  // +---+---+---+---+  _ = boundary blocks
-  // | o | o | o | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
-  EXPECT_EQ(4, GetDiffInfoWidth());
-  EXPECT_EQ(4, GetDiffInfoHeight());
-  EXPECT_EQ(16, GetDiffInfoSize());
+  // 96x96 pixels results in 3x3 array.
+  // +---+---+---+
+  // | o | o | o |
+  // +---+---+---+  o = blocks mapped to screen pixels
+  // | o | o | o |
+  // +---+---+---+
+  // | o | o | o |
+  // +---+---+---+
+  EXPECT_EQ(3, GetDiffInfoWidth());
+  EXPECT_EQ(3, GetDiffInfoHeight());
 }
 
 TEST_F(DifferTest, MarkDirtyBlocks_All) {
@@ -229,8 +225,8 @@ TEST_F(DifferTest, MarkDirtyBlocks_All) {
   ClearDiffInfo();
 
   // Update a pixel in each block.
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
+    for (int x = 0; x < GetDiffInfoWidth(); x++) {
       WriteBlockPixel(curr_.get(), x, y, 10, 10, 0xff00ff);
     }
   }
@@ -238,8 +234,8 @@ TEST_F(DifferTest, MarkDirtyBlocks_All) {
   MarkDirtyBlocks(prev_.get(), curr_.get());
 
   // Make sure each block is marked as dirty.
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
+    for (int x = 0; x < GetDiffInfoWidth(); x++) {
       EXPECT_TRUE(GetDiffInfo(x, y))
           << "when x = " << x << ", and y = " << y;
     }
@@ -297,19 +293,16 @@ TEST_F(DifferTest, DiffBlock) {
 TEST_F(DifferTest, Partial_Setup) {
   InitDiffer(kPartialScreenWidth, kPartialScreenHeight);
   // 70x70 pixels results in 3x3 array: 2x2 full blocks + partials around
-  // the edge. One more is added to each dimension as a boundary.
-  // +---+---+---+---+
-  // | o | o | + | _ |
-  // +---+---+---+---+  o = blocks mapped to screen pixels
-  // | o | o | + | _ |
-  // +---+---+---+---+  + = partial blocks (top/left mapped to screen pixels)
-  // | + | + | + | _ |
-  // +---+---+---+---+  _ = boundary blocks
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
-  EXPECT_EQ(4, GetDiffInfoWidth());
-  EXPECT_EQ(4, GetDiffInfoHeight());
-  EXPECT_EQ(16, GetDiffInfoSize());
+  // the edge.
+  // +---+---+---+
+  // | o | o | + |
+  // +---+---+---+  o = blocks mapped to screen pixels
+  // | o | o | + |
+  // +---+---+---+  + = partial blocks (top/left mapped to screen pixels)
+  // | + | + | + |
+  // +---+---+---+
+  EXPECT_EQ(3, GetDiffInfoWidth());
+  EXPECT_EQ(3, GetDiffInfoHeight());
 }
 
 TEST_F(DifferTest, Partial_FirstPixel) {
@@ -317,8 +310,8 @@ TEST_F(DifferTest, Partial_FirstPixel) {
   ClearDiffInfo();
 
   // Update the first pixel in each block.
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
+    for (int x = 0; x < GetDiffInfoWidth(); x++) {
       WriteBlockPixel(curr_.get(), x, y, 0, 0, 0xff00ff);
     }
   }
@@ -326,8 +319,8 @@ TEST_F(DifferTest, Partial_FirstPixel) {
   MarkDirtyBlocks(prev_.get(), curr_.get());
 
   // Make sure each block is marked as dirty.
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
+    for (int x = 0; x < GetDiffInfoWidth(); x++) {
       EXPECT_TRUE(GetDiffInfo(x, y))
           << "when x = " << x << ", and y = " << y;
     }
@@ -349,19 +342,19 @@ TEST_F(DifferTest, Partial_BorderPixel) {
   MarkDirtyBlocks(prev_.get(), curr_.get());
 
   // Make sure last (partial) block in each row/column is marked as dirty.
-  int x_last = GetDiffInfoWidth() - 2;
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
+  int x_last = GetDiffInfoWidth() - 1;
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
     EXPECT_TRUE(GetDiffInfo(x_last, y))
         << "when x = " << x_last << ", and y = " << y;
   }
-  int y_last = GetDiffInfoHeight() - 2;
-  for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  int y_last = GetDiffInfoHeight() - 1;
+  for (int x = 0; x < GetDiffInfoWidth(); x++) {
     EXPECT_TRUE(GetDiffInfo(x, y_last))
         << "when x = " << x << ", and y = " << y_last;
   }
   // All other blocks are clean.
-  for (int y = 0; y < GetDiffInfoHeight() - 2; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 2; x++) {
+  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
+    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
       EXPECT_FALSE(GetDiffInfo(x, y)) << "when x = " << x << ", and y = " << y;
     }
   }
@@ -371,15 +364,13 @@ TEST_F(DifferTest, MergeBlocks_Empty) {
   InitDiffer(kScreenWidth, kScreenHeight);
 
   // No blocks marked:
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
   ClearDiffInfo();
 
   DesktopRegion dirty;
@@ -392,8 +383,8 @@ TEST_F(DifferTest, MergeBlocks_SingleBlock) {
   InitDiffer(kScreenWidth, kScreenHeight);
   // Mark a single block and make sure that there is a single merged
   // rect with the correct bounds.
-  for (int y = 0; y < GetDiffInfoHeight() - 1; y++) {
-    for (int x = 0; x < GetDiffInfoWidth() - 1; x++) {
+  for (int y = 0; y < GetDiffInfoHeight(); y++) {
+    for (int x = 0; x < GetDiffInfoWidth(); x++) {
       ASSERT_TRUE(MarkBlocksAndCheckMerge(x, y, 1, 1)) << "x: " << x
                                                        << "y: " << y;
     }
@@ -403,133 +394,111 @@ TEST_F(DifferTest, MergeBlocks_SingleBlock) {
 TEST_F(DifferTest, MergeBlocks_BlockRow) {
   InitDiffer(kScreenWidth, kScreenHeight);
 
-  // +---+---+---+---+
-  // | X | X |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // | X | X |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 0, 2, 1));
 
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 1, 3, 1));
 
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(1, 2, 2, 1));
 }
 
 TEST_F(DifferTest, MergeBlocks_BlockColumn) {
   InitDiffer(kScreenWidth, kScreenHeight);
 
-  // +---+---+---+---+
-  // | X |   |   | _ |
-  // +---+---+---+---+
-  // | X |   |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // | X |   |   |
+  // +---+---+---+
+  // | X |   |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 0, 1, 2));
 
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   | X |   | _ |
-  // +---+---+---+---+
-  // |   | X |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   | X |   |
+  // +---+---+---+
+  // |   | X |   |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(1, 1, 1, 2));
 
-  // +---+---+---+---+
-  // |   |   | X | _ |
-  // +---+---+---+---+
-  // |   |   | X | _ |
-  // +---+---+---+---+
-  // |   |   | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   | X |
+  // +---+---+---+
+  // |   |   | X |
+  // +---+---+---+
+  // |   |   | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(2, 0, 1, 3));
 }
 
 TEST_F(DifferTest, MergeBlocks_BlockRect) {
   InitDiffer(kScreenWidth, kScreenHeight);
 
-  // +---+---+---+---+
-  // | X | X |   | _ |
-  // +---+---+---+---+
-  // | X | X |   | _ |
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // | X | X |   |
+  // +---+---+---+
+  // | X | X |   |
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 0, 2, 2));
 
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(1, 1, 2, 2));
 
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // |   | X | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
+  // |   | X | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(1, 0, 2, 3));
 
-  // +---+---+---+---+
-  // |   |   |   | _ |
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // |   |   |   |
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 1, 3, 2));
 
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // | X | X | X | _ |
-  // +---+---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
+  // | X | X | X |
+  // +---+---+---+
   ASSERT_TRUE(MarkBlocksAndCheckMerge(0, 0, 3, 3));
 }
 
@@ -540,15 +509,13 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   InitDiffer(kScreenWidth, kScreenHeight);
   DesktopRegion dirty;
 
-  // +---+---+---+---+      +---+---+---+
-  // |   | X |   | _ |      |   | 0 |   |
-  // +---+---+---+---+      +---+---+---+
-  // | X |   |   | _ |      | 1 |   |   |
-  // +---+---+---+---+  =>  +---+---+---+
-  // |   |   | X | _ |      |   |   | 2 |
-  // +---+---+---+---+      +---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+      +---+---+---+
+  // |   | X |   |      |   | 0 |   |
+  // +---+---+---+      +---+---+---+
+  // | X |   |   |      | 1 |   |   |
+  // +---+---+---+  =>  +---+---+---+
+  // |   |   | X |      |   |   | 2 |
+  // +---+---+---+      +---+---+---+
   ClearDiffInfo();
   MarkBlocks(1, 0, 1, 1);
   MarkBlocks(0, 1, 1, 1);
@@ -562,15 +529,13 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 0, 1, 1, 1));
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 2, 2, 1, 1));
 
-  // +---+---+---+---+      +---+---+---+
-  // |   |   | X | _ |      |   |   | 0 |
-  // +---+---+---+---+      +---+---+---+
-  // | X | X | X | _ |      | 1   1   1 |
-  // +---+---+---+---+  =>  +           +
-  // | X | X | X | _ |      | 1   1   1 |
-  // +---+---+---+---+      +---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+      +---+---+---+
+  // |   |   | X |      |   |   | 0 |
+  // +---+---+---+      +---+---+---+
+  // | X | X | X |      | 1   1   1 |
+  // +---+---+---+  =>  +           +
+  // | X | X | X |      | 1   1   1 |
+  // +---+---+---+      +---+---+---+
   ClearDiffInfo();
   MarkBlocks(2, 0, 1, 1);
   MarkBlocks(0, 1, 3, 2);
@@ -582,15 +547,13 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 2, 0, 1, 1));
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 0, 1, 3, 2));
 
-  // +---+---+---+---+      +---+---+---+
-  // |   |   |   | _ |      |   |   |   |
-  // +---+---+---+---+      +---+---+---+
-  // | X |   | X | _ |      | 0 |   | 1 |
-  // +---+---+---+---+  =>  +---+---+---+
-  // | X | X | X | _ |      | 2   2   2 |
-  // +---+---+---+---+      +---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+      +---+---+---+
+  // |   |   |   |      |   |   |   |
+  // +---+---+---+      +---+---+---+
+  // | X |   | X |      | 0 |   | 1 |
+  // +---+---+---+  =>  +---+---+---+
+  // | X | X | X |      | 2   2   2 |
+  // +---+---+---+      +---+---+---+
   ClearDiffInfo();
   MarkBlocks(0, 1, 1, 1);
   MarkBlocks(2, 1, 1, 1);
@@ -604,15 +567,13 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 2, 1, 1, 1));
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 0, 2, 3, 1));
 
-  // +---+---+---+---+      +---+---+---+
-  // | X | X | X | _ |      | 0   0   0 |
-  // +---+---+---+---+      +---+---+---+
-  // | X |   | X | _ |      | 1 |   | 2 |
-  // +---+---+---+---+  =>  +---+---+---+
-  // | X | X | X | _ |      | 3   3   3 |
-  // +---+---+---+---+      +---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+      +---+---+---+
+  // | X | X | X |      | 0   0   0 |
+  // +---+---+---+      +---+---+---+
+  // | X |   | X |      | 1 |   | 2 |
+  // +---+---+---+  =>  +---+---+---+
+  // | X | X | X |      | 3   3   3 |
+  // +---+---+---+      +---+---+---+
   ClearDiffInfo();
   MarkBlocks(0, 0, 3, 1);
   MarkBlocks(0, 1, 1, 1);
@@ -628,15 +589,13 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 2, 1, 1, 1));
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 0, 2, 3, 1));
 
-  // +---+---+---+---+      +---+---+---+
-  // | X | X |   | _ |      | 0   0 |   |
-  // +---+---+---+---+      +       +---+
-  // | X | X |   | _ |      | 0   0 |   |
-  // +---+---+---+---+  =>  +---+---+---+
-  // |   | X |   | _ |      |   | 1 |   |
-  // +---+---+---+---+      +---+---+---+
-  // | _ | _ | _ | _ |
-  // +---+---+---+---+
+  // +---+---+---+      +---+---+---+
+  // | X | X |   |      | 0   0 |   |
+  // +---+---+---+      +       +---+
+  // | X | X |   |      | 0   0 |   |
+  // +---+---+---+  =>  +---+---+---+
+  // |   | X |   |      |   | 1 |   |
+  // +---+---+---+      +---+---+---+
   ClearDiffInfo();
   MarkBlocks(0, 0, 2, 2);
   MarkBlocks(1, 2, 1, 1);
@@ -649,4 +608,152 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 1, 2, 1, 1));
 }
 
+namespace {
+
+// A synthetic desktop frame: a gradient background with windows of solid
+// color and rows of "text".
+void GenerateDesktop(int width, int height, int stride, uint8_t* frame) {
+  for (int y = 0; y < height; ++y) {
+    uint32_t* row = reinterpret_cast<uint32_t*>(frame + y * stride);
+    for (int x = 0; x < width; ++x)
+      row[x] = 0xff000000 | (y * 255 / height) << 8 | (x * 255 / width);
+  }
+  for (int i = 0; i < 8; ++i) {
+    const int left = (i * 7919) % (width / 2);
+    const int top = (i * 104729) % (height / 2);
+    for (int y = top; y < top + height / 3; ++y) {
+      uint32_t* row = reinterpret_cast<uint32_t*>(frame + y * stride);
+      for (int x = left; x < left + width / 3; ++x) {
+        const bool text = (y - top) % 16 < 10 && ((x * 31) ^ (y * 17)) % 7 == 0;
+        row[x] = text ? 0xff000000 : 0xffe0e0e0 + i;
+      }
+    }
+  }
+}
+
+// Changes |num_changes| small areas of |frame|, e.g. a blinking cursor or a
+// ticking clock, and a larger one, e.g. a scrolled window, if |scroll|.
+void ChangeDesktop(int width, int height, int stride, int num_changes,
+                   bool scroll, uint32_t seed, uint8_t* frame) {
+  for (int i = 0; i < num_changes; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    const int left = (seed >> 8) % (width - 8);
+    const int top = (seed >> 16) % (height - 16);
+    for (int y = top; y < top + 16; ++y) {
+      uint32_t* row = reinterpret_cast<uint32_t*>(frame + y * stride);
+      for (int x = left; x < left + 8; ++x)
+        row[x] ^= 0x00ffffff;
+    }
+  }
+  if (scroll) {
+    for (int y = height / 4; y < height * 3 / 4; ++y) {
+      uint32_t* row = reinterpret_cast<uint32_t*>(frame + y * stride);
+      for (int x = width / 4; x < width * 3 / 4; ++x)
+        row[x] += 0x010101;
+    }
+  }
+}
+
+WebRtc_CPUInfo g_get_cpu_info = NULL;
+
+int GetCPUInfoNoAVX2(CPUFeature feature) {
+  return feature == kAVX2 ? 0 : g_get_cpu_info(feature);
+}
+
+}  // namespace
+
+TEST(DifferThreadsTest, ThreadCountDoesNotChangeDirtyRegion) {
+  // Partial blocks on both edges, and padding at the end of the rows.
+  const int kWidth = 1000;
+  const int kHeight = 700;
+  const int kStride = kWidth * kBytesPerPixel + 64;
+  std::vector<uint8_t> prev(kStride * kHeight);
+  std::vector<uint8_t> curr(kStride * kHeight);
+  GenerateDesktop(kWidth, kHeight, kStride, &prev[0]);
+  Differ single(kWidth, kHeight, kBytesPerPixel, kStride);
+  Differ multi(kWidth, kHeight, kBytesPerPixel, kStride, 4);
+  EXPECT_EQ(1, single.num_threads());
+  EXPECT_EQ(4, multi.num_threads());
+
+  for (int i = 0; i < 20; ++i) {
+    SCOPED_TRACE(i);
+    curr = prev;
+    ChangeDesktop(kWidth, kHeight, kStride, i * 3, i % 5 == 4, i, &curr[0]);
+
+    // The blocks with a changed pixel, clipped to the screen.
+    DesktopRegion expected;
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth * kBytesPerPixel; ++x) {
+        if (prev[y * kStride + x] != curr[y * kStride + x]) {
+          const int block_x = x / kBytesPerPixel / kBlockSize * kBlockSize;
+          const int block_y = y / kBlockSize * kBlockSize;
+          DesktopRect block =
+              DesktopRect::MakeXYWH(block_x, block_y, kBlockSize, kBlockSize);
+          block.IntersectWith(DesktopRect::MakeWH(kWidth, kHeight));
+          expected.AddRect(block);
+        }
+      }
+    }
+    EXPECT_EQ(i == 0, expected.is_empty());
+
+    DesktopRegion single_region;
+    DesktopRegion multi_region;
+    single.CalcDirtyRegion(&prev[0], &curr[0], &single_region);
+    multi.CalcDirtyRegion(&prev[0], &curr[0], &multi_region);
+    EXPECT_TRUE(expected.Equals(single_region));
+    EXPECT_TRUE(expected.Equals(multi_region));
+    prev.swap(curr);
+  }
+}
+
+TEST(DifferThreadsTest, MoreThreadsThanRowsOfBlocks) {
+  Differ differ(100, 2 * kBlockSize, kBytesPerPixel, 100 * kBytesPerPixel, 8);
+  EXPECT_EQ(2, differ.num_threads());
+}
+
+// Compares the speed of the block comparisons and the number of threads on
+// frames of a synthetic desktop.
+TEST(DifferThreadsTest, DISABLED_Benchmark) {
+  const struct {
+    int width;
+    int height;
+  } kSizes[] = {{1920, 1080}, {3840, 2160}};
+  const int kNumFrames = 100;
+
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  for (const auto& size : kSizes) {
+    const int stride = size.width * kBytesPerPixel;
+    std::vector<uint8_t> frames[2] = {
+        std::vector<uint8_t>(stride * size.height),
+        std::vector<uint8_t>(stride * size.height)};
+    GenerateDesktop(size.width, size.height, stride, &frames[0][0]);
+
+    for (int avx2 = 0; avx2 < 2; ++avx2) {
+      if (avx2 && g_get_cpu_info(kAVX2) == 0)
+        continue;
+      for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+        WebRtc_GetCPUInfo = avx2 ? g_get_cpu_info : &GetCPUInfoNoAVX2;
+        Differ differ(size.width, size.height, kBytesPerPixel, stride,
+                      num_threads);
+        WebRtc_GetCPUInfo = g_get_cpu_info;
+
+        DesktopRegion region;
+        int64_t total_us = 0;
+        for (int i = 0; i < kNumFrames; ++i) {
+          frames[1] = frames[0];
+          ChangeDesktop(size.width, size.height, stride, 10, i % 10 == 0, i,
+                        &frames[1][0]);
+          const TickTime start = TickTime::Now();
+          differ.CalcDirtyRegion(&frames[0][0], &frames[1][0], &region);
+          total_us += (TickTime::Now() - start).Microseconds();
+          frames[0].swap(frames[1]);
+        }
+        printf("%dx%d %s, %d thread(s): %.3f ms/frame\n", size.width,
+               size.height, avx2 ? "AVX2" : "SSE2", differ.num_threads(),
+               total_us / 1000.0 / kNumFrames);
+      }
+    }
+  }
+}
+
 }  // namespace webrtc
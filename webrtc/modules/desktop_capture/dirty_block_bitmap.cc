@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/desktop_capture/dirty_block_bitmap.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "webrtc/modules/desktop_capture/desktop_region.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kBitsPerWord = 64;
+
+// Returns the index of the lowest set bit of |word|, which must not be zero.
+int CountTrailingZeros(uint64_t word) {
+  assert(word != 0);
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  int count = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+}  // namespace
+
+DirtyBlockBitmap::DirtyBlockBitmap(const DesktopSize& frame_size,
+                                   int block_size)
+    : frame_size_(frame_size),
+      block_size_(block_size),
+      width_((frame_size.width() + block_size - 1) / block_size),
+      height_((frame_size.height() + block_size - 1) / block_size),
+      words_per_row_((width_ + kBitsPerWord - 1) / kBitsPerWord),
+      bits_(words_per_row_ * height_, 0) {
+  assert(block_size > 0);
+}
+
+DirtyBlockBitmap::~DirtyBlockBitmap() {}
+
+void DirtyBlockBitmap::Clear() {
+  std::fill(bits_.begin(), bits_.end(), 0);
+}
+
+void DirtyBlockBitmap::Set(int x, int y) {
+  assert(x >= 0 && x < width_ && y >= 0 && y < height_);
+  bits_[y * words_per_row_ + x / kBitsPerWord] |=
+      static_cast<uint64_t>(1) << (x % kBitsPerWord);
+}
+
+bool DirtyBlockBitmap::IsSet(int x, int y) const {
+  assert(x >= 0 && x < width_ && y >= 0 && y < height_);
+  return ((bits_[y * words_per_row_ + x / kBitsPerWord] >>
+           (x % kBitsPerWord)) & 1) != 0;
+}
+
+void DirtyBlockBitmap::ToRegion(DesktopRegion* region) const {
+  region->Clear();
+  std::vector<DesktopRect> rects;
+  for (int y = 0; y < height_; ++y) {
+    FindRuns(y, &rects);
+    if (!rects.empty())
+      region->AppendRow(&rects[0], static_cast<int>(rects.size()));
+  }
+}
+
+void DirtyBlockBitmap::FindRuns(int y, std::vector<DesktopRect>* rects) const {
+  rects->clear();
+  const int top = y * block_size_;
+  const int bottom = std::min(top + block_size_, frame_size_.height());
+  const uint64_t* row = &bits_[y * words_per_row_];
+
+  // Index of the first block of the current run, or -1 between runs.
+  int run_start = -1;
+  for (int i = 0; i < words_per_row_; ++i) {
+    const uint64_t word = row[i];
+    int bit = 0;
+    while (bit < kBitsPerWord) {
+      if (run_start < 0) {
+        const uint64_t remaining = word >> bit;
+        if (remaining == 0)
+          break;
+        bit += CountTrailingZeros(remaining);
+        run_start = i * kBitsPerWord + bit;
+      } else {
+        const uint64_t remaining = ~word >> bit;
+        if (remaining == 0)
+          break;
+        bit += CountTrailingZeros(remaining);
+        const int run_end = i * kBitsPerWord + bit;
+        rects->push_back(DesktopRect::MakeLTRB(
+            run_start * block_size_, top,
+            std::min(run_end * block_size_, frame_size_.width()), bottom));
+        run_start = -1;
+      }
+    }
+  }
+  if (run_start >= 0) {
+    // The run reaches the end of a row whose width is a multiple of 64 blocks.
+    rects->push_back(DesktopRect::MakeLTRB(run_start * block_size_, top,
+                                           frame_size_.width(), bottom));
+  }
+}
+
+}  // namespace webrtc
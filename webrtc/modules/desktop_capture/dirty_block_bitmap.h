@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_DESKTOP_CAPTURE_DIRTY_BLOCK_BITMAP_H_
+#define WEBRTC_MODULES_DESKTOP_CAPTURE_DIRTY_BLOCK_BITMAP_H_
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/modules/desktop_capture/desktop_geometry.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class DesktopRegion;
+
+// DirtyBlockBitmap marks the changed square blocks of a frame with one bit per
+// block, e.g. 1 KB for a 4K frame with 32x32 blocks. The blocks on the right
+// and bottom edges may be partially outside the frame. Every row of blocks
+// starts on a new word, so different rows can be marked from different
+// threads.
+class DirtyBlockBitmap {
+ public:
+  DirtyBlockBitmap(const DesktopSize& frame_size, int block_size);
+  ~DirtyBlockBitmap();
+
+  // Dimensions in blocks.
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+  void Clear();
+  void Set(int x, int y);
+  bool IsSet(int x, int y) const;
+
+  // Replaces the content of |region| with the union of the marked blocks,
+  // clipped to the frame. Runs of marked blocks are found a word at a time and
+  // the region is built from top to bottom with DesktopRegion::AppendRow(),
+  // so the cost is linear in the number of words and runs, while adding the
+  // blocks with DesktopRegion::AddRect() needs a search per rectangle.
+  void ToRegion(DesktopRegion* region) const;
+
+ private:
+  // Finds the runs of marked blocks of row |y| and stores them in |rects| as
+  // rectangles in frame coordinates.
+  void FindRuns(int y, std::vector<DesktopRect>* rects) const;
+
+  const DesktopSize frame_size_;
+  const int block_size_;
+  const int width_;
+  const int height_;
+  const int words_per_row_;
+  std::vector<uint64_t> bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirtyBlockBitmap);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_DESKTOP_CAPTURE_DIRTY_BLOCK_BITMAP_H_
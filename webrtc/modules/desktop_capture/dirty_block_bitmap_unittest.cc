@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/desktop_capture/dirty_block_bitmap.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/desktop_capture/desktop_region.h"
+
+namespace webrtc {
+
+namespace {
+
+// Builds the region of the set blocks of |bitmap| one block at a time.
+DesktopRegion RegionOfBlocks(const DirtyBlockBitmap& bitmap,
+                             const DesktopSize& frame_size,
+                             int block_size) {
+  DesktopRegion region;
+  for (int y = 0; y < bitmap.height(); ++y) {
+    for (int x = 0; x < bitmap.width(); ++x) {
+      if (bitmap.IsSet(x, y)) {
+        DesktopRect block = DesktopRect::MakeXYWH(
+            x * block_size, y * block_size, block_size, block_size);
+        block.IntersectWith(DesktopRect::MakeSize(frame_size));
+        region.AddRect(block);
+      }
+    }
+  }
+  return region;
+}
+
+}  // namespace
+
+TEST(DirtyBlockBitmapTest, Dimensions) {
+  DirtyBlockBitmap bitmap(DesktopSize(3840, 2150), 32);
+  EXPECT_EQ(120, bitmap.width());
+  EXPECT_EQ(68, bitmap.height());
+
+  DesktopRegion region(DesktopRect::MakeWH(10, 10));
+  bitmap.ToRegion(&region);
+  EXPECT_TRUE(region.is_empty());
+}
+
+// Runs across words, up to the end of rows which fill their words exactly,
+// and blocks partially outside the frame.
+TEST(DirtyBlockBitmapTest, ToRegion) {
+  const int kBlockSize = 16;
+  const DesktopSize kSizes[] = {
+      DesktopSize(64 * kBlockSize, 5 * kBlockSize),
+      DesktopSize(128 * kBlockSize, 3 * kBlockSize),
+      DesktopSize(130 * kBlockSize - 3, 4 * kBlockSize - 7)};
+  for (const DesktopSize& size : kSizes) {
+    SCOPED_TRACE(size.width());
+    DirtyBlockBitmap bitmap(size, kBlockSize);
+    uint32_t seed = 1;
+    for (int i = 0; i < 20; ++i) {
+      bitmap.Clear();
+      for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+          seed = seed * 1664525 + 1013904223;
+          // Mostly long runs, and every block of some rows.
+          if ((seed >> 24) < static_cast<uint32_t>(16 * i) ||
+              (x / 8 + y + i) % 3 == 0) {
+            bitmap.Set(x, y);
+          }
+        }
+      }
+      DesktopRegion region;
+      bitmap.ToRegion(&region);
+      EXPECT_TRUE(region.Equals(RegionOfBlocks(bitmap, size, kBlockSize)));
+    }
+
+    // All blocks.
+    for (int y = 0; y < bitmap.height(); ++y) {
+      for (int x = 0; x < bitmap.width(); ++x)
+        bitmap.Set(x, y);
+    }
+    DesktopRegion region;
+    bitmap.ToRegion(&region);
+    DesktopRegion::Iterator it(region);
+    ASSERT_FALSE(it.IsAtEnd());
+    EXPECT_TRUE(it.rect().equals(DesktopRect::MakeSize(size)));
+    it.Advance();
+    EXPECT_TRUE(it.IsAtEnd());
+  }
+}
+
+}  // namespace webrtc
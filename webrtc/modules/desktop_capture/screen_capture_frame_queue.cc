@@ -20,12 +20,18 @@
 
 namespace webrtc {
 
-ScreenCaptureFrameQueue::ScreenCaptureFrameQueue() : current_(0) {}
+ScreenCaptureFrameQueue::ScreenCaptureFrameQueue()
+    : queue_length_(kDefaultQueueLength), current_(0) {}
+
+ScreenCaptureFrameQueue::ScreenCaptureFrameQueue(int queue_length)
+    : queue_length_(queue_length), current_(0) {
+  assert(queue_length >= 2 && queue_length <= kMaxQueueLength);
+}
 
 ScreenCaptureFrameQueue::~ScreenCaptureFrameQueue() {}
 
 void ScreenCaptureFrameQueue::MoveToNextFrame() {
-  current_ = (current_ + 1) % kQueueLength;
+  current_ = (current_ + 1) % queue_length_;
 
   // Verify that the frame is not shared, i.e. that consumer has released it
   // before attempting to capture again.
@@ -37,7 +43,7 @@ void ScreenCaptureFrameQueue::ReplaceCurrentFrame(DesktopFrame* frame) {
 }
 
 void ScreenCaptureFrameQueue::Reset() {
-  for (int i = 0; i < kQueueLength; ++i)
+  for (int i = 0; i < queue_length_; ++i)
     frames_[i].reset();
 }
 
@@ -31,12 +31,18 @@ namespace webrtc {
 // say, frame dimensions change). The queue records which frames need updating
 // which the caller can query.
 //
-// Frame consumer is expected to never hold more than kQueueLength frames
+// Frame consumer is expected to never hold more than queue_length() frames
 // created by this function and it should release the earliest one before trying
 // to capture a new frame (i.e. before MoveToNextFrame() is called).
 class ScreenCaptureFrameQueue {
  public:
+  static const int kDefaultQueueLength = 2;
+  static const int kMaxQueueLength = 3;
+
   ScreenCaptureFrameQueue();
+  // A longer queue allows to capture a frame while the consumer still works
+  // with the previous two, e.g. when capturing on a separate thread.
+  explicit ScreenCaptureFrameQueue(int queue_length);
   ~ScreenCaptureFrameQueue();
 
   // Moves to the next frame in the queue, moving the 'current' frame to become
@@ -56,15 +62,18 @@ class ScreenCaptureFrameQueue {
   }
 
   SharedDesktopFrame* previous_frame() const {
-    return frames_[(current_ + kQueueLength - 1) % kQueueLength].get();
+    return frames_[(current_ + queue_length_ - 1) % queue_length_].get();
   }
 
+  int queue_length() const { return queue_length_; }
+
  private:
+  const int queue_length_;
+
   // Index of the current frame.
   int current_;
 
-  static const int kQueueLength = 2;
-  rtc::scoped_ptr<SharedDesktopFrame> frames_[kQueueLength];
+  rtc::scoped_ptr<SharedDesktopFrame> frames_[kMaxQueueLength];
 
   DISALLOW_COPY_AND_ASSIGN(ScreenCaptureFrameQueue);
 };
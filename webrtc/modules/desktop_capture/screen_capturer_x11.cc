@@ -11,6 +11,7 @@
 #include "webrtc/modules/desktop_capture/screen_capturer.h"
 
 #include <string.h>
+#include <deque>
 #include <set>
 
 #include <X11/extensions/Xdamage.h>
@@ -18,32 +19,36 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 
+#include "webrtc/base/checks.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/desktop_capture/desktop_capture_options.h"
 #include "webrtc/modules/desktop_capture/desktop_frame.h"
 #include "webrtc/modules/desktop_capture/differ.h"
 #include "webrtc/modules/desktop_capture/screen_capture_frame_queue.h"
 #include "webrtc/modules/desktop_capture/screen_capturer_helper.h"
+#include "webrtc/modules/desktop_capture/shared_desktop_frame.h"
 #include "webrtc/modules/desktop_capture/x11/x_server_pixel_buffer.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 
-// TODO(sergeyu): Move this to a header where it can be shared.
-#if defined(NDEBUG)
-#define DCHECK(condition) (void)(condition)
-#else  // NDEBUG
-#define DCHECK(condition) if (!(condition)) {abort();}
-#endif
-
 namespace webrtc {
 
 namespace {
 
 // A class to perform video frame capturing for Linux.
+//
+// A frame is captured in two steps: GrabFrame() copies the changed pixels from
+// the X server into a frame of |queue_|, and DeliverFrame() finds the changed
+// region, if XDamage doesn't report it, and passes the frame to the callback.
+// With DesktopCaptureOptions::use_capture_thread() the frames are grabbed on
+// a dedicated thread, with its own connection to the X server, one frame ahead
+// of the frame being delivered.
 class ScreenCapturerLinux : public ScreenCapturer,
                             public SharedXDisplay::XEventHandler {
  public:
-  ScreenCapturerLinux();
+  explicit ScreenCapturerLinux(bool use_capture_thread);
   virtual ~ScreenCapturerLinux();
 
   // TODO(ajwong): Do we really want this to be synchronous?
@@ -58,34 +63,52 @@ class ScreenCapturerLinux : public ScreenCapturer,
   bool SelectScreen(ScreenId id) override;
 
  private:
-  Display* display() { return options_.x_display()->display(); }
+  Display* display() { return x_display_->display(); }
 
   // SharedXDisplay::XEventHandler interface.
   bool HandleXEvent(const XEvent& event) override;
 
   void InitXDamage();
 
+  // Moves to the next buffer in the queue, processes the pending XEvents and
+  // captures the screen with CaptureScreen(). Returns NULL if the pixel buffer
+  // couldn't be initialized.
+  SharedDesktopFrame* GrabFrame();
+
   // Capture screen pixels to the current buffer in the queue. In the DAMAGE
   // case, the ScreenCapturerHelper already holds the list of invalid rectangles
-  // from HandleXEvent(). In the non-DAMAGE case, this captures the
-  // whole screen, then calculates some invalid rectangles that include any
-  // differences between this and the previous capture.
-  DesktopFrame* CaptureScreen();
+  // from HandleXEvent(), and they are stored in the updated region of the
+  // frame. In the non-DAMAGE case, this captures the whole screen, leaving the
+  // changed region to DeliverFrame().
+  SharedDesktopFrame* CaptureScreen();
+
+  // In the non-DAMAGE case calculates the invalid rectangles that include any
+  // differences between |frame| and the previously delivered frame. Then
+  // passes |frame| to the callback.
+  void DeliverFrame(SharedDesktopFrame* frame, TickTime capture_start_time);
+
+  // Capture thread.
+  static bool CaptureThreadRun(void* obj);
+  bool CaptureThreadProcess();
+  void StartGrab();
 
   // Called when the screen configuration is changed.
   void ScreenConfigurationChanged();
 
-  // Synchronize the current buffer with |last_buffer_|, by copying pixels from
-  // the area of |last_invalid_rects|.
-  // Note this only works on the assumption that kNumBuffers == 2, as
-  // |last_invalid_rects| holds the differences from the previous buffer and
-  // the one prior to that (which will then be the current buffer).
+  // Synchronize the current buffer with the previous one, by copying pixels
+  // from the area of |last_invalid_regions_|, which holds the differences
+  // between the previous buffer and the ones prior to that, up to the current
+  // buffer.
   void SynchronizeFrame();
 
   void DeinitXlib();
 
   DesktopCaptureOptions options_;
 
+  // The connection used to capture the screen: the one in |options_|, or a
+  // new one used only on |capture_thread_|.
+  rtc::scoped_refptr<SharedXDisplay> x_display_;
+
   Callback* callback_;
 
   // X11 graphics context.
@@ -114,17 +137,31 @@ class ScreenCapturerLinux : public ScreenCapturer,
   // Queue of the frames buffers.
   ScreenCaptureFrameQueue queue_;
 
-  // Invalid region from the previous capture. This is used to synchronize the
-  // current with the last buffer used.
-  DesktopRegion last_invalid_region_;
+  // Invalid regions from the previous captures, the most recent last, one less
+  // than the length of |queue_|. These are used to synchronize the current
+  // with the last buffer used.
+  std::deque<DesktopRegion> last_invalid_regions_;
 
-  // |Differ| for use when polling for changes.
+  // The last frame passed to the callback, and |Differ| for use when polling
+  // for changes.
+  rtc::scoped_ptr<SharedDesktopFrame> last_frame_;
   rtc::scoped_ptr<Differ> differ_;
 
+  // Handshake with |capture_thread_|. |grabbed_frame_| and |grab_start_time_|
+  // are only written by the capture thread, and |stop_| by the thread calling
+  // Capture(), before setting the event the other thread waits on.
+  rtc::scoped_ptr<ThreadWrapper> capture_thread_;
+  rtc::scoped_ptr<EventWrapper> grab_event_;
+  rtc::scoped_ptr<EventWrapper> grab_done_event_;
+  rtc::scoped_ptr<SharedDesktopFrame> grabbed_frame_;
+  TickTime grab_start_time_;
+  bool grab_pending_;
+  bool stop_;
+
   DISALLOW_COPY_AND_ASSIGN(ScreenCapturerLinux);
 };
 
-ScreenCapturerLinux::ScreenCapturerLinux()
+ScreenCapturerLinux::ScreenCapturerLinux(bool use_capture_thread)
     : callback_(NULL),
       gc_(NULL),
       root_window_(BadValue),
@@ -135,15 +172,25 @@ ScreenCapturerLinux::ScreenCapturerLinux()
       damage_handle_(0),
       damage_event_base_(-1),
       damage_error_base_(-1),
-      damage_region_(0) {
+      damage_region_(0),
+      queue_(use_capture_thread ? ScreenCaptureFrameQueue::kMaxQueueLength
+                                : ScreenCaptureFrameQueue::kDefaultQueueLength),
+      grab_pending_(false),
+      stop_(false) {
   helper_.SetLogGridSize(4);
 }
 
 ScreenCapturerLinux::~ScreenCapturerLinux() {
-  options_.x_display()->RemoveEventHandler(ConfigureNotify, this);
+  if (capture_thread_) {
+    stop_ = true;
+    grab_event_->Set();
+    capture_thread_->Stop();
+  }
+  if (!x_display_)
+    return;
+  x_display_->RemoveEventHandler(ConfigureNotify, this);
   if (use_damage_) {
-    options_.x_display()->RemoveEventHandler(
-        damage_event_base_ + XDamageNotify, this);
+    x_display_->RemoveEventHandler(damage_event_base_ + XDamageNotify, this);
   }
   DeinitXlib();
 }
@@ -151,6 +198,20 @@ ScreenCapturerLinux::~ScreenCapturerLinux() {
 bool ScreenCapturerLinux::Init(const DesktopCaptureOptions& options) {
   options_ = options;
 
+  if (queue_.queue_length() > ScreenCaptureFrameQueue::kDefaultQueueLength) {
+    // Xlib connections can't be shared between threads without
+    // XInitThreads(), which would have to be called before any other Xlib
+    // call in the process.
+    x_display_ = SharedXDisplay::Create(
+        DisplayString(options_.x_display()->display()));
+    if (!x_display_) {
+      LOG(LS_ERROR) << "Unable to open a connection for the capture thread";
+      return false;
+    }
+  } else {
+    x_display_ = options_.x_display();
+  }
+
   root_window_ = RootWindow(display(), DefaultScreen(display()));
   if (root_window_ == BadValue) {
     LOG(LS_ERROR) << "Unable to get the root window";
@@ -165,7 +226,7 @@ bool ScreenCapturerLinux::Init(const DesktopCaptureOptions& options) {
     return false;
   }
 
-  options_.x_display()->AddEventHandler(ConfigureNotify, this);
+  x_display_->AddEventHandler(ConfigureNotify, this);
 
   // Check for XFixes extension. This is required for cursor shape
   // notifications, and for our use of XDamage.
@@ -188,6 +249,18 @@ bool ScreenCapturerLinux::Init(const DesktopCaptureOptions& options) {
     InitXDamage();
   }
 
+  if (queue_.queue_length() > ScreenCaptureFrameQueue::kDefaultQueueLength) {
+    grab_event_.reset(EventWrapper::Create());
+    grab_done_event_.reset(EventWrapper::Create());
+    capture_thread_ = ThreadWrapper::CreateThread(
+        &ScreenCapturerLinux::CaptureThreadRun, this, "screen_capture");
+    if (!capture_thread_->Start()) {
+      LOG(LS_ERROR) << "Unable to start the capture thread";
+      capture_thread_.reset();
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -225,8 +298,7 @@ void ScreenCapturerLinux::InitXDamage() {
     return;
   }
 
-  options_.x_display()->AddEventHandler(
-      damage_event_base_ + XDamageNotify, this);
+  x_display_->AddEventHandler(damage_event_base_ + XDamageNotify, this);
 
   use_damage_ = true;
   LOG(LS_INFO) << "Using XDamage extension.";
@@ -240,20 +312,40 @@ void ScreenCapturerLinux::Start(Callback* callback) {
 }
 
 void ScreenCapturerLinux::Capture(const DesktopRegion& region) {
-  TickTime capture_start_time = TickTime::Now();
+  if (!capture_thread_) {
+    TickTime capture_start_time = TickTime::Now();
+    DeliverFrame(GrabFrame(), capture_start_time);
+    return;
+  }
+
+  // The first call grabs a frame, the next ones take the frame grabbed at the
+  // end of the previous call.
+  if (!grab_pending_)
+    StartGrab();
+  grab_done_event_->Wait(WEBRTC_EVENT_INFINITE);
+  grab_pending_ = false;
+  SharedDesktopFrame* frame = grabbed_frame_.release();
+  TickTime capture_start_time = grab_start_time_;
+
+  // The consumer has released the frame before the previous one, so the
+  // capture thread can grab the next frame into it while this frame is diffed
+  // and delivered.
+  StartGrab();
+  DeliverFrame(frame, capture_start_time);
+}
 
+SharedDesktopFrame* ScreenCapturerLinux::GrabFrame() {
   queue_.MoveToNextFrame();
 
   // Process XEvents for XDamage and cursor shape tracking.
-  options_.x_display()->ProcessPendingXEvents();
+  x_display_->ProcessPendingXEvents();
 
   // ProcessPendingXEvents() may call ScreenConfigurationChanged() which
   // reinitializes |x_server_pixel_buffer_|. Check if the pixel buffer is still
   // in a good shape.
   if (!x_server_pixel_buffer_.is_initialized()) {
      // We failed to initialize pixel buffer.
-     callback_->OnCaptureCompleted(NULL);
-     return;
+     return NULL;
   }
 
   // If the current frame is from an older generation then allocate a new one.
@@ -265,23 +357,74 @@ void ScreenCapturerLinux::Capture(const DesktopRegion& region) {
     queue_.ReplaceCurrentFrame(frame.release());
   }
 
-  // Refresh the Differ helper used by CaptureFrame(), if needed.
-  DesktopFrame* frame = queue_.current_frame();
-  if (!use_damage_ && (
-      !differ_.get() ||
-      (differ_->width() != frame->size().width()) ||
-      (differ_->height() != frame->size().height()) ||
-      (differ_->bytes_per_row() != frame->stride()))) {
-    differ_.reset(new Differ(frame->size().width(), frame->size().height(),
-                             DesktopFrame::kBytesPerPixel,
-                             frame->stride()));
+  SharedDesktopFrame* result = CaptureScreen();
+  if (use_damage_) {
+    last_invalid_regions_.push_back(result->updated_region());
+    while (static_cast<int>(last_invalid_regions_.size()) >=
+           queue_.queue_length()) {
+      last_invalid_regions_.pop_front();
+    }
+  }
+  return result;
+}
+
+void ScreenCapturerLinux::DeliverFrame(SharedDesktopFrame* frame,
+                                       TickTime capture_start_time) {
+  if (!frame) {
+    last_frame_.reset();
+    callback_->OnCaptureCompleted(NULL);
+    return;
+  }
+
+  if (!use_damage_) {
+    // Full-screen polling, so calculate the invalid rects here, based on the
+    // changed pixels between the current and the previously delivered frame.
+    if (last_frame_ && last_frame_->size().equals(frame->size()) &&
+        last_frame_->stride() == frame->stride()) {
+      // Refresh the Differ helper, if needed.
+      if (!differ_.get() ||
+          (differ_->width() != frame->size().width()) ||
+          (differ_->height() != frame->size().height()) ||
+          (differ_->bytes_per_row() != frame->stride())) {
+        differ_.reset(new Differ(frame->size().width(), frame->size().height(),
+                                 DesktopFrame::kBytesPerPixel,
+                                 frame->stride()));
+      }
+      differ_->CalcDirtyRegion(last_frame_->data(), frame->data(),
+                               frame->mutable_updated_region());
+    } else {
+      // No previous frame of the same size, so invalidate the whole screen.
+      frame->mutable_updated_region()->SetRect(
+          DesktopRect::MakeSize(frame->size()));
+    }
   }
 
-  DesktopFrame* result = CaptureScreen();
-  last_invalid_region_ = result->updated_region();
-  result->set_capture_time_ms(
+  // Keeps a reference to diff the next frame against. The queue doesn't reuse
+  // the buffer before the next frame has been delivered, which replaces it.
+  last_frame_.reset(frame->Share());
+  frame->set_capture_time_ms(
       (TickTime::Now() - capture_start_time).Milliseconds());
-  callback_->OnCaptureCompleted(result);
+  callback_->OnCaptureCompleted(frame);
+}
+
+// static
+bool ScreenCapturerLinux::CaptureThreadRun(void* obj) {
+  return static_cast<ScreenCapturerLinux*>(obj)->CaptureThreadProcess();
+}
+
+bool ScreenCapturerLinux::CaptureThreadProcess() {
+  grab_event_->Wait(WEBRTC_EVENT_INFINITE);
+  if (stop_)
+    return false;
+  grab_start_time_ = TickTime::Now();
+  grabbed_frame_.reset(GrabFrame());
+  grab_done_event_->Set();
+  return true;
+}
+
+void ScreenCapturerLinux::StartGrab() {
+  grab_pending_ = true;
+  grab_event_->Set();
 }
 
 bool ScreenCapturerLinux::GetScreenList(ScreenList* screens) {
@@ -313,8 +456,8 @@ bool ScreenCapturerLinux::HandleXEvent(const XEvent& event) {
   return false;
 }
 
-DesktopFrame* ScreenCapturerLinux::CaptureScreen() {
-  DesktopFrame* frame = queue_.current_frame()->Share();
+SharedDesktopFrame* ScreenCapturerLinux::CaptureScreen() {
+  SharedDesktopFrame* frame = queue_.current_frame()->Share();
   assert(x_server_pixel_buffer_.window_size().equals(frame->size()));
 
   // Pass the screen size to the helper, so it can clip the invalid region if it
@@ -364,18 +507,11 @@ DesktopFrame* ScreenCapturerLinux::CaptureScreen() {
     DesktopRect screen_rect = DesktopRect::MakeSize(frame->size());
     x_server_pixel_buffer_.CaptureRect(screen_rect, frame);
 
-    if (queue_.previous_frame()) {
-      // Full-screen polling, so calculate the invalid rects here, based on the
-      // changed pixels between current and previous buffers.
-      DCHECK(differ_.get() != NULL);
-      DCHECK(queue_.previous_frame()->data());
-      differ_->CalcDirtyRegion(queue_.previous_frame()->data(),
-                               frame->data(), updated_region);
-    } else {
-      // No previous buffer, so always invalidate the whole screen, whether
-      // or not DAMAGE is being used.  DAMAGE doesn't necessarily send a
-      // full-screen notification after a screen-resolution change, so
-      // this is done here.
+    if (use_damage_) {
+      // No previous buffer, so invalidate the whole screen. DAMAGE doesn't
+      // necessarily send a full-screen notification after a
+      // screen-resolution change, so this is done here. When polling,
+      // DeliverFrame() calculates the invalid rects.
       updated_region->SetRect(screen_rect);
     }
   }
@@ -386,6 +522,7 @@ DesktopFrame* ScreenCapturerLinux::CaptureScreen() {
 void ScreenCapturerLinux::ScreenConfigurationChanged() {
   // Make sure the frame buffers will be reallocated.
   queue_.Reset();
+  last_invalid_regions_.clear();
 
   helper_.ClearInvalidRegion();
   if (!x_server_pixel_buffer_.Init(display(), DefaultRootWindow(display()))) {
@@ -401,14 +538,17 @@ void ScreenCapturerLinux::SynchronizeFrame() {
   // positives.
 
   // TODO(hclam): We can reduce the amount of copying here by subtracting
-  // |capturer_helper_|s region from |last_invalid_region_|.
+  // |capturer_helper_|s region from |last_invalid_regions_|.
   // http://crbug.com/92354
   DCHECK(queue_.previous_frame());
 
   DesktopFrame* current = queue_.current_frame();
   DesktopFrame* last = queue_.previous_frame();
   DCHECK(current != last);
-  for (DesktopRegion::Iterator it(last_invalid_region_);
+  DesktopRegion last_invalid_region;
+  for (size_t i = 0; i < last_invalid_regions_.size(); ++i)
+    last_invalid_region.AddRegion(last_invalid_regions_[i]);
+  for (DesktopRegion::Iterator it(last_invalid_region);
        !it.IsAtEnd(); it.Advance()) {
     current->CopyPixelsFrom(*last, it.rect().top_left(), it.rect());
   }
@@ -442,7 +582,8 @@ ScreenCapturer* ScreenCapturer::Create(const DesktopCaptureOptions& options) {
   if (!options.x_display())
     return NULL;
 
-  rtc::scoped_ptr<ScreenCapturerLinux> capturer(new ScreenCapturerLinux());
+  rtc::scoped_ptr<ScreenCapturerLinux> capturer(
+      new ScreenCapturerLinux(options.use_capture_thread()));
   if (!capturer->Init(options))
     capturer.reset();
   return capturer.release();
@@ -0,0 +1,181 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/desktop_capture/screen_capturer.h"
+
+#include <stdio.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/desktop_capture/desktop_capture_options.h"
+#include "webrtc/modules/desktop_capture/desktop_frame.h"
+#include "webrtc/modules/desktop_capture/desktop_region.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+// Xlib defines macros, e.g. None, which clash with gtest.
+#include <X11/Xlib.h>
+
+// These tests draw on the root window and need a display, so like the other
+// display-dependent capturer tests they are disabled. Run them on a virtual
+// display, e.g. with xvfb-run -s "-screen 0 1920x1080x24" and
+// --gtest_also_run_disabled_tests.
+
+namespace webrtc {
+
+namespace {
+
+// Keeps the last frame and simulates the time a consumer, e.g. an encoder,
+// spends on every frame.
+class FrameConsumer : public ScreenCapturer::Callback {
+ public:
+  FrameConsumer() : processing_time_ms_(0), total_capture_time_ms_(0) {}
+
+  void set_processing_time_ms(int ms) { processing_time_ms_ = ms; }
+  DesktopFrame* frame() { return frame_.get(); }
+  int64_t total_capture_time_ms() const { return total_capture_time_ms_; }
+
+  SharedMemory* CreateSharedMemory(size_t size) override { return NULL; }
+
+  void OnCaptureCompleted(DesktopFrame* frame) override {
+    // Releases the previous frame, as the capturer expects.
+    frame_.reset(frame);
+    if (frame) {
+      total_capture_time_ms_ += frame->capture_time_ms();
+      SleepMs(processing_time_ms_);
+    }
+  }
+
+ private:
+  rtc::scoped_ptr<DesktopFrame> frame_;
+  int processing_time_ms_;
+  int64_t total_capture_time_ms_;
+};
+
+// Draws on the root window through a separate connection.
+class Painter {
+ public:
+  Painter() : display_(XOpenDisplay(NULL)), gc_(NULL) {
+    if (display_)
+      gc_ = XCreateGC(display_, DefaultRootWindow(display_), 0, NULL);
+  }
+  ~Painter() {
+    if (display_) {
+      XFreeGC(display_, gc_);
+      XCloseDisplay(display_);
+    }
+  }
+
+  bool is_valid() const { return display_ != NULL; }
+
+  void FillRect(const DesktopRect& rect, uint32_t rgb) {
+    XSetForeground(display_, gc_, rgb);
+    XFillRectangle(display_, DefaultRootWindow(display_), gc_, rect.left(),
+                   rect.top(), rect.width(), rect.height());
+    XSync(display_, False);
+  }
+
+ private:
+  Display* display_;
+  GC gc_;
+};
+
+uint32_t GetPixel(const DesktopFrame& frame, int x, int y) {
+  return *reinterpret_cast<const uint32_t*>(
+             frame.data() + y * frame.stride() +
+             x * DesktopFrame::kBytesPerPixel) & 0xffffff;
+}
+
+ScreenCapturer* CreateCapturer(bool use_capture_thread, bool use_damage) {
+  DesktopCaptureOptions options(DesktopCaptureOptions::CreateDefault());
+  options.set_use_capture_thread(use_capture_thread);
+  options.set_use_update_notifications(use_damage);
+  return ScreenCapturer::Create(options);
+}
+
+}  // namespace
+
+// Verifies that a change of the screen is delivered by the second Capture()
+// call after it at the latest, in every mode.
+TEST(ScreenCapturerX11Test, DISABLED_DeliversChanges) {
+  Painter painter;
+  ASSERT_TRUE(painter.is_valid());
+  const DesktopRect kRect = DesktopRect::MakeXYWH(40, 30, 50, 20);
+  const uint32_t kColors[] = {0xff8040, 0x20c060};
+
+  for (int mode = 0; mode < 4; ++mode) {
+    SCOPED_TRACE(mode);
+    rtc::scoped_ptr<ScreenCapturer> capturer(
+        CreateCapturer(mode & 1, (mode & 2) != 0));
+    ASSERT_TRUE(capturer.get() != NULL);
+    FrameConsumer consumer;
+    capturer->Start(&consumer);
+
+    painter.FillRect(kRect, kColors[0]);
+    capturer->Capture(DesktopRegion());
+    ASSERT_TRUE(consumer.frame() != NULL);
+    EXPECT_TRUE(consumer.frame()->updated_region().Equals(
+        DesktopRegion(DesktopRect::MakeSize(consumer.frame()->size()))));
+
+    painter.FillRect(kRect, kColors[1]);
+    DesktopRegion updated_region;
+    for (int i = 0; i < 2; ++i) {
+      capturer->Capture(DesktopRegion());
+      ASSERT_TRUE(consumer.frame() != NULL);
+      updated_region.AddRegion(consumer.frame()->updated_region());
+    }
+    EXPECT_EQ(kColors[1], GetPixel(*consumer.frame(), kRect.left(),
+                                   kRect.top()));
+    EXPECT_EQ(kColors[1], GetPixel(*consumer.frame(), kRect.right() - 1,
+                                   kRect.bottom() - 1));
+    DesktopRegion missing(kRect);
+    missing.Subtract(updated_region);
+    EXPECT_TRUE(missing.is_empty());
+  }
+}
+
+// Measures the frame rate and the latency from the start of a capture to the
+// delivery of the frame, with a consumer spending 10 ms on every frame and a
+// part of the screen changing between the frames.
+TEST(ScreenCapturerX11Test, DISABLED_CaptureThreadBenchmark) {
+  const int kNumFrames = 200;
+  const int kProcessingTimeMs = 10;
+  Painter painter;
+  ASSERT_TRUE(painter.is_valid());
+
+  for (int mode = 0; mode < 4; ++mode) {
+    const bool use_capture_thread = (mode & 1) != 0;
+    const bool use_damage = (mode & 2) != 0;
+    rtc::scoped_ptr<ScreenCapturer> capturer(
+        CreateCapturer(use_capture_thread, use_damage));
+    ASSERT_TRUE(capturer.get() != NULL);
+    FrameConsumer consumer;
+    consumer.set_processing_time_ms(kProcessingTimeMs);
+    capturer->Start(&consumer);
+
+    const TickTime start = TickTime::Now();
+    for (int i = 0; i < kNumFrames; ++i) {
+      painter.FillRect(DesktopRect::MakeXYWH((i * 37) % 800, (i * 23) % 600,
+                                             200, 100),
+                       i * 0x010203);
+      capturer->Capture(DesktopRegion());
+    }
+    const int64_t elapsed_ms = (TickTime::Now() - start).Milliseconds();
+    ASSERT_TRUE(consumer.frame() != NULL);
+    printf("%dx%d, %s, %s: %.1f fps, %.2f ms capture latency\n",
+           consumer.frame()->size().width(), consumer.frame()->size().height(),
+           use_damage ? "XDamage" : "polling",
+           use_capture_thread ? "capture thread" : "synchronous",
+           kNumFrames * 1000.0 / elapsed_ms,
+           static_cast<double>(consumer.total_capture_time_ms()) / kNumFrames);
+  }
+}
+
+}  // namespace webrtc
@@ -160,12 +160,15 @@
             'audio_coding/neteq/tools/packet_unittest.cc',
             'audio_conference_mixer/test/audio_conference_mixer_unittest.cc',
             'audio_device/fine_audio_buffer_unittest.cc',
+            'audio_processing/aec/aec_core_unittest.cc',
             'audio_processing/aec/echo_cancellation_unittest.cc',
             'audio_processing/aec/system_delay_unittest.cc',
             # TODO(ajm): Fix to match new interface.
             # 'audio_processing/agc/agc_unittest.cc',
             'audio_processing/agc/histogram_unittest.cc',
             'audio_processing/agc/mock_agc.h',
+            'audio_processing/batch_audio_processing_unittest.cc',
+            'audio_processing/beamformer/beamformer_kernels_unittest.cc',
             'audio_processing/beamformer/complex_matrix_unittest.cc',
             'audio_processing/beamformer/covariance_matrix_generator_unittest.cc',
             'audio_processing/beamformer/matrix_unittest.cc',
@@ -173,6 +176,7 @@
             'audio_processing/echo_cancellation_impl_unittest.cc',
             'audio_processing/intelligibility/intelligibility_enhancer_unittest.cc',
             'audio_processing/intelligibility/intelligibility_utils_unittest.cc',
+            'audio_processing/ns/ns_core_unittest.cc',
             'audio_processing/splitting_filter_unittest.cc',
             'audio_processing/transient/dyadic_decimator_unittest.cc',
             'audio_processing/transient/file_utils.cc',
@@ -181,6 +185,7 @@
             'audio_processing/transient/moving_moments_unittest.cc',
             'audio_processing/transient/transient_detector_unittest.cc',
             'audio_processing/transient/transient_suppressor_unittest.cc',
+            'audio_processing/transient/wpd_filter_unittest.cc',
             'audio_processing/transient/wpd_node_unittest.cc',
             'audio_processing/transient/wpd_tree_unittest.cc',
             'audio_processing/utility/delay_estimator_unittest.cc',
@@ -199,11 +204,13 @@
             'desktop_capture/desktop_region_unittest.cc',
             'desktop_capture/differ_block_unittest.cc',
             'desktop_capture/differ_unittest.cc',
+            'desktop_capture/dirty_block_bitmap_unittest.cc',
             'desktop_capture/mouse_cursor_monitor_unittest.cc',
             'desktop_capture/screen_capturer_helper_unittest.cc',
             'desktop_capture/screen_capturer_mac_unittest.cc',
             'desktop_capture/screen_capturer_mock_objects.h',
             'desktop_capture/screen_capturer_unittest.cc',
+            'desktop_capture/screen_capturer_x11_unittest.cc',
             'desktop_capture/window_capturer_unittest.cc',
             'desktop_capture/win/cursor_unittest.cc',
             'desktop_capture/win/cursor_unittest_resources.h',
@@ -293,6 +300,7 @@
             'video_processing/main/test/unit_test/brightness_detection_test.cc',
             'video_processing/main/test/unit_test/content_metrics_test.cc',
             'video_processing/main/test/unit_test/deflickering_test.cc',
+            'video_processing/main/test/unit_test/denoiser_test.cc',
             'video_processing/main/test/unit_test/video_processing_unittest.cc',
             'video_processing/main/test/unit_test/video_processing_unittest.h',
           ],
@@ -315,6 +323,7 @@
                 'desktop_capture/screen_capturer_mac_unittest.cc',
                 'desktop_capture/screen_capturer_mock_objects.h',
                 'desktop_capture/screen_capturer_unittest.cc',
+                'desktop_capture/screen_capturer_x11_unittest.cc',
                 'desktop_capture/window_capturer_unittest.cc',
               ],
             }],
@@ -433,6 +442,7 @@
             'audio_coding/main/test/target_delay_unittest.cc',
             'audio_coding/main/test/utility.cc',
             'rtp_rtcp/test/testFec/test_fec.cc',
+            'video_coding/codecs/test/videoprocessor_benchmark_unittest.cc',
             'video_coding/codecs/test/videoprocessor_integrationtest.cc',
             'video_coding/codecs/vp8/test/vp8_impl_unittest.cc',
           ],
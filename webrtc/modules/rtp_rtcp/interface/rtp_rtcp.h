@@ -75,6 +75,7 @@ class RtpRtcp : public Module {
     BitrateStatisticsObserver* send_bitrate_observer;
     FrameCountObserver* send_frame_count_observer;
     SendSideDelayObserver* send_side_delay_observer;
+    SendPacketObserver* send_packet_observer;
   };
 
   /*
@@ -107,7 +107,8 @@ RTPSender::RTPSender(int32_t id,
                      TransportFeedbackObserver* transport_feedback_observer,
                      BitrateStatisticsObserver* bitrate_callback,
                      FrameCountObserver* frame_count_observer,
-                     SendSideDelayObserver* send_side_delay_observer)
+                     SendSideDelayObserver* send_side_delay_observer,
+                     SendPacketObserver* send_packet_observer)
     : clock_(clock),
       // TODO(holmer): Remove this conversion when we remove the use of
       // TickTime.
@@ -147,6 +148,7 @@ RTPSender::RTPSender(int32_t id,
       rtp_stats_callback_(NULL),
       frame_count_observer_(frame_count_observer),
       send_side_delay_observer_(send_side_delay_observer),
+      send_packet_observer_(send_packet_observer),
       // RTP variables
       start_timestamp_forced_(false),
       start_timestamp_(0),
@@ -876,6 +878,7 @@ bool RTPSender::TimeToSendPacket(uint16_t sequence_number,
   }
   if (!retransmission && capture_time_ms > 0) {
     UpdateDelayStatistics(capture_time_ms, clock_->TimeInMilliseconds());
+    UpdateOnSendPacket(capture_time_ms);
   }
   int rtx;
   {
@@ -1056,6 +1059,7 @@ int32_t RTPSender::SendToNetwork(
   }
   if (capture_time_ms > 0) {
     UpdateDelayStatistics(capture_time_ms, now_ms);
+    UpdateOnSendPacket(capture_time_ms);
   }
 
   size_t length = payload_length + rtp_header_length;
@@ -1111,6 +1115,18 @@ void RTPSender::UpdateDelayStatistics(int64_t capture_time_ms, int64_t now_ms) {
                                                   ssrc);
 }
 
+void RTPSender::UpdateOnSendPacket(int64_t capture_time_ms) {
+  if (!send_packet_observer_)
+    return;
+
+  uint32_t ssrc;
+  {
+    CriticalSectionScoped lock(send_critsect_.get());
+    ssrc = ssrc_;
+  }
+  send_packet_observer_->OnSendPacket(capture_time_ms, ssrc);
+}
+
 void RTPSender::ProcessBitrate() {
   CriticalSectionScoped cs(send_critsect_.get());
   total_bitrate_sent_.Process();
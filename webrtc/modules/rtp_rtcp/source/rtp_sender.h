@@ -96,7 +96,8 @@ class RTPSender : public RTPSenderInterface {
             TransportFeedbackObserver* transport_feedback_callback,
             BitrateStatisticsObserver* bitrate_callback,
             FrameCountObserver* frame_count_observer,
-            SendSideDelayObserver* send_side_delay_observer);
+            SendSideDelayObserver* send_side_delay_observer,
+            SendPacketObserver* send_packet_observer);
   virtual ~RTPSender();
 
   void ProcessBitrate();
@@ -351,6 +352,7 @@ class RTPSender : public RTPSenderInterface {
   bool SendPacketToNetwork(const uint8_t *packet, size_t size);
 
   void UpdateDelayStatistics(int64_t capture_time_ms, int64_t now_ms);
+  void UpdateOnSendPacket(int64_t capture_time_ms);
 
   // Find the byte position of the RTP extension as indicated by |type| in
   // |rtp_packet|. Return false if such extension doesn't exist.
@@ -432,6 +434,7 @@ class RTPSender : public RTPSenderInterface {
   StreamDataCountersCallback* rtp_stats_callback_ GUARDED_BY(statistics_crit_);
   FrameCountObserver* const frame_count_observer_;
   SendSideDelayObserver* const send_side_delay_observer_;
+  SendPacketObserver* const send_packet_observer_;
 
   // RTP variables
   bool start_timestamp_forced_ GUARDED_BY(send_critsect_);
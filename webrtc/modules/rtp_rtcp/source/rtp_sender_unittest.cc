@@ -116,7 +116,8 @@ class RtpSenderTest : public ::testing::Test {
   void SetUp() override {
     rtp_sender_.reset(new RTPSender(0, false, &fake_clock_, &transport_,
                                     nullptr, &mock_paced_sender_, nullptr,
-                                    nullptr, nullptr, nullptr, nullptr));
+                                    nullptr, nullptr, nullptr, nullptr,
+                                    nullptr));
     rtp_sender_->SetSequenceNumber(kSeqNum);
   }
 
@@ -828,7 +829,7 @@ TEST_F(RtpSenderTest, SendRedundantPayloads) {
   MockTransport transport;
   rtp_sender_.reset(new RTPSender(0, false, &fake_clock_, &transport, nullptr,
                                   &mock_paced_sender_, nullptr, nullptr,
-                                  nullptr, nullptr, nullptr));
+                                  nullptr, nullptr, nullptr, nullptr));
   rtp_sender_->SetSequenceNumber(kSeqNum);
   rtp_sender_->SetRtxPayloadType(kRtxPayload, kPayload);
   // Make all packets go through the pacer.
@@ -962,7 +963,7 @@ TEST_F(RtpSenderTest, FrameCountCallbacks) {
 
   rtp_sender_.reset(new RTPSender(0, false, &fake_clock_, &transport_, nullptr,
                                   &mock_paced_sender_, nullptr, nullptr,
-                                  nullptr, &callback, nullptr));
+                                  nullptr, &callback, nullptr, nullptr));
 
   char payload_name[RTP_PAYLOAD_NAME_SIZE] = "GENERIC";
   const uint8_t payload_type = 127;
@@ -993,6 +994,55 @@ TEST_F(RtpSenderTest, FrameCountCallbacks) {
   rtp_sender_.reset();
 }
 
+TEST_F(RtpSenderTest, SendPacketCallbacks) {
+  class TestCallback : public SendPacketObserver {
+   public:
+    TestCallback() : num_calls_(0), capture_time_ms_(0), ssrc_(0) {}
+
+    void OnSendPacket(int64_t capture_time_ms, uint32_t ssrc) override {
+      ++num_calls_;
+      capture_time_ms_ = capture_time_ms;
+      ssrc_ = ssrc;
+    }
+
+    uint32_t num_calls_;
+    int64_t capture_time_ms_;
+    uint32_t ssrc_;
+  } callback;
+
+  rtp_sender_.reset(new RTPSender(0, false, &fake_clock_, &transport_, nullptr,
+                                  &mock_paced_sender_, nullptr, nullptr,
+                                  nullptr, nullptr, nullptr, &callback));
+  rtp_sender_->SetSequenceNumber(kSeqNum);
+  EXPECT_CALL(mock_paced_sender_,
+              SendPacket(PacedSender::kNormalPriority, _, kSeqNum, _, _, _))
+      .WillOnce(testing::Return(false));
+  rtp_sender_->SetStorePacketsStatus(true, 10);
+  const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  int rtp_length_int = rtp_sender_->BuildRTPheader(
+      packet_, kPayload, kMarkerBit, kTimestamp, capture_time_ms);
+  ASSERT_NE(-1, rtp_length_int);
+  EXPECT_EQ(0, rtp_sender_->SendToNetwork(packet_, 0,
+                                          static_cast<size_t>(rtp_length_int),
+                                          capture_time_ms, kAllowRetransmission,
+                                          PacedSender::kNormalPriority));
+  // Not reported until the pacer sends it.
+  EXPECT_EQ(0u, callback.num_calls_);
+
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  rtp_sender_->TimeToSendPacket(kSeqNum, capture_time_ms, false);
+  EXPECT_EQ(1u, callback.num_calls_);
+  EXPECT_EQ(capture_time_ms, callback.capture_time_ms_);
+  EXPECT_EQ(rtp_sender_->SSRC(), callback.ssrc_);
+
+  // Retransmissions are not reported.
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  rtp_sender_->TimeToSendPacket(kSeqNum, capture_time_ms, true);
+  EXPECT_EQ(1u, callback.num_calls_);
+
+  rtp_sender_.reset();
+}
+
 TEST_F(RtpSenderTest, BitrateCallbacks) {
   class TestCallback : public BitrateStatisticsObserver {
    public:
@@ -1015,7 +1065,7 @@ TEST_F(RtpSenderTest, BitrateCallbacks) {
   } callback;
   rtp_sender_.reset(new RTPSender(0, false, &fake_clock_, &transport_, nullptr,
                                   &mock_paced_sender_, nullptr, nullptr,
-                                  &callback, nullptr, nullptr));
+                                  &callback, nullptr, nullptr, nullptr));
 
   // Simulate kNumPackets sent with kPacketInterval ms intervals.
   const uint32_t kNumPackets = 15;
@@ -1074,7 +1124,7 @@ class RtpSenderAudioTest : public RtpSenderTest {
     payload_ = kAudioPayload;
     rtp_sender_.reset(new RTPSender(0, true, &fake_clock_, &transport_, nullptr,
                                     &mock_paced_sender_, nullptr, nullptr,
-                                    nullptr, nullptr, nullptr));
+                                    nullptr, nullptr, nullptr, nullptr));
     rtp_sender_->SetSequenceNumber(kSeqNum);
   }
 };
@@ -290,6 +290,11 @@ int32_t VideoCaptureImpl::IncomingFrame(
                              "happen due to bad parameters.";
             return -1;
         }
+        if (commonVideoType == kI420) {
+          CountFrameBufferCopy();
+        } else {
+          CountFrameBufferConversion();
+        }
         const int conversionResult = ConvertToI420(
             commonVideoType, videoFrame, 0, 0,  // No cropping
             width, height, videoFrameLength,
@@ -32,6 +32,7 @@ TestConfig::TestConfig()
       exclude_frame_types(kExcludeOnlyFirstKeyFrame),
       frame_length_in_bytes(0),
       use_single_core(false),
+      num_cores(0),
       keyframe_interval(0),
       codec_settings(NULL),
       verbose(true) {}
@@ -104,7 +105,9 @@ bool VideoProcessorImpl::Init() {
   }
   // Init the encoder and decoder
   uint32_t nbr_of_cores = 1;
-  if (!config_.use_single_core) {
+  if (config_.num_cores > 0) {
+    nbr_of_cores = config_.num_cores;
+  } else if (!config_.use_single_core) {
     nbr_of_cores = CpuInfo::DetectNumberOfCores();
   }
   int32_t init_result =
@@ -381,6 +384,10 @@ const char* VideoCodecTypeToStr(webrtc::VideoCodecType e) {
   switch (e) {
     case kVideoCodecVP8:
       return "VP8";
+    case kVideoCodecVP9:
+      return "VP9";
+    case kVideoCodecH264:
+      return "H264";
     case kVideoCodecI420:
       return "I420";
     case kVideoCodecRED:
@@ -87,6 +87,11 @@ struct TestConfig {
   // Default: false.
   bool use_single_core;
 
+  // If set to a value >0 the encoder and decoder are told to use this many
+  // cores, regardless of |use_single_core| and the cores of the machine.
+  // Default: 0.
+  int num_cores;
+
   // If set to a value >0 this setting forces the encoder to create a keyframe
   // every Nth frame. Note that the encoder may create a keyframe in other
   // locations in addition to the interval that is set using this parameter.
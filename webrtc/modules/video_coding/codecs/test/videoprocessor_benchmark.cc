@@ -0,0 +1,440 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_video/libyuv/include/scaler.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/modules/video_coding/codecs/h264/include/h264.h"
+#include "webrtc/modules/video_coding/codecs/test/packet_manipulator.h"
+#include "webrtc/modules/video_coding/codecs/test/stats.h"
+#include "webrtc/modules/video_coding/codecs/test/videoprocessor.h"
+#include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
+#include "webrtc/modules/video_coding/codecs/vp9/include/vp9.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/test/testsupport/fileutils.h"
+#include "webrtc/test/testsupport/frame_reader.h"
+#include "webrtc/test/testsupport/frame_writer.h"
+#include "webrtc/test/testsupport/metrics/video_metrics.h"
+#include "webrtc/test/testsupport/packet_reader.h"
+#include "webrtc/test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+
+// Writes the first |num_frames| frames of |clip|, all if 0, scaled to
+// |width| x |height| to |output_filename|.
+bool ScaleClip(const BenchmarkClip& clip,
+               int width,
+               int height,
+               int num_frames,
+               const std::string& output_filename) {
+  const size_t frame_length = CalcBufferSize(kI420, clip.width, clip.height);
+  const size_t scaled_frame_length = CalcBufferSize(kI420, width, height);
+  FrameReaderImpl frame_reader(clip.filename, frame_length);
+  FrameWriterImpl frame_writer(output_filename, scaled_frame_length);
+  Scaler scaler;
+  if (!frame_reader.Init() || !frame_writer.Init() ||
+      scaler.Set(clip.width, clip.height, width, height, kI420, kI420,
+                 kScaleBilinear) != 0) {
+    return false;
+  }
+  rtc::scoped_ptr<uint8_t[]> buffer(new uint8_t[frame_length]);
+  rtc::scoped_ptr<uint8_t[]> scaled_buffer(new uint8_t[scaled_frame_length]);
+  VideoFrame frame;
+  VideoFrame scaled_frame;
+  for (int i = 0; (num_frames == 0 || i < num_frames) &&
+                  frame_reader.ReadFrame(buffer.get());
+       ++i) {
+    frame.CreateFrame(buffer.get(), clip.width, clip.height, kVideoRotation_0);
+    if (scaler.Scale(frame, &scaled_frame) < 0 ||
+        ExtractBuffer(scaled_frame, scaled_frame_length,
+                      scaled_buffer.get()) < 0 ||
+        !frame_writer.WriteFrame(scaled_buffer.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string FormatDouble(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.2f", value);
+  return buffer;
+}
+
+}  // namespace
+
+BenchmarkConfig::BenchmarkConfig()
+    : frame_rate(30),
+      num_frames(0),
+      num_parallel_runs(1),
+      output_dir(OutputPath()) {}
+
+BenchmarkConfig::~BenchmarkConfig() {}
+
+BenchmarkPoint::BenchmarkPoint()
+    : codec_type(kVideoCodecUnknown),
+      width(0),
+      height(0),
+      bit_rate_kbps(0),
+      num_cores(1),
+      packet_loss_probability(0.0) {}
+
+std::string BenchmarkPoint::Name() const {
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer), "%s_%s_%dx%d_%dkbps_%dcores_%.1fpct_loss",
+           VideoCodecTypeToStr(codec_type), clip.name.c_str(), width, height,
+           bit_rate_kbps, num_cores, packet_loss_probability * 100);
+  return buffer;
+}
+
+BenchmarkResult::BenchmarkResult()
+    : ok(false),
+      num_frames(0),
+      num_dropped_frames(0),
+      num_decoded_frames(0),
+      num_key_frames(0),
+      encode_fps(0.0),
+      decode_fps(0.0),
+      avg_psnr(0.0),
+      min_psnr(0.0),
+      avg_ssim(0.0),
+      min_ssim(0.0),
+      encoding_bit_rate_kbps(0.0),
+      bit_rate_mismatch_percent(0.0) {}
+
+VideoProcessorBenchmark::VideoProcessorBenchmark(const BenchmarkConfig& config)
+    : config_(config),
+      next_point_(0),
+      num_finished_points_(0),
+      failed_(false),
+      done_(false, false) {
+  for (VideoCodecType codec_type : config_.codec_types) {
+    for (const BenchmarkClip& clip : config_.clips) {
+      std::vector<BenchmarkResolution> resolutions = config_.resolutions;
+      if (resolutions.empty())
+        resolutions.push_back(BenchmarkResolution(clip.width, clip.height));
+      for (const BenchmarkResolution& resolution : resolutions) {
+        for (int bit_rate_kbps : config_.bit_rates_kbps) {
+          for (int num_cores : config_.num_cores) {
+            for (double packet_loss : config_.packet_loss_probabilities) {
+              BenchmarkPoint point;
+              point.codec_type = codec_type;
+              point.clip = clip;
+              point.width = resolution.width;
+              point.height = resolution.height;
+              point.bit_rate_kbps = bit_rate_kbps;
+              point.num_cores = num_cores;
+              point.packet_loss_probability = packet_loss;
+              points_.push_back(point);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+VideoProcessorBenchmark::~VideoProcessorBenchmark() {}
+
+bool VideoProcessorBenchmark::Run() {
+  results_.assign(points_.size(), BenchmarkResult());
+  input_filenames_.clear();
+  // Scale the clips up front, so that the runs only measure the codecs.
+  bool ok = true;
+  for (const BenchmarkPoint& point : points_) {
+    std::string input_filename;
+    ok = ok && PrepareInput(point, &input_filename);
+    input_filenames_.push_back(input_filename);
+  }
+
+  if (ok) {
+    {
+      rtc::CritScope cs(&crit_);
+      next_point_ = 0;
+      num_finished_points_ = 0;
+      failed_ = false;
+    }
+    std::vector<ThreadWrapper*> threads;
+    const int num_threads = std::max(1, config_.num_parallel_runs);
+    for (int i = 0; i < num_threads; ++i) {
+      rtc::scoped_ptr<ThreadWrapper> thread = ThreadWrapper::CreateThread(
+          &VideoProcessorBenchmark::RunThread, this, "VideoProcessorBenchmark");
+      thread->Start();
+      threads.push_back(thread.release());
+    }
+    if (!points_.empty())
+      done_.Wait(rtc::Event::kForever);
+    for (ThreadWrapper* thread : threads) {
+      thread->Stop();
+      delete thread;
+    }
+    rtc::CritScope cs(&crit_);
+    ok = !failed_;
+  }
+
+  for (const auto& scaled_clip : scaled_clips_)
+    remove(scaled_clip.second.c_str());
+  scaled_clips_.clear();
+  return ok;
+}
+
+bool VideoProcessorBenchmark::PrepareInput(const BenchmarkPoint& point,
+                                           std::string* input_filename) {
+  if (point.width == point.clip.width && point.height == point.clip.height) {
+    *input_filename = point.clip.filename;
+    return true;
+  }
+  char key[64];
+  snprintf(key, sizeof(key), ":%dx%d", point.width, point.height);
+  std::string& scaled_filename = scaled_clips_[point.clip.filename + key];
+  if (scaled_filename.empty()) {
+    scaled_filename =
+        TempFilename(config_.output_dir, "videoprocessor_benchmark_input");
+    if (!ScaleClip(point.clip, point.width, point.height, config_.num_frames,
+                   scaled_filename)) {
+      fprintf(stderr, "Failed to scale %s to %dx%d.\n",
+              point.clip.filename.c_str(), point.width, point.height);
+      return false;
+    }
+  }
+  *input_filename = scaled_filename;
+  return true;
+}
+
+bool VideoProcessorBenchmark::RunThread(void* obj) {
+  return static_cast<VideoProcessorBenchmark*>(obj)->RunNextPoint();
+}
+
+bool VideoProcessorBenchmark::RunNextPoint() {
+  size_t index;
+  {
+    rtc::CritScope cs(&crit_);
+    if (next_point_ == points_.size())
+      return false;
+    index = next_point_++;
+  }
+  const bool ok =
+      RunPoint(points_[index], input_filenames_[index], &results_[index]);
+  if (!ok) {
+    fprintf(stderr, "Benchmark run %s failed.\n",
+            points_[index].Name().c_str());
+  }
+  rtc::CritScope cs(&crit_);
+  failed_ = failed_ || !ok;
+  if (++num_finished_points_ == points_.size())
+    done_.Set();
+  return true;
+}
+
+bool VideoProcessorBenchmark::RunPoint(const BenchmarkPoint& point,
+                                       const std::string& input_filename,
+                                       BenchmarkResult* result) const {
+  result->point = point;
+  rtc::scoped_ptr<VideoEncoder> encoder;
+  rtc::scoped_ptr<VideoDecoder> decoder;
+  switch (point.codec_type) {
+    case kVideoCodecVP8:
+      encoder.reset(VP8Encoder::Create());
+      decoder.reset(VP8Decoder::Create());
+      break;
+    case kVideoCodecVP9:
+      // Null when built without VP9.
+      encoder.reset(VP9Encoder::Create());
+      decoder.reset(VP9Decoder::Create());
+      break;
+    case kVideoCodecH264:
+      if (H264Encoder::IsSupported() && H264Decoder::IsSupported()) {
+        encoder.reset(H264Encoder::Create());
+        decoder.reset(H264Decoder::Create());
+      }
+      break;
+    default:
+      break;
+  }
+  if (!encoder || !decoder) {
+    // Not supported in this build, which is not a failure.
+    return true;
+  }
+
+  VideoCodec codec_settings;
+  VideoCodingModule::Codec(point.codec_type, &codec_settings);
+  codec_settings.width = point.width;
+  codec_settings.height = point.height;
+  codec_settings.startBitrate = point.bit_rate_kbps;
+  codec_settings.maxFramerate = config_.frame_rate;
+
+  TestConfig config;
+  config.name = point.Name();
+  config.input_filename = input_filename;
+  config.output_filename =
+      TempFilename(config_.output_dir, "videoprocessor_benchmark_output");
+  config.output_dir = config_.output_dir;
+  config.frame_length_in_bytes =
+      CalcBufferSize(kI420, point.width, point.height);
+  config.num_cores = point.num_cores;
+  config.networking_config.packet_loss_probability =
+      point.packet_loss_probability;
+  config.codec_settings = &codec_settings;
+  config.verbose = false;
+
+  FrameReaderImpl frame_reader(config.input_filename,
+                               config.frame_length_in_bytes);
+  FrameWriterImpl frame_writer(config.output_filename,
+                               config.frame_length_in_bytes);
+  if (!frame_reader.Init() || !frame_writer.Init())
+    return false;
+  PacketReader packet_reader;
+  PacketManipulatorImpl packet_manipulator(
+      &packet_reader, config.networking_config, config.verbose);
+  Stats stats;
+  rtc::scoped_ptr<VideoProcessor> processor(new VideoProcessorImpl(
+      encoder.get(), decoder.get(), &frame_reader, &frame_writer,
+      &packet_manipulator, config, &stats));
+  if (!processor->Init())
+    return false;
+  processor->SetRates(point.bit_rate_kbps, config_.frame_rate);
+
+  int num_frames = 0;
+  while ((config_.num_frames == 0 || num_frames < config_.num_frames) &&
+         processor->ProcessFrame(num_frames)) {
+    ++num_frames;
+  }
+  encoder->Release();
+  decoder->Release();
+  processor.reset();
+  frame_reader.Close();
+  frame_writer.Close();
+
+  QualityMetricsResult psnr_result;
+  QualityMetricsResult ssim_result;
+  const int metrics_result = I420MetricsFromFiles(
+      config.input_filename.c_str(), config.output_filename.c_str(),
+      point.width, point.height, &psnr_result, &ssim_result);
+  remove(config.output_filename.c_str());
+  if (metrics_result != 0 || num_frames == 0)
+    return false;
+
+  int64_t encode_time_us = 0;
+  int64_t decode_time_us = 0;
+  size_t encoded_bytes = 0;
+  for (const FrameStatistic& stat : stats.stats_) {
+    if (stat.encoding_successful) {
+      encode_time_us += stat.encode_time_in_us;
+      encoded_bytes += stat.encoded_frame_length_in_bytes;
+      if (stat.frame_type == kKeyFrame)
+        ++result->num_key_frames;
+    } else {
+      ++result->num_dropped_frames;
+    }
+    if (stat.decoding_successful) {
+      decode_time_us += stat.decode_time_in_us;
+      ++result->num_decoded_frames;
+    }
+  }
+  const int num_encoded_frames = num_frames - result->num_dropped_frames;
+  result->num_frames = num_frames;
+  result->encode_fps =
+      encode_time_us > 0 ? num_encoded_frames * 1e6 / encode_time_us : 0.0;
+  result->decode_fps = decode_time_us > 0
+                           ? result->num_decoded_frames * 1e6 / decode_time_us
+                           : 0.0;
+  result->avg_psnr = psnr_result.average;
+  result->min_psnr = psnr_result.min;
+  result->avg_ssim = ssim_result.average;
+  result->min_ssim = ssim_result.min;
+  result->encoding_bit_rate_kbps =
+      encoded_bytes * 8.0 * config_.frame_rate / num_frames / 1000.0;
+  result->bit_rate_mismatch_percent =
+      100.0 * fabs(result->encoding_bit_rate_kbps - point.bit_rate_kbps) /
+      point.bit_rate_kbps;
+  result->ok = true;
+  return true;
+}
+
+void VideoProcessorBenchmark::PrintTable(FILE* file) const {
+  fprintf(file, "%-5s %-24s %-10s %6s %5s %5s %8s %8s %6s %6s %6s %6s %8s "
+          "%6s %5s\n", "codec", "clip", "size", "kbps", "cores", "loss%",
+          "enc_fps", "dec_fps", "psnr", "minpsn", "ssim", "minssi", "act_kbps",
+          "rate%", "drops");
+  for (const BenchmarkResult& result : results_) {
+    const BenchmarkPoint& point = result.point;
+    char size[16];
+    snprintf(size, sizeof(size), "%dx%d", point.width, point.height);
+    fprintf(file, "%-5s %-24s %-10s %6d %5d %5.1f ",
+            VideoCodecTypeToStr(point.codec_type), point.clip.name.c_str(),
+            size, point.bit_rate_kbps, point.num_cores,
+            point.packet_loss_probability * 100);
+    if (!result.ok) {
+      fprintf(file, "not run\n");
+      continue;
+    }
+    fprintf(file, "%8.1f %8.1f %6.2f %6.2f %6.3f %6.3f %8.1f %6.1f %5d\n",
+            result.encode_fps, result.decode_fps, result.avg_psnr,
+            result.min_psnr, result.avg_ssim, result.min_ssim,
+            result.encoding_bit_rate_kbps, result.bit_rate_mismatch_percent,
+            result.num_dropped_frames);
+  }
+}
+
+void VideoProcessorBenchmark::PrintCsv(FILE* file) const {
+  fprintf(file, "codec,clip,width,height,bit_rate_kbps,num_cores,packet_loss,"
+          "frames,dropped_frames,decoded_frames,key_frames,encode_fps,"
+          "decode_fps,avg_psnr,min_psnr,avg_ssim,min_ssim,"
+          "encoding_bit_rate_kbps,bit_rate_mismatch_percent\n");
+  for (const BenchmarkResult& result : results_) {
+    if (!result.ok)
+      continue;
+    const BenchmarkPoint& point = result.point;
+    fprintf(file, "%s,%s,%d,%d,%d,%d,%.3f,%d,%d,%d,%d,%.2f,%.2f,%.3f,%.3f,"
+            "%.4f,%.4f,%.2f,%.2f\n",
+            VideoCodecTypeToStr(point.codec_type), point.clip.name.c_str(),
+            point.width, point.height, point.bit_rate_kbps, point.num_cores,
+            point.packet_loss_probability, result.num_frames,
+            result.num_dropped_frames, result.num_decoded_frames,
+            result.num_key_frames, result.encode_fps, result.decode_fps,
+            result.avg_psnr, result.min_psnr, result.avg_ssim, result.min_ssim,
+            result.encoding_bit_rate_kbps, result.bit_rate_mismatch_percent);
+  }
+}
+
+void VideoProcessorBenchmark::PrintPerfResults() const {
+  for (const BenchmarkResult& result : results_) {
+    if (!result.ok)
+      continue;
+    const std::string trace = result.point.Name();
+    PrintResult("encode_fps", "", trace, FormatDouble(result.encode_fps),
+                "fps", true);
+    PrintResult("decode_fps", "", trace, FormatDouble(result.decode_fps),
+                "fps", true);
+    PrintResult("psnr", "", trace, FormatDouble(result.avg_psnr), "dB", true);
+    PrintResult("ssim", "", trace, FormatDouble(result.avg_ssim), "", true);
+    PrintResult("encoding_bit_rate", "", trace,
+                FormatDouble(result.encoding_bit_rate_kbps), "kbps", false);
+    PrintResult("bit_rate_mismatch", "", trace,
+                FormatDouble(result.bit_rate_mismatch_percent), "%", true);
+    PrintResult("dropped_frames", "", trace,
+                static_cast<size_t>(result.num_dropped_frames), "frames",
+                false);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
+#define WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/event.h"
+#include "webrtc/base/thread_annotations.h"
+#include "webrtc/common_types.h"
+
+namespace webrtc {
+namespace test {
+
+// An I420 clip to benchmark with.
+struct BenchmarkClip {
+  BenchmarkClip() : width(0), height(0) {}
+  BenchmarkClip(const std::string& name,
+                const std::string& filename,
+                int width,
+                int height)
+      : name(name), filename(filename), width(width), height(height) {}
+
+  std::string name;
+  std::string filename;
+  int width;
+  int height;
+};
+
+// A resolution to encode the clips in.
+struct BenchmarkResolution {
+  BenchmarkResolution() : width(0), height(0) {}
+  BenchmarkResolution(int width, int height) : width(width), height(height) {}
+
+  int width;
+  int height;
+};
+
+// The parameters to sweep. Every combination of codec, clip, resolution,
+// bit rate, number of cores and packet loss is run.
+struct BenchmarkConfig {
+  BenchmarkConfig();
+  ~BenchmarkConfig();
+
+  std::vector<VideoCodecType> codec_types;
+  std::vector<BenchmarkClip> clips;
+  // If empty, the clips are encoded in their own resolution. Otherwise they
+  // are scaled to each of these first.
+  std::vector<BenchmarkResolution> resolutions;
+  std::vector<int> bit_rates_kbps;
+  std::vector<int> num_cores;
+  std::vector<double> packet_loss_probabilities;
+
+  int frame_rate;
+  // The number of frames of each clip to process. All frames if 0.
+  int num_frames;
+  // How many combinations are run at the same time. The encode and decode
+  // speeds are only comparable between sweeps where the runs don't compete
+  // for cores, i.e. where |num_parallel_runs| times the largest number of
+  // cores fits the machine.
+  int num_parallel_runs;
+  // Where the decoded clips, and clips scaled to other resolutions, are
+  // written. They are deleted after use.
+  std::string output_dir;
+};
+
+// One combination of the sweep.
+struct BenchmarkPoint {
+  BenchmarkPoint();
+
+  // A name for the combination, usable as a perf dashboard trace.
+  std::string Name() const;
+
+  VideoCodecType codec_type;
+  BenchmarkClip clip;
+  int width;
+  int height;
+  int bit_rate_kbps;
+  int num_cores;
+  double packet_loss_probability;
+};
+
+struct BenchmarkResult {
+  BenchmarkResult();
+
+  BenchmarkPoint point;
+  // False if the codec isn't supported or the run failed. Then none of the
+  // metrics below are set.
+  bool ok;
+
+  int num_frames;
+  int num_dropped_frames;
+  int num_decoded_frames;
+  int num_key_frames;
+  double encode_fps;
+  double decode_fps;
+  double avg_psnr;
+  double min_psnr;
+  double avg_ssim;
+  double min_ssim;
+  // Rate control accuracy: the average encoding bit rate and its deviation
+  // from the target in percent.
+  double encoding_bit_rate_kbps;
+  double bit_rate_mismatch_percent;
+};
+
+// Encodes and decodes clips through VideoProcessorImpl, sweeping over codecs,
+// resolutions, bit rates, numbers of cores and packet loss. Runs several
+// combinations in parallel and collects speed, quality and rate control
+// metrics of each.
+//
+// Example:
+//   BenchmarkConfig config;
+//   config.codec_types.push_back(kVideoCodecVP8);
+//   config.clips.push_back(BenchmarkClip("foreman_cif", filename, 352, 288));
+//   config.bit_rates_kbps.push_back(500);
+//   config.num_cores.push_back(1);
+//   config.packet_loss_probabilities.push_back(0.0);
+//   VideoProcessorBenchmark benchmark(config);
+//   benchmark.Run();
+//   benchmark.PrintTable(stdout);
+class VideoProcessorBenchmark {
+ public:
+  explicit VideoProcessorBenchmark(const BenchmarkConfig& config);
+  ~VideoProcessorBenchmark();
+
+  // Runs all combinations. Returns false if any supported combination failed.
+  bool Run();
+
+  // The results of the last Run(), in sweep order.
+  const std::vector<BenchmarkResult>& results() const { return results_; }
+
+  // Prints the results as a table for reading.
+  void PrintTable(FILE* file) const;
+  // Prints the results as comma separated values, one row per combination.
+  void PrintCsv(FILE* file) const;
+  // Prints the results as perf dashboard results, see perf_test.h.
+  void PrintPerfResults() const;
+
+ private:
+  static bool RunThread(void* obj);
+  // Runs the next combination which hasn't been started, if any. Returns false
+  // when all have been started, and signals |done_| when all have finished.
+  bool RunNextPoint();
+  // Runs one combination, reading |input_filename| which is the clip in the
+  // resolution of the combination.
+  bool RunPoint(const BenchmarkPoint& point,
+                const std::string& input_filename,
+                BenchmarkResult* result) const;
+  // Writes the clip of |point| scaled to its resolution to a file, unless the
+  // resolutions are the same. Returns the name of the file to read.
+  bool PrepareInput(const BenchmarkPoint& point, std::string* input_filename);
+
+  const BenchmarkConfig config_;
+  std::vector<BenchmarkPoint> points_;
+  // The file to read for each combination.
+  std::vector<std::string> input_filenames_;
+  // Scaled clips, by clip file name and resolution.
+  std::map<std::string, std::string> scaled_clips_;
+
+  rtc::CriticalSection crit_;
+  size_t next_point_ GUARDED_BY(crit_);
+  size_t num_finished_points_ GUARDED_BY(crit_);
+  bool failed_ GUARDED_BY(crit_);
+  rtc::Event done_;
+  // Each run writes its own element.
+  std::vector<BenchmarkResult> results_;
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/video_coding/codecs/h264/include/h264.h"
+#include "webrtc/modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+const int kCifWidth = 352;
+const int kCifHeight = 288;
+const int kNumFrames = 10;
+}  // namespace
+
+class VideoProcessorBenchmarkTest : public testing::Test {
+ protected:
+  VideoProcessorBenchmarkTest() {
+    config_.clips.push_back(BenchmarkClip(
+        "foreman_cif", ResourcePath("foreman_cif", "yuv"), kCifWidth,
+        kCifHeight));
+    config_.num_cores.push_back(1);
+    config_.num_frames = kNumFrames;
+    config_.num_parallel_runs = 2;
+  }
+
+  BenchmarkConfig config_;
+};
+
+TEST_F(VideoProcessorBenchmarkTest, RunsAllCombinations) {
+  config_.codec_types.push_back(kVideoCodecVP8);
+  config_.resolutions.push_back(BenchmarkResolution(kCifWidth, kCifHeight));
+  config_.resolutions.push_back(
+      BenchmarkResolution(kCifWidth / 2, kCifHeight / 2));
+  config_.bit_rates_kbps.push_back(300);
+  config_.bit_rates_kbps.push_back(600);
+  config_.packet_loss_probabilities.push_back(0.0);
+
+  VideoProcessorBenchmark benchmark(config_);
+  ASSERT_TRUE(benchmark.Run());
+  const std::vector<BenchmarkResult>& results = benchmark.results();
+  ASSERT_EQ(4u, results.size());
+  for (const BenchmarkResult& result : results) {
+    SCOPED_TRACE(result.point.Name());
+    EXPECT_TRUE(result.ok);
+    EXPECT_EQ(kNumFrames, result.num_frames);
+    EXPECT_EQ(kNumFrames, result.num_decoded_frames);
+    EXPECT_GE(result.num_key_frames, 1);
+    EXPECT_GT(result.encode_fps, 0.0);
+    EXPECT_GT(result.decode_fps, 0.0);
+    EXPECT_GT(result.avg_psnr, 25.0);
+    EXPECT_GT(result.avg_ssim, 0.7);
+    EXPECT_GT(result.encoding_bit_rate_kbps, 0.0);
+  }
+  // Sweep order: resolutions before bit rates.
+  EXPECT_EQ(kCifWidth, results[0].point.width);
+  EXPECT_EQ(300, results[0].point.bit_rate_kbps);
+  EXPECT_EQ(600, results[1].point.bit_rate_kbps);
+  EXPECT_EQ(kCifWidth / 2, results[2].point.width);
+}
+
+TEST_F(VideoProcessorBenchmarkTest, DecodesWithPacketLoss) {
+  config_.codec_types.push_back(kVideoCodecVP8);
+  config_.bit_rates_kbps.push_back(500);
+  config_.packet_loss_probabilities.push_back(0.0);
+  config_.packet_loss_probabilities.push_back(0.2);
+
+  VideoProcessorBenchmark benchmark(config_);
+  ASSERT_TRUE(benchmark.Run());
+  const std::vector<BenchmarkResult>& results = benchmark.results();
+  ASSERT_EQ(2u, results.size());
+  EXPECT_TRUE(results[0].ok);
+  EXPECT_TRUE(results[1].ok);
+  EXPECT_GE(results[0].avg_psnr, results[1].avg_psnr);
+}
+
+TEST_F(VideoProcessorBenchmarkTest, SkipsUnsupportedCodecs) {
+  config_.codec_types.push_back(kVideoCodecH264);
+  config_.bit_rates_kbps.push_back(500);
+  config_.packet_loss_probabilities.push_back(0.0);
+
+  VideoProcessorBenchmark benchmark(config_);
+  EXPECT_TRUE(benchmark.Run());
+  ASSERT_EQ(1u, benchmark.results().size());
+  EXPECT_EQ(H264Encoder::IsSupported(), benchmark.results()[0].ok);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -12,6 +12,7 @@
 
 #include "testing/gtest/include/gtest/gtest.h"
 
+#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
 #include "webrtc/modules/video_coding/codecs/test/packet_manipulator.h"
 #include "webrtc/modules/video_coding/codecs/test/videoprocessor.h"
@@ -729,6 +730,144 @@ TEST_F(VideoProcessorIntegrationTest, ProcessNoLossDenoiserOnVP9) {
 // TODO(marpan): Add temporal layer test for VP9, once changes are in
 // vp9 wrapper for this.
 
+// Reads the frames of a clip scaled to another resolution, for speed tests at
+// resolutions which there are no clips of.
+class ScalingFrameReader : public webrtc::test::FrameReader {
+ public:
+  ScalingFrameReader(const std::string& input_filename,
+                     int width,
+                     int height,
+                     int scaled_width,
+                     int scaled_height)
+      : frame_reader_(input_filename, CalcBufferSize(kI420, width, height)),
+        width_(width),
+        height_(height),
+        scaled_width_(scaled_width),
+        scaled_height_(scaled_height),
+        buffer_(new uint8_t[CalcBufferSize(kI420, width, height)]) {}
+
+  bool Init() override {
+    return frame_reader_.Init() &&
+           scaler_.Set(width_, height_, scaled_width_, scaled_height_, kI420,
+                       kI420, kScaleBilinear) == 0;
+  }
+  bool ReadFrame(uint8_t* source_buffer) override {
+    if (!frame_reader_.ReadFrame(buffer_.get()))
+      return false;
+    frame_.CreateFrame(buffer_.get(), width_, height_, kVideoRotation_0);
+    if (scaler_.Scale(frame_, &scaled_frame_) < 0)
+      return false;
+    return ExtractBuffer(scaled_frame_, FrameLength(), source_buffer) > 0;
+  }
+  void Close() override { frame_reader_.Close(); }
+  size_t FrameLength() override {
+    return CalcBufferSize(kI420, scaled_width_, scaled_height_);
+  }
+  int NumberOfFrames() override { return frame_reader_.NumberOfFrames(); }
+
+ private:
+  webrtc::test::FrameReaderImpl frame_reader_;
+  const int width_;
+  const int height_;
+  const int scaled_width_;
+  const int scaled_height_;
+  rtc::scoped_ptr<uint8_t[]> buffer_;
+  Scaler scaler_;
+  VideoFrame frame_;
+  VideoFrame scaled_frame_;
+};
+
+// VP9: Encoding and decoding speed at 720p versus the number of cores the
+// codecs may use, with the decoder decoding tiles or whole frames in parallel.
+// Foreman is upscaled, there is no HD clip among the resources. The speed is
+// printed; the scaling needs a machine with as many cores.
+TEST(VideoProcessorBenchmark, DISABLED_VP9FpsVersusCores) {
+  const int kWidth = 1280;
+  const int kHeight = 720;
+  const int kBitrateKbps = 1500;
+  const int kFrameRate = 30;
+  const int kNumCores[] = {1, 2, 4, 8};
+  for (int frame_parallel = 0; frame_parallel <= 1; ++frame_parallel) {
+    for (int num_cores : kNumCores) {
+      VideoCodec codec_settings;
+      VideoCodingModule::Codec(kVideoCodecVP9, &codec_settings);
+      codec_settings.width = kWidth;
+      codec_settings.height = kHeight;
+      codec_settings.startBitrate = kBitrateKbps;
+      codec_settings.maxFramerate = kFrameRate;
+      codec_settings.codecSpecific.VP9.frameDroppingOn = false;
+      codec_settings.codecSpecific.VP9.keyFrameInterval = kBaseKeyFrameInterval;
+      codec_settings.codecSpecific.VP9.frameParallelDecoding =
+          frame_parallel != 0;
+
+      webrtc::test::TestConfig config;
+      config.codec_settings = &codec_settings;
+      config.num_cores = num_cores;
+      config.verbose = false;
+      config.frame_length_in_bytes = CalcBufferSize(kI420, kWidth, kHeight);
+      config.output_filename = webrtc::test::TempFilename(
+          webrtc::test::OutputPath(), "videoprocessor_benchmark");
+
+      ScalingFrameReader frame_reader(
+          webrtc::test::ResourcePath("foreman_cif", "yuv"), kCIFWidth,
+          kCIFHeight, kWidth, kHeight);
+      webrtc::test::FrameWriterImpl frame_writer(config.output_filename,
+                                                 config.frame_length_in_bytes);
+      ASSERT_TRUE(frame_reader.Init());
+      ASSERT_TRUE(frame_writer.Init());
+      webrtc::test::PacketReader packet_reader;
+      webrtc::test::PacketManipulatorImpl packet_manipulator(
+          &packet_reader, config.networking_config, config.verbose);
+      rtc::scoped_ptr<VideoEncoder> encoder(VP9Encoder::Create());
+      rtc::scoped_ptr<VideoDecoder> decoder(VP9Decoder::Create());
+      webrtc::test::Stats stats;
+      rtc::scoped_ptr<webrtc::test::VideoProcessor> processor(
+          new webrtc::test::VideoProcessorImpl(
+              encoder.get(), decoder.get(), &frame_reader, &frame_writer,
+              &packet_manipulator, config, &stats));
+      ASSERT_TRUE(processor->Init());
+      processor->SetRates(kBitrateKbps, kFrameRate);
+
+      int frame_number = 0;
+      while (frame_number < kNbrFramesShort &&
+             processor->ProcessFrame(frame_number)) {
+        ++frame_number;
+      }
+      EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder->Release());
+      EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, decoder->Release());
+      frame_reader.Close();
+      frame_writer.Close();
+      remove(config.output_filename.c_str());
+
+      // Frames decoded in parallel are output by a later Decode() call, whose
+      // time is what they are charged. Their decoding overlaps with encoding,
+      // so the decode fps is an upper bound.
+      int64_t encode_time_us = 0;
+      int64_t decode_time_us = 0;
+      int num_encoded_frames = 0;
+      int num_decoded_frames = 0;
+      for (const webrtc::test::FrameStatistic& stat : stats.stats_) {
+        if (stat.encoding_successful) {
+          encode_time_us += stat.encode_time_in_us;
+          ++num_encoded_frames;
+        }
+        if (stat.decoding_successful) {
+          decode_time_us += stat.decode_time_in_us;
+          ++num_decoded_frames;
+        }
+      }
+      EXPECT_EQ(frame_number, num_encoded_frames);
+      ASSERT_GT(num_decoded_frames, 0);
+      printf("VP9 %dx%d, %d cores, %s decoding: encode %.1f fps, "
+             "decode %.1f fps\n",
+             kWidth, kHeight, num_cores,
+             frame_parallel ? "frame parallel" : "tile parallel",
+             num_encoded_frames * 1e6 / encode_time_us,
+             num_decoded_frames * 1e6 / decode_time_us);
+    }
+  }
+}
+
 // VP8: Run with no packet loss and fixed bitrate. Quality should be very high.
 // One key frame (first frame only) in sequence. Setting |key_frame_interval|
 // to -1 below means no periodic key frames in test.
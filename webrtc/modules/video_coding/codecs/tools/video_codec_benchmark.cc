@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "webrtc/base/stringencode.h"
+#include "webrtc/modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+DEFINE_string(codecs, "VP8,VP9,H264", "Comma separated list of codecs to "
+              "benchmark. H264 is skipped where it isn't supported.");
+DEFINE_string(clips, "foreman_cif:352x288", "Comma separated list of I420 "
+              "clips, each as <file>:<width>x<height>. A file without a path "
+              "or extension is looked up in the resources directory.");
+DEFINE_string(resolutions, "", "Comma separated list of resolutions, as "
+              "<width>x<height>, to scale the clips to. If empty, the clips "
+              "are encoded in their own resolution.");
+DEFINE_string(bitrates, "300,500,1000", "Comma separated list of bit rates "
+              "in kilobits/second.");
+DEFINE_string(cores, "1", "Comma separated list of numbers of cores to let "
+              "the codecs use.");
+DEFINE_string(packet_loss, "0", "Comma separated list of packet loss "
+              "probabilities between 0.0 and 1.0.");
+DEFINE_int32(frames, 0, "Number of frames of each clip to process. 0 means "
+             "all frames.");
+DEFINE_int32(framerate, 30, "Frame rate of the clips, in FPS.");
+DEFINE_int32(parallel_runs, 0, "Number of combinations to run at the same "
+             "time. 0 means as many as fit the machine with the largest "
+             "number of cores given.");
+DEFINE_string(output_dir, "", "Directory for temporary files. Defaults to "
+              "the test output directory.");
+DEFINE_bool(csv, false, "Print comma separated values instead of a table.");
+DEFINE_bool(perf, false, "Also print the results in the perf dashboard "
+            "format.");
+
+namespace {
+
+std::vector<std::string> SplitList(const std::string& list) {
+  std::vector<std::string> items;
+  rtc::tokenize(list, ',', &items);
+  return items;
+}
+
+bool ParseResolution(const std::string& str, int* width, int* height) {
+  return sscanf(str.c_str(), "%dx%d", width, height) == 2 && *width > 0 &&
+         *height > 0;
+}
+
+bool ParseCodec(const std::string& str, webrtc::VideoCodecType* codec_type) {
+  if (str == "VP8") {
+    *codec_type = webrtc::kVideoCodecVP8;
+  } else if (str == "VP9") {
+    *codec_type = webrtc::kVideoCodecVP9;
+  } else if (str == "H264") {
+    *codec_type = webrtc::kVideoCodecH264;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseClip(const std::string& str, webrtc::test::BenchmarkClip* clip) {
+  const size_t colon = str.rfind(':');
+  if (colon == std::string::npos ||
+      !ParseResolution(str.substr(colon + 1), &clip->width, &clip->height)) {
+    return false;
+  }
+  const std::string file = str.substr(0, colon);
+  if (file.find('/') == std::string::npos &&
+      file.find('.') == std::string::npos) {
+    clip->name = file;
+    clip->filename = webrtc::test::ResourcePath(file, "yuv");
+  } else {
+    const size_t slash = file.rfind('/');
+    clip->name = slash == std::string::npos ? file : file.substr(slash + 1);
+    clip->filename = file;
+  }
+  return webrtc::test::FileExists(clip->filename);
+}
+
+// Fills |config| from the flags. Returns false and prints the reason if a
+// flag is invalid.
+bool HandleCommandLineFlags(webrtc::test::BenchmarkConfig* config) {
+  for (const std::string& codec : SplitList(FLAGS_codecs)) {
+    webrtc::VideoCodecType codec_type;
+    if (!ParseCodec(codec, &codec_type)) {
+      fprintf(stderr, "Unknown codec: %s\n", codec.c_str());
+      return false;
+    }
+    config->codec_types.push_back(codec_type);
+  }
+  for (const std::string& clip_str : SplitList(FLAGS_clips)) {
+    webrtc::test::BenchmarkClip clip;
+    if (!ParseClip(clip_str, &clip)) {
+      fprintf(stderr, "Invalid or missing clip: %s\n", clip_str.c_str());
+      return false;
+    }
+    config->clips.push_back(clip);
+  }
+  for (const std::string& resolution : SplitList(FLAGS_resolutions)) {
+    int width;
+    int height;
+    if (!ParseResolution(resolution, &width, &height)) {
+      fprintf(stderr, "Invalid resolution: %s\n", resolution.c_str());
+      return false;
+    }
+    config->resolutions.push_back(
+        webrtc::test::BenchmarkResolution(width, height));
+  }
+  for (const std::string& bit_rate : SplitList(FLAGS_bitrates)) {
+    const int bit_rate_kbps = atoi(bit_rate.c_str());
+    if (bit_rate_kbps <= 0) {
+      fprintf(stderr, "Invalid bit rate: %s\n", bit_rate.c_str());
+      return false;
+    }
+    config->bit_rates_kbps.push_back(bit_rate_kbps);
+  }
+  for (const std::string& cores : SplitList(FLAGS_cores)) {
+    const int num_cores = atoi(cores.c_str());
+    if (num_cores <= 0) {
+      fprintf(stderr, "Invalid number of cores: %s\n", cores.c_str());
+      return false;
+    }
+    config->num_cores.push_back(num_cores);
+  }
+  for (const std::string& loss : SplitList(FLAGS_packet_loss)) {
+    const double probability = atof(loss.c_str());
+    if (probability < 0.0 || probability > 1.0) {
+      fprintf(stderr, "Invalid packet loss probability: %s\n", loss.c_str());
+      return false;
+    }
+    config->packet_loss_probabilities.push_back(probability);
+  }
+  if (config->codec_types.empty() || config->clips.empty() ||
+      config->bit_rates_kbps.empty() || config->num_cores.empty() ||
+      config->packet_loss_probabilities.empty()) {
+    fprintf(stderr, "Nothing to run.\n");
+    return false;
+  }
+  if (FLAGS_frames < 0 || FLAGS_framerate <= 0 || FLAGS_parallel_runs < 0) {
+    fprintf(stderr, "Invalid number of frames, frame rate or parallel "
+            "runs.\n");
+    return false;
+  }
+  config->num_frames = FLAGS_frames;
+  config->frame_rate = FLAGS_framerate;
+  if (FLAGS_parallel_runs > 0) {
+    config->num_parallel_runs = FLAGS_parallel_runs;
+  } else {
+    const int max_cores = *std::max_element(config->num_cores.begin(),
+                                            config->num_cores.end());
+    config->num_parallel_runs = std::max(
+        1, static_cast<int>(webrtc::CpuInfo::DetectNumberOfCores()) /
+               max_cores);
+  }
+  if (!FLAGS_output_dir.empty())
+    config->output_dir = FLAGS_output_dir;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage = "Benchmarks video codecs by encoding and decoding clips "
+      "for every combination of codec, resolution, bit rate, number of cores "
+      "and packet loss, and prints the encode and decode speed, PSNR, SSIM "
+      "and rate control accuracy of each.\n"
+      "Example usage:\n" + program_name +
+      " --codecs=VP8,VP9 --clips=foreman_cif:352x288 "
+      "--resolutions=352x288,176x144 --bitrates=200,500 --cores=1,2 "
+      "--packet_loss=0,0.05\n";
+  google::SetUsageMessage(usage);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  webrtc::test::BenchmarkConfig config;
+  if (!HandleCommandLineFlags(&config))
+    return 1;
+
+  webrtc::test::VideoProcessorBenchmark benchmark(config);
+  const bool ok = benchmark.Run();
+  if (FLAGS_csv) {
+    benchmark.PrintCsv(stdout);
+  } else {
+    benchmark.PrintTable(stdout);
+  }
+  if (FLAGS_perf)
+    benchmark.PrintPerfResults();
+  return ok ? 0 : 2;
+}
@@ -17,6 +17,8 @@
 
 #include "webrtc/common.h"
 #include "webrtc/modules/video_coding/codecs/vp8/screenshare_layers.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace {
 
@@ -135,8 +137,148 @@ class AdapterEncodedImageCallback : public webrtc::EncodedImageCallback {
 
 namespace webrtc {
 
+// Encodes the frames of one stream on a thread of its own, and holds the
+// encoded images back until DeliverEncodedImages() passes them on from the
+// thread calling SimulcastEncoderAdapter::Encode().
+class SimulcastEncoderAdapter::EncoderThread {
+ public:
+  EncoderThread(SimulcastEncoderAdapter* adapter, size_t stream_idx)
+      : adapter_(adapter),
+        stream_idx_(stream_idx),
+        input_image_(NULL),
+        codec_specific_info_(NULL),
+        send_key_frame_(false),
+        encoding_(false),
+        num_encoded_images_(0),
+        stop_(false) {}
+
+  ~EncoderThread() {
+    if (thread_) {
+      stop_ = true;
+      start_event_->Set();
+      thread_->Stop();
+    }
+  }
+
+  bool Start() {
+    start_event_.reset(EventWrapper::Create());
+    done_event_.reset(EventWrapper::Create());
+    thread_ = ThreadWrapper::CreateThread(&EncoderThread::Run, this,
+                                          "simulcast_encoder");
+    if (!thread_->Start())
+      return false;
+    thread_->SetPriority(kHighPriority);
+    return true;
+  }
+
+  // Starts encoding |input_image|, which must stay valid until
+  // DeliverEncodedImages() returns.
+  void EncodeAsync(const VideoFrame& input_image,
+                   const CodecSpecificInfo* codec_specific_info,
+                   bool send_key_frame) {
+    input_image_ = &input_image;
+    codec_specific_info_ = codec_specific_info;
+    send_key_frame_ = send_key_frame;
+    start_event_->Set();
+  }
+
+  // Waits for the frame passed to EncodeAsync() to be encoded, and passes the
+  // encoded images to SimulcastEncoderAdapter::Encoded().
+  void DeliverEncodedImages() {
+    done_event_->Wait(WEBRTC_EVENT_INFINITE);
+    for (size_t i = 0; i < num_encoded_images_; ++i) {
+      const EncodedImageCopy& copy = *encoded_images_[i];
+      adapter_->Encoded(stream_idx_, copy.image, &copy.codec_specific_info,
+                        copy.has_fragmentation ? &copy.fragmentation : NULL);
+    }
+    num_encoded_images_ = 0;
+  }
+
+  // Copies an image produced by the encoder of the stream. Returns false if
+  // the encoder isn't encoding on this thread, e.g. if it delivers images
+  // asynchronously, in which case they are passed on directly.
+  bool QueueEncodedImage(const EncodedImage& image,
+                         const CodecSpecificInfo* codec_specific_info,
+                         const RTPFragmentationHeader* fragmentation) {
+    if (!encoding_)
+      return false;
+    if (num_encoded_images_ == encoded_images_.size())
+      encoded_images_.push_back(new EncodedImageCopy());
+    EncodedImageCopy* copy = encoded_images_[num_encoded_images_++];
+    // The buffers are reused from frame to frame.
+    if (copy->buffer_size < image._length) {
+      copy->buffer.reset(new uint8_t[image._length]);
+      copy->buffer_size = image._length;
+    }
+    copy->image = image;
+    copy->image._buffer = copy->buffer.get();
+    copy->image._size = copy->buffer_size;
+    if (image._length > 0)
+      memcpy(copy->buffer.get(), image._buffer, image._length);
+    copy->codec_specific_info = *codec_specific_info;
+    copy->has_fragmentation = fragmentation != NULL;
+    if (fragmentation)
+      copy->fragmentation.CopyFrom(*fragmentation);
+    return true;
+  }
+
+ private:
+  struct EncodedImageCopy {
+    EncodedImageCopy() : buffer_size(0), has_fragmentation(false) {}
+
+    EncodedImage image;
+    rtc::scoped_ptr<uint8_t[]> buffer;
+    size_t buffer_size;
+    CodecSpecificInfo codec_specific_info;
+    bool has_fragmentation;
+    RTPFragmentationHeader fragmentation;
+  };
+
+  static bool Run(void* obj) {
+    return static_cast<EncoderThread*>(obj)->Process();
+  }
+
+  bool Process() {
+    start_event_->Wait(WEBRTC_EVENT_INFINITE);
+    if (stop_)
+      return false;
+    encoding_ = true;
+    adapter_->EncodeStream(stream_idx_, *input_image_, codec_specific_info_,
+                           send_key_frame_);
+    encoding_ = false;
+    done_event_->Set();
+    return true;
+  }
+
+  SimulcastEncoderAdapter* const adapter_;
+  const size_t stream_idx_;
+
+  // Written by the thread calling EncodeAsync() before |start_event_| is set,
+  // read by |thread_|.
+  const VideoFrame* input_image_;
+  const CodecSpecificInfo* codec_specific_info_;
+  bool send_key_frame_;
+  // Only accessed on |thread_| while the encoder runs, and by
+  // DeliverEncodedImages() after |done_event_| is set.
+  bool encoding_;
+  ScopedVector<EncodedImageCopy> encoded_images_;
+  size_t num_encoded_images_;
+
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  rtc::scoped_ptr<EventWrapper> start_event_;
+  rtc::scoped_ptr<EventWrapper> done_event_;
+  bool stop_;
+};
+
 SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory)
-    : factory_(factory), encoded_complete_callback_(NULL) {
+    : SimulcastEncoderAdapter(factory, false) {}
+
+SimulcastEncoderAdapter::SimulcastEncoderAdapter(
+    VideoEncoderFactory* factory,
+    bool encode_streams_in_parallel)
+    : factory_(factory),
+      encode_streams_in_parallel_(encode_streams_in_parallel),
+      encoded_complete_callback_(NULL) {
   memset(&codec_, 0, sizeof(webrtc::VideoCodec));
 }
 
@@ -150,6 +292,7 @@ int SimulcastEncoderAdapter::Release() {
   // resolutions doesn't require reallocation of the first encoder, but only
   // reinitialization, which makes sense. Then Destroy this instance instead in
   // ~SimulcastEncoderAdapter().
+  encoder_threads_.clear();
   while (!streaminfos_.empty()) {
     VideoEncoder* encoder = streaminfos_.back().encoder;
     EncodedImageCallback* callback = streaminfos_.back().callback;
@@ -226,6 +369,16 @@ int SimulcastEncoderAdapter::InitEncode(const VideoCodec* inst,
     streaminfos_.push_back(StreamInfo(encoder, callback, stream_codec.width,
                                       stream_codec.height, send_stream));
   }
+
+  if (encode_streams_in_parallel_) {
+    for (int i = 1; i < number_of_streams; ++i) {
+      encoder_threads_.push_back(new EncoderThread(this, i));
+      if (!encoder_threads_.back()->Start()) {
+        Release();
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+    }
+  }
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
@@ -259,62 +412,98 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
-  int src_width = input_image.width();
-  int src_height = input_image.height();
-  for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
-    std::vector<VideoFrameType> stream_frame_types;
-    if (send_key_frame) {
-      stream_frame_types.push_back(kKeyFrame);
-      streaminfos_[stream_idx].key_frame_request = false;
-    } else {
-      stream_frame_types.push_back(kDeltaFrame);
+  if (encoder_threads_.empty()) {
+    for (size_t stream_idx = 0; stream_idx < streaminfos_.size();
+         ++stream_idx) {
+      EncodeStream(stream_idx, input_image, codec_specific_info,
+                   send_key_frame);
     }
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
 
-    int dst_width = streaminfos_[stream_idx].width;
-    int dst_height = streaminfos_[stream_idx].height;
-    // If scaling isn't required, because the input resolution
-    // matches the destination or the input image is empty (e.g.
-    // a keyframe request for encoders with internal camera
-    // sources), pass the image on directly. Otherwise, we'll
-    // scale it to match what the encoder expects (below).
-    if ((dst_width == src_width && dst_height == src_height) ||
-        input_image.IsZeroSize()) {
-      streaminfos_[stream_idx].encoder->Encode(input_image,
-                                               codec_specific_info,
-                                               &stream_frame_types);
-    } else {
-      VideoFrame dst_frame;
-      // Making sure that destination frame is of sufficient size.
-      // Aligning stride values based on width.
-      dst_frame.CreateEmptyFrame(dst_width, dst_height,
-                                 dst_width, (dst_width + 1) / 2,
-                                 (dst_width + 1) / 2);
-      libyuv::I420Scale(input_image.buffer(kYPlane),
-                        input_image.stride(kYPlane),
-                        input_image.buffer(kUPlane),
-                        input_image.stride(kUPlane),
-                        input_image.buffer(kVPlane),
-                        input_image.stride(kVPlane),
-                        src_width, src_height,
-                        dst_frame.buffer(kYPlane),
-                        dst_frame.stride(kYPlane),
-                        dst_frame.buffer(kUPlane),
-                        dst_frame.stride(kUPlane),
-                        dst_frame.buffer(kVPlane),
-                        dst_frame.stride(kVPlane),
-                        dst_width, dst_height,
-                        libyuv::kFilterBilinear);
-      dst_frame.set_timestamp(input_image.timestamp());
-      dst_frame.set_render_time_ms(input_image.render_time_ms());
-      streaminfos_[stream_idx].encoder->Encode(dst_frame,
-                                               codec_specific_info,
-                                               &stream_frame_types);
-    }
+  for (EncoderThread* encoder_thread : encoder_threads_) {
+    encoder_thread->EncodeAsync(input_image, codec_specific_info,
+                                send_key_frame);
   }
+  // The images of the lowest stream are delivered as they are encoded, those
+  // of the other streams once the lower streams are done.
+  EncodeStream(0, input_image, codec_specific_info, send_key_frame);
+  for (EncoderThread* encoder_thread : encoder_threads_)
+    encoder_thread->DeliverEncodedImages();
 
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+void SimulcastEncoderAdapter::EncodeStream(
+    size_t stream_idx,
+    const VideoFrame& input_image,
+    const CodecSpecificInfo* codec_specific_info,
+    bool send_key_frame) {
+  std::vector<VideoFrameType> stream_frame_types;
+  if (send_key_frame) {
+    stream_frame_types.push_back(kKeyFrame);
+    streaminfos_[stream_idx].key_frame_request = false;
+  } else {
+    stream_frame_types.push_back(kDeltaFrame);
+  }
+
+  int src_width = input_image.width();
+  int src_height = input_image.height();
+  int dst_width = streaminfos_[stream_idx].width;
+  int dst_height = streaminfos_[stream_idx].height;
+  // If scaling isn't required, because the input resolution
+  // matches the destination or the input image is empty (e.g.
+  // a keyframe request for encoders with internal camera
+  // sources), pass the image on directly. Otherwise, we'll
+  // scale it to match what the encoder expects (below).
+  if ((dst_width == src_width && dst_height == src_height) ||
+      input_image.IsZeroSize()) {
+    streaminfos_[stream_idx].encoder->Encode(input_image,
+                                             codec_specific_info,
+                                             &stream_frame_types);
+  } else if (input_image.scaled_frame_pyramid() &&
+             src_width * dst_height == dst_width * src_height) {
+    // Share the scaled frame with the other consumers of the captured frame.
+    // The pyramid crops to preserve the aspect ratio, so it's only used when
+    // the stream has the aspect ratio of the input.
+    ScaledFramePyramid* pyramid = input_image.scaled_frame_pyramid();
+    VideoFrame dst_frame(pyramid->GetScaledBuffer(dst_width, dst_height),
+                         input_image.timestamp(),
+                         input_image.render_time_ms(), kVideoRotation_0);
+    dst_frame.set_scaled_frame_pyramid(pyramid);
+    streaminfos_[stream_idx].encoder->Encode(dst_frame,
+                                             codec_specific_info,
+                                             &stream_frame_types);
+  } else {
+    VideoFrame dst_frame;
+    // Making sure that destination frame is of sufficient size.
+    // Aligning stride values based on width.
+    dst_frame.CreateEmptyFrame(dst_width, dst_height,
+                               dst_width, (dst_width + 1) / 2,
+                               (dst_width + 1) / 2);
+    libyuv::I420Scale(input_image.buffer(kYPlane),
+                      input_image.stride(kYPlane),
+                      input_image.buffer(kUPlane),
+                      input_image.stride(kUPlane),
+                      input_image.buffer(kVPlane),
+                      input_image.stride(kVPlane),
+                      src_width, src_height,
+                      dst_frame.buffer(kYPlane),
+                      dst_frame.stride(kYPlane),
+                      dst_frame.buffer(kUPlane),
+                      dst_frame.stride(kUPlane),
+                      dst_frame.buffer(kVPlane),
+                      dst_frame.stride(kVPlane),
+                      dst_width, dst_height,
+                      libyuv::kFilterBilinear);
+    dst_frame.set_timestamp(input_image.timestamp());
+    dst_frame.set_render_time_ms(input_image.render_time_ms());
+    streaminfos_[stream_idx].encoder->Encode(dst_frame,
+                                             codec_specific_info,
+                                             &stream_frame_types);
+  }
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   encoded_complete_callback_ = callback;
@@ -386,6 +575,12 @@ int32_t SimulcastEncoderAdapter::Encoded(
     const EncodedImage& encodedImage,
     const CodecSpecificInfo* codecSpecificInfo,
     const RTPFragmentationHeader* fragmentation) {
+  if (stream_idx > 0 && !encoder_threads_.empty() &&
+      encoder_threads_[stream_idx - 1]->QueueEncodedImage(
+          encodedImage, codecSpecificInfo, fragmentation)) {
+    return 0;
+  }
+
   CodecSpecificInfo stream_codec_specific = *codecSpecificInfo;
   CodecSpecificInfoVP8* vp8Info = &(stream_codec_specific.codecSpecific.VP8);
   vp8Info->simulcastIdx = stream_idx;
@@ -16,6 +16,7 @@
 
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 namespace webrtc {
 
@@ -30,9 +31,17 @@ class VideoEncoderFactory {
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // All the public interfaces are expected to be called from the same thread,
 // e.g the encoder thread.
+//
+// If |encode_streams_in_parallel| is set, Encode() encodes the lowest stream
+// on the calling thread and every other stream on a thread of its own, so the
+// encode latency is that of the slowest stream instead of the sum over all
+// streams. The encoded images are still delivered from Encode(), in the order
+// of the streams.
 class SimulcastEncoderAdapter : public VP8Encoder {
  public:
   explicit SimulcastEncoderAdapter(VideoEncoderFactory* factory);
+  SimulcastEncoderAdapter(VideoEncoderFactory* factory,
+                          bool encode_streams_in_parallel);
   virtual ~SimulcastEncoderAdapter();
 
   // Implements VideoEncoder
@@ -60,6 +69,8 @@ class SimulcastEncoderAdapter : public VP8Encoder {
   int GetTargetFramerate() override;
 
  private:
+  class EncoderThread;
+
   struct StreamInfo {
     StreamInfo()
         : encoder(NULL),
@@ -107,10 +118,21 @@ class SimulcastEncoderAdapter : public VP8Encoder {
 
   bool Initialized() const;
 
+  // Scales |input_image| to the resolution of the stream |stream_idx|, if
+  // needed, and encodes it.
+  void EncodeStream(size_t stream_idx,
+                    const VideoFrame& input_image,
+                    const CodecSpecificInfo* codec_specific_info,
+                    bool send_key_frame);
+
   rtc::scoped_ptr<VideoEncoderFactory> factory_;
+  const bool encode_streams_in_parallel_;
   rtc::scoped_ptr<Config> screensharing_extra_options_;
   VideoCodec codec_;
   std::vector<StreamInfo> streaminfos_;
+  // With |encode_streams_in_parallel_|, the threads encoding the streams
+  // 1 to N - 1.
+  ScopedVector<EncoderThread> encoder_threads_;
   EncodedImageCallback* encoded_complete_callback_;
 };
 
@@ -8,13 +8,23 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "testing/gmock/include/gmock/gmock.h"
+#include "webrtc/common_video/libyuv/include/scaler.h"
 #include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
 #include "webrtc/modules/video_coding/codecs/vp8/simulcast_encoder_adapter.h"
 #include "webrtc/modules/video_coding/codecs/vp8/simulcast_unittest.h"
 #include "webrtc/modules/video_coding/codecs/vp8/vp8_factory.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_impl.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/frame_generator.h"
+#include "webrtc/test/testsupport/fileutils.h"
 
 namespace webrtc {
 namespace testing {
@@ -24,6 +34,12 @@ static VP8Encoder* CreateTestEncoderAdapter() {
   return VP8Encoder::Create();
 }
 
+static VP8Encoder* CreateParallelTestEncoderAdapter() {
+  VP8EncoderFactoryConfig::set_use_simulcast_adapter(true);
+  VP8EncoderFactoryConfig::set_encode_streams_in_parallel(true);
+  return VP8Encoder::Create();
+}
+
 class TestSimulcastEncoderAdapter : public TestVp8Simulcast {
  public:
   TestSimulcastEncoderAdapter()
@@ -106,6 +122,48 @@ TEST_F(TestSimulcastEncoderAdapter, DISABLED_TestRPSIEncoder) {
   TestVp8Simulcast::TestRPSIEncoder();
 }
 
+class TestParallelSimulcastEncoderAdapter : public TestVp8Simulcast {
+ public:
+  TestParallelSimulcastEncoderAdapter()
+     : TestVp8Simulcast(CreateParallelTestEncoderAdapter(),
+                        VP8Decoder::Create()) {}
+ protected:
+  virtual void TearDown() {
+    TestVp8Simulcast::TearDown();
+    VP8EncoderFactoryConfig::set_use_simulcast_adapter(false);
+    VP8EncoderFactoryConfig::set_encode_streams_in_parallel(false);
+  }
+};
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestKeyFrameRequestsOnAllStreams) {
+  TestVp8Simulcast::TestKeyFrameRequestsOnAllStreams();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestPaddingOneStream) {
+  TestVp8Simulcast::TestPaddingOneStream();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestSendAllStreams) {
+  TestVp8Simulcast::TestSendAllStreams();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestDisablingStreams) {
+  TestVp8Simulcast::TestDisablingStreams();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestSwitchingToOneStream) {
+  TestVp8Simulcast::TestSwitchingToOneStream();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter, TestStrideEncodeDecode) {
+  TestVp8Simulcast::TestStrideEncodeDecode();
+}
+
+TEST_F(TestParallelSimulcastEncoderAdapter,
+       TestSpatioTemporalLayers321PatternEncoder) {
+  TestVp8Simulcast::TestSpatioTemporalLayers321PatternEncoder();
+}
+
 class MockVideoEncoder : public VideoEncoder {
  public:
   int32_t InitEncode(const VideoCodec* codecSettings,
@@ -379,5 +437,191 @@ TEST_F(TestSimulcastEncoderAdapterFake, EncodedCallbackForDifferentEncoders) {
   EXPECT_EQ(2, simulcast_index);
 }
 
+// Delivers an image filled with |content| from Encode(), after |delay_ms|.
+class DelayedVideoEncoder : public VideoEncoder {
+ public:
+  DelayedVideoEncoder(int delay_ms, uint8_t content)
+      : delay_ms_(delay_ms), content_(content), callback_(NULL) {}
+
+  int32_t InitEncode(const VideoCodec* codec_settings,
+                     int32_t number_of_cores,
+                     size_t max_payload_size) override {
+    codec_ = *codec_settings;
+    return 0;
+  }
+
+  int32_t Encode(const VideoFrame& input_image,
+                 const CodecSpecificInfo* codec_specific_info,
+                 const std::vector<VideoFrameType>* frame_types) override {
+    SleepMs(delay_ms_);
+    uint8_t buffer[100];
+    memset(buffer, content_, sizeof(buffer));
+    EncodedImage image(buffer, sizeof(buffer), sizeof(buffer));
+    image._encodedWidth = codec_.width;
+    image._encodedHeight = codec_.height;
+    image._timeStamp = input_image.timestamp();
+    image._frameType = (*frame_types)[0];
+    CodecSpecificInfo info;
+    memset(&info, 0, sizeof(info));
+    callback_->Encoded(image, &info, NULL);
+    // The adapter must have copied the image.
+    memset(buffer, 0, sizeof(buffer));
+    return 0;
+  }
+
+  int32_t RegisterEncodeCompleteCallback(
+      EncodedImageCallback* callback) override {
+    callback_ = callback;
+    return 0;
+  }
+  int32_t Release() override { return 0; }
+  int32_t SetChannelParameters(uint32_t packet_loss, int64_t rtt) override {
+    return 0;
+  }
+  int32_t SetRates(uint32_t new_bitrate, uint32_t frame_rate) override {
+    return 0;
+  }
+
+ private:
+  const int delay_ms_;
+  const uint8_t content_;
+  VideoCodec codec_;
+  EncodedImageCallback* callback_;
+};
+
+// The encoders of the higher streams are faster, so they finish first.
+class DelayedVideoEncoderFactory : public VideoEncoderFactory {
+ public:
+  DelayedVideoEncoderFactory() : num_encoders_(0) {}
+
+  VideoEncoder* Create() override {
+    const int stream = num_encoders_++;
+    return new DelayedVideoEncoder(10 * (kNumberOfSimulcastStreams - stream),
+                                   static_cast<uint8_t>(stream + 1));
+  }
+  void Destroy(VideoEncoder* encoder) override { delete encoder; }
+
+ private:
+  int num_encoders_;
+};
+
+class EncodedImageRecorder : public EncodedImageCallback {
+ public:
+  int32_t Encoded(const EncodedImage& encoded_image,
+                  const CodecSpecificInfo* codec_specific_info,
+                  const RTPFragmentationHeader* fragmentation) override {
+    const int stream = codec_specific_info->codecSpecific.VP8.simulcastIdx;
+    streams.push_back(stream);
+    for (size_t i = 0; i < encoded_image._length; ++i)
+      EXPECT_EQ(stream + 1, encoded_image._buffer[i]);
+    EXPECT_EQ(kDefaultWidth >> (kNumberOfSimulcastStreams - 1 - stream),
+              static_cast<int>(encoded_image._encodedWidth));
+    return 0;
+  }
+
+  std::vector<int> streams;
+};
+
+TEST(ParallelSimulcastEncoderAdapterTest, DeliversStreamsInOrder) {
+  SimulcastEncoderAdapter adapter(new DelayedVideoEncoderFactory(), true);
+  VideoCodec codec;
+  TestVp8Simulcast::DefaultSettings(
+      &codec, static_cast<const int*>(kDefaultTemporalLayerProfile));
+  ASSERT_EQ(0, adapter.InitEncode(&codec, 1, 1200));
+  EncodedImageRecorder recorder;
+  adapter.RegisterEncodeCompleteCallback(&recorder);
+  // Enough bitrate for all streams.
+  adapter.SetRates(kMaxBitrates[2], 30);
+
+  VideoFrame frame;
+  frame.CreateEmptyFrame(kDefaultWidth, kDefaultHeight, kDefaultWidth,
+                         kDefaultWidth / 2, kDefaultWidth / 2);
+  std::vector<VideoFrameType> frame_types(kNumberOfSimulcastStreams,
+                                          kDeltaFrame);
+  const int kNumFrames = 3;
+  std::vector<int> expected_streams;
+  for (int i = 0; i < kNumFrames; ++i) {
+    frame.set_timestamp(3000 * i);
+    EXPECT_EQ(0, adapter.Encode(frame, NULL, &frame_types));
+    for (int stream = 0; stream < kNumberOfSimulcastStreams; ++stream)
+      expected_streams.push_back(stream);
+  }
+  EXPECT_EQ(expected_streams, recorder.streams);
+}
+
+class VP8EncoderImplFactory : public VideoEncoderFactory {
+ public:
+  VideoEncoder* Create() override { return new VP8EncoderImpl(); }
+  void Destroy(VideoEncoder* encoder) override { delete encoder; }
+};
+
+// Measures the time Encode() takes per frame, with the streams encoded one
+// after the other and in parallel, on foreman_cif and on foreman_cif scaled
+// to 720p.
+class SimulcastEncodeLatencyBenchmark : public EncodedImageCallback {
+ public:
+  int32_t Encoded(const EncodedImage& encoded_image,
+                  const CodecSpecificInfo* codec_specific_info,
+                  const RTPFragmentationHeader* fragmentation) override {
+    return 0;
+  }
+
+  void Run(int width, int height, bool encode_streams_in_parallel) {
+    const int kNumFrames = 300;
+    const int kNumberOfCores = 4;
+    VideoCodec codec;
+    TestVp8Simulcast::DefaultSettings(
+        &codec, static_cast<const int*>(kDefaultTemporalLayerProfile));
+    codec.width = width;
+    codec.height = height;
+    for (int i = 0; i < kNumberOfSimulcastStreams; ++i) {
+      codec.simulcastStream[i].width =
+          width >> (kNumberOfSimulcastStreams - 1 - i);
+      codec.simulcastStream[i].height =
+          height >> (kNumberOfSimulcastStreams - 1 - i);
+    }
+    SimulcastEncoderAdapter adapter(new VP8EncoderImplFactory(),
+                                    encode_streams_in_parallel);
+    ASSERT_EQ(0, adapter.InitEncode(&codec, kNumberOfCores, 1200));
+    adapter.RegisterEncodeCompleteCallback(this);
+    adapter.SetRates(kMaxBitrates[2], 30);
+
+    rtc::scoped_ptr<test::FrameGenerator> generator(
+        test::FrameGenerator::CreateFromYuvFile(
+            std::vector<std::string>(
+                1, test::ResourcePath("foreman_cif", "yuv")),
+            352, 288, 1));
+    Scaler scaler;
+    ASSERT_EQ(0, scaler.Set(352, 288, width, height, kI420, kI420,
+                            kScaleBilinear));
+    std::vector<VideoFrameType> frame_types(kNumberOfSimulcastStreams,
+                                            kDeltaFrame);
+    VideoFrame frame;
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+    for (int i = 0; i < kNumFrames; ++i) {
+      ASSERT_EQ(0, scaler.Scale(*generator->NextFrame(), &frame));
+      frame.set_timestamp(3000 * i);
+      const TickTime start = TickTime::Now();
+      ASSERT_EQ(0, adapter.Encode(frame, NULL, &frame_types));
+      const int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+      total_us += elapsed_us;
+      max_us = std::max(max_us, elapsed_us);
+    }
+    printf("%dx%d, %s: %.2f ms mean, %.2f ms max encode latency\n", width,
+           height, encode_streams_in_parallel ? "parallel" : "sequential",
+           total_us / 1000.0 / kNumFrames, max_us / 1000.0);
+  }
+};
+
+TEST(ParallelSimulcastEncoderAdapterTest, DISABLED_EncodeLatencyBenchmark) {
+  SimulcastEncodeLatencyBenchmark benchmark;
+  benchmark.Run(352, 288, false);
+  benchmark.Run(352, 288, true);
+  // There is no 720p clip among the resources, so foreman_cif is upscaled.
+  benchmark.Run(1280, 720, false);
+  benchmark.Run(1280, 720, true);
+}
+
 }  // namespace testing
 }  // namespace webrtc
@@ -16,6 +16,7 @@
 namespace webrtc {
 
 bool VP8EncoderFactoryConfig::use_simulcast_adapter_ = false;
+bool VP8EncoderFactoryConfig::encode_streams_in_parallel_ = false;
 
 class VP8EncoderImplFactory : public VideoEncoderFactory {
  public:
@@ -28,7 +29,9 @@ class VP8EncoderImplFactory : public VideoEncoderFactory {
 
 VP8Encoder* VP8Encoder::Create() {
   if (VP8EncoderFactoryConfig::use_simulcast_adapter()) {
-    return new SimulcastEncoderAdapter(new VP8EncoderImplFactory());
+    return new SimulcastEncoderAdapter(
+        new VP8EncoderImplFactory(),
+        VP8EncoderFactoryConfig::encode_streams_in_parallel());
   } else {
     return new VP8EncoderImpl();
   }
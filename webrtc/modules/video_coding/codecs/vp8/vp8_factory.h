@@ -25,8 +25,17 @@ class VP8EncoderFactoryConfig {
   }
   static bool use_simulcast_adapter() { return use_simulcast_adapter_; }
 
+  // Makes the SimulcastEncoderAdapter encode the streams in parallel.
+  static void set_encode_streams_in_parallel(bool encode_streams_in_parallel) {
+    encode_streams_in_parallel_ = encode_streams_in_parallel;
+  }
+  static bool encode_streams_in_parallel() {
+    return encode_streams_in_parallel_;
+  }
+
  private:
   static bool use_simulcast_adapter_;
+  static bool encode_streams_in_parallel_;
 };
 
 }  // namespace webrtc
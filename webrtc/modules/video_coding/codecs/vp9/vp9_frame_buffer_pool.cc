@@ -32,6 +32,9 @@ void Vp9FrameBufferPool::Vp9FrameBuffer::SetSize(size_t size) {
   data_.SetSize(size);
 }
 
+Vp9FrameBufferPool::Vp9FrameBufferPool()
+    : max_num_buffers_(kDefaultMaxNumBuffers) {}
+
 bool Vp9FrameBufferPool::InitializeVpxUsePool(
     vpx_codec_ctx* vpx_codec_context) {
   DCHECK(vpx_codec_context);
@@ -51,6 +54,11 @@ bool Vp9FrameBufferPool::InitializeVpxUsePool(
   return true;
 }
 
+void Vp9FrameBufferPool::SetMaxNumBuffers(size_t max_num_buffers) {
+  rtc::CritScope cs(&buffers_lock_);
+  max_num_buffers_ = max_num_buffers;
+}
+
 rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer>
 Vp9FrameBufferPool::GetFrameBuffer(size_t min_size) {
   DCHECK_GT(min_size, 0u);
@@ -66,10 +66,19 @@ class Vp9FrameBufferPool {
     rtc::Buffer data_;
   };
 
+  // More buffers than this are not expected with a single decoding thread.
+  static const size_t kDefaultMaxNumBuffers = 10;
+
+  Vp9FrameBufferPool();
+
   // Configures libvpx to, in the specified context, use this memory pool for
   // buffers used to decompress frames. This is only supported for VP9.
   bool InitializeVpxUsePool(vpx_codec_ctx* vpx_codec_context);
 
+  // Sets how many buffers may be allocated before warnings are printed. Frame
+  // parallel decoding keeps more frames alive than decoding on one thread.
+  void SetMaxNumBuffers(size_t max_num_buffers);
+
   // Gets a frame buffer of at least |min_size|, recycling an available one or
   // creating a new one. When no longer referenced from the outside the buffer
   // becomes recyclable.
@@ -102,14 +111,14 @@ class Vp9FrameBufferPool {
                                      vpx_codec_frame_buffer* fb);
 
  private:
-  // Protects |allocated_buffers_|.
+  // Protects |allocated_buffers_| and |max_num_buffers_|.
   mutable rtc::CriticalSection buffers_lock_;
   // All buffers, in use or ready to be recycled.
   std::vector<rtc::scoped_refptr<Vp9FrameBuffer>> allocated_buffers_
       GUARDED_BY(buffers_lock_);
   // If more buffers than this are allocated we print warnings, and crash if
   // in debug mode.
-  static const size_t max_num_buffers_ = 10;
+  size_t max_num_buffers_ GUARDED_BY(buffers_lock_);
 };
 
 }  // namespace webrtc
@@ -14,6 +14,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "vpx/vpx_encoder.h"
@@ -42,6 +44,16 @@ static void WrappedI420BufferNoLongerUsedCb(
 
 namespace webrtc {
 
+// Column tiles are at least this many pixels wide.
+const int kMinTileColumnWidth = 256;
+
+// The decoder doesn't use more threads than this.
+const int kMaxDecoderThreads = 8;
+
+// Decoded frames which libvpx caches for output when decoding frames in
+// parallel (FRAME_CACHE_SIZE in vp9_dx_iface.c).
+const size_t kFrameParallelCacheSize = 6;
+
 // Only positive speeds, range for real-time coding currently is: 5 - 8.
 // Lower means slower/better quality, higher means fastest/lower quality.
 int GetCpuSpeed(int width, int height) {
@@ -338,16 +350,15 @@ int VP9EncoderImpl::NumberOfThreads(int width,
     return 1;
   }
 
-  // Keep the number of encoder threads equal to the possible number of column
-  // tiles, which is (1, 2, 4, 8). See comments below for VP9E_SET_TILE_COLUMNS.
-  if (width * height >= 1280 * 720 && number_of_cores > 4) {
-    return 4;
-  } else if (width * height >= 640 * 480 && number_of_cores > 2) {
-    return 2;
-  } else {
-    // 1 thread less than VGA.
-    return 1;
+  // Keep the number of encoder threads equal to the number of column tiles,
+  // which is a power of two, and leave one core for the rest of the pipeline.
+  // See comments below for VP9E_SET_TILE_COLUMNS.
+  int num_threads = 1;
+  while (num_threads * 2 * kMinTileColumnWidth <= width &&
+         num_threads * 2 < number_of_cores) {
+    num_threads *= 2;
   }
+  return num_threads;
 }
 
 int VP9EncoderImpl::InitAndSetControlSettings(const VideoCodec* inst) {
@@ -392,7 +403,11 @@ int VP9EncoderImpl::InitAndSetControlSettings(const VideoCodec* inst) {
   // log2 unit: e.g., 0 = 1 tile column, 1 = 2 tile columns, 2 = 4 tile columns.
   // The number tile columns will be capped by the encoder based on image size
   // (minimum width of tile column is 256 pixels, maximum is 4096).
-  vpx_codec_control(encoder_, VP9E_SET_TILE_COLUMNS, (config_->g_threads >> 1));
+  // There is one tile column per encoder thread.
+  int tile_columns_log2 = 0;
+  while ((2u << tile_columns_log2) <= config_->g_threads)
+    ++tile_columns_log2;
+  vpx_codec_control(encoder_, VP9E_SET_TILE_COLUMNS, tile_columns_log2);
 #if !defined(WEBRTC_ARCH_ARM) && !defined(WEBRTC_ARCH_ARM64)
   // Note denoiser is still off by default until further testing/optimization,
   // i.e., codecSpecific.VP9.denoisingOn == 0.
@@ -621,6 +636,7 @@ VP9DecoderImpl::VP9DecoderImpl()
     : decode_complete_callback_(NULL),
       inited_(false),
       decoder_(NULL),
+      number_of_cores_(1),
       key_frame_required_(true) {
   memset(&codec_, 0, sizeof(codec_));
 }
@@ -642,10 +658,21 @@ int VP9DecoderImpl::Reset() {
   if (!inited_) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
-  InitDecode(&codec_, 1);
+  InitDecode(&codec_, number_of_cores_);
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+int VP9DecoderImpl::NumberOfThreads(int number_of_cores) {
+  // The stream resolution is not known until the first frame is decoded.
+  // libvpx only uses as many threads as there are tile columns, plus one for
+  // the loop filter, so more threads than cores with small frames cost nothing
+  // but the idle threads. As for the encoder, leave one core for the rest of
+  // the pipeline. Callers decoding many streams should pass a single core, as
+  // VideoReceiveStream does for the streams decoded on a DecodeThreadPool, so
+  // that each decoder doesn't start up to kMaxDecoderThreads threads.
+  return std::max(1, std::min(number_of_cores - 1, kMaxDecoderThreads));
+}
+
 int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
   if (inst == NULL) {
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
@@ -658,10 +685,20 @@ int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
     decoder_ = new vpx_codec_ctx_t;
   }
   vpx_codec_dec_cfg_t  cfg;
-  // Setting number of threads to a constant value (1)
-  cfg.threads = 1;
+  // With more than one thread libvpx decodes the tile columns in parallel and
+  // filters the rows of the frame on a separate thread. In frame parallel mode
+  // the threads decode consecutive frames instead.
+  cfg.threads = NumberOfThreads(number_of_cores);
   cfg.h = cfg.w = 0;  // set after decode
   vpx_codec_flags_t flags = 0;
+  const bool frame_parallel =
+      inst->codecType == kVideoCodecVP9 &&
+      inst->codecSpecific.VP9.frameParallelDecoding && cfg.threads > 1;
+  if (frame_parallel) {
+    // Our encoder produces error resilient streams, which have no backward
+    // adaptation between frames and so can be decoded frame parallel.
+    flags |= VPX_CODEC_USE_FRAME_THREADING;
+  }
   if (vpx_codec_dec_init(decoder_, vpx_codec_vp9_dx(), &cfg, flags)) {
     return WEBRTC_VIDEO_CODEC_MEMORY;
   }
@@ -669,7 +706,14 @@ int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
     // Save VideoCodec instance for later; mainly for duplicating the decoder.
     codec_ = *inst;
   }
+  number_of_cores_ = number_of_cores;
 
+  // Each frame in flight holds on to a buffer, as does each decoded frame
+  // waiting to be output.
+  frame_buffer_pool_.SetMaxNumBuffers(
+      frame_parallel ? Vp9FrameBufferPool::kDefaultMaxNumBuffers +
+                           cfg.threads - 1 + kFrameParallelCacheSize
+                     : Vp9FrameBufferPool::kDefaultMaxNumBuffers);
   if (!frame_buffer_pool_.InitializeVpxUsePool(decoder_)) {
     return WEBRTC_VIDEO_CODEC_MEMORY;
   }
@@ -709,11 +753,15 @@ int VP9DecoderImpl::Decode(const EncodedImage& input_image,
     buffer = NULL;  // Triggers full frame concealment.
   }
   // During decode libvpx may get and release buffers from |frame_buffer_pool_|.
-  // In practice libvpx keeps a few (~3-4) buffers alive at a time.
+  // In practice libvpx keeps a few (~3-4) buffers alive at a time, more when
+  // decoding frames in parallel.
+  // The timestamp is passed as user data, since decoding frames in parallel
+  // outputs them a few calls later.
   if (vpx_codec_decode(decoder_,
                        buffer,
                        static_cast<unsigned int>(input_image._length),
-                       0,
+                       reinterpret_cast<void*>(
+                           static_cast<uintptr_t>(input_image._timeStamp)),
                        VPX_DL_REALTIME)) {
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
@@ -721,10 +769,20 @@ int VP9DecoderImpl::Decode(const EncodedImage& input_image,
   // It may be released by libvpx during future vpx_codec_decode or
   // vpx_codec_destroy calls.
   img = vpx_codec_get_frame(decoder_, &iter);
-  int ret = ReturnFrame(img, input_image._timeStamp);
-  if (ret != 0) {
-    return ret;
+  if (img == NULL) {
+    // No show frame, or the frame is still being decoded.
+    return WEBRTC_VIDEO_CODEC_NO_OUTPUT;
   }
+  // Decoding frames in parallel may output more than one frame at a time.
+  do {
+    int ret = ReturnFrame(
+        img,
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(img->user_priv)));
+    if (ret != 0) {
+      return ret;
+    }
+    img = vpx_codec_get_frame(decoder_, &iter);
+  } while (img != NULL);
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
@@ -117,12 +117,16 @@ class VP9DecoderImpl : public VP9Decoder {
  private:
   int ReturnFrame(const vpx_image_t* img, uint32_t timeStamp);
 
+  // Determine number of decoder threads to use.
+  static int NumberOfThreads(int number_of_cores);
+
   // Memory pool used to share buffers between libvpx and webrtc.
   Vp9FrameBufferPool frame_buffer_pool_;
   DecodedImageCallback* decode_complete_callback_;
   bool inited_;
   vpx_codec_ctx_t* decoder_;
   VideoCodec codec_;
+  int number_of_cores_;
   bool key_frame_required_;
 };
 }  // namespace webrtc
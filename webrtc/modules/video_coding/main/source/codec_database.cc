@@ -63,6 +63,7 @@ VideoCodecVP9 VideoEncoder::GetDefaultVp9Settings() {
   vp9_settings.adaptiveQpMode = true;
   vp9_settings.numberOfSpatialLayers = 1;
   vp9_settings.flexibleMode = false;
+  vp9_settings.frameParallelDecoding = false;
   return vp9_settings;
 }
 
@@ -263,6 +263,13 @@ class VideoProcessingModule : public Module {
   Enable content analysis
   */
   virtual void EnableContentAnalysis(bool enable) = 0;
+
+  /**
+  Enable temporal denoising of the preprocessed frames. Noise costs bits to
+  encode, so denoising noisy camera input lowers the bitrate needed for a
+  given quality. Disabled by default.
+  */
+  virtual void EnableDenoising(bool enable) = 0;
 };
 
 }  // namespace webrtc
@@ -36,7 +36,10 @@ VPMContentAnalysis::VPMContentAnalysis(bool runtime_cpu_detection)
 
   if (runtime_cpu_detection) {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-    if (WebRtc_GetCPUInfo(kSSE2)) {
+    if (WebRtc_GetCPUInfo(kAVX2)) {
+      ComputeSpatialMetrics = &VPMContentAnalysis::ComputeSpatialMetrics_AVX2;
+      TemporalDiffMetric = &VPMContentAnalysis::TemporalDiffMetric_AVX2;
+    } else if (WebRtc_GetCPUInfo(kSSE2)) {
       ComputeSpatialMetrics = &VPMContentAnalysis::ComputeSpatialMetrics_SSE2;
       TemporalDiffMetric = &VPMContentAnalysis::TemporalDiffMetric_SSE2;
     }
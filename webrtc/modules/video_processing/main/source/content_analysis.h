@@ -62,6 +62,8 @@ class VPMContentAnalysis {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
   int32_t ComputeSpatialMetrics_SSE2();
   int32_t TemporalDiffMetric_SSE2();
+  int32_t ComputeSpatialMetrics_AVX2();
+  int32_t TemporalDiffMetric_AVX2();
 #endif
 
   const uint8_t* orig_frame_;
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_processing/main/source/content_analysis.h"
+
+#include <immintrin.h>
+#include <math.h>
+
+namespace webrtc {
+
+namespace {
+
+// The work section of a row is a multiple of 16 pixels. Rows are processed 32
+// pixels at a time, and the last 16 pixels, if any, are loaded into the low
+// half of a register with zeros above. The zeros add nothing to any sum.
+__m256i LoadPixels(const uint8_t* pixels, int32_t count) {
+  if (count >= 32)
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+  return _mm256_inserti128_si256(
+      _mm256_setzero_si256(),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)), 0);
+}
+
+// Sums the four 64 bit lanes.
+uint64_t SumLanes64(__m256i v) {
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), v);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Widens the eight 32 bit lanes to 64 bits, summing them pairwise.
+__m256i WidenLanes32(__m256i v) {
+  const __m256i z = _mm256_setzero_si256();
+  return _mm256_add_epi64(_mm256_unpacklo_epi32(v, z),
+                          _mm256_unpackhi_epi32(v, z));
+}
+
+// Widens the sixteen 16 bit lanes to 32 bits, summing them pairwise.
+__m256i WidenLanes16(__m256i v) {
+  const __m256i z = _mm256_setzero_si256();
+  return _mm256_add_epi32(_mm256_unpacklo_epi16(v, z),
+                          _mm256_unpackhi_epi16(v, z));
+}
+
+}  // namespace
+
+int32_t VPMContentAnalysis::TemporalDiffMetric_AVX2() {
+  uint32_t num_pixels = 0;       // counter for # of pixels
+  const uint8_t* imgBufO = orig_frame_ + border_*width_ + border_;
+  const uint8_t* imgBufP = prev_frame_ + border_*width_ + border_;
+
+  const int32_t width_end = ((width_ - 2*border_) & -16) + border_;
+  const int32_t row_pixels = width_end - border_;
+
+  __m256i sad_64   = _mm256_setzero_si256();
+  __m256i sum_64   = _mm256_setzero_si256();
+  __m256i sqsum_64 = _mm256_setzero_si256();
+  const __m256i z  = _mm256_setzero_si256();
+
+  for (int32_t i = 0; i < (height_ - 2*border_); i += skip_num_) {
+    __m256i sqsum_32 = _mm256_setzero_si256();
+
+    // Like the SSE2 version, with 32 pixels at a time. Each 32 bit lane of
+    // |sqsum_32| adds four squares per iteration, so for HD content it stays
+    // below 60*4*65025, far from rolling over.
+    for (int32_t j = 0; j < row_pixels; j += 32) {
+      const __m256i o = LoadPixels(imgBufO + j, row_pixels - j);
+      const __m256i p = LoadPixels(imgBufP + j, row_pixels - j);
+
+      // Abs pixel difference between frames.
+      sad_64 = _mm256_add_epi64(sad_64, _mm256_sad_epu8(o, p));
+
+      // sum of all pixels in frame
+      sum_64 = _mm256_add_epi64(sum_64, _mm256_sad_epu8(o, z));
+
+      // Squared sum of all pixels in frame.
+      const __m256i olo = _mm256_unpacklo_epi8(o, z);
+      const __m256i ohi = _mm256_unpackhi_epi8(o, z);
+      sqsum_32 = _mm256_add_epi32(sqsum_32, _mm256_madd_epi16(olo, olo));
+      sqsum_32 = _mm256_add_epi32(sqsum_32, _mm256_madd_epi16(ohi, ohi));
+    }
+
+    // Add to 64 bit running sum as to not roll over.
+    sqsum_64 = _mm256_add_epi64(sqsum_64, WidenLanes32(sqsum_32));
+
+    imgBufO += width_ * skip_num_;
+    imgBufP += width_ * skip_num_;
+    num_pixels += row_pixels;
+  }
+
+  const uint32_t pixelSum = static_cast<uint32_t>(SumLanes64(sum_64));
+  const uint64_t pixelSqSum = SumLanes64(sqsum_64);
+  const uint32_t tempDiffSum = static_cast<uint32_t>(SumLanes64(sad_64));
+
+  // Default.
+  motion_magnitude_ = 0.0f;
+
+  if (tempDiffSum == 0) return VPM_OK;
+
+  // Normalize over all pixels.
+  const float tempDiffAvg = (float)tempDiffSum / (float)(num_pixels);
+  const float pixelSumAvg = (float)pixelSum / (float)(num_pixels);
+  const float pixelSqSumAvg = (float)pixelSqSum / (float)(num_pixels);
+  float contrast = pixelSqSumAvg - (pixelSumAvg * pixelSumAvg);
+
+  if (contrast > 0.0) {
+    contrast = sqrt(contrast);
+    motion_magnitude_ = tempDiffAvg/contrast;
+  }
+
+  return VPM_OK;
+}
+
+int32_t VPMContentAnalysis::ComputeSpatialMetrics_AVX2() {
+  const uint8_t* imgBuf = orig_frame_ + border_*width_;
+  const int32_t width_end = ((width_ - 2 * border_) & -16) + border_;
+  const int32_t row_pixels = width_end - border_;
+
+  __m256i se_32  = _mm256_setzero_si256();
+  __m256i sev_32 = _mm256_setzero_si256();
+  __m256i seh_32 = _mm256_setzero_si256();
+  __m256i msa_32 = _mm256_setzero_si256();
+  const __m256i z = _mm256_setzero_si256();
+
+  // The accumulators have the same bounds as in the SSE2 version; each 16 bit
+  // lane of the row sums only gets half as many values.
+  for (int32_t i = 0; i < (height_ - 2*border_); i += skip_num_) {
+    __m256i se_16  = _mm256_setzero_si256();
+    __m256i sev_16 = _mm256_setzero_si256();
+    __m256i seh_16 = _mm256_setzero_si256();
+    __m256i msa_16 = _mm256_setzero_si256();
+
+    const uint8_t *lineTop = imgBuf - width_ + border_;
+    const uint8_t *lineCen = imgBuf + border_;
+    const uint8_t *lineBot = imgBuf + width_ + border_;
+
+    for (int32_t j = 0; j < row_pixels; j += 32) {
+      const int32_t count = row_pixels - j;
+      const __m256i t = LoadPixels(lineTop + j, count);
+      const __m256i l = LoadPixels(lineCen + j - 1, count);
+      const __m256i c = LoadPixels(lineCen + j, count);
+      const __m256i r = LoadPixels(lineCen + j + 1, count);
+      const __m256i b = LoadPixels(lineBot + j, count);
+
+      // center pixel unpacked
+      __m256i clo = _mm256_unpacklo_epi8(c, z);
+      __m256i chi = _mm256_unpackhi_epi8(c, z);
+
+      // left right pixels unpacked and added together
+      const __m256i lrlo = _mm256_add_epi16(_mm256_unpacklo_epi8(l, z),
+                                            _mm256_unpacklo_epi8(r, z));
+      const __m256i lrhi = _mm256_add_epi16(_mm256_unpackhi_epi8(l, z),
+                                            _mm256_unpackhi_epi8(r, z));
+
+      // top & bottom pixels unpacked and added together
+      const __m256i tblo = _mm256_add_epi16(_mm256_unpacklo_epi8(t, z),
+                                            _mm256_unpacklo_epi8(b, z));
+      const __m256i tbhi = _mm256_add_epi16(_mm256_unpackhi_epi8(t, z),
+                                            _mm256_unpackhi_epi8(b, z));
+
+      // running sum of all pixels
+      msa_16 = _mm256_add_epi16(msa_16, _mm256_add_epi16(chi, clo));
+
+      clo = _mm256_slli_epi16(clo, 1);
+      chi = _mm256_slli_epi16(chi, 1);
+      const __m256i sevtlo = _mm256_sub_epi16(clo, tblo);
+      const __m256i sevthi = _mm256_sub_epi16(chi, tbhi);
+      const __m256i sehtlo = _mm256_sub_epi16(clo, lrlo);
+      const __m256i sehthi = _mm256_sub_epi16(chi, lrhi);
+
+      clo = _mm256_slli_epi16(clo, 1);
+      chi = _mm256_slli_epi16(chi, 1);
+      const __m256i setlo = _mm256_sub_epi16(clo, _mm256_add_epi16(lrlo, tblo));
+      const __m256i sethi = _mm256_sub_epi16(chi, _mm256_add_epi16(lrhi, tbhi));
+
+      // Add to 16 bit running sum. The differences are within +-1020, so
+      // they are exact.
+      se_16 = _mm256_add_epi16(se_16, _mm256_abs_epi16(setlo));
+      se_16 = _mm256_add_epi16(se_16, _mm256_abs_epi16(sethi));
+      sev_16 = _mm256_add_epi16(sev_16, _mm256_abs_epi16(sevtlo));
+      sev_16 = _mm256_add_epi16(sev_16, _mm256_abs_epi16(sevthi));
+      seh_16 = _mm256_add_epi16(seh_16, _mm256_abs_epi16(sehtlo));
+      seh_16 = _mm256_add_epi16(seh_16, _mm256_abs_epi16(sehthi));
+    }
+
+    // Add to 32 bit running sum as to not roll over.
+    se_32 = _mm256_add_epi32(se_32, WidenLanes16(se_16));
+    sev_32 = _mm256_add_epi32(sev_32, WidenLanes16(sev_16));
+    seh_32 = _mm256_add_epi32(seh_32, WidenLanes16(seh_16));
+    msa_32 = _mm256_add_epi32(msa_32, WidenLanes16(msa_16));
+
+    imgBuf += width_ * skip_num_;
+  }
+
+  const uint32_t spatialErrSum =
+      static_cast<uint32_t>(SumLanes64(WidenLanes32(se_32)));
+  const uint32_t spatialErrVSum =
+      static_cast<uint32_t>(SumLanes64(WidenLanes32(sev_32)));
+  const uint32_t spatialErrHSum =
+      static_cast<uint32_t>(SumLanes64(WidenLanes32(seh_32)));
+  const uint32_t pixelMSA =
+      static_cast<uint32_t>(SumLanes64(WidenLanes32(msa_32)));
+
+  // Normalize over all pixels.
+  const float spatialErr  = (float)(spatialErrSum >> 2);
+  const float spatialErrH = (float)(spatialErrHSum >> 1);
+  const float spatialErrV = (float)(spatialErrVSum >> 1);
+  const float norm = (float)pixelMSA;
+
+  // 2X2:
+  spatial_pred_err_ = spatialErr / norm;
+
+  // 1X2:
+  spatial_pred_err_h_ = spatialErrH / norm;
+
+  // 2X1:
+  spatial_pred_err_v_ = spatialErrV / norm;
+
+  return VPM_OK;
+}
+
+}  // namespace webrtc
@@ -15,7 +15,6 @@
 
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/system_wrappers/interface/logging.h"
-#include "webrtc/system_wrappers/interface/sort.h"
 
 namespace webrtc {
 
@@ -121,24 +120,10 @@ int32_t VPMDeflickering::ProcessFrame(
     return 0;
   }
 
-  // Size of luminance component.
-  const uint32_t y_size = height * width;
-
+  const int stride = frame->stride(kYPlane);
+  const uint8_t* y_plane = frame->buffer(kYPlane);
   const uint32_t y_sub_size = width * (((height - 1) >>
       kLog2OfDownsamplingFactor) + 1);
-  uint8_t* y_sorted = new uint8_t[y_sub_size];
-  uint32_t sort_row_idx = 0;
-  for (int i = 0; i < height; i += kDownsamplingFactor) {
-    memcpy(y_sorted + sort_row_idx * width,
-        frame->buffer(kYPlane) + i * width, width);
-    sort_row_idx++;
-  }
-
-  webrtc::Sort(y_sorted, y_sub_size, webrtc::TYPE_UWord8);
-
-  uint32_t prob_idx_uw32 = 0;
-  quant_uw8[0] = 0;
-  quant_uw8[kNumQuants - 1] = 255;
 
   // Ensure we won't get an overflow below.
   // In practice, the number of subsampled pixels will not become this large.
@@ -147,15 +132,33 @@ int32_t VPMDeflickering::ProcessFrame(
     return -1;
   }
 
+  // The quantiles are read from a histogram of the subsampled rows, which
+  // gives the same pixels as sorting them at a fraction of the cost.
+  uint32_t hist_uw32[256] = {0};
+  for (int i = 0; i < height; i += kDownsamplingFactor) {
+    const uint8_t* row = y_plane + i * stride;
+    for (int j = 0; j < width; j++) {
+      hist_uw32[row[j]]++;
+    }
+  }
+
+  quant_uw8[0] = 0;
+  quant_uw8[kNumQuants - 1] = 255;
+  // The probabilities are increasing, so one pass over the histogram finds
+  // all the quantiles. |num_below| is the number of pixels below |value|.
+  uint32_t num_below = 0;
+  uint32_t value = 0;
   for (int32_t i = 0; i < kNumProbs; i++) {
     // <Q0>.
-    prob_idx_uw32 = WEBRTC_SPL_UMUL_32_16(y_sub_size, prob_uw16_[i]) >> 11;
-    quant_uw8[i + 1] = y_sorted[prob_idx_uw32];
+    const uint32_t prob_idx_uw32 =
+        WEBRTC_SPL_UMUL_32_16(y_sub_size, prob_uw16_[i]) >> 11;
+    while (num_below + hist_uw32[value] <= prob_idx_uw32) {
+      num_below += hist_uw32[value];
+      value++;
+    }
+    quant_uw8[i + 1] = static_cast<uint8_t>(value);
   }
 
-  delete [] y_sorted;
-  y_sorted = NULL;
-
   // Shift history for new frame.
   memmove(quant_hist_uw8_[1], quant_hist_uw8_[0],
       (kFrameHistory_size - 1) * kNumQuants * sizeof(uint8_t));
@@ -224,9 +227,11 @@ int32_t VPMDeflickering::ProcessFrame(
   }
 
   // Map to the output frame.
-  uint8_t* buffer = frame->buffer(kYPlane);
-  for (uint32_t i = 0; i < y_size; i++) {
-    buffer[i] = map_uw8[buffer[i]];
+  for (int i = 0; i < height; i++) {
+    uint8_t* row = frame->buffer(kYPlane) + i * stride;
+    for (int j = 0; j < width; j++) {
+      row[j] = map_uw8[row[j]];
+    }
   }
 
   // Frame was altered, so reset stats.
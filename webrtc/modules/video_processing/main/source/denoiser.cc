@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_processing/main/source/denoiser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+VPMDenoiser::VPMDenoiser(bool runtime_cpu_detection)
+    : denoise_block_(&VPMDenoiser::DenoiseBlock_C),
+      width_(0),
+      height_(0) {
+  if (runtime_cpu_detection) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (WebRtc_GetCPUInfo(kSSE2)) {
+      denoise_block_ = &VPMDenoiser::DenoiseBlock_SSE2;
+    }
+#endif
+  }
+}
+
+VPMDenoiser::~VPMDenoiser() {}
+
+void VPMDenoiser::Reset() {
+  prev_frame_.reset();
+  width_ = 0;
+  height_ = 0;
+}
+
+int32_t VPMDenoiser::ProcessFrame(const VideoFrame& frame,
+                                  VideoFrame* denoised_frame) {
+  if (frame.IsZeroSize() || frame.native_handle()) {
+    return VPM_PARAMETER_ERROR;
+  }
+
+  const int width = frame.width();
+  const int height = frame.height();
+  if (denoised_frame->CreateEmptyFrame(width, height, frame.stride(kYPlane),
+                                       frame.stride(kUPlane),
+                                       frame.stride(kVPlane)) < 0) {
+    return VPM_GENERAL_ERROR;
+  }
+  // Only the luma plane is denoised; the chroma planes and the frame
+  // properties are copied as they are.
+  memcpy(denoised_frame->buffer(kUPlane), frame.buffer(kUPlane),
+         frame.allocated_size(kUPlane));
+  memcpy(denoised_frame->buffer(kVPlane), frame.buffer(kVPlane),
+         frame.allocated_size(kVPlane));
+  denoised_frame->set_timestamp(frame.timestamp());
+  denoised_frame->set_ntp_time_ms(frame.ntp_time_ms());
+  denoised_frame->set_render_time_ms(frame.render_time_ms());
+  denoised_frame->set_rotation(frame.rotation());
+
+  if (!prev_frame_ || width != width_ || height != height_) {
+    // Nothing to filter with; keep the frame as the previous one.
+    memcpy(denoised_frame->buffer(kYPlane), frame.buffer(kYPlane),
+           frame.allocated_size(kYPlane));
+    width_ = width;
+    height_ = height;
+    prev_frame_.reset(new uint8_t[width_ * height_]);
+  } else {
+    const uint8_t* src = frame.buffer(kYPlane);
+    const int src_stride = frame.stride(kYPlane);
+    uint8_t* dst = denoised_frame->buffer(kYPlane);
+    const int dst_stride = denoised_frame->stride(kYPlane);
+    for (int y = 0; y < height_; y += kBlockSize) {
+      const int block_height = std::min<int>(kBlockSize, height_ - y);
+      for (int x = 0; x < width_; x += kBlockSize) {
+        const int block_width = std::min<int>(kBlockSize, width_ - x);
+        // The optimized versions only handle whole blocks.
+        DenoiseBlockFunc denoise_block =
+            (block_width == kBlockSize && block_height == kBlockSize) ?
+            denoise_block_ : &VPMDenoiser::DenoiseBlock_C;
+        denoise_block(src + y * src_stride + x, src_stride,
+                      prev_frame_.get() + y * width_ + x, width_,
+                      dst + y * dst_stride + x, dst_stride,
+                      block_width, block_height);
+      }
+    }
+  }
+
+  const uint8_t* denoised = denoised_frame->buffer(kYPlane);
+  for (int y = 0; y < height_; ++y) {
+    memcpy(prev_frame_.get() + y * width_,
+           denoised + y * denoised_frame->stride(kYPlane), width_);
+  }
+  return VPM_OK;
+}
+
+void VPMDenoiser::DenoiseBlock_C(const uint8_t* src, int src_stride,
+                                 const uint8_t* prev, int prev_stride,
+                                 uint8_t* dst, int dst_stride,
+                                 int width, int height) {
+  int sad = 0;
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      sad += abs(src[i * src_stride + j] - prev[i * prev_stride + j]);
+    }
+  }
+
+  // Moving blocks are kept.
+  if (sad > kMotionThreshold * width * height) {
+    for (int i = 0; i < height; ++i) {
+      memcpy(dst + i * dst_stride, src + i * src_stride, width);
+    }
+    return;
+  }
+
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      const int s = src[i * src_stride + j];
+      const int p = prev[i * prev_stride + j];
+      dst[i * dst_stride + j] = static_cast<uint8_t>(
+          abs(s - p) <= kNoiseThreshold ? (s + p + 1) >> 1 : s);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_PROCESSING_MAIN_SOURCE_DENOISER_H
+#define WEBRTC_MODULES_VIDEO_PROCESSING_MAIN_SOURCE_DENOISER_H
+
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/video_processing/main/interface/video_processing_defines.h"
+#include "webrtc/typedefs.h"
+#include "webrtc/video_frame.h"
+
+namespace webrtc {
+
+// Temporal denoiser for camera input. Each luma pixel is averaged with the
+// previous denoised frame when the two differ by no more than sensor noise.
+// Blocks which differ more on average are moving and are left as they are, so
+// that moving edges don't leave trails. The chroma planes are copied.
+class VPMDenoiser {
+ public:
+  // When |runtime_cpu_detection| is true, runtime selection of an optimized
+  // code path is allowed.
+  explicit VPMDenoiser(bool runtime_cpu_detection);
+  ~VPMDenoiser();
+
+  // Forgets the previous frame, so the next frame is passed through.
+  void Reset();
+
+  // Denoises |frame| into |denoised_frame|.
+  // Return value: 0 if OK, negative value upon error.
+  int32_t ProcessFrame(const VideoFrame& frame, VideoFrame* denoised_frame);
+
+  enum { kBlockSize = 16 };
+  // Largest difference of a pixel from the previous frame which is filtered.
+  enum { kNoiseThreshold = 8 };
+  // Largest average difference of a block from the previous frame for which
+  // the block is filtered.
+  enum { kMotionThreshold = 4 };
+
+ private:
+  // Denoises a block of |width| x |height| pixels of |src| into |dst|, with
+  // |prev| as the previous denoised block.
+  typedef void (*DenoiseBlockFunc)(const uint8_t* src, int src_stride,
+                                   const uint8_t* prev, int prev_stride,
+                                   uint8_t* dst, int dst_stride,
+                                   int width, int height);
+  static void DenoiseBlock_C(const uint8_t* src, int src_stride,
+                             const uint8_t* prev, int prev_stride,
+                             uint8_t* dst, int dst_stride,
+                             int width, int height);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  // Only handles blocks of kBlockSize x kBlockSize pixels.
+  static void DenoiseBlock_SSE2(const uint8_t* src, int src_stride,
+                                const uint8_t* prev, int prev_stride,
+                                uint8_t* dst, int dst_stride,
+                                int width, int height);
+#endif
+
+  DenoiseBlockFunc denoise_block_;
+  // The luma plane of the previous denoised frame, without padding.
+  rtc::scoped_ptr<uint8_t[]> prev_frame_;
+  int width_;
+  int height_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_PROCESSING_MAIN_SOURCE_DENOISER_H
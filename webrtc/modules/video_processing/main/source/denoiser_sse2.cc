@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_processing/main/source/denoiser.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+void VPMDenoiser::DenoiseBlock_SSE2(const uint8_t* src, int src_stride,
+                                    const uint8_t* prev, int prev_stride,
+                                    uint8_t* dst, int dst_stride,
+                                    int width, int height) {
+  __m128i sad_64 = _mm_setzero_si128();
+  for (int i = 0; i < kBlockSize; ++i) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * src_stride));
+    const __m128i p = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(prev + i * prev_stride));
+    sad_64 = _mm_add_epi64(sad_64, _mm_sad_epu8(s, p));
+  }
+  const int sad = _mm_cvtsi128_si32(sad_64) +
+                  _mm_cvtsi128_si32(_mm_srli_si128(sad_64, 8));
+
+  // Moving blocks are kept.
+  if (sad > kMotionThreshold * kBlockSize * kBlockSize) {
+    for (int i = 0; i < kBlockSize; ++i) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dst + i * dst_stride),
+          _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(src + i * src_stride)));
+    }
+    return;
+  }
+
+  const __m128i threshold = _mm_set1_epi8(kNoiseThreshold);
+  for (int i = 0; i < kBlockSize; ++i) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * src_stride));
+    const __m128i p = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(prev + i * prev_stride));
+    // |s - p| <= threshold, as a mask.
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(s, p), _mm_subs_epu8(p, s));
+    const __m128i noise =
+        _mm_cmpeq_epi8(_mm_min_epu8(diff, threshold), diff);
+    // _mm_avg_epu8 rounds up like (s + p + 1) >> 1.
+    const __m128i filtered = _mm_or_si128(
+        _mm_and_si128(noise, _mm_avg_epu8(s, p)), _mm_andnot_si128(noise, s));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * dst_stride),
+                     filtered);
+  }
+}
+
+}  // namespace webrtc
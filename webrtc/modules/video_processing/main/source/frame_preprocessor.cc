@@ -15,11 +15,14 @@ namespace webrtc {
 VPMFramePreprocessor::VPMFramePreprocessor()
     : content_metrics_(NULL),
       resampled_frame_(),
+      denoised_frame_(),
       enable_ca_(false),
+      enable_denoising_(false),
       frame_cnt_(0) {
   spatial_resampler_ = new VPMSimpleSpatialResampler();
   ca_ = new VPMContentAnalysis(true);
   vd_ = new VPMVideoDecimator();
+  denoiser_ = new VPMDenoiser(true);
 }
 
 VPMFramePreprocessor::~VPMFramePreprocessor() {
@@ -27,14 +30,17 @@ VPMFramePreprocessor::~VPMFramePreprocessor() {
   delete spatial_resampler_;
   delete ca_;
   delete vd_;
+  delete denoiser_;
 }
 
 void  VPMFramePreprocessor::Reset() {
   ca_->Release();
   vd_->Reset();
+  denoiser_->Reset();
   content_metrics_ = NULL;
   spatial_resampler_->Reset();
   enable_ca_ = false;
+  enable_denoising_ = false;
   frame_cnt_ = 0;
 }
 
@@ -46,6 +52,14 @@ void VPMFramePreprocessor::EnableContentAnalysis(bool enable) {
   enable_ca_ = enable;
 }
 
+void VPMFramePreprocessor::EnableDenoising(bool enable) {
+  if (!enable) {
+    // Start over from the next frame when enabled again.
+    denoiser_->Reset();
+  }
+  enable_denoising_ = enable;
+}
+
 void  VPMFramePreprocessor::SetInputFrameResampleMode(
     VideoFrameResampling resampling_mode) {
   spatial_resampler_->SetInputFrameResampleMode(resampling_mode);
@@ -113,6 +127,15 @@ int32_t VPMFramePreprocessor::PreprocessFrame(const VideoFrame& frame,
     *processed_frame = &resampled_frame_;
   }
 
+  // Denoise the frame to be encoded, at the encoded size.
+  if (enable_denoising_ && !frame.native_handle()) {
+    const VideoFrame& input =
+        *processed_frame == NULL ? frame : **processed_frame;
+    int32_t ret = denoiser_->ProcessFrame(input, &denoised_frame_);
+    if (ret != VPM_OK) return ret;
+    *processed_frame = &denoised_frame_;
+  }
+
   // Perform content analysis on the frame to be encoded.
   if (enable_ca_) {
     // Compute new metrics every |kSkipFramesCA| frames, starting with
@@ -121,7 +144,7 @@ int32_t VPMFramePreprocessor::PreprocessFrame(const VideoFrame& frame,
       if (*processed_frame == NULL)  {
         content_metrics_ = ca_->ComputeContentMetrics(frame);
       } else {
-        content_metrics_ = ca_->ComputeContentMetrics(resampled_frame_);
+        content_metrics_ = ca_->ComputeContentMetrics(**processed_frame);
       }
     }
     ++frame_cnt_;
@@ -16,6 +16,7 @@
 
 #include "webrtc/modules/video_processing/main/interface/video_processing.h"
 #include "webrtc/modules/video_processing/main/source/content_analysis.h"
+#include "webrtc/modules/video_processing/main/source/denoiser.h"
 #include "webrtc/modules/video_processing/main/source/spatial_resampler.h"
 #include "webrtc/modules/video_processing/main/source/video_decimator.h"
 #include "webrtc/typedefs.h"
@@ -37,6 +38,9 @@ class VPMFramePreprocessor {
   // Enable content analysis.
   void EnableContentAnalysis(bool enable);
 
+  // Enable temporal denoising.
+  void EnableDenoising(bool enable);
+
   // Set target resolution: frame rate and dimension.
   int32_t SetTargetResolution(uint32_t width, uint32_t height,
                               uint32_t frame_rate);
@@ -66,10 +70,13 @@ class VPMFramePreprocessor {
 
   VideoContentMetrics* content_metrics_;
   VideoFrame resampled_frame_;
+  VideoFrame denoised_frame_;
   VPMSpatialResampler* spatial_resampler_;
   VPMContentAnalysis* ca_;
   VPMVideoDecimator* vd_;
+  VPMDenoiser* denoiser_;
   bool enable_ca_;
+  bool enable_denoising_;
   int frame_cnt_;
 
 };
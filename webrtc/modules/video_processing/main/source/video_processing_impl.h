@@ -43,6 +43,9 @@ class VideoProcessingModuleImpl : public VideoProcessingModule {
   // Enable content analysis
   void EnableContentAnalysis(bool enable) override;
 
+  // Enable temporal denoising
+  void EnableDenoising(bool enable) override;
+
   // Set Target Resolution: frame rate and dimension
   int32_t SetTargetResolution(uint32_t width,
                               uint32_t height,
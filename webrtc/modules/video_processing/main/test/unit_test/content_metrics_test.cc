@@ -12,17 +12,32 @@
 #include "webrtc/modules/video_processing/main/interface/video_processing.h"
 #include "webrtc/modules/video_processing/main/source/content_analysis.h"
 #include "webrtc/modules/video_processing/main/test/unit_test/video_processing_unittest.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/test/testsupport/gtest_disable.h"
 
 namespace webrtc {
 
+static WebRtc_CPUInfo g_get_cpu_info = NULL;
+
+static int GetCPUInfoNoAVX2(CPUFeature feature) {
+  return feature == kAVX2 ? 0 : g_get_cpu_info(feature);
+}
+
 TEST_F(VideoProcessingModuleTest, DISABLED_ON_IOS(ContentAnalysis)) {
   VPMContentAnalysis    ca__c(false);
   VPMContentAnalysis    ca__sse(true);
   VideoContentMetrics  *_cM_c, *_cM_SSE;
 
+  // Without AVX2, the runtime detection selects the SSE2 version, if any.
+  g_get_cpu_info = WebRtc_GetCPUInfo;
+  WebRtc_GetCPUInfo = GetCPUInfoNoAVX2;
+  VPMContentAnalysis    ca__no_avx2(true);
+  WebRtc_GetCPUInfo = g_get_cpu_info;
+  VideoContentMetrics  *_cM_no_avx2;
+
   ca__c.Initialize(width_,height_);
   ca__sse.Initialize(width_,height_);
+  ca__no_avx2.Initialize(width_,height_);
 
   rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[frame_length_]);
   while (fread(video_buffer.get(), 1, frame_length_, source_file_)
@@ -32,11 +47,17 @@ TEST_F(VideoProcessingModuleTest, DISABLED_ON_IOS(ContentAnalysis)) {
                                0, kVideoRotation_0, &video_frame_));
     _cM_c   = ca__c.ComputeContentMetrics(video_frame_);
     _cM_SSE = ca__sse.ComputeContentMetrics(video_frame_);
+    _cM_no_avx2 = ca__no_avx2.ComputeContentMetrics(video_frame_);
 
     ASSERT_EQ(_cM_c->spatial_pred_err, _cM_SSE->spatial_pred_err);
     ASSERT_EQ(_cM_c->spatial_pred_err_v, _cM_SSE->spatial_pred_err_v);
     ASSERT_EQ(_cM_c->spatial_pred_err_h, _cM_SSE->spatial_pred_err_h);
     ASSERT_EQ(_cM_c->motion_magnitude, _cM_SSE->motion_magnitude);
+
+    ASSERT_EQ(_cM_c->spatial_pred_err, _cM_no_avx2->spatial_pred_err);
+    ASSERT_EQ(_cM_c->spatial_pred_err_v, _cM_no_avx2->spatial_pred_err_v);
+    ASSERT_EQ(_cM_c->spatial_pred_err_h, _cM_no_avx2->spatial_pred_err_h);
+    ASSERT_EQ(_cM_c->motion_magnitude, _cM_no_avx2->motion_magnitude);
   }
   ASSERT_NE(0, feof(source_file_)) << "Error reading source file";
 }
@@ -0,0 +1,324 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/modules/video_coding/codecs/interface/video_error_codes.h"
+#include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
+#include "webrtc/modules/video_processing/main/interface/video_processing.h"
+#include "webrtc/modules/video_processing/main/source/denoiser.h"
+#include "webrtc/modules/video_processing/main/test/unit_test/video_processing_unittest.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/fileutils.h"
+#include "webrtc/test/testsupport/gtest_disable.h"
+
+namespace webrtc {
+
+namespace {
+
+// Not a multiple of the block size, and with padded rows.
+const int kWidth = 100;
+const int kHeight = 70;
+const int kStrideY = 128;
+const int kStrideUV = 64;
+
+void CreateFrame(VideoFrame* frame, uint8_t y_value) {
+  frame->CreateEmptyFrame(kWidth, kHeight, kStrideY, kStrideUV, kStrideUV);
+  memset(frame->buffer(kYPlane), y_value, frame->allocated_size(kYPlane));
+  memset(frame->buffer(kUPlane), 128, frame->allocated_size(kUPlane));
+  memset(frame->buffer(kVPlane), 128, frame->allocated_size(kVPlane));
+}
+
+// Adds noise of up to +-|amplitude| to the luma plane.
+void AddNoise(VideoFrame* frame, int amplitude) {
+  for (int y = 0; y < frame->height(); ++y) {
+    uint8_t* row = frame->buffer(kYPlane) + y * frame->stride(kYPlane);
+    for (int x = 0; x < frame->width(); ++x)
+      row[x] = static_cast<uint8_t>(row[x] + rand() % (2 * amplitude + 1) -
+                                    amplitude);
+  }
+}
+
+// Returns the sum of the absolute luma differences from |value|.
+int SumOfDifferences(const VideoFrame& frame, uint8_t value) {
+  int sum = 0;
+  for (int y = 0; y < frame.height(); ++y) {
+    const uint8_t* row = frame.buffer(kYPlane) + y * frame.stride(kYPlane);
+    for (int x = 0; x < frame.width(); ++x)
+      sum += abs(row[x] - value);
+  }
+  return sum;
+}
+
+bool EqualLumaPlanes(const VideoFrame& frame1, const VideoFrame& frame2) {
+  for (int y = 0; y < frame1.height(); ++y) {
+    if (memcmp(frame1.buffer(kYPlane) + y * frame1.stride(kYPlane),
+               frame2.buffer(kYPlane) + y * frame2.stride(kYPlane),
+               frame1.width()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(VPMDenoiserTest, FiltersStaticNoise) {
+  srand(0);
+  VPMDenoiser denoiser(true);
+  VideoFrame frame;
+  VideoFrame denoised_frame;
+  int noise = 0;
+  int remaining_noise = 0;
+  for (int i = 0; i < 10; ++i) {
+    CreateFrame(&frame, 100);
+    AddNoise(&frame, 4);
+    frame.set_timestamp(i);
+    frame.set_render_time_ms(1000 + i);
+    ASSERT_EQ(VPM_OK, denoiser.ProcessFrame(frame, &denoised_frame));
+    EXPECT_EQ(frame.timestamp(), denoised_frame.timestamp());
+    EXPECT_EQ(frame.render_time_ms(), denoised_frame.render_time_ms());
+    EXPECT_EQ(0, memcmp(frame.buffer(kUPlane), denoised_frame.buffer(kUPlane),
+                        frame.allocated_size(kUPlane)));
+    EXPECT_EQ(0, memcmp(frame.buffer(kVPlane), denoised_frame.buffer(kVPlane),
+                        frame.allocated_size(kVPlane)));
+    if (i == 0) {
+      // The first frame has nothing to be filtered with.
+      EXPECT_TRUE(EqualLumaPlanes(frame, denoised_frame));
+      continue;
+    }
+    noise += SumOfDifferences(frame, 100);
+    remaining_noise += SumOfDifferences(denoised_frame, 100);
+  }
+  EXPECT_LT(remaining_noise, noise * 2 / 3);
+}
+
+TEST(VPMDenoiserTest, KeepsMovingBlocks) {
+  VPMDenoiser denoiser(true);
+  VideoFrame frame;
+  VideoFrame denoised_frame;
+  CreateFrame(&frame, 100);
+  ASSERT_EQ(VPM_OK, denoiser.ProcessFrame(frame, &denoised_frame));
+
+  // The new value differs by more than the noise threshold everywhere.
+  CreateFrame(&frame, 100 + VPMDenoiser::kNoiseThreshold + 1);
+  ASSERT_EQ(VPM_OK, denoiser.ProcessFrame(frame, &denoised_frame));
+  EXPECT_TRUE(EqualLumaPlanes(frame, denoised_frame));
+
+  // Every pixel is within the noise threshold, but the blocks still differ by
+  // more than the motion threshold on average.
+  CreateFrame(&frame, 100 + VPMDenoiser::kNoiseThreshold + 1 +
+                          VPMDenoiser::kMotionThreshold + 1);
+  ASSERT_EQ(VPM_OK, denoiser.ProcessFrame(frame, &denoised_frame));
+  EXPECT_TRUE(EqualLumaPlanes(frame, denoised_frame));
+
+  // After a reset, the frame is passed through.
+  denoiser.Reset();
+  CreateFrame(&frame, 101);
+  ASSERT_EQ(VPM_OK, denoiser.ProcessFrame(frame, &denoised_frame));
+  EXPECT_TRUE(EqualLumaPlanes(frame, denoised_frame));
+}
+
+TEST(VPMDenoiserTest, RejectsEmptyFrames) {
+  VPMDenoiser denoiser(true);
+  VideoFrame frame;
+  VideoFrame denoised_frame;
+  EXPECT_EQ(VPM_PARAMETER_ERROR, denoiser.ProcessFrame(frame,
+                                                       &denoised_frame));
+}
+
+TEST_F(VideoProcessingModuleTest, DISABLED_ON_IOS(DenoisingIsBitExact)) {
+  VPMDenoiser denoiser_c(false);
+  VPMDenoiser denoiser_opt(true);
+  VideoFrame denoised_c;
+  VideoFrame denoised_opt;
+
+  rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[frame_length_]);
+  while (fread(video_buffer.get(), 1, frame_length_, source_file_) ==
+         frame_length_) {
+    EXPECT_EQ(0, ConvertToI420(kI420, video_buffer.get(), 0, 0, width_, height_,
+                               0, kVideoRotation_0, &video_frame_));
+    ASSERT_EQ(VPM_OK, denoiser_c.ProcessFrame(video_frame_, &denoised_c));
+    ASSERT_EQ(VPM_OK, denoiser_opt.ProcessFrame(video_frame_, &denoised_opt));
+    ASSERT_TRUE(EqualLumaPlanes(denoised_c, denoised_opt));
+  }
+  ASSERT_NE(0, feof(source_file_)) << "Error reading source file";
+}
+
+TEST_F(VideoProcessingModuleTest, DISABLED_ON_IOS(PreprocessFrameDenoises)) {
+  rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[frame_length_]);
+  ASSERT_EQ(frame_length_, fread(video_buffer.get(), 1, frame_length_,
+                                 source_file_));
+  EXPECT_EQ(0, ConvertToI420(kI420, video_buffer.get(), 0, 0, width_, height_,
+                             0, kVideoRotation_0, &video_frame_));
+  vpm_->EnableTemporalDecimation(false);
+  ASSERT_EQ(VPM_OK, vpm_->SetTargetResolution(width_, height_, 30));
+
+  // Without denoising or scaling, the frame isn't processed.
+  VideoFrame* processed_frame = NULL;
+  ASSERT_EQ(VPM_OK, vpm_->PreprocessFrame(video_frame_, &processed_frame));
+  EXPECT_TRUE(processed_frame == NULL);
+
+  vpm_->EnableDenoising(true);
+  ASSERT_EQ(VPM_OK, vpm_->PreprocessFrame(video_frame_, &processed_frame));
+  ASSERT_TRUE(processed_frame != NULL);
+  EXPECT_EQ(0, memcmp(video_buffer.get(), processed_frame->buffer(kYPlane),
+                      size_y_));
+
+  // A noisy copy of the frame is filtered.
+  VideoFrame noisy_frame;
+  noisy_frame.CopyFrame(video_frame_);
+  for (int i = 0; i < size_y_; ++i) {
+    noisy_frame.buffer(kYPlane)[i] =
+        static_cast<uint8_t>(noisy_frame.buffer(kYPlane)[i] ^ (i & 3));
+  }
+  ASSERT_EQ(VPM_OK, vpm_->PreprocessFrame(noisy_frame, &processed_frame));
+  ASSERT_TRUE(processed_frame != NULL);
+  EXPECT_GT(I420PSNR(&video_frame_, processed_frame),
+            I420PSNR(&video_frame_, &noisy_frame));
+}
+
+namespace {
+
+// Decodes the encoded frames right away, and sums their sizes and PSNRs.
+class EncodedFrameEvaluator : public EncodedImageCallback,
+                              public DecodedImageCallback {
+ public:
+  EncodedFrameEvaluator()
+      : decoder_(VP8Decoder::Create()),
+        source_frame_(NULL),
+        total_bytes_(0),
+        total_psnr_(0.0),
+        num_frames_(0) {
+    decoder_->RegisterDecodeCompleteCallback(this);
+  }
+
+  int32_t InitDecode(const VideoCodec* codec_settings) {
+    return decoder_->InitDecode(codec_settings, 1);
+  }
+
+  void set_source_frame(const VideoFrame* source_frame) {
+    source_frame_ = source_frame;
+  }
+
+  int32_t Encoded(const EncodedImage& encoded_image,
+                  const CodecSpecificInfo* codec_specific_info,
+                  const RTPFragmentationHeader* fragmentation) override {
+    total_bytes_ += encoded_image._length;
+    return decoder_->Decode(encoded_image, false, NULL);
+  }
+
+  int32_t Decoded(VideoFrame& decoded_image) override {
+    total_psnr_ += I420PSNR(source_frame_, &decoded_image);
+    ++num_frames_;
+    return 0;
+  }
+
+  size_t total_bytes() const { return total_bytes_; }
+  double average_psnr() const { return total_psnr_ / num_frames_; }
+  int num_frames() const { return num_frames_; }
+
+ private:
+  rtc::scoped_ptr<VideoDecoder> decoder_;
+  const VideoFrame* source_frame_;
+  size_t total_bytes_;
+  double total_psnr_;
+  int num_frames_;
+};
+
+}  // namespace
+
+// Encodes foremanColorEnhanced_cif_short with VP8 with and without denoising,
+// and prints the preprocessing time per frame, the bitrate and the PSNR of the
+// decoded frames against the source. The bitrate is set too low for the clip,
+// so that every frame is encoded at the maximum QP and the bitrate shows how
+// hard the frames are to encode.
+TEST_F(VideoProcessingModuleTest, DISABLED_DenoisingBenchmark) {
+  const int kFrameRate = 30;
+  const int kQp = 32;
+  fclose(source_file_);
+  const std::string video_file =
+      webrtc::test::ResourcePath("foremanColorEnhanced_cif_short", "yuv");
+  source_file_ = fopen(video_file.c_str(), "rb");
+  ASSERT_TRUE(source_file_ != NULL) <<
+      "Cannot read source file: " + video_file + "\n";
+
+  VideoCodec codec_settings;
+  memset(&codec_settings, 0, sizeof(codec_settings));
+  codec_settings.codecType = kVideoCodecVP8;
+  codec_settings.width = width_;
+  codec_settings.height = height_;
+  codec_settings.maxFramerate = kFrameRate;
+  codec_settings.startBitrate = 50;
+  codec_settings.maxBitrate = 50;
+  codec_settings.qpMax = kQp;
+  codec_settings.codecSpecific.VP8.complexity = kComplexityNormal;
+  codec_settings.codecSpecific.VP8.numberOfTemporalLayers = 1;
+  codec_settings.codecSpecific.VP8.keyFrameInterval = 3000;
+  // Only compare with the denoising of the preprocessor.
+  codec_settings.codecSpecific.VP8.denoisingOn = false;
+  codec_settings.codecSpecific.VP8.frameDroppingOn = false;
+
+  printf("\nDenoising  Run time [us / frame]  Bitrate [kbps]  PSNR [dB]\n");
+  const bool kDenoising[] = {false, true};
+  for (bool denoising : kDenoising) {
+    rewind(source_file_);
+    vpm_->Reset();
+    vpm_->EnableTemporalDecimation(false);
+    vpm_->EnableDenoising(denoising);
+    ASSERT_EQ(VPM_OK, vpm_->SetTargetResolution(width_, height_, kFrameRate));
+
+    rtc::scoped_ptr<VideoEncoder> encoder(VP8Encoder::Create());
+    EncodedFrameEvaluator evaluator;
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK, evaluator.InitDecode(&codec_settings));
+    encoder->RegisterEncodeCompleteCallback(&evaluator);
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder->InitEncode(&codec_settings, 1, 1440));
+
+    rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[frame_length_]);
+    TickInterval acc_ticks;
+    int num_frames = 0;
+    uint32_t timestamp = 0;
+    while (fread(video_buffer.get(), 1, frame_length_, source_file_) ==
+           frame_length_) {
+      EXPECT_EQ(0, ConvertToI420(kI420, video_buffer.get(), 0, 0, width_,
+                                 height_, 0, kVideoRotation_0, &video_frame_));
+      video_frame_.set_timestamp(timestamp);
+      timestamp += 90000 / kFrameRate;
+
+      VideoFrame* processed_frame = NULL;
+      const TickTime t0 = TickTime::Now();
+      ASSERT_EQ(VPM_OK, vpm_->PreprocessFrame(video_frame_, &processed_frame));
+      acc_ticks += TickTime::Now() - t0;
+      ++num_frames;
+
+      evaluator.set_source_frame(&video_frame_);
+      ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+                encoder->Encode(processed_frame ? *processed_frame
+                                                : video_frame_,
+                                NULL, NULL));
+    }
+    ASSERT_NE(0, feof(source_file_)) << "Error reading source file";
+    ASSERT_GT(num_frames, 0);
+    ASSERT_EQ(num_frames, evaluator.num_frames());
+
+    printf("%-9s  %22d  %14d  %9.2f\n", denoising ? "on" : "off",
+           static_cast<int>(acc_ticks.Microseconds() / num_frames),
+           static_cast<int>(evaluator.total_bytes() * 8 * kFrameRate /
+                            num_frames / 1000),
+           evaluator.average_psnr());
+  }
+}
+
+}  // namespace webrtc
@@ -20,7 +20,11 @@ extern "C" {
 // List of features in x86.
 typedef enum {
   kSSE2,
-  kSSE3
+  kSSE3,
+  // AVX2 and FMA are only reported if the OS also saves the YMM registers on
+  // context switches.
+  kAVX2,
+  kFMA
 } CPUFeature;
 
 // List of features in ARM.
@@ -36,6 +36,14 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
     : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
     : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+    "mov %%ebx, %%edi\n"
+    "cpuid\n"
+    "xchg %%edi, %%ebx\n"
+    : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(info_type), "c"(sub_type));
+}
 #else
 static inline void __cpuid(int cpu_info[4], int info_type) {
   __asm__ volatile(
@@ -43,8 +51,26 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
     : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
     : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+    "cpuid\n"
+    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(info_type), "c"(sub_type));
+}
 #endif
 #endif  // _MSC_VER
+
+// Returns the XCR0 register, which tells which register state the OS saves.
+// Only valid if cpuid reports OSXSAVE.
+static inline uint64_t ReadXCR0() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
@@ -58,6 +84,25 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kAVX2 || feature == kFMA) {
+    // The OS must support XSAVE and have enabled saving of the XMM and YMM
+    // state, otherwise the upper register halves are lost on context switches.
+    const int kOsXsave = 0x08000000;
+    const int kAvx = 0x10000000;
+    if ((cpu_info[2] & (kOsXsave | kAvx)) != (kOsXsave | kAvx) ||
+        (ReadXCR0() & 0x6) != 0x6) {
+      return 0;
+    }
+    if (feature == kFMA) {
+      return 0 != (cpu_info[2] & 0x00001000);
+    }
+    __cpuid(cpu_info, 0);
+    if (cpu_info[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else
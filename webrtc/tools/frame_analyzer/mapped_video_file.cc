@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/tools/frame_analyzer/mapped_video_file.h"
+
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <limits>
+
+#include "webrtc/tools/frame_analyzer/video_quality_analysis.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+const char kY4mFileSignature[] = "YUV4MPEG2";
+const char kY4mFrameSignature[] = "FRAME";
+
+// Returns the offset of the first byte after the next '\n' at or after
+// |offset|, or 0 if there is none.
+size_t SkipLine(const uint8_t* data, size_t size, size_t offset) {
+  const void* end_of_line = memchr(data + offset, '\n', size - offset);
+  return end_of_line
+             ? static_cast<const uint8_t*>(end_of_line) - data + 1
+             : 0;
+}
+
+#if defined(WEBRTC_POSIX)
+const uint8_t* MapFile(const std::string& file_name, size_t* size) {
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat file_stat;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 &&
+      static_cast<uint64_t>(file_stat.st_size) <=
+          std::numeric_limits<size_t>::max()) {
+    data = mmap(NULL, static_cast<size_t>(file_stat.st_size), PROT_READ,
+                MAP_PRIVATE, fd, 0);
+  }
+  // The mapping stays valid after closing the file.
+  close(fd);
+  if (data == MAP_FAILED)
+    return NULL;
+  *size = static_cast<size_t>(file_stat.st_size);
+  // The frames are mostly read in order, if by several threads.
+  madvise(data, *size, MADV_SEQUENTIAL);
+  return static_cast<const uint8_t*>(data);
+}
+#endif
+
+const uint8_t* ReadFile(const std::string& file_name, size_t* size) {
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == NULL)
+    return NULL;
+  uint8_t* data = NULL;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    const long file_size = ftell(file);
+    if (file_size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+      *size = static_cast<size_t>(file_size);
+      data = new uint8_t[*size];
+      if (fread(data, 1, *size, file) != *size) {
+        delete[] data;
+        data = NULL;
+      }
+    }
+  }
+  fclose(file);
+  return data;
+}
+
+}  // namespace
+
+MappedVideoFile* MappedVideoFile::Open(const std::string& file_name,
+                                       bool y4m,
+                                       int width,
+                                       int height) {
+  if (width <= 0 || height <= 0)
+    return NULL;
+  size_t size = 0;
+  bool mapped = false;
+  const uint8_t* data = NULL;
+#if defined(WEBRTC_POSIX)
+  data = MapFile(file_name, &size);
+  mapped = data != NULL;
+#endif
+  if (!data)
+    data = ReadFile(file_name, &size);
+  if (!data) {
+    fprintf(stderr, "Couldn't open input file for reading: %s\n",
+            file_name.c_str());
+    return NULL;
+  }
+  MappedVideoFile* file = new MappedVideoFile(data, size, mapped);
+  if (!file->FindFrames(y4m, GetI420FrameSize(width, height))) {
+    fprintf(stderr, "Corrupted Y4M file: %s\n", file_name.c_str());
+    delete file;
+    return NULL;
+  }
+  return file;
+}
+
+MappedVideoFile::MappedVideoFile(const uint8_t* data, size_t size, bool mapped)
+    : data_(data), size_(size), mapped_(mapped) {
+}
+
+MappedVideoFile::~MappedVideoFile() {
+#if defined(WEBRTC_POSIX)
+  if (mapped_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    return;
+  }
+#endif
+  delete[] data_;
+}
+
+const uint8_t* MappedVideoFile::frame(int frame_number) const {
+  assert(frame_number >= 0 && frame_number < num_frames());
+  return data_ + frame_offsets_[frame_number];
+}
+
+bool MappedVideoFile::FindFrames(bool y4m, size_t frame_size) {
+  if (!y4m) {
+    for (size_t offset = 0; size_ - offset >= frame_size;
+         offset += frame_size) {
+      frame_offsets_.push_back(offset);
+    }
+    return true;
+  }
+
+  // A Y4M file has a file header, e.g. "YUV4MPEG2 C420 W640 H360 Ip F30:1\n",
+  // and every frame a frame header, "FRAME" followed by optional parameters
+  // and a new line.
+  const size_t signature_length = sizeof(kY4mFileSignature) - 1;
+  if (size_ < signature_length ||
+      memcmp(data_, kY4mFileSignature, signature_length) != 0) {
+    return false;
+  }
+  size_t offset = SkipLine(data_, size_, 0);
+  if (offset == 0)
+    return false;
+  const size_t frame_signature_length = sizeof(kY4mFrameSignature) - 1;
+  while (size_ - offset >= frame_signature_length &&
+         memcmp(data_ + offset, kY4mFrameSignature, frame_signature_length) ==
+             0) {
+    const size_t frame_offset = SkipLine(data_, size_, offset);
+    if (frame_offset == 0 || size_ - frame_offset < frame_size)
+      break;
+    frame_offsets_.push_back(frame_offset);
+    offset = frame_offset + frame_size;
+  }
+  return true;
+}
+
+}  // namespace test
+}  // namespace webrtc
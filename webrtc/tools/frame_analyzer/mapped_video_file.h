@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_TOOLS_FRAME_ANALYZER_MAPPED_VIDEO_FILE_H_
+#define WEBRTC_TOOLS_FRAME_ANALYZER_MAPPED_VIDEO_FILE_H_
+
+#include <string>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace test {
+
+// Gives random access to the frames of a raw I420 or a Y4M file. The file is
+// memory mapped where supported, and read into memory otherwise, so frames can
+// be read from any number of threads without copying them.
+class MappedVideoFile {
+ public:
+  // Returns NULL if the file can't be read, or if |y4m| is true and the file
+  // doesn't start with a Y4M header. A truncated last frame is ignored.
+  static MappedVideoFile* Open(const std::string& file_name,
+                               bool y4m,
+                               int width,
+                               int height);
+  ~MappedVideoFile();
+
+  int num_frames() const { return static_cast<int>(frame_offsets_.size()); }
+
+  // Returns the I420 data of the frame at position |frame_number|, which must
+  // be less than num_frames().
+  const uint8_t* frame(int frame_number) const;
+
+ private:
+  MappedVideoFile(const uint8_t* data, size_t size, bool mapped);
+  bool FindFrames(bool y4m, size_t frame_size);
+
+  const uint8_t* const data_;
+  const size_t size_;
+  const bool mapped_;
+  std::vector<size_t> frame_offsets_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedVideoFile);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // WEBRTC_TOOLS_FRAME_ANALYZER_MAPPED_VIDEO_FILE_H_
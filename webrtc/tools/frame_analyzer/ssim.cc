@@ -0,0 +1,208 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/tools/frame_analyzer/ssim.h"
+
+#include <float.h>
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/tools/frame_analyzer/ssim_sse2.h"
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+#include "webrtc/tools/frame_analyzer/ssim_neon.h"
+#endif
+
+namespace webrtc {
+namespace test {
+namespace {
+
+// The constants of libyuv's Ssim8x8_C(), (64 * 0.01 * 255)^2 and
+// (64 * 0.03 * 255)^2.
+const int64_t kC1 = 26634;
+const int64_t kC2 = 239708;
+const int64_t kWindowSize = 64;
+
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+bool HasSse2() {
+#if defined(__SSE2__)
+  return true;
+#else
+  return WebRtc_GetCPUInfo(kSSE2) != 0;
+#endif
+}
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+bool HasNeon() {
+#if defined(WEBRTC_HAS_NEON)
+  return true;
+#else
+  return (WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0;
+#endif
+}
+#endif
+
+void SsimBlockSums(const uint8_t* a,
+                   int stride_a,
+                   const uint8_t* b,
+                   int stride_b,
+                   int num_blocks,
+                   int32_t* const* sums) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (HasSse2()) {
+    SsimBlockSums_SSE2(a, stride_a, b, stride_b, num_blocks, sums);
+    return;
+  }
+#elif defined(WEBRTC_HAS_NEON) || defined(WEBRTC_DETECT_NEON)
+  if (HasNeon()) {
+    SsimBlockSums_NEON(a, stride_a, b, stride_b, num_blocks, sums);
+    return;
+  }
+#endif
+  SsimBlockSums_C(a, stride_a, b, stride_b, num_blocks, sums);
+}
+
+// Evaluates the SSIM of an 8x8 window from its sums with the same integer
+// arithmetic as libyuv.
+double WindowSsim(int64_t sum_a,
+                  int64_t sum_b,
+                  int64_t sum_sq_a,
+                  int64_t sum_sq_b,
+                  int64_t sum_axb) {
+  const int64_t c1 = (kC1 * kWindowSize * kWindowSize) >> 12;
+  const int64_t c2 = (kC2 * kWindowSize * kWindowSize) >> 12;
+  const int64_t sum_a_x_sum_b = sum_a * sum_b;
+  const int64_t ssim_n =
+      (2 * sum_a_x_sum_b + c1) *
+      (2 * kWindowSize * sum_axb - 2 * sum_a_x_sum_b + c2);
+  const int64_t sum_a_sq = sum_a * sum_a;
+  const int64_t sum_b_sq = sum_b * sum_b;
+  const int64_t ssim_d =
+      (sum_a_sq + sum_b_sq + c1) *
+      (kWindowSize * sum_sq_a - sum_a_sq + kWindowSize * sum_sq_b - sum_b_sq +
+       c2);
+  if (ssim_d == 0)
+    return DBL_MAX;
+  return ssim_n * 1.0 / ssim_d;
+}
+
+// The sums of one row of 4x4 blocks, one vector per SsimSum.
+class BlockRow {
+ public:
+  explicit BlockRow(int num_blocks) {
+    for (int k = 0; k < kNumSsimSums; ++k) {
+      sums_[k].resize(num_blocks);
+      pointers_[k] = &sums_[k][0];
+    }
+  }
+
+  int32_t* const* sums() { return pointers_; }
+  int32_t sum(int k, int block) const { return sums_[k][block]; }
+
+ private:
+  std::vector<int32_t> sums_[kNumSsimSums];
+  int32_t* pointers_[kNumSsimSums];
+
+  DISALLOW_COPY_AND_ASSIGN(BlockRow);
+};
+
+}  // namespace
+
+void SsimBlockSums_C(const uint8_t* a,
+                     int stride_a,
+                     const uint8_t* b,
+                     int stride_b,
+                     int num_blocks,
+                     int32_t* const* sums) {
+  for (int m = 0; m < num_blocks; ++m) {
+    int32_t block_sums[kNumSsimSums] = {0};
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 4 * m; j < 4 * m + 4; ++j) {
+        const int32_t pixel_a = a[i * stride_a + j];
+        const int32_t pixel_b = b[i * stride_b + j];
+        block_sums[kSumA] += pixel_a;
+        block_sums[kSumB] += pixel_b;
+        block_sums[kSumSqA] += pixel_a * pixel_a;
+        block_sums[kSumSqB] += pixel_b * pixel_b;
+        block_sums[kSumAxB] += pixel_a * pixel_b;
+      }
+    }
+    for (int k = 0; k < kNumSsimSums; ++k)
+      sums[k][m] = block_sums[k];
+  }
+}
+
+double CalculatePlaneSsim(const uint8_t* a,
+                          int stride_a,
+                          const uint8_t* b,
+                          int stride_b,
+                          int width,
+                          int height) {
+  // libyuv places the windows at the 4x4 grid points strictly less than 8
+  // pixels away from the right and bottom edges.
+  const int num_window_rows = height > 8 ? (height - 8 + 3) / 4 : 0;
+  const int num_window_columns = width > 8 ? (width - 8 + 3) / 4 : 0;
+  const int num_blocks = num_window_columns + 1;
+
+  double ssim_total = 0;
+  int samples = 0;
+  if (num_window_rows > 0 && num_window_columns > 0) {
+    BlockRow even_row(num_blocks);
+    BlockRow odd_row(num_blocks);
+    BlockRow* const rows[] = {&even_row, &odd_row};
+    SsimBlockSums(a, stride_a, b, stride_b, num_blocks, even_row.sums());
+    for (int r = 0; r < num_window_rows; ++r) {
+      const BlockRow& top = *rows[r % 2];
+      BlockRow& bottom = *rows[(r + 1) % 2];
+      SsimBlockSums(a + 4 * (r + 1) * stride_a, stride_a,
+                    b + 4 * (r + 1) * stride_b, stride_b, num_blocks,
+                    bottom.sums());
+      // Accumulate in the same order as libyuv, to get the same rounding.
+      for (int m = 0; m < num_window_columns; ++m) {
+        int64_t window_sums[kNumSsimSums];
+        for (int k = 0; k < kNumSsimSums; ++k) {
+          window_sums[k] = top.sum(k, m) + top.sum(k, m + 1) +
+                           bottom.sum(k, m) + bottom.sum(k, m + 1);
+        }
+        ssim_total += WindowSsim(window_sums[kSumA], window_sums[kSumB],
+                                 window_sums[kSumSqA], window_sums[kSumSqB],
+                                 window_sums[kSumAxB]);
+        ++samples;
+      }
+    }
+  }
+  // Like libyuv, planes too small for a single window give NaN.
+  return ssim_total / samples;
+}
+
+double CalculateI420Ssim(const uint8_t* ref_frame,
+                         const uint8_t* test_frame,
+                         int width,
+                         int height) {
+  const int half_width = (width + 1) >> 1;
+  const int half_height = (height + 1) >> 1;
+  const int y_size = width * height;
+  const int uv_size = half_width * half_height;
+  const double ssim_y =
+      CalculatePlaneSsim(ref_frame, width, test_frame, width, width, height);
+  const double ssim_u =
+      CalculatePlaneSsim(ref_frame + y_size, half_width, test_frame + y_size,
+                         half_width, half_width, half_height);
+  const double ssim_v = CalculatePlaneSsim(
+      ref_frame + y_size + uv_size, half_width, test_frame + y_size + uv_size,
+      half_width, half_width, half_height);
+  return ssim_y * 0.8 + 0.1 * (ssim_u + ssim_v);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_H_
+#define WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace test {
+
+// The sums over a 4x4 block of two planes |a| and |b| from which the SSIM of
+// the 8x8 windows covering the block is computed.
+enum SsimSum { kSumA, kSumB, kSumSqA, kSumSqB, kSumAxB, kNumSsimSums };
+
+// Computes the sums of |num_blocks| consecutive 4x4 blocks, starting at the
+// top left corner of |a| and |b|. sums[k][m] is sum |k| of block |m|.
+void SsimBlockSums_C(const uint8_t* a,
+                     int stride_a,
+                     const uint8_t* b,
+                     int stride_b,
+                     int num_blocks,
+                     int32_t* const* sums);
+
+// Returns the mean SSIM of the 8x8 windows starting on every 4x4 grid point,
+// bitexact with libyuv::CalcFrameSsim(). Each pixel is part of four windows,
+// so the sums are computed once per 4x4 block with SIMD and combined per
+// window.
+double CalculatePlaneSsim(const uint8_t* a,
+                          int stride_a,
+                          const uint8_t* b,
+                          int stride_b,
+                          int width,
+                          int height);
+
+// Returns the SSIM of an I420 frame, weighting the Y plane by 0.8 and the U
+// and V planes by 0.1, bitexact with libyuv::I420Ssim().
+double CalculateI420Ssim(const uint8_t* ref_frame,
+                         const uint8_t* test_frame,
+                         int width,
+                         int height);
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_H_
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/tools/frame_analyzer/ssim_neon.h"
+
+#include <arm_neon.h>
+
+#include "webrtc/tools/frame_analyzer/ssim.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+// Adds the neighbouring lanes of |lo| and |hi|, which hold the sums of pairs
+// of pixels, giving the sums of four blocks.
+inline int32x4_t AddPairs(uint32x4_t lo, uint32x4_t hi) {
+  return vreinterpretq_s32_u32(
+      vcombine_u32(vpadd_u32(vget_low_u32(lo), vget_high_u32(lo)),
+                   vpadd_u32(vget_low_u32(hi), vget_high_u32(hi))));
+}
+
+}  // namespace
+
+void SsimBlockSums_NEON(const uint8_t* a,
+                        int stride_a,
+                        const uint8_t* b,
+                        int stride_b,
+                        int num_blocks,
+                        int32_t* const* sums) {
+  int m = 0;
+  // Four blocks at a time. The products of two pixels fit in 16 bits and are
+  // summed in pairs into 32 bits by vpadalq_u16().
+  for (; m + 4 <= num_blocks; m += 4) {
+    uint16x8_t sum_a = vdupq_n_u16(0);
+    uint16x8_t sum_b = vdupq_n_u16(0);
+    uint32x4_t sum_sq_a_lo = vdupq_n_u32(0);
+    uint32x4_t sum_sq_a_hi = vdupq_n_u32(0);
+    uint32x4_t sum_sq_b_lo = vdupq_n_u32(0);
+    uint32x4_t sum_sq_b_hi = vdupq_n_u32(0);
+    uint32x4_t sum_axb_lo = vdupq_n_u32(0);
+    uint32x4_t sum_axb_hi = vdupq_n_u32(0);
+    for (int i = 0; i < 4; ++i) {
+      const uint8x16_t va = vld1q_u8(&a[i * stride_a + 4 * m]);
+      const uint8x16_t vb = vld1q_u8(&b[i * stride_b + 4 * m]);
+      const uint8x8_t a_lo = vget_low_u8(va);
+      const uint8x8_t a_hi = vget_high_u8(va);
+      const uint8x8_t b_lo = vget_low_u8(vb);
+      const uint8x8_t b_hi = vget_high_u8(vb);
+      sum_a = vpadalq_u8(sum_a, va);
+      sum_b = vpadalq_u8(sum_b, vb);
+      sum_sq_a_lo = vpadalq_u16(sum_sq_a_lo, vmull_u8(a_lo, a_lo));
+      sum_sq_a_hi = vpadalq_u16(sum_sq_a_hi, vmull_u8(a_hi, a_hi));
+      sum_sq_b_lo = vpadalq_u16(sum_sq_b_lo, vmull_u8(b_lo, b_lo));
+      sum_sq_b_hi = vpadalq_u16(sum_sq_b_hi, vmull_u8(b_hi, b_hi));
+      sum_axb_lo = vpadalq_u16(sum_axb_lo, vmull_u8(a_lo, b_lo));
+      sum_axb_hi = vpadalq_u16(sum_axb_hi, vmull_u8(a_hi, b_hi));
+    }
+    vst1q_s32(&sums[kSumA][m], vreinterpretq_s32_u32(vpaddlq_u16(sum_a)));
+    vst1q_s32(&sums[kSumB][m], vreinterpretq_s32_u32(vpaddlq_u16(sum_b)));
+    vst1q_s32(&sums[kSumSqA][m], AddPairs(sum_sq_a_lo, sum_sq_a_hi));
+    vst1q_s32(&sums[kSumSqB][m], AddPairs(sum_sq_b_lo, sum_sq_b_hi));
+    vst1q_s32(&sums[kSumAxB][m], AddPairs(sum_axb_lo, sum_axb_hi));
+  }
+  if (m < num_blocks) {
+    int32_t* remaining_sums[kNumSsimSums];
+    for (int k = 0; k < kNumSsimSums; ++k)
+      remaining_sums[k] = &sums[k][m];
+    SsimBlockSums_C(&a[4 * m], stride_a, &b[4 * m], stride_b, num_blocks - m,
+                    remaining_sums);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
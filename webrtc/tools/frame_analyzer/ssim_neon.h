@@ -0,0 +1,30 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_NEON_H_
+#define WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_NEON_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace test {
+
+// NEON version of SsimBlockSums_C().
+void SsimBlockSums_NEON(const uint8_t* a,
+                        int stride_a,
+                        const uint8_t* b,
+                        int stride_b,
+                        int num_blocks,
+                        int32_t* const* sums);
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // WEBRTC_TOOLS_FRAME_ANALYZER_SSIM_NEON_H_
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/tools/frame_analyzer/ssim_sse2.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/tools/frame_analyzer/ssim.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+// Adds the neighbouring lanes of |lo| and |hi|, which hold the sums of pairs
+// of pixels, giving the sums of four blocks.
+inline __m128i AddPairs(__m128i lo, __m128i hi) {
+  const __m128 lo_ps = _mm_castsi128_ps(lo);
+  const __m128 hi_ps = _mm_castsi128_ps(hi);
+  return _mm_add_epi32(
+      _mm_castps_si128(_mm_shuffle_ps(lo_ps, hi_ps, _MM_SHUFFLE(2, 0, 2, 0))),
+      _mm_castps_si128(_mm_shuffle_ps(lo_ps, hi_ps, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+inline void Store(__m128i v, int32_t* dest) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), v);
+}
+
+}  // namespace
+
+void SsimBlockSums_SSE2(const uint8_t* a,
+                        int stride_a,
+                        const uint8_t* b,
+                        int stride_b,
+                        int num_blocks,
+                        int32_t* const* sums) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  int m = 0;
+  // Four blocks at a time. The sums of the pixels fit in 16 bits and the
+  // products are summed in pairs into 32 bits by _mm_madd_epi16().
+  for (; m + 4 <= num_blocks; m += 4) {
+    __m128i sum_a_lo = zero;
+    __m128i sum_a_hi = zero;
+    __m128i sum_b_lo = zero;
+    __m128i sum_b_hi = zero;
+    __m128i sum_sq_a_lo = zero;
+    __m128i sum_sq_a_hi = zero;
+    __m128i sum_sq_b_lo = zero;
+    __m128i sum_sq_b_hi = zero;
+    __m128i sum_axb_lo = zero;
+    __m128i sum_axb_hi = zero;
+    for (int i = 0; i < 4; ++i) {
+      const __m128i va = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(&a[i * stride_a + 4 * m]));
+      const __m128i vb = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(&b[i * stride_b + 4 * m]));
+      const __m128i a_lo = _mm_unpacklo_epi8(va, zero);
+      const __m128i a_hi = _mm_unpackhi_epi8(va, zero);
+      const __m128i b_lo = _mm_unpacklo_epi8(vb, zero);
+      const __m128i b_hi = _mm_unpackhi_epi8(vb, zero);
+      sum_a_lo = _mm_add_epi16(sum_a_lo, a_lo);
+      sum_a_hi = _mm_add_epi16(sum_a_hi, a_hi);
+      sum_b_lo = _mm_add_epi16(sum_b_lo, b_lo);
+      sum_b_hi = _mm_add_epi16(sum_b_hi, b_hi);
+      sum_sq_a_lo = _mm_add_epi32(sum_sq_a_lo, _mm_madd_epi16(a_lo, a_lo));
+      sum_sq_a_hi = _mm_add_epi32(sum_sq_a_hi, _mm_madd_epi16(a_hi, a_hi));
+      sum_sq_b_lo = _mm_add_epi32(sum_sq_b_lo, _mm_madd_epi16(b_lo, b_lo));
+      sum_sq_b_hi = _mm_add_epi32(sum_sq_b_hi, _mm_madd_epi16(b_hi, b_hi));
+      sum_axb_lo = _mm_add_epi32(sum_axb_lo, _mm_madd_epi16(a_lo, b_lo));
+      sum_axb_hi = _mm_add_epi32(sum_axb_hi, _mm_madd_epi16(a_hi, b_hi));
+    }
+    Store(AddPairs(_mm_madd_epi16(sum_a_lo, ones),
+                   _mm_madd_epi16(sum_a_hi, ones)),
+          &sums[kSumA][m]);
+    Store(AddPairs(_mm_madd_epi16(sum_b_lo, ones),
+                   _mm_madd_epi16(sum_b_hi, ones)),
+          &sums[kSumB][m]);
+    Store(AddPairs(sum_sq_a_lo, sum_sq_a_hi), &sums[kSumSqA][m]);
+    Store(AddPairs(sum_sq_b_lo, sum_sq_b_hi), &sums[kSumSqB][m]);
+    Store(AddPairs(sum_axb_lo, sum_axb_hi), &sums[kSumAxB][m]);
+  }
+  if (m < num_blocks) {
+    int32_t* remaining_sums[kNumSsimSums];
+    for (int k = 0; k < kNumSsimSums; ++k)
+      remaining_sums[k] = &sums[k][m];
+    SsimBlockSums_C(&a[4 * m], stride_a, &b[4 * m], stride_b, num_blocks - m,
+                    remaining_sums);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
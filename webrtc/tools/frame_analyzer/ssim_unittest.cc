@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/tools/frame_analyzer/ssim.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "libyuv/compare.h"  // NOLINT
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/tools/frame_analyzer/video_quality_analysis.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+// Fills |frame| with a gradient plus noise, so that every window has a
+// different SSIM.
+void GenerateFrame(uint32_t seed, std::vector<uint8_t>* frame) {
+  for (size_t i = 0; i < frame->size(); ++i) {
+    seed = seed * 1664525 + 1013904223;
+    (*frame)[i] = static_cast<uint8_t>((i / 7 + (seed >> 26)) & 0xff);
+  }
+}
+
+// Adds noise of up to +-|amplitude| to |frame|, saturating.
+void AddNoise(uint32_t seed, int amplitude, std::vector<uint8_t>* frame) {
+  for (size_t i = 0; i < frame->size(); ++i) {
+    seed = seed * 1664525 + 1013904223;
+    const int noise = static_cast<int>(seed >> 16) % (2 * amplitude + 1) -
+                      amplitude;
+    const int value = (*frame)[i] + noise;
+    (*frame)[i] =
+        static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+  }
+}
+
+}  // namespace
+
+TEST(SsimTest, BlockSumsMatchReference) {
+  const int kStride = 83;
+  const int kNumBlocks = kStride / 4;
+  std::vector<uint8_t> a(4 * kStride);
+  std::vector<uint8_t> b(4 * kStride);
+  GenerateFrame(1, &a);
+  GenerateFrame(2, &b);
+  // Saturated pixels give the largest sums.
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 16; ++j) {
+      a[i * kStride + j] = 255;
+      b[i * kStride + j] = 255;
+    }
+  }
+  std::vector<int32_t> sums[kNumSsimSums];
+  int32_t* sum_pointers[kNumSsimSums];
+  for (int k = 0; k < kNumSsimSums; ++k) {
+    sums[k].resize(kNumBlocks);
+    sum_pointers[k] = &sums[k][0];
+  }
+  SsimBlockSums_C(&a[0], kStride, &b[0], kStride, kNumBlocks, sum_pointers);
+  for (int m = 0; m < kNumBlocks; ++m) {
+    int32_t expected[kNumSsimSums] = {0};
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 4 * m; j < 4 * m + 4; ++j) {
+        const int32_t pixel_a = a[i * kStride + j];
+        const int32_t pixel_b = b[i * kStride + j];
+        expected[kSumA] += pixel_a;
+        expected[kSumB] += pixel_b;
+        expected[kSumSqA] += pixel_a * pixel_a;
+        expected[kSumSqB] += pixel_b * pixel_b;
+        expected[kSumAxB] += pixel_a * pixel_b;
+      }
+    }
+    for (int k = 0; k < kNumSsimSums; ++k)
+      EXPECT_EQ(expected[k], sums[k][m]) << "block " << m << ", sum " << k;
+  }
+  EXPECT_EQ(16 * 255, sums[kSumA][0]);
+  EXPECT_EQ(16 * 255 * 255, sums[kSumAxB][0]);
+}
+
+TEST(SsimTest, PlaneSsimIsBitexactWithLibyuv) {
+  // Sizes with and without a partial last window, and with a number of blocks
+  // which isn't a multiple of the SIMD width.
+  const struct {
+    int width;
+    int height;
+  } kSizes[] = {{9, 9}, {16, 16}, {17, 13}, {64, 48}, {75, 41}, {176, 144},
+                {352, 288}, {333, 201}};
+  for (const auto& size : kSizes) {
+    SCOPED_TRACE(testing::Message() << size.width << "x" << size.height);
+    const int stride = size.width + 5;
+    std::vector<uint8_t> a(stride * size.height);
+    GenerateFrame(size.width, &a);
+    for (int amplitude : {0, 2, 30, 255}) {
+      std::vector<uint8_t> b = a;
+      AddNoise(size.height + amplitude, amplitude, &b);
+      const double expected = libyuv::CalcFrameSsim(
+          &a[0], stride, &b[0], stride, size.width, size.height);
+      EXPECT_EQ(expected, CalculatePlaneSsim(&a[0], stride, &b[0], stride,
+                                             size.width, size.height))
+          << "amplitude " << amplitude;
+    }
+  }
+}
+
+TEST(SsimTest, PlaneSsimOfFlatPlanes) {
+  std::vector<uint8_t> black(32 * 32, 0);
+  std::vector<uint8_t> white(32 * 32, 255);
+  EXPECT_EQ(1.0, CalculatePlaneSsim(&white[0], 32, &white[0], 32, 32, 32));
+  EXPECT_EQ(libyuv::CalcFrameSsim(&black[0], 32, &white[0], 32, 32, 32),
+            CalculatePlaneSsim(&black[0], 32, &white[0], 32, 32, 32));
+  EXPECT_LT(CalculatePlaneSsim(&black[0], 32, &white[0], 32, 32, 32), 0.01);
+}
+
+TEST(SsimTest, I420SsimIsBitexactWithLibyuv) {
+  const int kWidth = 354;
+  const int kHeight = 290;
+  std::vector<uint8_t> reference(GetI420FrameSize(kWidth, kHeight));
+  GenerateFrame(3, &reference);
+  std::vector<uint8_t> test = reference;
+  AddNoise(4, 10, &test);
+  const int half_width = (kWidth + 1) / 2;
+  const int half_height = (kHeight + 1) / 2;
+  const int u_offset = kWidth * kHeight;
+  const int v_offset = u_offset + half_width * half_height;
+  EXPECT_EQ(libyuv::I420Ssim(&reference[0], kWidth, &reference[u_offset],
+                             half_width, &reference[v_offset], half_width,
+                             &test[0], kWidth, &test[u_offset], half_width,
+                             &test[v_offset], half_width, kWidth, kHeight),
+            CalculateI420Ssim(&reference[0], &test[0], kWidth, kHeight));
+}
+
+// Compares the speed of CalculateI420Ssim() and libyuv::I420Ssim() on 1080p
+// frames.
+TEST(SsimTest, DISABLED_Benchmark) {
+  const int kWidth = 1920;
+  const int kHeight = 1080;
+  const int kNumFrames = 20;
+  std::vector<uint8_t> reference(GetI420FrameSize(kWidth, kHeight));
+  GenerateFrame(5, &reference);
+  std::vector<uint8_t> test = reference;
+  AddNoise(6, 10, &test);
+  const int half_width = kWidth / 2;
+  const uint8_t* reference_u = &reference[kWidth * kHeight];
+  const uint8_t* reference_v = reference_u + half_width * kHeight / 2;
+  const uint8_t* test_u = &test[kWidth * kHeight];
+  const uint8_t* test_v = test_u + half_width * kHeight / 2;
+
+  double libyuv_ssim = 0.0;
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kNumFrames; ++i) {
+    libyuv_ssim += libyuv::I420Ssim(
+        &reference[0], kWidth, reference_u, half_width, reference_v,
+        half_width, &test[0], kWidth, test_u, half_width, test_v, half_width,
+        kWidth, kHeight);
+  }
+  const int64_t libyuv_us = (TickTime::Now() - start).Microseconds();
+
+  double ssim = 0.0;
+  start = TickTime::Now();
+  for (int i = 0; i < kNumFrames; ++i)
+    ssim += CalculateI420Ssim(&reference[0], &test[0], kWidth, kHeight);
+  const int64_t us = (TickTime::Now() - start).Microseconds();
+
+  EXPECT_EQ(libyuv_ssim, ssim);
+  printf("libyuv::I420Ssim: %.2f ms per frame\n",
+         libyuv_us / 1000.0 / kNumFrames);
+  printf("CalculateI420Ssim: %.2f ms per frame (%.1fx)\n",
+         us / 1000.0 / kNumFrames, static_cast<double>(libyuv_us) / us);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -14,8 +14,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 
+#include "webrtc/base/atomicops.h"
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/tools/frame_analyzer/mapped_video_file.h"
+#include "webrtc/tools/frame_analyzer/ssim.h"
+
 #define STATS_LINE_LENGTH 32
 #define Y4M_FILE_HEADER_MAX_SIZE 200
 #define Y4M_FRAME_DELIMITER "FRAME"
@@ -26,6 +36,72 @@ namespace test {
 
 using std::string;
 
+namespace {
+
+// Analyzes the frames of two files on any number of threads, each taking the
+// next frame which hasn't been analyzed yet.
+class FrameByFrameAnalyzer {
+ public:
+  FrameByFrameAnalyzer(const MappedVideoFile* reference_file,
+                       const MappedVideoFile* test_file,
+                       int width,
+                       int height,
+                       std::vector<AnalysisResult>* frames)
+      : reference_file_(reference_file),
+        test_file_(test_file),
+        width_(width),
+        height_(height),
+        num_frames_(std::min(reference_file->num_frames(),
+                             test_file->num_frames())),
+        next_frame_(0),
+        frames_(frames) {
+    frames_->resize(num_frames_);
+  }
+
+  static bool Run(void* obj) {
+    static_cast<FrameByFrameAnalyzer*>(obj)->AnalyzeFrames();
+    // Each thread runs only once.
+    return false;
+  }
+
+  void AnalyzeFrames() {
+    for (int frame = rtc::AtomicOps::Increment(&next_frame_) - 1;
+         frame < num_frames_;
+         frame = rtc::AtomicOps::Increment(&next_frame_) - 1) {
+      const uint8* reference_frame = reference_file_->frame(frame);
+      const uint8* test_frame = test_file_->frame(frame);
+      (*frames_)[frame] = AnalysisResult(
+          frame,
+          CalculateMetrics(kPSNR, reference_frame, test_frame, width_, height_),
+          CalculateMetrics(kSSIM, reference_frame, test_frame, width_,
+                           height_));
+    }
+  }
+
+ private:
+  const MappedVideoFile* const reference_file_;
+  const MappedVideoFile* const test_file_;
+  const int width_;
+  const int height_;
+  const int num_frames_;
+  volatile int next_frame_;
+  // Each frame is written by a single thread.
+  std::vector<AnalysisResult>* const frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameByFrameAnalyzer);
+};
+
+// JSON has no representation of NaN and infinity, e.g. the SSIM of a frame
+// too small for a single window.
+void PrintJsonNumber(FILE* output, double value) {
+  if (std::isfinite(value))
+    fprintf(output, "%f", value);
+  else
+    fprintf(output, "null");
+}
+
+}  // namespace
+
 int GetI420FrameSize(int width, int height) {
   int half_width = (width + 1) >> 1;
   int half_height = (height + 1) >> 1;
@@ -182,9 +258,6 @@ double CalculateMetrics(VideoAnalysisMetricsType video_metrics_type,
   const uint8* src_u_b = src_y_b + width * height;
   const uint8* src_v_b = src_u_b + half_width * half_height;
 
-  int stride_y = width;
-  int stride_uv = half_width;
-
   double result = 0.0;
 
   switch (video_metrics_type) {
@@ -199,10 +272,8 @@ double CalculateMetrics(VideoAnalysisMetricsType video_metrics_type,
       result = (result > 48.0) ? 48.0 : result;
       break;
     case kSSIM:
-      result = libyuv::I420Ssim(src_y_a, stride_y, src_u_a, stride_uv,
-                                src_v_a, stride_uv, src_y_b, stride_y,
-                                src_u_b, stride_uv, src_v_b, stride_uv,
-                                width, height);
+      // Same as libyuv::I420Ssim(), which computes the SSIM without SIMD.
+      result = CalculateI420Ssim(ref_frame, test_frame, width, height);
       break;
     default:
       assert(false);
@@ -279,6 +350,94 @@ void RunAnalysis(const char* reference_file_name, const char* test_file_name,
   delete[] reference_frame;
 }
 
+bool RunFrameByFrameAnalysis(const std::string& reference_file_name,
+                             const std::string& test_file_name,
+                             int width,
+                             int height,
+                             int num_threads,
+                             ResultsContainer* results) {
+  const bool y4m_mode = reference_file_name.find("y4m") != std::string::npos;
+  rtc::scoped_ptr<MappedVideoFile> reference_file(
+      MappedVideoFile::Open(reference_file_name, y4m_mode, width, height));
+  rtc::scoped_ptr<MappedVideoFile> test_file(
+      MappedVideoFile::Open(test_file_name, false, width, height));
+  if (!reference_file || !test_file)
+    return false;
+
+  FrameByFrameAnalyzer analyzer(reference_file.get(), test_file.get(), width,
+                                height, &results->frames);
+  ScopedVector<ThreadWrapper> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.push_back(ThreadWrapper::CreateThread(&FrameByFrameAnalyzer::Run,
+                                                  &analyzer, "FrameAnalyzer")
+                          .release());
+    if (!threads.back()->Start()) {
+      threads.pop_back();
+      break;
+    }
+  }
+  analyzer.AnalyzeFrames();
+  for (ThreadWrapper* thread : threads)
+    thread->Stop();
+  return true;
+}
+
+AggregateResult AggregateResults(const ResultsContainer& results) {
+  AggregateResult aggregate;
+  aggregate.num_frames = static_cast<int>(results.frames.size());
+  if (aggregate.num_frames == 0)
+    return aggregate;
+  aggregate.min_psnr = results.frames[0].psnr_value;
+  aggregate.min_ssim = results.frames[0].ssim_value;
+  for (const AnalysisResult& frame : results.frames) {
+    aggregate.mean_psnr += frame.psnr_value;
+    aggregate.mean_ssim += frame.ssim_value;
+    aggregate.min_psnr = std::min(aggregate.min_psnr, frame.psnr_value);
+    aggregate.min_ssim = std::min(aggregate.min_ssim, frame.ssim_value);
+  }
+  aggregate.mean_psnr /= aggregate.num_frames;
+  aggregate.mean_ssim /= aggregate.num_frames;
+  return aggregate;
+}
+
+void PrintAnalysisResultsAsCsv(FILE* output, const ResultsContainer& results) {
+  fprintf(output, "frame,psnr,ssim\n");
+  for (const AnalysisResult& frame : results.frames) {
+    fprintf(output, "%d,%f,%f\n", frame.frame_number, frame.psnr_value,
+            frame.ssim_value);
+  }
+  const AggregateResult aggregate = AggregateResults(results);
+  fprintf(output, "mean,%f,%f\n", aggregate.mean_psnr, aggregate.mean_ssim);
+  fprintf(output, "min,%f,%f\n", aggregate.min_psnr, aggregate.min_ssim);
+}
+
+void PrintAnalysisResultsAsJson(FILE* output, const ResultsContainer& results) {
+  fprintf(output, "{\n  \"frames\": [");
+  for (size_t i = 0; i < results.frames.size(); ++i) {
+    const AnalysisResult& frame = results.frames[i];
+    fprintf(output, "%s\n    {\"frame\": %d, \"psnr\": ", i > 0 ? "," : "",
+            frame.frame_number);
+    PrintJsonNumber(output, frame.psnr_value);
+    fprintf(output, ", \"ssim\": ");
+    PrintJsonNumber(output, frame.ssim_value);
+    fprintf(output, "}");
+  }
+  const AggregateResult aggregate = AggregateResults(results);
+  fprintf(output, "\n  ],\n  \"num_frames\": %d", aggregate.num_frames);
+  const struct {
+    const char* name;
+    double value;
+  } kAggregates[] = {{"mean_psnr", aggregate.mean_psnr},
+                     {"min_psnr", aggregate.min_psnr},
+                     {"mean_ssim", aggregate.mean_ssim},
+                     {"min_ssim", aggregate.min_ssim}};
+  for (const auto& value : kAggregates) {
+    fprintf(output, ",\n  \"%s\": ", value.name);
+    PrintJsonNumber(output, value.value);
+  }
+  fprintf(output, "\n}\n");
+}
+
 void PrintMaxRepeatedAndSkippedFrames(const std::string& label,
                                       const std::string& stats_file_name) {
   PrintMaxRepeatedAndSkippedFrames(stdout, label, stats_file_name);
@@ -35,6 +35,22 @@ struct ResultsContainer {
   std::vector<AnalysisResult> frames;
 };
 
+// The mean and minimum values of the metrics over all frames of a
+// ResultsContainer.
+struct AggregateResult {
+  AggregateResult()
+      : num_frames(0),
+        mean_psnr(0.0),
+        min_psnr(0.0),
+        mean_ssim(0.0),
+        min_ssim(0.0) {}
+  int num_frames;
+  double mean_psnr;
+  double min_psnr;
+  double mean_ssim;
+  double min_ssim;
+};
+
 enum VideoAnalysisMetricsType {kPSNR, kSSIM};
 
 // A function to run the PSNR and SSIM analysis on the test file. The test file
@@ -54,6 +70,20 @@ void RunAnalysis(const char* reference_file_name, const char* test_file_name,
                  const char* stats_file_name, int width, int height,
                  ResultsContainer* results);
 
+// Runs the PSNR and SSIM analysis on the frames at the same position in the
+// reference and the test file, until either file runs out of frames. Unlike
+// RunAnalysis() no stats file is needed, so this is meant for comparing the
+// output of a codec to its input. Both files are memory mapped and the frames
+// are distributed over |num_threads| threads, including the calling one. The
+// reference file is read as Y4M if its name contains "y4m". Returns false if
+// either file can't be read.
+bool RunFrameByFrameAnalysis(const std::string& reference_file_name,
+                             const std::string& test_file_name,
+                             int width,
+                             int height,
+                             int num_threads,
+                             ResultsContainer* results);
+
 // Compute PSNR or SSIM for an I420 frame (all planes). When we are calculating
 // PSNR values, the max return value (in the case where the test and reference
 // frames are exactly the same) will be 48. In the case of SSIM the max return
@@ -71,6 +101,18 @@ void PrintAnalysisResults(const std::string& label, ResultsContainer* results);
 void PrintAnalysisResults(FILE* output, const std::string& label,
                           ResultsContainer* results);
 
+// Returns the mean and minimum PSNR and SSIM of |results|.
+AggregateResult AggregateResults(const ResultsContainer& results);
+
+// Prints a "frame,psnr,ssim" header, one line per frame and two lines with
+// the aggregate results, with "mean" and "min" in the frame column.
+void PrintAnalysisResultsAsCsv(FILE* output, const ResultsContainer& results);
+
+// Prints a JSON object with a "frames" array holding the results of every
+// frame and the aggregate results as "num_frames", "mean_psnr", "min_psnr",
+// "mean_ssim" and "min_ssim".
+void PrintAnalysisResultsAsJson(FILE* output, const ResultsContainer& results);
+
 // Calculates max repeated and skipped frames and prints them to stdout in a
 // format that is compatible with Chromium performance numbers.
 void PrintMaxRepeatedAndSkippedFrames(const std::string& label,
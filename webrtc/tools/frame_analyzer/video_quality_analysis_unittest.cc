@@ -11,8 +11,12 @@
 // This test doesn't actually verify the output since it's just printed
 // to stdout by void functions, but it's still useful as it executes the code.
 
+#include <stdio.h>
+
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/test/testsupport/fileutils.h"
@@ -20,6 +24,53 @@
 
 namespace webrtc {
 namespace test {
+namespace {
+
+const int kWidth = 67;
+const int kHeight = 37;
+
+// Returns a frame whose pixels depend on |frame_number| and |noise|.
+std::vector<uint8> GenerateFrame(int frame_number, int noise) {
+  std::vector<uint8> frame(GetI420FrameSize(kWidth, kHeight));
+  uint32_t seed = 1 + frame_number;
+  for (size_t i = 0; i < frame.size(); ++i) {
+    seed = seed * 1664525 + 1013904223;
+    frame[i] = static_cast<uint8>((i / 5 + frame_number * 3 +
+                                   (seed >> 16) % (noise + 1)) & 0xff);
+  }
+  return frame;
+}
+
+// Writes |num_frames| frames to |file_name|, raw or with Y4M headers,
+// followed by |trailing_bytes| bytes of a truncated frame.
+void WriteVideoFile(const std::string& file_name,
+                    int num_frames,
+                    int noise,
+                    bool y4m,
+                    size_t trailing_bytes) {
+  FILE* file = fopen(file_name.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  if (y4m)
+    fprintf(file, "YUV4MPEG2 W%d H%d F30:1 Ip A0:0 C420jpeg\n", kWidth,
+            kHeight);
+  for (int i = 0; i < num_frames; ++i) {
+    const std::vector<uint8> frame = GenerateFrame(i, noise);
+    if (y4m)
+      fprintf(file, i % 2 ? "FRAME\n" : "FRAME Ip\n");
+    fwrite(&frame[0], 1, frame.size(), file);
+  }
+  const std::vector<uint8> frame = GenerateFrame(num_frames, noise);
+  fwrite(&frame[0], 1, trailing_bytes, file);
+  fclose(file);
+}
+
+std::string ReadFile(const std::string& file_name) {
+  std::ifstream file(file_name.c_str());
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
 
 // Setup a log file to write the output to instead of stdout because we don't
 // want those numbers to be picked up as perf numbers.
@@ -86,6 +137,107 @@ TEST_F(VideoQualityAnalysisTest, PrintMaxRepeatedAndSkippedFramesNormalFile) {
   PrintMaxRepeatedAndSkippedFrames(logfile_, "NormalStatsFile", stats_filename);
 }
 
+TEST_F(VideoQualityAnalysisTest, RunFrameByFrameAnalysisMatchesMetrics) {
+  const std::string reference_filename = OutputPath() + "reference.yuv";
+  const std::string reference_y4m_filename = OutputPath() + "reference.y4m";
+  const std::string test_filename = OutputPath() + "test.yuv";
+  const int kNumTestFrames = 9;
+  WriteVideoFile(reference_filename, kNumTestFrames + 2, 0, false, 0);
+  WriteVideoFile(reference_y4m_filename, kNumTestFrames + 2, 0, true, 0);
+  WriteVideoFile(test_filename, kNumTestFrames, 20, false, 100);
+
+  for (const std::string& filename :
+       {reference_filename, reference_y4m_filename}) {
+    for (int num_threads : {1, 4}) {
+      SCOPED_TRACE(filename);
+      SCOPED_TRACE(num_threads);
+      ResultsContainer results;
+      ASSERT_TRUE(RunFrameByFrameAnalysis(filename, test_filename, kWidth,
+                                          kHeight, num_threads, &results));
+      ASSERT_EQ(static_cast<size_t>(kNumTestFrames), results.frames.size());
+      for (int i = 0; i < kNumTestFrames; ++i) {
+        const std::vector<uint8> reference_frame = GenerateFrame(i, 0);
+        const std::vector<uint8> test_frame = GenerateFrame(i, 20);
+        EXPECT_EQ(i, results.frames[i].frame_number);
+        EXPECT_EQ(CalculateMetrics(kPSNR, &reference_frame[0], &test_frame[0],
+                                   kWidth, kHeight),
+                  results.frames[i].psnr_value);
+        EXPECT_EQ(CalculateMetrics(kSSIM, &reference_frame[0], &test_frame[0],
+                                   kWidth, kHeight),
+                  results.frames[i].ssim_value);
+        EXPECT_LT(results.frames[i].psnr_value, 48.0);
+      }
+    }
+  }
+}
+
+TEST_F(VideoQualityAnalysisTest, RunFrameByFrameAnalysisInvalidFiles) {
+  const std::string reference_filename = OutputPath() + "reference.yuv";
+  const std::string missing_filename = OutputPath() + "non-existing.yuv";
+  remove(missing_filename.c_str());
+  WriteVideoFile(reference_filename, 1, 0, false, 0);
+  ResultsContainer results;
+  EXPECT_FALSE(RunFrameByFrameAnalysis(reference_filename, missing_filename,
+                                       kWidth, kHeight, 2, &results));
+  EXPECT_FALSE(RunFrameByFrameAnalysis(missing_filename, reference_filename,
+                                       kWidth, kHeight, 2, &results));
+  // Not a Y4M file.
+  const std::string bad_y4m_filename = OutputPath() + "reference_bad.y4m";
+  WriteVideoFile(bad_y4m_filename, 1, 0, false, 0);
+  EXPECT_FALSE(RunFrameByFrameAnalysis(bad_y4m_filename, reference_filename,
+                                       kWidth, kHeight, 2, &results));
+}
+
+TEST_F(VideoQualityAnalysisTest, AggregateResults) {
+  ResultsContainer results;
+  EXPECT_EQ(0, AggregateResults(results).num_frames);
+  results.frames.push_back(AnalysisResult(0, 35.0, 0.9));
+  results.frames.push_back(AnalysisResult(1, 34.0, 0.6));
+  results.frames.push_back(AnalysisResult(2, 30.0, 0.75));
+  const AggregateResult aggregate = AggregateResults(results);
+  EXPECT_EQ(3, aggregate.num_frames);
+  EXPECT_DOUBLE_EQ(33.0, aggregate.mean_psnr);
+  EXPECT_DOUBLE_EQ(30.0, aggregate.min_psnr);
+  EXPECT_DOUBLE_EQ(0.75, aggregate.mean_ssim);
+  EXPECT_DOUBLE_EQ(0.6, aggregate.min_ssim);
+}
+
+TEST_F(VideoQualityAnalysisTest, PrintAnalysisResultsAsCsvAndJson) {
+  ResultsContainer results;
+  results.frames.push_back(AnalysisResult(0, 35.0, 0.5));
+  results.frames.push_back(AnalysisResult(1, 33.0, 0.25));
+  const std::string filename = OutputPath() + "results.txt";
+
+  FILE* file = fopen(filename.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  PrintAnalysisResultsAsCsv(file, results);
+  fclose(file);
+  EXPECT_EQ(
+      "frame,psnr,ssim\n"
+      "0,35.000000,0.500000\n"
+      "1,33.000000,0.250000\n"
+      "mean,34.000000,0.375000\n"
+      "min,33.000000,0.250000\n",
+      ReadFile(filename));
+
+  file = fopen(filename.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  PrintAnalysisResultsAsJson(file, results);
+  fclose(file);
+  EXPECT_EQ(
+      "{\n"
+      "  \"frames\": [\n"
+      "    {\"frame\": 0, \"psnr\": 35.000000, \"ssim\": 0.500000},\n"
+      "    {\"frame\": 1, \"psnr\": 33.000000, \"ssim\": 0.250000}\n"
+      "  ],\n"
+      "  \"num_frames\": 2,\n"
+      "  \"mean_psnr\": 34.000000,\n"
+      "  \"min_psnr\": 33.000000,\n"
+      "  \"mean_ssim\": 0.375000,\n"
+      "  \"min_ssim\": 0.250000\n"
+      "}\n",
+      ReadFile(filename));
+}
 
 }  // namespace test
 }  // namespace webrtc
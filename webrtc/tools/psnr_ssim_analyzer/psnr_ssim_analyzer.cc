@@ -8,60 +8,47 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include <map>
 #include <string>
-#include <vector>
 
+#include "webrtc/system_wrappers/interface/cpu_info.h"
 #include "webrtc/tools/frame_analyzer/video_quality_analysis.h"
 #include "webrtc/tools/simple_command_line_parser.h"
 
-#define MAX_NUM_FRAMES_PER_FILE INT_MAX
-
-void CompareFiles(const char* reference_file_name, const char* test_file_name,
-                  const char* results_file_name, int width, int height) {
-  // Check if the reference_file_name ends with "y4m".
-  bool y4m_mode = false;
-  if (std::string(reference_file_name).find("y4m") != std::string::npos){
-    y4m_mode = true;
+bool CompareFiles(const std::string& reference_file_name,
+                  const std::string& test_file_name,
+                  const std::string& results_file_name,
+                  const std::string& output_format,
+                  int width,
+                  int height,
+                  int num_threads) {
+  webrtc::test::ResultsContainer results;
+  if (!webrtc::test::RunFrameByFrameAnalysis(reference_file_name,
+                                             test_file_name, width, height,
+                                             num_threads, &results)) {
+    return false;
   }
 
-  FILE* results_file = fopen(results_file_name, "w");
-
-  int size = webrtc::test::GetI420FrameSize(width, height);
-
-  // Allocate buffers for test and reference frames.
-  uint8* test_frame = new uint8[size];
-  uint8* ref_frame = new uint8[size];
-
-  bool read_result = true;
-  for(int frame_counter = 0; frame_counter < MAX_NUM_FRAMES_PER_FILE;
-      ++frame_counter){
-    read_result &= (y4m_mode) ? webrtc::test::ExtractFrameFromY4mFile(
-        reference_file_name, width, height, frame_counter, ref_frame):
-        webrtc::test::ExtractFrameFromYuvFile(reference_file_name, width,
-                                              height, frame_counter, ref_frame);
-    read_result &=  webrtc::test::ExtractFrameFromYuvFile(test_file_name, width,
-        height, frame_counter, test_frame);
-
-    if (!read_result)
-      break;
-
-    // Calculate the PSNR and SSIM.
-    double result_psnr = webrtc::test::CalculateMetrics(
-        webrtc::test::kPSNR, ref_frame, test_frame, width, height);
-    double result_ssim = webrtc::test::CalculateMetrics(
-        webrtc::test::kSSIM, ref_frame, test_frame, width, height);
-    fprintf(results_file, "Frame: %d, PSNR: %f, SSIM: %f\n", frame_counter,
-            result_psnr, result_ssim);
+  FILE* results_file = fopen(results_file_name.c_str(), "w");
+  if (results_file == NULL) {
+    fprintf(stderr, "Couldn't open results file for writing: %s\n",
+            results_file_name.c_str());
+    return false;
+  }
+  if (output_format == "csv") {
+    webrtc::test::PrintAnalysisResultsAsCsv(results_file, results);
+  } else if (output_format == "json") {
+    webrtc::test::PrintAnalysisResultsAsJson(results_file, results);
+  } else {
+    for (const webrtc::test::AnalysisResult& frame : results.frames) {
+      fprintf(results_file, "Frame: %d, PSNR: %f, SSIM: %f\n",
+              frame.frame_number, frame.psnr_value, frame.ssim_value);
+    }
   }
-  delete[] test_frame;
-  delete[] ref_frame;
-
   fclose(results_file);
+  return true;
 }
 
 /*
@@ -69,16 +56,21 @@ void CompareFiles(const char* reference_file_name, const char* test_file_name,
  * test video. The two videos should be I420 YUV videos.
  * The tool just runs PSNR and SSIM on the corresponding frames in the test and
  * the reference videos until either the first or the second video runs out of
- * frames. The result is written in a results text file in the format:
+ * frames. The videos are memory mapped and the frames are analyzed on
+ * --num_threads threads, one per core by default. With --output_format=text
+ * the result is written in a results text file in the format:
  * Frame: <frame_number>, PSNR: <psnr_value>, SSIM: <ssim_value>
  * Frame: <frame_number>, ........
+ * With --output_format=csv or json the mean and minimum PSNR and SSIM are
+ * written after the per-frame results.
  *
  * The max value for PSNR is 48.0 (between equal frames), as for SSIM it is 1.0.
  *
  * Usage:
  * psnr_ssim_analyzer --reference_file=<name_of_file> --test_file=<name_of_file>
  * --results_file=<name_of_file> --width=<width_of_frames>
- * --height=<height_of_frames>
+ * --height=<height_of_frames> [--num_threads=<number_of_threads>]
+ * [--output_format=<text|csv|json>]
  */
 int main(int argc, char** argv) {
   std::string program_name = argv[0];
@@ -96,7 +88,11 @@ int main(int argc, char** argv) {
       "  - test_file(string): The test YUV file to run the analysis for."
       " Default: test_file.yuv\n"
       "  - results_file(string): The full name of the file where the results "
-      "will be written. Default: results.txt\n";
+      "will be written. Default: results.txt\n"
+      "  - num_threads(int): The number of threads analyzing the frames. "
+      "Default: the number of cores\n"
+      "  - output_format(string): The format of the results file, text, csv "
+      "or json. Default: text\n";
 
   webrtc::test::CommandLineParser parser;
 
@@ -110,6 +106,8 @@ int main(int argc, char** argv) {
   parser.SetFlag("reference_file", "ref.yuv");
   parser.SetFlag("test_file", "test.yuv");
   parser.SetFlag("results_file", "results.txt");
+  parser.SetFlag("num_threads", "0");
+  parser.SetFlag("output_format", "text");
   parser.SetFlag("help", "false");
 
   parser.ProcessFlags();
@@ -127,7 +125,22 @@ int main(int argc, char** argv) {
     return -1;
   }
 
-  CompareFiles(parser.GetFlag("reference_file").c_str(),
-               parser.GetFlag("test_file").c_str(),
-               parser.GetFlag("results_file").c_str(), width, height);
+  int num_threads = strtol((parser.GetFlag("num_threads")).c_str(), NULL, 10);
+  if (num_threads <= 0)
+    num_threads = static_cast<int>(webrtc::CpuInfo::DetectNumberOfCores());
+
+  const std::string output_format = parser.GetFlag("output_format");
+  if (output_format != "text" && output_format != "csv" &&
+      output_format != "json") {
+    fprintf(stderr, "Error: output_format must be text, csv or json!\n");
+    return -1;
+  }
+
+  if (!CompareFiles(parser.GetFlag("reference_file"),
+                    parser.GetFlag("test_file"),
+                    parser.GetFlag("results_file"), output_format, width,
+                    height, num_threads)) {
+    return -1;
+  }
+  return 0;
 }
@@ -16,14 +16,29 @@
       'type': 'static_library',
       'dependencies': [
         '<(webrtc_root)/common_video/common_video.gyp:common_video',
+        '<(webrtc_root)/system_wrappers/system_wrappers.gyp:system_wrappers',
       ],
       'export_dependent_settings': [
         '<(webrtc_root)/common_video/common_video.gyp:common_video',
       ],
       'sources': [
+        'frame_analyzer/mapped_video_file.cc',
+        'frame_analyzer/mapped_video_file.h',
+        'frame_analyzer/ssim.cc',
+        'frame_analyzer/ssim.h',
+        'frame_analyzer/ssim_neon.h',
+        'frame_analyzer/ssim_sse2.h',
         'frame_analyzer/video_quality_analysis.h',
         'frame_analyzer/video_quality_analysis.cc',
       ],
+      'conditions': [
+        ['target_arch=="ia32" or target_arch=="x64"', {
+          'dependencies': ['video_quality_analysis_sse2',],
+        }],
+        ['build_with_neon==1', {
+          'dependencies': ['video_quality_analysis_neon',],
+        }],
+      ],
     }, # video_quality_analysis
     {
       'target_name': 'frame_analyzer',
@@ -99,6 +114,37 @@
     }, # force_mic_volume_max
   ],
   'conditions': [
+    ['target_arch=="ia32" or target_arch=="x64"', {
+      'targets': [
+        {
+          'target_name': 'video_quality_analysis_sse2',
+          'type': 'static_library',
+          'sources': [
+            'frame_analyzer/ssim_sse2.cc',
+          ],
+          'conditions': [
+            ['os_posix==1', {
+              'cflags': [ '-msse2', ],
+              'xcode_settings': {
+                'OTHER_CFLAGS': [ '-msse2', ],
+              },
+            }],
+          ],
+        },
+      ],  # targets
+    }],
+    ['build_with_neon==1', {
+      'targets': [
+        {
+          'target_name': 'video_quality_analysis_neon',
+          'type': 'static_library',
+          'includes': ['../build/arm_neon.gypi',],
+          'sources': [
+            'frame_analyzer/ssim_neon.cc',
+          ],
+        },
+      ],  # targets
+    }],
     ['include_tests==1', {
       'targets' : [
         {
@@ -192,6 +238,7 @@
           'sources': [
             'simple_command_line_parser_unittest.cc',
             'frame_editing/frame_editing_unittest.cc',
+            'frame_analyzer/ssim_unittest.cc',
             'frame_analyzer/video_quality_analysis_unittest.cc',
           ],
           # Disable warnings to enable Win64 build, issue 1323.
@@ -35,6 +35,7 @@
 #include "webrtc/video/rtc_event_log.h"
 #include "webrtc/video/video_receive_stream.h"
 #include "webrtc/video/video_send_stream.h"
+#include "webrtc/video_engine/decode_thread_pool.h"
 #include "webrtc/voice_engine/include/voe_codec.h"
 
 namespace webrtc {
@@ -96,6 +97,8 @@ class Call : public webrtc::Call, public PacketReceiver {
 
   const int num_cpu_cores_;
   const rtc::scoped_ptr<ProcessThread> module_process_thread_;
+  // Decodes the video receive streams if Config::num_decode_threads > 0.
+  const rtc::scoped_ptr<DecodeThreadPool> decode_thread_pool_;
   const rtc::scoped_ptr<ChannelGroup> channel_group_;
   volatile int next_channel_id_;
   Call::Config config_;
@@ -137,6 +140,10 @@ namespace internal {
 Call::Call(const Call::Config& config)
     : num_cpu_cores_(CpuInfo::DetectNumberOfCores()),
       module_process_thread_(ProcessThread::Create("ModuleProcessThread")),
+      decode_thread_pool_(
+          config.num_decode_threads > 0
+              ? new DecodeThreadPool(config.num_decode_threads)
+              : nullptr),
       channel_group_(new ChannelGroup(module_process_thread_.get())),
       next_channel_id_(0),
       config_(config),
@@ -294,7 +301,7 @@ webrtc::VideoReceiveStream* Call::CreateVideoReceiveStream(
   TRACE_EVENT0("webrtc", "Call::CreateVideoReceiveStream");
   LOG(LS_INFO) << "CreateVideoReceiveStream: " << config.ToString();
   VideoReceiveStream* receive_stream = new VideoReceiveStream(
-      num_cpu_cores_, channel_group_.get(),
+      num_cpu_cores_, decode_thread_pool_.get(), channel_group_.get(),
       rtc::AtomicOps::Increment(&next_channel_id_), config,
       config_.voice_engine);
 
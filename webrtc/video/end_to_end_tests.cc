@@ -18,6 +18,7 @@
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/call.h"
 #include "webrtc/frame_callback.h"
+#include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
 #include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
 #include "webrtc/modules/video_coding/codecs/vp9/include/vp9.h"
@@ -229,6 +230,74 @@ TEST_F(EndToEndTest, TransmitsFirstFrame) {
   DestroyStreams();
 }
 
+TEST_F(EndToEndTest, DecodesAndRendersOnDecodeThreadPool) {
+  static const int kNumFramesToRender = 30;
+
+  // With a pool, the decoders are registered as renderers so that the pool
+  // threads don't wait for the render times, and the frames are held until
+  // their render time after decoding instead.
+  class PoolObserver : public test::EndToEndTest,
+                       public I420FrameCallback,
+                       public VideoRenderer {
+   public:
+    PoolObserver()
+        : EndToEndTest(kDefaultTimeoutMs),
+          crit_(CriticalSectionWrapper::CreateCriticalSection()),
+          num_decoded_frames_(0),
+          num_rendered_frames_(0),
+          last_rendered_timestamp_(0) {}
+
+   private:
+    Call::Config GetReceiverCallConfig() override {
+      Call::Config config = EndToEndTest::GetReceiverCallConfig();
+      config.num_decode_threads = 2;
+      return config;
+    }
+
+    void ModifyConfigs(VideoSendStream::Config* send_config,
+                       std::vector<VideoReceiveStream::Config>* receive_configs,
+                       VideoEncoderConfig* encoder_config) override {
+      EXPECT_FALSE((*receive_configs)[0].decoders[0].is_renderer);
+      (*receive_configs)[0].pre_render_callback = this;
+      (*receive_configs)[0].renderer = this;
+    }
+
+    void FrameCallback(VideoFrame* video_frame) override {
+      CriticalSectionScoped lock(crit_.get());
+      ++num_decoded_frames_;
+    }
+
+    void RenderFrame(const VideoFrame& video_frame,
+                     int /*time_to_render_ms*/) override {
+      CriticalSectionScoped lock(crit_.get());
+      // The frames are decoded and rendered in order.
+      if (num_rendered_frames_ > 0) {
+        EXPECT_TRUE(IsNewerTimestamp(video_frame.timestamp(),
+                                     last_rendered_timestamp_));
+      }
+      last_rendered_timestamp_ = video_frame.timestamp();
+      EXPECT_LE(++num_rendered_frames_, num_decoded_frames_);
+      if (num_rendered_frames_ == kNumFramesToRender)
+        observation_complete_->Set();
+    }
+
+    bool IsTextureSupported() const override { return false; }
+
+    void PerformTest() override {
+      EXPECT_EQ(kEventSignaled, Wait())
+          << "Timed out while waiting for frames decoded on the pool to "
+             "render.";
+    }
+
+    const rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+    int num_decoded_frames_ GUARDED_BY(crit_);
+    int num_rendered_frames_ GUARDED_BY(crit_);
+    uint32_t last_rendered_timestamp_ GUARDED_BY(crit_);
+  } test;
+
+  RunBaseTest(&test);
+}
+
 TEST_F(EndToEndTest, SendsAndReceivesVP9) {
   class VP9Observer : public test::EndToEndTest, public VideoRenderer {
    public:
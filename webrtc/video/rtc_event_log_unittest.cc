@@ -303,7 +303,8 @@ size_t GenerateRtpPacket(uint32_t extensions_bitvector,
                        nullptr,   // SendTimeObserver*
                        nullptr,   // BitrateStatisticsObserver*
                        nullptr,   // FrameCountObserver*
-                       nullptr);  // SendSideDelayObserver*
+                       nullptr,   // SendSideDelayObserver*
+                       nullptr);  // SendPacketObserver*
 
   std::vector<uint32_t> csrcs;
   for (unsigned i = 0; i < csrcs_count; i++) {
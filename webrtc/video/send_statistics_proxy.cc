@@ -12,16 +12,25 @@
 
 #include <algorithm>
 #include <map>
+#include <vector>
 
 #include "webrtc/base/checks.h"
 
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 #include "webrtc/system_wrappers/interface/metrics.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
 
 namespace webrtc {
+namespace {
+// Frames which never reach the transport, e.g. because they are dropped
+// before encoding, are forgotten when a later frame is sent. This bounds the
+// number of frames tracked if none is sent at all.
+const size_t kMaxFramesInFlight = 100;
+}  // namespace
 
 const int SendStatisticsProxy::kStatsTimeoutMs = 5000;
+const size_t SendStatisticsProxy::kMaxDelaySamples = 300;
 
 SendStatisticsProxy::SendStatisticsProxy(Clock* clock,
                                          const VideoSendStream::Config& config)
@@ -31,7 +40,13 @@ SendStatisticsProxy::SendStatisticsProxy(Clock* clock,
       sent_frame_rate_tracker_(100u, 10u),
       last_sent_frame_timestamp_(0),
       max_sent_width_per_timestamp_(0),
-      max_sent_height_per_timestamp_(0) {
+      max_sent_height_per_timestamp_(0),
+      capture_delay_counter_(kMaxDelaySamples),
+      deliver_delay_counter_(kMaxDelaySamples),
+      preprocess_delay_counter_(kMaxDelaySamples),
+      encode_delay_counter_(kMaxDelaySamples),
+      send_delay_counter_(kMaxDelaySamples),
+      capture_to_send_delay_counter_(kMaxDelaySamples) {
 }
 
 SendStatisticsProxy::~SendStatisticsProxy() {
@@ -92,6 +107,13 @@ VideoSendStream::Stats SendStatisticsProxy::GetStats() {
   PurgeOldStats();
   stats_.input_frame_rate =
       static_cast<int>(input_frame_rate_tracker_.ComputeRate());
+  stats_.capture_delay = capture_delay_counter_.GetPercentiles();
+  stats_.deliver_delay = deliver_delay_counter_.GetPercentiles();
+  stats_.preprocess_delay = preprocess_delay_counter_.GetPercentiles();
+  stats_.encode_delay = encode_delay_counter_.GetPercentiles();
+  stats_.send_delay = send_delay_counter_.GetPercentiles();
+  stats_.capture_to_send_delay =
+      capture_to_send_delay_counter_.GetPercentiles();
   return stats_;
 }
 
@@ -156,6 +178,7 @@ void SendStatisticsProxy::OnSendEncodedImage(
   uint32_t ssrc = config_.rtp.ssrcs[simulcast_idx];
 
   rtc::CritScope lock(&crit_);
+  UpdateFrameStage(kFrameEncoded, encoded_image.capture_time_ms_);
   VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
   if (stats == nullptr)
     return;
@@ -196,6 +219,73 @@ void SendStatisticsProxy::OnEncodedFrame(int encode_time_ms) {
   encode_time_counter_.Add(encode_time_ms);
 }
 
+void SendStatisticsProxy::OnFrameStage(FrameStage stage,
+                                       int64_t capture_time_ms) {
+  rtc::CritScope lock(&crit_);
+  UpdateFrameStage(stage, capture_time_ms);
+}
+
+void SendStatisticsProxy::OnSendPacket(int64_t capture_time_ms,
+                                       uint32_t ssrc) {
+  rtc::CritScope lock(&crit_);
+  UpdateFrameStage(kFrameSent, capture_time_ms);
+}
+
+void SendStatisticsProxy::UpdateFrameStage(FrameStage stage,
+                                           int64_t capture_time_ms) {
+  if (capture_time_ms <= 0)
+    return;
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  if (stage == kFrameIncoming) {
+    if (frames_in_flight_.size() >= kMaxFramesInFlight)
+      frames_in_flight_.erase(frames_in_flight_.begin());
+    FrameProgress progress = {kFrameIncoming, now_ms};
+    if (!frames_in_flight_.insert(std::make_pair(capture_time_ms, progress))
+             .second) {
+      return;
+    }
+    capture_delay_counter_.Add(
+        static_cast<int>(std::max<int64_t>(now_ms - capture_time_ms, 0)));
+    return;
+  }
+
+  // Only the first time a frame reaches a stage counts, e.g. the first
+  // simulcast layer encoded or the first packet sent.
+  std::map<int64_t, FrameProgress>::iterator it =
+      frames_in_flight_.find(capture_time_ms);
+  if (it == frames_in_flight_.end() || it->second.stage >= stage)
+    return;
+  int delay_ms = static_cast<int>(now_ms - it->second.time_ms);
+  it->second.stage = stage;
+  it->second.time_ms = now_ms;
+  switch (stage) {
+    case kFrameDelivered:
+      deliver_delay_counter_.Add(delay_ms);
+      TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", capture_time_ms, "Delivered");
+      break;
+    case kFramePreprocessed:
+      preprocess_delay_counter_.Add(delay_ms);
+      TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", capture_time_ms,
+                              "Preprocessed");
+      break;
+    case kFrameEncoded:
+      encode_delay_counter_.Add(delay_ms);
+      TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", capture_time_ms, "Encoded");
+      break;
+    case kFrameSent:
+      send_delay_counter_.Add(delay_ms);
+      capture_to_send_delay_counter_.Add(
+          static_cast<int>(std::max<int64_t>(now_ms - capture_time_ms, 0)));
+      TRACE_EVENT_ASYNC_END0("webrtc", "Video", capture_time_ms);
+      // Older frames which haven't been sent by now have been dropped.
+      frames_in_flight_.erase(frames_in_flight_.begin(), ++it);
+      break;
+    case kFrameIncoming:
+      RTC_NOTREACHED();
+      break;
+  }
+}
+
 void SendStatisticsProxy::RtcpPacketTypesCounterUpdated(
     uint32_t ssrc,
     const RtcpPacketTypeCounter& packet_counter) {
@@ -275,4 +365,24 @@ int SendStatisticsProxy::SampleCounter::Avg(int min_required_samples) const {
   return sum / num_samples;
 }
 
+void SendStatisticsProxy::PercentileCounter::Add(int sample) {
+  samples_.push_back(sample);
+  if (samples_.size() > max_samples_)
+    samples_.pop_front();
+}
+
+VideoSendStream::DelayPercentiles
+SendStatisticsProxy::PercentileCounter::GetPercentiles() const {
+  VideoSendStream::DelayPercentiles percentiles;
+  if (samples_.empty())
+    return percentiles;
+  std::vector<int> sorted(samples_.begin(), samples_.end());
+  std::sort(sorted.begin(), sorted.end());
+  const size_t last = sorted.size() - 1;
+  percentiles.p50_ms = sorted[last * 50 / 100];
+  percentiles.p90_ms = sorted[last * 90 / 100];
+  percentiles.p99_ms = sorted[last * 99 / 100];
+  return percentiles;
+}
+
 }  // namespace webrtc
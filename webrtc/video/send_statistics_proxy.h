@@ -11,6 +11,8 @@
 #ifndef WEBRTC_VIDEO_SEND_STATISTICS_PROXY_H_
 #define WEBRTC_VIDEO_SEND_STATISTICS_PROXY_H_
 
+#include <deque>
+#include <map>
 #include <string>
 
 #include "webrtc/base/criticalsection.h"
@@ -35,9 +37,23 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
                             public FrameCountObserver,
                             public ViEEncoderObserver,
                             public VideoEncoderRateObserver,
-                            public SendSideDelayObserver {
+                            public SendSideDelayObserver,
+                            public SendPacketObserver {
  public:
   static const int kStatsTimeoutMs;
+  // Number of recent frames the delay percentiles are computed over.
+  static const size_t kMaxDelaySamples;
+
+  // Stages of the send pipeline a frame passes through, in order. A frame is
+  // identified by its capture time (render_time_ms() of the VideoFrame,
+  // capture_time_ms_ of the EncodedImage and of the RTP packets).
+  enum FrameStage {
+    kFrameIncoming,      // Received by VideoCaptureInput.
+    kFrameDelivered,     // Delivered to ViEEncoder on the capture thread.
+    kFramePreprocessed,  // Handed to VideoSender for encoding.
+    kFrameEncoded,       // Returned by the encoder.
+    kFrameSent,          // First packet sent to the transport.
+  };
 
   SendStatisticsProxy(Clock* clock, const VideoSendStream::Config& config);
   virtual ~SendStatisticsProxy();
@@ -57,6 +73,9 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
 
   void OnInactiveSsrc(uint32_t ssrc);
 
+  // Records that the frame captured at |capture_time_ms| reached |stage|.
+  void OnFrameStage(FrameStage stage, int64_t capture_time_ms);
+
  protected:
   // From CpuOveruseMetricsObserver.
   void CpuOveruseMetricsUpdated(const CpuOveruseMetrics& metrics) override;
@@ -92,6 +111,9 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
                             int max_delay_ms,
                             uint32_t ssrc) override;
 
+  // From SendPacketObserver.
+  void OnSendPacket(int64_t capture_time_ms, uint32_t ssrc) override;
+
  private:
   struct SampleCounter {
     SampleCounter() : sum(0), num_samples(0) {}
@@ -102,6 +124,18 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
     int sum;
     int num_samples;
   };
+  // Keeps the last |max_samples| samples and computes percentiles of them.
+  class PercentileCounter {
+   public:
+    explicit PercentileCounter(size_t max_samples)
+        : max_samples_(max_samples) {}
+    void Add(int sample);
+    VideoSendStream::DelayPercentiles GetPercentiles() const;
+
+   private:
+    const size_t max_samples_;
+    std::deque<int> samples_;
+  };
   struct StatsUpdateTimes {
     StatsUpdateTimes() : resolution_update_ms(0) {}
     int64_t resolution_update_ms;
@@ -111,6 +145,8 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
   VideoSendStream::StreamStats* GetStatsEntry(uint32_t ssrc)
       EXCLUSIVE_LOCKS_REQUIRED(crit_);
   void UpdateHistograms() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void UpdateFrameStage(FrameStage stage, int64_t capture_time_ms)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   Clock* const clock_;
   const VideoSendStream::Config config_;
@@ -128,6 +164,21 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
   SampleCounter sent_width_counter_ GUARDED_BY(crit_);
   SampleCounter sent_height_counter_ GUARDED_BY(crit_);
   SampleCounter encode_time_counter_ GUARDED_BY(crit_);
+
+  // Frames in the send pipeline, by capture time, and the last stage each has
+  // reached and when.
+  struct FrameProgress {
+    FrameStage stage;
+    int64_t time_ms;
+  };
+  std::map<int64_t, FrameProgress> frames_in_flight_ GUARDED_BY(crit_);
+  // Delays until each stage from the stage before it, and in total.
+  PercentileCounter capture_delay_counter_ GUARDED_BY(crit_);
+  PercentileCounter deliver_delay_counter_ GUARDED_BY(crit_);
+  PercentileCounter preprocess_delay_counter_ GUARDED_BY(crit_);
+  PercentileCounter encode_delay_counter_ GUARDED_BY(crit_);
+  PercentileCounter send_delay_counter_ GUARDED_BY(crit_);
+  PercentileCounter capture_to_send_delay_counter_ GUARDED_BY(crit_);
 };
 
 }  // namespace webrtc
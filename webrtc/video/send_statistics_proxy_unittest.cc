@@ -404,4 +404,78 @@ TEST_F(SendStatisticsProxyTest, ClearsBitratesFromInactiveSsrcs) {
   EXPECT_EQ(0, stats.substreams[config_.rtp.ssrcs[1]].retransmit_bitrate_bps);
 }
 
+TEST_F(SendStatisticsProxyTest, FrameStageDelays) {
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(-1, stats.capture_to_send_delay.p50_ms);
+
+  const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  fake_clock_.AdvanceTimeMilliseconds(5);
+  statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFrameIncoming,
+                                  capture_time_ms);
+  fake_clock_.AdvanceTimeMilliseconds(2);
+  statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFrameDelivered,
+                                  capture_time_ms);
+  fake_clock_.AdvanceTimeMilliseconds(3);
+  statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFramePreprocessed,
+                                  capture_time_ms);
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  EncodedImage encoded_image;
+  encoded_image.capture_time_ms_ = capture_time_ms;
+  statistics_proxy_->OnSendEncodedImage(encoded_image, nullptr);
+  fake_clock_.AdvanceTimeMilliseconds(4);
+  SendPacketObserver* observer = statistics_proxy_.get();
+  observer->OnSendPacket(capture_time_ms, config_.rtp.ssrcs[0]);
+  // Only the first packet of a frame counts.
+  fake_clock_.AdvanceTimeMilliseconds(20);
+  observer->OnSendPacket(capture_time_ms, config_.rtp.ssrcs[0]);
+
+  stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(5, stats.capture_delay.p50_ms);
+  EXPECT_EQ(2, stats.deliver_delay.p50_ms);
+  EXPECT_EQ(3, stats.preprocess_delay.p50_ms);
+  EXPECT_EQ(10, stats.encode_delay.p50_ms);
+  EXPECT_EQ(4, stats.send_delay.p50_ms);
+  EXPECT_EQ(24, stats.capture_to_send_delay.p50_ms);
+  EXPECT_EQ(24, stats.capture_to_send_delay.p99_ms);
+}
+
+TEST_F(SendStatisticsProxyTest, FrameStageDelayPercentiles) {
+  SendPacketObserver* observer = statistics_proxy_.get();
+  for (int delay_ms = 1; delay_ms <= 100; ++delay_ms) {
+    const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+    statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFrameIncoming,
+                                    capture_time_ms);
+    fake_clock_.AdvanceTimeMilliseconds(delay_ms);
+    observer->OnSendPacket(capture_time_ms, config_.rtp.ssrcs[0]);
+  }
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(50, stats.capture_to_send_delay.p50_ms);
+  EXPECT_EQ(90, stats.capture_to_send_delay.p90_ms);
+  EXPECT_EQ(99, stats.capture_to_send_delay.p99_ms);
+  // The stages in between were not reported.
+  EXPECT_EQ(-1, stats.encode_delay.p50_ms);
+}
+
+TEST_F(SendStatisticsProxyTest, ForgetsFramesOlderThanSentFrame) {
+  SendPacketObserver* observer = statistics_proxy_.get();
+  const int64_t dropped_capture_time_ms = fake_clock_.TimeInMilliseconds();
+  statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFrameIncoming,
+                                  dropped_capture_time_ms);
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  statistics_proxy_->OnFrameStage(SendStatisticsProxy::kFrameIncoming,
+                                  capture_time_ms);
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  observer->OnSendPacket(capture_time_ms, config_.rtp.ssrcs[0]);
+  fake_clock_.AdvanceTimeMilliseconds(100);
+  observer->OnSendPacket(dropped_capture_time_ms, config_.rtp.ssrcs[0]);
+  // Packets of frames which never went through the pipeline are ignored.
+  observer->OnSendPacket(fake_clock_.TimeInMilliseconds() - 1,
+                         config_.rtp.ssrcs[0]);
+
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(10, stats.capture_to_send_delay.p50_ms);
+  EXPECT_EQ(10, stats.capture_to_send_delay.p99_ms);
+}
+
 }  // namespace webrtc
@@ -20,6 +20,7 @@
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/metrics.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 #include "webrtc/video/send_statistics_proxy.h"
@@ -52,7 +53,11 @@ VideoCaptureInput::VideoCaptureInput(ProcessThread* module_process_thread,
       overuse_detector_(new OveruseFrameDetector(Clock::GetRealTimeClock(),
                                                  CpuOveruseOptions(),
                                                  overuse_observer,
-                                                 stats_proxy)) {
+                                                 stats_proxy)),
+      initial_frame_buffer_counts_(GetFrameBufferCounts()),
+      num_delivered_frames_(0),
+      scaled_frame_pyramid_pool_(
+          new rtc::RefCountedObject<ScaledFramePyramidPool>()) {
   capture_thread_->Start();
   capture_thread_->SetPriority(kHighPriority);
   module_process_thread_->RegisterModule(overuse_detector_.get());
@@ -68,6 +73,46 @@ VideoCaptureInput::~VideoCaptureInput() {
   // Stop the camera input.
   capture_thread_->Stop();
   delete &capture_event_;
+
+  // Report the scaling passes which the pyramids saved, e.g. when simulcast
+  // streams and the quality scaler need the same downscaled frame.
+  const ScaledFramePyramidPool::Stats stats =
+      scaled_frame_pyramid_pool_->GetStats();
+  if (stats.num_frames > 0) {
+    const double saved_per_frame =
+        static_cast<double>(stats.num_reused_frames) / stats.num_frames;
+    LOG(LS_INFO) << "Scaled " << stats.num_scaled_frames << " and reused "
+                 << stats.num_reused_frames << " scaled frames for "
+                 << stats.num_frames << " captured frames, saving "
+                 << saved_per_frame << " scaling passes per frame.";
+  }
+  if (stats.num_scaled_frames + stats.num_reused_frames > 0) {
+    RTC_HISTOGRAM_PERCENTAGE(
+        "WebRTC.Video.ReusedScaledFramesInPercent",
+        static_cast<int>(stats.num_reused_frames * 100 /
+                         (stats.num_scaled_frames + stats.num_reused_frames)));
+  }
+
+  // Report how many times the frames were converted or copied on their way to
+  // the encoder, e.g. to see that native and NV12 frames stay unconverted. The
+  // counts are process wide, so they include other streams sending at the
+  // same time.
+  if (num_delivered_frames_ > 0) {
+    const FrameBufferCounts counts = GetFrameBufferCounts();
+    const int num_conversions =
+        counts.num_conversions - initial_frame_buffer_counts_.num_conversions;
+    const int num_copies =
+        counts.num_copies - initial_frame_buffer_counts_.num_copies;
+    LOG(LS_INFO) << "Converted frame buffers " << num_conversions
+                 << " times and copied them " << num_copies << " times for "
+                 << num_delivered_frames_ << " captured frames.";
+    RTC_HISTOGRAM_COUNTS_1000(
+        "WebRTC.Video.FrameBufferConversionsPer100Frames",
+        static_cast<int>(num_conversions * 100LL / num_delivered_frames_));
+    RTC_HISTOGRAM_COUNTS_1000(
+        "WebRTC.Video.FrameBufferCopiesPer100Frames",
+        static_cast<int>(num_copies * 100LL / num_delivered_frames_));
+  }
 }
 
 void VideoCaptureInput::IncomingCapturedFrame(const VideoFrame& video_frame) {
@@ -98,6 +143,13 @@ void VideoCaptureInput::IncomingCapturedFrame(const VideoFrame& video_frame) {
   incoming_frame.set_timestamp(
       kMsToRtpTimestamp * static_cast<uint32_t>(incoming_frame.ntp_time_ms()));
 
+  // Let the consumers which scale the frame share the scaled frames.
+  if (!incoming_frame.IsZeroSize() && !incoming_frame.native_handle()) {
+    incoming_frame.set_scaled_frame_pyramid(
+        scaled_frame_pyramid_pool_->CreatePyramid(
+            incoming_frame.video_frame_buffer()));
+  }
+
   CriticalSectionScoped cs(capture_cs_.get());
   if (incoming_frame.ntp_time_ms() <= last_captured_timestamp_) {
     // We don't allow the same capture time for two frames, drop this one.
@@ -115,8 +167,12 @@ void VideoCaptureInput::IncomingCapturedFrame(const VideoFrame& video_frame) {
                                    captured_frame_.height(),
                                    captured_frame_.render_time_ms());
 
-  TRACE_EVENT_ASYNC_BEGIN1("webrtc", "Video", video_frame.render_time_ms(),
-                           "render_time", video_frame.render_time_ms());
+  // The frame is identified by its render time, i.e. capture time, through
+  // the rest of the send pipeline.
+  TRACE_EVENT_ASYNC_BEGIN1("webrtc", "Video", incoming_frame.render_time_ms(),
+                           "render_time", incoming_frame.render_time_ms());
+  stats_proxy_->OnFrameStage(SendStatisticsProxy::kFrameIncoming,
+                             incoming_frame.render_time_ms());
 
   capture_event_.Set();
 }
@@ -143,8 +199,11 @@ bool VideoCaptureInput::CaptureProcess() {
     }
     if (!deliver_frame.IsZeroSize()) {
       capture_time = deliver_frame.render_time_ms();
+      stats_proxy_->OnFrameStage(SendStatisticsProxy::kFrameDelivered,
+                                 capture_time);
       encode_start_time = Clock::GetRealTimeClock()->TimeInMilliseconds();
       frame_callback_->DeliverFrame(deliver_frame);
+      ++num_delivered_frames_;
     }
     // Update the overuse detector with the duration.
     if (encode_start_time != -1) {
@@ -17,6 +17,7 @@
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/base/thread_annotations.h"
 #include "webrtc/common_types.h"
+#include "webrtc/common_video/interface/scaled_frame_pyramid.h"
 #include "webrtc/engine_configurations.h"
 #include "webrtc/modules/video_capture/include/video_capture.h"
 #include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
@@ -92,6 +93,14 @@ class VideoCaptureInput : public webrtc::VideoCaptureInput {
   const int64_t delta_ntp_internal_ms_;
 
   rtc::scoped_ptr<OveruseFrameDetector> overuse_detector_;
+
+  // Frame buffer conversions and copies before this input was created, and the
+  // number of frames delivered since, to count them per frame.
+  const FrameBufferCounts initial_frame_buffer_counts_;
+  int num_delivered_frames_;
+
+  // Provides the scaled frame pyramids attached to the captured frames.
+  const rtc::scoped_refptr<ScaledFramePyramidPool> scaled_frame_pyramid_pool_;
 };
 
 }  // namespace internal
@@ -197,11 +197,33 @@ TEST_F(VideoCaptureInputTest, TestTextureFrames) {
     AddInputFrame(input_frames_[i]);
     WaitOutputFrame();
     EXPECT_EQ(dummy_handle, output_frames_[i]->native_handle());
+    EXPECT_TRUE(output_frames_[i]->scaled_frame_pyramid() == nullptr);
   }
 
   EXPECT_TRUE(EqualFramesVector(input_frames_, output_frames_));
 }
 
+TEST_F(VideoCaptureInputTest, DoesNotConvertNV12Frames) {
+  const int kWidth = 4;
+  const int kHeight = 4;
+  const uint8_t kNV12Frame[kWidth * kHeight * 3 / 2] = {0};
+  const FrameBufferCounts counts_before = GetFrameBufferCounts();
+  input_frames_.push_back(new VideoFrame(
+      new rtc::RefCountedObject<WrappedNV12Buffer>(
+          kWidth, kHeight, kNV12Frame, kWidth, kNV12Frame + kWidth * kHeight,
+          kWidth, rtc::Callback0<void>()),
+      1, 1, kVideoRotation_0));
+  AddInputFrame(input_frames_[0]);
+  WaitOutputFrame();
+
+  EXPECT_EQ(input_frames_[0]->video_frame_buffer(),
+            output_frames_[0]->video_frame_buffer());
+  EXPECT_TRUE(output_frames_[0]->scaled_frame_pyramid() == nullptr);
+  const FrameBufferCounts counts = GetFrameBufferCounts();
+  EXPECT_EQ(counts_before.num_conversions, counts.num_conversions);
+  EXPECT_EQ(counts_before.num_copies, counts.num_copies);
+}
+
 TEST_F(VideoCaptureInputTest, TestI420Frames) {
   const int kNumFrame = 4;
   std::vector<const uint8_t*> ybuffer_pointers;
@@ -217,6 +239,12 @@ TEST_F(VideoCaptureInputTest, TestI420Frames) {
   // Make sure the buffer is not copied.
   for (int i = 0; i < kNumFrame; ++i)
     EXPECT_EQ(ybuffer_pointers[i], output_frame_ybuffers_[i]);
+  // The consumers can share scaled frames through the attached pyramid.
+  for (int i = 0; i < kNumFrame; ++i) {
+    ASSERT_TRUE(output_frames_[i]->scaled_frame_pyramid() != nullptr);
+    EXPECT_EQ(input_frames_[i]->width(),
+              output_frames_[i]->scaled_frame_pyramid()->width());
+  }
 }
 
 TEST_F(VideoCaptureInputTest, TestI420FrameAfterTextureFrame) {
@@ -129,6 +129,7 @@ VideoCodec CreateDecoderVideoCodec(const VideoReceiveStream::Decoder& decoder) {
 }  // namespace
 
 VideoReceiveStream::VideoReceiveStream(int num_cpu_cores,
+                                       DecodeThreadPool* decode_thread_pool,
                                        ChannelGroup* channel_group,
                                        int channel_id,
                                        const VideoReceiveStream::Config& config,
@@ -139,8 +140,12 @@ VideoReceiveStream::VideoReceiveStream(int num_cpu_cores,
       clock_(Clock::GetRealTimeClock()),
       channel_group_(channel_group),
       channel_id_(channel_id) {
+  // The streams decoded on a pool share its threads, so their decoders are
+  // initialized for one core each. Otherwise every decoder starts threads of
+  // its own, e.g. up to 8 per VP9 decoder, which adds up with many streams.
   CHECK(channel_group_->CreateReceiveChannel(
-      channel_id_, 0, &transport_adapter_, num_cpu_cores));
+      channel_id_, 0, &transport_adapter_,
+      decode_thread_pool ? 1 : num_cpu_cores, decode_thread_pool));
 
   vie_channel_ = channel_group_->GetChannel(channel_id_);
 
@@ -228,8 +233,12 @@ VideoReceiveStream::VideoReceiveStream(int num_cpu_cores,
   DCHECK(!config_.decoders.empty());
   for (size_t i = 0; i < config_.decoders.size(); ++i) {
     const Decoder& decoder = config_.decoders[i];
+    // A pool thread mustn't block waiting for the render time of a frame, so
+    // with a pool the frames are decoded when complete and
+    // |incoming_video_stream_| holds them until their render time.
     CHECK_EQ(0, vie_channel_->RegisterExternalDecoder(
-                    decoder.payload_type, decoder.decoder, decoder.is_renderer,
+                    decoder.payload_type, decoder.decoder,
+                    decoder.is_renderer || decode_thread_pool != nullptr,
                     decoder.is_renderer ? decoder.expected_delay_ms
                                         : config.render_delay_ms));
 
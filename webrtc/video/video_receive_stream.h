@@ -37,7 +37,10 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
                            public I420FrameCallback,
                            public VideoRenderCallback {
  public:
+  // |decode_thread_pool|, if not null, decodes the stream instead of a decode
+  // thread of its own.
   VideoReceiveStream(int num_cpu_cores,
+                     DecodeThreadPool* decode_thread_pool,
                      ChannelGroup* channel_group,
                      int channel_id,
                      const VideoReceiveStream::Config& config,
@@ -178,6 +178,7 @@ VideoSendStream::VideoSendStream(
   CHECK(ReconfigureVideoEncoder(encoder_config));
 
   vie_channel_->RegisterSendSideDelayObserver(&stats_proxy_);
+  vie_channel_->RegisterSendPacketObserver(&stats_proxy_);
   vie_encoder_->RegisterSendStatisticsProxy(&stats_proxy_);
 
   vie_encoder_->RegisterPreEncodeCallback(config_.pre_encode_callback);
@@ -207,6 +208,7 @@ VideoSendStream::~VideoSendStream() {
 
   vie_channel_->RegisterSendFrameCountObserver(nullptr);
   vie_channel_->RegisterSendBitrateObserver(nullptr);
+  vie_channel_->RegisterSendPacketObserver(nullptr);
   vie_channel_->RegisterRtcpPacketTypeCounterObserver(nullptr);
   vie_channel_->RegisterSendChannelRtpStatisticsCallback(nullptr);
   vie_channel_->RegisterSendChannelRtcpStatisticsCallback(nullptr);
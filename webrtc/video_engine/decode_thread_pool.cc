@@ -0,0 +1,203 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/decode_thread_pool.h"
+
+#include <algorithm>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+namespace {
+
+// An event which also schedules its stream when set. The event still works as
+// usual, in case a decode waits for it.
+class StreamEvent : public EventWrapper {
+ public:
+  StreamEvent(DecodeThreadPool* pool, DecodeThreadPool::Stream* stream)
+      : pool_(pool), stream_(stream), event_(EventWrapper::Create()) {}
+
+  bool Set() override {
+    const bool result = event_->Set();
+    pool_->ScheduleStream(stream_);
+    return result;
+  }
+
+  EventTypeWrapper Wait(unsigned long max_time) override {
+    return event_->Wait(max_time);
+  }
+
+ private:
+  DecodeThreadPool* const pool_;
+  DecodeThreadPool::Stream* const stream_;
+  const rtc::scoped_ptr<EventWrapper> event_;
+};
+
+}  // namespace
+
+class DecodeThreadPool::StreamEventFactory : public EventFactory {
+ public:
+  StreamEventFactory(DecodeThreadPool* pool, Stream* stream)
+      : pool_(pool), stream_(stream) {}
+
+  EventWrapper* CreateEvent() override {
+    return new StreamEvent(pool_, stream_);
+  }
+
+ private:
+  DecodeThreadPool* const pool_;
+  Stream* const stream_;
+};
+
+DecodeThreadPool::DecodeThreadPool(int num_threads)
+    : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      stream_ready_(ConditionVariableWrapper::CreateConditionVariable()),
+      decode_done_(ConditionVariableWrapper::CreateConditionVariable()),
+      stopping_(false) {
+  DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    rtc::scoped_ptr<ThreadWrapper> thread = ThreadWrapper::CreateThread(
+        DecodeThreadFunction, this, "DecodeThreadPool");
+    thread->Start();
+    thread->SetPriority(kHighestPriority);
+    threads_.push_back(thread.release());
+  }
+}
+
+DecodeThreadPool::~DecodeThreadPool() {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    DCHECK(streams_.empty());
+    stopping_ = true;
+    stream_ready_->WakeAll();
+  }
+  for (ThreadWrapper* thread : threads_)
+    thread->Stop();
+}
+
+EventFactory* DecodeThreadPool::CreateEventFactory(Stream* stream) {
+  return new StreamEventFactory(this, stream);
+}
+
+void DecodeThreadPool::AddStream(Stream* stream) {
+  CriticalSectionScoped cs(crit_.get());
+  DCHECK(streams_.find(stream) == streams_.end());
+  ScheduleStreamLocked(stream, &streams_[stream]);
+}
+
+void DecodeThreadPool::RemoveStream(Stream* stream) {
+  CriticalSectionScoped cs(crit_.get());
+  StreamMap::iterator it = streams_.find(stream);
+  if (it == streams_.end())
+    return;
+  while (it->second.decoding)
+    decode_done_->SleepCS(*crit_);
+
+  if (it->second.scheduled) {
+    ready_streams_.erase(
+        std::find(ready_streams_.begin(), ready_streams_.end(), stream));
+  }
+  CancelPollLocked(stream, &it->second);
+  streams_.erase(it);
+}
+
+void DecodeThreadPool::ScheduleStream(Stream* stream) {
+  CriticalSectionScoped cs(crit_.get());
+  StreamMap::iterator it = streams_.find(stream);
+  if (it != streams_.end())
+    ScheduleStreamLocked(stream, &it->second);
+}
+
+bool DecodeThreadPool::DecodeThreadFunction(void* obj) {
+  return static_cast<DecodeThreadPool*>(obj)->DecodeProcess();
+}
+
+bool DecodeThreadPool::DecodeProcess() {
+  Stream* stream = nullptr;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    while (!stopping_) {
+      const int64_t time_until_poll_ms =
+          SchedulePollsLocked(TickTime::MillisecondTimestamp());
+      if (!ready_streams_.empty())
+        break;
+      if (time_until_poll_ms < 0) {
+        stream_ready_->SleepCS(*crit_);
+      } else {
+        stream_ready_->SleepCS(*crit_,
+                               static_cast<unsigned long>(time_until_poll_ms));
+      }
+    }
+    if (stopping_)
+      return false;
+
+    stream = ready_streams_.front();
+    ready_streams_.pop_front();
+    StreamState& state = streams_[stream];
+    state.scheduled = false;
+    state.decoding = true;
+  }
+
+  const int64_t poll_delay_ms = stream->DecodeNextFrame();
+
+  CriticalSectionScoped cs(crit_.get());
+  // RemoveStream() waits for the decode, so the stream is still added.
+  StreamState& state = streams_[stream];
+  state.decoding = false;
+  if (state.decode_again) {
+    state.decode_again = false;
+    ScheduleStreamLocked(stream, &state);
+  } else if (poll_delay_ms >= 0) {
+    state.poll_time_ms = TickTime::MillisecondTimestamp() + poll_delay_ms;
+    poll_times_.insert(std::make_pair(state.poll_time_ms, stream));
+  }
+  decode_done_->WakeAll();
+  return true;
+}
+
+void DecodeThreadPool::ScheduleStreamLocked(Stream* stream,
+                                            StreamState* state) {
+  if (state->scheduled)
+    return;
+  // The frame completed during a decode is decoded once the decode is done, so
+  // that two threads never decode the stream at once.
+  if (state->decoding) {
+    state->decode_again = true;
+    return;
+  }
+  CancelPollLocked(stream, state);
+  state->scheduled = true;
+  ready_streams_.push_back(stream);
+  stream_ready_->Wake();
+}
+
+void DecodeThreadPool::CancelPollLocked(Stream* stream, StreamState* state) {
+  if (state->poll_time_ms < 0)
+    return;
+  poll_times_.erase(std::make_pair(state->poll_time_ms, stream));
+  state->poll_time_ms = -1;
+}
+
+int64_t DecodeThreadPool::SchedulePollsLocked(int64_t now_ms) {
+  while (!poll_times_.empty() && poll_times_.begin()->first <= now_ms) {
+    Stream* stream = poll_times_.begin()->second;
+    ScheduleStreamLocked(stream, &streams_[stream]);
+  }
+  if (poll_times_.empty())
+    return -1;
+  return poll_times_.begin()->first - now_ms;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_ENGINE_DECODE_THREAD_POOL_H_
+#define WEBRTC_VIDEO_ENGINE_DECODE_THREAD_POOL_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/thread_annotations.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+
+class ConditionVariableWrapper;
+class EventFactory;
+
+// Decodes many receive streams on a fixed number of threads, instead of on a
+// thread per stream, e.g. on endpoints which record or monitor a lot of
+// streams. A stream is scheduled for decoding when one of the events created
+// by its event factory is set, i.e. when its jitter buffer has a complete
+// frame, and when the poll delay returned by its last decode has passed. A
+// stream is never decoded on two threads at once, so its frames are decoded in
+// order, and the ready streams are decoded in the order they became ready.
+class DecodeThreadPool {
+ public:
+  class Stream {
+   public:
+    // Decodes the next frame, if any, without waiting for it. Returns the time
+    // in ms after which the stream is decoded again even if no event is set,
+    // or -1 to wait for an event.
+    virtual int64_t DecodeNextFrame() = 0;
+
+   protected:
+    virtual ~Stream() {}
+  };
+
+  explicit DecodeThreadPool(int num_threads);
+  ~DecodeThreadPool();
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  // Returns a factory, owned by the caller, of events which schedule |stream|
+  // for decoding when set while the stream is added. Used as the event
+  // factory of the VideoCodingModule decoding |stream|.
+  EventFactory* CreateEventFactory(Stream* stream);
+
+  // Starts decoding |stream|, beginning with the frames already received.
+  void AddStream(Stream* stream);
+  // Stops decoding |stream|. If a pool thread is decoding the stream, waits
+  // until it's done, so this must not be called on a pool thread.
+  void RemoveStream(Stream* stream);
+  // Schedules |stream| for decoding, if it has been added.
+  void ScheduleStream(Stream* stream);
+
+ private:
+  class StreamEventFactory;
+
+  struct StreamState {
+    StreamState()
+        : scheduled(false),
+          decoding(false),
+          decode_again(false),
+          poll_time_ms(-1) {}
+
+    // Whether the stream is in |ready_streams_|.
+    bool scheduled;
+    bool decoding;
+    // Whether the stream was scheduled while being decoded.
+    bool decode_again;
+    // When the stream is scheduled without an event, or -1.
+    int64_t poll_time_ms;
+  };
+  typedef std::map<Stream*, StreamState> StreamMap;
+
+  static bool DecodeThreadFunction(void* obj);
+  bool DecodeProcess();
+
+  void ScheduleStreamLocked(Stream* stream, StreamState* state)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void CancelPollLocked(Stream* stream, StreamState* state)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Schedules the streams whose poll time has passed, and returns the time
+  // until the next poll, or -1 if no stream is to be polled.
+  int64_t SchedulePollsLocked(int64_t now_ms) EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+  // Signaled when a stream is scheduled.
+  const rtc::scoped_ptr<ConditionVariableWrapper> stream_ready_;
+  // Signaled when a stream has been decoded.
+  const rtc::scoped_ptr<ConditionVariableWrapper> decode_done_;
+
+  bool stopping_ GUARDED_BY(crit_);
+  StreamMap streams_ GUARDED_BY(crit_);
+  std::deque<Stream*> ready_streams_ GUARDED_BY(crit_);
+  std::set<std::pair<int64_t, Stream*>> poll_times_ GUARDED_BY(crit_);
+
+  ScopedVector<ThreadWrapper> threads_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecodeThreadPool);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_ENGINE_DECODE_THREAD_POOL_H_
@@ -0,0 +1,492 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/decode_thread_pool.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/video_coding/codecs/interface/video_error_codes.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/video_decoder.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kEventTimeoutMs = 5000;
+
+// Decodes the ids of the inserted frames, one per DecodeNextFrame() call, and
+// records whether it's ever decoded on two threads at once.
+class FakeStream : public DecodeThreadPool::Stream {
+ public:
+  FakeStream()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        frame_decoded_(EventWrapper::Create()),
+        decoding_(false),
+        decoded_concurrently_(false),
+        num_decodes_(0),
+        poll_delay_ms_(-1),
+        decode_time_ms_(0) {}
+
+  void InsertFrame(int id) {
+    CriticalSectionScoped cs(crit_.get());
+    frames_.push_back(id);
+  }
+
+  int64_t DecodeNextFrame() override {
+    int decode_time_ms;
+    {
+      CriticalSectionScoped cs(crit_.get());
+      if (decoding_)
+        decoded_concurrently_ = true;
+      decoding_ = true;
+      ++num_decodes_;
+      decode_time_ms = decode_time_ms_;
+    }
+    if (decode_time_ms > 0)
+      SleepMs(decode_time_ms);
+
+    CriticalSectionScoped cs(crit_.get());
+    decoding_ = false;
+    if (frames_.empty())
+      return poll_delay_ms_;
+    decoded_frames_.push_back(frames_.front());
+    frames_.pop_front();
+    frame_decoded_->Set();
+    // Like ViEChannel, decode until there are no frames left, since the events
+    // of several frames may have scheduled only one decode.
+    return 0;
+  }
+
+  // Waits until |num_frames| have been decoded.
+  bool WaitForDecodedFrames(size_t num_frames) {
+    const int64_t deadline_ms =
+        TickTime::MillisecondTimestamp() + kEventTimeoutMs;
+    while (true) {
+      {
+        CriticalSectionScoped cs(crit_.get());
+        if (decoded_frames_.size() >= num_frames)
+          return true;
+      }
+      const int64_t time_left_ms =
+          deadline_ms - TickTime::MillisecondTimestamp();
+      if (time_left_ms <= 0)
+        return false;
+      frame_decoded_->Wait(static_cast<unsigned long>(time_left_ms));
+    }
+  }
+
+  std::vector<int> decoded_frames() const {
+    CriticalSectionScoped cs(crit_.get());
+    return decoded_frames_;
+  }
+  bool decoded_concurrently() const {
+    CriticalSectionScoped cs(crit_.get());
+    return decoded_concurrently_;
+  }
+  int num_decodes() const {
+    CriticalSectionScoped cs(crit_.get());
+    return num_decodes_;
+  }
+  void set_poll_delay_ms(int64_t poll_delay_ms) {
+    CriticalSectionScoped cs(crit_.get());
+    poll_delay_ms_ = poll_delay_ms;
+  }
+  void set_decode_time_ms(int decode_time_ms) {
+    CriticalSectionScoped cs(crit_.get());
+    decode_time_ms_ = decode_time_ms;
+  }
+
+ private:
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+  const rtc::scoped_ptr<EventWrapper> frame_decoded_;
+  std::deque<int> frames_;
+  std::vector<int> decoded_frames_;
+  bool decoding_;
+  bool decoded_concurrently_;
+  int num_decodes_;
+  int64_t poll_delay_ms_;
+  int decode_time_ms_;
+};
+
+}  // namespace
+
+TEST(DecodeThreadPoolTest, DecodesStreamWhenEventIsSet) {
+  DecodeThreadPool pool(2);
+  FakeStream stream;
+  rtc::scoped_ptr<EventFactory> event_factory(
+      pool.CreateEventFactory(&stream));
+  rtc::scoped_ptr<EventWrapper> event(event_factory->CreateEvent());
+
+  // The frames received before the stream is added are decoded when added.
+  stream.InsertFrame(0);
+  event->Set();
+  SleepMs(10);
+  EXPECT_EQ(0, stream.num_decodes());
+  pool.AddStream(&stream);
+  ASSERT_TRUE(stream.WaitForDecodedFrames(1));
+
+  stream.InsertFrame(1);
+  event->Set();
+  ASSERT_TRUE(stream.WaitForDecodedFrames(2));
+  // The event works as usual too.
+  EXPECT_EQ(kEventSignaled, event->Wait(0));
+  pool.RemoveStream(&stream);
+
+  const int num_decodes = stream.num_decodes();
+  stream.InsertFrame(2);
+  event->Set();
+  SleepMs(10);
+  EXPECT_EQ(num_decodes, stream.num_decodes());
+}
+
+TEST(DecodeThreadPoolTest, PollsStreamAfterReturnedDelay) {
+  DecodeThreadPool pool(1);
+  FakeStream stream;
+  stream.set_poll_delay_ms(10);
+  pool.AddStream(&stream);
+  // Without events, the stream is decoded every 10 ms.
+  stream.InsertFrame(0);
+  stream.InsertFrame(1);
+  stream.InsertFrame(2);
+  ASSERT_TRUE(stream.WaitForDecodedFrames(3));
+
+  stream.set_poll_delay_ms(-1);
+  ASSERT_TRUE(stream.WaitForDecodedFrames(3));
+  SleepMs(20);
+  const int num_decodes = stream.num_decodes();
+  SleepMs(50);
+  EXPECT_EQ(num_decodes, stream.num_decodes());
+  pool.RemoveStream(&stream);
+}
+
+TEST(DecodeThreadPoolTest, DecodesEachStreamInOrderOnOneThreadAtATime) {
+  const int kNumStreams = 8;
+  const int kNumFrames = 100;
+  DecodeThreadPool pool(4);
+  FakeStream streams[kNumStreams];
+  ScopedVector<EventFactory> event_factories;
+  ScopedVector<EventWrapper> events;
+  for (FakeStream& stream : streams) {
+    // Let the frames queue up, to decode streams which are scheduled while
+    // being decoded.
+    stream.set_decode_time_ms(1);
+    event_factories.push_back(pool.CreateEventFactory(&stream));
+    events.push_back(event_factories.back()->CreateEvent());
+    pool.AddStream(&stream);
+  }
+
+  for (int i = 0; i < kNumFrames; ++i) {
+    for (int j = 0; j < kNumStreams; ++j) {
+      streams[j].InsertFrame(i);
+      events[j]->Set();
+    }
+  }
+
+  std::vector<int> expected_frames;
+  for (int i = 0; i < kNumFrames; ++i)
+    expected_frames.push_back(i);
+  for (FakeStream& stream : streams) {
+    ASSERT_TRUE(stream.WaitForDecodedFrames(kNumFrames));
+    pool.RemoveStream(&stream);
+    EXPECT_EQ(expected_frames, stream.decoded_frames());
+    EXPECT_FALSE(stream.decoded_concurrently());
+  }
+}
+
+TEST(DecodeThreadPoolTest, RemoveStreamWaitsForDecode) {
+  DecodeThreadPool pool(1);
+  FakeStream stream;
+  stream.set_decode_time_ms(50);
+  stream.InsertFrame(0);
+  pool.AddStream(&stream);
+  while (stream.num_decodes() == 0)
+    SleepMs(1);
+  pool.RemoveStream(&stream);
+  EXPECT_EQ(1u, stream.decoded_frames().size());
+}
+
+namespace {
+
+const int kPayloadType = 100;
+
+// Records the latency from the insertion of a frame to its decode.
+class LatencyRecorder {
+ public:
+  LatencyRecorder()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        num_frames_(0),
+        sum_latency_us_(0),
+        max_latency_us_(0) {}
+
+  void AddLatency(int64_t latency_us) {
+    CriticalSectionScoped cs(crit_.get());
+    ++num_frames_;
+    sum_latency_us_ += latency_us;
+    max_latency_us_ = std::max(max_latency_us_, latency_us);
+  }
+
+  int num_frames() const {
+    CriticalSectionScoped cs(crit_.get());
+    return num_frames_;
+  }
+  double mean_latency_ms() const {
+    CriticalSectionScoped cs(crit_.get());
+    return num_frames_ > 0 ? sum_latency_us_ / (1000.0 * num_frames_) : 0;
+  }
+  double max_latency_ms() const {
+    CriticalSectionScoped cs(crit_.get());
+    return max_latency_us_ / 1000.0;
+  }
+
+ private:
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+  int num_frames_;
+  int64_t sum_latency_us_;
+  int64_t max_latency_us_;
+};
+
+// A decoder which only records when each frame is decoded, and checks that
+// the frames are decoded in order.
+class FakeDecoder : public VideoDecoder {
+ public:
+  explicit FakeDecoder(LatencyRecorder* latency_recorder)
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        latency_recorder_(latency_recorder),
+        last_timestamp_(0),
+        decoded_out_of_order_(false) {}
+
+  void OnFrameInserted(uint32_t timestamp) {
+    CriticalSectionScoped cs(crit_.get());
+    insert_times_us_[timestamp] = TickTime::MicrosecondTimestamp();
+  }
+
+  int32_t InitDecode(const VideoCodec* codec_settings,
+                     int32_t number_of_cores) override {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int32_t Decode(const EncodedImage& input_image,
+                 bool missing_frames,
+                 const RTPFragmentationHeader* fragmentation,
+                 const CodecSpecificInfo* codec_specific_info,
+                 int64_t render_time_ms) override {
+    CriticalSectionScoped cs(crit_.get());
+    if (input_image._timeStamp <= last_timestamp_)
+      decoded_out_of_order_ = true;
+    last_timestamp_ = input_image._timeStamp;
+    std::map<uint32_t, int64_t>::iterator it =
+        insert_times_us_.find(input_image._timeStamp);
+    if (it != insert_times_us_.end()) {
+      latency_recorder_->AddLatency(TickTime::MicrosecondTimestamp() -
+                                    it->second);
+      insert_times_us_.erase(it);
+    }
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int32_t RegisterDecodeCompleteCallback(
+      DecodedImageCallback* callback) override {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+  int32_t Release() override { return WEBRTC_VIDEO_CODEC_OK; }
+  int32_t Reset() override { return WEBRTC_VIDEO_CODEC_OK; }
+
+  bool decoded_out_of_order() const {
+    CriticalSectionScoped cs(crit_.get());
+    return decoded_out_of_order_;
+  }
+
+ private:
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+  LatencyRecorder* const latency_recorder_;
+  std::map<uint32_t, int64_t> insert_times_us_;
+  uint32_t last_timestamp_;
+  bool decoded_out_of_order_;
+};
+
+// A VideoCodingModule with a fake decoder, decoded either on a pool like
+// ViEChannel::DecodeNextFrame does, or on a thread of its own like
+// ViEChannel::ChannelDecodeProcess does.
+class ReceiveStream : public DecodeThreadPool::Stream {
+ public:
+  ReceiveStream(DecodeThreadPool* pool,
+                EventFactory* event_factory,
+                LatencyRecorder* latency_recorder)
+      : pool_(pool),
+        decoder_(latency_recorder),
+        event_factory_(pool ? pool->CreateEventFactory(this) : event_factory),
+        owns_event_factory_(pool != nullptr),
+        vcm_(VideoCodingModule::Create(Clock::GetRealTimeClock(),
+                                       event_factory_)),
+        sequence_number_(0),
+        timestamp_(0) {
+    VideoCodec codec = {};
+    VideoCodingModule::Codec(kVideoCodecVP8, &codec);
+    codec.plType = kPayloadType;
+    EXPECT_EQ(0, vcm_->RegisterExternalDecoder(&decoder_, kPayloadType, true));
+    EXPECT_EQ(0, vcm_->RegisterReceiveCodec(&codec, 1, true));
+  }
+
+  ~ReceiveStream() {
+    Stop();
+    VideoCodingModule::Destroy(vcm_);
+    if (owns_event_factory_)
+      delete event_factory_;
+  }
+
+  void Start() {
+    if (pool_) {
+      pool_->AddStream(this);
+      return;
+    }
+    decode_thread_ = ThreadWrapper::CreateThread(DecodeThreadFunction, this,
+                                                 "DecodingThread");
+    decode_thread_->Start();
+  }
+
+  void Stop() {
+    if (pool_) {
+      pool_->RemoveStream(this);
+    } else if (decode_thread_) {
+      vcm_->TriggerDecoderShutdown();
+      decode_thread_->Stop();
+      decode_thread_.reset();
+    }
+  }
+
+  // Inserts a frame of a single packet, a key frame first.
+  void InsertFrame() {
+    static const uint8_t kPayload[100] = {0};
+    WebRtcRTPHeader header = {};
+    header.frameType = timestamp_ == 0 ? kVideoFrameKey : kVideoFrameDelta;
+    header.header.payloadType = kPayloadType;
+    header.header.sequenceNumber = sequence_number_++;
+    timestamp_ += 3000;
+    header.header.timestamp = timestamp_;
+    header.header.markerBit = true;
+    header.header.headerLength = 12;
+    header.type.Video.codec = kRtpVideoVp8;
+    header.type.Video.isFirstPacket = true;
+    header.type.Video.codecHeader.VP8.InitRTPVideoHeaderVP8();
+    decoder_.OnFrameInserted(timestamp_);
+    EXPECT_EQ(0, vcm_->IncomingPacket(kPayload, sizeof(kPayload), header));
+  }
+
+  int64_t DecodeNextFrame() override {
+    if (vcm_->Decode(0) != VCM_FRAME_NOT_READY)
+      return 0;
+    return 50;
+  }
+
+  bool decoded_out_of_order() const { return decoder_.decoded_out_of_order(); }
+
+ private:
+  static bool DecodeThreadFunction(void* obj) {
+    static_cast<ReceiveStream*>(obj)->vcm_->Decode(50);
+    return true;
+  }
+
+  DecodeThreadPool* const pool_;
+  FakeDecoder decoder_;
+  EventFactory* const event_factory_;
+  const bool owns_event_factory_;
+  VideoCodingModule* const vcm_;
+  rtc::scoped_ptr<ThreadWrapper> decode_thread_;
+  uint16_t sequence_number_;
+  uint32_t timestamp_;
+};
+
+// Inserts frames into |num_streams| streams at 30 fps, decodes them with a
+// pool of |num_decode_threads|, or on a thread per stream if 0. If
+// |print_stats|, prints the CPU time used and the decode latency.
+void DecodeStreams(int num_streams,
+                   int num_decode_threads,
+                   int num_frames,
+                   bool print_stats) {
+  rtc::scoped_ptr<DecodeThreadPool> pool(
+      num_decode_threads > 0 ? new DecodeThreadPool(num_decode_threads)
+                             : nullptr);
+  EventFactoryImpl event_factory;
+  LatencyRecorder latency_recorder;
+  ScopedVector<ReceiveStream> streams;
+  for (int i = 0; i < num_streams; ++i) {
+    streams.push_back(
+        new ReceiveStream(pool.get(), &event_factory, &latency_recorder));
+    streams.back()->Start();
+  }
+
+  const clock_t start_cpu_time = clock();
+  const int64_t start_time_ms = TickTime::MillisecondTimestamp();
+  for (int i = 0; i < num_frames; ++i) {
+    for (ReceiveStream* stream : streams)
+      stream->InsertFrame();
+    const int64_t next_frame_time_ms = start_time_ms + (i + 1) * 1000 / 30;
+    const int64_t now_ms = TickTime::MillisecondTimestamp();
+    if (next_frame_time_ms > now_ms)
+      SleepMs(static_cast<int>(next_frame_time_ms - now_ms));
+  }
+  const int64_t deadline_ms = TickTime::MillisecondTimestamp() + 1000;
+  while (latency_recorder.num_frames() < num_streams * num_frames &&
+         TickTime::MillisecondTimestamp() < deadline_ms) {
+    SleepMs(1);
+  }
+  const double cpu_time_ms =
+      1000.0 * (clock() - start_cpu_time) / CLOCKS_PER_SEC;
+  const int64_t elapsed_time_ms =
+      TickTime::MillisecondTimestamp() - start_time_ms;
+
+  for (ReceiveStream* stream : streams) {
+    stream->Stop();
+    EXPECT_FALSE(stream->decoded_out_of_order());
+  }
+  EXPECT_EQ(num_streams * num_frames, latency_recorder.num_frames());
+
+  if (!print_stats)
+    return;
+  printf("%d streams, %s: %.1f%% CPU, %.2f ms mean, %.2f ms max decode "
+         "latency\n",
+         num_streams,
+         num_decode_threads > 0 ? "decode thread pool" : "thread per stream",
+         100.0 * cpu_time_ms / elapsed_time_ms,
+         latency_recorder.mean_latency_ms(), latency_recorder.max_latency_ms());
+}
+
+}  // namespace
+
+TEST(DecodeThreadPoolTest, Decodes64StreamsOnPool) {
+  DecodeStreams(64, 4, 30, false);
+}
+
+// Compares the pool with a decode thread per stream. The fake decoders are
+// free, so the CPU usage is the cost of scheduling the decodes.
+TEST(DecodeThreadPoolTest, DISABLED_DecodeLatencyBenchmark) {
+  const int kNumFrames = 300;
+  DecodeStreams(64, 0, kNumFrames, true);
+  DecodeStreams(64, 1, kNumFrames, true);
+  DecodeStreams(64, 4, kNumFrames, true);
+}
+
+}  // namespace webrtc
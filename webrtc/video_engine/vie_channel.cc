@@ -89,6 +89,7 @@ ViEChannel::ViEChannel(int32_t channel_id,
                        RtcpRttStats* rtt_stats,
                        PacedSender* paced_sender,
                        PacketRouter* packet_router,
+                       DecodeThreadPool* decode_thread_pool,
                        size_t max_rtp_streams,
                        bool sender)
     : channel_id_(channel_id),
@@ -99,9 +100,17 @@ ViEChannel::ViEChannel(int32_t channel_id,
       crit_(CriticalSectionWrapper::CreateCriticalSection()),
       send_payload_router_(new PayloadRouter()),
       vcm_protection_callback_(new ViEChannelProtectionCallback(this)),
-      vcm_(VideoCodingModule::Create(Clock::GetRealTimeClock(),
-                                     nullptr,
-                                     nullptr)),
+      decode_thread_pool_(decode_thread_pool),
+      decode_event_factory_(
+          decode_thread_pool ? decode_thread_pool->CreateEventFactory(this)
+                             : nullptr),
+      decoding_on_pool_(false),
+      vcm_(decode_event_factory_
+               ? VideoCodingModule::Create(Clock::GetRealTimeClock(),
+                                           decode_event_factory_.get())
+               : VideoCodingModule::Create(Clock::GetRealTimeClock(),
+                                           nullptr,
+                                           nullptr)),
       vie_receiver_(channel_id, vcm_, remote_bitrate_estimator, this),
       vie_sync_(vcm_),
       stats_observer_(new ChannelStatsObserver(this)),
@@ -136,6 +145,7 @@ ViEChannel::ViEChannel(int32_t channel_id,
                                &send_bitrate_observer_,
                                &send_frame_count_observer_,
                                &send_side_delay_observer_,
+                               &send_packet_observer_,
                                max_rtp_streams)),
       num_active_rtp_rtcp_modules_(1) {
   vie_receiver_.SetRtpRtcpModule(rtp_rtcp_modules_[0]);
@@ -187,7 +197,7 @@ ViEChannel::~ViEChannel() {
     module_process_thread_->DeRegisterModule(rtp_rtcp);
     delete rtp_rtcp;
   }
-  if (decode_thread_) {
+  if (decode_thread_ || decoding_on_pool_) {
     StopDecodeThread();
   }
   // Release modules.
@@ -929,6 +939,10 @@ void ViEChannel::RegisterSendSideDelayObserver(
   send_side_delay_observer_.Set(observer);
 }
 
+void ViEChannel::RegisterSendPacketObserver(SendPacketObserver* observer) {
+  send_packet_observer_.Set(observer);
+}
+
 void ViEChannel::RegisterSendBitrateObserver(
     BitrateStatisticsObserver* observer) {
   send_bitrate_observer_.Set(observer);
@@ -1100,6 +1114,16 @@ bool ViEChannel::ChannelDecodeProcess() {
   return true;
 }
 
+int64_t ViEChannel::DecodeNextFrame() {
+  // Decode one frame at a time, and let the pool decode the other ready
+  // channels before the next frame.
+  if (vcm_->Decode(0) != VCM_FRAME_NOT_READY)
+    return 0;
+  // Poll as often as the decode thread does, to decode the incomplete frames
+  // which the jitter buffer releases without setting an event.
+  return kMaxDecodeWaitTimeMs;
+}
+
 void ViEChannel::OnRttUpdate(int64_t avg_rtt_ms, int64_t max_rtt_ms) {
   vcm_->SetReceiveChannelParameters(max_rtt_ms);
 
@@ -1149,6 +1173,7 @@ std::vector<RtpRtcp*> ViEChannel::CreateRtpRtcpModules(
     BitrateStatisticsObserver* send_bitrate_observer,
     FrameCountObserver* send_frame_count_observer,
     SendSideDelayObserver* send_side_delay_observer,
+    SendPacketObserver* send_packet_observer,
     size_t num_modules) {
   DCHECK_GT(num_modules, 0u);
   RtpRtcp::Configuration configuration;
@@ -1167,6 +1192,7 @@ std::vector<RtpRtcp*> ViEChannel::CreateRtpRtcpModules(
   configuration.send_bitrate_observer = send_bitrate_observer;
   configuration.send_frame_count_observer = send_frame_count_observer;
   configuration.send_side_delay_observer = send_side_delay_observer;
+  configuration.send_packet_observer = send_packet_observer;
   configuration.bandwidth_callback = bandwidth_callback;
   configuration.transport_feedback_callback = transport_feedback_callback;
 
@@ -1187,6 +1213,13 @@ std::vector<RtpRtcp*> ViEChannel::CreateRtpRtcpModules(
 
 void ViEChannel::StartDecodeThread() {
   DCHECK(!sender_);
+  if (decode_thread_pool_) {
+    if (!decoding_on_pool_) {
+      decode_thread_pool_->AddStream(this);
+      decoding_on_pool_ = true;
+    }
+    return;
+  }
   // Start the decode thread
   if (decode_thread_)
     return;
@@ -1197,6 +1230,12 @@ void ViEChannel::StartDecodeThread() {
 }
 
 void ViEChannel::StopDecodeThread() {
+  if (decoding_on_pool_) {
+    vcm_->TriggerDecoderShutdown();
+    decode_thread_pool_->RemoveStream(this);
+    decoding_on_pool_ = false;
+    return;
+  }
   if (!decode_thread_)
     return;
 
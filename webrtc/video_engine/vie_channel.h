@@ -22,6 +22,7 @@
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/typedefs.h"
+#include "webrtc/video_engine/decode_thread_pool.h"
 #include "webrtc/video_engine/vie_defines.h"
 #include "webrtc/video_engine/vie_receiver.h"
 #include "webrtc/video_engine/vie_sync_module.h"
@@ -33,6 +34,7 @@ class ChannelStatsObserver;
 class Config;
 class CriticalSectionWrapper;
 class EncodedImageCallback;
+class EventFactory;
 class I420FrameCallback;
 class IncomingVideoStream;
 class PacedSender;
@@ -60,7 +62,8 @@ class ViEChannel : public VCMFrameTypeCallback,
                    public VCMReceiveStatisticsCallback,
                    public VCMDecoderTimingCallback,
                    public VCMPacketRequestCallback,
-                   public RtpFeedback {
+                   public RtpFeedback,
+                   public DecodeThreadPool::Stream {
  public:
   friend class ChannelStatsObserver;
   friend class ViEChannelProtectionCallback;
@@ -77,6 +80,7 @@ class ViEChannel : public VCMFrameTypeCallback,
              RtcpRttStats* rtt_stats,
              PacedSender* paced_sender,
              PacketRouter* packet_router,
+             DecodeThreadPool* decode_thread_pool,
              size_t max_rtp_streams,
              bool sender);
   ~ViEChannel();
@@ -188,6 +192,9 @@ class ViEChannel : public VCMFrameTypeCallback,
 
   void RegisterSendSideDelayObserver(SendSideDelayObserver* observer);
 
+  // Called for every media packet sent to the network.
+  void RegisterSendPacketObserver(SendPacketObserver* observer);
+
   // Called on any new send bitrate estimate.
   void RegisterSendBitrateObserver(BitrateStatisticsObserver* observer);
 
@@ -286,6 +293,9 @@ class ViEChannel : public VCMFrameTypeCallback,
   static bool ChannelDecodeThreadFunction(void* obj);
   bool ChannelDecodeProcess();
 
+  // Implements DecodeThreadPool::Stream.
+  int64_t DecodeNextFrame() override;
+
   void OnRttUpdate(int64_t avg_rtt_ms, int64_t max_rtt_ms);
 
   int ProtectionRequest(const FecProtectionParams* delta_fec_params,
@@ -311,6 +321,7 @@ class ViEChannel : public VCMFrameTypeCallback,
       BitrateStatisticsObserver* send_bitrate_observer,
       FrameCountObserver* send_frame_count_observer,
       SendSideDelayObserver* send_side_delay_observer,
+      SendPacketObserver* send_packet_observer,
       size_t num_modules);
 
   // Assumed to be protected.
@@ -387,6 +398,15 @@ class ViEChannel : public VCMFrameTypeCallback,
     }
   } send_side_delay_observer_;
 
+  class RegisterableSendPacketObserver
+      : public RegisterableCallback<SendPacketObserver> {
+    void OnSendPacket(int64_t capture_time_ms, uint32_t ssrc) override {
+      CriticalSectionScoped cs(critsect_.get());
+      if (callback_)
+        callback_->OnSendPacket(capture_time_ms, ssrc);
+    }
+  } send_packet_observer_;
+
   class RegisterableRtcpPacketTypeCounterObserver
       : public RegisterableCallback<RtcpPacketTypeCounterObserver> {
    public:
@@ -424,6 +444,12 @@ class ViEChannel : public VCMFrameTypeCallback,
   rtc::scoped_refptr<PayloadRouter> send_payload_router_;
   rtc::scoped_ptr<ViEChannelProtectionCallback> vcm_protection_callback_;
 
+  // If not null, decodes the channel instead of |decode_thread_|. The VCM
+  // events schedule the channel on the pool.
+  DecodeThreadPool* const decode_thread_pool_;
+  const rtc::scoped_ptr<EventFactory> decode_event_factory_;
+  bool decoding_on_pool_;
+
   VideoCodingModule* const vcm_;
   ViEReceiver vie_receiver_;
   ViESyncModule vie_sync_;
@@ -199,7 +199,7 @@ bool ChannelGroup::CreateSendChannel(int channel_id,
   }
   ViEEncoder* encoder = vie_encoder.get();
   if (!CreateChannel(channel_id, engine_id, transport, number_of_cores,
-                     vie_encoder.release(), ssrcs.size(), true)) {
+                     vie_encoder.release(), nullptr, ssrcs.size(), true)) {
     return false;
   }
   ViEChannel* channel = channel_map_[channel_id];
@@ -216,9 +216,10 @@ bool ChannelGroup::CreateSendChannel(int channel_id,
 bool ChannelGroup::CreateReceiveChannel(int channel_id,
                                         int engine_id,
                                         Transport* transport,
-                                        int number_of_cores) {
+                                        int number_of_cores,
+                                        DecodeThreadPool* decode_thread_pool) {
   return CreateChannel(channel_id, engine_id, transport, number_of_cores,
-                       nullptr, 1, false);
+                       nullptr, decode_thread_pool, 1, false);
 }
 
 bool ChannelGroup::CreateChannel(int channel_id,
@@ -226,6 +227,7 @@ bool ChannelGroup::CreateChannel(int channel_id,
                                  Transport* transport,
                                  int number_of_cores,
                                  ViEEncoder* vie_encoder,
+                                 DecodeThreadPool* decode_thread_pool,
                                  size_t max_rtp_streams,
                                  bool sender) {
   rtc::scoped_ptr<ViEChannel> channel(new ViEChannel(
@@ -233,7 +235,8 @@ bool ChannelGroup::CreateChannel(int channel_id,
       encoder_state_feedback_->GetRtcpIntraFrameObserver(),
       bitrate_controller_->CreateRtcpBandwidthObserver(), nullptr,
       remote_bitrate_estimator_.get(), call_stats_->rtcp_rtt_stats(),
-      pacer_.get(), packet_router_.get(), max_rtp_streams, sender));
+      pacer_.get(), packet_router_.get(), decode_thread_pool, max_rtp_streams,
+      sender));
   if (channel->Init() != 0) {
     return false;
   }
@@ -24,6 +24,7 @@ namespace webrtc {
 
 class BitrateAllocator;
 class CallStats;
+class DecodeThreadPool;
 class Config;
 class EncoderStateFeedback;
 class PacedSender;
@@ -51,7 +52,8 @@ class ChannelGroup : public BitrateObserver {
   bool CreateReceiveChannel(int channel_id,
                             int engine_id,
                             Transport* transport,
-                            int number_of_cores);
+                            int number_of_cores,
+                            DecodeThreadPool* decode_thread_pool);
   void DeleteChannel(int channel_id);
   ViEChannel* GetChannel(int channel_id) const;
   ViEEncoder* GetEncoder(int channel_id) const;
@@ -79,6 +81,7 @@ class ChannelGroup : public BitrateObserver {
                      Transport* transport,
                      int number_of_cores,
                      ViEEncoder* vie_encoder,
+                     DecodeThreadPool* decode_thread_pool,
                      size_t max_rtp_streams,
                      bool sender);
   ViEChannel* PopChannel(int channel_id);
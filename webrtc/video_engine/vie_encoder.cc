@@ -433,6 +433,16 @@ void ViEEncoder::DeliverFrame(VideoFrame video_frame) {
   TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", video_frame.render_time_ms(),
                           "Encode");
   VideoFrame* decimated_frame = NULL;
+  // Native frames, e.g. textures or NV12 buffers, are passed on as they are and
+  // only converted to I420 if the encoder needs it. They have to be converted
+  // here though if they need to be scaled to the send resolution.
+  if (video_frame.native_handle() != NULL &&
+      (static_cast<int>(vpm_->DecimatedWidth()) != video_frame.width() ||
+       static_cast<int>(vpm_->DecimatedHeight()) != video_frame.height())) {
+    VideoFrame converted_frame = video_frame.ConvertNativeToI420Frame();
+    if (!converted_frame.IsZeroSize())
+      video_frame = converted_frame;
+  }
   // TODO(wuchengli): support texture frames.
   if (video_frame.native_handle() == NULL) {
     // Pass frame via preprocessor.
@@ -456,9 +466,18 @@ void ViEEncoder::DeliverFrame(VideoFrame video_frame) {
       if (decimated_frame == NULL) {
         copied_frame.CopyFrame(video_frame);
         decimated_frame = &copied_frame;
+      } else if (decimated_frame->scaled_frame_pyramid()) {
+        // The scaled frame is cached in the pyramid of the captured frame, so
+        // the callback gets a copy.
+        copied_frame.CopyFrame(*decimated_frame);
+        decimated_frame = &copied_frame;
       }
       pre_encode_callback_->FrameCallback(decimated_frame);
     }
+    if (send_statistics_proxy_ != NULL) {
+      send_statistics_proxy_->OnFrameStage(
+          SendStatisticsProxy::kFramePreprocessed, video_frame.render_time_ms());
+    }
   }
 
   // If the frame was not resampled, scaled, or touched by FrameCallback => use
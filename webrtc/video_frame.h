@@ -12,6 +12,7 @@
 #define WEBRTC_VIDEO_FRAME_H_
 
 #include "webrtc/base/scoped_ref_ptr.h"
+#include "webrtc/common_video/interface/scaled_frame_pyramid.h"
 #include "webrtc/common_video/interface/video_frame_buffer.h"
 #include "webrtc/common_video/rotation.h"
 #include "webrtc/typedefs.h"
@@ -73,7 +74,8 @@ class VideoFrame {
                   VideoRotation rotation);
 
   // Deep copy frame: If required size is bigger than allocated one, new
-  // buffers of adequate size will be allocated.
+  // buffers of adequate size will be allocated. Native-handle frames share the
+  // buffer instead. Deep copies are counted, see GetFrameBufferCounts().
   // Return value: 0 on success, -1 on error.
   int CopyFrame(const VideoFrame& videoFrame);
 
@@ -149,12 +151,24 @@ class VideoFrame {
   // Return the underlying buffer.
   rtc::scoped_refptr<webrtc::VideoFrameBuffer> video_frame_buffer() const;
 
-  // Set the underlying buffer.
+  // Set the underlying buffer. Detaches the scaled frame pyramid.
   void set_video_frame_buffer(
       const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer);
 
+  // The cached scaled versions of the captured frame this frame is, or was
+  // scaled from, if any. Shallow copies share the pyramid, and the methods
+  // which replace the buffer detach it.
+  ScaledFramePyramid* scaled_frame_pyramid() const {
+    return scaled_frame_pyramid_.get();
+  }
+  void set_scaled_frame_pyramid(
+      const rtc::scoped_refptr<ScaledFramePyramid>& pyramid) {
+    scaled_frame_pyramid_ = pyramid;
+  }
+
   // Convert native-handle frame to memory-backed I420 frame. Should not be
-  // called on a non-native-handle frame.
+  // called on a non-native-handle frame. Conversions are counted, see
+  // GetFrameBufferCounts().
   VideoFrame ConvertNativeToI420Frame() const;
 
  private:
@@ -164,6 +178,7 @@ class VideoFrame {
   int64_t ntp_time_ms_;
   int64_t render_time_ms_;
   VideoRotation rotation_;
+  rtc::scoped_refptr<ScaledFramePyramid> scaled_frame_pyramid_;
 };
 
 enum VideoFrameType {
@@ -54,6 +54,14 @@ class VideoSendStream : public SendStream {
     RtcpStatistics rtcp_stats;
   };
 
+  // Percentiles of the time recently sent frames spent in one part of the
+  // send pipeline. -1 if no frame has been measured.
+  struct DelayPercentiles {
+    int p50_ms = -1;
+    int p90_ms = -1;
+    int p99_ms = -1;
+  };
+
   struct Stats {
     int input_frame_rate = 0;
     int encode_frame_rate = 0;
@@ -62,6 +70,20 @@ class VideoSendStream : public SendStream {
     int target_media_bitrate_bps = 0;
     int media_bitrate_bps = 0;
     bool suspended = false;
+    // Where the time goes between capturing a frame and sending its first
+    // packet, identified by the capture time of the frame.
+    // From capture until VideoCaptureInput gets the frame.
+    DelayPercentiles capture_delay;
+    // Waiting for the capture thread to deliver the frame to the encoder.
+    DelayPercentiles deliver_delay;
+    // Scaling, denoising and other preprocessing before encoding.
+    DelayPercentiles preprocess_delay;
+    // Encoding, including waiting for the encoder.
+    DelayPercentiles encode_delay;
+    // Packetization and pacing until the first packet goes to the transport.
+    DelayPercentiles send_delay;
+    // From capture until the first packet goes to the transport.
+    DelayPercentiles capture_to_send_delay;
     std::map<uint32_t, StreamStats> substreams;
   };
 